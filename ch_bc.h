@@ -0,0 +1,1578 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// load time: fast mode, all hardware threads
+size_t BlockPitch = ch::GetBCRowPitch(Width, ch::BCFormat_BC1);
+void *Blocks = malloc(ch::GetBCImageSize(Width, Height, ch::BCFormat_BC1));
+ch::EncodeBC(Blocks, BlockPitch, Pixels, Width * 4, Width, Height, ch::BCFormat_BC1, ch::BCQuality_Fast, 0);
+
+// offline: high quality BC7, check what it cost
+ch::EncodeBC(Blocks, BlockPitch, Pixels, Width * 4, Width, Height, ch::BCFormat_BC7, ch::BCQuality_High, 0);
+ch::DecodeBC(Decoded, Width * 4, Blocks, BlockPitch, Width, Height, ch::BCFormat_BC7, 0);
+f64 PSNR = ch::ComputePSNR(Pixels, Width * 4, Decoded, Width * 4, Width, Height, ch::GetBCChannelCount(ch::BCFormat_BC7));
+
+Formats (D3D names, input is always RGBA8, rows of 4x4 blocks):
+
+BC1   8 bytes   RGB 565 endpoints + 2-bit indices, alpha < 128 becomes 1-bit punch-through
+BC3  16 bytes   BC4 style alpha block, then a BC1 color block (always 4-color)
+BC4   8 bytes   R only, 8-bit endpoints + 3-bit indices, decodes to (r, 0, 0, 255)
+BC5  16 bytes   two BC4 blocks, R then G, decodes to (r, g, 0, 255) (normal maps)
+BC7  16 bytes   8 modes of 1-3 partitioned subsets, the decoder does all of them
+
+Fast mode fits each block once along its principal axis and refines the endpoints
+with one least squares pass (BC7: mode 6 only, p-bits picked by how well they
+quantize the endpoints). High quality iterates the least squares fit, then nudges
+the quantized endpoints while the error goes down; BC4 walks its endpoints downhill
+from the min/max in both of its modes and BC7 also tries every p-bit choice and the
+best 2-subset partitions in modes 1, 3 and 7. Error is plain squared RGBA error.
+Blocks are independent, so threads split the rows of blocks.
+*/
+
+#include "ch_imgproc.h"
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#ifndef CH_BC7_PARTITION_CANDIDATES
+#define CH_BC7_PARTITION_CANDIDATES 4
+#endif
+
+namespace ch
+{
+    enum bc_format
+    {
+        BCFormat_BC1,
+        BCFormat_BC3,
+        BCFormat_BC4,
+        BCFormat_BC5,
+        BCFormat_BC7,
+    };
+    
+    enum bc_quality
+    {
+        BCQuality_Fast,
+        BCQuality_High,
+    };
+    
+    inline int
+        GetBCBlockSize(bc_format Format)
+    {
+        return (Format == BCFormat_BC1 || Format == BCFormat_BC4)? 8: 16;
+    }
+    
+    // channels the format actually stores, for PSNR
+    inline int
+        GetBCChannelCount(bc_format Format)
+    {
+        switch (Format)
+        {
+            case BCFormat_BC1: return 3;
+            case BCFormat_BC4: return 1;
+            case BCFormat_BC5: return 2;
+            default: return 4;
+        }
+    }
+    
+    inline size_t
+        GetBCRowPitch(int Width, bc_format Format)
+    {
+        return (size_t)((Width + 3) / 4) * GetBCBlockSize(Format);
+    }
+    
+    inline size_t
+        GetBCImageSize(int Width, int Height, bc_format Format)
+    {
+        return GetBCRowPitch(Width, Format) * (size_t)((Height + 3) / 4);
+    }
+    
+    //
+    //
+    // endpoint fitting shared by BC1 and BC7
+    
+    // line through the points along their principal axis, clipped to the extreme projections
+    inline void
+        FitPrincipalAxis(f32 Low[4], f32 High[4], const f32 (*Points)[4], int Count, int ChannelCount)
+    {
+        f32 Mean[4] = {};
+        for (int I = 0; I < Count; ++I)
+        {
+            for (int C = 0; C < ChannelCount; ++C) Mean[C] += Points[I][C];
+        }
+        for (int C = 0; C < ChannelCount; ++C) Mean[C] /= f32(Count);
+        
+        f32 Covariance[4][4] = {};
+        for (int I = 0; I < Count; ++I)
+        {
+            f32 D[4];
+            for (int C = 0; C < ChannelCount; ++C) D[C] = Points[I][C] - Mean[C];
+            for (int Row = 0; Row < ChannelCount; ++Row)
+            {
+                for (int Col = Row; Col < ChannelCount; ++Col) Covariance[Row][Col] += D[Row] * D[Col];
+            }
+        }
+        for (int Row = 0; Row < ChannelCount; ++Row)
+        {
+            for (int Col = 0; Col < Row; ++Col) Covariance[Row][Col] = Covariance[Col][Row];
+        }
+        
+        // power iteration, starting from the row of the widest channel
+        int Widest = 0;
+        for (int C = 1; C < ChannelCount; ++C)
+        {
+            if (Covariance[C][C] > Covariance[Widest][Widest]) Widest = C;
+        }
+        f32 Axis[4] = {};
+        for (int C = 0; C < ChannelCount; ++C) Axis[C] = Covariance[Widest][C];
+        for (int Iteration = 0; Iteration < 8; ++Iteration)
+        {
+            f32 Next[4] = {};
+            f32 Length = 0.0f;
+            for (int Row = 0; Row < ChannelCount; ++Row)
+            {
+                for (int Col = 0; Col < ChannelCount; ++Col) Next[Row] += Covariance[Row][Col] * Axis[Col];
+                Length = fmaxf(Length, fabsf(Next[Row]));
+            }
+            if (Length < 1e-12f) break;
+            for (int C = 0; C < ChannelCount; ++C) Axis[C] = Next[C] / Length;
+        }
+        
+        f32 LengthSq = 0.0f;
+        for (int C = 0; C < ChannelCount; ++C) LengthSq += Axis[C] * Axis[C];
+        f32 MinT = 0.0f, MaxT = 0.0f;
+        if (LengthSq > 1e-12f)
+        {
+            for (int C = 0; C < ChannelCount; ++C) Axis[C] /= sqrtf(LengthSq);
+            MinT = FLT_MAX;
+            MaxT = -FLT_MAX;
+            for (int I = 0; I < Count; ++I)
+            {
+                f32 T = 0.0f;
+                for (int C = 0; C < ChannelCount; ++C) T += (Points[I][C] - Mean[C]) * Axis[C];
+                MinT = fminf(MinT, T);
+                MaxT = fmaxf(MaxT, T);
+            }
+        }
+        for (int C = 0; C < ChannelCount; ++C)
+        {
+            Low[C] = fminf(fmaxf(Mean[C] + MinT * Axis[C], 0.0f), 255.0f);
+            High[C] = fminf(fmaxf(Mean[C] + MaxT * Axis[C], 0.0f), 255.0f);
+        }
+    }
+    
+    // least squares endpoints for points at fixed interpolation weights (0 = Low, 1 = High)
+    inline bool
+        SolveEndpoints(f32 Low[4], f32 High[4], const f32 (*Points)[4], const f32 *Weights, int Count, int ChannelCount)
+    {
+        f32 AA = 0.0f, AB = 0.0f, BB = 0.0f;
+        f32 AX[4] = {}, BX[4] = {};
+        for (int I = 0; I < Count; ++I)
+        {
+            f32 B = Weights[I];
+            f32 A = 1.0f - B;
+            AA += A * A;
+            AB += A * B;
+            BB += B * B;
+            for (int C = 0; C < ChannelCount; ++C)
+            {
+                AX[C] += A * Points[I][C];
+                BX[C] += B * Points[I][C];
+            }
+        }
+        
+        f32 Determinant = AA * BB - AB * AB;
+        if (fabsf(Determinant) < 1e-6f)
+        {
+            return false;
+        }
+        for (int C = 0; C < ChannelCount; ++C)
+        {
+            Low[C] = fminf(fmaxf((BB * AX[C] - AB * BX[C]) / Determinant, 0.0f), 255.0f);
+            High[C] = fminf(fmaxf((AA * BX[C] - AB * AX[C]) / Determinant, 0.0f), 255.0f);
+        }
+        return true;
+    }
+    
+    inline u32
+        TexelError(const u8 *A, const u8 *B, int ChannelCount)
+    {
+        u32 Error = 0;
+        for (int C = 0; C < ChannelCount; ++C)
+        {
+            int D = int(A[C]) - int(B[C]);
+            Error += u32(D * D);
+        }
+        return Error;
+    }
+    
+    // nearest palette entry for each texel, returns the summed error
+    inline u32
+        AssignIndices(u8 *Indices, const u8 (*Texels)[4], const u8 *Members, int MemberCount,
+                      const u8 (*Palette)[4], int PaletteSize, int ChannelCount)
+    {
+        u32 Total = 0;
+        for (int I = 0; I < MemberCount; ++I)
+        {
+            const u8 *Texel = Texels[Members[I]];
+            u32 BestError = UINT32_MAX;
+            int BestIndex = 0;
+            for (int P = 0; P < PaletteSize; ++P)
+            {
+                u32 Error = TexelError(Texel, Palette[P], ChannelCount);
+                if (Error < BestError)
+                {
+                    BestError = Error;
+                    BestIndex = P;
+                }
+            }
+            Indices[Members[I]] = (u8)BestIndex;
+            Total += BestError;
+        }
+        return Total;
+    }
+    
+    //NOTE(chen): Order lists the palette from endpoint 0 to endpoint 1. Texels are
+    //            projected onto that line and only the 3 nearest steps get tested,
+    //            close to the exhaustive search for a fraction of its cost.
+    inline u32
+        ProjectIndices(u8 *Indices, const u8 (*Texels)[4], const u8 *Members, int MemberCount,
+                       const u8 (*Palette)[4], const u8 *Order, int StepCount, int ChannelCount)
+    {
+        const u8 *First = Palette[Order[0]];
+        const u8 *Last = Palette[Order[StepCount - 1]];
+        int Direction[4] = {};
+        int LengthSq = 0;
+        for (int C = 0; C < ChannelCount; ++C)
+        {
+            Direction[C] = int(Last[C]) - int(First[C]);
+            LengthSq += Direction[C] * Direction[C];
+        }
+        f32 Scale = LengthSq? f32(StepCount - 1) / f32(LengthSq): 0.0f;
+        
+        u32 Total = 0;
+        for (int I = 0; I < MemberCount; ++I)
+        {
+            const u8 *Texel = Texels[Members[I]];
+            int Dot = 0;
+            for (int C = 0; C < ChannelCount; ++C) Dot += (int(Texel[C]) - int(First[C])) * Direction[C];
+            int Step = int(f32(Dot) * Scale + 0.5f);
+            Step = Step < 0? 0: (Step >= StepCount? StepCount - 1: Step);
+            
+            int FirstStep = Step > 0? Step - 1: 0;
+            int LastStep = Step + 1 < StepCount? Step + 1: Step;
+            u32 BestError = UINT32_MAX;
+            int BestIndex = 0;
+            for (int S = FirstStep; S <= LastStep; ++S)
+            {
+                u32 Error = TexelError(Texel, Palette[Order[S]], ChannelCount);
+                if (Error < BestError)
+                {
+                    BestError = Error;
+                    BestIndex = Order[S];
+                }
+            }
+            Indices[Members[I]] = (u8)BestIndex;
+            Total += BestError;
+        }
+        return Total;
+    }
+    
+    inline const u8 *
+        GetIdentityOrder()
+    {
+        static const u8 Order[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+        return Order;
+    }
+    
+    //
+    //
+    // BC1 color blocks
+    
+    inline void
+        ExpandRGB565(u8 Out[4], u16 Color)
+    {
+        u32 R = (Color >> 11) & 31, G = (Color >> 5) & 63, B = Color & 31;
+        Out[0] = u8((R << 3) | (R >> 2));
+        Out[1] = u8((G << 2) | (G >> 4));
+        Out[2] = u8((B << 3) | (B >> 2));
+        Out[3] = 255;
+    }
+    
+    inline u16
+        QuantizeRGB565(const f32 Color[4])
+    {
+        u32 R = u32(Color[0] * (31.0f / 255.0f) + 0.5f);
+        u32 G = u32(Color[1] * (63.0f / 255.0f) + 0.5f);
+        u32 B = u32(Color[2] * (31.0f / 255.0f) + 0.5f);
+        return u16((R << 11) | (G << 5) | B);
+    }
+    
+    // FourColor forces the opaque interpretation, BC3 color blocks are always read that way
+    inline void
+        GetBC1Palette(u8 Palette[4][4], u16 C0, u16 C1, bool FourColor)
+    {
+        ExpandRGB565(Palette[0], C0);
+        ExpandRGB565(Palette[1], C1);
+        if (C0 > C1 || FourColor)
+        {
+            for (int C = 0; C < 3; ++C)
+            {
+                Palette[2][C] = u8((2 * Palette[0][C] + Palette[1][C]) / 3);
+                Palette[3][C] = u8((Palette[0][C] + 2 * Palette[1][C]) / 3);
+            }
+            Palette[2][3] = Palette[3][3] = 255;
+        }
+        else
+        {
+            for (int C = 0; C < 3; ++C)
+            {
+                Palette[2][C] = u8((Palette[0][C] + Palette[1][C]) / 2);
+            }
+            Palette[2][3] = 255;
+            memset(Palette[3], 0, 4);
+        }
+    }
+    
+    // best 5 and 6-bit endpoint pairs whose 1/3 point lands on each 8-bit value
+    struct bc1_single_color_tables
+    {
+        u8 Match5[256][2];
+        u8 Match6[256][2];
+    };
+    
+    inline const bc1_single_color_tables *
+        GetBC1SingleColorTables()
+    {
+        struct table_init
+        {
+            bc1_single_color_tables Tables;
+            
+            static void
+                Build(u8 (*Match)[2], int Bits)
+            {
+                int Levels = 1 << Bits;
+                for (int Value = 0; Value < 256; ++Value)
+                {
+                    int BestError = INT32_MAX;
+                    for (int A = 0; A < Levels; ++A)
+                    {
+                        for (int B = 0; B < Levels; ++B)
+                        {
+                            int EA = Bits == 5? (A << 3) | (A >> 2): (A << 2) | (A >> 4);
+                            int EB = Bits == 5? (B << 3) | (B >> 2): (B << 2) | (B >> 4);
+                            // prefer close endpoints, hardware interpolation only approximates 1/3
+                            int Error = 256 * abs((2 * EA + EB) / 3 - Value) + abs(EA - EB);
+                            if (Error < BestError)
+                            {
+                                BestError = Error;
+                                Match[Value][0] = (u8)A;
+                                Match[Value][1] = (u8)B;
+                            }
+                        }
+                    }
+                }
+            }
+            
+            table_init()
+            {
+                Build(Tables.Match5, 5);
+                Build(Tables.Match6, 6);
+            }
+        };
+        static table_init Init; // thread safe since C++11
+        return &Init.Tables;
+    }
+    
+    inline void
+        WriteBC1Block(u8 *Out, u16 C0, u16 C1, const u8 Indices[16])
+    {
+        u32 Bits = 0;
+        for (int I = 0; I < 16; ++I) Bits |= u32(Indices[I]) << (2 * I);
+        Out[0] = u8(C0);
+        Out[1] = u8(C0 >> 8);
+        Out[2] = u8(C1);
+        Out[3] = u8(C1 >> 8);
+        memcpy(Out + 4, &Bits, 4);
+    }
+    
+    struct bc1_fit
+    {
+        u16 C0;
+        u16 C1;
+        u8 Indices[16];
+        u32 Error;
+    };
+    
+    // orders the endpoints for the mode, then indexes the opaque texels
+    inline bc1_fit
+        EvaluateBC1(u16 C0, u16 C1, const u8 (*Texels)[4], const u8 *Opaque, int OpaqueCount, u32 TransparentMask,
+                    bool ThreeColor, bool Exhaustive)
+    {
+        bc1_fit Fit = {};
+        if (ThreeColor? C0 > C1: C0 < C1)
+        {
+            u16 Swap = C0;
+            C0 = C1;
+            C1 = Swap;
+        }
+        Fit.C0 = C0;
+        Fit.C1 = C1;
+        
+        u8 Palette[4][4];
+        GetBC1Palette(Palette, C0, C1, false);
+        static const u8 FourColorOrder[4] = {0, 2, 3, 1};
+        static const u8 ThreeColorOrder[3] = {0, 2, 1};
+        int StepCount = C0 == C1? 1: (ThreeColor? 3: 4);
+        const u8 *Order = ThreeColor? ThreeColorOrder: FourColorOrder;
+        if (Exhaustive)
+        {
+            Fit.Error = AssignIndices(Fit.Indices, Texels, Opaque, OpaqueCount, Palette, StepCount == 4? 4: (StepCount == 3? 3: 1), 3);
+        }
+        else
+        {
+            Fit.Error = ProjectIndices(Fit.Indices, Texels, Opaque, OpaqueCount, Palette, Order, StepCount, 3);
+        }
+        for (int I = 0; I < 16; ++I)
+        {
+            if (TransparentMask & (1u << I)) Fit.Indices[I] = 3;
+        }
+        return Fit;
+    }
+    
+    //NOTE(chen): PunchThrough is for BC1 proper, texels with alpha < 128 go
+    //            transparent in the 3-color mode. BC3 color blocks always use 4 colors.
+    inline void
+        EncodeBC1Block(u8 *Out, const u8 (*Texels)[4], bool HighQuality, bool PunchThrough)
+    {
+        u8 Opaque[16];
+        int OpaqueCount = 0;
+        u32 TransparentMask = 0;
+        for (int I = 0; I < 16; ++I)
+        {
+            if (PunchThrough && Texels[I][3] < 128) TransparentMask |= 1u << I;
+            else Opaque[OpaqueCount++] = (u8)I;
+        }
+        bool ThreeColor = TransparentMask != 0;
+        
+        if (OpaqueCount == 0)
+        {
+            u8 Indices[16];
+            memset(Indices, 3, 16);
+            WriteBC1Block(Out, 0, 0, Indices);
+            return;
+        }
+        
+        bool Solid = true;
+        for (int I = 1; I < OpaqueCount; ++I)
+        {
+            Solid = Solid && memcmp(Texels[Opaque[I]], Texels[Opaque[0]], 3) == 0;
+        }
+        if (Solid && !ThreeColor)
+        {
+            const bc1_single_color_tables *Tables = GetBC1SingleColorTables();
+            const u8 *Color = Texels[0];
+            u16 C0 = u16((Tables->Match5[Color[0]][0] << 11) | (Tables->Match6[Color[1]][0] << 5) | Tables->Match5[Color[2]][0]);
+            u16 C1 = u16((Tables->Match5[Color[0]][1] << 11) | (Tables->Match6[Color[1]][1] << 5) | Tables->Match5[Color[2]][1]);
+            u8 Index = C0 > C1? 2: (C0 < C1? 3: 0);
+            if (C0 < C1)
+            {
+                u16 Swap = C0;
+                C0 = C1;
+                C1 = Swap;
+            }
+            u8 Indices[16];
+            memset(Indices, Index, 16);
+            WriteBC1Block(Out, C0, C1, Indices);
+            return;
+        }
+        
+        f32 Points[16][4];
+        for (int I = 0; I < OpaqueCount; ++I)
+        {
+            for (int C = 0; C < 3; ++C) Points[I][C] = Texels[Opaque[I]][C];
+        }
+        f32 Low[4], High[4];
+        FitPrincipalAxis(Low, High, Points, OpaqueCount, 3);
+        
+        bc1_fit Best = {};
+        Best.Error = UINT32_MAX;
+        int Iterations = HighQuality? 4: 2;
+        for (int Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            bc1_fit Fit = EvaluateBC1(QuantizeRGB565(High), QuantizeRGB565(Low), Texels, Opaque, OpaqueCount,
+                                      TransparentMask, ThreeColor, HighQuality);
+            if (Fit.Error < Best.Error)
+            {
+                Best = Fit;
+            }
+            if (Best.Error == 0 || Iteration + 1 == Iterations) break;
+            
+            // indices of the best fit so far, as weights from C1 (Low) to C0 (High)
+            const f32 FourWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+            const f32 ThreeWeights[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+            f32 Weights[16];
+            for (int I = 0; I < OpaqueCount; ++I)
+            {
+                u8 Index = Best.Indices[Opaque[I]];
+                Weights[I] = ThreeColor? ThreeWeights[Index]: FourWeights[Index];
+            }
+            if (!SolveEndpoints(Low, High, Points, Weights, OpaqueCount, 3)) break;
+        }
+        
+        if (HighQuality)
+        {
+            //NOTE(chen): least squares works on unquantized endpoints, a step of one
+            //            565 unit on a single channel can still help after rounding
+            const u16 Steps[3] = {1 << 11, 1 << 5, 1};
+            const u16 Masks[3] = {31 << 11, 63 << 5, 31};
+            bool Improved = true;
+            for (int Pass = 0; Pass < 8 && Improved && Best.Error; ++Pass)
+            {
+                Improved = false;
+                for (int Endpoint = 0; Endpoint < 2; ++Endpoint)
+                {
+                    for (int Channel = 0; Channel < 3; ++Channel)
+                    {
+                        for (int Direction = -1; Direction <= 1; Direction += 2)
+                        {
+                            u16 Color = Endpoint? Best.C1: Best.C0;
+                            int Field = (Color & Masks[Channel]) / Steps[Channel] + Direction;
+                            if (Field < 0 || Field > int(Masks[Channel] / Steps[Channel])) continue;
+                            Color = u16((Color & ~Masks[Channel]) | (Field * Steps[Channel]));
+                            bc1_fit Fit = EvaluateBC1(Endpoint? Best.C0: Color, Endpoint? Color: Best.C1,
+                                                      Texels, Opaque, OpaqueCount, TransparentMask, ThreeColor, true);
+                            if (Fit.Error < Best.Error)
+                            {
+                                Best = Fit;
+                                Improved = true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        
+        WriteBC1Block(Out, Best.C0, Best.C1, Best.Indices);
+    }
+    
+    inline void
+        DecodeBC1Block(u8 (*Texels)[4], const u8 *Block, bool FourColor)
+    {
+        u16 C0 = u16(Block[0] | (Block[1] << 8));
+        u16 C1 = u16(Block[2] | (Block[3] << 8));
+        u32 Bits;
+        memcpy(&Bits, Block + 4, 4);
+        u8 Palette[4][4];
+        GetBC1Palette(Palette, C0, C1, FourColor);
+        for (int I = 0; I < 16; ++I)
+        {
+            memcpy(Texels[I], Palette[(Bits >> (2 * I)) & 3], 4);
+        }
+    }
+    
+    //
+    //
+    // BC4 single channel blocks
+    
+    inline void
+        GetBC4Palette(u8 Palette[8], u8 A0, u8 A1)
+    {
+        Palette[0] = A0;
+        Palette[1] = A1;
+        if (A0 > A1)
+        {
+            for (int I = 1; I < 7; ++I) Palette[I + 1] = u8(((7 - I) * A0 + I * A1) / 7);
+        }
+        else
+        {
+            for (int I = 1; I < 5; ++I) Palette[I + 1] = u8(((5 - I) * A0 + I * A1) / 5);
+            Palette[6] = 0;
+            Palette[7] = 255;
+        }
+    }
+    
+    // returns the squared error, the 48 index bits go to *IndexBits
+    inline u32
+        EvaluateBC4(u64 *IndexBits, const u8 Values[16], u8 A0, u8 A1)
+    {
+        u8 Palette[8];
+        GetBC4Palette(Palette, A0, A1);
+        
+        // palette entries from the low to the high endpoint, 0 and 255 are extra in the 6 value mode
+        static const u8 EightOrder[8] = {1, 7, 6, 5, 4, 3, 2, 0};
+        static const u8 SixOrder[6] = {0, 2, 3, 4, 5, 1};
+        bool EightValues = A0 > A1;
+        const u8 *Order = EightValues? EightOrder: SixOrder;
+        int StepCount = EightValues? 8: 6;
+        int Low = EightValues? A1: A0;
+        int Range = EightValues? A0 - A1: A1 - A0;
+        f32 Scale = Range? f32(StepCount - 1) / f32(Range): 0.0f;
+        
+        u64 Bits = 0;
+        u32 Total = 0;
+        for (int I = 0; I < 16; ++I)
+        {
+            int Value = Values[I];
+            int Step = int(f32(Value - Low) * Scale + 0.5f);
+            Step = Step < 0? 0: (Step >= StepCount? StepCount - 1: Step);
+            
+            // palette entries are truncated, the neighbors can be closer
+            u32 BestError = UINT32_MAX;
+            u32 BestIndex = 0;
+            int FirstStep = Step > 0? Step - 1: 0;
+            int LastStep = Step + 1 < StepCount? Step + 1: Step;
+            for (int S = FirstStep; S <= LastStep; ++S)
+            {
+                int D = Value - int(Palette[Order[S]]);
+                if (u32(D * D) < BestError)
+                {
+                    BestError = u32(D * D);
+                    BestIndex = Order[S];
+                }
+            }
+            if (!EightValues)
+            {
+                if (u32(Value * Value) < BestError)
+                {
+                    BestError = u32(Value * Value);
+                    BestIndex = 6;
+                }
+                if (u32((255 - Value) * (255 - Value)) < BestError)
+                {
+                    BestError = u32((255 - Value) * (255 - Value));
+                    BestIndex = 7;
+                }
+            }
+            Bits |= u64(BestIndex) << (3 * I);
+            Total += BestError;
+        }
+        *IndexBits = Bits;
+        return Total;
+    }
+    
+    inline void
+        EncodeBC4Block(u8 *Out, const u8 Values[16], bool HighQuality)
+    {
+        int Min = 255, Max = 0;
+        int InnerMin = 255, InnerMax = 0; // ignoring 0 and 255, which the 6 value mode has for free
+        for (int I = 0; I < 16; ++I)
+        {
+            Min = Values[I] < Min? Values[I]: Min;
+            Max = Values[I] > Max? Values[I]: Max;
+            if (Values[I] != 0 && Values[I] != 255)
+            {
+                InnerMin = Values[I] < InnerMin? Values[I]: InnerMin;
+                InnerMax = Values[I] > InnerMax? Values[I]: InnerMax;
+            }
+        }
+        
+        // 8 value mode wants A0 > A1, equal endpoints fall into the 6 value mode, which is fine for flat blocks
+        u8 A0 = (u8)Max, A1 = (u8)Min;
+        u64 Bits;
+        u32 BestError = EvaluateBC4(&Bits, Values, A0, A1);
+        
+        if (HighQuality && BestError)
+        {
+            if (InnerMin > InnerMax)
+            {
+                InnerMin = InnerMax = Min;
+            }
+            //NOTE(chen): coordinate descent on both endpoints, big steps first. The 8 value
+            //            mode starts from the full range, the 6 value mode from the range
+            //            without 0 and 255
+            for (int Mode = 0; Mode < 2; ++Mode)
+            {
+                int Low = Mode == 0? Min: InnerMin;
+                int High = Mode == 0? Max: InnerMax;
+                u64 ModeBits;
+                u32 ModeError = (Mode == 0 && Low == High)? UINT32_MAX:
+                    EvaluateBC4(&ModeBits, Values, u8(Mode == 0? High: Low), u8(Mode == 0? Low: High));
+                for (int Step = 4; Step >= 1; Step /= 4)
+                {
+                    bool Improved = true;
+                    while (Improved)
+                    {
+                        Improved = false;
+                        for (int Move = 0; Move < 4; ++Move)
+                        {
+                            int D = (Move & 1)? Step: -Step;
+                            int L = Low + ((Move & 2)? 0: D);
+                            int H = High + ((Move & 2)? D: 0);
+                            if (L < 0 || H > 255 || L > H) continue;
+                            if (Mode == 0 && L == H) continue;
+                            u64 CandidateBits;
+                            u32 Error = EvaluateBC4(&CandidateBits, Values, u8(Mode == 0? H: L), u8(Mode == 0? L: H));
+                            if (Error < ModeError)
+                            {
+                                ModeError = Error;
+                                ModeBits = CandidateBits;
+                                Low = L;
+                                High = H;
+                                Improved = true;
+                            }
+                        }
+                    }
+                }
+                if (ModeError < BestError)
+                {
+                    BestError = ModeError;
+                    Bits = ModeBits;
+                    A0 = u8(Mode == 0? High: Low);
+                    A1 = u8(Mode == 0? Low: High);
+                }
+            }
+        }
+        
+        Out[0] = A0;
+        Out[1] = A1;
+        for (int I = 0; I < 6; ++I) Out[2 + I] = u8(Bits >> (8 * I));
+    }
+    
+    // writes Values[I] into Texels[I][Channel]
+    inline void
+        DecodeBC4Block(u8 (*Texels)[4], int Channel, const u8 *Block)
+    {
+        u8 Palette[8];
+        GetBC4Palette(Palette, Block[0], Block[1]);
+        u64 Bits = 0;
+        for (int I = 0; I < 6; ++I) Bits |= u64(Block[2 + I]) << (8 * I);
+        for (int I = 0; I < 16; ++I)
+        {
+            Texels[I][Channel] = Palette[(Bits >> (3 * I)) & 7];
+        }
+    }
+    
+    //
+    //
+    // BC7
+    
+    struct bc7_mode_info
+    {
+        u8 SubsetCount;
+        u8 PartitionBits;
+        u8 RotationBits;
+        u8 IndexSelectionBits;
+        u8 ColorBits;
+        u8 AlphaBits;
+        u8 EndpointPBits; // one p-bit per endpoint
+        u8 SharedPBits;   // one p-bit per subset
+        u8 IndexBits;
+        u8 AlphaIndexBits; // second index set, modes 4 and 5
+    };
+    
+    inline const bc7_mode_info *
+        GetBC7ModeInfo(int Mode)
+    {
+        static const bc7_mode_info Modes[8] = {
+            {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+            {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+            {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+            {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+            {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+            {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+            {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+            {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+        };
+        return &Modes[Mode];
+    }
+    
+    inline int
+        GetBC7Subset(int SubsetCount, int Partition, int TexelI)
+    {
+        // bit per texel, texel 0 lowest
+        static const u16 Partitions2[64] = {
+            0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+            0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+            0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+            0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+            0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+            0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+            0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+            0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+        };
+        // 2 bits per texel
+        static const u32 Partitions3[64] = {
+            0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+            0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+            0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+            0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+            0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+            0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+            0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+            0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+        };
+        if (SubsetCount == 2) return (Partitions2[Partition] >> TexelI) & 1;
+        if (SubsetCount == 3) return (Partitions3[Partition] >> (2 * TexelI)) & 3;
+        return 0;
+    }
+    
+    // anchor texels store their index without the top bit (which is always 0)
+    inline bool
+        IsBC7Anchor(int SubsetCount, int Partition, int TexelI)
+    {
+        static const u8 Anchors2[64] = {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+            15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+            15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+             6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+        };
+        static const u8 Anchors3Second[64] = {
+             3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+             3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+             8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+             3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+        };
+        static const u8 Anchors3Third[64] = {
+            15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+            15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+            15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+            15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+        };
+        if (TexelI == 0) return true;
+        if (SubsetCount == 2) return TexelI == Anchors2[Partition];
+        if (SubsetCount == 3) return TexelI == Anchors3Second[Partition] || TexelI == Anchors3Third[Partition];
+        return false;
+    }
+    
+    inline int
+        GetBC7Anchor(int SubsetCount, int Partition, int Subset)
+    {
+        for (int I = 0; I < 16; ++I)
+        {
+            if (GetBC7Subset(SubsetCount, Partition, I) == Subset && IsBC7Anchor(SubsetCount, Partition, I)) return I;
+        }
+        return 0;
+    }
+    
+    inline const u8 *
+        GetBC7Weights(int IndexBits)
+    {
+        static const u8 Weights2[4] = {0, 21, 43, 64};
+        static const u8 Weights3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+        static const u8 Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+        return IndexBits == 2? Weights2: (IndexBits == 3? Weights3: Weights4);
+    }
+    
+    // a block with its fields pulled out of the bitstream
+    struct bc7_block
+    {
+        int Mode; // -1 for the reserved encoding, which decodes to transparent black
+        int Partition;
+        int Rotation;
+        int IndexSelection;
+        u8 Endpoints[3][2][4]; // [subset][endpoint][channel], quantized, without p-bits
+        u8 PBits[3][2];
+        u8 Indices[2][16]; // set 1 only in modes 4 and 5
+    };
+    
+    struct bc7_bit_stream
+    {
+        u64 Low;
+        u64 High;
+        int Position;
+        
+        u32
+            Read(int Count)
+        {
+            u64 Value = Position >= 64? High >> (Position - 64): Low >> Position;
+            if (Position < 64 && Position + Count > 64) Value |= High << (64 - Position);
+            Position += Count;
+            return u32(Value & ((1ull << Count) - 1));
+        }
+        
+        void
+            Write(u32 Value, int Count)
+        {
+            u64 Bits = u64(Value) & ((1ull << Count) - 1);
+            if (Position >= 64) High |= Bits << (Position - 64);
+            else
+            {
+                Low |= Bits << Position;
+                if (Position + Count > 64) High |= Bits >> (64 - Position);
+            }
+            Position += Count;
+        }
+    };
+    
+    // both directions walk the same field order, Write selects which way
+    inline void
+        TransferBC7Fields(bc7_block *Block, bc7_bit_stream *Stream, bool Write)
+    {
+        const bc7_mode_info *Info = GetBC7ModeInfo(Block->Mode);
+        auto Field = [&](u32 Value, int Count) -> u32
+        {
+            if (Write)
+            {
+                Stream->Write(Value, Count);
+                return Value;
+            }
+            return Stream->Read(Count);
+        };
+        
+        Field(1u << Block->Mode, Block->Mode + 1);
+        Block->Partition = (int)Field(Block->Partition, Info->PartitionBits);
+        Block->Rotation = (int)Field(Block->Rotation, Info->RotationBits);
+        Block->IndexSelection = (int)Field(Block->IndexSelection, Info->IndexSelectionBits);
+        int ChannelCount = Info->AlphaBits? 4: 3;
+        for (int C = 0; C < ChannelCount; ++C)
+        {
+            int Bits = C < 3? Info->ColorBits: Info->AlphaBits;
+            for (int S = 0; S < Info->SubsetCount; ++S)
+            {
+                for (int E = 0; E < 2; ++E) Block->Endpoints[S][E][C] = (u8)Field(Block->Endpoints[S][E][C], Bits);
+            }
+        }
+        for (int S = 0; S < Info->SubsetCount; ++S)
+        {
+            if (Info->EndpointPBits)
+            {
+                for (int E = 0; E < 2; ++E) Block->PBits[S][E] = (u8)Field(Block->PBits[S][E], 1);
+            }
+            else if (Info->SharedPBits)
+            {
+                Block->PBits[S][0] = Block->PBits[S][1] = (u8)Field(Block->PBits[S][0], 1);
+            }
+        }
+        for (int I = 0; I < 16; ++I)
+        {
+            int Bits = Info->IndexBits - IsBC7Anchor(Info->SubsetCount, Block->Partition, I);
+            Block->Indices[0][I] = (u8)Field(Block->Indices[0][I], Bits);
+        }
+        if (Info->AlphaIndexBits)
+        {
+            for (int I = 0; I < 16; ++I)
+            {
+                Block->Indices[1][I] = (u8)Field(Block->Indices[1][I], Info->AlphaIndexBits - (I == 0));
+            }
+        }
+    }
+    
+    inline void
+        UnpackBC7Block(bc7_block *Block, const u8 *Data)
+    {
+        *Block = {};
+        Block->Mode = -1;
+        for (int Mode = 0; Mode < 8; ++Mode)
+        {
+            if (Data[0] & (1 << Mode))
+            {
+                Block->Mode = Mode;
+                break;
+            }
+        }
+        if (Block->Mode < 0) return;
+        
+        bc7_bit_stream Stream = {};
+        memcpy(&Stream.Low, Data, 8);
+        memcpy(&Stream.High, Data + 8, 8);
+        TransferBC7Fields(Block, &Stream, false);
+    }
+    
+    inline void
+        PackBC7Block(u8 *Data, bc7_block *Block)
+    {
+        bc7_bit_stream Stream = {};
+        TransferBC7Fields(Block, &Stream, true);
+        memcpy(Data, &Stream.Low, 8);
+        memcpy(Data + 8, &Stream.High, 8);
+    }
+    
+    // Bits wide value (p-bit included) to 8 bits, top bits repeat into the bottom
+    inline u8
+        ExpandBC7(u32 Value, int Bits)
+    {
+        Value <<= 8 - Bits;
+        return u8(Value | (Value >> Bits));
+    }
+    
+    // endpoint expanded to 8 bits per channel, alpha is 255 in the color only modes
+    inline void
+        GetBC7Endpoint(u8 Out[4], const bc7_block *Block, int Subset, int Endpoint)
+    {
+        const bc7_mode_info *Info = GetBC7ModeInfo(Block->Mode);
+        bool HasPBit = Info->EndpointPBits || Info->SharedPBits;
+        for (int C = 0; C < 4; ++C)
+        {
+            int Bits = C < 3? Info->ColorBits: Info->AlphaBits;
+            if (!Bits)
+            {
+                Out[C] = 255;
+                continue;
+            }
+            u32 Value = Block->Endpoints[Subset][Endpoint][C];
+            if (HasPBit)
+            {
+                Value = (Value << 1) | Block->PBits[Subset][Endpoint];
+                ++Bits;
+            }
+            Out[C] = ExpandBC7(Value, Bits);
+        }
+    }
+    
+    inline u8
+        InterpolateBC7(u8 E0, u8 E1, int Weight)
+    {
+        return u8(((64 - Weight) * E0 + Weight * E1 + 32) >> 6);
+    }
+    
+    // every mode has 2 to 4 index bits, the clamp lets the compiler see Palette's size too
+    inline void
+        GetBC7Palette(u8 Palette[16][4], const u8 E0[4], const u8 E1[4], int IndexBits)
+    {
+        assert(IndexBits >= 2 && IndexBits <= 4);
+        if (IndexBits > 4) IndexBits = 4;
+        const u8 *Weights = GetBC7Weights(IndexBits);
+        for (int I = 0; I < (1 << IndexBits); ++I)
+        {
+            for (int C = 0; C < 4; ++C) Palette[I][C] = InterpolateBC7(E0[C], E1[C], Weights[I]);
+        }
+    }
+    
+    inline void
+        DecodeBC7Block(u8 (*Texels)[4], const u8 *Data)
+    {
+        bc7_block Block;
+        UnpackBC7Block(&Block, Data);
+        if (Block.Mode < 0)
+        {
+            memset(Texels, 0, 64);
+            return;
+        }
+        
+        const bc7_mode_info *Info = GetBC7ModeInfo(Block.Mode);
+        u8 Endpoints[3][2][4];
+        for (int S = 0; S < Info->SubsetCount; ++S)
+        {
+            GetBC7Endpoint(Endpoints[S][0], &Block, S, 0);
+            GetBC7Endpoint(Endpoints[S][1], &Block, S, 1);
+        }
+        
+        int ColorSet = Block.IndexSelection? 1: 0;
+        int ColorBits = Block.IndexSelection? Info->AlphaIndexBits: Info->IndexBits;
+        int AlphaBits = Block.IndexSelection? Info->IndexBits: Info->AlphaIndexBits;
+        const u8 *ColorWeights = GetBC7Weights(ColorBits);
+        const u8 *AlphaWeights = GetBC7Weights(AlphaBits ? AlphaBits: 2);
+        for (int I = 0; I < 16; ++I)
+        {
+            int S = GetBC7Subset(Info->SubsetCount, Block.Partition, I);
+            int Weight = ColorWeights[Block.Indices[ColorSet][I]];
+            u8 *Texel = Texels[I];
+            for (int C = 0; C < 4; ++C)
+            {
+                Texel[C] = InterpolateBC7(Endpoints[S][0][C], Endpoints[S][1][C], Weight);
+            }
+            if (Info->AlphaIndexBits)
+            {
+                Texel[3] = InterpolateBC7(Endpoints[S][0][3], Endpoints[S][1][3], AlphaWeights[Block.Indices[1 - ColorSet][I]]);
+            }
+            if (Block.Rotation)
+            {
+                u8 Swap = Texel[3];
+                Texel[3] = Texel[Block.Rotation - 1];
+                Texel[Block.Rotation - 1] = Swap;
+            }
+        }
+    }
+    
+    // quantized channel value whose expansion is closest to Value
+    inline u8
+        QuantizeBC7(f32 Value, int Bits, int PBit)
+    {
+        if (PBit < 0)
+        {
+            int Max = (1 << Bits) - 1;
+            int Q = int(Value * f32(Max) / 255.0f + 0.5f);
+            return u8(Q < 0? 0: (Q > Max? Max: Q));
+        }
+        f32 Scaled = Value * f32((2 << Bits) - 1) / 255.0f;
+        int Q = int((Scaled - f32(PBit)) * 0.5f + 0.5f);
+        int Max = (1 << Bits) - 1;
+        return u8(Q < 0? 0: (Q > Max? Max: Q));
+    }
+    
+    struct bc7_subset_fit
+    {
+        u8 Endpoints[2][4];
+        u8 PBits[2];
+        u8 Indices[16];
+        u32 Error;
+    };
+    
+    // palette from the fit's endpoints in *Block's mode, then indices for the members
+    inline void
+        EvaluateBC7Subset(bc7_subset_fit *Fit, const bc7_block *Block, const u8 (*Texels)[4],
+                          const u8 *Members, int MemberCount, int ChannelCount, bool Exhaustive)
+    {
+        bc7_block Scratch;
+        Scratch.Mode = Block->Mode;
+        memcpy(Scratch.Endpoints[0], Fit->Endpoints, sizeof(Fit->Endpoints));
+        Scratch.PBits[0][0] = Fit->PBits[0];
+        Scratch.PBits[0][1] = Fit->PBits[1];
+        u8 E0[4], E1[4];
+        GetBC7Endpoint(E0, &Scratch, 0, 0);
+        GetBC7Endpoint(E1, &Scratch, 0, 1);
+        
+        const bc7_mode_info *Info = GetBC7ModeInfo(Block->Mode);
+        u8 Palette[16][4];
+        GetBC7Palette(Palette, E0, E1, Info->IndexBits);
+        if (Exhaustive)
+        {
+            Fit->Error = AssignIndices(Fit->Indices, Texels, Members, MemberCount, Palette, 1 << Info->IndexBits, ChannelCount);
+        }
+        else
+        {
+            Fit->Error = ProjectIndices(Fit->Indices, Texels, Members, MemberCount, Palette, GetIdentityOrder(),
+                                        1 << Info->IndexBits, ChannelCount);
+        }
+    }
+    
+    //NOTE(chen): quantizes float endpoints under each allowed p-bit choice and keeps
+    //            the best into *Best. With AllPBits off only the choice that quantizes
+    //            the endpoints themselves closest gets a palette evaluation.
+    inline void
+        TryBC7Endpoints(bc7_subset_fit *Best, const bc7_block *Block, const f32 Low[4], const f32 High[4],
+                        const u8 (*Texels)[4], const u8 *Members, int MemberCount, int ChannelCount, bool AllPBits)
+    {
+        const bc7_mode_info *Info = GetBC7ModeInfo(Block->Mode);
+        int Combinations = Info->EndpointPBits? 4: (Info->SharedPBits? 2: 1);
+        bool HasPBit = Combinations > 1;
+        bc7_subset_fit Fits[4];
+        f32 QuantizationErrors[4];
+        int Closest = 0;
+        for (int Combination = 0; Combination < Combinations; ++Combination)
+        {
+            bc7_subset_fit *Fit = &Fits[Combination];
+            Fit->PBits[0] = u8(Combination & 1);
+            Fit->PBits[1] = u8(Info->EndpointPBits? Combination >> 1: Combination & 1);
+            QuantizationErrors[Combination] = 0.0f;
+            for (int C = 0; C < 4; ++C)
+            {
+                int Bits = C < 3? Info->ColorBits: Info->AlphaBits;
+                for (int E = 0; E < 2; ++E)
+                {
+                    f32 Target = E? High[C]: Low[C];
+                    u8 Value = Bits? QuantizeBC7(Target, Bits, HasPBit? Fit->PBits[E]: -1): 0;
+                    Fit->Endpoints[E][C] = Value;
+                    if (Bits && C < ChannelCount)
+                    {
+                        f32 D = f32(HasPBit? ExpandBC7((Value << 1) | Fit->PBits[E], Bits + 1): ExpandBC7(Value, Bits)) - Target;
+                        QuantizationErrors[Combination] += D * D;
+                    }
+                }
+            }
+            if (QuantizationErrors[Combination] < QuantizationErrors[Closest]) Closest = Combination;
+        }
+        
+        for (int Combination = 0; Combination < Combinations; ++Combination)
+        {
+            if (!AllPBits && Combination != Closest) continue;
+            bc7_subset_fit *Fit = &Fits[Combination];
+            EvaluateBC7Subset(Fit, Block, Texels, Members, MemberCount, ChannelCount, false);
+            if (Fit->Error < Best->Error)
+            {
+                *Best = *Fit;
+            }
+        }
+    }
+    
+    inline u32
+        FitBC7Subset(bc7_block *Block, int Subset, const u8 (*Texels)[4], const u8 *Members, int MemberCount, bool HighQuality)
+    {
+        const bc7_mode_info *Info = GetBC7ModeInfo(Block->Mode);
+        int ChannelCount = Info->AlphaBits? 4: 3;
+        
+        f32 Points[16][4];
+        for (int I = 0; I < MemberCount; ++I)
+        {
+            for (int C = 0; C < 4; ++C) Points[I][C] = Texels[Members[I]][C];
+        }
+        f32 Low[4] = {}, High[4] = {};
+        FitPrincipalAxis(Low, High, Points, MemberCount, ChannelCount);
+        
+        bc7_subset_fit Best = {};
+        Best.Error = UINT32_MAX;
+        const u8 *Weights = GetBC7Weights(Info->IndexBits);
+        int Iterations = HighQuality? 4: 2;
+        for (int Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            TryBC7Endpoints(&Best, Block, Low, High, Texels, Members, MemberCount, ChannelCount, HighQuality);
+            if (Best.Error == 0 || Iteration + 1 == Iterations) break;
+            
+            f32 FitWeights[16];
+            for (int I = 0; I < MemberCount; ++I) FitWeights[I] = Weights[Best.Indices[Members[I]]] / 64.0f;
+            if (!SolveEndpoints(Low, High, Points, FitWeights, MemberCount, ChannelCount)) break;
+        }
+        
+        if (HighQuality)
+        {
+            // one quantization step at a time on each endpoint channel, p-bits stay
+            bool Improved = true;
+            for (int Pass = 0; Pass < 4 && Improved && Best.Error; ++Pass)
+            {
+                Improved = false;
+                for (int E = 0; E < 2; ++E)
+                {
+                    for (int C = 0; C < ChannelCount; ++C)
+                    {
+                        int Max = (1 << (C < 3? Info->ColorBits: Info->AlphaBits)) - 1;
+                        for (int Direction = -1; Direction <= 1; Direction += 2)
+                        {
+                            int Value = Best.Endpoints[E][C] + Direction;
+                            if (Value < 0 || Value > Max) continue;
+                            bc7_subset_fit Fit = Best;
+                            Fit.Endpoints[E][C] = (u8)Value;
+                            EvaluateBC7Subset(&Fit, Block, Texels, Members, MemberCount, ChannelCount, false);
+                            if (Fit.Error < Best.Error)
+                            {
+                                Best = Fit;
+                                Improved = true;
+                            }
+                        }
+                    }
+                }
+            }
+            
+            // the search indexes by projection, the final endpoints get the exact nearest entries
+            EvaluateBC7Subset(&Best, Block, Texels, Members, MemberCount, ChannelCount, true);
+        }
+        
+        memcpy(Block->Endpoints[Subset], Best.Endpoints, sizeof(Best.Endpoints));
+        Block->PBits[Subset][0] = Best.PBits[0];
+        Block->PBits[Subset][1] = Best.PBits[1];
+        for (int I = 0; I < MemberCount; ++I)
+        {
+            Block->Indices[0][Members[I]] = Best.Indices[Members[I]];
+        }
+        return Best.Error;
+    }
+    
+    // fits every subset of Mode/Partition into *Block, returns the block's error
+    inline u32
+        EncodeBC7Mode(bc7_block *Block, const u8 (*Texels)[4], int Mode, int Partition, bool HighQuality)
+    {
+        *Block = {};
+        Block->Mode = Mode;
+        Block->Partition = Partition;
+        const bc7_mode_info *Info = GetBC7ModeInfo(Mode);
+        
+        u32 Error = 0;
+        for (int S = 0; S < Info->SubsetCount; ++S)
+        {
+            u8 Members[16];
+            int MemberCount = 0;
+            for (int I = 0; I < 16; ++I)
+            {
+                if (GetBC7Subset(Info->SubsetCount, Partition, I) == S) Members[MemberCount++] = (u8)I;
+            }
+            Error += FitBC7Subset(Block, S, Texels, Members, MemberCount, HighQuality);
+            
+            // the anchor's top index bit isn't stored, flip the subset if it's set
+            int Anchor = GetBC7Anchor(Info->SubsetCount, Partition, S);
+            int MaxIndex = (1 << Info->IndexBits) - 1;
+            if (Block->Indices[0][Anchor] > MaxIndex / 2)
+            {
+                for (int C = 0; C < 4; ++C)
+                {
+                    u8 Swap = Block->Endpoints[S][0][C];
+                    Block->Endpoints[S][0][C] = Block->Endpoints[S][1][C];
+                    Block->Endpoints[S][1][C] = Swap;
+                }
+                u8 Swap = Block->PBits[S][0];
+                Block->PBits[S][0] = Block->PBits[S][1];
+                Block->PBits[S][1] = Swap;
+                for (int I = 0; I < MemberCount; ++I)
+                {
+                    Block->Indices[0][Members[I]] = u8(MaxIndex - Block->Indices[0][Members[I]]);
+                }
+            }
+        }
+        return Error;
+    }
+    
+    // squared distance of each subset to its own best fit line, summed
+    inline f32
+        EstimateBC7PartitionError(const u8 (*Texels)[4], int SubsetCount, int Partition, int ChannelCount)
+    {
+        f32 Total = 0.0f;
+        for (int S = 0; S < SubsetCount; ++S)
+        {
+            f32 Sum[4] = {}, Products[4][4] = {};
+            int Count = 0;
+            for (int I = 0; I < 16; ++I)
+            {
+                if (GetBC7Subset(SubsetCount, Partition, I) != S) continue;
+                ++Count;
+                for (int Row = 0; Row < ChannelCount; ++Row)
+                {
+                    Sum[Row] += Texels[I][Row];
+                    for (int Col = Row; Col < ChannelCount; ++Col) Products[Row][Col] += f32(Texels[I][Row] * Texels[I][Col]);
+                }
+            }
+            
+            f32 Covariance[4][4];
+            f32 Trace = 0.0f;
+            for (int Row = 0; Row < ChannelCount; ++Row)
+            {
+                for (int Col = Row; Col < ChannelCount; ++Col)
+                {
+                    Covariance[Row][Col] = Covariance[Col][Row] = Products[Row][Col] - Sum[Row] * Sum[Col] / f32(Count);
+                }
+                Trace += Covariance[Row][Row];
+            }
+            
+            // largest eigenvalue by power iteration, the rest is what a line can't fit
+            f32 Axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+            f32 Eigenvalue = 0.0f;
+            for (int Iteration = 0; Iteration < 4; ++Iteration)
+            {
+                f32 Next[4] = {};
+                f32 Length = 0.0f;
+                for (int Row = 0; Row < ChannelCount; ++Row)
+                {
+                    for (int Col = 0; Col < ChannelCount; ++Col) Next[Row] += Covariance[Row][Col] * Axis[Col];
+                    Length += Next[Row] * Next[Row];
+                }
+                if (Length < 1e-12f) break;
+                Length = sqrtf(Length);
+                for (int C = 0; C < ChannelCount; ++C) Axis[C] = Next[C] / Length;
+                Eigenvalue = Length;
+            }
+            Total += fmaxf(Trace - Eigenvalue, 0.0f);
+        }
+        return Total;
+    }
+    
+    inline void
+        EncodeBC7Block(u8 *Out, const u8 (*Texels)[4], bool HighQuality)
+    {
+        bool Opaque = true;
+        for (int I = 0; I < 16; ++I) Opaque = Opaque && Texels[I][3] == 255;
+        
+        bc7_block Best, Candidate;
+        u32 BestError = EncodeBC7Mode(&Best, Texels, 6, 0, HighQuality);
+        
+        if (HighQuality && BestError)
+        {
+            // rank the 2-subset partitions by how well two lines fit them, encode the best few
+            int ChannelCount = Opaque? 3: 4;
+            int Candidates[CH_BC7_PARTITION_CANDIDATES];
+            f32 CandidateErrors[CH_BC7_PARTITION_CANDIDATES];
+            int CandidateCount = 0;
+            for (int Partition = 0; Partition < 64; ++Partition)
+            {
+                f32 Estimate = EstimateBC7PartitionError(Texels, 2, Partition, ChannelCount);
+                int Slot = CandidateCount < CH_BC7_PARTITION_CANDIDATES? CandidateCount++: CH_BC7_PARTITION_CANDIDATES;
+                while (Slot > 0 && Estimate < CandidateErrors[Slot - 1])
+                {
+                    if (Slot < CH_BC7_PARTITION_CANDIDATES)
+                    {
+                        Candidates[Slot] = Candidates[Slot - 1];
+                        CandidateErrors[Slot] = CandidateErrors[Slot - 1];
+                    }
+                    --Slot;
+                }
+                if (Slot < CH_BC7_PARTITION_CANDIDATES)
+                {
+                    Candidates[Slot] = Partition;
+                    CandidateErrors[Slot] = Estimate;
+                }
+            }
+            
+            const int OpaqueModes[2] = {1, 3};
+            const int AlphaModes[1] = {7};
+            const int *Modes = Opaque? OpaqueModes: AlphaModes;
+            int ModeCount = Opaque? 2: 1;
+            for (int CandidateI = 0; CandidateI < CandidateCount; ++CandidateI)
+            {
+                for (int ModeI = 0; ModeI < ModeCount; ++ModeI)
+                {
+                    u32 Error = EncodeBC7Mode(&Candidate, Texels, Modes[ModeI], Candidates[CandidateI], true);
+                    if (Error < BestError)
+                    {
+                        BestError = Error;
+                        Best = Candidate;
+                    }
+                }
+            }
+        }
+        
+        PackBC7Block(Out, &Best);
+    }
+    
+    //
+    //
+    // blocks and images
+    
+    // 4x4 texels at block (BlockX, BlockY), edges clamp
+    inline void
+        LoadBCBlock(u8 (*Texels)[4], const u8 *Pixels, size_t Pitch, int Width, int Height, int BlockX, int BlockY)
+    {
+        for (int Y = 0; Y < 4; ++Y)
+        {
+            int PY = BlockY * 4 + Y;
+            PY = PY < Height? PY: Height - 1;
+            const u8 *Row = Pixels + Pitch * PY;
+            if (BlockX * 4 + 4 <= Width)
+            {
+                memcpy(Texels[4 * Y], Row + 16 * BlockX, 16);
+                continue;
+            }
+            for (int X = 0; X < 4; ++X)
+            {
+                int PX = BlockX * 4 + X;
+                PX = PX < Width? PX: Width - 1;
+                memcpy(Texels[4 * Y + X], Row + 4 * PX, 4);
+            }
+        }
+    }
+    
+    inline void
+        EncodeBCBlock(u8 *Out, const u8 (*Texels)[4], bc_format Format, bc_quality Quality)
+    {
+        bool HighQuality = Quality == BCQuality_High;
+        switch (Format)
+        {
+            case BCFormat_BC1:
+            {
+                EncodeBC1Block(Out, Texels, HighQuality, true);
+            } break;
+            
+            case BCFormat_BC3:
+            {
+                u8 Alpha[16];
+                for (int I = 0; I < 16; ++I) Alpha[I] = Texels[I][3];
+                EncodeBC4Block(Out, Alpha, HighQuality);
+                EncodeBC1Block(Out + 8, Texels, HighQuality, false);
+            } break;
+            
+            case BCFormat_BC4:
+            case BCFormat_BC5:
+            {
+                for (int C = 0; C < (Format == BCFormat_BC5? 2: 1); ++C)
+                {
+                    u8 Values[16];
+                    for (int I = 0; I < 16; ++I) Values[I] = Texels[I][C];
+                    EncodeBC4Block(Out + 8 * C, Values, HighQuality);
+                }
+            } break;
+            
+            case BCFormat_BC7:
+            {
+                EncodeBC7Block(Out, Texels, HighQuality);
+            } break;
+        }
+    }
+    
+    // RGBA8 out, channels the format doesn't store are 0 (alpha 255)
+    inline void
+        DecodeBCBlock(u8 (*Texels)[4], const u8 *Block, bc_format Format)
+    {
+        switch (Format)
+        {
+            case BCFormat_BC1:
+            {
+                DecodeBC1Block(Texels, Block, false);
+            } break;
+            
+            case BCFormat_BC3:
+            {
+                DecodeBC1Block(Texels, Block + 8, true);
+                DecodeBC4Block(Texels, 3, Block);
+            } break;
+            
+            case BCFormat_BC4:
+            case BCFormat_BC5:
+            {
+                for (int I = 0; I < 16; ++I)
+                {
+                    Texels[I][1] = Texels[I][2] = 0;
+                    Texels[I][3] = 255;
+                }
+                DecodeBC4Block(Texels, 0, Block);
+                if (Format == BCFormat_BC5) DecodeBC4Block(Texels, 1, Block + 8);
+            } break;
+            
+            case BCFormat_BC7:
+            {
+                DecodeBC7Block(Texels, Block);
+            } break;
+        }
+    }
+    
+    // RGBA8 pixels to rows of blocks BlockPitch bytes apart, ThreadCount <= 0 uses all hardware threads
+    inline void
+        EncodeBC(void *Blocks, size_t BlockPitch, const void *Pixels, size_t Pitch, int Width, int Height,
+                 bc_format Format, bc_quality Quality, int ThreadCount)
+    {
+        int BlocksX = (Width + 3) / 4;
+        int BlocksY = (Height + 3) / 4;
+        int BlockSize = GetBCBlockSize(Format);
+        ThreadCount = ResolveThreadCount(ThreadCount, (u64)Width * Height);
+        ImageParallel(ThreadCount, [&](int ThreadI)
+                      {
+                          int Begin = int(i64(BlocksY) * ThreadI / ThreadCount);
+                          int End = int(i64(BlocksY) * (ThreadI + 1) / ThreadCount);
+                          for (int BY = Begin; BY < End; ++BY)
+                          {
+                              u8 *Out = (u8 *)Blocks + BlockPitch * BY;
+                              for (int BX = 0; BX < BlocksX; ++BX)
+                              {
+                                  u8 Texels[16][4];
+                                  LoadBCBlock(Texels, (const u8 *)Pixels, Pitch, Width, Height, BX, BY);
+                                  EncodeBCBlock(Out + BlockSize * BX, Texels, Format, Quality);
+                              }
+                          }
+                      });
+    }
+    
+    inline void
+        DecodeBC(void *Pixels, size_t Pitch, const void *Blocks, size_t BlockPitch, int Width, int Height,
+                 bc_format Format, int ThreadCount)
+    {
+        int BlocksX = (Width + 3) / 4;
+        int BlocksY = (Height + 3) / 4;
+        int BlockSize = GetBCBlockSize(Format);
+        ThreadCount = ResolveThreadCount(ThreadCount, (u64)Width * Height);
+        ImageParallel(ThreadCount, [&](int ThreadI)
+                      {
+                          int Begin = int(i64(BlocksY) * ThreadI / ThreadCount);
+                          int End = int(i64(BlocksY) * (ThreadI + 1) / ThreadCount);
+                          for (int BY = Begin; BY < End; ++BY)
+                          {
+                              const u8 *In = (const u8 *)Blocks + BlockPitch * BY;
+                              for (int BX = 0; BX < BlocksX; ++BX)
+                              {
+                                  u8 Texels[16][4];
+                                  DecodeBCBlock(Texels, In + BlockSize * BX, Format);
+                                  int CopyWidth = Width - 4 * BX < 4? Width - 4 * BX: 4;
+                                  for (int Y = 0; Y < 4 && 4 * BY + Y < Height; ++Y)
+                                  {
+                                      u8 *Row = (u8 *)Pixels + Pitch * (4 * BY + Y) + 16 * BX;
+                                      memcpy(Row, Texels[4 * Y], 4 * (size_t)CopyWidth);
+                                  }
+                              }
+                          }
+                      });
+    }
+    
+    // over the first ChannelCount channels of two RGBA8 images, infinite when they match
+    inline f64
+        ComputePSNR(const void *A, size_t PitchA, const void *B, size_t PitchB, int Width, int Height, int ChannelCount)
+    {
+        u64 Total = 0;
+        for (int Y = 0; Y < Height; ++Y)
+        {
+            const u8 *RowA = (const u8 *)A + PitchA * Y;
+            const u8 *RowB = (const u8 *)B + PitchB * Y;
+            for (int X = 0; X < Width; ++X)
+            {
+                Total += TexelError(RowA + 4 * X, RowB + 4 * X, ChannelCount);
+            }
+        }
+        if (Total == 0) return INFINITY;
+        f64 MSE = f64(Total) / (f64(Width) * f64(Height) * f64(ChannelCount));
+        return 10.0 * log10(255.0 * 255.0 / MSE);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,572 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch::bench_suite Suite = ch::InitBenchSuite(ch::DefaultBenchOptions());
+
+mat4 A = ..., B = ...;
+ch::RunBenchmark(&Suite, "math/mat4_mul", 1.0, [&]()
+{
+    mat4 C = A * B;
+    ch::KeepValue(C); // or the compiler drops the work
+});
+ch::RunBenchmark(&Suite, "bc/bc7_fast_256", 256.0 * 256.0, [&]() { ... }); // items per call, prints items/s
+
+ch::WriteBenchJSON(&Suite, "results.json");
+
+// against a stored run
+ch::bench_suite Baseline = {};
+if (ch::ReadBenchJSON(&Baseline, "baseline.json"))
+{
+    ch::bench_tolerance Tolerances[] = {{"bc*", 0.25}}; // noisier, threaded
+    int Regressions = ch::CompareBenchSuites(&Suite, &Baseline, 0.10, Tolerances, 1, stdout);
+}
+ch::FreeBenchSuite(&Baseline);
+ch::FreeBenchSuite(&Suite);
+
+Measuring:
+
+Each benchmark is warmed up for WarmupSeconds, which also sizes a repetition:
+enough calls to take RepetitionSeconds. Then RepetitionCount repetitions are
+timed one by one. Results are per call: min, median, p90, p99, max and mean
+nanoseconds over the repetitions, plus the median cycles. Cycles come from the
+CPU's own cycle counter where the OS lets us read it (perf events on Linux,
+CycleSource "cpu"), so they don't move with turbo or power states. Elsewhere
+they are TSC ticks from ch_profile (CycleSource "tsc"), which run at a fixed
+rate and are only a finer clock. The counter includes threads the benchmark
+starts, it's the work done, not the wall time.
+
+Comparing:
+
+A benchmark regresses when its median is more than its tolerance slower than the
+baseline's. Cycles are compared when both runs counted CPU cycles, nanoseconds
+otherwise. Tolerances match names exactly or by prefix with a trailing '*', the
+last match wins, anything else gets the default tolerance. WriteBenchJSON and
+ReadBenchJSON only have to understand each other, the reader is not a general
+JSON parser.
+*/
+
+#include "ch_profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef CH_BENCH_MAX_REPETITIONS
+#define CH_BENCH_MAX_REPETITIONS 1024
+#endif
+
+namespace ch
+{
+    //
+    //
+    // measuring
+    
+    // makes the compiler assume Value is read, so the work producing it stays
+    template <typename T>
+        inline void
+        KeepValue(const T &Value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(Value) : "memory");
+#else
+        static const void *volatile Sink;
+        Sink = &Value;
+#endif
+    }
+    
+    struct cycle_counter
+    {
+        int FD; // perf event, -1 counts TSC ticks
+        const char *Source;
+    };
+    
+    inline cycle_counter
+        OpenCycleCounter()
+    {
+        cycle_counter Counter = {-1, "tsc"};
+#if defined(__linux__)
+        perf_event_attr Attributes = {};
+        Attributes.type = PERF_TYPE_HARDWARE;
+        Attributes.size = sizeof(Attributes);
+        Attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+        Attributes.exclude_kernel = 1;
+        Attributes.exclude_hv = 1;
+        Attributes.inherit = 1; // threads started later count too
+        int FD = (int)syscall(SYS_perf_event_open, &Attributes, 0, -1, -1, 0);
+        if (FD >= 0)
+        {
+            Counter.FD = FD;
+            Counter.Source = "cpu";
+        }
+#endif
+        return Counter;
+    }
+    
+    inline const cycle_counter *
+        GetCycleCounter()
+    {
+        static cycle_counter Counter = OpenCycleCounter();
+        return &Counter;
+    }
+    
+    inline u64
+        ReadCycles(const cycle_counter *Counter)
+    {
+#if defined(__linux__)
+        u64 Cycles = 0;
+        if (Counter->FD >= 0 && read(Counter->FD, &Cycles, sizeof(Cycles)) == sizeof(Cycles))
+        {
+            return Cycles;
+        }
+#endif
+        return GetTicks();
+    }
+    
+    struct bench_options
+    {
+        f64 WarmupSeconds;
+        f64 RepetitionSeconds; // a repetition calls the benchmark until about this much time passed
+        int RepetitionCount;
+        const char *Filter; // only names containing it run, 0 runs everything
+        FILE *Log;          // a line per finished benchmark, 0 for none
+    };
+    
+    inline bench_options
+        DefaultBenchOptions()
+    {
+        bench_options Options = {};
+        Options.WarmupSeconds = 0.1;
+        Options.RepetitionSeconds = 0.02;
+        Options.RepetitionCount = 15;
+        Options.Log = stdout;
+        return Options;
+    }
+    
+    // times are nanoseconds per call
+    struct bench_result
+    {
+        char Name[96];
+        u64 Iterations; // calls per repetition
+        int Repetitions;
+        f64 Items;      // per call, 0 if there's no meaningful unit
+        f64 Min;
+        f64 Median;
+        f64 P90;
+        f64 P99;
+        f64 Max;
+        f64 Mean;
+        f64 Cycles;     // median
+    };
+    
+    struct bench_suite
+    {
+        bench_options Options;
+        char CycleSource[8];
+        bench_result *Results;
+        int ResultCount;
+        int ResultCapacity;
+    };
+    
+    inline bench_suite
+        InitBenchSuite(bench_options Options)
+    {
+        bench_suite Suite = {};
+        Suite.Options = Options;
+        if (Suite.Options.RepetitionCount < 1) Suite.Options.RepetitionCount = 1;
+        if (Suite.Options.RepetitionCount > CH_BENCH_MAX_REPETITIONS) Suite.Options.RepetitionCount = CH_BENCH_MAX_REPETITIONS;
+        snprintf(Suite.CycleSource, sizeof(Suite.CycleSource), "%s", GetCycleCounter()->Source);
+        return Suite;
+    }
+    
+    inline void
+        FreeBenchSuite(bench_suite *Suite)
+    {
+        free(Suite->Results);
+        *Suite = {};
+    }
+    
+    inline bench_result *
+        AddBenchResult(bench_suite *Suite, const char *Name)
+    {
+        if (Suite->ResultCount == Suite->ResultCapacity)
+        {
+            Suite->ResultCapacity = Suite->ResultCapacity? 2 * Suite->ResultCapacity: 64;
+            Suite->Results = (bench_result *)realloc(Suite->Results, sizeof(bench_result) * Suite->ResultCapacity);
+        }
+        bench_result *Result = &Suite->Results[Suite->ResultCount++];
+        *Result = {};
+        snprintf(Result->Name, sizeof(Result->Name), "%s", Name);
+        return Result;
+    }
+    
+    inline const bench_result *
+        FindBenchResult(const bench_suite *Suite, const char *Name)
+    {
+        for (int ResultI = 0; ResultI < Suite->ResultCount; ++ResultI)
+        {
+            if (strcmp(Suite->Results[ResultI].Name, Name) == 0) return &Suite->Results[ResultI];
+        }
+        return 0;
+    }
+    
+    // linear between the closest ranks, Sorted has Count > 0 values
+    inline f64
+        GetPercentile(const f64 *Sorted, int Count, f64 Percent)
+    {
+        f64 Rank = Percent / 100.0 * f64(Count - 1);
+        int Low = int(Rank);
+        if (Low >= Count - 1) return Sorted[Count - 1];
+        f64 T = Rank - f64(Low);
+        return Sorted[Low] + T * (Sorted[Low + 1] - Sorted[Low]);
+    }
+    
+    inline void
+        SortSamples(f64 *Samples, int Count)
+    {
+        qsort(Samples, (size_t)Count, sizeof(f64), [](const void *A, const void *B)
+              {
+                  f64 X = *(const f64 *)A, Y = *(const f64 *)B;
+                  return X < Y? -1: (X > Y? 1: 0);
+              });
+    }
+    
+    inline void
+        PrintBenchResult(FILE *File, const bench_result *Result, const char *CycleSource)
+    {
+        fprintf(File, "%-32s %12.1f ns  p90 %12.1f  min %12.1f  %12.0f %s cycles", Result->Name,
+                Result->Median, Result->P90, Result->Min, Result->Cycles, CycleSource);
+        if (Result->Items > 0.0)
+        {
+            fprintf(File, "  %10.2f M items/s", Result->Items / Result->Median * 1e3);
+        }
+        fprintf(File, "\n");
+    }
+    
+    // calls Work repeatedly, Items is how many things one call processes (for throughput).
+    // 0 if the filter skipped it
+    template <typename F>
+        inline const bench_result *
+        RunBenchmark(bench_suite *Suite, const char *Name, f64 Items, F Work)
+    {
+        const bench_options *Options = &Suite->Options;
+        if (Options->Filter && !strstr(Name, Options->Filter)) return 0;
+        const cycle_counter *Counter = GetCycleCounter();
+        f64 SecondsPerTick = GetTickClock()->SecondsPerTick;
+        
+        // warmup, and how many calls make a repetition
+        u64 WarmupCalls = 0;
+        u64 WarmupBegin = GetTicks();
+        f64 WarmupElapsed = 0.0;
+        do
+        {
+            Work();
+            ++WarmupCalls;
+            WarmupElapsed = f64(GetTicks() - WarmupBegin) * SecondsPerTick;
+        } while (WarmupElapsed < Options->WarmupSeconds);
+        f64 SecondsPerCall = WarmupElapsed / f64(WarmupCalls);
+        u64 Iterations = SecondsPerCall > 0.0? u64(Options->RepetitionSeconds / SecondsPerCall): 1;
+        if (Iterations < 1) Iterations = 1;
+        
+        f64 Nanoseconds[CH_BENCH_MAX_REPETITIONS];
+        f64 Cycles[CH_BENCH_MAX_REPETITIONS];
+        int RepetitionCount = Options->RepetitionCount;
+        for (int RepetitionI = 0; RepetitionI < RepetitionCount; ++RepetitionI)
+        {
+            u64 CyclesBegin = ReadCycles(Counter);
+            u64 TicksBegin = GetTicks();
+            for (u64 I = 0; I < Iterations; ++I)
+            {
+                Work();
+            }
+            u64 TicksEnd = GetTicks();
+            u64 CyclesEnd = ReadCycles(Counter);
+            Nanoseconds[RepetitionI] = f64(TicksEnd - TicksBegin) * SecondsPerTick * 1e9 / f64(Iterations);
+            Cycles[RepetitionI] = f64(CyclesEnd - CyclesBegin) / f64(Iterations);
+        }
+        
+        bench_result *Result = AddBenchResult(Suite, Name);
+        Result->Iterations = Iterations;
+        Result->Repetitions = RepetitionCount;
+        Result->Items = Items;
+        f64 Sum = 0.0;
+        for (int RepetitionI = 0; RepetitionI < RepetitionCount; ++RepetitionI)
+        {
+            Sum += Nanoseconds[RepetitionI];
+        }
+        Result->Mean = Sum / f64(RepetitionCount);
+        SortSamples(Nanoseconds, RepetitionCount);
+        SortSamples(Cycles, RepetitionCount);
+        Result->Min = Nanoseconds[0];
+        Result->Median = GetPercentile(Nanoseconds, RepetitionCount, 50.0);
+        Result->P90 = GetPercentile(Nanoseconds, RepetitionCount, 90.0);
+        Result->P99 = GetPercentile(Nanoseconds, RepetitionCount, 99.0);
+        Result->Max = Nanoseconds[RepetitionCount - 1];
+        Result->Cycles = GetPercentile(Cycles, RepetitionCount, 50.0);
+        
+        if (Options->Log)
+        {
+            PrintBenchResult(Options->Log, Result, Suite->CycleSource);
+            fflush(Options->Log);
+        }
+        return Result;
+    }
+    
+    //
+    //
+    // json
+    
+    inline bool
+        WriteBenchJSON(const bench_suite *Suite, const char *Path)
+    {
+        FILE *File = fopen(Path, "wb");
+        if (!File) return false;
+        
+        fprintf(File, "{\n\"version\": 1,\n\"cycle_source\": \"%s\",\n\"benchmarks\": [", Suite->CycleSource);
+        for (int ResultI = 0; ResultI < Suite->ResultCount; ++ResultI)
+        {
+            const bench_result *R = &Suite->Results[ResultI];
+            fprintf(File, "%s\n{\"name\": \"", ResultI? ",": "");
+            for (const char *C = R->Name; *C; ++C)
+            {
+                if (*C == '"' || *C == '\\') fputc('\\', File);
+                if ((u8)*C >= 0x20) fputc(*C, File);
+            }
+            fprintf(File, "\", \"iterations\": %llu, \"repetitions\": %d, \"items\": %.17g, "
+                    "\"min_ns\": %.17g, \"median_ns\": %.17g, \"p90_ns\": %.17g, \"p99_ns\": %.17g, "
+                    "\"max_ns\": %.17g, \"mean_ns\": %.17g, \"cycles\": %.17g}",
+                    (unsigned long long)R->Iterations, R->Repetitions, R->Items,
+                    R->Min, R->Median, R->P90, R->P99, R->Max, R->Mean, R->Cycles);
+        }
+        fprintf(File, "\n]\n}\n");
+        return fclose(File) == 0;
+    }
+    
+    inline const char *
+        SkipBenchWhitespace(const char *At)
+    {
+        while (*At == ' ' || *At == '\t' || *At == '\r' || *At == '\n') ++At;
+        return At;
+    }
+    
+    // a JSON string at At into Out, returns what follows it or 0
+    inline const char *
+        ParseBenchString(const char *At, char *Out, size_t OutSize)
+    {
+        if (*At != '"') return 0;
+        size_t Length = 0;
+        for (++At; *At && *At != '"'; ++At)
+        {
+            if (*At == '\\' && At[1]) ++At;
+            if (Length + 1 < OutSize) Out[Length++] = *At;
+        }
+        if (OutSize) Out[Length] = 0;
+        return *At == '"'? At + 1: 0;
+    }
+    
+    // the benchmarks of a file written by WriteBenchJSON, appended to Suite
+    inline bool
+        ReadBenchJSON(bench_suite *Suite, const char *Path)
+    {
+        FILE *File = fopen(Path, "rb");
+        if (!File) return false;
+        fseek(File, 0, SEEK_END);
+        long Size = ftell(File);
+        fseek(File, 0, SEEK_SET);
+        if (Size <= 0)
+        {
+            fclose(File);
+            return false;
+        }
+        char *Text = (char *)malloc((size_t)Size + 1);
+        size_t ReadSize = fread(Text, 1, (size_t)Size, File);
+        fclose(File);
+        Text[ReadSize] = 0;
+        
+        bool Valid = false;
+        const char *Source = strstr(Text, "\"cycle_source\"");
+        if (Source)
+        {
+            Source = SkipBenchWhitespace(Source + 14);
+            if (*Source == ':') ParseBenchString(SkipBenchWhitespace(Source + 1), Suite->CycleSource, sizeof(Suite->CycleSource));
+        }
+        const char *At = strstr(Text, "\"benchmarks\"");
+        At = At? strchr(At, '['): 0;
+        if (At)
+        {
+            Valid = true;
+            ++At;
+            for (;;)
+            {
+                At = SkipBenchWhitespace(At);
+                if (*At == ',') At = SkipBenchWhitespace(At + 1);
+                if (*At != '{') break;
+                ++At;
+                
+                bench_result Parsed = {};
+                for (;;)
+                {
+                    char Key[32];
+                    At = ParseBenchString(SkipBenchWhitespace(At), Key, sizeof(Key));
+                    if (!At) break;
+                    At = SkipBenchWhitespace(At);
+                    if (*At != ':')
+                    {
+                        At = 0;
+                        break;
+                    }
+                    At = SkipBenchWhitespace(At + 1);
+                    if (strcmp(Key, "name") == 0)
+                    {
+                        At = ParseBenchString(At, Parsed.Name, sizeof(Parsed.Name));
+                        if (!At) break;
+                    }
+                    else
+                    {
+                        char *End = 0;
+                        f64 Value = strtod(At, &End);
+                        if (End == At)
+                        {
+                            At = 0;
+                            break;
+                        }
+                        At = End;
+                        if (strcmp(Key, "iterations") == 0) Parsed.Iterations = u64(Value);
+                        else if (strcmp(Key, "repetitions") == 0) Parsed.Repetitions = int(Value);
+                        else if (strcmp(Key, "items") == 0) Parsed.Items = Value;
+                        else if (strcmp(Key, "min_ns") == 0) Parsed.Min = Value;
+                        else if (strcmp(Key, "median_ns") == 0) Parsed.Median = Value;
+                        else if (strcmp(Key, "p90_ns") == 0) Parsed.P90 = Value;
+                        else if (strcmp(Key, "p99_ns") == 0) Parsed.P99 = Value;
+                        else if (strcmp(Key, "max_ns") == 0) Parsed.Max = Value;
+                        else if (strcmp(Key, "mean_ns") == 0) Parsed.Mean = Value;
+                        else if (strcmp(Key, "cycles") == 0) Parsed.Cycles = Value;
+                    }
+                    At = SkipBenchWhitespace(At);
+                    if (*At == ',') ++At;
+                    else break;
+                }
+                if (!At || *At != '}')
+                {
+                    Valid = false;
+                    break;
+                }
+                ++At;
+                *AddBenchResult(Suite, Parsed.Name) = Parsed;
+            }
+            Valid = Valid && *At == ']';
+        }
+        
+        free(Text);
+        return Valid;
+    }
+    
+    //
+    //
+    // comparing
+    
+    struct bench_tolerance
+    {
+        const char *Pattern; // a name, or a prefix ending in '*'
+        f64 Tolerance;       // 0.1 = 10% slower is still fine
+    };
+    
+    enum bench_verdict
+    {
+        BenchVerdict_Same,
+        BenchVerdict_Faster,
+        BenchVerdict_Slower, // beyond tolerance, a regression
+        BenchVerdict_New,    // not in the baseline
+    };
+    
+    inline f64
+        GetBenchTolerance(const char *Name, f64 DefaultTolerance, const bench_tolerance *Tolerances, int ToleranceCount)
+    {
+        f64 Result = DefaultTolerance;
+        for (int ToleranceI = 0; ToleranceI < ToleranceCount; ++ToleranceI)
+        {
+            const char *Pattern = Tolerances[ToleranceI].Pattern;
+            size_t Length = strlen(Pattern);
+            bool Matches = (Length && Pattern[Length - 1] == '*')? strncmp(Name, Pattern, Length - 1) == 0: strcmp(Name, Pattern) == 0;
+            if (Matches) Result = Tolerances[ToleranceI].Tolerance;
+        }
+        return Result;
+    }
+    
+    // Ratio_Out is current / baseline, above 1 is slower
+    inline bench_verdict
+        CompareBenchResult(const bench_result *Current, const bench_result *Baseline, bool CompareCycles,
+                           f64 Tolerance, f64 *Ratio_Out = 0)
+    {
+        f64 Ratio = 1.0;
+        bench_verdict Verdict = BenchVerdict_New;
+        if (Baseline)
+        {
+            f64 Now = CompareCycles? Current->Cycles: Current->Median;
+            f64 Before = CompareCycles? Baseline->Cycles: Baseline->Median;
+            Ratio = Before > 0.0? Now / Before: 1.0;
+            Verdict = BenchVerdict_Same;
+            if (Ratio > 1.0 + Tolerance) Verdict = BenchVerdict_Slower;
+            else if (Ratio < 1.0 / (1.0 + Tolerance)) Verdict = BenchVerdict_Faster;
+        }
+        if (Ratio_Out) *Ratio_Out = Ratio;
+        return Verdict;
+    }
+    
+    // reports every benchmark of Current against Baseline to Report (0 for none), returns
+    // the number of regressions. Benchmarks only in the baseline are listed (unless Current
+    // ran filtered), not counted
+    inline int
+        CompareBenchSuites(const bench_suite *Current, const bench_suite *Baseline, f64 DefaultTolerance,
+                           const bench_tolerance *Tolerances = 0, int ToleranceCount = 0, FILE *Report = 0)
+    {
+        bool CompareCycles = strcmp(Current->CycleSource, "cpu") == 0 && strcmp(Baseline->CycleSource, "cpu") == 0;
+        int Regressions = 0;
+        if (Report)
+        {
+            fprintf(Report, "comparing %s against the baseline\n", CompareCycles? "cycles": "median times");
+        }
+        for (int ResultI = 0; ResultI < Current->ResultCount; ++ResultI)
+        {
+            const bench_result *Result = &Current->Results[ResultI];
+            const bench_result *Before = FindBenchResult(Baseline, Result->Name);
+            f64 Tolerance = GetBenchTolerance(Result->Name, DefaultTolerance, Tolerances, ToleranceCount);
+            f64 Ratio = 1.0;
+            bench_verdict Verdict = CompareBenchResult(Result, Before, CompareCycles, Tolerance, &Ratio);
+            if (Verdict == BenchVerdict_Slower) ++Regressions;
+            if (Report)
+            {
+                static const char *VerdictNames[] = {"same", "faster", "SLOWER", "new"};
+                if (Verdict == BenchVerdict_New)
+                {
+                    fprintf(Report, "%-32s %-6s\n", Result->Name, VerdictNames[Verdict]);
+                }
+                else
+                {
+                    fprintf(Report, "%-32s %-6s %+7.1f%% (tolerance %.0f%%)\n", Result->Name, VerdictNames[Verdict],
+                            100.0 * (Ratio - 1.0), 100.0 * Tolerance);
+                }
+            }
+        }
+        if (Report)
+        {
+            for (int ResultI = 0; ResultI < Baseline->ResultCount && !Current->Options.Filter; ++ResultI)
+            {
+                const char *Name = Baseline->Results[ResultI].Name;
+                if (!FindBenchResult(Current, Name))
+                {
+                    fprintf(Report, "%-32s missing\n", Name);
+                }
+            }
+            fprintf(Report, "%d regression%s\n", Regressions, Regressions == 1? "": "s");
+        }
+        return Regressions;
+    }
+};
\ No newline at end of file
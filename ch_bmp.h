@@ -1,6 +1,31 @@
 #pragma once
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include "ch_simd.h"
+
+/*
+NOTE: sample usage code:
+
+// whole image in memory, 32-bit, row 0 is the bottom row
+CH_BMP::WriteImageToBMP("out.bmp", Pixels, Width, Height);
+
+// streaming, row 0 is the top row, nothing but the rows in flight is kept around
+CH_BMP::bmp_writer Writer;
+if (CH_BMP::BeginBMP(&Writer, "huge.bmp", 16384, 16384, 24, CH_BMP::BMPPixel_RGBA8))
+{
+    // from any thread, in any order, any number of rows at a time
+    CH_BMP::WriteBMPRows(&Writer, FirstRow, RowCount, Rows, PitchInBytes);
+    ...
+    bool Success = CH_BMP::EndBMP(&Writer); // false if a write failed or rows are missing
+}
+
+Pixels are uint32_t, BMPPixel_BGRA8 is 0xAARRGGBB (what BMP stores, written
+as-is for 32-bit output), BMPPixel_RGBA8 is 0xAABBGGRR (bytes R, G, B, A, e.g.
+glReadPixels with GL_RGBA). 24-bit output drops alpha and pads rows to 4 bytes.
+*/
 
 namespace CH_BMP
 {
@@ -33,34 +58,287 @@ namespace CH_BMP
     };
 #pragma pack(pop)
     
-    static bool 
-        WriteImageToBMP(const char *Path, uint32_t *Buffer, int Width, int Height)
+    enum bmp_pixel_format
     {
-        bool Result = false;
+        BMPPixel_BGRA8,
+        BMPPixel_RGBA8,
+    };
+    
+    struct bmp_writer
+    {
+        FILE *File;
+        int Width;
+        int Height;
+        int BitCount;
+        bmp_pixel_format Format;
+        uint32_t RowStride;
+        uint32_t DataOffset;
         
-        FILE *File = fopen(Path, "wb");
-        if (File)
+        std::mutex Lock;
+        uint32_t *RowBits; // a bit per row, set once it's written
+        int RowsWritten;   // rows with their bit set, a row written twice counts once
+        bool Failed;
+    };
+    
+    inline uint32_t
+        GetBMPRowStride(int Width, int BitCount)
+    {
+        return ((uint32_t)Width * (uint32_t)BitCount / 8 + 3) & ~3u;
+    }
+    
+    //
+    //
+    // row conversion
+    
+    static void
+        ConvertRowToBGRA(uint8_t *Dest, const uint32_t *Src, int Width, bmp_pixel_format Format)
+    {
+        if (Format == BMPPixel_BGRA8)
         {
-            bmp_file_header BMPFileHeader = {};
-            BMPFileHeader.bfType[0] = 'B';
-            BMPFileHeader.bfType[1] = 'M';
-            BMPFileHeader.bfOffbits = sizeof(bmp_file_header) + sizeof(bmp_image_header);
-            
-            bmp_image_header BMPImageHeader = {};
-            BMPImageHeader.biSize = sizeof(BMPImageHeader);
-            BMPImageHeader.biWidth = Width;
-            BMPImageHeader.biHeight = Height;
-            BMPImageHeader.biPlanes = 1;
-            BMPImageHeader.biBitCount = 32;
+            memcpy(Dest, Src, (size_t)Width * 4);
+            return;
+        }
+        
+        // RGBA, swap R and B
+        int X = 0;
+#if CH_SSSE3
+        __m128i Swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        for (; X + 4 <= Width; X += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((const __m128i *)(Src + X));
+            _mm_storeu_si128((__m128i *)(Dest + 4 * X), _mm_shuffle_epi8(Pixels, Swizzle));
+        }
+#elif CH_SSE2
+        __m128i KeepMask = _mm_set1_epi32((int)0xFF00FF00);
+        __m128i LowByte = _mm_set1_epi32(0xFF);
+        for (; X + 4 <= Width; X += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((const __m128i *)(Src + X));
+            __m128i Swapped = _mm_or_si128(_mm_and_si128(Pixels, KeepMask),
+                                           _mm_or_si128(_mm_and_si128(_mm_srli_epi32(Pixels, 16), LowByte),
+                                                        _mm_slli_epi32(_mm_and_si128(Pixels, LowByte), 16)));
+            _mm_storeu_si128((__m128i *)(Dest + 4 * X), Swapped);
+        }
+#endif
+        for (; X < Width; ++X)
+        {
+            uint32_t Pixel = Src[X];
+            Pixel = (Pixel & 0xFF00FF00) | ((Pixel >> 16) & 0xFF) | ((Pixel & 0xFF) << 16);
+            memcpy(Dest + 4 * X, &Pixel, 4);
+        }
+    }
+    
+    static void
+        ConvertRowToBGR(uint8_t *Dest, const uint32_t *Src, int Width, bmp_pixel_format Format)
+    {
+        int X = 0;
+#if CH_SSSE3
+        //NOTE(chen): one shuffle drops alpha and swizzles, 4 pixels -> 12 bytes in the
+        //            low part of the register. 16 pixels make exactly 3 full stores.
+        __m128i Pack = (Format == BMPPixel_BGRA8?
+                        _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1):
+                        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        for (; X + 16 <= Width; X += 16)
+        {
+            const __m128i *In = (const __m128i *)(Src + X);
+            __m128i A = _mm_shuffle_epi8(_mm_loadu_si128(In + 0), Pack);
+            __m128i B = _mm_shuffle_epi8(_mm_loadu_si128(In + 1), Pack);
+            __m128i C = _mm_shuffle_epi8(_mm_loadu_si128(In + 2), Pack);
+            __m128i D = _mm_shuffle_epi8(_mm_loadu_si128(In + 3), Pack);
             
-            fwrite(&BMPFileHeader, sizeof(BMPFileHeader), 1, File);
-            fwrite(&BMPImageHeader, sizeof(BMPImageHeader), 1, File);
-            fwrite(Buffer, sizeof(uint32_t), Width * Height, File);
-            fclose(File);
+            __m128i *Out = (__m128i *)(Dest + 3 * X);
+            _mm_storeu_si128(Out + 0, _mm_or_si128(A, _mm_slli_si128(B, 12)));
+            _mm_storeu_si128(Out + 1, _mm_or_si128(_mm_srli_si128(B, 4), _mm_slli_si128(C, 8)));
+            _mm_storeu_si128(Out + 2, _mm_or_si128(_mm_srli_si128(C, 8), _mm_slli_si128(D, 4)));
+        }
+#endif
+        int RedShift = Format == BMPPixel_BGRA8? 16: 0;
+        int BlueShift = Format == BMPPixel_BGRA8? 0: 16;
+        for (; X < Width; ++X)
+        {
+            uint32_t Pixel = Src[X];
+            Dest[3*X + 0] = (uint8_t)(Pixel >> BlueShift);
+            Dest[3*X + 1] = (uint8_t)(Pixel >> 8);
+            Dest[3*X + 2] = (uint8_t)(Pixel >> RedShift);
+        }
+    }
+    
+    //
+    //
+    // writing
+    
+    // TopRowFirst puts row 0 at the top (negative biHeight), otherwise at the bottom.
+    // The rows sit in the file in the order they're numbered either way.
+    static bool
+        BeginBMP(bmp_writer *Writer, const char *Path, int Width, int Height,
+                 int BitCount = 24, bmp_pixel_format Format = BMPPixel_BGRA8, bool TopRowFirst = true)
+    {
+        if (Width <= 0 || Height <= 0 || (BitCount != 24 && BitCount != 32))
+        {
+            return false;
+        }
+        
+        Writer->File = fopen(Path, "wb");
+        if (!Writer->File)
+        {
+            return false;
+        }
+        
+        Writer->Width = Width;
+        Writer->Height = Height;
+        Writer->BitCount = BitCount;
+        Writer->Format = Format;
+        Writer->RowStride = GetBMPRowStride(Width, BitCount);
+        Writer->DataOffset = sizeof(bmp_file_header) + sizeof(bmp_image_header);
+        Writer->RowsWritten = 0;
+        Writer->Failed = false;
+        Writer->RowBits = (uint32_t *)calloc(((size_t)Height + 31) / 32, sizeof(uint32_t));
+        if (!Writer->RowBits)
+        {
+            fclose(Writer->File);
+            Writer->File = 0;
+            return false;
+        }
+        
+        uint64_t ImageSize = (uint64_t)Writer->RowStride * (uint64_t)Height;
+        uint64_t FileSize = ImageSize + Writer->DataOffset;
+        
+        //NOTE(chen): the size fields are 32-bit, past 4GB readers have to go by
+        //            width/height anyway so they're written as 0 (valid for BI_RGB)
+        bmp_file_header BMPFileHeader = {};
+        BMPFileHeader.bfType[0] = 'B';
+        BMPFileHeader.bfType[1] = 'M';
+        BMPFileHeader.bfSize = FileSize <= 0xFFFFFFFF? (uint32_t)FileSize: 0;
+        BMPFileHeader.bfOffbits = Writer->DataOffset;
+        
+        bmp_image_header BMPImageHeader = {};
+        BMPImageHeader.biSize = sizeof(BMPImageHeader);
+        BMPImageHeader.biWidth = Width;
+        BMPImageHeader.biHeight = TopRowFirst? -Height: Height;
+        BMPImageHeader.biPlanes = 1;
+        BMPImageHeader.biBitCount = (uint16_t)BitCount;
+        BMPImageHeader.biSizeImage = FileSize <= 0xFFFFFFFF? (uint32_t)ImageSize: 0;
+        
+        if (fwrite(&BMPFileHeader, sizeof(BMPFileHeader), 1, Writer->File) != 1 ||
+            fwrite(&BMPImageHeader, sizeof(BMPImageHeader), 1, Writer->File) != 1)
+        {
+            fclose(Writer->File);
+            Writer->File = 0;
+            free(Writer->RowBits);
+            Writer->RowBits = 0;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    static bool
+        SeekBMPRow(bmp_writer *Writer, int Row)
+    {
+        uint64_t Offset = Writer->DataOffset + (uint64_t)Row * Writer->RowStride;
+#if defined(_WIN32)
+        return _fseeki64(Writer->File, (__int64)Offset, SEEK_SET) == 0;
+#else
+        return fseeko(Writer->File, (off_t)Offset, SEEK_SET) == 0;
+#endif
+    }
+    
+    // Pitch is in bytes, 0 means tightly packed rows. Safe to call from several
+    // threads at once: conversion runs unlocked, only the seek + write is serialized.
+    static bool
+        WriteBMPRows(bmp_writer *Writer, int FirstRow, int RowCount, const uint32_t *Rows, size_t Pitch = 0)
+    {
+        if (FirstRow < 0 || RowCount <= 0 || FirstRow + RowCount > Writer->Height)
+        {
+            return false;
+        }
+        if (Pitch == 0)
+        {
+            Pitch = (size_t)Writer->Width * 4;
+        }
+        
+        bool PassThrough = (Writer->BitCount == 32 && Writer->Format == BMPPixel_BGRA8 &&
+                            Pitch == Writer->RowStride);
+        
+        uint8_t *Converted = 0;
+        if (!PassThrough)
+        {
+            Converted = (uint8_t *)malloc((size_t)Writer->RowStride * RowCount);
+            if (!Converted)
+            {
+                return false;
+            }
             
-            Result = true;
+            for (int Y = 0; Y < RowCount; ++Y)
+            {
+                const uint32_t *Src = (const uint32_t *)((const uint8_t *)Rows + Pitch * Y);
+                uint8_t *Dest = Converted + (size_t)Writer->RowStride * Y;
+                if (Writer->BitCount == 32)
+                {
+                    ConvertRowToBGRA(Dest, Src, Writer->Width, Writer->Format);
+                }
+                else
+                {
+                    size_t RowBytes = (size_t)Writer->Width * 3;
+                    ConvertRowToBGR(Dest, Src, Writer->Width, Writer->Format);
+                    memset(Dest + RowBytes, 0, Writer->RowStride - RowBytes);
+                }
+            }
         }
         
+        bool Result = false;
+        {
+            std::lock_guard<std::mutex> Guard(Writer->Lock);
+            size_t Size = (size_t)Writer->RowStride * RowCount;
+            const void *Data = PassThrough? (const void *)Rows: (const void *)Converted;
+            Result = SeekBMPRow(Writer, FirstRow) && fwrite(Data, 1, Size, Writer->File) == Size;
+            if (Result)
+            {
+                for (int Row = FirstRow; Row < FirstRow + RowCount; ++Row)
+                {
+                    uint32_t Bit = 1u << (Row & 31);
+                    if (!(Writer->RowBits[Row >> 5] & Bit))
+                    {
+                        Writer->RowBits[Row >> 5] |= Bit;
+                        ++Writer->RowsWritten;
+                    }
+                }
+            }
+            else
+            {
+                Writer->Failed = true;
+            }
+        }
+        
+        free(Converted);
         return Result;
     }
+    
+    // true if every write succeeded and every row was written at least once
+    static bool
+        EndBMP(bmp_writer *Writer)
+    {
+        bool Result = !Writer->Failed && Writer->RowsWritten == Writer->Height;
+        if (Writer->File)
+        {
+            Result = (fclose(Writer->File) == 0) && Result;
+            Writer->File = 0;
+        }
+        free(Writer->RowBits);
+        Writer->RowBits = 0;
+        return Result;
+    }
+    
+    static bool 
+        WriteImageToBMP(const char *Path, uint32_t *Buffer, int Width, int Height)
+    {
+        bmp_writer Writer;
+        if (!BeginBMP(&Writer, Path, Width, Height, 32, BMPPixel_BGRA8, false))
+        {
+            return false;
+        }
+        
+        WriteBMPRows(&Writer, 0, Height, Buffer);
+        return EndBMP(&Writer);
+    }
 };
\ No newline at end of file
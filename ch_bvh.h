@@ -0,0 +1,786 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch_obj::Model Model = ch_obj::load_model("bunny.obj");
+ch::bvh BVH = ch::BuildBVH(&Model, 0); // 0 = one thread per hardware thread
+
+ch::ray Ray = ch::Ray(V3(0.0f, 0.0f, -5.0f), V3(0.0f, 0.0f, 1.0f));
+ch::hit Hit = {};
+if (BVH.Intersect(Ray, &Hit))
+{
+    // Hit.T, Hit.U, Hit.V, Hit.TriangleIndex (index into Model.ib / 3)
+}
+bool Blocked = BVH.Occluded(Ray);
+
+ch::ray_packet<8> Packet = {}; // SoA, fill OX..DZ, TMin and TMax per lane
+ch::hit Hits[8];
+BVH.Intersect(&Packet, Hits);
+
+BVH.Free();
+
+Layout:
+
+bvh_node is 32 bytes, two of them share a 64-byte cache line. Sibling nodes
+are always allocated next to each other, so an interior node only stores the
+index of its left child (the right child is LeftFirst + 1). For leaves,
+LeftFirst is the first triangle in Triangles/TriangleIndices and Count is
+the number of triangles. Count == 0 marks an interior node.
+
+Node 1 is left unused so every sibling pair starts on an even index.
+*/
+
+#include "ch_math.h"
+#include "ch_obj.h"
+#include <stdlib.h>
+#include <thread>
+#include <atomic>
+
+#ifndef CH_BVH_BIN_COUNT
+#define CH_BVH_BIN_COUNT 16
+#endif
+
+#ifndef CH_BVH_STACK_SIZE
+#define CH_BVH_STACK_SIZE 64
+#endif
+
+namespace ch
+{
+    struct bvh_node
+    {
+        v3 Min;
+        u32 LeftFirst;
+        v3 Max;
+        u32 Count;
+    };
+    static_assert(sizeof(bvh_node) == 32, "bvh_node must stay 32 bytes");
+    
+    // precomputed for Moller-Trumbore
+    struct bvh_triangle
+    {
+        v3 V0;
+        v3 E1;
+        v3 E2;
+    };
+    
+    struct ray
+    {
+        v3 O;
+        v3 D;
+        f32 TMin;
+        f32 TMax;
+    };
+    
+    struct hit
+    {
+        f32 T;
+        f32 U;
+        f32 V;
+        i32 TriangleIndex; // -1 if nothing was hit
+    };
+    
+    template <int N>
+        struct ray_packet
+    {
+        f32 OX[N], OY[N], OZ[N];
+        f32 DX[N], DY[N], DZ[N];
+        f32 TMin[N];
+        f32 TMax[N];
+    };
+    
+    typedef ray_packet<4> ray_packet4;
+    typedef ray_packet<8> ray_packet8;
+    
+    struct bvh
+    {
+        bvh_node *Nodes;
+        int NodeCount;
+        
+        bvh_triangle *Triangles; // in leaf order
+        i32 *TriangleIndices; // leaf order -> model triangle
+        int TriangleCount;
+        
+        bool Intersect(ray Ray, hit *Hit_Out);
+        bool Occluded(ray Ray);
+        
+        template <int N> void Intersect(ray_packet<N> *Packet, hit *Hits_Out);
+        template <int N> void Occluded(ray_packet<N> *Packet, bool *Occluded_Out);
+        
+        void Free();
+    };
+    
+    inline ray
+        Ray(v3 O, v3 D, f32 TMin = 0.0f, f32 TMax = F32Max)
+    {
+        ray Result = {};
+        Result.O = O;
+        Result.D = D;
+        Result.TMin = TMin;
+        Result.TMax = TMax;
+        return Result;
+    }
+    
+    //
+    //
+    // builder
+    
+    struct bvh_aabb
+    {
+        v3 Min;
+        v3 Max;
+    };
+    
+    inline bvh_aabb
+        EmptyAABB()
+    {
+        bvh_aabb Result = {};
+        Result.Min = V3(F32Max);
+        Result.Max = V3(-F32Max);
+        return Result;
+    }
+    
+    inline void
+        Grow(bvh_aabb *Box, v3 P)
+    {
+        Box->Min = Min(Box->Min, P);
+        Box->Max = Max(Box->Max, P);
+    }
+    
+    inline void
+        Grow(bvh_aabb *Box, bvh_aabb Other)
+    {
+        Box->Min = Min(Box->Min, Other.Min);
+        Box->Max = Max(Box->Max, Other.Max);
+    }
+    
+    inline f32
+        HalfArea(bvh_aabb Box)
+    {
+        v3 E = Box.Max - Box.Min;
+        if (E.X < 0.0f) return 0.0f; // empty
+        return E.X * E.Y + E.Y * E.Z + E.Z * E.X;
+    }
+    
+    struct bvh_builder
+    {
+        bvh_node *Nodes;
+        std::atomic<u32> NodesUsed;
+        
+        bvh_aabb *PrimBounds;
+        v3 *Centroids;
+        i32 *Indices;
+        
+        int ParallelDepth; // subtrees above this depth are built on their own thread
+    };
+    
+    inline void
+        UpdateNodeBounds(bvh_builder *B, bvh_node *Node)
+    {
+        bvh_aabb Box = EmptyAABB();
+        for (u32 I = 0; I < Node->Count; ++I)
+        {
+            Grow(&Box, B->PrimBounds[B->Indices[Node->LeftFirst + I]]);
+        }
+        Node->Min = Box.Min;
+        Node->Max = Box.Max;
+    }
+    
+    // returns the SAH cost of the best split, F32Max if no valid split exists
+    inline f32
+        FindBestSplit(bvh_builder *B, bvh_node *Node, int *Axis_Out, f32 *SplitPos_Out)
+    {
+        f32 BestCost = F32Max;
+        
+        bvh_aabb CentroidBox = EmptyAABB();
+        for (u32 I = 0; I < Node->Count; ++I)
+        {
+            Grow(&CentroidBox, B->Centroids[B->Indices[Node->LeftFirst + I]]);
+        }
+        
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            f32 BoundsMin = CentroidBox.Min.Data[Axis];
+            f32 BoundsMax = CentroidBox.Max.Data[Axis];
+            if (BoundsMin == BoundsMax) continue;
+            
+            bvh_aabb BinBounds[CH_BVH_BIN_COUNT];
+            int BinCounts[CH_BVH_BIN_COUNT] = {};
+            for (int BinI = 0; BinI < CH_BVH_BIN_COUNT; ++BinI)
+            {
+                BinBounds[BinI] = EmptyAABB();
+            }
+            
+            f32 Scale = f32(CH_BVH_BIN_COUNT) / (BoundsMax - BoundsMin);
+            for (u32 I = 0; I < Node->Count; ++I)
+            {
+                i32 Prim = B->Indices[Node->LeftFirst + I];
+                int BinI = int((B->Centroids[Prim].Data[Axis] - BoundsMin) * Scale);
+                if (BinI > CH_BVH_BIN_COUNT - 1) BinI = CH_BVH_BIN_COUNT - 1;
+                BinCounts[BinI] += 1;
+                Grow(&BinBounds[BinI], B->PrimBounds[Prim]);
+            }
+            
+            // sweep from both sides to get the area/count left and right of every plane
+            f32 LeftArea[CH_BVH_BIN_COUNT - 1];
+            f32 RightArea[CH_BVH_BIN_COUNT - 1];
+            int LeftCount[CH_BVH_BIN_COUNT - 1];
+            int RightCount[CH_BVH_BIN_COUNT - 1];
+            bvh_aabb LeftBox = EmptyAABB();
+            bvh_aabb RightBox = EmptyAABB();
+            int LeftSum = 0;
+            int RightSum = 0;
+            for (int I = 0; I < CH_BVH_BIN_COUNT - 1; ++I)
+            {
+                LeftSum += BinCounts[I];
+                LeftCount[I] = LeftSum;
+                Grow(&LeftBox, BinBounds[I]);
+                LeftArea[I] = HalfArea(LeftBox);
+                
+                int J = CH_BVH_BIN_COUNT - 1 - I;
+                RightSum += BinCounts[J];
+                RightCount[J - 1] = RightSum;
+                Grow(&RightBox, BinBounds[J]);
+                RightArea[J - 1] = HalfArea(RightBox);
+            }
+            
+            f32 PlaneStep = (BoundsMax - BoundsMin) / f32(CH_BVH_BIN_COUNT);
+            for (int I = 0; I < CH_BVH_BIN_COUNT - 1; ++I)
+            {
+                if (LeftCount[I] == 0 || RightCount[I] == 0) continue;
+                
+                f32 Cost = f32(LeftCount[I]) * LeftArea[I] + f32(RightCount[I]) * RightArea[I];
+                if (Cost < BestCost)
+                {
+                    BestCost = Cost;
+                    *Axis_Out = Axis;
+                    *SplitPos_Out = BoundsMin + PlaneStep * f32(I + 1);
+                }
+            }
+        }
+        
+        return BestCost;
+    }
+    
+    inline void
+        Subdivide(bvh_builder *B, u32 NodeIndex, int Depth)
+    {
+        bvh_node *Node = B->Nodes + NodeIndex;
+        if (Node->Count <= 2) return;
+        
+        int Axis = 0;
+        f32 SplitPos = 0.0f;
+        f32 SplitCost = FindBestSplit(B, Node, &Axis, &SplitPos);
+        
+        bvh_aabb NodeBox = {Node->Min, Node->Max};
+        f32 LeafCost = f32(Node->Count) * HalfArea(NodeBox);
+        if (SplitCost >= LeafCost) return;
+        
+        // in-place partition of the index range
+        i32 I = i32(Node->LeftFirst);
+        i32 J = I + i32(Node->Count) - 1;
+        while (I <= J)
+        {
+            if (B->Centroids[B->Indices[I]].Data[Axis] < SplitPos)
+            {
+                I += 1;
+            }
+            else
+            {
+                i32 Temp = B->Indices[I];
+                B->Indices[I] = B->Indices[J];
+                B->Indices[J] = Temp;
+                J -= 1;
+            }
+        }
+        
+        u32 LeftCount = u32(I) - Node->LeftFirst;
+        if (LeftCount == 0 || LeftCount == Node->Count) return;
+        
+        u32 LeftIndex = B->NodesUsed.fetch_add(2);
+        u32 RightIndex = LeftIndex + 1;
+        bvh_node *Left = B->Nodes + LeftIndex;
+        bvh_node *Right = B->Nodes + RightIndex;
+        Left->LeftFirst = Node->LeftFirst;
+        Left->Count = LeftCount;
+        Right->LeftFirst = u32(I);
+        Right->Count = Node->Count - LeftCount;
+        Node->LeftFirst = LeftIndex;
+        Node->Count = 0;
+        UpdateNodeBounds(B, Left);
+        UpdateNodeBounds(B, Right);
+        
+        //NOTE(chen): the top levels fan out to threads, every thread then
+        //            owns a disjoint index range and only shares the node counter
+        if (Depth < B->ParallelDepth)
+        {
+            std::thread LeftThread(Subdivide, B, LeftIndex, Depth + 1);
+            Subdivide(B, RightIndex, Depth + 1);
+            LeftThread.join();
+        }
+        else
+        {
+            Subdivide(B, LeftIndex, Depth + 1);
+            Subdivide(B, RightIndex, Depth + 1);
+        }
+    }
+    
+    // ThreadCount <= 0 uses std::thread::hardware_concurrency()
+    inline bvh
+        BuildBVH(ch_obj::Model *Model, int ThreadCount = 0)
+    {
+        bvh BVH = {};
+        
+        int TriCount = Model->ib_count / 3;
+        if (TriCount == 0) return BVH;
+        
+        if (ThreadCount <= 0)
+        {
+            ThreadCount = int(std::thread::hardware_concurrency());
+            if (ThreadCount <= 0) ThreadCount = 1;
+        }
+        
+        bvh_builder B;
+        B.Nodes = (bvh_node *)calloc(2 * TriCount, sizeof(bvh_node));
+        B.NodesUsed = 2;
+        B.PrimBounds = (bvh_aabb *)malloc(TriCount * sizeof(bvh_aabb));
+        B.Centroids = (v3 *)malloc(TriCount * sizeof(v3));
+        B.Indices = (i32 *)malloc(TriCount * sizeof(i32));
+        B.ParallelDepth = 0;
+        while ((1 << B.ParallelDepth) < ThreadCount)
+        {
+            B.ParallelDepth += 1;
+        }
+        
+        v3 *Positions = (v3 *)Model->vb;
+        for (int TriI = 0; TriI < TriCount; ++TriI)
+        {
+            v3 A = Positions[Model->ib[9*TriI + 0]];
+            v3 C = Positions[Model->ib[9*TriI + 3]];
+            v3 D = Positions[Model->ib[9*TriI + 6]];
+            
+            bvh_aabb Box = EmptyAABB();
+            Grow(&Box, A);
+            Grow(&Box, C);
+            Grow(&Box, D);
+            B.PrimBounds[TriI] = Box;
+            B.Centroids[TriI] = 0.5f * (Box.Min + Box.Max);
+            B.Indices[TriI] = TriI;
+        }
+        
+        bvh_node *Root = B.Nodes;
+        Root->LeftFirst = 0;
+        Root->Count = u32(TriCount);
+        UpdateNodeBounds(&B, Root);
+        Subdivide(&B, 0, 0);
+        
+        BVH.Nodes = B.Nodes;
+        BVH.NodeCount = int(B.NodesUsed.load());
+        BVH.TriangleCount = TriCount;
+        BVH.TriangleIndices = B.Indices;
+        BVH.Triangles = (bvh_triangle *)malloc(TriCount * sizeof(bvh_triangle));
+        for (int I = 0; I < TriCount; ++I)
+        {
+            int TriI = B.Indices[I];
+            v3 A = Positions[Model->ib[9*TriI + 0]];
+            v3 C = Positions[Model->ib[9*TriI + 3]];
+            v3 D = Positions[Model->ib[9*TriI + 6]];
+            
+            BVH.Triangles[I].V0 = A;
+            BVH.Triangles[I].E1 = C - A;
+            BVH.Triangles[I].E2 = D - A;
+        }
+        
+        free(B.PrimBounds);
+        free(B.Centroids);
+        
+        return BVH;
+    }
+    
+    inline void
+        bvh::Free()
+    {
+        free(Nodes);
+        free(Triangles);
+        free(TriangleIndices);
+        *this = {};
+    }
+    
+    //
+    //
+    // single ray traversal
+    
+    // returns entry distance, F32Max on a miss
+    inline f32
+        IntersectAABB(v3 O, v3 InvD, f32 TMin, f32 TMax, bvh_node *Node)
+    {
+        f32 TX1 = (Node->Min.X - O.X) * InvD.X, TX2 = (Node->Max.X - O.X) * InvD.X;
+        f32 TNear = Min(TX1, TX2), TFar = Max(TX1, TX2);
+        f32 TY1 = (Node->Min.Y - O.Y) * InvD.Y, TY2 = (Node->Max.Y - O.Y) * InvD.Y;
+        TNear = Max(TNear, Min(TY1, TY2)), TFar = Min(TFar, Max(TY1, TY2));
+        f32 TZ1 = (Node->Min.Z - O.Z) * InvD.Z, TZ2 = (Node->Max.Z - O.Z) * InvD.Z;
+        TNear = Max(TNear, Min(TZ1, TZ2)), TFar = Min(TFar, Max(TZ1, TZ2));
+        
+        if (TFar >= TNear && TFar >= TMin && TNear < TMax) return TNear;
+        return F32Max;
+    }
+    
+    inline bool
+        IntersectTriangle(ray *Ray, bvh_triangle *Tri, f32 *T_Out, f32 *U_Out, f32 *V_Out)
+    {
+        v3 P = Cross(Ray->D, Tri->E2);
+        f32 Det = Dot(Tri->E1, P);
+        if (Det > -EPSILON && Det < EPSILON) return false;
+        
+        f32 InvDet = 1.0f / Det;
+        v3 S = Ray->O - Tri->V0;
+        f32 U = InvDet * Dot(S, P);
+        if (U < 0.0f || U > 1.0f) return false;
+        
+        v3 Q = Cross(S, Tri->E1);
+        f32 V = InvDet * Dot(Ray->D, Q);
+        if (V < 0.0f || U + V > 1.0f) return false;
+        
+        f32 T = InvDet * Dot(Tri->E2, Q);
+        if (T < Ray->TMin || T >= Ray->TMax) return false;
+        
+        *T_Out = T;
+        *U_Out = U;
+        *V_Out = V;
+        return true;
+    }
+    
+    inline v3
+        SafeInverse(v3 D)
+    {
+        return V3(1.0f / D.X, 1.0f / D.Y, 1.0f / D.Z);
+    }
+    
+    inline bool
+        bvh::Intersect(ray Ray, hit *Hit_Out)
+    {
+        hit Hit = {};
+        Hit.TriangleIndex = -1;
+        if (!Nodes)
+        {
+            *Hit_Out = Hit;
+            return false;
+        }
+        
+        v3 InvD = SafeInverse(Ray.D);
+        u32 Stack[CH_BVH_STACK_SIZE];
+        int StackSize = 0;
+        
+        bvh_node *Node = Nodes;
+        if (IntersectAABB(Ray.O, InvD, Ray.TMin, Ray.TMax, Node) == F32Max)
+        {
+            *Hit_Out = Hit;
+            return false;
+        }
+        
+        for (;;)
+        {
+            if (Node->Count)
+            {
+                for (u32 I = 0; I < Node->Count; ++I)
+                {
+                    u32 TriI = Node->LeftFirst + I;
+                    f32 T, U, V;
+                    if (IntersectTriangle(&Ray, Triangles + TriI, &T, &U, &V))
+                    {
+                        Ray.TMax = T;
+                        Hit.T = T;
+                        Hit.U = U;
+                        Hit.V = V;
+                        Hit.TriangleIndex = TriangleIndices[TriI];
+                    }
+                }
+            }
+            else
+            {
+                bvh_node *Left = Nodes + Node->LeftFirst;
+                bvh_node *Right = Left + 1;
+                f32 DistL = IntersectAABB(Ray.O, InvD, Ray.TMin, Ray.TMax, Left);
+                f32 DistR = IntersectAABB(Ray.O, InvD, Ray.TMin, Ray.TMax, Right);
+                if (DistL > DistR)
+                {
+                    f32 TempDist = DistL; DistL = DistR; DistR = TempDist;
+                    bvh_node *TempNode = Left; Left = Right; Right = TempNode;
+                }
+                
+                if (DistL != F32Max)
+                {
+                    if (DistR != F32Max)
+                    {
+                        CH_ASSERT(StackSize < CH_BVH_STACK_SIZE);
+                        Stack[StackSize++] = u32(Right - Nodes);
+                    }
+                    Node = Left;
+                    continue;
+                }
+            }
+            
+            if (StackSize == 0) break;
+            Node = Nodes + Stack[--StackSize];
+        }
+        
+        *Hit_Out = Hit;
+        return Hit.TriangleIndex != -1;
+    }
+    
+    inline bool
+        bvh::Occluded(ray Ray)
+    {
+        if (!Nodes) return false;
+        
+        v3 InvD = SafeInverse(Ray.D);
+        u32 Stack[CH_BVH_STACK_SIZE];
+        int StackSize = 0;
+        Stack[StackSize++] = 0;
+        
+        while (StackSize)
+        {
+            bvh_node *Node = Nodes + Stack[--StackSize];
+            if (IntersectAABB(Ray.O, InvD, Ray.TMin, Ray.TMax, Node) == F32Max) continue;
+            
+            if (Node->Count)
+            {
+                for (u32 I = 0; I < Node->Count; ++I)
+                {
+                    f32 T, U, V;
+                    if (IntersectTriangle(&Ray, Triangles + Node->LeftFirst + I, &T, &U, &V))
+                    {
+                        return true;
+                    }
+                }
+            }
+            else
+            {
+                CH_ASSERT(StackSize + 2 <= CH_BVH_STACK_SIZE);
+                Stack[StackSize++] = Node->LeftFirst + 1;
+                Stack[StackSize++] = Node->LeftFirst;
+            }
+        }
+        
+        return false;
+    }
+    
+    //
+    //
+    // packet traversal
+    
+    //NOTE(chen): lanes are processed with straight-line loops over N so the
+    //            compiler can turn each of them into 4/8-wide SIMD.
+    //            A lane is considered dead once its TMax drops below TMin.
+    
+    template <int N>
+        struct packet_context
+    {
+        f32 InvDX[N], InvDY[N], InvDZ[N];
+        f32 T[N];
+        f32 U[N];
+        f32 V[N];
+        i32 TriangleIndex[N];
+    };
+    
+    // returns the smallest entry distance over all lanes, F32Max if no lane hits
+    template <int N>
+        inline f32
+        IntersectAABB(ray_packet<N> *P, packet_context<N> *C, bvh_node *Node)
+    {
+        f32 Best = F32Max;
+        for (int I = 0; I < N; ++I)
+        {
+            f32 TX1 = (Node->Min.X - P->OX[I]) * C->InvDX[I], TX2 = (Node->Max.X - P->OX[I]) * C->InvDX[I];
+            f32 TY1 = (Node->Min.Y - P->OY[I]) * C->InvDY[I], TY2 = (Node->Max.Y - P->OY[I]) * C->InvDY[I];
+            f32 TZ1 = (Node->Min.Z - P->OZ[I]) * C->InvDZ[I], TZ2 = (Node->Max.Z - P->OZ[I]) * C->InvDZ[I];
+            f32 TNear = Max(Max(Min(TX1, TX2), Min(TY1, TY2)), Min(TZ1, TZ2));
+            f32 TFar = Min(Min(Max(TX1, TX2), Max(TY1, TY2)), Max(TZ1, TZ2));
+            bool Hit = TFar >= TNear && TFar >= P->TMin[I] && TNear < C->T[I];
+            Best = Hit? Min(Best, TNear): Best;
+        }
+        return Best;
+    }
+    
+    // returns true if any lane got a closer hit
+    template <int N>
+        inline bool
+        IntersectTriangle(ray_packet<N> *P, packet_context<N> *C, bvh_triangle *Tri, i32 TriangleIndex)
+    {
+        bool AnyHit = false;
+        for (int I = 0; I < N; ++I)
+        {
+            // P = D x E2
+            f32 PX = P->DY[I] * Tri->E2.Z - P->DZ[I] * Tri->E2.Y;
+            f32 PY = P->DZ[I] * Tri->E2.X - P->DX[I] * Tri->E2.Z;
+            f32 PZ = P->DX[I] * Tri->E2.Y - P->DY[I] * Tri->E2.X;
+            f32 Det = Tri->E1.X * PX + Tri->E1.Y * PY + Tri->E1.Z * PZ;
+            f32 InvDet = 1.0f / Det;
+            
+            f32 SX = P->OX[I] - Tri->V0.X;
+            f32 SY = P->OY[I] - Tri->V0.Y;
+            f32 SZ = P->OZ[I] - Tri->V0.Z;
+            f32 U = InvDet * (SX * PX + SY * PY + SZ * PZ);
+            
+            // Q = S x E1
+            f32 QX = SY * Tri->E1.Z - SZ * Tri->E1.Y;
+            f32 QY = SZ * Tri->E1.X - SX * Tri->E1.Z;
+            f32 QZ = SX * Tri->E1.Y - SY * Tri->E1.X;
+            f32 V = InvDet * (P->DX[I] * QX + P->DY[I] * QY + P->DZ[I] * QZ);
+            f32 T = InvDet * (Tri->E2.X * QX + Tri->E2.Y * QY + Tri->E2.Z * QZ);
+            
+            bool Hit = (Det <= -EPSILON || Det >= EPSILON) &&
+                U >= 0.0f && V >= 0.0f && U + V <= 1.0f &&
+                T >= P->TMin[I] && T < C->T[I];
+            
+            C->T[I] = Hit? T: C->T[I];
+            C->U[I] = Hit? U: C->U[I];
+            C->V[I] = Hit? V: C->V[I];
+            C->TriangleIndex[I] = Hit? TriangleIndex: C->TriangleIndex[I];
+            AnyHit |= Hit;
+        }
+        return AnyHit;
+    }
+    
+    template <int N>
+        inline void
+        InitPacketContext(ray_packet<N> *P, packet_context<N> *C)
+    {
+        for (int I = 0; I < N; ++I)
+        {
+            C->InvDX[I] = 1.0f / P->DX[I];
+            C->InvDY[I] = 1.0f / P->DY[I];
+            C->InvDZ[I] = 1.0f / P->DZ[I];
+            C->T[I] = P->TMax[I];
+            C->U[I] = 0.0f;
+            C->V[I] = 0.0f;
+            C->TriangleIndex[I] = -1;
+        }
+    }
+    
+    template <int N>
+        void
+        bvh::Intersect(ray_packet<N> *Packet, hit *Hits_Out)
+    {
+        packet_context<N> C;
+        InitPacketContext(Packet, &C);
+        
+        if (Nodes && IntersectAABB(Packet, &C, Nodes) != F32Max)
+        {
+            u32 Stack[CH_BVH_STACK_SIZE];
+            int StackSize = 0;
+            bvh_node *Node = Nodes;
+            
+            for (;;)
+            {
+                if (Node->Count)
+                {
+                    for (u32 I = 0; I < Node->Count; ++I)
+                    {
+                        u32 TriI = Node->LeftFirst + I;
+                        IntersectTriangle(Packet, &C, Triangles + TriI, TriangleIndices[TriI]);
+                    }
+                }
+                else
+                {
+                    bvh_node *Left = Nodes + Node->LeftFirst;
+                    bvh_node *Right = Left + 1;
+                    f32 DistL = IntersectAABB(Packet, &C, Left);
+                    f32 DistR = IntersectAABB(Packet, &C, Right);
+                    if (DistL > DistR)
+                    {
+                        f32 TempDist = DistL; DistL = DistR; DistR = TempDist;
+                        bvh_node *TempNode = Left; Left = Right; Right = TempNode;
+                    }
+                    
+                    if (DistL != F32Max)
+                    {
+                        if (DistR != F32Max)
+                        {
+                            CH_ASSERT(StackSize < CH_BVH_STACK_SIZE);
+                            Stack[StackSize++] = u32(Right - Nodes);
+                        }
+                        Node = Left;
+                        continue;
+                    }
+                }
+                
+                //NOTE(chen): lanes may have found closer hits since the node
+                //            got pushed, so re-test before descending
+                bool Found = false;
+                while (StackSize)
+                {
+                    Node = Nodes + Stack[--StackSize];
+                    if (IntersectAABB(Packet, &C, Node) != F32Max)
+                    {
+                        Found = true;
+                        break;
+                    }
+                }
+                if (!Found) break;
+            }
+        }
+        
+        for (int I = 0; I < N; ++I)
+        {
+            Hits_Out[I].T = C.T[I];
+            Hits_Out[I].U = C.U[I];
+            Hits_Out[I].V = C.V[I];
+            Hits_Out[I].TriangleIndex = C.TriangleIndex[I];
+        }
+    }
+    
+    template <int N>
+        void
+        bvh::Occluded(ray_packet<N> *Packet, bool *Occluded_Out)
+    {
+        packet_context<N> C;
+        InitPacketContext(Packet, &C);
+        
+        for (int I = 0; I < N; ++I)
+        {
+            Occluded_Out[I] = false;
+        }
+        if (!Nodes) return;
+        
+        int ActiveCount = N;
+        u32 Stack[CH_BVH_STACK_SIZE];
+        int StackSize = 0;
+        Stack[StackSize++] = 0;
+        
+        while (StackSize && ActiveCount)
+        {
+            bvh_node *Node = Nodes + Stack[--StackSize];
+            if (IntersectAABB(Packet, &C, Node) == F32Max) continue;
+            
+            if (Node->Count)
+            {
+                for (u32 TriI = 0; TriI < Node->Count; ++TriI)
+                {
+                    u32 Slot = Node->LeftFirst + TriI;
+                    if (IntersectTriangle(Packet, &C, Triangles + Slot, TriangleIndices[Slot]))
+                    {
+                        // retire every lane that got blocked
+                        ActiveCount = 0;
+                        for (int I = 0; I < N; ++I)
+                        {
+                            if (C.TriangleIndex[I] != -1)
+                            {
+                                Occluded_Out[I] = true;
+                                C.T[I] = -F32Max;
+                            }
+                            ActiveCount += Occluded_Out[I]? 0: 1;
+                        }
+                        if (!ActiveCount) break;
+                    }
+                }
+            }
+            else
+            {
+                CH_ASSERT(StackSize + 2 <= CH_BVH_STACK_SIZE);
+                Stack[StackSize++] = Node->LeftFirst + 1;
+                Stack[StackSize++] = Node->LeftFirst;
+            }
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,438 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch::capture_queue Capture;
+ch::InitCaptureQueue(&Capture, 1920, 1080, 4, ch::CapturePolicy_Block, ch::CaptureFormat_BMP);
+
+// every frame, on the render thread. Copies the pixels into a pooled buffer and returns,
+// false if the frame was dropped
+char Path[64];
+snprintf(Path, sizeof(Path), "frames/%06d.bmp", FrameIndex);
+ch::SubmitCaptureFrame(&Capture, Path, Pixels, Width, Height, Width * 4,
+                       ch::CapturePixel_RGBA8, true); // glReadPixels rows are bottom-up
+
+// or read back straight into a pooled buffer, no extra copy
+ch::capture_frame *Frame = ch::BeginCaptureFrame(&Capture);
+if (Frame)
+{
+    glReadPixels(...) / memcpy into Frame->Pixels, rows Frame->Pitch apart, RGBA8 top to bottom
+    ch::EndCaptureFrame(&Capture, Frame, Path, Width, Height);
+}
+
+ch::capture_stats Stats = ch::GetCaptureStats(&Capture);
+printf("%d queued, %llu dropped, %.2f ms/frame\n", Stats.QueueDepth,
+       (unsigned long long)Stats.Dropped, 1000.0 * Stats.TotalEncodeSeconds / Stats.Written);
+
+ch::FreeCaptureQueue(&Capture); // writes whatever is still queued, then stops the writer
+
+The queue owns FrameCount buffers of MaxWidth x MaxHeight RGBA8, allocated once
+up front. A single writer thread takes submitted frames in order, encodes them
+(ch_bmp, or QOI/PNG from ch_image) and writes them out, then hands the buffer
+back. When every buffer is taken the policy decides what the render thread does:
+
+Block        wait for the writer to free one, no frame is ever lost
+DropNewest   skip the frame being captured
+DropOldest   recycle the oldest frame that's still waiting to be written
+
+With Block the render thread can only stall when encoding falls behind on
+average, bursts get absorbed by the pool.
+*/
+
+#include "ch_image.h"
+#include "ch_bmp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#ifndef CH_CAPTURE_MAX_PATH
+#define CH_CAPTURE_MAX_PATH 260
+#endif
+
+namespace ch
+{
+    enum capture_policy
+    {
+        CapturePolicy_Block,
+        CapturePolicy_DropNewest,
+        CapturePolicy_DropOldest,
+    };
+    
+    enum capture_format
+    {
+        CaptureFormat_BMP, // 24-bit, no compression, fastest to write
+        CaptureFormat_QOI,
+        CaptureFormat_PNG,
+    };
+    
+    enum capture_pixel_format
+    {
+        CapturePixel_RGBA8, // bytes R, G, B, A (GL_RGBA)
+        CapturePixel_BGRA8, // 0xAARRGGBB (ch_raster, DXGI_FORMAT_B8G8R8A8)
+    };
+    
+    struct capture_frame
+    {
+        u8 *Pixels; // RGBA8, rows top to bottom
+        size_t Pitch;
+        int Width;
+        int Height;
+        u64 Index; // order of submission
+        char Path[CH_CAPTURE_MAX_PATH];
+        
+        image Buffer;
+    };
+    
+    struct capture_stats
+    {
+        int QueueDepth; // submitted, not written yet
+        int MaxQueueDepth;
+        u64 Submitted;
+        u64 Written;
+        u64 Dropped;
+        u64 Failed; // encoding or file errors
+        u64 BytesWritten;
+        f64 TotalEncodeSeconds; // encode + write, on the writer thread
+        f64 MaxEncodeSeconds;
+        f64 BlockedSeconds; // time producers waited for a free buffer
+    };
+    
+    // replaces encoding + writing to Path, e.g. to stream frames out over a socket.
+    // Runs on the writer thread, returns false on failure
+    typedef bool capture_write_callback(const capture_frame *Frame, void *UserData);
+    
+    struct capture_queue
+    {
+        capture_frame *Frames;
+        int FrameCount;
+        int MaxWidth;
+        int MaxHeight;
+        capture_policy Policy;
+        capture_format Format;
+        int PNGThreadCount; // threads EncodePNG may use, 1 keeps it on the writer thread
+        
+        capture_write_callback *WriteCallback;
+        void *CallbackData;
+        
+        std::mutex Lock;
+        std::condition_variable WorkReady; // writer waits on this
+        std::condition_variable FrameDone; // producers and flushes wait on this
+        int *FreeFrames;
+        int FreeCount;
+        int *Pending; // ring, oldest at PendingHead
+        int PendingHead;
+        int PendingCount;
+        int WritingFrame; // -1 when the writer is idle
+        u64 NextIndex;
+        bool Quit;
+        capture_stats Stats;
+        
+        std::thread Writer;
+    };
+    
+    //
+    //
+    // writer thread
+    
+    inline f64
+        GetCaptureSeconds()
+    {
+        using namespace std::chrono;
+        return duration<f64>(steady_clock::now().time_since_epoch()).count();
+    }
+    
+    inline bool
+        WriteCaptureFrame(capture_queue *Queue, const capture_frame *Frame, u64 *BytesWritten)
+    {
+        *BytesWritten = 0;
+        if (Queue->WriteCallback)
+        {
+            return Queue->WriteCallback(Frame, Queue->CallbackData);
+        }
+        
+        bool Result = false;
+        if (Queue->Format == CaptureFormat_BMP)
+        {
+            CH_BMP::bmp_writer Writer;
+            if (CH_BMP::BeginBMP(&Writer, Frame->Path, Frame->Width, Frame->Height, 24, CH_BMP::BMPPixel_RGBA8))
+            {
+                CH_BMP::WriteBMPRows(&Writer, 0, Frame->Height, (const uint32_t *)Frame->Pixels, Frame->Pitch);
+                Result = CH_BMP::EndBMP(&Writer);
+                *BytesWritten = Writer.DataOffset + (u64)Writer.RowStride * Frame->Height;
+            }
+        }
+        else
+        {
+            size_t Size = 0;
+            u8 *Data = (Queue->Format == CaptureFormat_QOI?
+                        EncodeQOI(Frame->Pixels, Frame->Width, Frame->Height, Frame->Pitch, 4, &Size):
+                        EncodePNG(Frame->Pixels, Frame->Width, Frame->Height, Frame->Pitch, 4, Queue->PNGThreadCount, &Size));
+            if (Data)
+            {
+                Result = WriteFileData(Frame->Path, Data, Size);
+                *BytesWritten = Size;
+                free(Data);
+            }
+        }
+        
+        if (!Result)
+        {
+            *BytesWritten = 0;
+        }
+        return Result;
+    }
+    
+    inline void
+        CaptureWriterLoop(capture_queue *Queue)
+    {
+        std::unique_lock<std::mutex> Guard(Queue->Lock);
+        for (;;)
+        {
+            Queue->WorkReady.wait(Guard, [Queue]() { return Queue->PendingCount > 0 || Queue->Quit; });
+            if (Queue->PendingCount == 0)
+            {
+                break; // quitting, and everything is written
+            }
+            
+            int FrameIndex = Queue->Pending[Queue->PendingHead];
+            Queue->PendingHead = (Queue->PendingHead + 1) % Queue->FrameCount;
+            Queue->PendingCount--;
+            Queue->WritingFrame = FrameIndex;
+            
+            Guard.unlock();
+            f64 Begin = GetCaptureSeconds();
+            u64 BytesWritten = 0;
+            bool Written = WriteCaptureFrame(Queue, &Queue->Frames[FrameIndex], &BytesWritten);
+            f64 Elapsed = GetCaptureSeconds() - Begin;
+            Guard.lock();
+            
+            capture_stats *Stats = &Queue->Stats;
+            Stats->Written += Written? 1: 0;
+            Stats->Failed += Written? 0: 1;
+            Stats->BytesWritten += BytesWritten;
+            Stats->TotalEncodeSeconds += Elapsed;
+            Stats->MaxEncodeSeconds = Elapsed > Stats->MaxEncodeSeconds? Elapsed: Stats->MaxEncodeSeconds;
+            
+            Queue->WritingFrame = -1;
+            Queue->FreeFrames[Queue->FreeCount++] = FrameIndex;
+            Queue->FrameDone.notify_all();
+        }
+    }
+    
+    //
+    //
+    // API
+    
+    inline bool
+        InitCaptureQueue(capture_queue *Queue, int MaxWidth, int MaxHeight, int FrameCount = 4,
+                         capture_policy Policy = CapturePolicy_Block, capture_format Format = CaptureFormat_BMP)
+    {
+        if (MaxWidth <= 0 || MaxHeight <= 0 || FrameCount <= 0)
+        {
+            return false;
+        }
+        
+        Queue->Frames = (capture_frame *)calloc((size_t)FrameCount, sizeof(capture_frame));
+        Queue->FreeFrames = (int *)malloc(sizeof(int) * FrameCount);
+        Queue->Pending = (int *)malloc(sizeof(int) * FrameCount);
+        bool Allocated = Queue->Frames && Queue->FreeFrames && Queue->Pending;
+        for (int I = 0; Allocated && I < FrameCount; ++I)
+        {
+            capture_frame *Frame = &Queue->Frames[I];
+            Frame->Buffer = AllocateImage(MaxWidth, MaxHeight);
+            Frame->Pixels = Frame->Buffer.Pixels;
+            Frame->Pitch = Frame->Buffer.Pitch;
+            Allocated = Frame->Pixels != 0;
+            
+            //NOTE(chen): touch every page now, first-touch page faults would otherwise
+            //            land on the render thread during the first few captures
+            if (Allocated) memset(Frame->Pixels, 0, Frame->Pitch * MaxHeight);
+        }
+        if (!Allocated)
+        {
+            for (int I = 0; Queue->Frames && I < FrameCount; ++I) FreeImage(&Queue->Frames[I].Buffer);
+            free(Queue->Frames);
+            free(Queue->FreeFrames);
+            free(Queue->Pending);
+            Queue->Frames = 0;
+            return false;
+        }
+        
+        Queue->FrameCount = FrameCount;
+        Queue->MaxWidth = MaxWidth;
+        Queue->MaxHeight = MaxHeight;
+        Queue->Policy = Policy;
+        Queue->Format = Format;
+        Queue->PNGThreadCount = 1;
+        Queue->WriteCallback = 0;
+        Queue->CallbackData = 0;
+        for (int I = 0; I < FrameCount; ++I)
+        {
+            Queue->FreeFrames[I] = FrameCount - 1 - I;
+        }
+        Queue->FreeCount = FrameCount;
+        Queue->PendingHead = 0;
+        Queue->PendingCount = 0;
+        Queue->WritingFrame = -1;
+        Queue->NextIndex = 0;
+        Queue->Quit = false;
+        Queue->Stats = {};
+        Queue->Writer = std::thread(CaptureWriterLoop, Queue);
+        return true;
+    }
+    
+    // a free buffer to fill, 0 if the frame got dropped. Every frame returned
+    // has to go back through EndCaptureFrame or CancelCaptureFrame
+    inline capture_frame *
+        BeginCaptureFrame(capture_queue *Queue)
+    {
+        std::unique_lock<std::mutex> Guard(Queue->Lock);
+        
+        int FrameIndex = -1;
+        if (Queue->FreeCount > 0)
+        {
+            FrameIndex = Queue->FreeFrames[--Queue->FreeCount];
+        }
+        else if (Queue->Policy == CapturePolicy_Block)
+        {
+            //NOTE(chen): only waits for the writer, if the caller itself holds every
+            //            buffer (Begin without End) this never returns
+            f64 Begin = GetCaptureSeconds();
+            Queue->FrameDone.wait(Guard, [Queue]() { return Queue->FreeCount > 0; });
+            Queue->Stats.BlockedSeconds += GetCaptureSeconds() - Begin;
+            FrameIndex = Queue->FreeFrames[--Queue->FreeCount];
+        }
+        else if (Queue->Policy == CapturePolicy_DropOldest && Queue->PendingCount > 0)
+        {
+            FrameIndex = Queue->Pending[Queue->PendingHead];
+            Queue->PendingHead = (Queue->PendingHead + 1) % Queue->FrameCount;
+            Queue->PendingCount--;
+            Queue->Stats.Dropped++;
+        }
+        else
+        {
+            Queue->Stats.Dropped++;
+            return 0;
+        }
+        
+        return &Queue->Frames[FrameIndex];
+    }
+    
+    // queues the frame for writing, Width/Height up to the queue's maximum
+    inline bool
+        EndCaptureFrame(capture_queue *Queue, capture_frame *Frame, const char *Path, int Width, int Height)
+    {
+        int FrameIndex = (int)(Frame - Queue->Frames);
+        size_t PathLength = strlen(Path);
+        bool Valid = (Width > 0 && Height > 0 && Width <= Queue->MaxWidth && Height <= Queue->MaxHeight &&
+                      PathLength < CH_CAPTURE_MAX_PATH);
+        
+        std::unique_lock<std::mutex> Guard(Queue->Lock);
+        if (!Valid)
+        {
+            Queue->Stats.Failed++;
+            Queue->FreeFrames[Queue->FreeCount++] = FrameIndex;
+            Queue->FrameDone.notify_all();
+            return false;
+        }
+        
+        memcpy(Frame->Path, Path, PathLength + 1);
+        Frame->Width = Width;
+        Frame->Height = Height;
+        Frame->Index = Queue->NextIndex++;
+        
+        int Tail = (Queue->PendingHead + Queue->PendingCount) % Queue->FrameCount;
+        Queue->Pending[Tail] = FrameIndex;
+        Queue->PendingCount++;
+        Queue->Stats.Submitted++;
+        if (Queue->PendingCount > Queue->Stats.MaxQueueDepth)
+        {
+            Queue->Stats.MaxQueueDepth = Queue->PendingCount;
+        }
+        Queue->WorkReady.notify_one();
+        return true;
+    }
+    
+    // gives a frame from BeginCaptureFrame back without writing it
+    inline void
+        CancelCaptureFrame(capture_queue *Queue, capture_frame *Frame)
+    {
+        std::unique_lock<std::mutex> Guard(Queue->Lock);
+        Queue->FreeFrames[Queue->FreeCount++] = (int)(Frame - Queue->Frames);
+        Queue->FrameDone.notify_all();
+    }
+    
+    // copies Pixels into a pooled buffer (converting to RGBA8 top to bottom) and queues it.
+    // Pitch in bytes, false if the frame was dropped or doesn't fit
+    inline bool
+        SubmitCaptureFrame(capture_queue *Queue, const char *Path, const void *Pixels, int Width, int Height, size_t Pitch,
+                           capture_pixel_format Format = CapturePixel_RGBA8, bool BottomUp = false)
+    {
+        if (Width <= 0 || Height <= 0 || Width > Queue->MaxWidth || Height > Queue->MaxHeight)
+        {
+            std::unique_lock<std::mutex> Guard(Queue->Lock);
+            Queue->Stats.Failed++;
+            return false;
+        }
+        
+        capture_frame *Frame = BeginCaptureFrame(Queue);
+        if (!Frame)
+        {
+            return false;
+        }
+        
+        for (int Y = 0; Y < Height; ++Y)
+        {
+            const u8 *Src = (const u8 *)Pixels + Pitch * (BottomUp? Height - 1 - Y: Y);
+            CopyPixels32(Frame->Pixels + Frame->Pitch * Y, Src, Width, Format == CapturePixel_BGRA8);
+        }
+        
+        return EndCaptureFrame(Queue, Frame, Path, Width, Height);
+    }
+    
+    inline capture_stats
+        GetCaptureStats(capture_queue *Queue)
+    {
+        std::unique_lock<std::mutex> Guard(Queue->Lock);
+        capture_stats Result = Queue->Stats;
+        Result.QueueDepth = Queue->PendingCount;
+        return Result;
+    }
+    
+    // waits until every submitted frame is written
+    inline void
+        FlushCaptureQueue(capture_queue *Queue)
+    {
+        std::unique_lock<std::mutex> Guard(Queue->Lock);
+        Queue->FrameDone.wait(Guard, [Queue]() { return Queue->PendingCount == 0 && Queue->WritingFrame == -1; });
+    }
+    
+    inline void
+        FreeCaptureQueue(capture_queue *Queue)
+    {
+        if (!Queue->Frames)
+        {
+            return;
+        }
+        
+        {
+            std::unique_lock<std::mutex> Guard(Queue->Lock);
+            Queue->Quit = true;
+            Queue->WorkReady.notify_one();
+        }
+        Queue->Writer.join();
+        
+        for (int I = 0; I < Queue->FrameCount; ++I)
+        {
+            FreeImage(&Queue->Frames[I].Buffer);
+        }
+        free(Queue->Frames);
+        free(Queue->FreeFrames);
+        free(Queue->Pending);
+        Queue->Frames = 0;
+    }
+};
\ No newline at end of file
@@ -10,15 +10,22 @@
 #include <stdint.h>
 #include <assert.h>
 
-// plug your own assert
+// plug your own assert, before ch_texcache.h so its headers get this one
 #ifndef CH_ASSERT
 #define CH_ASSERT(Value) assert(Value)
 #endif
 
+#include "ch_texcache.h"
+
 #ifndef CH_ARRAY_COUNT
 #define CH_ARRAY_COUNT(Array) (sizeof(Array)/sizeof((Array)[0]))
 #endif
 
+// where LoadTexture2D keeps its transcoded textures
+#ifndef CH_TEXTURE_CACHE_DIRECTORY
+#define CH_TEXTURE_CACHE_DIRECTORY "texcache"
+#endif
+
 namespace ch
 {
 #define CH_DXOP(Value) CH_ASSERT(SUCCEEDED(Value))
@@ -94,6 +101,7 @@ namespace ch
         void CopyResourceBarriered(texture *Dest, texture *Source);
         
         void Upload(texture *Tex, void *Data);
+        void UploadTextureFile(texture *Tex, const texture_file *File);
         texture LoadTexture2D(char *Filename, DXGI_FORMAT Format, 
                               D3D12_RESOURCE_FLAGS Flags, 
                               D3D12_RESOURCE_STATES ResourceStates);
@@ -683,7 +691,8 @@ namespace ch
     
     static texture
         InitTexture2D(ID3D12Device *D, int Width, int Height, DXGI_FORMAT Format,
-                      D3D12_RESOURCE_FLAGS Flags, D3D12_RESOURCE_STATES ResourceState)
+                      D3D12_RESOURCE_FLAGS Flags, D3D12_RESOURCE_STATES ResourceState,
+                      int MipLevels = 1)
     {
         texture Tex = {};
         Tex.ResourceState = ResourceState;
@@ -694,7 +703,7 @@ namespace ch
         ResourceDesc.Width = Width;
         ResourceDesc.Height = Height;
         ResourceDesc.DepthOrArraySize = 1;
-        ResourceDesc.MipLevels = 1;
+        ResourceDesc.MipLevels = UINT16(MipLevels);
         ResourceDesc.Format = Format;
         ResourceDesc.SampleDesc = {1, 0};
         ResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
@@ -770,27 +779,21 @@ namespace ch
         int BytesPerPixel = GetBytesPerTexel(Format);
         int BytesPerRow = BytesPerPixel * Width;
         
-        size_t PaddedTexDataSize = Height * RowPitch;
-        uint8_t *PaddedTexData = (uint8_t *)calloc(PaddedTexDataSize, 1);
-        
-        uint8_t *Reader = (uint8_t *)TexData;
-        uint8_t *Writer = PaddedTexData;
-        for (int Y = 0; Y < Height; ++Y)
-        {
-            for (int X = 0; X < BytesPerRow; ++X)
-            {
-                Writer[X] = Reader[X];
-            }
-            Writer += RowPitch;
-            Reader += BytesPerRow;
-        }
-        
+        size_t StagingSize = size_t(Height) * RowPitch;
         ID3D12Resource *StagingBuffer = InitBuffer(Device, 
-                                                   PaddedTexDataSize,
+                                                   StagingSize,
                                                    D3D12_HEAP_TYPE_UPLOAD,
                                                    D3D12_RESOURCE_STATE_GENERIC_READ,
                                                    D3D12_RESOURCE_FLAG_NONE);
-        ch::Upload(StagingBuffer, PaddedTexData, PaddedTexDataSize);
+        
+        //NOTE(chen): upload heaps are write-combined, so rows get streamed straight
+        //            into the mapped buffer instead of padding a copy in system memory first
+        D3D12_RANGE ReadRange = {};
+        void *MappedAddr = 0;
+        CH_DXOP(StagingBuffer->Map(0, &ReadRange, &MappedAddr));
+        CopyRows(MappedAddr, RowPitch, TexData, BytesPerRow, BytesPerRow, Height, true);
+        D3D12_RANGE WriteRange = {0, StagingSize};
+        StagingBuffer->Unmap(0, &WriteRange);
         
         Reset(0);
         
@@ -820,7 +823,110 @@ namespace ch
         WaitForGpu(0);
         
         StagingBuffer->Release();
-        free(PaddedTexData);
+    }
+    
+    //NOTE(chen): texture files are laid out like the copyable footprints of their mip chain,
+    //            so normally the whole chain is one streaming copy out of the (mapped) file.
+    //            Rows get copied one by one only if the device disagrees about the layout
+    void gpu_context::UploadTextureFile(texture *Tex, const texture_file *File)
+    {
+        const texture_file_header *Header = File->Header;
+        D3D12_RESOURCE_DESC Desc = Tex->Handle->GetDesc();
+        UINT LevelCount = Header->LevelCount;
+        CH_ASSERT(Desc.MipLevels == LevelCount);
+        
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT Footprints[CH_MAX_MIP_LEVELS] = {};
+        UINT RowCounts[CH_MAX_MIP_LEVELS] = {};
+        UINT64 RowSizes[CH_MAX_MIP_LEVELS] = {};
+        UINT64 StagingSize = 0;
+        Device->GetCopyableFootprints(&Desc, 0, LevelCount, 0, Footprints, RowCounts, RowSizes, &StagingSize);
+        
+        bool SameLayout = StagingSize >= Header->DataSize;
+        for (UINT LevelI = 0; LevelI < LevelCount; ++LevelI)
+        {
+            const texture_file_level *Level = &Header->Levels[LevelI];
+            SameLayout = SameLayout && Footprints[LevelI].Offset == Level->Offset &&
+                Footprints[LevelI].Footprint.RowPitch == Level->RowPitch &&
+                RowCounts[LevelI] == Level->RowCount;
+        }
+        
+        ID3D12Resource *StagingBuffer = InitBuffer(Device, 
+                                                   size_t(StagingSize),
+                                                   D3D12_HEAP_TYPE_UPLOAD,
+                                                   D3D12_RESOURCE_STATE_GENERIC_READ,
+                                                   D3D12_RESOURCE_FLAG_NONE);
+        D3D12_RANGE ReadRange = {};
+        void *MappedAddr = 0;
+        CH_DXOP(StagingBuffer->Map(0, &ReadRange, &MappedAddr));
+        if (SameLayout)
+        {
+            CopyRows(MappedAddr, 0, File->Data, 0, size_t(Header->DataSize), 1, true);
+        }
+        else
+        {
+            for (UINT LevelI = 0; LevelI < LevelCount; ++LevelI)
+            {
+                const texture_file_level *Level = &Header->Levels[LevelI];
+                UINT RowCount = RowCounts[LevelI] < Level->RowCount? RowCounts[LevelI]: Level->RowCount;
+                CopyRows((u8 *)MappedAddr + Footprints[LevelI].Offset, Footprints[LevelI].Footprint.RowPitch,
+                         File->Data + Level->Offset, Level->RowPitch, size_t(RowSizes[LevelI]), RowCount, true);
+            }
+        }
+        D3D12_RANGE WriteRange = {0, size_t(StagingSize)};
+        StagingBuffer->Unmap(0, &WriteRange);
+        
+        Reset(0);
+        
+        D3D12_RESOURCE_STATES TexState = Tex->ResourceState;
+        TransitionBarrier(Tex, D3D12_RESOURCE_STATE_COPY_DEST);
+        FlushBarriers();
+        
+        for (UINT LevelI = 0; LevelI < LevelCount; ++LevelI)
+        {
+            D3D12_TEXTURE_COPY_LOCATION DestLocation = {};
+            DestLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            DestLocation.pResource = Tex->Handle;
+            DestLocation.SubresourceIndex = LevelI;
+            
+            D3D12_TEXTURE_COPY_LOCATION SourceLocation = {};
+            SourceLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            SourceLocation.pResource = StagingBuffer;
+            SourceLocation.PlacedFootprint = Footprints[LevelI];
+            
+            CmdList->CopyTextureRegion(&DestLocation, 0, 0, 0, &SourceLocation, 0);
+        }
+        
+        TransitionBarrier(Tex, TexState);
+        FlushBarriers();
+        
+        CH_DXOP(CmdList->Close());
+        ID3D12CommandList *CmdLists[] = {CmdList};
+        CmdQueue->ExecuteCommandLists(1, CmdLists);
+        WaitForGpu(0);
+        
+        StagingBuffer->Release();
+    }
+    
+    // goes through the texture cache: the first launch transcodes Filename into Format
+    // with mips, later ones map the result. Handle is 0 if the file can't be loaded
+    texture gpu_context::LoadTexture2D(char *Filename, DXGI_FORMAT Format, 
+                                       D3D12_RESOURCE_FLAGS Flags, 
+                                       D3D12_RESOURCE_STATES ResourceStates)
+    {
+        texture Tex = {};
+        
+        texture_cache Cache = InitTextureCache(CH_TEXTURE_CACHE_DIRECTORY);
+        texture_file File = {};
+        if (LoadCachedTexture(&File, &Cache, Filename, texture_format(Format), DefaultTextureBuildOptions()))
+        {
+            const texture_file_header *Header = File.Header;
+            Tex = InitTexture2D(Device, int(Header->Width), int(Header->Height), Format,
+                                Flags, ResourceStates, int(Header->LevelCount));
+            UploadTextureFile(&Tex, &File);
+            CloseTextureFile(&File);
+        }
+        
+        return Tex;
     }
     
     static void
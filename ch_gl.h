@@ -5032,6 +5032,25 @@ extern "C" {
 }
 #endif
 
+#ifndef _WIN32
+#define __stdcall
+#endif
+
+// the same as kernel.h's and ch_math.h's, for the ch_gl_*.h helpers
+#include <stdint.h>
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t i8;
+typedef int16_t i16;
+typedef int32_t i32;
+typedef int64_t i64;
+typedef float f32;
+typedef double f64;
+typedef i32 b32;
+typedef bool b8;
+
 typedef  void __stdcall GLCULLFACE (GLenum mode);
 GLCULLFACE *glCullFace;
 typedef  void __stdcall GLFRONTFACE (GLenum mode);
@@ -5110,7 +5129,7 @@ typedef  void __stdcall GLGETFLOATV (GLenum pname, GLfloat *data);
 GLGETFLOATV *glGetFloatv;
 typedef  void __stdcall GLGETINTEGERV (GLenum pname, GLint *data);
 GLGETINTEGERV *glGetIntegerv;
-typedef  const GLubyte  __stdcall GLGETSTRING (GLenum name);
+typedef  const GLubyte * __stdcall GLGETSTRING (GLenum name);
 GLGETSTRING *glGetString;
 typedef  void __stdcall GLGETTEXIMAGE (GLenum target, GLint level, GLenum format, GLenum type, void *pixels);
 GLGETTEXIMAGE *glGetTexImage;
@@ -5230,7 +5249,7 @@ typedef  void __stdcall GLBUFFERSUBDATA (GLenum target, GLintptr offset, GLsizei
 GLBUFFERSUBDATA *glBufferSubData;
 typedef  void __stdcall GLGETBUFFERSUBDATA (GLenum target, GLintptr offset, GLsizeiptr size, void *data);
 GLGETBUFFERSUBDATA *glGetBufferSubData;
-typedef  void  __stdcall GLMAPBUFFER (GLenum target, GLenum access);
+typedef  void * __stdcall GLMAPBUFFER (GLenum target, GLenum access);
 GLMAPBUFFER *glMapBuffer;
 typedef  GLboolean __stdcall GLUNMAPBUFFER (GLenum target);
 GLUNMAPBUFFER *glUnmapBuffer;
@@ -5550,7 +5569,7 @@ typedef  void __stdcall GLCLEARBUFFERFV (GLenum buffer, GLint drawbuffer, const
 GLCLEARBUFFERFV *glClearBufferfv;
 typedef  void __stdcall GLCLEARBUFFERFI (GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil);
 GLCLEARBUFFERFI *glClearBufferfi;
-typedef  const GLubyte  __stdcall GLGETSTRINGI (GLenum name, GLuint index);
+typedef  const GLubyte * __stdcall GLGETSTRINGI (GLenum name, GLuint index);
 GLGETSTRINGI *glGetStringi;
 typedef  GLboolean __stdcall GLISRENDERBUFFER (GLuint renderbuffer);
 GLISRENDERBUFFER *glIsRenderbuffer;
@@ -5592,7 +5611,7 @@ typedef  void __stdcall GLRENDERBUFFERSTORAGEMULTISAMPLE (GLenum target, GLsizei
 GLRENDERBUFFERSTORAGEMULTISAMPLE *glRenderbufferStorageMultisample;
 typedef  void __stdcall GLFRAMEBUFFERTEXTURELAYER (GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
 GLFRAMEBUFFERTEXTURELAYER *glFramebufferTextureLayer;
-typedef  void  __stdcall GLMAPBUFFERRANGE (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef  void * __stdcall GLMAPBUFFERRANGE (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
 GLMAPBUFFERRANGE *glMapBufferRange;
 typedef  void __stdcall GLFLUSHMAPPEDBUFFERRANGE (GLenum target, GLintptr offset, GLsizeiptr length);
 GLFLUSHMAPPEDBUFFERRANGE *glFlushMappedBufferRange;
@@ -6146,9 +6165,9 @@ typedef  void __stdcall GLCLEARNAMEDBUFFERDATA (GLuint buffer, GLenum internalfo
 GLCLEARNAMEDBUFFERDATA *glClearNamedBufferData;
 typedef  void __stdcall GLCLEARNAMEDBUFFERSUBDATA (GLuint buffer, GLenum internalformat, GLintptr offset, GLsizeiptr size, GLenum format, GLenum type, const void *data);
 GLCLEARNAMEDBUFFERSUBDATA *glClearNamedBufferSubData;
-typedef  void  __stdcall GLMAPNAMEDBUFFER (GLuint buffer, GLenum access);
+typedef  void * __stdcall GLMAPNAMEDBUFFER (GLuint buffer, GLenum access);
 GLMAPNAMEDBUFFER *glMapNamedBuffer;
-typedef  void  __stdcall GLMAPNAMEDBUFFERRANGE (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef  void * __stdcall GLMAPNAMEDBUFFERRANGE (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
 GLMAPNAMEDBUFFERRANGE *glMapNamedBufferRange;
 typedef  GLboolean __stdcall GLUNMAPNAMEDBUFFER (GLuint buffer);
 GLUNMAPNAMEDBUFFER *glUnmapNamedBuffer;
@@ -6674,7 +6693,7 @@ typedef  void __stdcall GLNAMEDBUFFERDATAEXT (GLuint buffer, GLsizeiptr size, co
 GLNAMEDBUFFERDATAEXT *glNamedBufferDataEXT;
 typedef  void __stdcall GLNAMEDBUFFERSUBDATAEXT (GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data);
 GLNAMEDBUFFERSUBDATAEXT *glNamedBufferSubDataEXT;
-typedef  void  __stdcall GLMAPNAMEDBUFFEREXT (GLuint buffer, GLenum access);
+typedef  void * __stdcall GLMAPNAMEDBUFFEREXT (GLuint buffer, GLenum access);
 GLMAPNAMEDBUFFEREXT *glMapNamedBufferEXT;
 typedef  GLboolean __stdcall GLUNMAPNAMEDBUFFEREXT (GLuint buffer);
 GLUNMAPNAMEDBUFFEREXT *glUnmapNamedBufferEXT;
@@ -6898,7 +6917,7 @@ typedef  void __stdcall GLGETVERTEXARRAYINTEGERI_VEXT (GLuint vaobj, GLuint inde
 GLGETVERTEXARRAYINTEGERI_VEXT *glGetVertexArrayIntegeri_vEXT;
 typedef  void __stdcall GLGETVERTEXARRAYPOINTERI_VEXT (GLuint vaobj, GLuint index, GLenum pname, void **param);
 GLGETVERTEXARRAYPOINTERI_VEXT *glGetVertexArrayPointeri_vEXT;
-typedef  void  __stdcall GLMAPNAMEDBUFFERRANGEEXT (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef  void * __stdcall GLMAPNAMEDBUFFERRANGEEXT (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
 GLMAPNAMEDBUFFERRANGEEXT *glMapNamedBufferRangeEXT;
 typedef  void __stdcall GLFLUSHMAPPEDNAMEDBUFFERRANGEEXT (GLuint buffer, GLintptr offset, GLsizeiptr length);
 GLFLUSHMAPPEDNAMEDBUFFERRANGEEXT *glFlushMappedNamedBufferRangeEXT;
@@ -0,0 +1,367 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+struct object_data
+{
+    mat4 Model;
+    v3 Color;
+    f32 Roughness;
+    v3 Lights[4];
+};
+
+// the C++ struct described once, offsets and strides come from the GLSL rules
+ch::gl_block_member ObjectMembers[] =
+{
+    CH_GL_MEMBER(object_data, Model, GL_FLOAT_MAT4),
+    CH_GL_MEMBER(object_data, Color, GL_FLOAT_VEC3),
+    CH_GL_MEMBER(object_data, Roughness, GL_FLOAT),
+    CH_GL_MEMBER_ARRAY(object_data, Lights, GL_FLOAT_VEC3, 4),
+};
+ch::gl_block_layout ObjectLayout = ch::BuildBlockLayout(ObjectMembers, 4, ch::GL_BLOCK_STD140);
+
+// the matching GLSL declaration, pasted in front of the shader source
+char Declaration[1024];
+ch::WriteBlockGLSL(&ObjectLayout, "ObjectData", 0, Declaration, sizeof(Declaration));
+
+// one big persistently mapped buffer, a third of it per frame in flight (ch_gl_ring.h)
+ch::gl_block_ring Ring = ch::CreateBlockRing(GL_UNIFORM_BUFFER, 8 << 20);
+
+ch::BeginBlockFrame(&Ring); // waits for the GPU only if it's 3 frames behind
+for (object *Object...)
+{
+    ch::gl_block_range Range = ch::PushBlock(&Ring, &ObjectLayout, &Object->Data);
+    ch::BindBlockRange(&Ring, Range, 0); // glBindBufferRange to binding 0
+    glDrawElements(...);
+}
+ch::EndBlockFrame(&Ring);
+
+ch::DestroyBlockRing(&Ring);
+
+Layouts:
+
+Members are GL type enums (GL_FLOAT_VEC3, GL_FLOAT_MAT4...) with an array count,
+the C++ side is tightly packed like glUniform*v takes it. BuildBlockLayout applies
+std140 (uniform blocks: arrays and matrix columns padded to 16 bytes) or std430
+(storage blocks: no padding to 16) and PackBlock copies a C++ struct into that
+layout. Matrices are transposed on the way like glUploadMatrix4 does, the GLSL
+side stays column_major. Nested structs aren't described, a struct array in a
+storage block is an array of blocks of Layout.Size each (PushBlock's Count).
+
+Ring:
+
+ch_gl_ring.h's persistently mapped ring of CH_GL_RING_FRAMES fenced regions, the
+same one ch_gl_stream.h streams through. A frame sub-allocates from its region at
+the target's offset alignment. A frame that runs out of its region gets empty
+ranges (Data is 0) and counts them in FailedCount, the ring has to be made bigger.
+*/
+
+#include "ch_gl_uniform.h"
+#include "ch_gl_ring.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CH_GL_MEMBER(Struct, Member, Type) {#Member, Type, 1, u32(offsetof(Struct, Member)), u32(sizeof(((Struct *)0)->Member)), 0, 0, 0}
+#define CH_GL_MEMBER_ARRAY(Struct, Member, Type, Count) {#Member, Type, Count, u32(offsetof(Struct, Member)), u32(sizeof(((Struct *)0)->Member)), 0, 0, 0}
+
+namespace ch
+{
+    //
+    //
+    // layouts
+    
+    enum gl_block_packing
+    {
+        GL_BLOCK_STD140,
+        GL_BLOCK_STD430,
+    };
+    
+    struct gl_block_member
+    {
+        const char *Name;
+        GLenum Type;
+        i32 Count;          // array elements, 1 for everything else
+        u32 SourceOffset;   // in the C++ struct
+        u32 SourceSize;     // sizeof the C++ member, checked against Type and Count
+        
+        // from BuildBlockLayout
+        u32 Offset;
+        u32 ArrayStride;
+        u32 MatrixStride;   // between columns, 0 for scalars and vectors
+    };
+    
+    struct gl_block_layout
+    {
+        gl_block_member *Members;
+        int MemberCount;
+        gl_block_packing Packing;
+        u32 Size;           // rounded to Alignment, the stride of an array of blocks
+        u32 Alignment;
+        b32 TransposeMatrices; // true, the C++ matrices are row major
+    };
+    
+    struct gl_type_shape
+    {
+        u32 ComponentSize; // 4, 8 for doubles
+        u32 Columns;       // 1 for scalars and vectors
+        u32 Rows;          // components of a column
+        const char *GLSLName;
+    };
+    
+    inline gl_type_shape
+        GetGLTypeShape(GLenum Type)
+    {
+        switch (Type)
+        {
+            case GL_FLOAT: return {4, 1, 1, "float"};
+            case GL_FLOAT_VEC2: return {4, 1, 2, "vec2"};
+            case GL_FLOAT_VEC3: return {4, 1, 3, "vec3"};
+            case GL_FLOAT_VEC4: return {4, 1, 4, "vec4"};
+            case GL_INT: return {4, 1, 1, "int"};
+            case GL_INT_VEC2: return {4, 1, 2, "ivec2"};
+            case GL_INT_VEC3: return {4, 1, 3, "ivec3"};
+            case GL_INT_VEC4: return {4, 1, 4, "ivec4"};
+            case GL_UNSIGNED_INT: return {4, 1, 1, "uint"};
+            case GL_UNSIGNED_INT_VEC2: return {4, 1, 2, "uvec2"};
+            case GL_UNSIGNED_INT_VEC3: return {4, 1, 3, "uvec3"};
+            case GL_UNSIGNED_INT_VEC4: return {4, 1, 4, "uvec4"};
+            case GL_BOOL: return {4, 1, 1, "bool"};
+            case GL_BOOL_VEC2: return {4, 1, 2, "bvec2"};
+            case GL_BOOL_VEC3: return {4, 1, 3, "bvec3"};
+            case GL_BOOL_VEC4: return {4, 1, 4, "bvec4"};
+            case GL_DOUBLE: return {8, 1, 1, "double"};
+            case GL_DOUBLE_VEC2: return {8, 1, 2, "dvec2"};
+            case GL_DOUBLE_VEC3: return {8, 1, 3, "dvec3"};
+            case GL_DOUBLE_VEC4: return {8, 1, 4, "dvec4"};
+            case GL_FLOAT_MAT2: return {4, 2, 2, "mat2"};
+            case GL_FLOAT_MAT3: return {4, 3, 3, "mat3"};
+            case GL_FLOAT_MAT4: return {4, 4, 4, "mat4"};
+            case GL_FLOAT_MAT2x3: return {4, 2, 3, "mat2x3"};
+            case GL_FLOAT_MAT2x4: return {4, 2, 4, "mat2x4"};
+            case GL_FLOAT_MAT3x2: return {4, 3, 2, "mat3x2"};
+            case GL_FLOAT_MAT3x4: return {4, 3, 4, "mat3x4"};
+            case GL_FLOAT_MAT4x2: return {4, 4, 2, "mat4x2"};
+            case GL_FLOAT_MAT4x3: return {4, 4, 3, "mat4x3"};
+            case GL_DOUBLE_MAT2: return {8, 2, 2, "dmat2"};
+            case GL_DOUBLE_MAT3: return {8, 3, 3, "dmat3"};
+            case GL_DOUBLE_MAT4: return {8, 4, 4, "dmat4"};
+        }
+        return {0, 0, 0, 0}; // samplers and images can't be in blocks
+    }
+    
+    inline u32
+        AlignBlockOffset(u32 Offset, u32 Alignment)
+    {
+        return (Offset + Alignment - 1) / Alignment * Alignment;
+    }
+    
+    // fills in the members' offsets and strides, Members has to outlive the layout
+    inline gl_block_layout
+        BuildBlockLayout(gl_block_member *Members, int MemberCount, gl_block_packing Packing)
+    {
+        gl_block_layout Layout = {};
+        Layout.Members = Members;
+        Layout.MemberCount = MemberCount;
+        Layout.Packing = Packing;
+        Layout.TransposeMatrices = true;
+        Layout.Alignment = Packing == GL_BLOCK_STD140? 16: 4;
+        
+        u32 Offset = 0;
+        for (int MemberI = 0; MemberI < MemberCount; ++MemberI)
+        {
+            gl_block_member *Member = &Members[MemberI];
+            gl_type_shape Shape = GetGLTypeShape(Member->Type);
+            assert(Shape.ComponentSize && Member->Count >= 1);
+            assert(Member->SourceSize == Shape.ComponentSize * Shape.Columns * Shape.Rows * u32(Member->Count));
+            
+            // a vec3 aligns like a vec4, matrices and arrays are arrays of their
+            // columns/elements, which std140 rounds up to a vec4
+            u32 VectorAlignment = Shape.ComponentSize * (Shape.Rows == 1? 1: Shape.Rows == 2? 2: 4);
+            u32 Alignment = VectorAlignment;
+            bool IsArray = Member->Count > 1 || Shape.Columns > 1;
+            if (IsArray && Packing == GL_BLOCK_STD140)
+            {
+                Alignment = AlignBlockOffset(Alignment, 16);
+            }
+            
+            Member->Offset = AlignBlockOffset(Offset, Alignment);
+            Member->MatrixStride = Shape.Columns > 1? Alignment: 0;
+            u32 ElementSize = Shape.Columns > 1? Shape.Columns * Alignment: Shape.ComponentSize * Shape.Rows;
+            Member->ArrayStride = AlignBlockOffset(ElementSize, Alignment);
+            Offset = Member->Offset + (Member->Count > 1? Member->ArrayStride * u32(Member->Count): ElementSize);
+            if (IsArray)
+            {
+                // whatever follows an array starts past its padding
+                Offset = AlignBlockOffset(Offset, Alignment);
+            }
+            if (Alignment > Layout.Alignment) Layout.Alignment = Alignment;
+        }
+        Layout.Size = AlignBlockOffset(Offset, Layout.Alignment);
+        return Layout;
+    }
+    
+    // Dest has Layout->Size bytes, padding is left alone
+    inline void
+        PackBlock(const gl_block_layout *Layout, const void *Source, void *Dest)
+    {
+        const u8 *From = (const u8 *)Source;
+        u8 *To = (u8 *)Dest;
+        for (int MemberI = 0; MemberI < Layout->MemberCount; ++MemberI)
+        {
+            const gl_block_member *Member = &Layout->Members[MemberI];
+            gl_type_shape Shape = GetGLTypeShape(Member->Type);
+            u32 N = Shape.ComponentSize;
+            u32 SourceElementSize = N * Shape.Columns * Shape.Rows;
+            for (i32 ElementI = 0; ElementI < Member->Count; ++ElementI)
+            {
+                const u8 *Element = From + Member->SourceOffset + SourceElementSize * u32(ElementI);
+                u8 *Target = To + Member->Offset + Member->ArrayStride * u32(ElementI);
+                if (Shape.Columns == 1)
+                {
+                    memcpy(Target, Element, SourceElementSize);
+                }
+                else if (Layout->TransposeMatrices)
+                {
+                    // row major source: Rows rows of Columns components
+                    for (u32 Column = 0; Column < Shape.Columns; ++Column)
+                    {
+                        for (u32 Row = 0; Row < Shape.Rows; ++Row)
+                        {
+                            memcpy(Target + Column * Member->MatrixStride + Row * N,
+                                   Element + (Row * Shape.Columns + Column) * N, N);
+                        }
+                    }
+                }
+                else
+                {
+                    for (u32 Column = 0; Column < Shape.Columns; ++Column)
+                    {
+                        memcpy(Target + Column * Member->MatrixStride, Element + Column * Shape.Rows * N, Shape.Rows * N);
+                    }
+                }
+            }
+        }
+    }
+    
+    // "layout(std140, binding = 0) uniform Name\n{...};\n", a buffer block for std430.
+    // false if it didn't fit
+    inline bool
+        WriteBlockGLSL(const gl_block_layout *Layout, const char *BlockName, int Binding, char *Buffer, size_t BufferSize)
+    {
+        bool IsStorage = Layout->Packing == GL_BLOCK_STD430;
+        int Written = snprintf(Buffer, BufferSize, "layout(%s, binding = %d) %s %s\n{\n",
+                               IsStorage? "std430": "std140", Binding, IsStorage? "buffer": "uniform", BlockName);
+        size_t Used = Written > 0? size_t(Written): 0;
+        for (int MemberI = 0; MemberI < Layout->MemberCount && Used < BufferSize; ++MemberI)
+        {
+            const gl_block_member *Member = &Layout->Members[MemberI];
+            const char *Type = GetGLTypeShape(Member->Type).GLSLName;
+            if (Member->Count > 1)
+            {
+                Written = snprintf(Buffer + Used, BufferSize - Used, "    %s %s[%d];\n", Type, Member->Name, Member->Count);
+            }
+            else
+            {
+                Written = snprintf(Buffer + Used, BufferSize - Used, "    %s %s;\n", Type, Member->Name);
+            }
+            Used += Written > 0? size_t(Written): 0;
+        }
+        if (Used < BufferSize)
+        {
+            Used += size_t(snprintf(Buffer + Used, BufferSize - Used, "};\n"));
+        }
+        return Used < BufferSize;
+    }
+    
+    //
+    //
+    // per-frame ring
+    
+    struct gl_block_range
+    {
+        u8 *Data; // 0 when the frame's region is full
+        GLintptr Offset;
+        GLsizeiptr Size;
+    };
+    
+    // a frame ring of ch_gl_ring.h on GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER
+    typedef gl_frame_ring gl_block_ring;
+    
+    inline gl_block_ring
+        CreateBlockRing(GLenum Target, u32 Size)
+    {
+        GLint Alignment = 0;
+        glGetIntegerv(Target == GL_SHADER_STORAGE_BUFFER? GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT: GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+        return CreateFrameRing(Target, Size, Alignment > 0? u32(Alignment): 256);
+    }
+    
+    inline void
+        DestroyBlockRing(gl_block_ring *Ring)
+    {
+        DestroyFrameRing(Ring);
+    }
+    
+    inline void
+        BeginBlockFrame(gl_block_ring *Ring)
+    {
+        BeginRingFrame(Ring);
+    }
+    
+    // after the frame's last draw that reads the ring
+    inline void
+        EndBlockFrame(gl_block_ring *Ring)
+    {
+        EndRingFrame(Ring);
+    }
+    
+    inline gl_block_range
+        AllocateBlock(gl_block_ring *Ring, u32 Size)
+    {
+        gl_block_range Range = {};
+        u32 Offset = 0;
+        if (!ReserveRing(Ring, Size, Ring->Alignment, &Offset))
+        {
+            return Range;
+        }
+        Ring->Head = Offset + Size;
+        Range.Data = Ring->Mapped + Offset;
+        Range.Offset = GLintptr(Offset);
+        Range.Size = GLsizeiptr(Size);
+        return Range;
+    }
+    
+    // Count blocks one after the other, Source is an array of Count C++ structs
+    inline gl_block_range
+        PushBlock(gl_block_ring *Ring, const gl_block_layout *Layout, const void *Source, int Count, size_t SourceStride)
+    {
+        gl_block_range Range = AllocateBlock(Ring, Layout->Size * u32(Count));
+        if (Range.Data)
+        {
+            for (int BlockI = 0; BlockI < Count; ++BlockI)
+            {
+                PackBlock(Layout, (const u8 *)Source + SourceStride * size_t(BlockI), Range.Data + Layout->Size * u32(BlockI));
+            }
+        }
+        return Range;
+    }
+    
+    template <typename T>
+    inline gl_block_range
+        PushBlock(gl_block_ring *Ring, const gl_block_layout *Layout, const T *Source, int Count = 1)
+    {
+        return PushBlock(Ring, Layout, (const void *)Source, Count, sizeof(T));
+    }
+    
+    inline void
+        BindBlockRange(const gl_block_ring *Ring, gl_block_range Range, GLuint Binding)
+    {
+        if (Range.Data)
+        {
+            glBindBufferRange(Ring->Target, Binding, Ring->Buffer, Range.Offset, Range.Size);
+            NoteGLBuffer(Ring->Target, Ring->Buffer);
+        }
+    }
+};
\ No newline at end of file
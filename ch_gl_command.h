@@ -0,0 +1,624 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// one buffer per recording thread, kept from frame to frame
+ch::gl_command_buffer *Commands = ch::CreateGLCommandBuffer();
+
+// on a worker, no GL calls are made while recording
+ch::ResetGLCommandBuffer(Commands);
+for (mesh &Mesh: Meshes)
+{
+    ch::BeginGLPacket(Commands, ch::MakeGLSortKey(0, Mesh.Program, Mesh.Material, Mesh.Depth));
+    ch::RecordGLUseProgram(Commands, Mesh.Program);
+    ch::RecordGLBindVertexArray(Commands, Mesh.VAO);
+    ch::RecordGLBindTexture(Commands, GL_TEXTURE0, GL_TEXTURE_2D, Mesh.Albedo);
+    ch::RecordGLBindBufferRange(Commands, GL_UNIFORM_BUFFER, 1, Block.Buffer, Block.Offset, Block.Size);
+    ch::RecordGLUniform(Commands, ModelLocation, GL_FLOAT_MAT4, &Mesh.Model); // copied in
+    ch::RecordGLDrawElements(Commands, GL_TRIANGLES, Mesh.IndexCount, GL_UNSIGNED_INT, 0);
+}
+ch::EndGLCommandBuffer(Commands);
+
+// on the GL thread, once the workers are done
+ch::gl_command_replay Replay = {};
+ch::gl_command_buffer *Buffers[] = {WorkerCommands[0], WorkerCommands[1], ...};
+ch::ReplayGLCommandBuffers(&Replay, Buffers, WorkerCount); // sorted by key
+printf("%u packets, %u draws\n", Replay.PacketCount, Replay.DrawCount);
+
+ch::FreeGLCommandReplay(&Replay);
+ch::DestroyGLCommandBuffer(Commands);
+
+Recording:
+
+GL calls have to come from the thread that owns the context, recording doesn't:
+a command buffer is a list of typed commands written into chunks of memory owned
+by the buffer, one thread records into one buffer and buffers don't share
+anything. Chunks are CH_GL_COMMAND_CHUNK_SIZE bytes and are kept on reset, after
+the first frames recording doesn't allocate. Each command is an 8 byte header
+(type and size) and its arguments, uniform values and buffer data are copied
+after it, so the source can go away once recorded. A command that doesn't fit
+the chunk ends it with a jump to the next one.
+
+Packets:
+
+Commands are grouped in packets, BeginGLPacket starts one with a 64 bit key and
+the commands recorded until the next packet belong to it. Replay radix sorts the
+packets of all buffers by key, a packet is replayed whole and packets with the
+same key keep the order they were recorded in (buffer order first). A packet
+can't rely on the state left by the one recorded before it, sorting moves it, so
+it sets what it needs.
+MakeGLSortKey packs pass, program, material and depth with the most expensive
+change in the high bits so equal state ends up adjacent.
+
+Replay:
+
+One loop over the sorted packets with a switch per command. Binds go through
+ch_gl_state.h's cache, so a bind of what the previous packet left bound doesn't
+reach the driver, and the cache is right afterwards. Uniform commands upload to
+the program bound at that point with the glUniform* of their type, matrices are
+transposed by default like ch_gl_uniform.h does. Buffer data goes up with
+glBufferSubData through GL_COPY_WRITE_BUFFER, so the buffer needs to be created
+with glBufferData or GL_DYNAMIC_STORAGE_BIT.
+*/
+
+#include "ch_gl_state.h"
+#include "ch_gl_uniform.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CH_GL_COMMAND_CHUNK_SIZE
+#define CH_GL_COMMAND_CHUNK_SIZE (64 * 1024)
+#endif
+
+namespace ch
+{
+    //
+    //
+    // commands
+    
+    enum gl_command_type
+    {
+        GL_COMMAND_END,
+        GL_COMMAND_JUMP,
+        GL_COMMAND_USE_PROGRAM,
+        GL_COMMAND_BIND_VERTEX_ARRAY,
+        GL_COMMAND_BIND_TEXTURE,
+        GL_COMMAND_BIND_BUFFER_RANGE,
+        GL_COMMAND_UNIFORM,
+        GL_COMMAND_BUFFER_DATA,
+        GL_COMMAND_DRAW_ARRAYS,
+        GL_COMMAND_DRAW_ELEMENTS,
+    };
+    
+    struct gl_command
+    {
+        u32 Type;
+        u32 Size; // bytes to the next command, header and trailing data included
+    };
+    
+    struct gl_command_jump
+    {
+        gl_command Header;
+        u8 *Next;
+    };
+    
+    struct gl_command_use_program
+    {
+        gl_command Header;
+        GLuint Program;
+    };
+    
+    struct gl_command_bind_vertex_array
+    {
+        gl_command Header;
+        GLuint VertexArray;
+    };
+    
+    struct gl_command_bind_texture
+    {
+        gl_command Header;
+        GLenum Unit; // GL_TEXTURE0 + n
+        GLenum Target;
+        GLuint Texture;
+    };
+    
+    struct gl_command_bind_buffer_range
+    {
+        gl_command Header;
+        GLenum Target;
+        GLuint Index;
+        GLuint Buffer;
+        GLintptr Offset;
+        GLsizeiptr Size;
+    };
+    
+    // values follow
+    struct gl_command_uniform
+    {
+        gl_command Header;
+        GLint Location;
+        GLenum Type;
+        GLsizei Count;
+        GLboolean Transpose;
+    };
+    
+    // data follows
+    struct gl_command_buffer_data
+    {
+        gl_command Header;
+        GLuint Buffer;
+        GLintptr Offset;
+        GLsizeiptr Size;
+    };
+    
+    struct gl_command_draw_arrays
+    {
+        gl_command Header;
+        GLenum Mode;
+        GLint First;
+        GLsizei Count;
+        GLsizei InstanceCount;
+    };
+    
+    struct gl_command_draw_elements
+    {
+        gl_command Header;
+        GLenum Mode;
+        GLsizei Count;
+        GLenum Type;
+        GLint BaseVertex;
+        GLsizei InstanceCount;
+        size_t IndexOffset; // bytes into the element buffer
+    };
+    
+    //
+    //
+    // buffers
+    
+    struct gl_command_chunk
+    {
+        gl_command_chunk *Next;
+        size_t Size; // bytes after the header
+    };
+    
+    struct gl_command_packet
+    {
+        u64 Key;
+        const u8 *Commands;
+    };
+    
+    struct gl_command_buffer
+    {
+        gl_command_chunk *FirstChunk;
+        gl_command_chunk *Chunk;
+        u8 *At;
+        u8 *End; // room for a jump is kept past it
+        
+        gl_command_packet *Packets;
+        u32 PacketCount;
+        u32 PacketCapacity;
+        bool PacketOpen;
+        
+        u32 CommandCount;
+        size_t ChunkBytes; // allocated
+    };
+    
+    const size_t GL_COMMAND_ALIGN = 8;
+    
+    inline size_t
+        AlignGLCommandSize(size_t Size)
+    {
+        return (Size + GL_COMMAND_ALIGN - 1) & ~(GL_COMMAND_ALIGN - 1);
+    }
+    
+    inline u8 *
+        GetGLCommandChunkData(gl_command_chunk *Chunk)
+    {
+        return (u8 *)Chunk + AlignGLCommandSize(sizeof(gl_command_chunk));
+    }
+    
+    inline void
+        StartGLCommandChunk(gl_command_buffer *Buffer, gl_command_chunk *Chunk)
+    {
+        Buffer->Chunk = Chunk;
+        Buffer->At = GetGLCommandChunkData(Chunk);
+        Buffer->End = Buffer->At + Chunk->Size - sizeof(gl_command_jump);
+    }
+    
+    inline gl_command_chunk *
+        AllocateGLCommandChunk(gl_command_buffer *Buffer, size_t Size)
+    {
+        size_t Bytes = AlignGLCommandSize(sizeof(gl_command_chunk)) + Size;
+        gl_command_chunk *Chunk = (gl_command_chunk *)malloc(Bytes);
+        Chunk->Next = 0;
+        Chunk->Size = Size;
+        Buffer->ChunkBytes += Bytes;
+        return Chunk;
+    }
+    
+    inline gl_command_buffer *
+        CreateGLCommandBuffer()
+    {
+        gl_command_buffer *Buffer = (gl_command_buffer *)calloc(1, sizeof(gl_command_buffer));
+        Buffer->FirstChunk = AllocateGLCommandChunk(Buffer, CH_GL_COMMAND_CHUNK_SIZE);
+        StartGLCommandChunk(Buffer, Buffer->FirstChunk);
+        return Buffer;
+    }
+    
+    inline void
+        DestroyGLCommandBuffer(gl_command_buffer *Buffer)
+    {
+        gl_command_chunk *Chunk = Buffer->FirstChunk;
+        while (Chunk)
+        {
+            gl_command_chunk *Next = Chunk->Next;
+            free(Chunk);
+            Chunk = Next;
+        }
+        free(Buffer->Packets);
+        free(Buffer);
+    }
+    
+    // forgets what was recorded, memory is kept
+    inline void
+        ResetGLCommandBuffer(gl_command_buffer *Buffer)
+    {
+        StartGLCommandChunk(Buffer, Buffer->FirstChunk);
+        Buffer->PacketCount = 0;
+        Buffer->PacketOpen = false;
+        Buffer->CommandCount = 0;
+    }
+    
+    // room for a command of Size bytes, jumping to the next chunk when it doesn't fit
+    inline gl_command *
+        ReserveGLCommand(gl_command_buffer *Buffer, u32 Type, size_t Size)
+    {
+        Size = AlignGLCommandSize(Size);
+        if (Buffer->At + Size > Buffer->End)
+        {
+            size_t Needed = Size + sizeof(gl_command_jump);
+            gl_command_chunk *Next = Buffer->Chunk->Next;
+            if (!Next || Next->Size < Needed)
+            {
+                // a new chunk, in front of the kept ones when those are too small for this
+                size_t ChunkSize = CH_GL_COMMAND_CHUNK_SIZE;
+                if (ChunkSize < Needed) ChunkSize = Needed;
+                gl_command_chunk *Added = AllocateGLCommandChunk(Buffer, ChunkSize);
+                Added->Next = Next;
+                Buffer->Chunk->Next = Added;
+                Next = Added;
+            }
+            
+            gl_command_jump *Jump = (gl_command_jump *)Buffer->At;
+            Jump->Header.Type = GL_COMMAND_JUMP;
+            Jump->Header.Size = u32(sizeof(gl_command_jump));
+            StartGLCommandChunk(Buffer, Next);
+            Jump->Next = Buffer->At;
+        }
+        
+        gl_command *Command = (gl_command *)Buffer->At;
+        Command->Type = Type;
+        Command->Size = u32(Size);
+        Buffer->At += Size;
+        return Command;
+    }
+    
+    inline void *
+        PushGLCommand(gl_command_buffer *Buffer, u32 Type, size_t Size)
+    {
+        assert(Buffer->PacketOpen && "BeginGLPacket before recording");
+        Buffer->CommandCount += 1;
+        return ReserveGLCommand(Buffer, Type, Size);
+    }
+    
+    inline void
+        EndGLPacket(gl_command_buffer *Buffer)
+    {
+        if (!Buffer->PacketOpen) return;
+        ReserveGLCommand(Buffer, GL_COMMAND_END, sizeof(gl_command));
+        Buffer->PacketOpen = false;
+    }
+    
+    inline void
+        BeginGLPacket(gl_command_buffer *Buffer, u64 Key)
+    {
+        EndGLPacket(Buffer);
+        if (Buffer->PacketCount == Buffer->PacketCapacity)
+        {
+            Buffer->PacketCapacity = Buffer->PacketCapacity? 2 * Buffer->PacketCapacity: 256;
+            Buffer->Packets = (gl_command_packet *)realloc(Buffer->Packets, Buffer->PacketCapacity * sizeof(gl_command_packet));
+        }
+        gl_command_packet *Packet = &Buffer->Packets[Buffer->PacketCount];
+        Packet->Key = Key;
+        Packet->Commands = Buffer->At;
+        Buffer->PacketCount += 1;
+        Buffer->PacketOpen = true;
+    }
+    
+    // closes the last packet, the buffer can be replayed after this
+    inline void
+        EndGLCommandBuffer(gl_command_buffer *Buffer)
+    {
+        EndGLPacket(Buffer);
+    }
+    
+    //
+    //
+    // recording
+    
+    // pass in the top byte, then program, material and the top 24 bits of a non-negative depth
+    inline u64
+        MakeGLSortKey(u32 Pass, u32 Program, u32 Material, f32 Depth)
+    {
+        u32 DepthBits = 0;
+        if (Depth > 0.0f) memcpy(&DepthBits, &Depth, sizeof(DepthBits)); // positive floats order like their bits
+        return (u64(Pass & 0xFF) << 56) | (u64(Program & 0xFFFF) << 40) |
+            (u64(Material & 0xFFFF) << 24) | u64((DepthBits >> 7) & 0xFFFFFF);
+    }
+    
+    inline void
+        RecordGLUseProgram(gl_command_buffer *Buffer, GLuint Program)
+    {
+        gl_command_use_program *Command = (gl_command_use_program *)PushGLCommand(Buffer, GL_COMMAND_USE_PROGRAM, sizeof(gl_command_use_program));
+        Command->Program = Program;
+    }
+    
+    inline void
+        RecordGLBindVertexArray(gl_command_buffer *Buffer, GLuint VertexArray)
+    {
+        gl_command_bind_vertex_array *Command = (gl_command_bind_vertex_array *)PushGLCommand(Buffer, GL_COMMAND_BIND_VERTEX_ARRAY, sizeof(gl_command_bind_vertex_array));
+        Command->VertexArray = VertexArray;
+    }
+    
+    inline void
+        RecordGLBindTexture(gl_command_buffer *Buffer, GLenum Unit, GLenum Target, GLuint Texture)
+    {
+        gl_command_bind_texture *Command = (gl_command_bind_texture *)PushGLCommand(Buffer, GL_COMMAND_BIND_TEXTURE, sizeof(gl_command_bind_texture));
+        Command->Unit = Unit;
+        Command->Target = Target;
+        Command->Texture = Texture;
+    }
+    
+    inline void
+        RecordGLBindBufferRange(gl_command_buffer *Buffer, GLenum Target, GLuint Index, GLuint BufferName, GLintptr Offset, GLsizeiptr Size)
+    {
+        gl_command_bind_buffer_range *Command = (gl_command_bind_buffer_range *)PushGLCommand(Buffer, GL_COMMAND_BIND_BUFFER_RANGE, sizeof(gl_command_bind_buffer_range));
+        Command->Target = Target;
+        Command->Index = Index;
+        Command->Buffer = BufferName;
+        Command->Offset = Offset;
+        Command->Size = Size;
+    }
+    
+    // Type is the GLSL type (GL_FLOAT_MAT4...), Count elements of it are copied
+    inline void
+        RecordGLUniform(gl_command_buffer *Buffer, GLint Location, GLenum Type, const void *Data, GLsizei Count = 1, GLboolean Transpose = GL_TRUE)
+    {
+        size_t Bytes = size_t(GetUniformElementSize(Type)) * size_t(Count);
+        size_t Header = AlignGLCommandSize(sizeof(gl_command_uniform));
+        gl_command_uniform *Command = (gl_command_uniform *)PushGLCommand(Buffer, GL_COMMAND_UNIFORM, Header + Bytes);
+        Command->Location = Location;
+        Command->Type = Type;
+        Command->Count = Count;
+        Command->Transpose = Transpose;
+        memcpy((u8 *)Command + Header, Data, Bytes);
+    }
+    
+    // Size bytes of Data are copied, they go to BufferName at Offset on replay
+    inline void
+        RecordGLBufferData(gl_command_buffer *Buffer, GLuint BufferName, GLintptr Offset, GLsizeiptr Size, const void *Data)
+    {
+        size_t Header = AlignGLCommandSize(sizeof(gl_command_buffer_data));
+        gl_command_buffer_data *Command = (gl_command_buffer_data *)PushGLCommand(Buffer, GL_COMMAND_BUFFER_DATA, Header + size_t(Size));
+        Command->Buffer = BufferName;
+        Command->Offset = Offset;
+        Command->Size = Size;
+        memcpy((u8 *)Command + Header, Data, size_t(Size));
+    }
+    
+    inline void
+        RecordGLDrawArrays(gl_command_buffer *Buffer, GLenum Mode, GLint First, GLsizei Count, GLsizei InstanceCount = 1)
+    {
+        gl_command_draw_arrays *Command = (gl_command_draw_arrays *)PushGLCommand(Buffer, GL_COMMAND_DRAW_ARRAYS, sizeof(gl_command_draw_arrays));
+        Command->Mode = Mode;
+        Command->First = First;
+        Command->Count = Count;
+        Command->InstanceCount = InstanceCount;
+    }
+    
+    // IndexOffset in bytes, like the pointer glDrawElements takes
+    inline void
+        RecordGLDrawElements(gl_command_buffer *Buffer, GLenum Mode, GLsizei Count, GLenum Type, size_t IndexOffset, GLint BaseVertex = 0, GLsizei InstanceCount = 1)
+    {
+        gl_command_draw_elements *Command = (gl_command_draw_elements *)PushGLCommand(Buffer, GL_COMMAND_DRAW_ELEMENTS, sizeof(gl_command_draw_elements));
+        Command->Mode = Mode;
+        Command->Count = Count;
+        Command->Type = Type;
+        Command->BaseVertex = BaseVertex;
+        Command->InstanceCount = InstanceCount;
+        Command->IndexOffset = IndexOffset;
+    }
+    
+    //
+    //
+    // replay
+    
+    struct gl_command_replay
+    {
+        gl_command_packet *Packets; // scratch, kept between replays
+        gl_command_packet *SortScratch;
+        u32 PacketCapacity;
+        
+        // last replay
+        u32 PacketCount;
+        u32 CommandCount;
+        u32 DrawCount;
+    };
+    
+    // LSD radix sort by key, a byte per pass, stable so equal keys stay in recording order
+    inline void
+        SortGLCommandPackets(gl_command_packet *Packets, gl_command_packet *Scratch, u32 Count)
+    {
+        gl_command_packet *From = Packets;
+        gl_command_packet *To = Scratch;
+        for (int Shift = 0; Shift < 64 && Count > 1; Shift += 8)
+        {
+            u32 Offsets[256] = {};
+            for (u32 PacketI = 0; PacketI < Count; ++PacketI)
+            {
+                Offsets[(From[PacketI].Key >> Shift) & 0xFF] += 1;
+            }
+            if (Offsets[(From[0].Key >> Shift) & 0xFF] == Count) continue; // a byte every key shares, unused pass bits
+            
+            u32 Offset = 0;
+            for (int Digit = 0; Digit < 256; ++Digit)
+            {
+                u32 DigitCount = Offsets[Digit];
+                Offsets[Digit] = Offset;
+                Offset += DigitCount;
+            }
+            for (u32 PacketI = 0; PacketI < Count; ++PacketI)
+            {
+                To[Offsets[(From[PacketI].Key >> Shift) & 0xFF]++] = From[PacketI];
+            }
+            gl_command_packet *Swap = From;
+            From = To;
+            To = Swap;
+        }
+        if (From != Packets) memcpy(Packets, From, Count * sizeof(gl_command_packet));
+    }
+    
+    // commands of one packet, binds through the state cache
+    inline void
+        ExecuteGLCommands(gl_command_replay *Replay, const u8 *At)
+    {
+        for (;;)
+        {
+            const gl_command *Command = (const gl_command *)At;
+            switch (Command->Type)
+            {
+                case GL_COMMAND_END:
+                {
+                    return;
+                }
+                
+                case GL_COMMAND_JUMP:
+                {
+                    At = ((const gl_command_jump *)Command)->Next;
+                    continue;
+                }
+                
+                case GL_COMMAND_USE_PROGRAM:
+                {
+                    SetGLProgram(((const gl_command_use_program *)Command)->Program);
+                } break;
+                
+                case GL_COMMAND_BIND_VERTEX_ARRAY:
+                {
+                    SetGLVertexArray(((const gl_command_bind_vertex_array *)Command)->VertexArray);
+                } break;
+                
+                case GL_COMMAND_BIND_TEXTURE:
+                {
+                    const gl_command_bind_texture *Bind = (const gl_command_bind_texture *)Command;
+                    SetGLActiveTexture(Bind->Unit);
+                    SetGLTexture(Bind->Target, Bind->Texture);
+                } break;
+                
+                case GL_COMMAND_BIND_BUFFER_RANGE:
+                {
+                    const gl_command_bind_buffer_range *Bind = (const gl_command_bind_buffer_range *)Command;
+                    glBindBufferRange(Bind->Target, Bind->Index, Bind->Buffer, Bind->Offset, Bind->Size);
+                    NoteGLBuffer(Bind->Target, Bind->Buffer);
+                } break;
+                
+                case GL_COMMAND_UNIFORM:
+                {
+                    const gl_command_uniform *Uniform = (const gl_command_uniform *)Command;
+                    gl_uniform_info Info = {};
+                    Info.Location = Uniform->Location;
+                    Info.Type = Uniform->Type;
+                    UploadUniform(&Info, (const u8 *)Command + AlignGLCommandSize(sizeof(gl_command_uniform)), Uniform->Count, Uniform->Transpose);
+                } break;
+                
+                case GL_COMMAND_BUFFER_DATA:
+                {
+                    const gl_command_buffer_data *Data = (const gl_command_buffer_data *)Command;
+                    SetGLBuffer(GL_COPY_WRITE_BUFFER, Data->Buffer);
+                    glBufferSubData(GL_COPY_WRITE_BUFFER, Data->Offset, Data->Size, (const u8 *)Command + AlignGLCommandSize(sizeof(gl_command_buffer_data)));
+                } break;
+                
+                case GL_COMMAND_DRAW_ARRAYS:
+                {
+                    const gl_command_draw_arrays *Draw = (const gl_command_draw_arrays *)Command;
+                    if (Draw->InstanceCount == 1) glDrawArrays(Draw->Mode, Draw->First, Draw->Count);
+                    else glDrawArraysInstanced(Draw->Mode, Draw->First, Draw->Count, Draw->InstanceCount);
+                    Replay->DrawCount += 1;
+                } break;
+                
+                case GL_COMMAND_DRAW_ELEMENTS:
+                {
+                    const gl_command_draw_elements *Draw = (const gl_command_draw_elements *)Command;
+                    const void *Indices = (const void *)Draw->IndexOffset;
+                    if (Draw->InstanceCount == 1) glDrawElementsBaseVertex(Draw->Mode, Draw->Count, Draw->Type, Indices, Draw->BaseVertex);
+                    else glDrawElementsInstancedBaseVertex(Draw->Mode, Draw->Count, Draw->Type, Indices, Draw->InstanceCount, Draw->BaseVertex);
+                    Replay->DrawCount += 1;
+                } break;
+                
+                default:
+                {
+                    assert(!"unknown command");
+                    return;
+                }
+            }
+            Replay->CommandCount += 1;
+            At += Command->Size;
+        }
+    }
+    
+    // on the GL thread, after every buffer was ended; Sort = false replays in recording order
+    inline void
+        ReplayGLCommandBuffers(gl_command_replay *Replay, gl_command_buffer **Buffers, int BufferCount, bool Sort = true)
+    {
+        u32 PacketCount = 0;
+        for (int BufferI = 0; BufferI < BufferCount; ++BufferI)
+        {
+            assert(!Buffers[BufferI]->PacketOpen && "EndGLCommandBuffer before replay");
+            PacketCount += Buffers[BufferI]->PacketCount;
+        }
+        if (PacketCount > Replay->PacketCapacity)
+        {
+            Replay->PacketCapacity = PacketCount;
+            Replay->Packets = (gl_command_packet *)realloc(Replay->Packets, PacketCount * sizeof(gl_command_packet));
+            Replay->SortScratch = (gl_command_packet *)realloc(Replay->SortScratch, PacketCount * sizeof(gl_command_packet));
+        }
+        
+        gl_command_packet *Packet = Replay->Packets;
+        for (int BufferI = 0; BufferI < BufferCount; ++BufferI)
+        {
+            gl_command_buffer *Buffer = Buffers[BufferI];
+            if (!Buffer->PacketCount) continue;
+            memcpy(Packet, Buffer->Packets, Buffer->PacketCount * sizeof(gl_command_packet));
+            Packet += Buffer->PacketCount;
+        }
+        if (Sort) SortGLCommandPackets(Replay->Packets, Replay->SortScratch, PacketCount);
+        
+        Replay->PacketCount = PacketCount;
+        Replay->CommandCount = 0;
+        Replay->DrawCount = 0;
+        for (u32 PacketI = 0; PacketI < PacketCount; ++PacketI)
+        {
+            ExecuteGLCommands(Replay, Replay->Packets[PacketI].Commands);
+        }
+    }
+    
+    inline void
+        FreeGLCommandReplay(gl_command_replay *Replay)
+    {
+        free(Replay->Packets);
+        free(Replay->SortScratch);
+        *Replay = {};
+    }
+};
\ No newline at end of file
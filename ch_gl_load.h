@@ -0,0 +1,1526 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// core 4.5 and the extensions asked for, nothing else is looked up
+const char *Extensions[] = {"GL_ARB_bindless_texture", "GL_KHR_blend_equation_advanced"};
+ch::gl_load_result Result = ch::LoadGLFunctionsMinimal(LoadFunction, 4, 5, Extensions, 2);
+if (Result.MissingCount) ... // the driver had no pointer for some of them
+
+// nothing looked up yet, every pointer is a trampoline that looks itself up on its first call
+ch::LoadGLFunctionsLazy(LoadFunction);
+glCullFace(GL_BACK); // looks up glCullFace and calls it, the next call goes straight to the driver
+
+// every pointer is non-zero in lazy mode, existence checks go through this (in any mode)
+if (ch::IsGLFunctionAvailable((void *)glBufferStorage)) ...
+
+Modes:
+
+LoadGLFunctions in ch_gl.h looks up all 1115 entry points, vendor extensions
+(NV path rendering, INTEL performance queries, EXT direct state access...)
+included, and every lookup is a wglGetProcAddress/glXGetProcAddress. Minimal
+mode looks up the core versions up to the one asked for plus the named
+extensions, everything else is set to 0. Lazy mode looks up nothing: each
+pointer is set to a trampoline with the entry point's signature, the first call
+looks the real one up through the same load function, stores it over the
+trampoline and forwards the call. Lookups happen on the thread that makes the
+call, which for GL is the one with the context anyway. A trampoline knows its
+entry's index, the first call is one lookup and no search of the table.
+
+Missing entry points:
+
+In lazy mode no pointer is 0, so "if (glFoo)" can't tell whether the driver has
+glFoo. IsGLFunctionAvailable can, in every mode: it looks a trampoline up right
+away (once, like its first call would) and says whether the driver had it. An
+entry point the driver doesn't have keeps its trampoline, calling it prints its
+name to stderr the first time, counts in MissingCalls and returns 0 without
+calling anything.
+
+The table below is generated from ch_gl.h's loader and its glcorearb.h blocks,
+in the same order. A function that is both core and an extension belongs to its
+core version. Extensions without entry points of their own aren't in it,
+LoadGLFunctionsMinimal counts them in UnknownCount and goes on.
+*/
+
+#include "ch_gl.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace ch
+{
+    //
+    //
+    // table
+    
+    struct gl_function_entry
+    {
+        const char *Name;
+        void **Pointer;
+        void *Trampoline;
+    };
+    
+    // a core version (Major.Minor) or an extension (Major 0), entries First to First + Count
+    struct gl_function_group
+    {
+        const char *Name;
+        u8 Major;
+        u8 Minor;
+        u16 First;
+        u16 Count;
+    };
+    
+    inline void *ResolveGLFunction(int Index);
+    inline void CountMissingGLCall();
+    
+    template <typename function, function *Pointer, int Index>
+        struct gl_trampoline;
+    
+    template <typename result, typename... arguments, result (__stdcall **Pointer)(arguments...), int Index>
+        struct gl_trampoline<result (__stdcall *)(arguments...), Pointer, Index>
+    {
+        static result __stdcall
+            Call(arguments... Arguments)
+        {
+            if (!ResolveGLFunction(Index))
+            {
+                CountMissingGLCall();
+                return result();
+            }
+            return (*Pointer)(Arguments...);
+        }
+    };
+    
+    // entries count from here, each one's trampoline gets its index
+    enum { GL_FUNCTION_COUNTER_BASE = __COUNTER__ + 1 };
+    
+#define CH_GL_FUNCTION(Name) {#Name, (void **)&Name, (void *)&ch::gl_trampoline<decltype(Name), &Name, __COUNTER__ - ch::GL_FUNCTION_COUNTER_BASE>::Call}
+    
+    static const gl_function_entry GL_FUNCTION_ENTRIES[] =
+    {
+        // GL_VERSION_1_0
+        CH_GL_FUNCTION(glCullFace),
+        CH_GL_FUNCTION(glFrontFace),
+        CH_GL_FUNCTION(glHint),
+        CH_GL_FUNCTION(glLineWidth),
+        CH_GL_FUNCTION(glPointSize),
+        CH_GL_FUNCTION(glPolygonMode),
+        CH_GL_FUNCTION(glScissor),
+        CH_GL_FUNCTION(glTexParameterf),
+        CH_GL_FUNCTION(glTexParameterfv),
+        CH_GL_FUNCTION(glTexParameteri),
+        CH_GL_FUNCTION(glTexParameteriv),
+        CH_GL_FUNCTION(glTexImage1D),
+        CH_GL_FUNCTION(glTexImage2D),
+        CH_GL_FUNCTION(glDrawBuffer),
+        CH_GL_FUNCTION(glClear),
+        CH_GL_FUNCTION(glClearColor),
+        CH_GL_FUNCTION(glClearStencil),
+        CH_GL_FUNCTION(glClearDepth),
+        CH_GL_FUNCTION(glStencilMask),
+        CH_GL_FUNCTION(glColorMask),
+        CH_GL_FUNCTION(glDepthMask),
+        CH_GL_FUNCTION(glDisable),
+        CH_GL_FUNCTION(glEnable),
+        CH_GL_FUNCTION(glFinish),
+        CH_GL_FUNCTION(glFlush),
+        CH_GL_FUNCTION(glBlendFunc),
+        CH_GL_FUNCTION(glLogicOp),
+        CH_GL_FUNCTION(glStencilFunc),
+        CH_GL_FUNCTION(glStencilOp),
+        CH_GL_FUNCTION(glDepthFunc),
+        CH_GL_FUNCTION(glPixelStoref),
+        CH_GL_FUNCTION(glPixelStorei),
+        CH_GL_FUNCTION(glReadBuffer),
+        CH_GL_FUNCTION(glReadPixels),
+        CH_GL_FUNCTION(glGetBooleanv),
+        CH_GL_FUNCTION(glGetDoublev),
+        CH_GL_FUNCTION(glGetError),
+        CH_GL_FUNCTION(glGetFloatv),
+        CH_GL_FUNCTION(glGetIntegerv),
+        CH_GL_FUNCTION(glGetString),
+        CH_GL_FUNCTION(glGetTexImage),
+        CH_GL_FUNCTION(glGetTexParameterfv),
+        CH_GL_FUNCTION(glGetTexParameteriv),
+        CH_GL_FUNCTION(glGetTexLevelParameterfv),
+        CH_GL_FUNCTION(glGetTexLevelParameteriv),
+        CH_GL_FUNCTION(glIsEnabled),
+        CH_GL_FUNCTION(glDepthRange),
+        CH_GL_FUNCTION(glViewport),
+        // GL_VERSION_1_1
+        CH_GL_FUNCTION(glDrawArrays),
+        CH_GL_FUNCTION(glDrawElements),
+        CH_GL_FUNCTION(glGetPointerv),
+        CH_GL_FUNCTION(glPolygonOffset),
+        CH_GL_FUNCTION(glCopyTexImage1D),
+        CH_GL_FUNCTION(glCopyTexImage2D),
+        CH_GL_FUNCTION(glCopyTexSubImage1D),
+        CH_GL_FUNCTION(glCopyTexSubImage2D),
+        CH_GL_FUNCTION(glTexSubImage1D),
+        CH_GL_FUNCTION(glTexSubImage2D),
+        CH_GL_FUNCTION(glBindTexture),
+        CH_GL_FUNCTION(glDeleteTextures),
+        CH_GL_FUNCTION(glGenTextures),
+        CH_GL_FUNCTION(glIsTexture),
+        // GL_VERSION_1_2
+        CH_GL_FUNCTION(glDrawRangeElements),
+        CH_GL_FUNCTION(glTexImage3D),
+        CH_GL_FUNCTION(glTexSubImage3D),
+        CH_GL_FUNCTION(glCopyTexSubImage3D),
+        // GL_VERSION_1_3
+        CH_GL_FUNCTION(glActiveTexture),
+        CH_GL_FUNCTION(glSampleCoverage),
+        CH_GL_FUNCTION(glCompressedTexImage3D),
+        CH_GL_FUNCTION(glCompressedTexImage2D),
+        CH_GL_FUNCTION(glCompressedTexImage1D),
+        CH_GL_FUNCTION(glCompressedTexSubImage3D),
+        CH_GL_FUNCTION(glCompressedTexSubImage2D),
+        CH_GL_FUNCTION(glCompressedTexSubImage1D),
+        CH_GL_FUNCTION(glGetCompressedTexImage),
+        // GL_VERSION_1_4
+        CH_GL_FUNCTION(glBlendFuncSeparate),
+        CH_GL_FUNCTION(glMultiDrawArrays),
+        CH_GL_FUNCTION(glMultiDrawElements),
+        CH_GL_FUNCTION(glPointParameterf),
+        CH_GL_FUNCTION(glPointParameterfv),
+        CH_GL_FUNCTION(glPointParameteri),
+        CH_GL_FUNCTION(glPointParameteriv),
+        CH_GL_FUNCTION(glBlendColor),
+        CH_GL_FUNCTION(glBlendEquation),
+        // GL_VERSION_1_5
+        CH_GL_FUNCTION(glGenQueries),
+        CH_GL_FUNCTION(glDeleteQueries),
+        CH_GL_FUNCTION(glIsQuery),
+        CH_GL_FUNCTION(glBeginQuery),
+        CH_GL_FUNCTION(glEndQuery),
+        CH_GL_FUNCTION(glGetQueryiv),
+        CH_GL_FUNCTION(glGetQueryObjectiv),
+        CH_GL_FUNCTION(glGetQueryObjectuiv),
+        CH_GL_FUNCTION(glBindBuffer),
+        CH_GL_FUNCTION(glDeleteBuffers),
+        CH_GL_FUNCTION(glGenBuffers),
+        CH_GL_FUNCTION(glIsBuffer),
+        CH_GL_FUNCTION(glBufferData),
+        CH_GL_FUNCTION(glBufferSubData),
+        CH_GL_FUNCTION(glGetBufferSubData),
+        CH_GL_FUNCTION(glMapBuffer),
+        CH_GL_FUNCTION(glUnmapBuffer),
+        CH_GL_FUNCTION(glGetBufferParameteriv),
+        CH_GL_FUNCTION(glGetBufferPointerv),
+        // GL_VERSION_2_0
+        CH_GL_FUNCTION(glBlendEquationSeparate),
+        CH_GL_FUNCTION(glDrawBuffers),
+        CH_GL_FUNCTION(glStencilOpSeparate),
+        CH_GL_FUNCTION(glStencilFuncSeparate),
+        CH_GL_FUNCTION(glStencilMaskSeparate),
+        CH_GL_FUNCTION(glAttachShader),
+        CH_GL_FUNCTION(glBindAttribLocation),
+        CH_GL_FUNCTION(glCompileShader),
+        CH_GL_FUNCTION(glCreateProgram),
+        CH_GL_FUNCTION(glCreateShader),
+        CH_GL_FUNCTION(glDeleteProgram),
+        CH_GL_FUNCTION(glDeleteShader),
+        CH_GL_FUNCTION(glDetachShader),
+        CH_GL_FUNCTION(glDisableVertexAttribArray),
+        CH_GL_FUNCTION(glEnableVertexAttribArray),
+        CH_GL_FUNCTION(glGetActiveAttrib),
+        CH_GL_FUNCTION(glGetActiveUniform),
+        CH_GL_FUNCTION(glGetAttachedShaders),
+        CH_GL_FUNCTION(glGetAttribLocation),
+        CH_GL_FUNCTION(glGetProgramiv),
+        CH_GL_FUNCTION(glGetProgramInfoLog),
+        CH_GL_FUNCTION(glGetShaderiv),
+        CH_GL_FUNCTION(glGetShaderInfoLog),
+        CH_GL_FUNCTION(glGetShaderSource),
+        CH_GL_FUNCTION(glGetUniformLocation),
+        CH_GL_FUNCTION(glGetUniformfv),
+        CH_GL_FUNCTION(glGetUniformiv),
+        CH_GL_FUNCTION(glGetVertexAttribdv),
+        CH_GL_FUNCTION(glGetVertexAttribfv),
+        CH_GL_FUNCTION(glGetVertexAttribiv),
+        CH_GL_FUNCTION(glGetVertexAttribPointerv),
+        CH_GL_FUNCTION(glIsProgram),
+        CH_GL_FUNCTION(glIsShader),
+        CH_GL_FUNCTION(glLinkProgram),
+        CH_GL_FUNCTION(glShaderSource),
+        CH_GL_FUNCTION(glUseProgram),
+        CH_GL_FUNCTION(glUniform1f),
+        CH_GL_FUNCTION(glUniform2f),
+        CH_GL_FUNCTION(glUniform3f),
+        CH_GL_FUNCTION(glUniform4f),
+        CH_GL_FUNCTION(glUniform1i),
+        CH_GL_FUNCTION(glUniform2i),
+        CH_GL_FUNCTION(glUniform3i),
+        CH_GL_FUNCTION(glUniform4i),
+        CH_GL_FUNCTION(glUniform1fv),
+        CH_GL_FUNCTION(glUniform2fv),
+        CH_GL_FUNCTION(glUniform3fv),
+        CH_GL_FUNCTION(glUniform4fv),
+        CH_GL_FUNCTION(glUniform1iv),
+        CH_GL_FUNCTION(glUniform2iv),
+        CH_GL_FUNCTION(glUniform3iv),
+        CH_GL_FUNCTION(glUniform4iv),
+        CH_GL_FUNCTION(glUniformMatrix2fv),
+        CH_GL_FUNCTION(glUniformMatrix3fv),
+        CH_GL_FUNCTION(glUniformMatrix4fv),
+        CH_GL_FUNCTION(glValidateProgram),
+        CH_GL_FUNCTION(glVertexAttrib1d),
+        CH_GL_FUNCTION(glVertexAttrib1dv),
+        CH_GL_FUNCTION(glVertexAttrib1f),
+        CH_GL_FUNCTION(glVertexAttrib1fv),
+        CH_GL_FUNCTION(glVertexAttrib1s),
+        CH_GL_FUNCTION(glVertexAttrib1sv),
+        CH_GL_FUNCTION(glVertexAttrib2d),
+        CH_GL_FUNCTION(glVertexAttrib2dv),
+        CH_GL_FUNCTION(glVertexAttrib2f),
+        CH_GL_FUNCTION(glVertexAttrib2fv),
+        CH_GL_FUNCTION(glVertexAttrib2s),
+        CH_GL_FUNCTION(glVertexAttrib2sv),
+        CH_GL_FUNCTION(glVertexAttrib3d),
+        CH_GL_FUNCTION(glVertexAttrib3dv),
+        CH_GL_FUNCTION(glVertexAttrib3f),
+        CH_GL_FUNCTION(glVertexAttrib3fv),
+        CH_GL_FUNCTION(glVertexAttrib3s),
+        CH_GL_FUNCTION(glVertexAttrib3sv),
+        CH_GL_FUNCTION(glVertexAttrib4Nbv),
+        CH_GL_FUNCTION(glVertexAttrib4Niv),
+        CH_GL_FUNCTION(glVertexAttrib4Nsv),
+        CH_GL_FUNCTION(glVertexAttrib4Nub),
+        CH_GL_FUNCTION(glVertexAttrib4Nubv),
+        CH_GL_FUNCTION(glVertexAttrib4Nuiv),
+        CH_GL_FUNCTION(glVertexAttrib4Nusv),
+        CH_GL_FUNCTION(glVertexAttrib4bv),
+        CH_GL_FUNCTION(glVertexAttrib4d),
+        CH_GL_FUNCTION(glVertexAttrib4dv),
+        CH_GL_FUNCTION(glVertexAttrib4f),
+        CH_GL_FUNCTION(glVertexAttrib4fv),
+        CH_GL_FUNCTION(glVertexAttrib4iv),
+        CH_GL_FUNCTION(glVertexAttrib4s),
+        CH_GL_FUNCTION(glVertexAttrib4sv),
+        CH_GL_FUNCTION(glVertexAttrib4ubv),
+        CH_GL_FUNCTION(glVertexAttrib4uiv),
+        CH_GL_FUNCTION(glVertexAttrib4usv),
+        CH_GL_FUNCTION(glVertexAttribPointer),
+        // GL_VERSION_2_1
+        CH_GL_FUNCTION(glUniformMatrix2x3fv),
+        CH_GL_FUNCTION(glUniformMatrix3x2fv),
+        CH_GL_FUNCTION(glUniformMatrix2x4fv),
+        CH_GL_FUNCTION(glUniformMatrix4x2fv),
+        CH_GL_FUNCTION(glUniformMatrix3x4fv),
+        CH_GL_FUNCTION(glUniformMatrix4x3fv),
+        // GL_VERSION_3_0
+        CH_GL_FUNCTION(glColorMaski),
+        CH_GL_FUNCTION(glGetBooleani_v),
+        CH_GL_FUNCTION(glGetIntegeri_v),
+        CH_GL_FUNCTION(glEnablei),
+        CH_GL_FUNCTION(glDisablei),
+        CH_GL_FUNCTION(glIsEnabledi),
+        CH_GL_FUNCTION(glBeginTransformFeedback),
+        CH_GL_FUNCTION(glEndTransformFeedback),
+        CH_GL_FUNCTION(glBindBufferRange),
+        CH_GL_FUNCTION(glBindBufferBase),
+        CH_GL_FUNCTION(glTransformFeedbackVaryings),
+        CH_GL_FUNCTION(glGetTransformFeedbackVarying),
+        CH_GL_FUNCTION(glClampColor),
+        CH_GL_FUNCTION(glBeginConditionalRender),
+        CH_GL_FUNCTION(glEndConditionalRender),
+        CH_GL_FUNCTION(glVertexAttribIPointer),
+        CH_GL_FUNCTION(glGetVertexAttribIiv),
+        CH_GL_FUNCTION(glGetVertexAttribIuiv),
+        CH_GL_FUNCTION(glVertexAttribI1i),
+        CH_GL_FUNCTION(glVertexAttribI2i),
+        CH_GL_FUNCTION(glVertexAttribI3i),
+        CH_GL_FUNCTION(glVertexAttribI4i),
+        CH_GL_FUNCTION(glVertexAttribI1ui),
+        CH_GL_FUNCTION(glVertexAttribI2ui),
+        CH_GL_FUNCTION(glVertexAttribI3ui),
+        CH_GL_FUNCTION(glVertexAttribI4ui),
+        CH_GL_FUNCTION(glVertexAttribI1iv),
+        CH_GL_FUNCTION(glVertexAttribI2iv),
+        CH_GL_FUNCTION(glVertexAttribI3iv),
+        CH_GL_FUNCTION(glVertexAttribI4iv),
+        CH_GL_FUNCTION(glVertexAttribI1uiv),
+        CH_GL_FUNCTION(glVertexAttribI2uiv),
+        CH_GL_FUNCTION(glVertexAttribI3uiv),
+        CH_GL_FUNCTION(glVertexAttribI4uiv),
+        CH_GL_FUNCTION(glVertexAttribI4bv),
+        CH_GL_FUNCTION(glVertexAttribI4sv),
+        CH_GL_FUNCTION(glVertexAttribI4ubv),
+        CH_GL_FUNCTION(glVertexAttribI4usv),
+        CH_GL_FUNCTION(glGetUniformuiv),
+        CH_GL_FUNCTION(glBindFragDataLocation),
+        CH_GL_FUNCTION(glGetFragDataLocation),
+        CH_GL_FUNCTION(glUniform1ui),
+        CH_GL_FUNCTION(glUniform2ui),
+        CH_GL_FUNCTION(glUniform3ui),
+        CH_GL_FUNCTION(glUniform4ui),
+        CH_GL_FUNCTION(glUniform1uiv),
+        CH_GL_FUNCTION(glUniform2uiv),
+        CH_GL_FUNCTION(glUniform3uiv),
+        CH_GL_FUNCTION(glUniform4uiv),
+        CH_GL_FUNCTION(glTexParameterIiv),
+        CH_GL_FUNCTION(glTexParameterIuiv),
+        CH_GL_FUNCTION(glGetTexParameterIiv),
+        CH_GL_FUNCTION(glGetTexParameterIuiv),
+        CH_GL_FUNCTION(glClearBufferiv),
+        CH_GL_FUNCTION(glClearBufferuiv),
+        CH_GL_FUNCTION(glClearBufferfv),
+        CH_GL_FUNCTION(glClearBufferfi),
+        CH_GL_FUNCTION(glGetStringi),
+        CH_GL_FUNCTION(glIsRenderbuffer),
+        CH_GL_FUNCTION(glBindRenderbuffer),
+        CH_GL_FUNCTION(glDeleteRenderbuffers),
+        CH_GL_FUNCTION(glGenRenderbuffers),
+        CH_GL_FUNCTION(glRenderbufferStorage),
+        CH_GL_FUNCTION(glGetRenderbufferParameteriv),
+        CH_GL_FUNCTION(glIsFramebuffer),
+        CH_GL_FUNCTION(glBindFramebuffer),
+        CH_GL_FUNCTION(glDeleteFramebuffers),
+        CH_GL_FUNCTION(glGenFramebuffers),
+        CH_GL_FUNCTION(glCheckFramebufferStatus),
+        CH_GL_FUNCTION(glFramebufferTexture1D),
+        CH_GL_FUNCTION(glFramebufferTexture2D),
+        CH_GL_FUNCTION(glFramebufferTexture3D),
+        CH_GL_FUNCTION(glFramebufferRenderbuffer),
+        CH_GL_FUNCTION(glGetFramebufferAttachmentParameteriv),
+        CH_GL_FUNCTION(glGenerateMipmap),
+        CH_GL_FUNCTION(glBlitFramebuffer),
+        CH_GL_FUNCTION(glRenderbufferStorageMultisample),
+        CH_GL_FUNCTION(glFramebufferTextureLayer),
+        CH_GL_FUNCTION(glMapBufferRange),
+        CH_GL_FUNCTION(glFlushMappedBufferRange),
+        CH_GL_FUNCTION(glBindVertexArray),
+        CH_GL_FUNCTION(glDeleteVertexArrays),
+        CH_GL_FUNCTION(glGenVertexArrays),
+        CH_GL_FUNCTION(glIsVertexArray),
+        // GL_VERSION_3_1
+        CH_GL_FUNCTION(glDrawArraysInstanced),
+        CH_GL_FUNCTION(glDrawElementsInstanced),
+        CH_GL_FUNCTION(glTexBuffer),
+        CH_GL_FUNCTION(glPrimitiveRestartIndex),
+        CH_GL_FUNCTION(glCopyBufferSubData),
+        CH_GL_FUNCTION(glGetUniformIndices),
+        CH_GL_FUNCTION(glGetActiveUniformsiv),
+        CH_GL_FUNCTION(glGetActiveUniformName),
+        CH_GL_FUNCTION(glGetUniformBlockIndex),
+        CH_GL_FUNCTION(glGetActiveUniformBlockiv),
+        CH_GL_FUNCTION(glGetActiveUniformBlockName),
+        CH_GL_FUNCTION(glUniformBlockBinding),
+        // GL_VERSION_3_2
+        CH_GL_FUNCTION(glDrawElementsBaseVertex),
+        CH_GL_FUNCTION(glDrawRangeElementsBaseVertex),
+        CH_GL_FUNCTION(glDrawElementsInstancedBaseVertex),
+        CH_GL_FUNCTION(glMultiDrawElementsBaseVertex),
+        CH_GL_FUNCTION(glProvokingVertex),
+        CH_GL_FUNCTION(glFenceSync),
+        CH_GL_FUNCTION(glIsSync),
+        CH_GL_FUNCTION(glDeleteSync),
+        CH_GL_FUNCTION(glClientWaitSync),
+        CH_GL_FUNCTION(glWaitSync),
+        CH_GL_FUNCTION(glGetInteger64v),
+        CH_GL_FUNCTION(glGetSynciv),
+        CH_GL_FUNCTION(glGetInteger64i_v),
+        CH_GL_FUNCTION(glGetBufferParameteri64v),
+        CH_GL_FUNCTION(glFramebufferTexture),
+        CH_GL_FUNCTION(glTexImage2DMultisample),
+        CH_GL_FUNCTION(glTexImage3DMultisample),
+        CH_GL_FUNCTION(glGetMultisamplefv),
+        CH_GL_FUNCTION(glSampleMaski),
+        // GL_VERSION_3_3
+        CH_GL_FUNCTION(glBindFragDataLocationIndexed),
+        CH_GL_FUNCTION(glGetFragDataIndex),
+        CH_GL_FUNCTION(glGenSamplers),
+        CH_GL_FUNCTION(glDeleteSamplers),
+        CH_GL_FUNCTION(glIsSampler),
+        CH_GL_FUNCTION(glBindSampler),
+        CH_GL_FUNCTION(glSamplerParameteri),
+        CH_GL_FUNCTION(glSamplerParameteriv),
+        CH_GL_FUNCTION(glSamplerParameterf),
+        CH_GL_FUNCTION(glSamplerParameterfv),
+        CH_GL_FUNCTION(glSamplerParameterIiv),
+        CH_GL_FUNCTION(glSamplerParameterIuiv),
+        CH_GL_FUNCTION(glGetSamplerParameteriv),
+        CH_GL_FUNCTION(glGetSamplerParameterIiv),
+        CH_GL_FUNCTION(glGetSamplerParameterfv),
+        CH_GL_FUNCTION(glGetSamplerParameterIuiv),
+        CH_GL_FUNCTION(glQueryCounter),
+        CH_GL_FUNCTION(glGetQueryObjecti64v),
+        CH_GL_FUNCTION(glGetQueryObjectui64v),
+        CH_GL_FUNCTION(glVertexAttribDivisor),
+        CH_GL_FUNCTION(glVertexAttribP1ui),
+        CH_GL_FUNCTION(glVertexAttribP1uiv),
+        CH_GL_FUNCTION(glVertexAttribP2ui),
+        CH_GL_FUNCTION(glVertexAttribP2uiv),
+        CH_GL_FUNCTION(glVertexAttribP3ui),
+        CH_GL_FUNCTION(glVertexAttribP3uiv),
+        CH_GL_FUNCTION(glVertexAttribP4ui),
+        CH_GL_FUNCTION(glVertexAttribP4uiv),
+        // GL_VERSION_4_0
+        CH_GL_FUNCTION(glMinSampleShading),
+        CH_GL_FUNCTION(glBlendEquationi),
+        CH_GL_FUNCTION(glBlendEquationSeparatei),
+        CH_GL_FUNCTION(glBlendFunci),
+        CH_GL_FUNCTION(glBlendFuncSeparatei),
+        CH_GL_FUNCTION(glDrawArraysIndirect),
+        CH_GL_FUNCTION(glDrawElementsIndirect),
+        CH_GL_FUNCTION(glUniform1d),
+        CH_GL_FUNCTION(glUniform2d),
+        CH_GL_FUNCTION(glUniform3d),
+        CH_GL_FUNCTION(glUniform4d),
+        CH_GL_FUNCTION(glUniform1dv),
+        CH_GL_FUNCTION(glUniform2dv),
+        CH_GL_FUNCTION(glUniform3dv),
+        CH_GL_FUNCTION(glUniform4dv),
+        CH_GL_FUNCTION(glUniformMatrix2dv),
+        CH_GL_FUNCTION(glUniformMatrix3dv),
+        CH_GL_FUNCTION(glUniformMatrix4dv),
+        CH_GL_FUNCTION(glUniformMatrix2x3dv),
+        CH_GL_FUNCTION(glUniformMatrix2x4dv),
+        CH_GL_FUNCTION(glUniformMatrix3x2dv),
+        CH_GL_FUNCTION(glUniformMatrix3x4dv),
+        CH_GL_FUNCTION(glUniformMatrix4x2dv),
+        CH_GL_FUNCTION(glUniformMatrix4x3dv),
+        CH_GL_FUNCTION(glGetUniformdv),
+        CH_GL_FUNCTION(glGetSubroutineUniformLocation),
+        CH_GL_FUNCTION(glGetSubroutineIndex),
+        CH_GL_FUNCTION(glGetActiveSubroutineUniformiv),
+        CH_GL_FUNCTION(glGetActiveSubroutineUniformName),
+        CH_GL_FUNCTION(glGetActiveSubroutineName),
+        CH_GL_FUNCTION(glUniformSubroutinesuiv),
+        CH_GL_FUNCTION(glGetUniformSubroutineuiv),
+        CH_GL_FUNCTION(glGetProgramStageiv),
+        CH_GL_FUNCTION(glPatchParameteri),
+        CH_GL_FUNCTION(glPatchParameterfv),
+        CH_GL_FUNCTION(glBindTransformFeedback),
+        CH_GL_FUNCTION(glDeleteTransformFeedbacks),
+        CH_GL_FUNCTION(glGenTransformFeedbacks),
+        CH_GL_FUNCTION(glIsTransformFeedback),
+        CH_GL_FUNCTION(glPauseTransformFeedback),
+        CH_GL_FUNCTION(glResumeTransformFeedback),
+        CH_GL_FUNCTION(glDrawTransformFeedback),
+        CH_GL_FUNCTION(glDrawTransformFeedbackStream),
+        CH_GL_FUNCTION(glBeginQueryIndexed),
+        CH_GL_FUNCTION(glEndQueryIndexed),
+        CH_GL_FUNCTION(glGetQueryIndexediv),
+        // GL_VERSION_4_1
+        CH_GL_FUNCTION(glReleaseShaderCompiler),
+        CH_GL_FUNCTION(glShaderBinary),
+        CH_GL_FUNCTION(glGetShaderPrecisionFormat),
+        CH_GL_FUNCTION(glDepthRangef),
+        CH_GL_FUNCTION(glClearDepthf),
+        CH_GL_FUNCTION(glGetProgramBinary),
+        CH_GL_FUNCTION(glProgramBinary),
+        CH_GL_FUNCTION(glProgramParameteri),
+        CH_GL_FUNCTION(glUseProgramStages),
+        CH_GL_FUNCTION(glActiveShaderProgram),
+        CH_GL_FUNCTION(glCreateShaderProgramv),
+        CH_GL_FUNCTION(glBindProgramPipeline),
+        CH_GL_FUNCTION(glDeleteProgramPipelines),
+        CH_GL_FUNCTION(glGenProgramPipelines),
+        CH_GL_FUNCTION(glIsProgramPipeline),
+        CH_GL_FUNCTION(glGetProgramPipelineiv),
+        CH_GL_FUNCTION(glProgramUniform1i),
+        CH_GL_FUNCTION(glProgramUniform1iv),
+        CH_GL_FUNCTION(glProgramUniform1f),
+        CH_GL_FUNCTION(glProgramUniform1fv),
+        CH_GL_FUNCTION(glProgramUniform1d),
+        CH_GL_FUNCTION(glProgramUniform1dv),
+        CH_GL_FUNCTION(glProgramUniform1ui),
+        CH_GL_FUNCTION(glProgramUniform1uiv),
+        CH_GL_FUNCTION(glProgramUniform2i),
+        CH_GL_FUNCTION(glProgramUniform2iv),
+        CH_GL_FUNCTION(glProgramUniform2f),
+        CH_GL_FUNCTION(glProgramUniform2fv),
+        CH_GL_FUNCTION(glProgramUniform2d),
+        CH_GL_FUNCTION(glProgramUniform2dv),
+        CH_GL_FUNCTION(glProgramUniform2ui),
+        CH_GL_FUNCTION(glProgramUniform2uiv),
+        CH_GL_FUNCTION(glProgramUniform3i),
+        CH_GL_FUNCTION(glProgramUniform3iv),
+        CH_GL_FUNCTION(glProgramUniform3f),
+        CH_GL_FUNCTION(glProgramUniform3fv),
+        CH_GL_FUNCTION(glProgramUniform3d),
+        CH_GL_FUNCTION(glProgramUniform3dv),
+        CH_GL_FUNCTION(glProgramUniform3ui),
+        CH_GL_FUNCTION(glProgramUniform3uiv),
+        CH_GL_FUNCTION(glProgramUniform4i),
+        CH_GL_FUNCTION(glProgramUniform4iv),
+        CH_GL_FUNCTION(glProgramUniform4f),
+        CH_GL_FUNCTION(glProgramUniform4fv),
+        CH_GL_FUNCTION(glProgramUniform4d),
+        CH_GL_FUNCTION(glProgramUniform4dv),
+        CH_GL_FUNCTION(glProgramUniform4ui),
+        CH_GL_FUNCTION(glProgramUniform4uiv),
+        CH_GL_FUNCTION(glProgramUniformMatrix2fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix3fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix4fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix2dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix3dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix4dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x3fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x2fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x4fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x2fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x4fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x3fv),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x3dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x2dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x4dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x2dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x4dv),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x3dv),
+        CH_GL_FUNCTION(glValidateProgramPipeline),
+        CH_GL_FUNCTION(glGetProgramPipelineInfoLog),
+        CH_GL_FUNCTION(glVertexAttribL1d),
+        CH_GL_FUNCTION(glVertexAttribL2d),
+        CH_GL_FUNCTION(glVertexAttribL3d),
+        CH_GL_FUNCTION(glVertexAttribL4d),
+        CH_GL_FUNCTION(glVertexAttribL1dv),
+        CH_GL_FUNCTION(glVertexAttribL2dv),
+        CH_GL_FUNCTION(glVertexAttribL3dv),
+        CH_GL_FUNCTION(glVertexAttribL4dv),
+        CH_GL_FUNCTION(glVertexAttribLPointer),
+        CH_GL_FUNCTION(glGetVertexAttribLdv),
+        CH_GL_FUNCTION(glViewportArrayv),
+        CH_GL_FUNCTION(glViewportIndexedf),
+        CH_GL_FUNCTION(glViewportIndexedfv),
+        CH_GL_FUNCTION(glScissorArrayv),
+        CH_GL_FUNCTION(glScissorIndexed),
+        CH_GL_FUNCTION(glScissorIndexedv),
+        CH_GL_FUNCTION(glDepthRangeArrayv),
+        CH_GL_FUNCTION(glDepthRangeIndexed),
+        CH_GL_FUNCTION(glGetFloati_v),
+        CH_GL_FUNCTION(glGetDoublei_v),
+        // GL_VERSION_4_2
+        CH_GL_FUNCTION(glDrawArraysInstancedBaseInstance),
+        CH_GL_FUNCTION(glDrawElementsInstancedBaseInstance),
+        CH_GL_FUNCTION(glDrawElementsInstancedBaseVertexBaseInstance),
+        CH_GL_FUNCTION(glGetInternalformativ),
+        CH_GL_FUNCTION(glGetActiveAtomicCounterBufferiv),
+        CH_GL_FUNCTION(glBindImageTexture),
+        CH_GL_FUNCTION(glMemoryBarrier),
+        CH_GL_FUNCTION(glTexStorage1D),
+        CH_GL_FUNCTION(glTexStorage2D),
+        CH_GL_FUNCTION(glTexStorage3D),
+        CH_GL_FUNCTION(glDrawTransformFeedbackInstanced),
+        CH_GL_FUNCTION(glDrawTransformFeedbackStreamInstanced),
+        // GL_VERSION_4_3
+        CH_GL_FUNCTION(glClearBufferData),
+        CH_GL_FUNCTION(glClearBufferSubData),
+        CH_GL_FUNCTION(glDispatchCompute),
+        CH_GL_FUNCTION(glDispatchComputeIndirect),
+        CH_GL_FUNCTION(glCopyImageSubData),
+        CH_GL_FUNCTION(glFramebufferParameteri),
+        CH_GL_FUNCTION(glGetFramebufferParameteriv),
+        CH_GL_FUNCTION(glGetInternalformati64v),
+        CH_GL_FUNCTION(glInvalidateTexSubImage),
+        CH_GL_FUNCTION(glInvalidateTexImage),
+        CH_GL_FUNCTION(glInvalidateBufferSubData),
+        CH_GL_FUNCTION(glInvalidateBufferData),
+        CH_GL_FUNCTION(glInvalidateFramebuffer),
+        CH_GL_FUNCTION(glInvalidateSubFramebuffer),
+        CH_GL_FUNCTION(glMultiDrawArraysIndirect),
+        CH_GL_FUNCTION(glMultiDrawElementsIndirect),
+        CH_GL_FUNCTION(glGetProgramInterfaceiv),
+        CH_GL_FUNCTION(glGetProgramResourceIndex),
+        CH_GL_FUNCTION(glGetProgramResourceName),
+        CH_GL_FUNCTION(glGetProgramResourceiv),
+        CH_GL_FUNCTION(glGetProgramResourceLocation),
+        CH_GL_FUNCTION(glGetProgramResourceLocationIndex),
+        CH_GL_FUNCTION(glShaderStorageBlockBinding),
+        CH_GL_FUNCTION(glTexBufferRange),
+        CH_GL_FUNCTION(glTexStorage2DMultisample),
+        CH_GL_FUNCTION(glTexStorage3DMultisample),
+        CH_GL_FUNCTION(glTextureView),
+        CH_GL_FUNCTION(glBindVertexBuffer),
+        CH_GL_FUNCTION(glVertexAttribFormat),
+        CH_GL_FUNCTION(glVertexAttribIFormat),
+        CH_GL_FUNCTION(glVertexAttribLFormat),
+        CH_GL_FUNCTION(glVertexAttribBinding),
+        CH_GL_FUNCTION(glVertexBindingDivisor),
+        CH_GL_FUNCTION(glDebugMessageControl),
+        CH_GL_FUNCTION(glDebugMessageInsert),
+        CH_GL_FUNCTION(glDebugMessageCallback),
+        CH_GL_FUNCTION(glGetDebugMessageLog),
+        CH_GL_FUNCTION(glPushDebugGroup),
+        CH_GL_FUNCTION(glPopDebugGroup),
+        CH_GL_FUNCTION(glObjectLabel),
+        CH_GL_FUNCTION(glGetObjectLabel),
+        CH_GL_FUNCTION(glObjectPtrLabel),
+        CH_GL_FUNCTION(glGetObjectPtrLabel),
+        // GL_VERSION_4_4
+        CH_GL_FUNCTION(glBufferStorage),
+        CH_GL_FUNCTION(glClearTexImage),
+        CH_GL_FUNCTION(glClearTexSubImage),
+        CH_GL_FUNCTION(glBindBuffersBase),
+        CH_GL_FUNCTION(glBindBuffersRange),
+        CH_GL_FUNCTION(glBindTextures),
+        CH_GL_FUNCTION(glBindSamplers),
+        CH_GL_FUNCTION(glBindImageTextures),
+        CH_GL_FUNCTION(glBindVertexBuffers),
+        // GL_VERSION_4_5
+        CH_GL_FUNCTION(glClipControl),
+        CH_GL_FUNCTION(glCreateTransformFeedbacks),
+        CH_GL_FUNCTION(glTransformFeedbackBufferBase),
+        CH_GL_FUNCTION(glTransformFeedbackBufferRange),
+        CH_GL_FUNCTION(glGetTransformFeedbackiv),
+        CH_GL_FUNCTION(glGetTransformFeedbacki_v),
+        CH_GL_FUNCTION(glGetTransformFeedbacki64_v),
+        CH_GL_FUNCTION(glCreateBuffers),
+        CH_GL_FUNCTION(glNamedBufferStorage),
+        CH_GL_FUNCTION(glNamedBufferData),
+        CH_GL_FUNCTION(glNamedBufferSubData),
+        CH_GL_FUNCTION(glCopyNamedBufferSubData),
+        CH_GL_FUNCTION(glClearNamedBufferData),
+        CH_GL_FUNCTION(glClearNamedBufferSubData),
+        CH_GL_FUNCTION(glMapNamedBuffer),
+        CH_GL_FUNCTION(glMapNamedBufferRange),
+        CH_GL_FUNCTION(glUnmapNamedBuffer),
+        CH_GL_FUNCTION(glFlushMappedNamedBufferRange),
+        CH_GL_FUNCTION(glGetNamedBufferParameteriv),
+        CH_GL_FUNCTION(glGetNamedBufferParameteri64v),
+        CH_GL_FUNCTION(glGetNamedBufferPointerv),
+        CH_GL_FUNCTION(glGetNamedBufferSubData),
+        CH_GL_FUNCTION(glCreateFramebuffers),
+        CH_GL_FUNCTION(glNamedFramebufferRenderbuffer),
+        CH_GL_FUNCTION(glNamedFramebufferParameteri),
+        CH_GL_FUNCTION(glNamedFramebufferTexture),
+        CH_GL_FUNCTION(glNamedFramebufferTextureLayer),
+        CH_GL_FUNCTION(glNamedFramebufferDrawBuffer),
+        CH_GL_FUNCTION(glNamedFramebufferDrawBuffers),
+        CH_GL_FUNCTION(glNamedFramebufferReadBuffer),
+        CH_GL_FUNCTION(glInvalidateNamedFramebufferData),
+        CH_GL_FUNCTION(glInvalidateNamedFramebufferSubData),
+        CH_GL_FUNCTION(glClearNamedFramebufferiv),
+        CH_GL_FUNCTION(glClearNamedFramebufferuiv),
+        CH_GL_FUNCTION(glClearNamedFramebufferfv),
+        CH_GL_FUNCTION(glClearNamedFramebufferfi),
+        CH_GL_FUNCTION(glBlitNamedFramebuffer),
+        CH_GL_FUNCTION(glCheckNamedFramebufferStatus),
+        CH_GL_FUNCTION(glGetNamedFramebufferParameteriv),
+        CH_GL_FUNCTION(glGetNamedFramebufferAttachmentParameteriv),
+        CH_GL_FUNCTION(glCreateRenderbuffers),
+        CH_GL_FUNCTION(glNamedRenderbufferStorage),
+        CH_GL_FUNCTION(glNamedRenderbufferStorageMultisample),
+        CH_GL_FUNCTION(glGetNamedRenderbufferParameteriv),
+        CH_GL_FUNCTION(glCreateTextures),
+        CH_GL_FUNCTION(glTextureBuffer),
+        CH_GL_FUNCTION(glTextureBufferRange),
+        CH_GL_FUNCTION(glTextureStorage1D),
+        CH_GL_FUNCTION(glTextureStorage2D),
+        CH_GL_FUNCTION(glTextureStorage3D),
+        CH_GL_FUNCTION(glTextureStorage2DMultisample),
+        CH_GL_FUNCTION(glTextureStorage3DMultisample),
+        CH_GL_FUNCTION(glTextureSubImage1D),
+        CH_GL_FUNCTION(glTextureSubImage2D),
+        CH_GL_FUNCTION(glTextureSubImage3D),
+        CH_GL_FUNCTION(glCompressedTextureSubImage1D),
+        CH_GL_FUNCTION(glCompressedTextureSubImage2D),
+        CH_GL_FUNCTION(glCompressedTextureSubImage3D),
+        CH_GL_FUNCTION(glCopyTextureSubImage1D),
+        CH_GL_FUNCTION(glCopyTextureSubImage2D),
+        CH_GL_FUNCTION(glCopyTextureSubImage3D),
+        CH_GL_FUNCTION(glTextureParameterf),
+        CH_GL_FUNCTION(glTextureParameterfv),
+        CH_GL_FUNCTION(glTextureParameteri),
+        CH_GL_FUNCTION(glTextureParameterIiv),
+        CH_GL_FUNCTION(glTextureParameterIuiv),
+        CH_GL_FUNCTION(glTextureParameteriv),
+        CH_GL_FUNCTION(glGenerateTextureMipmap),
+        CH_GL_FUNCTION(glBindTextureUnit),
+        CH_GL_FUNCTION(glGetTextureImage),
+        CH_GL_FUNCTION(glGetCompressedTextureImage),
+        CH_GL_FUNCTION(glGetTextureLevelParameterfv),
+        CH_GL_FUNCTION(glGetTextureLevelParameteriv),
+        CH_GL_FUNCTION(glGetTextureParameterfv),
+        CH_GL_FUNCTION(glGetTextureParameterIiv),
+        CH_GL_FUNCTION(glGetTextureParameterIuiv),
+        CH_GL_FUNCTION(glGetTextureParameteriv),
+        CH_GL_FUNCTION(glCreateVertexArrays),
+        CH_GL_FUNCTION(glDisableVertexArrayAttrib),
+        CH_GL_FUNCTION(glEnableVertexArrayAttrib),
+        CH_GL_FUNCTION(glVertexArrayElementBuffer),
+        CH_GL_FUNCTION(glVertexArrayVertexBuffer),
+        CH_GL_FUNCTION(glVertexArrayVertexBuffers),
+        CH_GL_FUNCTION(glVertexArrayAttribBinding),
+        CH_GL_FUNCTION(glVertexArrayAttribFormat),
+        CH_GL_FUNCTION(glVertexArrayAttribIFormat),
+        CH_GL_FUNCTION(glVertexArrayAttribLFormat),
+        CH_GL_FUNCTION(glVertexArrayBindingDivisor),
+        CH_GL_FUNCTION(glGetVertexArrayiv),
+        CH_GL_FUNCTION(glGetVertexArrayIndexediv),
+        CH_GL_FUNCTION(glGetVertexArrayIndexed64iv),
+        CH_GL_FUNCTION(glCreateSamplers),
+        CH_GL_FUNCTION(glCreateProgramPipelines),
+        CH_GL_FUNCTION(glCreateQueries),
+        CH_GL_FUNCTION(glGetQueryBufferObjecti64v),
+        CH_GL_FUNCTION(glGetQueryBufferObjectiv),
+        CH_GL_FUNCTION(glGetQueryBufferObjectui64v),
+        CH_GL_FUNCTION(glGetQueryBufferObjectuiv),
+        CH_GL_FUNCTION(glMemoryBarrierByRegion),
+        CH_GL_FUNCTION(glGetTextureSubImage),
+        CH_GL_FUNCTION(glGetCompressedTextureSubImage),
+        CH_GL_FUNCTION(glGetGraphicsResetStatus),
+        CH_GL_FUNCTION(glGetnCompressedTexImage),
+        CH_GL_FUNCTION(glGetnTexImage),
+        CH_GL_FUNCTION(glGetnUniformdv),
+        CH_GL_FUNCTION(glGetnUniformfv),
+        CH_GL_FUNCTION(glGetnUniformiv),
+        CH_GL_FUNCTION(glGetnUniformuiv),
+        CH_GL_FUNCTION(glReadnPixels),
+        CH_GL_FUNCTION(glTextureBarrier),
+        // GL_ARB_bindless_texture
+        CH_GL_FUNCTION(glGetTextureHandleARB),
+        CH_GL_FUNCTION(glGetTextureSamplerHandleARB),
+        CH_GL_FUNCTION(glMakeTextureHandleResidentARB),
+        CH_GL_FUNCTION(glMakeTextureHandleNonResidentARB),
+        CH_GL_FUNCTION(glGetImageHandleARB),
+        CH_GL_FUNCTION(glMakeImageHandleResidentARB),
+        CH_GL_FUNCTION(glMakeImageHandleNonResidentARB),
+        CH_GL_FUNCTION(glUniformHandleui64ARB),
+        CH_GL_FUNCTION(glUniformHandleui64vARB),
+        CH_GL_FUNCTION(glProgramUniformHandleui64ARB),
+        CH_GL_FUNCTION(glProgramUniformHandleui64vARB),
+        CH_GL_FUNCTION(glIsTextureHandleResidentARB),
+        CH_GL_FUNCTION(glIsImageHandleResidentARB),
+        CH_GL_FUNCTION(glVertexAttribL1ui64ARB),
+        CH_GL_FUNCTION(glVertexAttribL1ui64vARB),
+        CH_GL_FUNCTION(glGetVertexAttribLui64vARB),
+        // GL_ARB_cl_event
+        CH_GL_FUNCTION(glCreateSyncFromCLeventARB),
+        // GL_ARB_compute_variable_group_size
+        CH_GL_FUNCTION(glDispatchComputeGroupSizeARB),
+        // GL_ARB_debug_output
+        CH_GL_FUNCTION(glDebugMessageControlARB),
+        CH_GL_FUNCTION(glDebugMessageInsertARB),
+        CH_GL_FUNCTION(glDebugMessageCallbackARB),
+        CH_GL_FUNCTION(glGetDebugMessageLogARB),
+        // GL_ARB_draw_buffers_blend
+        CH_GL_FUNCTION(glBlendEquationiARB),
+        CH_GL_FUNCTION(glBlendEquationSeparateiARB),
+        CH_GL_FUNCTION(glBlendFunciARB),
+        CH_GL_FUNCTION(glBlendFuncSeparateiARB),
+        // GL_ARB_indirect_parameters
+        CH_GL_FUNCTION(glMultiDrawArraysIndirectCountARB),
+        CH_GL_FUNCTION(glMultiDrawElementsIndirectCountARB),
+        // GL_ARB_robustness
+        CH_GL_FUNCTION(glGetGraphicsResetStatusARB),
+        CH_GL_FUNCTION(glGetnTexImageARB),
+        CH_GL_FUNCTION(glReadnPixelsARB),
+        CH_GL_FUNCTION(glGetnCompressedTexImageARB),
+        CH_GL_FUNCTION(glGetnUniformfvARB),
+        CH_GL_FUNCTION(glGetnUniformivARB),
+        CH_GL_FUNCTION(glGetnUniformuivARB),
+        CH_GL_FUNCTION(glGetnUniformdvARB),
+        // GL_ARB_sample_shading
+        CH_GL_FUNCTION(glMinSampleShadingARB),
+        // GL_ARB_shading_language_include
+        CH_GL_FUNCTION(glNamedStringARB),
+        CH_GL_FUNCTION(glDeleteNamedStringARB),
+        CH_GL_FUNCTION(glCompileShaderIncludeARB),
+        CH_GL_FUNCTION(glIsNamedStringARB),
+        CH_GL_FUNCTION(glGetNamedStringARB),
+        CH_GL_FUNCTION(glGetNamedStringivARB),
+        // GL_ARB_sparse_buffer
+        CH_GL_FUNCTION(glBufferPageCommitmentARB),
+        CH_GL_FUNCTION(glNamedBufferPageCommitmentEXT),
+        CH_GL_FUNCTION(glNamedBufferPageCommitmentARB),
+        // GL_ARB_sparse_texture
+        CH_GL_FUNCTION(glTexPageCommitmentARB),
+        // GL_KHR_blend_equation_advanced
+        CH_GL_FUNCTION(glBlendBarrierKHR),
+        // GL_AMD_performance_monitor
+        CH_GL_FUNCTION(glGetPerfMonitorGroupsAMD),
+        CH_GL_FUNCTION(glGetPerfMonitorCountersAMD),
+        CH_GL_FUNCTION(glGetPerfMonitorGroupStringAMD),
+        CH_GL_FUNCTION(glGetPerfMonitorCounterStringAMD),
+        CH_GL_FUNCTION(glGetPerfMonitorCounterInfoAMD),
+        CH_GL_FUNCTION(glGenPerfMonitorsAMD),
+        CH_GL_FUNCTION(glDeletePerfMonitorsAMD),
+        CH_GL_FUNCTION(glSelectPerfMonitorCountersAMD),
+        CH_GL_FUNCTION(glBeginPerfMonitorAMD),
+        CH_GL_FUNCTION(glEndPerfMonitorAMD),
+        CH_GL_FUNCTION(glGetPerfMonitorCounterDataAMD),
+        // GL_EXT_debug_label
+        CH_GL_FUNCTION(glLabelObjectEXT),
+        CH_GL_FUNCTION(glGetObjectLabelEXT),
+        // GL_EXT_debug_marker
+        CH_GL_FUNCTION(glInsertEventMarkerEXT),
+        CH_GL_FUNCTION(glPushGroupMarkerEXT),
+        CH_GL_FUNCTION(glPopGroupMarkerEXT),
+        // GL_EXT_direct_state_access
+        CH_GL_FUNCTION(glMatrixLoadfEXT),
+        CH_GL_FUNCTION(glMatrixLoaddEXT),
+        CH_GL_FUNCTION(glMatrixMultfEXT),
+        CH_GL_FUNCTION(glMatrixMultdEXT),
+        CH_GL_FUNCTION(glMatrixLoadIdentityEXT),
+        CH_GL_FUNCTION(glMatrixRotatefEXT),
+        CH_GL_FUNCTION(glMatrixRotatedEXT),
+        CH_GL_FUNCTION(glMatrixScalefEXT),
+        CH_GL_FUNCTION(glMatrixScaledEXT),
+        CH_GL_FUNCTION(glMatrixTranslatefEXT),
+        CH_GL_FUNCTION(glMatrixTranslatedEXT),
+        CH_GL_FUNCTION(glMatrixFrustumEXT),
+        CH_GL_FUNCTION(glMatrixOrthoEXT),
+        CH_GL_FUNCTION(glMatrixPopEXT),
+        CH_GL_FUNCTION(glMatrixPushEXT),
+        CH_GL_FUNCTION(glClientAttribDefaultEXT),
+        CH_GL_FUNCTION(glPushClientAttribDefaultEXT),
+        CH_GL_FUNCTION(glTextureParameterfEXT),
+        CH_GL_FUNCTION(glTextureParameterfvEXT),
+        CH_GL_FUNCTION(glTextureParameteriEXT),
+        CH_GL_FUNCTION(glTextureParameterivEXT),
+        CH_GL_FUNCTION(glTextureImage1DEXT),
+        CH_GL_FUNCTION(glTextureImage2DEXT),
+        CH_GL_FUNCTION(glTextureSubImage1DEXT),
+        CH_GL_FUNCTION(glTextureSubImage2DEXT),
+        CH_GL_FUNCTION(glCopyTextureImage1DEXT),
+        CH_GL_FUNCTION(glCopyTextureImage2DEXT),
+        CH_GL_FUNCTION(glCopyTextureSubImage1DEXT),
+        CH_GL_FUNCTION(glCopyTextureSubImage2DEXT),
+        CH_GL_FUNCTION(glGetTextureImageEXT),
+        CH_GL_FUNCTION(glGetTextureParameterfvEXT),
+        CH_GL_FUNCTION(glGetTextureParameterivEXT),
+        CH_GL_FUNCTION(glGetTextureLevelParameterfvEXT),
+        CH_GL_FUNCTION(glGetTextureLevelParameterivEXT),
+        CH_GL_FUNCTION(glTextureImage3DEXT),
+        CH_GL_FUNCTION(glTextureSubImage3DEXT),
+        CH_GL_FUNCTION(glCopyTextureSubImage3DEXT),
+        CH_GL_FUNCTION(glBindMultiTextureEXT),
+        CH_GL_FUNCTION(glMultiTexCoordPointerEXT),
+        CH_GL_FUNCTION(glMultiTexEnvfEXT),
+        CH_GL_FUNCTION(glMultiTexEnvfvEXT),
+        CH_GL_FUNCTION(glMultiTexEnviEXT),
+        CH_GL_FUNCTION(glMultiTexEnvivEXT),
+        CH_GL_FUNCTION(glMultiTexGendEXT),
+        CH_GL_FUNCTION(glMultiTexGendvEXT),
+        CH_GL_FUNCTION(glMultiTexGenfEXT),
+        CH_GL_FUNCTION(glMultiTexGenfvEXT),
+        CH_GL_FUNCTION(glMultiTexGeniEXT),
+        CH_GL_FUNCTION(glMultiTexGenivEXT),
+        CH_GL_FUNCTION(glGetMultiTexEnvfvEXT),
+        CH_GL_FUNCTION(glGetMultiTexEnvivEXT),
+        CH_GL_FUNCTION(glGetMultiTexGendvEXT),
+        CH_GL_FUNCTION(glGetMultiTexGenfvEXT),
+        CH_GL_FUNCTION(glGetMultiTexGenivEXT),
+        CH_GL_FUNCTION(glMultiTexParameteriEXT),
+        CH_GL_FUNCTION(glMultiTexParameterivEXT),
+        CH_GL_FUNCTION(glMultiTexParameterfEXT),
+        CH_GL_FUNCTION(glMultiTexParameterfvEXT),
+        CH_GL_FUNCTION(glMultiTexImage1DEXT),
+        CH_GL_FUNCTION(glMultiTexImage2DEXT),
+        CH_GL_FUNCTION(glMultiTexSubImage1DEXT),
+        CH_GL_FUNCTION(glMultiTexSubImage2DEXT),
+        CH_GL_FUNCTION(glCopyMultiTexImage1DEXT),
+        CH_GL_FUNCTION(glCopyMultiTexImage2DEXT),
+        CH_GL_FUNCTION(glCopyMultiTexSubImage1DEXT),
+        CH_GL_FUNCTION(glCopyMultiTexSubImage2DEXT),
+        CH_GL_FUNCTION(glGetMultiTexImageEXT),
+        CH_GL_FUNCTION(glGetMultiTexParameterfvEXT),
+        CH_GL_FUNCTION(glGetMultiTexParameterivEXT),
+        CH_GL_FUNCTION(glGetMultiTexLevelParameterfvEXT),
+        CH_GL_FUNCTION(glGetMultiTexLevelParameterivEXT),
+        CH_GL_FUNCTION(glMultiTexImage3DEXT),
+        CH_GL_FUNCTION(glMultiTexSubImage3DEXT),
+        CH_GL_FUNCTION(glCopyMultiTexSubImage3DEXT),
+        CH_GL_FUNCTION(glEnableClientStateIndexedEXT),
+        CH_GL_FUNCTION(glDisableClientStateIndexedEXT),
+        CH_GL_FUNCTION(glGetFloatIndexedvEXT),
+        CH_GL_FUNCTION(glGetDoubleIndexedvEXT),
+        CH_GL_FUNCTION(glGetPointerIndexedvEXT),
+        CH_GL_FUNCTION(glEnableIndexedEXT),
+        CH_GL_FUNCTION(glDisableIndexedEXT),
+        CH_GL_FUNCTION(glIsEnabledIndexedEXT),
+        CH_GL_FUNCTION(glGetIntegerIndexedvEXT),
+        CH_GL_FUNCTION(glGetBooleanIndexedvEXT),
+        CH_GL_FUNCTION(glCompressedTextureImage3DEXT),
+        CH_GL_FUNCTION(glCompressedTextureImage2DEXT),
+        CH_GL_FUNCTION(glCompressedTextureImage1DEXT),
+        CH_GL_FUNCTION(glCompressedTextureSubImage3DEXT),
+        CH_GL_FUNCTION(glCompressedTextureSubImage2DEXT),
+        CH_GL_FUNCTION(glCompressedTextureSubImage1DEXT),
+        CH_GL_FUNCTION(glGetCompressedTextureImageEXT),
+        CH_GL_FUNCTION(glCompressedMultiTexImage3DEXT),
+        CH_GL_FUNCTION(glCompressedMultiTexImage2DEXT),
+        CH_GL_FUNCTION(glCompressedMultiTexImage1DEXT),
+        CH_GL_FUNCTION(glCompressedMultiTexSubImage3DEXT),
+        CH_GL_FUNCTION(glCompressedMultiTexSubImage2DEXT),
+        CH_GL_FUNCTION(glCompressedMultiTexSubImage1DEXT),
+        CH_GL_FUNCTION(glGetCompressedMultiTexImageEXT),
+        CH_GL_FUNCTION(glMatrixLoadTransposefEXT),
+        CH_GL_FUNCTION(glMatrixLoadTransposedEXT),
+        CH_GL_FUNCTION(glMatrixMultTransposefEXT),
+        CH_GL_FUNCTION(glMatrixMultTransposedEXT),
+        CH_GL_FUNCTION(glNamedBufferDataEXT),
+        CH_GL_FUNCTION(glNamedBufferSubDataEXT),
+        CH_GL_FUNCTION(glMapNamedBufferEXT),
+        CH_GL_FUNCTION(glUnmapNamedBufferEXT),
+        CH_GL_FUNCTION(glGetNamedBufferParameterivEXT),
+        CH_GL_FUNCTION(glGetNamedBufferPointervEXT),
+        CH_GL_FUNCTION(glGetNamedBufferSubDataEXT),
+        CH_GL_FUNCTION(glProgramUniform1fEXT),
+        CH_GL_FUNCTION(glProgramUniform2fEXT),
+        CH_GL_FUNCTION(glProgramUniform3fEXT),
+        CH_GL_FUNCTION(glProgramUniform4fEXT),
+        CH_GL_FUNCTION(glProgramUniform1iEXT),
+        CH_GL_FUNCTION(glProgramUniform2iEXT),
+        CH_GL_FUNCTION(glProgramUniform3iEXT),
+        CH_GL_FUNCTION(glProgramUniform4iEXT),
+        CH_GL_FUNCTION(glProgramUniform1fvEXT),
+        CH_GL_FUNCTION(glProgramUniform2fvEXT),
+        CH_GL_FUNCTION(glProgramUniform3fvEXT),
+        CH_GL_FUNCTION(glProgramUniform4fvEXT),
+        CH_GL_FUNCTION(glProgramUniform1ivEXT),
+        CH_GL_FUNCTION(glProgramUniform2ivEXT),
+        CH_GL_FUNCTION(glProgramUniform3ivEXT),
+        CH_GL_FUNCTION(glProgramUniform4ivEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix2fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix3fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix4fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x3fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x2fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x4fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x2fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x4fvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x3fvEXT),
+        CH_GL_FUNCTION(glTextureBufferEXT),
+        CH_GL_FUNCTION(glMultiTexBufferEXT),
+        CH_GL_FUNCTION(glTextureParameterIivEXT),
+        CH_GL_FUNCTION(glTextureParameterIuivEXT),
+        CH_GL_FUNCTION(glGetTextureParameterIivEXT),
+        CH_GL_FUNCTION(glGetTextureParameterIuivEXT),
+        CH_GL_FUNCTION(glMultiTexParameterIivEXT),
+        CH_GL_FUNCTION(glMultiTexParameterIuivEXT),
+        CH_GL_FUNCTION(glGetMultiTexParameterIivEXT),
+        CH_GL_FUNCTION(glGetMultiTexParameterIuivEXT),
+        CH_GL_FUNCTION(glProgramUniform1uiEXT),
+        CH_GL_FUNCTION(glProgramUniform2uiEXT),
+        CH_GL_FUNCTION(glProgramUniform3uiEXT),
+        CH_GL_FUNCTION(glProgramUniform4uiEXT),
+        CH_GL_FUNCTION(glProgramUniform1uivEXT),
+        CH_GL_FUNCTION(glProgramUniform2uivEXT),
+        CH_GL_FUNCTION(glProgramUniform3uivEXT),
+        CH_GL_FUNCTION(glProgramUniform4uivEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameters4fvEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameterI4iEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameterI4ivEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParametersI4ivEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameterI4uiEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameterI4uivEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParametersI4uivEXT),
+        CH_GL_FUNCTION(glGetNamedProgramLocalParameterIivEXT),
+        CH_GL_FUNCTION(glGetNamedProgramLocalParameterIuivEXT),
+        CH_GL_FUNCTION(glEnableClientStateiEXT),
+        CH_GL_FUNCTION(glDisableClientStateiEXT),
+        CH_GL_FUNCTION(glGetFloati_vEXT),
+        CH_GL_FUNCTION(glGetDoublei_vEXT),
+        CH_GL_FUNCTION(glGetPointeri_vEXT),
+        CH_GL_FUNCTION(glNamedProgramStringEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameter4dEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameter4dvEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameter4fEXT),
+        CH_GL_FUNCTION(glNamedProgramLocalParameter4fvEXT),
+        CH_GL_FUNCTION(glGetNamedProgramLocalParameterdvEXT),
+        CH_GL_FUNCTION(glGetNamedProgramLocalParameterfvEXT),
+        CH_GL_FUNCTION(glGetNamedProgramivEXT),
+        CH_GL_FUNCTION(glGetNamedProgramStringEXT),
+        CH_GL_FUNCTION(glNamedRenderbufferStorageEXT),
+        CH_GL_FUNCTION(glGetNamedRenderbufferParameterivEXT),
+        CH_GL_FUNCTION(glNamedRenderbufferStorageMultisampleEXT),
+        CH_GL_FUNCTION(glNamedRenderbufferStorageMultisampleCoverageEXT),
+        CH_GL_FUNCTION(glCheckNamedFramebufferStatusEXT),
+        CH_GL_FUNCTION(glNamedFramebufferTexture1DEXT),
+        CH_GL_FUNCTION(glNamedFramebufferTexture2DEXT),
+        CH_GL_FUNCTION(glNamedFramebufferTexture3DEXT),
+        CH_GL_FUNCTION(glNamedFramebufferRenderbufferEXT),
+        CH_GL_FUNCTION(glGetNamedFramebufferAttachmentParameterivEXT),
+        CH_GL_FUNCTION(glGenerateTextureMipmapEXT),
+        CH_GL_FUNCTION(glGenerateMultiTexMipmapEXT),
+        CH_GL_FUNCTION(glFramebufferDrawBufferEXT),
+        CH_GL_FUNCTION(glFramebufferDrawBuffersEXT),
+        CH_GL_FUNCTION(glFramebufferReadBufferEXT),
+        CH_GL_FUNCTION(glGetFramebufferParameterivEXT),
+        CH_GL_FUNCTION(glNamedCopyBufferSubDataEXT),
+        CH_GL_FUNCTION(glNamedFramebufferTextureEXT),
+        CH_GL_FUNCTION(glNamedFramebufferTextureLayerEXT),
+        CH_GL_FUNCTION(glNamedFramebufferTextureFaceEXT),
+        CH_GL_FUNCTION(glTextureRenderbufferEXT),
+        CH_GL_FUNCTION(glMultiTexRenderbufferEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayColorOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayEdgeFlagOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayIndexOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayNormalOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayTexCoordOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayMultiTexCoordOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayFogCoordOffsetEXT),
+        CH_GL_FUNCTION(glVertexArraySecondaryColorOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribOffsetEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribIOffsetEXT),
+        CH_GL_FUNCTION(glEnableVertexArrayEXT),
+        CH_GL_FUNCTION(glDisableVertexArrayEXT),
+        CH_GL_FUNCTION(glEnableVertexArrayAttribEXT),
+        CH_GL_FUNCTION(glDisableVertexArrayAttribEXT),
+        CH_GL_FUNCTION(glGetVertexArrayIntegervEXT),
+        CH_GL_FUNCTION(glGetVertexArrayPointervEXT),
+        CH_GL_FUNCTION(glGetVertexArrayIntegeri_vEXT),
+        CH_GL_FUNCTION(glGetVertexArrayPointeri_vEXT),
+        CH_GL_FUNCTION(glMapNamedBufferRangeEXT),
+        CH_GL_FUNCTION(glFlushMappedNamedBufferRangeEXT),
+        CH_GL_FUNCTION(glNamedBufferStorageEXT),
+        CH_GL_FUNCTION(glClearNamedBufferDataEXT),
+        CH_GL_FUNCTION(glClearNamedBufferSubDataEXT),
+        CH_GL_FUNCTION(glNamedFramebufferParameteriEXT),
+        CH_GL_FUNCTION(glGetNamedFramebufferParameterivEXT),
+        CH_GL_FUNCTION(glProgramUniform1dEXT),
+        CH_GL_FUNCTION(glProgramUniform2dEXT),
+        CH_GL_FUNCTION(glProgramUniform3dEXT),
+        CH_GL_FUNCTION(glProgramUniform4dEXT),
+        CH_GL_FUNCTION(glProgramUniform1dvEXT),
+        CH_GL_FUNCTION(glProgramUniform2dvEXT),
+        CH_GL_FUNCTION(glProgramUniform3dvEXT),
+        CH_GL_FUNCTION(glProgramUniform4dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix2dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix3dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix4dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x3dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix2x4dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x2dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix3x4dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x2dvEXT),
+        CH_GL_FUNCTION(glProgramUniformMatrix4x3dvEXT),
+        CH_GL_FUNCTION(glTextureBufferRangeEXT),
+        CH_GL_FUNCTION(glTextureStorage1DEXT),
+        CH_GL_FUNCTION(glTextureStorage2DEXT),
+        CH_GL_FUNCTION(glTextureStorage3DEXT),
+        CH_GL_FUNCTION(glTextureStorage2DMultisampleEXT),
+        CH_GL_FUNCTION(glTextureStorage3DMultisampleEXT),
+        CH_GL_FUNCTION(glVertexArrayBindVertexBufferEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribFormatEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribIFormatEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribLFormatEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribBindingEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexBindingDivisorEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribLOffsetEXT),
+        CH_GL_FUNCTION(glTexturePageCommitmentEXT),
+        CH_GL_FUNCTION(glVertexArrayVertexAttribDivisorEXT),
+        // GL_EXT_draw_instanced
+        CH_GL_FUNCTION(glDrawArraysInstancedEXT),
+        CH_GL_FUNCTION(glDrawElementsInstancedEXT),
+        // GL_EXT_polygon_offset_clamp
+        CH_GL_FUNCTION(glPolygonOffsetClampEXT),
+        // GL_EXT_raster_multisample
+        CH_GL_FUNCTION(glRasterSamplesEXT),
+        // GL_EXT_separate_shader_objects
+        CH_GL_FUNCTION(glUseShaderProgramEXT),
+        CH_GL_FUNCTION(glActiveProgramEXT),
+        CH_GL_FUNCTION(glCreateShaderProgramEXT),
+        // GL_EXT_window_rectangles
+        CH_GL_FUNCTION(glWindowRectanglesEXT),
+        // GL_INTEL_framebuffer_CMAA
+        CH_GL_FUNCTION(glApplyFramebufferAttachmentCMAAINTEL),
+        // GL_INTEL_performance_query
+        CH_GL_FUNCTION(glBeginPerfQueryINTEL),
+        CH_GL_FUNCTION(glCreatePerfQueryINTEL),
+        CH_GL_FUNCTION(glDeletePerfQueryINTEL),
+        CH_GL_FUNCTION(glEndPerfQueryINTEL),
+        CH_GL_FUNCTION(glGetFirstPerfQueryIdINTEL),
+        CH_GL_FUNCTION(glGetNextPerfQueryIdINTEL),
+        CH_GL_FUNCTION(glGetPerfCounterInfoINTEL),
+        CH_GL_FUNCTION(glGetPerfQueryDataINTEL),
+        CH_GL_FUNCTION(glGetPerfQueryIdByNameINTEL),
+        CH_GL_FUNCTION(glGetPerfQueryInfoINTEL),
+        // GL_NV_bindless_texture
+        CH_GL_FUNCTION(glGetTextureHandleNV),
+        CH_GL_FUNCTION(glGetTextureSamplerHandleNV),
+        CH_GL_FUNCTION(glMakeTextureHandleResidentNV),
+        CH_GL_FUNCTION(glMakeTextureHandleNonResidentNV),
+        CH_GL_FUNCTION(glGetImageHandleNV),
+        CH_GL_FUNCTION(glMakeImageHandleResidentNV),
+        CH_GL_FUNCTION(glMakeImageHandleNonResidentNV),
+        CH_GL_FUNCTION(glUniformHandleui64NV),
+        CH_GL_FUNCTION(glUniformHandleui64vNV),
+        CH_GL_FUNCTION(glProgramUniformHandleui64NV),
+        CH_GL_FUNCTION(glProgramUniformHandleui64vNV),
+        CH_GL_FUNCTION(glIsTextureHandleResidentNV),
+        CH_GL_FUNCTION(glIsImageHandleResidentNV),
+        // GL_NV_blend_equation_advanced
+        CH_GL_FUNCTION(glBlendParameteriNV),
+        CH_GL_FUNCTION(glBlendBarrierNV),
+        // GL_NV_conditional_render
+        CH_GL_FUNCTION(glBeginConditionalRenderNV),
+        CH_GL_FUNCTION(glEndConditionalRenderNV),
+        // GL_NV_conservative_raster
+        CH_GL_FUNCTION(glSubpixelPrecisionBiasNV),
+        // GL_NV_conservative_raster_pre_snap_triangles
+        CH_GL_FUNCTION(glConservativeRasterParameteriNV),
+        // GL_NV_draw_vulkan_image
+        CH_GL_FUNCTION(glDrawVkImageNV),
+        CH_GL_FUNCTION(glGetVkProcAddrNV),
+        CH_GL_FUNCTION(glWaitVkSemaphoreNV),
+        CH_GL_FUNCTION(glSignalVkSemaphoreNV),
+        CH_GL_FUNCTION(glSignalVkFenceNV),
+        // GL_NV_fragment_coverage_to_color
+        CH_GL_FUNCTION(glFragmentCoverageColorNV),
+        // GL_NV_framebuffer_mixed_samples
+        CH_GL_FUNCTION(glCoverageModulationTableNV),
+        CH_GL_FUNCTION(glGetCoverageModulationTableNV),
+        CH_GL_FUNCTION(glCoverageModulationNV),
+        // GL_NV_gpu_shader5
+        CH_GL_FUNCTION(glUniform1i64NV),
+        CH_GL_FUNCTION(glUniform2i64NV),
+        CH_GL_FUNCTION(glUniform3i64NV),
+        CH_GL_FUNCTION(glUniform4i64NV),
+        CH_GL_FUNCTION(glUniform1i64vNV),
+        CH_GL_FUNCTION(glUniform2i64vNV),
+        CH_GL_FUNCTION(glUniform3i64vNV),
+        CH_GL_FUNCTION(glUniform4i64vNV),
+        CH_GL_FUNCTION(glUniform1ui64NV),
+        CH_GL_FUNCTION(glUniform2ui64NV),
+        CH_GL_FUNCTION(glUniform3ui64NV),
+        CH_GL_FUNCTION(glUniform4ui64NV),
+        CH_GL_FUNCTION(glUniform1ui64vNV),
+        CH_GL_FUNCTION(glUniform2ui64vNV),
+        CH_GL_FUNCTION(glUniform3ui64vNV),
+        CH_GL_FUNCTION(glUniform4ui64vNV),
+        CH_GL_FUNCTION(glGetUniformi64vNV),
+        CH_GL_FUNCTION(glProgramUniform1i64NV),
+        CH_GL_FUNCTION(glProgramUniform2i64NV),
+        CH_GL_FUNCTION(glProgramUniform3i64NV),
+        CH_GL_FUNCTION(glProgramUniform4i64NV),
+        CH_GL_FUNCTION(glProgramUniform1i64vNV),
+        CH_GL_FUNCTION(glProgramUniform2i64vNV),
+        CH_GL_FUNCTION(glProgramUniform3i64vNV),
+        CH_GL_FUNCTION(glProgramUniform4i64vNV),
+        CH_GL_FUNCTION(glProgramUniform1ui64NV),
+        CH_GL_FUNCTION(glProgramUniform2ui64NV),
+        CH_GL_FUNCTION(glProgramUniform3ui64NV),
+        CH_GL_FUNCTION(glProgramUniform4ui64NV),
+        CH_GL_FUNCTION(glProgramUniform1ui64vNV),
+        CH_GL_FUNCTION(glProgramUniform2ui64vNV),
+        CH_GL_FUNCTION(glProgramUniform3ui64vNV),
+        CH_GL_FUNCTION(glProgramUniform4ui64vNV),
+        // GL_NV_internalformat_sample_query
+        CH_GL_FUNCTION(glGetInternalformatSampleivNV),
+        // GL_NV_path_rendering
+        CH_GL_FUNCTION(glGenPathsNV),
+        CH_GL_FUNCTION(glDeletePathsNV),
+        CH_GL_FUNCTION(glIsPathNV),
+        CH_GL_FUNCTION(glPathCommandsNV),
+        CH_GL_FUNCTION(glPathCoordsNV),
+        CH_GL_FUNCTION(glPathSubCommandsNV),
+        CH_GL_FUNCTION(glPathSubCoordsNV),
+        CH_GL_FUNCTION(glPathStringNV),
+        CH_GL_FUNCTION(glPathGlyphsNV),
+        CH_GL_FUNCTION(glPathGlyphRangeNV),
+        CH_GL_FUNCTION(glWeightPathsNV),
+        CH_GL_FUNCTION(glCopyPathNV),
+        CH_GL_FUNCTION(glInterpolatePathsNV),
+        CH_GL_FUNCTION(glTransformPathNV),
+        CH_GL_FUNCTION(glPathParameterivNV),
+        CH_GL_FUNCTION(glPathParameteriNV),
+        CH_GL_FUNCTION(glPathParameterfvNV),
+        CH_GL_FUNCTION(glPathParameterfNV),
+        CH_GL_FUNCTION(glPathDashArrayNV),
+        CH_GL_FUNCTION(glPathStencilFuncNV),
+        CH_GL_FUNCTION(glPathStencilDepthOffsetNV),
+        CH_GL_FUNCTION(glStencilFillPathNV),
+        CH_GL_FUNCTION(glStencilStrokePathNV),
+        CH_GL_FUNCTION(glStencilFillPathInstancedNV),
+        CH_GL_FUNCTION(glStencilStrokePathInstancedNV),
+        CH_GL_FUNCTION(glPathCoverDepthFuncNV),
+        CH_GL_FUNCTION(glCoverFillPathNV),
+        CH_GL_FUNCTION(glCoverStrokePathNV),
+        CH_GL_FUNCTION(glCoverFillPathInstancedNV),
+        CH_GL_FUNCTION(glCoverStrokePathInstancedNV),
+        CH_GL_FUNCTION(glGetPathParameterivNV),
+        CH_GL_FUNCTION(glGetPathParameterfvNV),
+        CH_GL_FUNCTION(glGetPathCommandsNV),
+        CH_GL_FUNCTION(glGetPathCoordsNV),
+        CH_GL_FUNCTION(glGetPathDashArrayNV),
+        CH_GL_FUNCTION(glGetPathMetricsNV),
+        CH_GL_FUNCTION(glGetPathMetricRangeNV),
+        CH_GL_FUNCTION(glGetPathSpacingNV),
+        CH_GL_FUNCTION(glIsPointInFillPathNV),
+        CH_GL_FUNCTION(glIsPointInStrokePathNV),
+        CH_GL_FUNCTION(glGetPathLengthNV),
+        CH_GL_FUNCTION(glPointAlongPathNV),
+        CH_GL_FUNCTION(glMatrixLoad3x2fNV),
+        CH_GL_FUNCTION(glMatrixLoad3x3fNV),
+        CH_GL_FUNCTION(glMatrixLoadTranspose3x3fNV),
+        CH_GL_FUNCTION(glMatrixMult3x2fNV),
+        CH_GL_FUNCTION(glMatrixMult3x3fNV),
+        CH_GL_FUNCTION(glMatrixMultTranspose3x3fNV),
+        CH_GL_FUNCTION(glStencilThenCoverFillPathNV),
+        CH_GL_FUNCTION(glStencilThenCoverStrokePathNV),
+        CH_GL_FUNCTION(glStencilThenCoverFillPathInstancedNV),
+        CH_GL_FUNCTION(glStencilThenCoverStrokePathInstancedNV),
+        CH_GL_FUNCTION(glPathGlyphIndexRangeNV),
+        CH_GL_FUNCTION(glPathGlyphIndexArrayNV),
+        CH_GL_FUNCTION(glPathMemoryGlyphIndexArrayNV),
+        CH_GL_FUNCTION(glProgramPathFragmentInputGenNV),
+        CH_GL_FUNCTION(glGetProgramResourcefvNV),
+        // GL_NV_sample_locations
+        CH_GL_FUNCTION(glFramebufferSampleLocationsfvNV),
+        CH_GL_FUNCTION(glNamedFramebufferSampleLocationsfvNV),
+        CH_GL_FUNCTION(glResolveDepthValuesNV),
+        // GL_NV_viewport_swizzle
+        CH_GL_FUNCTION(glViewportSwizzleNV),
+        // GL_OVR_multiview
+        CH_GL_FUNCTION(glFramebufferTextureMultiviewOVR),
+    };
+    
+    static const gl_function_group GL_FUNCTION_GROUPS[] =
+    {
+        {"GL_VERSION_1_0", 1, 0, 0, 48},
+        {"GL_VERSION_1_1", 1, 1, 48, 14},
+        {"GL_VERSION_1_2", 1, 2, 62, 4},
+        {"GL_VERSION_1_3", 1, 3, 66, 9},
+        {"GL_VERSION_1_4", 1, 4, 75, 9},
+        {"GL_VERSION_1_5", 1, 5, 84, 19},
+        {"GL_VERSION_2_0", 2, 0, 103, 93},
+        {"GL_VERSION_2_1", 2, 1, 196, 6},
+        {"GL_VERSION_3_0", 3, 0, 202, 84},
+        {"GL_VERSION_3_1", 3, 1, 286, 12},
+        {"GL_VERSION_3_2", 3, 2, 298, 19},
+        {"GL_VERSION_3_3", 3, 3, 317, 28},
+        {"GL_VERSION_4_0", 4, 0, 345, 46},
+        {"GL_VERSION_4_1", 4, 1, 391, 88},
+        {"GL_VERSION_4_2", 4, 2, 479, 12},
+        {"GL_VERSION_4_3", 4, 3, 491, 43},
+        {"GL_VERSION_4_4", 4, 4, 534, 9},
+        {"GL_VERSION_4_5", 4, 5, 543, 110},
+        {"GL_ARB_bindless_texture", 0, 0, 653, 16},
+        {"GL_ARB_cl_event", 0, 0, 669, 1},
+        {"GL_ARB_compute_variable_group_size", 0, 0, 670, 1},
+        {"GL_ARB_debug_output", 0, 0, 671, 4},
+        {"GL_ARB_draw_buffers_blend", 0, 0, 675, 4},
+        {"GL_ARB_indirect_parameters", 0, 0, 679, 2},
+        {"GL_ARB_robustness", 0, 0, 681, 8},
+        {"GL_ARB_sample_shading", 0, 0, 689, 1},
+        {"GL_ARB_shading_language_include", 0, 0, 690, 6},
+        {"GL_ARB_sparse_buffer", 0, 0, 696, 3},
+        {"GL_ARB_sparse_texture", 0, 0, 699, 1},
+        {"GL_KHR_blend_equation_advanced", 0, 0, 700, 1},
+        {"GL_AMD_performance_monitor", 0, 0, 701, 11},
+        {"GL_EXT_debug_label", 0, 0, 712, 2},
+        {"GL_EXT_debug_marker", 0, 0, 714, 3},
+        {"GL_EXT_direct_state_access", 0, 0, 717, 255},
+        {"GL_EXT_draw_instanced", 0, 0, 972, 2},
+        {"GL_EXT_polygon_offset_clamp", 0, 0, 974, 1},
+        {"GL_EXT_raster_multisample", 0, 0, 975, 1},
+        {"GL_EXT_separate_shader_objects", 0, 0, 976, 3},
+        {"GL_EXT_window_rectangles", 0, 0, 979, 1},
+        {"GL_INTEL_framebuffer_CMAA", 0, 0, 980, 1},
+        {"GL_INTEL_performance_query", 0, 0, 981, 10},
+        {"GL_NV_bindless_texture", 0, 0, 991, 13},
+        {"GL_NV_blend_equation_advanced", 0, 0, 1004, 2},
+        {"GL_NV_conditional_render", 0, 0, 1006, 2},
+        {"GL_NV_conservative_raster", 0, 0, 1008, 1},
+        {"GL_NV_conservative_raster_pre_snap_triangles", 0, 0, 1009, 1},
+        {"GL_NV_draw_vulkan_image", 0, 0, 1010, 5},
+        {"GL_NV_fragment_coverage_to_color", 0, 0, 1015, 1},
+        {"GL_NV_framebuffer_mixed_samples", 0, 0, 1016, 3},
+        {"GL_NV_gpu_shader5", 0, 0, 1019, 33},
+        {"GL_NV_internalformat_sample_query", 0, 0, 1052, 1},
+        {"GL_NV_path_rendering", 0, 0, 1053, 57},
+        {"GL_NV_sample_locations", 0, 0, 1110, 3},
+        {"GL_NV_viewport_swizzle", 0, 0, 1113, 1},
+        {"GL_OVR_multiview", 0, 0, 1114, 1},
+    };
+    
+#undef CH_GL_FUNCTION
+    
+    const int GL_FUNCTION_COUNT = int(sizeof(GL_FUNCTION_ENTRIES) / sizeof(GL_FUNCTION_ENTRIES[0]));
+    const int GL_FUNCTION_GROUP_COUNT = int(sizeof(GL_FUNCTION_GROUPS) / sizeof(GL_FUNCTION_GROUPS[0]));
+    
+    inline const gl_function_group *
+        FindGLFunctionGroup(const char *Name)
+    {
+        for (int GroupI = 0; GroupI < GL_FUNCTION_GROUP_COUNT; ++GroupI)
+        {
+            if (strcmp(GL_FUNCTION_GROUPS[GroupI].Name, Name) == 0) return &GL_FUNCTION_GROUPS[GroupI];
+        }
+        return 0;
+    }
+    
+    //
+    //
+    // lazy state
+    
+    enum gl_function_state
+    {
+        GL_FUNCTION_UNRESOLVED,
+        GL_FUNCTION_RESOLVED,
+        GL_FUNCTION_MISSING, // the driver has none, the trampoline stays
+    };
+    
+    const u32 GL_TRAMPOLINE_SLOT_COUNT = 4096; // a power of 2, at most about a quarter full
+    
+    struct gl_lazy_loader
+    {
+        load_function *LoadFunction;
+        bool Hashed; // TrampolineSlots is filled, it never changes after that
+        u8 States[GL_FUNCTION_COUNT];
+        u16 TrampolineSlots[GL_TRAMPOLINE_SLOT_COUNT]; // entry index + 1 by trampoline address, 0 is empty
+        u64 MissingCalls;                              // calls through trampolines of missing entry points
+    };
+    
+    inline gl_lazy_loader *
+        GetGLLazyLoader()
+    {
+        static gl_lazy_loader Loader;
+        return &Loader;
+    }
+    
+    inline u32
+        GetGLTrampolineSlot(const void *Trampoline)
+    {
+        u64 Address = u64(uintptr_t(Trampoline));
+        return u32((Address >> 4) * 0x9E3779B97F4A7C15ull >> 40) & (GL_TRAMPOLINE_SLOT_COUNT - 1);
+    }
+    
+    // the entry whose trampoline Function is, -1 for anything else
+    inline int
+        FindGLTrampoline(const void *Function)
+    {
+        if (!Function) return -1;
+        const gl_lazy_loader *Loader = GetGLLazyLoader();
+        for (u32 Slot = GetGLTrampolineSlot(Function); Loader->TrampolineSlots[Slot]; Slot = (Slot + 1) & (GL_TRAMPOLINE_SLOT_COUNT - 1))
+        {
+            int Index = Loader->TrampolineSlots[Slot] - 1;
+            if (GL_FUNCTION_ENTRIES[Index].Trampoline == Function) return Index;
+        }
+        return -1;
+    }
+    
+    // looks entry Index up the first time, the driver's function or 0 if it has none
+    inline void *
+        ResolveGLFunction(int Index)
+    {
+        gl_lazy_loader *Loader = GetGLLazyLoader();
+        const gl_function_entry *Entry = &GL_FUNCTION_ENTRIES[Index];
+        if (Loader->States[Index] == GL_FUNCTION_UNRESOLVED)
+        {
+            assert(Loader->LoadFunction);
+            void *Function = Loader->LoadFunction((char *)Entry->Name);
+            if (Function)
+            {
+                *Entry->Pointer = Function;
+                Loader->States[Index] = GL_FUNCTION_RESOLVED;
+            }
+            else
+            {
+                Loader->States[Index] = GL_FUNCTION_MISSING;
+                fprintf(stderr, "ch_gl_load: the driver has no %s, calls to it do nothing\n", Entry->Name);
+            }
+        }
+        return Loader->States[Index] == GL_FUNCTION_RESOLVED? *Entry->Pointer: 0;
+    }
+    
+    inline void
+        CountMissingGLCall()
+    {
+        ++GetGLLazyLoader()->MissingCalls;
+    }
+    
+    //
+    //
+    // loading
+    
+    struct gl_load_result
+    {
+        u32 LoadedCount;  // looked up and found
+        u32 MissingCount; // looked up, the driver returned 0
+        u32 SkippedCount; // not asked for, set to 0
+        u32 UnknownCount; // extension names with no entry points in the table
+    };
+    
+    inline void
+        LoadGLFunctionRange(load_function *LoadFunction, int First, int Count, gl_load_result *Result)
+    {
+        for (int FunctionI = First; FunctionI < First + Count; ++FunctionI)
+        {
+            const gl_function_entry *Entry = &GL_FUNCTION_ENTRIES[FunctionI];
+            *Entry->Pointer = LoadFunction((char *)Entry->Name);
+            if (*Entry->Pointer) ++Result->LoadedCount;
+            else ++Result->MissingCount;
+        }
+    }
+    
+    // core Major.Minor and everything before it, plus the named extensions ("GL_ARB_bindless_texture")
+    inline gl_load_result
+        LoadGLFunctionsMinimal(load_function *LoadFunction, int Major, int Minor,
+                               const char **Extensions = 0, int ExtensionCount = 0)
+    {
+        gl_load_result Result = {};
+        for (int FunctionI = 0; FunctionI < GL_FUNCTION_COUNT; ++FunctionI)
+        {
+            *GL_FUNCTION_ENTRIES[FunctionI].Pointer = 0;
+        }
+        
+        int Version = 10 * Major + Minor;
+        for (int GroupI = 0; GroupI < GL_FUNCTION_GROUP_COUNT; ++GroupI)
+        {
+            const gl_function_group *Group = &GL_FUNCTION_GROUPS[GroupI];
+            if (Group->Major && 10 * Group->Major + Group->Minor <= Version)
+            {
+                LoadGLFunctionRange(LoadFunction, Group->First, Group->Count, &Result);
+            }
+        }
+        for (int ExtensionI = 0; ExtensionI < ExtensionCount; ++ExtensionI)
+        {
+            const gl_function_group *Group = FindGLFunctionGroup(Extensions[ExtensionI]);
+            if (!Group || Group->Major)
+            {
+                ++Result.UnknownCount;
+                continue;
+            }
+            LoadGLFunctionRange(LoadFunction, Group->First, Group->Count, &Result);
+        }
+        Result.SkippedCount = u32(GL_FUNCTION_COUNT) - Result.LoadedCount - Result.MissingCount;
+        return Result;
+    }
+    
+    // LoadFunction has to stay valid, it's called on first use
+    inline void
+        LoadGLFunctionsLazy(load_function *LoadFunction)
+    {
+        gl_lazy_loader *Loader = GetGLLazyLoader();
+        Loader->LoadFunction = LoadFunction;
+        memset(Loader->States, GL_FUNCTION_UNRESOLVED, sizeof(Loader->States));
+        if (!Loader->Hashed)
+        {
+            for (int FunctionI = 0; FunctionI < GL_FUNCTION_COUNT; ++FunctionI)
+            {
+                u32 Slot = GetGLTrampolineSlot(GL_FUNCTION_ENTRIES[FunctionI].Trampoline);
+                while (Loader->TrampolineSlots[Slot]) Slot = (Slot + 1) & (GL_TRAMPOLINE_SLOT_COUNT - 1);
+                Loader->TrampolineSlots[Slot] = u16(FunctionI + 1);
+            }
+            Loader->Hashed = true;
+        }
+        for (int FunctionI = 0; FunctionI < GL_FUNCTION_COUNT; ++FunctionI)
+        {
+            const gl_function_entry *Entry = &GL_FUNCTION_ENTRIES[FunctionI];
+            *Entry->Pointer = Entry->Trampoline;
+        }
+    }
+    
+    // still a trampoline: never called since LoadGLFunctionsLazy, or the driver doesn't have it
+    inline bool
+        IsGLFunctionResolved(const void *Function)
+    {
+        return Function && FindGLTrampoline(Function) < 0;
+    }
+    
+    // Function is a gl* pointer, cast to void *. Looks a trampoline up now
+    inline bool
+        IsGLFunctionAvailable(const void *Function)
+    {
+        int Index = FindGLTrampoline(Function);
+        if (Index < 0) return Function != 0;
+        return ResolveGLFunction(Index) != 0;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,381 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// one vertex and index buffer for every mesh, sized up front
+ch::gl_mesh_registry Registry = ch::CreateGLMeshRegistry(1 << 20, 4 << 20);
+ch_obj::Mesh Welded = ch_obj::weld_model(&Model);
+int Bunny = ch::AddGLMesh(&Registry, &Welded); // -1 when it doesn't fit
+ch_obj::free_mesh(&Welded);                    // the registry has its own copy
+
+// a draw list, rebuilt every frame
+ch::gl_mesh_draws Draws = ch::CreateGLMeshDraws(4096);
+ch::ResetGLMeshDraws(&Draws);
+for (int I = 0; I < InstanceCount; ++I)
+{
+    // BaseInstance reaches the shader as gl_BaseInstance (or through an instanced attribute)
+    ch::PushGLMeshDraw(&Draws, &Registry, Bunny, I, &Transforms[I].Data[0][0]); // row major
+}
+
+f32 Planes[6][4];
+ch::GetGLFrustumPlanes(Planes, &ViewProjection.Data[0][0]);
+ch::CullGLMeshDraws(&Draws, Planes); // optional, drops what's outside
+
+ch::SubmitGLMeshDraws(&Registry, &Draws); // one glMultiDrawElementsIndirect
+
+ch::DestroyGLMeshDraws(&Draws);
+ch::DestroyGLMeshRegistry(&Registry);
+
+Registry:
+
+Vertices of every mesh are interleaved position and normal (attributes 0 and 1,
+3 floats each) in one buffer, indices are 32 bit in another, both immutable
+(glBufferStorage, GL 4.4) and written with glBufferSubData as meshes are added.
+A mesh is a range of each, its indices are kept as they are and BaseVertex
+moves them to its vertices. One VAO covers everything. Meshes are never removed,
+a registry is for what's loaded for the level. A bounding sphere of each mesh
+is kept for culling.
+
+Draws:
+
+A draw is a DrawElementsIndirectCommand for a mesh plus its world bounding
+sphere (the mesh sphere through the transform, radius scaled by the largest
+axis scale). CullGLMeshDraws tests the spheres against the frustum and compacts
+the commands that survive to the front, in order. Submitting copies what's in
+the list into the next region of its indirect ring (ch_gl_ring.h, persistently
+mapped, no glBufferData) and draws it from there with a single
+glMultiDrawElementsIndirect (GL 4.3), whatever the number of meshes. A region
+holds the list's capacity and is fenced after the draw, so a list submitted once
+a frame only waits if the GPU is CH_GL_RING_FRAMES frames behind.
+*/
+
+#include "ch_gl_ring.h"
+#include "ch_gl_state.h"
+#include "ch_obj.h"
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace ch
+{
+    //
+    //
+    // registry
+    
+    // the layout glMultiDrawElementsIndirect reads
+    struct gl_draw_elements_indirect_command
+    {
+        u32 Count;
+        u32 InstanceCount;
+        u32 FirstIndex;
+        i32 BaseVertex;
+        u32 BaseInstance;
+    };
+    
+    struct gl_mesh_vertex
+    {
+        f32 Position[3];
+        f32 Normal[3];
+    };
+    
+    struct gl_mesh_range
+    {
+        u32 FirstIndex;
+        u32 IndexCount;
+        i32 BaseVertex;
+        u32 VertexCount;
+        f32 Center[3]; // bounding sphere, mesh space
+        f32 Radius;
+    };
+    
+    struct gl_mesh_registry
+    {
+        GLuint VertexArray;
+        GLuint VertexBuffer;
+        GLuint IndexBuffer;
+        u32 VertexCapacity;
+        u32 IndexCapacity;
+        u32 VertexCount;
+        u32 IndexCount;
+        
+        gl_mesh_range *Meshes;
+        int MeshCount;
+        int MeshCapacity;
+        
+        u64 FailedCount; // meshes that didn't fit
+    };
+    
+    inline gl_mesh_registry
+        CreateGLMeshRegistry(u32 MaxVertices, u32 MaxIndices)
+    {
+        gl_mesh_registry Registry = {};
+        Registry.VertexCapacity = MaxVertices;
+        Registry.IndexCapacity = MaxIndices;
+        
+        glGenVertexArrays(1, &Registry.VertexArray);
+        glGenBuffers(1, &Registry.VertexBuffer);
+        glGenBuffers(1, &Registry.IndexBuffer);
+        SetGLVertexArray(Registry.VertexArray);
+        SetGLBuffer(GL_ARRAY_BUFFER, Registry.VertexBuffer);
+        glBufferStorage(GL_ARRAY_BUFFER, GLsizeiptr(MaxVertices) * sizeof(gl_mesh_vertex), 0, GL_DYNAMIC_STORAGE_BIT);
+        SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, Registry.IndexBuffer);
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(MaxIndices) * sizeof(u32), 0, GL_DYNAMIC_STORAGE_BIT);
+        
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(gl_mesh_vertex), (void *)offsetof(gl_mesh_vertex, Position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(gl_mesh_vertex), (void *)offsetof(gl_mesh_vertex, Normal));
+        SetGLVertexArray(0);
+        return Registry;
+    }
+    
+    inline void
+        DestroyGLMeshRegistry(gl_mesh_registry *Registry)
+    {
+        DeleteGLVertexArrays(1, &Registry->VertexArray);
+        DeleteGLBuffers(1, &Registry->VertexBuffer);
+        DeleteGLBuffers(1, &Registry->IndexBuffer);
+        free(Registry->Meshes);
+        *Registry = {};
+    }
+    
+    // Positions and Normals are 3 floats a vertex (Normals can be 0), returns the mesh or -1 when full
+    inline int
+        AddGLMeshData(gl_mesh_registry *Registry, const f32 *Positions, const f32 *Normals, u32 VertexCount,
+                      const u32 *Indices, u32 IndexCount)
+    {
+        if (VertexCount > Registry->VertexCapacity - Registry->VertexCount ||
+            IndexCount > Registry->IndexCapacity - Registry->IndexCount)
+        {
+            ++Registry->FailedCount;
+            return -1;
+        }
+        if (Registry->MeshCount == Registry->MeshCapacity)
+        {
+            Registry->MeshCapacity = Registry->MeshCapacity? 2 * Registry->MeshCapacity: 64;
+            Registry->Meshes = (gl_mesh_range *)realloc(Registry->Meshes, Registry->MeshCapacity * sizeof(gl_mesh_range));
+        }
+        
+        gl_mesh_range *Mesh = &Registry->Meshes[Registry->MeshCount];
+        Mesh->FirstIndex = Registry->IndexCount;
+        Mesh->IndexCount = IndexCount;
+        Mesh->BaseVertex = i32(Registry->VertexCount);
+        Mesh->VertexCount = VertexCount;
+        
+        // sphere around the box center
+        f32 Min[3] = {0.0f, 0.0f, 0.0f};
+        f32 Max[3] = {0.0f, 0.0f, 0.0f};
+        for (u32 VertexI = 0; VertexI < VertexCount; ++VertexI)
+        {
+            for (int Axis = 0; Axis < 3; ++Axis)
+            {
+                f32 Value = Positions[3 * VertexI + Axis];
+                if (VertexI == 0 || Value < Min[Axis]) Min[Axis] = Value;
+                if (VertexI == 0 || Value > Max[Axis]) Max[Axis] = Value;
+            }
+        }
+        f32 RadiusSquared = 0.0f;
+        for (int Axis = 0; Axis < 3; ++Axis) Mesh->Center[Axis] = 0.5f * (Min[Axis] + Max[Axis]);
+        for (u32 VertexI = 0; VertexI < VertexCount; ++VertexI)
+        {
+            f32 X = Positions[3 * VertexI + 0] - Mesh->Center[0];
+            f32 Y = Positions[3 * VertexI + 1] - Mesh->Center[1];
+            f32 Z = Positions[3 * VertexI + 2] - Mesh->Center[2];
+            f32 DistanceSquared = X * X + Y * Y + Z * Z;
+            if (DistanceSquared > RadiusSquared) RadiusSquared = DistanceSquared;
+        }
+        Mesh->Radius = sqrtf(RadiusSquared);
+        
+        gl_mesh_vertex *Vertices = (gl_mesh_vertex *)malloc(VertexCount * sizeof(gl_mesh_vertex));
+        for (u32 VertexI = 0; VertexI < VertexCount; ++VertexI)
+        {
+            memcpy(Vertices[VertexI].Position, Positions + 3 * VertexI, sizeof(Vertices[VertexI].Position));
+            if (Normals) memcpy(Vertices[VertexI].Normal, Normals + 3 * VertexI, sizeof(Vertices[VertexI].Normal));
+            else memset(Vertices[VertexI].Normal, 0, sizeof(Vertices[VertexI].Normal));
+        }
+        
+        // through a target no VAO holds
+        SetGLBuffer(GL_COPY_WRITE_BUFFER, Registry->VertexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(Registry->VertexCount) * sizeof(gl_mesh_vertex),
+                        GLsizeiptr(VertexCount) * sizeof(gl_mesh_vertex), Vertices);
+        SetGLBuffer(GL_COPY_WRITE_BUFFER, Registry->IndexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(Registry->IndexCount) * sizeof(u32),
+                        GLsizeiptr(IndexCount) * sizeof(u32), Indices);
+        free(Vertices);
+        
+        Registry->VertexCount += VertexCount;
+        Registry->IndexCount += IndexCount;
+        return Registry->MeshCount++;
+    }
+    
+    // a welded ch_obj mesh
+    inline int
+        AddGLMesh(gl_mesh_registry *Registry, const ch_obj::Mesh *Mesh)
+    {
+        return AddGLMeshData(Registry, Mesh->vb, Mesh->nb, u32(Mesh->vertex_count), Mesh->ib, u32(Mesh->ib_count));
+    }
+    
+    //
+    //
+    // draws
+    
+    struct gl_mesh_draws
+    {
+        gl_draw_elements_indirect_command *Commands;
+        f32 (*Spheres)[4]; // world center and radius, per command
+        u32 Count;
+        u32 Capacity;
+        gl_frame_ring Indirect; // a region of Capacity commands per submit
+        
+        u32 CulledCount;  // by the last cull
+        u64 DroppedCount; // pushes past Capacity
+    };
+    
+    inline gl_mesh_draws
+        CreateGLMeshDraws(u32 Capacity)
+    {
+        gl_mesh_draws Draws = {};
+        Draws.Capacity = Capacity;
+        Draws.Commands = (gl_draw_elements_indirect_command *)malloc(Capacity * sizeof(gl_draw_elements_indirect_command));
+        Draws.Spheres = (f32 (*)[4])malloc(Capacity * sizeof(f32[4]));
+        u32 RegionSize = Capacity * u32(sizeof(gl_draw_elements_indirect_command));
+        Draws.Indirect = CreateFrameRing(GL_DRAW_INDIRECT_BUFFER, CH_GL_RING_FRAMES * RegionSize, sizeof(u32));
+        return Draws;
+    }
+    
+    inline void
+        DestroyGLMeshDraws(gl_mesh_draws *Draws)
+    {
+        DestroyFrameRing(&Draws->Indirect);
+        free(Draws->Commands);
+        free(Draws->Spheres);
+        *Draws = {};
+    }
+    
+    inline void
+        ResetGLMeshDraws(gl_mesh_draws *Draws)
+    {
+        Draws->Count = 0;
+        Draws->CulledCount = 0;
+    }
+    
+    // Transform is a row major 4x4 (0 for identity), InstanceCount > 1 draws instances BaseInstance onwards
+    inline void
+        PushGLMeshDraw(gl_mesh_draws *Draws, const gl_mesh_registry *Registry, int MeshIndex, u32 BaseInstance,
+                       const f32 *Transform = 0, u32 InstanceCount = 1)
+    {
+        assert(MeshIndex >= 0 && MeshIndex < Registry->MeshCount);
+        if (Draws->Count == Draws->Capacity)
+        {
+            ++Draws->DroppedCount;
+            return;
+        }
+        const gl_mesh_range *Mesh = &Registry->Meshes[MeshIndex];
+        gl_draw_elements_indirect_command *Command = &Draws->Commands[Draws->Count];
+        Command->Count = Mesh->IndexCount;
+        Command->InstanceCount = InstanceCount;
+        Command->FirstIndex = Mesh->FirstIndex;
+        Command->BaseVertex = Mesh->BaseVertex;
+        Command->BaseInstance = BaseInstance;
+        
+        f32 *Sphere = Draws->Spheres[Draws->Count];
+        if (Transform)
+        {
+            const f32 *C = Mesh->Center;
+            f32 MaxScaleSquared = 0.0f;
+            for (int Row = 0; Row < 3; ++Row)
+            {
+                const f32 *M = Transform + 4 * Row;
+                Sphere[Row] = M[0] * C[0] + M[1] * C[1] + M[2] * C[2] + M[3];
+                
+                // columns are the transformed axes
+                f32 Column[3] = {Transform[Row], Transform[4 + Row], Transform[8 + Row]};
+                f32 ScaleSquared = Column[0] * Column[0] + Column[1] * Column[1] + Column[2] * Column[2];
+                if (ScaleSquared > MaxScaleSquared) MaxScaleSquared = ScaleSquared;
+            }
+            Sphere[3] = Mesh->Radius * sqrtf(MaxScaleSquared);
+        }
+        else
+        {
+            memcpy(Sphere, Mesh->Center, 3 * sizeof(f32));
+            Sphere[3] = Mesh->Radius;
+        }
+        ++Draws->Count;
+    }
+    
+    // planes of a row major view projection (GL clip space), pointing in and normalized
+    inline void
+        GetGLFrustumPlanes(f32 Planes[6][4], const f32 *ViewProjection)
+    {
+        const f32 *W = ViewProjection + 12;
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            const f32 *Row = ViewProjection + 4 * Axis;
+            for (int I = 0; I < 4; ++I)
+            {
+                Planes[2 * Axis + 0][I] = W[I] + Row[I];
+                Planes[2 * Axis + 1][I] = W[I] - Row[I];
+            }
+        }
+        for (int PlaneI = 0; PlaneI < 6; ++PlaneI)
+        {
+            f32 *P = Planes[PlaneI];
+            f32 Length = sqrtf(P[0] * P[0] + P[1] * P[1] + P[2] * P[2]);
+            if (Length > 0.0f)
+            {
+                for (int I = 0; I < 4; ++I) P[I] /= Length;
+            }
+        }
+    }
+    
+    // keeps the draws whose sphere touches the frustum, in order, returns how many
+    inline u32
+        CullGLMeshDraws(gl_mesh_draws *Draws, const f32 Planes[6][4])
+    {
+        u32 Kept = 0;
+        for (u32 DrawI = 0; DrawI < Draws->Count; ++DrawI)
+        {
+            const f32 *S = Draws->Spheres[DrawI];
+            bool Inside = true;
+            for (int PlaneI = 0; PlaneI < 6 && Inside; ++PlaneI)
+            {
+                const f32 *P = Planes[PlaneI];
+                Inside = P[0] * S[0] + P[1] * S[1] + P[2] * S[2] + P[3] >= -S[3];
+            }
+            if (!Inside) continue;
+            if (Kept != DrawI)
+            {
+                Draws->Commands[Kept] = Draws->Commands[DrawI];
+                memcpy(Draws->Spheres[Kept], S, sizeof(f32[4]));
+            }
+            ++Kept;
+        }
+        Draws->CulledCount += Draws->Count - Kept;
+        Draws->Count = Kept;
+        return Kept;
+    }
+    
+    // every draw in the list with one call, the program is whatever is bound
+    inline void
+        SubmitGLMeshDraws(const gl_mesh_registry *Registry, gl_mesh_draws *Draws, GLenum Mode = GL_TRIANGLES)
+    {
+        if (Draws->Count == 0) return;
+        gl_frame_ring *Ring = &Draws->Indirect;
+        BeginRingFrame(Ring);
+        u32 Size = Draws->Count * u32(sizeof(gl_draw_elements_indirect_command));
+        u32 Offset = 0;
+        bool Reserved = ReserveRing(Ring, Size, sizeof(u32), &Offset);
+        assert(Reserved); // never more than Capacity commands, what a region holds
+        if (!Reserved) return;
+        memcpy(Ring->Mapped + Offset, Draws->Commands, Size);
+        Ring->Head = Offset + Size;
+        
+        SetGLVertexArray(Registry->VertexArray);
+        SetGLBuffer(GL_DRAW_INDIRECT_BUFFER, Ring->Buffer);
+        glMultiDrawElementsIndirect(Mode, GL_UNSIGNED_INT, (const void *)size_t(Offset), GLsizei(Draws->Count), 0);
+        EndRingFrame(Ring);
+    }
+};
\ No newline at end of file
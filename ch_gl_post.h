@@ -0,0 +1,199 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// post-process shaders pair their fragment shader with this vertex shader,
+// which hands them TexCoord
+ch::gl_program_desc Bloom = {};
+Bloom.Stages[0] = {GL_VERTEX_SHADER, CH_GL_FULLSCREEN_VERTEX_SHADER};
+Bloom.Stages[1] = {GL_FRAGMENT_SHADER, BloomFS}; // samples unit 0 at TexCoord
+Bloom.StageCount = 2;
+
+ch::gl_post_chain Chain = ch::CreateGLPostChain(Width, Height); // GL_RGBA16F
+...
+ch::ResizeGLPostChain(&Chain, NewWidth, NewHeight); // on resize, keeps its framebuffers
+
+// every frame
+ch::ApplyGLPostPass(&Chain, ToneMapProgram, SceneTexture); // the first pass reads the scene
+ch::ApplyGLPostPass(&Chain, BloomProgram);                  // the others read the pass before
+ch::ApplyGLPostPass(&Chain, FXAAProgram, 0, 0);             // the last one to the window
+
+// or just the triangle, with any program and framebuffer
+ch::DrawGLFullscreenTriangle();
+
+Fullscreen triangle:
+
+One triangle with corners (-1, -1), (3, -1) and (-1, 3) covers the viewport,
+clipping cuts it to exactly the screen. Two triangles would shade the pixels
+along their shared diagonal twice (2x2 quads on both sides). The corners
+come from gl_VertexID, so the draw needs no vertex buffer, only a VAO
+without attributes (core profile). That VAO is created the first time it's
+needed and shared by every pass.
+
+Chain:
+
+Two color textures, each attached to its own framebuffer. A pass samples one
+on unit 0 and writes the other, then they swap. Resizing replaces the
+textures (immutable storage) and attaches them to the same framebuffers.
+Passes turn off depth test, blending and face culling and set the viewport,
+through ch_gl_state.h.
+*/
+
+#include "ch_gl_state.h"
+
+// TexCoord is 0 to 1 over the screen
+#define CH_GL_FULLSCREEN_VERTEX_SHADER \
+    "#version 330\n" \
+    "out vec2 TexCoord;\n" \
+    "void main()\n" \
+    "{\n" \
+    "    vec2 Position = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);\n" \
+    "    TexCoord = Position * 0.5 + 0.5;\n" \
+    "    gl_Position = vec4(Position, 0.0, 1.0);\n" \
+    "}\n"
+
+namespace ch
+{
+    //
+    //
+    // fullscreen triangle
+    
+    inline GLuint &
+        GetGLFullscreenVAOSlot()
+    {
+        static GLuint VertexArray = 0;
+        return VertexArray;
+    }
+    
+    // shared, created on first use. Don't delete it, ReleaseGLFullscreenVAO does
+    inline GLuint
+        GetGLFullscreenVAO()
+    {
+        GLuint &VertexArray = GetGLFullscreenVAOSlot();
+        if (!VertexArray)
+        {
+            glGenVertexArrays(1, &VertexArray);
+        }
+        return VertexArray;
+    }
+    
+    // with the context that made it, the next use makes a new one
+    inline void
+        ReleaseGLFullscreenVAO()
+    {
+        GLuint &VertexArray = GetGLFullscreenVAOSlot();
+        if (VertexArray)
+        {
+            DeleteGLVertexArrays(1, &VertexArray);
+            VertexArray = 0;
+        }
+    }
+    
+    // the program's vertex shader is CH_GL_FULLSCREEN_VERTEX_SHADER or does the same
+    inline void
+        DrawGLFullscreenTriangle()
+    {
+        SetGLVertexArray(GetGLFullscreenVAO());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    
+    //
+    //
+    // chain
+    
+    struct gl_post_chain
+    {
+        GLuint Framebuffers[2];
+        GLuint Textures[2];
+        GLenum Format;
+        GLsizei Width;
+        GLsizei Height;
+        int Current;     // the image the last pass wrote
+        int FailedCount; // incomplete framebuffers
+    };
+    
+    inline void
+        AllocateGLPostTextures(gl_post_chain *Chain)
+    {
+        glGenTextures(2, Chain->Textures);
+        for (int ImageI = 0; ImageI < 2; ++ImageI)
+        {
+            SetGLActiveTexture(GL_TEXTURE0);
+            SetGLTexture(GL_TEXTURE_2D, Chain->Textures[ImageI]);
+            glTexStorage2D(GL_TEXTURE_2D, 1, Chain->Format, Chain->Width, Chain->Height);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            
+            glBindFramebuffer(GL_FRAMEBUFFER, Chain->Framebuffers[ImageI]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Chain->Textures[ImageI], 0);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            {
+                ++Chain->FailedCount;
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    
+    inline gl_post_chain
+        CreateGLPostChain(GLsizei Width, GLsizei Height, GLenum Format = GL_RGBA16F)
+    {
+        gl_post_chain Chain = {};
+        Chain.Format = Format;
+        Chain.Width = Width;
+        Chain.Height = Height;
+        glGenFramebuffers(2, Chain.Framebuffers);
+        AllocateGLPostTextures(&Chain);
+        return Chain;
+    }
+    
+    // new textures, same framebuffers. Nothing happens if the size is the same
+    inline void
+        ResizeGLPostChain(gl_post_chain *Chain, GLsizei Width, GLsizei Height)
+    {
+        if (Chain->Width == Width && Chain->Height == Height) return;
+        DeleteGLTextures(2, Chain->Textures);
+        Chain->Width = Width;
+        Chain->Height = Height;
+        Chain->Current = 0;
+        AllocateGLPostTextures(Chain);
+    }
+    
+    inline void
+        DestroyGLPostChain(gl_post_chain *Chain)
+    {
+        glDeleteFramebuffers(2, Chain->Framebuffers);
+        DeleteGLTextures(2, Chain->Textures);
+        *Chain = {};
+    }
+    
+    // the last pass's output
+    inline GLuint
+        GetGLPostTexture(const gl_post_chain *Chain)
+    {
+        return Chain->Textures[Chain->Current];
+    }
+    
+    // Program over Source (the chain's last image when 0) into the chain's other image, which
+    // becomes its last. Framebuffer other than -1 draws there instead, at Width x Height
+    // (the chain's size when 0), and the chain doesn't move on
+    inline void
+        ApplyGLPostPass(gl_post_chain *Chain, GLuint Program, GLuint Source = 0,
+                        GLint Framebuffer = -1, GLsizei Width = 0, GLsizei Height = 0)
+    {
+        int Target = 1 - Chain->Current;
+        if (!Source) Source = Chain->Textures[Chain->Current];
+        glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer < 0? Chain->Framebuffers[Target]: GLuint(Framebuffer));
+        SetGLViewport(0, 0, Width? Width: Chain->Width, Height? Height: Chain->Height);
+        SetGLEnabled(GL_DEPTH_TEST, false);
+        SetGLEnabled(GL_BLEND, false);
+        SetGLEnabled(GL_CULL_FACE, false);
+        SetGLProgram(Program);
+        SetGLActiveTexture(GL_TEXTURE0);
+        SetGLTexture(GL_TEXTURE_2D, Source);
+        DrawGLFullscreenTriangle();
+        if (Framebuffer < 0) Chain->Current = Target;
+    }
+};
\ No newline at end of file
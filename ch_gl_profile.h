@@ -0,0 +1,275 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch::InitGLProfiler(); // after the context, the zones show up as the "gpu" track
+
+while (Running)
+{
+    ch::BeginGLProfileFrame(); // once per frame, reads back what the GPU has finished
+    {
+        CH_GL_ZONE("shadows"); // GPU time of everything issued in this scope
+        ...
+    }
+    {
+        CH_GL_ZONE("lighting");
+        ...
+    }
+    RenderImgui(ImGui::GetDrawData()); // has its own "imgui" zone
+    SwapBuffers(...);
+
+    ImGui::Text("gpu %.2f ms", ch::GetGLFrameMilliseconds()); // a few frames old
+}
+
+ch::SaveChromeTrace("trace.json"); // CPU and GPU zones side by side
+
+Queries:
+
+A GPU zone is two glQueryCounter(GL_TIMESTAMP) queries, one where it begins
+and one where it ends, on the timeline of the commands around them. Each of the
+CH_GL_PROFILE_FRAMES frames in flight has its own set of queries, so nothing is
+reused before the GPU is done with it. BeginGLProfileFrame reads back every
+frame whose last query is available, oldest first. Results are never waited
+for, a frame still not done when its queries come around again is dropped and
+counted in LateFrames. With the default of 4 that takes a GPU 3 frames behind.
+
+Trace:
+
+GPU timestamps are moved onto the GetTicks timeline (measured against
+GL_TIMESTAMP at init and every CH_GL_PROFILE_CALIBRATION_FRAMES frames) and
+pushed as zones to a track of ch_profile.h, so they are exported with the CPU
+zones by ExportChromeTrace. Every frame is a zone of its own, from one
+BeginGLProfileFrame to the next, and it ends the zones still open in it.
+Zones past CH_GL_PROFILE_FRAME_EVENTS queries in a frame are dropped whole.
+Zones are GL thread only and do nothing before InitGLProfiler. Build with
+CH_PROFILE=0 to compile CH_GL_ZONE out.
+*/
+
+#include "ch_gl.h"
+#include "ch_profile.h"
+
+#ifndef CH_GL_PROFILE_FRAMES
+#define CH_GL_PROFILE_FRAMES 4 // frames in flight, read back at most this many - 1 late
+#endif
+
+#ifndef CH_GL_PROFILE_FRAME_EVENTS
+#define CH_GL_PROFILE_FRAME_EVENTS 256 // queries per frame, 2 per zone
+#endif
+
+#ifndef CH_GL_PROFILE_CALIBRATION_FRAMES
+#define CH_GL_PROFILE_CALIBRATION_FRAMES 1024
+#endif
+
+#if CH_PROFILE
+#define CH_GL_ZONE(Name) ch::BeginGLZone(Name); defer(ch::EndGLZone())
+#else
+#define CH_GL_ZONE(Name)
+#endif
+
+namespace ch
+{
+    struct gl_profile_frame
+    {
+        GLuint Queries[CH_GL_PROFILE_FRAME_EVENTS];
+        const char *Names[CH_GL_PROFILE_FRAME_EVENTS]; // 0 ends the innermost open zone
+        u32 EventCount;
+        bool Pending; // ended, not read back yet
+    };
+    
+    struct gl_profiler
+    {
+        bool Initialized;
+        profile_track *Track;
+        gl_profile_frame Frames[CH_GL_PROFILE_FRAMES];
+        u32 FrameIndex;
+        u32 Depth;     // open zones in this frame, the frame's own included
+        u32 SkipDepth; // open zones that got dropped
+        u64 FrameCount;
+        
+        // GPU nanoseconds to GetTicks
+        i64 GPUBase;
+        u64 TicksBase;
+        f64 TicksPerNanosecond;
+        
+        f64 FrameMilliseconds; // of the last frame read back
+        u64 ReadFrames;
+        u64 LateFrames;        // not done in time, dropped instead of waited on
+        u64 DroppedZones;      // past CH_GL_PROFILE_FRAME_EVENTS
+    };
+    
+    inline gl_profiler *
+        GetGLProfiler()
+    {
+        static gl_profiler Profiler;
+        return &Profiler;
+    }
+    
+    inline void
+        CalibrateGLProfiler(gl_profiler *Profiler)
+    {
+        GLint64 GPUNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &GPUNow);
+        Profiler->TicksBase = GetTicks();
+        Profiler->GPUBase = GPUNow;
+        Profiler->TicksPerNanosecond = GetTicksPerSecond() * 1e-9;
+    }
+    
+    // needs the context. The track outlives a shutdown, a second init keeps using it
+    inline void
+        InitGLProfiler(const char *TrackName = "gpu")
+    {
+        gl_profiler *Profiler = GetGLProfiler();
+        if (Profiler->Initialized) return;
+        
+        profile_track *Track = Profiler->Track;
+        *Profiler = {};
+        Profiler->Track = Track? Track: CreateProfileTrack(TrackName);
+        for (int FrameI = 0; FrameI < CH_GL_PROFILE_FRAMES; ++FrameI)
+        {
+            glGenQueries(CH_GL_PROFILE_FRAME_EVENTS, Profiler->Frames[FrameI].Queries);
+        }
+        CalibrateGLProfiler(Profiler);
+        Profiler->Initialized = true;
+    }
+    
+    // frames not read back yet are lost
+    inline void
+        ShutdownGLProfiler()
+    {
+        gl_profiler *Profiler = GetGLProfiler();
+        if (!Profiler->Initialized) return;
+        for (int FrameI = 0; FrameI < CH_GL_PROFILE_FRAMES; ++FrameI)
+        {
+            glDeleteQueries(CH_GL_PROFILE_FRAME_EVENTS, Profiler->Frames[FrameI].Queries);
+            Profiler->Frames[FrameI].Pending = false;
+        }
+        Profiler->Depth = 0;
+        Profiler->SkipDepth = 0;
+        Profiler->Initialized = false;
+    }
+    
+    //
+    //
+    // zones
+    
+    inline void
+        PushGLProfileEvent(gl_profiler *Profiler, const char *Name)
+    {
+        gl_profile_frame *Frame = &Profiler->Frames[Profiler->FrameIndex];
+        glQueryCounter(Frame->Queries[Frame->EventCount], GL_TIMESTAMP);
+        Frame->Names[Frame->EventCount++] = Name;
+    }
+    
+    // GL thread only, Name must outlive the profiler (string literals)
+    inline void
+        BeginGLZone(const char *Name)
+    {
+        gl_profiler *Profiler = GetGLProfiler();
+        if (!Profiler->Depth) return; // not initialized or no frame yet
+        
+        // room for this begin and its end, and the ends of every open zone
+        gl_profile_frame *Frame = &Profiler->Frames[Profiler->FrameIndex];
+        if (Profiler->SkipDepth || Frame->EventCount + Profiler->Depth + 2 > CH_GL_PROFILE_FRAME_EVENTS)
+        {
+            ++Profiler->SkipDepth;
+            ++Profiler->DroppedZones;
+            return;
+        }
+        PushGLProfileEvent(Profiler, Name);
+        ++Profiler->Depth;
+    }
+    
+    inline void
+        EndGLZone()
+    {
+        gl_profiler *Profiler = GetGLProfiler();
+        if (Profiler->SkipDepth)
+        {
+            --Profiler->SkipDepth;
+            return;
+        }
+        if (Profiler->Depth < 2) return; // the frame's zone is BeginGLProfileFrame's to end
+        PushGLProfileEvent(Profiler, 0);
+        --Profiler->Depth;
+    }
+    
+    //
+    //
+    // frames
+    
+    // false if the GPU isn't done with it, it's not waited for
+    inline bool
+        ReadGLProfileFrame(gl_profiler *Profiler, gl_profile_frame *Frame)
+    {
+        GLint Available = GL_FALSE;
+        glGetQueryObjectiv(Frame->Queries[Frame->EventCount - 1], GL_QUERY_RESULT_AVAILABLE, &Available);
+        if (!Available) return false;
+        
+        u64 FirstTicks = 0;
+        u64 LastTicks = 0;
+        for (u32 EventI = 0; EventI < Frame->EventCount; ++EventI)
+        {
+            GLuint64 GPUTime = 0;
+            glGetQueryObjectui64v(Frame->Queries[EventI], GL_QUERY_RESULT, &GPUTime);
+            f64 Nanoseconds = f64(i64(GPUTime) - Profiler->GPUBase);
+            u64 Ticks = Profiler->TicksBase + u64(i64(Nanoseconds * Profiler->TicksPerNanosecond));
+            if (Frame->Names[EventI]) PushZoneBegin(Profiler->Track, Frame->Names[EventI], Ticks);
+            else PushZoneEnd(Profiler->Track, Ticks);
+            if (EventI == 0) FirstTicks = Ticks;
+            LastTicks = Ticks;
+        }
+        Profiler->FrameMilliseconds = TicksToMilliseconds(LastTicks - FirstTicks);
+        ++Profiler->ReadFrames;
+        Frame->Pending = false;
+        return true;
+    }
+    
+    // ends the frame before (and its open zones) and begins a zone named Name for this one
+    inline void
+        BeginGLProfileFrame(const char *Name = "frame")
+    {
+        gl_profiler *Profiler = GetGLProfiler();
+        if (!Profiler->Initialized) return;
+        if (Profiler->Depth)
+        {
+            while (Profiler->Depth)
+            {
+                PushGLProfileEvent(Profiler, 0);
+                --Profiler->Depth;
+            }
+            Profiler->SkipDepth = 0;
+            Profiler->Frames[Profiler->FrameIndex].Pending = true;
+        }
+        
+        // oldest first, so the track stays in order
+        Profiler->FrameIndex = (Profiler->FrameIndex + 1) % CH_GL_PROFILE_FRAMES;
+        for (u32 FrameI = 0; FrameI < CH_GL_PROFILE_FRAMES; ++FrameI)
+        {
+            gl_profile_frame *Frame = &Profiler->Frames[(Profiler->FrameIndex + FrameI) % CH_GL_PROFILE_FRAMES];
+            if (Frame->Pending && !ReadGLProfileFrame(Profiler, Frame)) break;
+        }
+        
+        gl_profile_frame *Frame = &Profiler->Frames[Profiler->FrameIndex];
+        if (Frame->Pending)
+        {
+            // reading it now would wait for the GPU
+            Frame->Pending = false;
+            ++Profiler->LateFrames;
+        }
+        if (++Profiler->FrameCount % CH_GL_PROFILE_CALIBRATION_FRAMES == 0)
+        {
+            CalibrateGLProfiler(Profiler);
+        }
+        Frame->EventCount = 0;
+        PushGLProfileEvent(Profiler, Name);
+        Profiler->Depth = 1;
+    }
+    
+    // GPU time of the last frame read back, 0 before the first one
+    inline f64
+        GetGLFrameMilliseconds()
+    {
+        return GetGLProfiler()->FrameMilliseconds;
+    }
+};
\ No newline at end of file
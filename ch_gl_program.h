@@ -0,0 +1,381 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// binaries go to the directory, 0 compiles every time (batching still applies)
+ch::gl_program_cache Cache = ch::InitGLProgramCache("shadercache");
+
+ch::gl_program_desc Descs[2] = {};
+Descs[0].Name = "mesh";
+Descs[0].Stages[0] = {GL_VERTEX_SHADER, MeshVS};
+Descs[0].Stages[1] = {GL_FRAGMENT_SHADER, MeshFS};
+Descs[0].StageCount = 2;
+Descs[1] = Descs[0];
+Descs[1].Name = "mesh_shadowed";
+Descs[1].Defines = "#define SHADOWS 1\n"; // goes after the #version line
+
+GLuint Programs[2];
+int Built = ch::BuildGLPrograms(&Cache, Descs, 2, Programs); // failed ones are 0
+if (Built != 2) printf("%s\n", Cache.Log);
+
+GLuint Sky = ch::BuildGLProgram(&Cache, &SkyDesc); // just one
+
+printf("%llu from binaries, %llu compiled\n", Cache.Hits, Cache.Builds);
+
+Cache:
+
+The key is a 64-bit hash (ch_hash.h) of each stage's type and source, the defines and the
+driver's GL_VENDOR, GL_RENDERER and GL_VERSION strings, so a driver update
+misses instead of feeding the new driver an old binary. An entry is one .glbin
+file named after the key: a header (magic, version, key, binary format, size)
+and what glGetProgramBinary returned. A hit creates the program with
+glProgramBinary and checks its link status, a driver can refuse a binary at any
+time (it counts in Rejects) and the program is compiled from source instead.
+Entries are written through a temporary file and a rename, a write failure only
+costs the next startup its hit. Without GL_NUM_PROGRAM_BINARY_FORMATS nothing
+is read or written.
+
+Batching:
+
+Drivers compile on other threads when nothing waits for the result, asking for
+a compile or link status right away makes each program wait for the one before.
+BuildGLPrograms loads the hits first, then issues every compile, then every
+link, and only then asks for link statuses (compile statuses and logs only for
+programs that failed).
+*/
+
+#include "ch_gl_load.h"
+#include "ch_gl_uniform.h"
+#include "ch_hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#ifndef CH_GL_PROGRAM_MAX_STAGES
+#define CH_GL_PROGRAM_MAX_STAGES 5
+#endif
+
+#define CH_GL_PROGRAM_FILE_MAGIC 0x42504843 // "CHPB"
+#define CH_GL_PROGRAM_FILE_VERSION 1
+
+namespace ch
+{
+    struct gl_shader_stage
+    {
+        GLenum Type; // GL_VERTEX_SHADER...
+        const char *Source;
+    };
+    
+    struct gl_program_desc
+    {
+        const char *Name; // for the log, can be 0
+        gl_shader_stage Stages[CH_GL_PROGRAM_MAX_STAGES];
+        int StageCount;
+        const char *Defines; // inserted after the #version line, can be 0
+    };
+    
+    struct gl_program_cache
+    {
+        char Directory[512]; // empty for no binaries
+        u64 DriverHash;
+        bool BinariesSupported;
+        
+        u64 Hits;          // programs made from binaries
+        u64 Builds;        // compiled from source
+        u64 Rejects;       // binaries the driver didn't take
+        u64 Failures;      // compile or link errors
+        u64 WriteFailures;
+        char Log[2048];    // the last error
+    };
+    
+    struct gl_program_file_header
+    {
+        u32 Magic;
+        u32 Version;
+        u64 Key;
+        u32 BinaryFormat;
+        u32 BinarySize; // bytes after the header
+    };
+    
+    //
+    //
+    // keys
+    
+    // continued from Hash. Strings hash with their terminator, "ab" + "c" isn't "a" + "bc"
+    inline u64
+        HashGLProgramString(u64 Hash, const char *String)
+    {
+        if (!String) String = "";
+        return HashBytes64(String, strlen(String) + 1, Hash);
+    }
+    
+    inline u64
+        GetGLProgramKey(const gl_program_cache *Cache, const gl_program_desc *Desc)
+    {
+        u64 Hash = HashBytes64(&Desc->StageCount, sizeof(Desc->StageCount), Cache->DriverHash);
+        for (int StageI = 0; StageI < Desc->StageCount; ++StageI)
+        {
+            Hash = HashBytes64(&Desc->Stages[StageI].Type, sizeof(GLenum), Hash);
+            Hash = HashGLProgramString(Hash, Desc->Stages[StageI].Source);
+        }
+        return HashGLProgramString(Hash, Desc->Defines);
+    }
+    
+    //
+    //
+    // cache
+    
+    // Directory is created if needed, 0 keeps nothing on disk. Needs the context
+    inline gl_program_cache
+        InitGLProgramCache(const char *Directory)
+    {
+        gl_program_cache Cache = {};
+        u32 Version = CH_GL_PROGRAM_FILE_VERSION;
+        Cache.DriverHash = HashBytes64(&Version, sizeof(Version));
+        GLenum Names[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        for (int NameI = 0; NameI < 3; ++NameI)
+        {
+            Cache.DriverHash = HashGLProgramString(Cache.DriverHash, (const char *)glGetString(Names[NameI]));
+        }
+        
+        GLint FormatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &FormatCount);
+        Cache.BinariesSupported = FormatCount > 0 && IsGLFunctionAvailable((void *)glGetProgramBinary) &&
+            IsGLFunctionAvailable((void *)glProgramBinary);
+        if (Directory && Cache.BinariesSupported)
+        {
+            snprintf(Cache.Directory, sizeof(Cache.Directory), "%s", Directory);
+#ifdef _WIN32
+            _mkdir(Directory);
+#else
+            mkdir(Directory, 0755);
+#endif
+        }
+        return Cache;
+    }
+    
+    inline void
+        GetGLProgramCachePath(char *Out, size_t OutSize, const gl_program_cache *Cache, u64 Key)
+    {
+        snprintf(Out, OutSize, "%s/%016llx.glbin", Cache->Directory, (unsigned long long)Key);
+    }
+    
+    // the program from the entry for Key, 0 if there's none or the driver refuses it
+    inline GLuint
+        LoadGLProgramBinary(gl_program_cache *Cache, u64 Key)
+    {
+        if (!Cache->Directory[0]) return 0;
+        char Path[600];
+        GetGLProgramCachePath(Path, sizeof(Path), Cache, Key);
+        FILE *File = fopen(Path, "rb");
+        if (!File) return 0;
+        
+        GLuint Program = 0;
+        gl_program_file_header Header;
+        if (fread(&Header, sizeof(Header), 1, File) == 1 && Header.Magic == CH_GL_PROGRAM_FILE_MAGIC &&
+            Header.Version == CH_GL_PROGRAM_FILE_VERSION && Header.Key == Key && Header.BinarySize > 0)
+        {
+            void *Binary = malloc(Header.BinarySize);
+            if (Binary && fread(Binary, 1, Header.BinarySize, File) == Header.BinarySize)
+            {
+                Program = glCreateProgram();
+                ResetUniformCache(Program); // a reused name, the old program's locations are wrong
+                glProgramBinary(Program, Header.BinaryFormat, Binary, GLsizei(Header.BinarySize));
+                GLint Linked = GL_FALSE;
+                glGetProgramiv(Program, GL_LINK_STATUS, &Linked);
+                if (!Linked)
+                {
+                    DeleteGLProgram(Program);
+                    Program = 0;
+                    ++Cache->Rejects;
+                }
+            }
+            free(Binary);
+        }
+        fclose(File);
+        return Program;
+    }
+    
+    // written next to the entry and renamed, a crash never leaves half an entry
+    inline void
+        SaveGLProgramBinary(gl_program_cache *Cache, u64 Key, GLuint Program)
+    {
+        if (!Cache->Directory[0]) return;
+        GLint Size = 0;
+        glGetProgramiv(Program, GL_PROGRAM_BINARY_LENGTH, &Size);
+        if (Size <= 0) return;
+        
+        u8 *Data = (u8 *)malloc(sizeof(gl_program_file_header) + size_t(Size));
+        gl_program_file_header *Header = (gl_program_file_header *)Data;
+        GLsizei Length = 0;
+        GLenum Format = 0;
+        glGetProgramBinary(Program, Size, &Length, &Format, Data + sizeof(gl_program_file_header));
+        Header->Magic = CH_GL_PROGRAM_FILE_MAGIC;
+        Header->Version = CH_GL_PROGRAM_FILE_VERSION;
+        Header->Key = Key;
+        Header->BinaryFormat = Format;
+        Header->BinarySize = u32(Length);
+        
+        char Path[600];
+        char TempPath[640];
+        GetGLProgramCachePath(Path, sizeof(Path), Cache, Key);
+        snprintf(TempPath, sizeof(TempPath), "%s.tmp", Path);
+        bool Written = false;
+        FILE *File = fopen(TempPath, "wb");
+        if (File)
+        {
+            size_t FileSize = sizeof(gl_program_file_header) + size_t(Length);
+            Written = fwrite(Data, 1, FileSize, File) == FileSize;
+            Written = fclose(File) == 0 && Written;
+#ifdef _WIN32
+            // replaces the old entry in one step, rename doesn't replace there
+            Written = Written && MoveFileExA(TempPath, Path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+            Written = Written && rename(TempPath, Path) == 0;
+#endif
+            if (!Written) remove(TempPath);
+        }
+        if (!Written) ++Cache->WriteFailures;
+        free(Data);
+    }
+    
+    //
+    //
+    // building
+    
+    // Source with Defines after its #version line, as glShaderSource strings
+    inline void
+        SetGLShaderSource(GLuint Shader, const char *Source, const char *Defines)
+    {
+        if (!Defines || !Defines[0])
+        {
+            glShaderSource(Shader, 1, &Source, 0);
+            return;
+        }
+        GLint VersionLength = 0;
+        const char *At = Source;
+        while (*At == ' ' || *At == '\t' || *At == '\r' || *At == '\n') ++At;
+        if (strncmp(At, "#version", 8) == 0)
+        {
+            const char *LineEnd = strchr(At, '\n');
+            VersionLength = LineEnd? GLint(LineEnd + 1 - Source): GLint(strlen(Source));
+        }
+        const char *Strings[3] = {Source, Defines, Source + VersionLength};
+        GLint Lengths[3] = {VersionLength, -1, -1};
+        glShaderSource(Shader, 3, Strings, Lengths);
+    }
+    
+    // Cache->Log keeps the last error, every failure overwrites it
+    inline void
+        LogGLProgramError(gl_program_cache *Cache, const gl_program_desc *Desc, GLuint Program, const GLuint *Shaders)
+    {
+        ++Cache->Failures;
+        int Used = snprintf(Cache->Log, sizeof(Cache->Log), "%s: ", Desc->Name? Desc->Name: "program");
+        GLsizei Length = 0;
+        for (int StageI = 0; StageI < Desc->StageCount; ++StageI)
+        {
+            GLint Compiled = GL_FALSE;
+            glGetShaderiv(Shaders[StageI], GL_COMPILE_STATUS, &Compiled);
+            if (!Compiled)
+            {
+                glGetShaderInfoLog(Shaders[StageI], GLsizei(sizeof(Cache->Log) - Used), &Length, Cache->Log + Used);
+                return;
+            }
+        }
+        glGetProgramInfoLog(Program, GLsizei(sizeof(Cache->Log) - Used), &Length, Cache->Log + Used);
+    }
+    
+    // Programs[I] gets Descs[I]'s program or 0 when it fails, returns how many were built
+    inline int
+        BuildGLPrograms(gl_program_cache *Cache, const gl_program_desc *Descs, int Count, GLuint *Programs)
+    {
+        u64 *Keys = (u64 *)malloc(Count * sizeof(u64) + 1);
+        GLuint (*Shaders)[CH_GL_PROGRAM_MAX_STAGES] = (GLuint (*)[CH_GL_PROGRAM_MAX_STAGES])calloc(Count + 1, sizeof(*Shaders));
+        int Built = 0;
+        for (int ProgramI = 0; ProgramI < Count; ++ProgramI)
+        {
+            Keys[ProgramI] = GetGLProgramKey(Cache, &Descs[ProgramI]);
+            Programs[ProgramI] = LoadGLProgramBinary(Cache, Keys[ProgramI]);
+            if (Programs[ProgramI])
+            {
+                ++Cache->Hits;
+                ++Built;
+            }
+        }
+        
+        // every compile, then every link, nothing waits in between
+        for (int ProgramI = 0; ProgramI < Count; ++ProgramI)
+        {
+            if (Programs[ProgramI]) continue;
+            const gl_program_desc *Desc = &Descs[ProgramI];
+            for (int StageI = 0; StageI < Desc->StageCount; ++StageI)
+            {
+                GLuint Shader = glCreateShader(Desc->Stages[StageI].Type);
+                SetGLShaderSource(Shader, Desc->Stages[StageI].Source, Desc->Defines);
+                glCompileShader(Shader);
+                Shaders[ProgramI][StageI] = Shader;
+            }
+        }
+        for (int ProgramI = 0; ProgramI < Count; ++ProgramI)
+        {
+            if (Programs[ProgramI]) continue;
+            GLuint Program = glCreateProgram();
+            ResetUniformCache(Program);
+            for (int StageI = 0; StageI < Descs[ProgramI].StageCount; ++StageI)
+            {
+                glAttachShader(Program, Shaders[ProgramI][StageI]);
+            }
+            if (Cache->Directory[0]) glProgramParameteri(Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(Program);
+            Programs[ProgramI] = Program;
+        }
+        
+        // first status query, after everything was issued
+        for (int ProgramI = 0; ProgramI < Count; ++ProgramI)
+        {
+            const gl_program_desc *Desc = &Descs[ProgramI];
+            GLuint Program = Programs[ProgramI];
+            if (!Shaders[ProgramI][0] && Desc->StageCount > 0) continue; // from a binary
+            
+            GLint Linked = GL_FALSE;
+            glGetProgramiv(Program, GL_LINK_STATUS, &Linked);
+            if (Linked)
+            {
+                ++Cache->Builds;
+                ++Built;
+                SaveGLProgramBinary(Cache, Keys[ProgramI], Program);
+            }
+            else
+            {
+                LogGLProgramError(Cache, Desc, Program, Shaders[ProgramI]);
+                DeleteGLProgram(Program);
+                Programs[ProgramI] = 0;
+            }
+            for (int StageI = 0; StageI < Desc->StageCount; ++StageI)
+            {
+                if (Programs[ProgramI]) glDetachShader(Program, Shaders[ProgramI][StageI]);
+                glDeleteShader(Shaders[ProgramI][StageI]);
+            }
+        }
+        free(Keys);
+        free(Shaders);
+        return Built;
+    }
+    
+    // 0 when it fails, the error is in Cache->Log
+    inline GLuint
+        BuildGLProgram(gl_program_cache *Cache, const gl_program_desc *Desc)
+    {
+        GLuint Program = 0;
+        BuildGLPrograms(Cache, Desc, 1, &Program);
+        return Program;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// what ch_gl_block.h's gl_block_ring and ch_gl_stream.h's gl_stream_buffer are built on
+ch::gl_frame_ring Ring = ch::CreateFrameRing(GL_COPY_WRITE_BUFFER, 3 * (4 << 20), 256);
+
+ch::BeginRingFrame(&Ring); // waits only if the GPU is 3 frames behind
+
+u32 Offset = 0;
+if (ch::ReserveRing(&Ring, Size, Alignment, &Offset))
+{
+    memcpy(Ring.Mapped + Offset, Data, Size);
+    Ring.Head = Offset + Size; // taken, the next reservation starts after it
+}
+
+ch::EndRingFrame(&Ring); // after the last draw reading this frame's data
+
+ch::DestroyFrameRing(&Ring);
+
+Regions:
+
+glBufferStorage with a persistent, coherent write mapping (GL 4.4), mapped once.
+The buffer is CH_GL_RING_FRAMES regions of the same size (a multiple of the
+alignment given at creation), a frame writes into its region and fences it at
+the end, a frame that comes back to a region waits on that fence first, which
+is CH_GL_RING_FRAMES frames old. There is no orphaning and no glBufferData, the
+driver never reallocates. Reservations are aligned to what they ask for and end
+at the frame's region, what doesn't fit fails and counts in FailedCount. The
+allocators on top decide when the head moves.
+*/
+
+#include "ch_gl_state.h"
+#include <assert.h>
+
+#ifndef CH_GL_RING_FRAMES
+#define CH_GL_RING_FRAMES 3
+#endif
+
+namespace ch
+{
+    struct gl_frame_ring
+    {
+        GLenum Target;   // what it's bound to while it's created and destroyed
+        GLuint Buffer;
+        u8 *Mapped;
+        u32 Size;
+        u32 Alignment;   // of the regions, and the default of the allocators on top
+        u32 RegionSize;
+        GLsync Fences[CH_GL_RING_FRAMES];
+        u64 Frame;
+        u32 Head;        // taken up to here in the frame's region
+        u32 End;
+        
+        u64 WaitCount;   // frames that found the GPU still reading their region
+        u64 FailedCount; // reservations that didn't fit
+    };
+    
+    inline gl_frame_ring
+        CreateFrameRing(GLenum Target, u32 Size, u32 Alignment)
+    {
+        gl_frame_ring Ring = {};
+        Ring.Target = Target;
+        Ring.Alignment = Alignment;
+        Ring.RegionSize = Size / CH_GL_RING_FRAMES / Alignment * Alignment;
+        Ring.Size = Ring.RegionSize * CH_GL_RING_FRAMES;
+        assert(Ring.RegionSize > 0);
+        
+        GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &Ring.Buffer);
+        SetGLBuffer(Target, Ring.Buffer);
+        glBufferStorage(Target, Ring.Size, 0, Flags);
+        Ring.Mapped = (u8 *)glMapBufferRange(Target, 0, Ring.Size, Flags);
+        SetGLBuffer(Target, 0);
+        return Ring;
+    }
+    
+    inline void
+        DestroyFrameRing(gl_frame_ring *Ring)
+    {
+        for (int RegionI = 0; RegionI < CH_GL_RING_FRAMES; ++RegionI)
+        {
+            if (Ring->Fences[RegionI]) glDeleteSync(Ring->Fences[RegionI]);
+        }
+        SetGLBuffer(Ring->Target, Ring->Buffer);
+        glUnmapBuffer(Ring->Target);
+        SetGLBuffer(Ring->Target, 0);
+        DeleteGLBuffers(1, &Ring->Buffer);
+        *Ring = {};
+    }
+    
+    // true if it had to wait
+    inline bool
+        WaitForRingFence(GLsync Fence)
+    {
+        GLenum Status = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        bool Waited = false;
+        while (Status == GL_TIMEOUT_EXPIRED)
+        {
+            Waited = true;
+            Status = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        return Waited;
+    }
+    
+    inline void
+        BeginRingFrame(gl_frame_ring *Ring)
+    {
+        int Region = int(Ring->Frame % CH_GL_RING_FRAMES);
+        if (Ring->Fences[Region])
+        {
+            if (WaitForRingFence(Ring->Fences[Region])) ++Ring->WaitCount;
+            glDeleteSync(Ring->Fences[Region]);
+            Ring->Fences[Region] = 0;
+        }
+        Ring->Head = u32(Region) * Ring->RegionSize;
+        Ring->End = Ring->Head + Ring->RegionSize;
+    }
+    
+    // after the frame's last draw that reads the ring
+    inline void
+        EndRingFrame(gl_frame_ring *Ring)
+    {
+        int Region = int(Ring->Frame % CH_GL_RING_FRAMES);
+        Ring->Fences[Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ++Ring->Frame;
+    }
+    
+    // Size bytes at Alignment past the head, false (and counted) if they don't fit.
+    // The head doesn't move
+    inline bool
+        ReserveRing(gl_frame_ring *Ring, u32 Size, u32 Alignment, u32 *Offset)
+    {
+        u32 Aligned = (Ring->Head + Alignment - 1) / Alignment * Alignment;
+        if (Size == 0 || Aligned > Ring->End || Size > Ring->End - Aligned)
+        {
+            ++Ring->FailedCount;
+            return false;
+        }
+        *Offset = Aligned;
+        return true;
+    }
+};
\ No newline at end of file
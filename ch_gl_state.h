@@ -0,0 +1,835 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// state changes through the cache, the ones that change nothing don't reach the driver
+ch::SetGLProgram(Program);
+ch::SetGLVertexArray(VAO);
+ch::SetGLActiveTexture(GL_TEXTURE0);
+ch::SetGLTexture(GL_TEXTURE_2D, Albedo);
+ch::SetGLEnabled(GL_BLEND, true);
+ch::SetGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+ch::SetGLViewport(0, 0, Width, Height);
+
+// queries come from the cache
+GLuint Bound = ch::GetGLTexture(GL_TEXTURE_2D);
+
+// what RenderImgui does around its pass. With every bind going through the cache
+// the save is a copy, nothing is asked of the driver
+ch::gl_state Saved = ch::SaveGLState();
+... // change whatever through the cache
+ch::RestoreGLState(&Saved); // only what differs is set back
+
+// deleting through the cache, a deleted name that gets reused must not look bound
+ch::DeleteGLTextures(1, &Albedo);
+
+// after code that calls GL directly (a library, a callback), what it may have touched
+glBindTexture(GL_TEXTURE_2D, Texture);
+ch::InvalidateGLState(ch::GL_STATE_TEXTURES_BIT);
+ch::InvalidateGLState(); // or everything, when it isn't known what it touched
+
+ch::gl_state_cache *Cache = ch::GetGLStateCache();
+printf("%llu calls, %llu elided\n", Cache->CallCount, Cache->ElidedCount);
+
+Tracking:
+
+One cache for the context, on the GL thread. It starts out as a fresh context's
+state: nothing bound, blend/depth/cull/scissor off, blend ONE/ZERO with FUNC_ADD,
+depth LESS with writes on, cull BACK and unit 0 active. The viewport and scissor
+box depend on the window and are unknown. Unknown state is queried from the
+driver the first time it's asked for and known from then on, setting it always
+goes to the driver. Binding a vertex array makes the element buffer unknown,
+the vertex array holds that one.
+
+Tracked: program, vertex array, buffers bound to ARRAY, ELEMENT_ARRAY, UNIFORM,
+SHADER_STORAGE, DRAW_INDIRECT, COPY_READ/WRITE and PIXEL_PACK/UNPACK, textures
+bound to 2D, 3D, CUBE_MAP and 2D_ARRAY on CH_GL_STATE_TEXTURE_UNITS units, the
+active unit, blend, depth test, cull face and scissor test enables, blend
+functions and equations, depth function and mask, cull face, viewport and scissor
+box. Other targets and capabilities go straight to the driver. Code that changes
+tracked state without the cache has to be followed by InvalidateGLState with the
+bits of what it changed, at its call site. Invalidating more than that costs the
+queries of the next save.
+
+Save and restore:
+
+SaveGLState resolves what's unknown (not the textures of other units than the
+active one, those stay unknown and aren't restored) and copies the state,
+RestoreGLState sets it back through the cache so only what changed is set.
+*/
+
+#include "ch_gl.h"
+#include <assert.h>
+#include <string.h>
+
+#ifndef CH_GL_STATE_TEXTURE_UNITS
+#define CH_GL_STATE_TEXTURE_UNITS 32
+#endif
+
+namespace ch
+{
+    //
+    //
+    // state
+    
+    // not a valid name or enum for anything tracked
+    const GLuint GL_STATE_UNKNOWN = 0xFFFFFFFFu;
+    
+    enum gl_state_capability
+    {
+        GL_STATE_BLEND,
+        GL_STATE_DEPTH_TEST,
+        GL_STATE_CULL_FACE,
+        GL_STATE_SCISSOR_TEST,
+        GL_STATE_CAPABILITY_COUNT,
+    };
+    
+    enum gl_state_buffer
+    {
+        GL_STATE_ARRAY_BUFFER,
+        GL_STATE_ELEMENT_ARRAY_BUFFER,
+        GL_STATE_UNIFORM_BUFFER,
+        GL_STATE_SHADER_STORAGE_BUFFER,
+        GL_STATE_DRAW_INDIRECT_BUFFER,
+        GL_STATE_COPY_READ_BUFFER,
+        GL_STATE_COPY_WRITE_BUFFER,
+        GL_STATE_PIXEL_PACK_BUFFER,
+        GL_STATE_PIXEL_UNPACK_BUFFER,
+        GL_STATE_BUFFER_COUNT,
+    };
+    
+    enum gl_state_texture
+    {
+        GL_STATE_TEXTURE_2D,
+        GL_STATE_TEXTURE_3D,
+        GL_STATE_TEXTURE_CUBE_MAP,
+        GL_STATE_TEXTURE_2D_ARRAY,
+        GL_STATE_TEXTURE_COUNT,
+    };
+    
+    // what InvalidateGLState forgets
+    enum gl_state_bits
+    {
+        GL_STATE_PROGRAM_BIT      = 0x001,
+        GL_STATE_VERTEX_ARRAY_BIT = 0x002, // and the element buffer it holds
+        GL_STATE_BUFFERS_BIT      = 0x004,
+        GL_STATE_TEXTURES_BIT     = 0x008, // and the active unit
+        GL_STATE_ENABLES_BIT      = 0x010,
+        GL_STATE_BLEND_BIT        = 0x020,
+        GL_STATE_DEPTH_BIT        = 0x040,
+        GL_STATE_CULL_BIT         = 0x080,
+        GL_STATE_VIEWPORT_BIT     = 0x100,
+        GL_STATE_SCISSOR_BIT      = 0x200, // the box, the enable is GL_STATE_ENABLES_BIT
+        GL_STATE_ALL_BITS         = 0x3FF,
+    };
+    
+    // by slot
+    const GLenum GL_STATE_CAPABILITIES[GL_STATE_CAPABILITY_COUNT] =
+    {
+        GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST,
+    };
+    const GLenum GL_STATE_BUFFER_TARGETS[GL_STATE_BUFFER_COUNT] =
+    {
+        GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER,
+        GL_DRAW_INDIRECT_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER,
+    };
+    const GLenum GL_STATE_TEXTURE_TARGETS[GL_STATE_TEXTURE_COUNT] =
+    {
+        GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY,
+    };
+    
+    struct gl_state
+    {
+        GLuint Program;
+        GLuint VertexArray;
+        GLuint Buffers[GL_STATE_BUFFER_COUNT];
+        GLuint ActiveTexture; // unit index, not GL_TEXTURE0 + index
+        GLuint Textures[CH_GL_STATE_TEXTURE_UNITS][GL_STATE_TEXTURE_COUNT];
+        
+        u8 Enabled[GL_STATE_CAPABILITY_COUNT]; // 0, 1 or 2 for unknown
+        GLenum BlendSrcRGB;
+        GLenum BlendDstRGB;
+        GLenum BlendSrcAlpha;
+        GLenum BlendDstAlpha;
+        GLenum BlendEquationRGB;
+        GLenum BlendEquationAlpha;
+        GLenum DepthFunc;
+        u8 DepthMask;                          // 0, 1 or 2 for unknown
+        GLenum CullFace;
+        
+        b8 ViewportKnown;
+        b8 ScissorKnown;
+        GLint Viewport[4];
+        GLint Scissor[4];
+    };
+    
+    struct gl_state_cache
+    {
+        gl_state State;
+        
+        u64 CallCount;        // state changes that went to the driver
+        u64 ElidedCount;      // state changes that changed nothing
+        u64 CachedQueryCount; // queries answered by the cache
+        u64 DriverQueryCount; // glGet*/glIsEnabled for unknown state
+    };
+    
+    // a fresh context's state
+    inline void
+        ResetGLStateCache(gl_state_cache *Cache)
+    {
+        *Cache = {};
+        gl_state *State = &Cache->State;
+        State->BlendSrcRGB = State->BlendSrcAlpha = GL_ONE;
+        State->BlendDstRGB = State->BlendDstAlpha = GL_ZERO;
+        State->BlendEquationRGB = State->BlendEquationAlpha = GL_FUNC_ADD;
+        State->DepthFunc = GL_LESS;
+        State->DepthMask = 1;
+        State->CullFace = GL_BACK;
+    }
+    
+    inline gl_state_cache *
+        GetGLStateCache()
+    {
+        static gl_state_cache Cache;
+        static bool Initialized = false;
+        if (!Initialized)
+        {
+            ResetGLStateCache(&Cache);
+            Initialized = true;
+        }
+        return &Cache;
+    }
+    
+    // what's in Mask (gl_state_bits) unknown, counters are kept
+    inline void
+        InvalidateGLState(u32 Mask = GL_STATE_ALL_BITS)
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        if (Mask & GL_STATE_PROGRAM_BIT) State->Program = GL_STATE_UNKNOWN;
+        if (Mask & GL_STATE_VERTEX_ARRAY_BIT)
+        {
+            State->VertexArray = GL_STATE_UNKNOWN;
+            State->Buffers[GL_STATE_ELEMENT_ARRAY_BUFFER] = GL_STATE_UNKNOWN;
+        }
+        if (Mask & GL_STATE_BUFFERS_BIT) memset(State->Buffers, 0xFF, sizeof(State->Buffers));
+        if (Mask & GL_STATE_TEXTURES_BIT)
+        {
+            State->ActiveTexture = GL_STATE_UNKNOWN;
+            memset(State->Textures, 0xFF, sizeof(State->Textures));
+        }
+        if (Mask & GL_STATE_ENABLES_BIT)
+        {
+            for (int CapabilityI = 0; CapabilityI < GL_STATE_CAPABILITY_COUNT; ++CapabilityI) State->Enabled[CapabilityI] = 2;
+        }
+        if (Mask & GL_STATE_BLEND_BIT)
+        {
+            State->BlendSrcRGB = State->BlendDstRGB = State->BlendSrcAlpha = State->BlendDstAlpha = GL_STATE_UNKNOWN;
+            State->BlendEquationRGB = State->BlendEquationAlpha = GL_STATE_UNKNOWN;
+        }
+        if (Mask & GL_STATE_DEPTH_BIT)
+        {
+            State->DepthFunc = GL_STATE_UNKNOWN;
+            State->DepthMask = 2;
+        }
+        if (Mask & GL_STATE_CULL_BIT) State->CullFace = GL_STATE_UNKNOWN;
+        if (Mask & GL_STATE_VIEWPORT_BIT) State->ViewportKnown = false;
+        if (Mask & GL_STATE_SCISSOR_BIT) State->ScissorKnown = false;
+    }
+    
+    inline int
+        GetGLStateCapability(GLenum Capability)
+    {
+        switch (Capability)
+        {
+            case GL_BLEND: return GL_STATE_BLEND;
+            case GL_DEPTH_TEST: return GL_STATE_DEPTH_TEST;
+            case GL_CULL_FACE: return GL_STATE_CULL_FACE;
+            case GL_SCISSOR_TEST: return GL_STATE_SCISSOR_TEST;
+        }
+        return -1;
+    }
+    
+    inline int
+        GetGLStateBuffer(GLenum Target)
+    {
+        switch (Target)
+        {
+            case GL_ARRAY_BUFFER: return GL_STATE_ARRAY_BUFFER;
+            case GL_ELEMENT_ARRAY_BUFFER: return GL_STATE_ELEMENT_ARRAY_BUFFER;
+            case GL_UNIFORM_BUFFER: return GL_STATE_UNIFORM_BUFFER;
+            case GL_SHADER_STORAGE_BUFFER: return GL_STATE_SHADER_STORAGE_BUFFER;
+            case GL_DRAW_INDIRECT_BUFFER: return GL_STATE_DRAW_INDIRECT_BUFFER;
+            case GL_COPY_READ_BUFFER: return GL_STATE_COPY_READ_BUFFER;
+            case GL_COPY_WRITE_BUFFER: return GL_STATE_COPY_WRITE_BUFFER;
+            case GL_PIXEL_PACK_BUFFER: return GL_STATE_PIXEL_PACK_BUFFER;
+            case GL_PIXEL_UNPACK_BUFFER: return GL_STATE_PIXEL_UNPACK_BUFFER;
+        }
+        return -1;
+    }
+    
+    inline int
+        GetGLStateTexture(GLenum Target)
+    {
+        switch (Target)
+        {
+            case GL_TEXTURE_2D: return GL_STATE_TEXTURE_2D;
+            case GL_TEXTURE_3D: return GL_STATE_TEXTURE_3D;
+            case GL_TEXTURE_CUBE_MAP: return GL_STATE_TEXTURE_CUBE_MAP;
+            case GL_TEXTURE_2D_ARRAY: return GL_STATE_TEXTURE_2D_ARRAY;
+        }
+        return -1;
+    }
+    
+    // glGetIntegerv once for unknown state
+    inline GLuint
+        QueryGLState(GLuint *Value, GLenum Name)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (*Value == GL_STATE_UNKNOWN)
+        {
+            GLint Result = 0;
+            glGetIntegerv(Name, &Result);
+            *Value = GLuint(Result);
+            ++Cache->DriverQueryCount;
+        }
+        else
+        {
+            ++Cache->CachedQueryCount;
+        }
+        return *Value;
+    }
+    
+    //
+    //
+    // bindings
+    
+    inline void
+        SetGLProgram(GLuint Program)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (Cache->State.Program == Program)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glUseProgram(Program);
+        Cache->State.Program = Program;
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLVertexArray(GLuint VertexArray)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (Cache->State.VertexArray == VertexArray)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glBindVertexArray(VertexArray);
+        Cache->State.VertexArray = VertexArray;
+        Cache->State.Buffers[GL_STATE_ELEMENT_ARRAY_BUFFER] = GL_STATE_UNKNOWN;
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLBuffer(GLenum Target, GLuint Buffer)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        int Slot = GetGLStateBuffer(Target);
+        if (Slot >= 0 && Cache->State.Buffers[Slot] == Buffer)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glBindBuffer(Target, Buffer);
+        if (Slot >= 0) Cache->State.Buffers[Slot] = Buffer;
+        ++Cache->CallCount;
+    }
+    
+    // glBindBufferRange/glBindBufferBase also bind the generic target, tell the cache
+    inline void
+        NoteGLBuffer(GLenum Target, GLuint Buffer)
+    {
+        int Slot = GetGLStateBuffer(Target);
+        if (Slot >= 0) GetGLStateCache()->State.Buffers[Slot] = Buffer;
+    }
+    
+    // Unit is GL_TEXTURE0 + n, like glActiveTexture
+    inline void
+        SetGLActiveTexture(GLenum Unit)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        GLuint Index = GLuint(Unit - GL_TEXTURE0);
+        if (Cache->State.ActiveTexture == Index)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glActiveTexture(Unit);
+        Cache->State.ActiveTexture = Index;
+        ++Cache->CallCount;
+    }
+    
+    inline GLuint *
+        GetGLTextureSlot(gl_state *State, GLenum Target)
+    {
+        int Slot = GetGLStateTexture(Target);
+        if (Slot < 0 || State->ActiveTexture >= CH_GL_STATE_TEXTURE_UNITS) return 0;
+        return &State->Textures[State->ActiveTexture][Slot];
+    }
+    
+    // on the active unit
+    inline void
+        SetGLTexture(GLenum Target, GLuint Texture)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        GLuint *Bound = GetGLTextureSlot(&Cache->State, Target);
+        if (Bound && *Bound == Texture)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glBindTexture(Target, Texture);
+        if (Bound) *Bound = Texture;
+        ++Cache->CallCount;
+    }
+    
+    //
+    //
+    // fixed function
+    
+    inline void
+        SetGLEnabled(GLenum Capability, bool Enabled)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        int Slot = GetGLStateCapability(Capability);
+        if (Slot >= 0 && Cache->State.Enabled[Slot] == u8(Enabled))
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        if (Enabled) glEnable(Capability);
+        else glDisable(Capability);
+        if (Slot >= 0) Cache->State.Enabled[Slot] = u8(Enabled);
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLBlendFuncSeparate(GLenum SrcRGB, GLenum DstRGB, GLenum SrcAlpha, GLenum DstAlpha)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        gl_state *State = &Cache->State;
+        if (State->BlendSrcRGB == SrcRGB && State->BlendDstRGB == DstRGB &&
+            State->BlendSrcAlpha == SrcAlpha && State->BlendDstAlpha == DstAlpha)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        if (SrcRGB == SrcAlpha && DstRGB == DstAlpha) glBlendFunc(SrcRGB, DstRGB);
+        else glBlendFuncSeparate(SrcRGB, DstRGB, SrcAlpha, DstAlpha);
+        State->BlendSrcRGB = SrcRGB;
+        State->BlendDstRGB = DstRGB;
+        State->BlendSrcAlpha = SrcAlpha;
+        State->BlendDstAlpha = DstAlpha;
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLBlendFunc(GLenum Src, GLenum Dst)
+    {
+        SetGLBlendFuncSeparate(Src, Dst, Src, Dst);
+    }
+    
+    inline void
+        SetGLBlendEquationSeparate(GLenum ModeRGB, GLenum ModeAlpha)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        gl_state *State = &Cache->State;
+        if (State->BlendEquationRGB == ModeRGB && State->BlendEquationAlpha == ModeAlpha)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        if (ModeRGB == ModeAlpha) glBlendEquation(ModeRGB);
+        else glBlendEquationSeparate(ModeRGB, ModeAlpha);
+        State->BlendEquationRGB = ModeRGB;
+        State->BlendEquationAlpha = ModeAlpha;
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLBlendEquation(GLenum Mode)
+    {
+        SetGLBlendEquationSeparate(Mode, Mode);
+    }
+    
+    inline void
+        SetGLDepthFunc(GLenum Func)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (Cache->State.DepthFunc == Func)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glDepthFunc(Func);
+        Cache->State.DepthFunc = Func;
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLDepthMask(bool Write)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (Cache->State.DepthMask == u8(Write))
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glDepthMask(Write? GL_TRUE: GL_FALSE);
+        Cache->State.DepthMask = u8(Write);
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLCullFace(GLenum Face)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (Cache->State.CullFace == Face)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glCullFace(Face);
+        Cache->State.CullFace = Face;
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLViewport(GLint X, GLint Y, GLsizei Width, GLsizei Height)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        gl_state *State = &Cache->State;
+        if (State->ViewportKnown && State->Viewport[0] == X && State->Viewport[1] == Y &&
+            State->Viewport[2] == Width && State->Viewport[3] == Height)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glViewport(X, Y, Width, Height);
+        State->Viewport[0] = X;
+        State->Viewport[1] = Y;
+        State->Viewport[2] = Width;
+        State->Viewport[3] = Height;
+        State->ViewportKnown = true;
+        ++Cache->CallCount;
+    }
+    
+    inline void
+        SetGLScissor(GLint X, GLint Y, GLsizei Width, GLsizei Height)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        gl_state *State = &Cache->State;
+        if (State->ScissorKnown && State->Scissor[0] == X && State->Scissor[1] == Y &&
+            State->Scissor[2] == Width && State->Scissor[3] == Height)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        glScissor(X, Y, Width, Height);
+        State->Scissor[0] = X;
+        State->Scissor[1] = Y;
+        State->Scissor[2] = Width;
+        State->Scissor[3] = Height;
+        State->ScissorKnown = true;
+        ++Cache->CallCount;
+    }
+    
+    //
+    //
+    // queries
+    
+    inline GLuint
+        GetGLProgram()
+    {
+        return QueryGLState(&GetGLStateCache()->State.Program, GL_CURRENT_PROGRAM);
+    }
+    
+    inline GLuint
+        GetGLVertexArray()
+    {
+        return QueryGLState(&GetGLStateCache()->State.VertexArray, GL_VERTEX_ARRAY_BINDING);
+    }
+    
+    inline GLuint
+        GetGLBuffer(GLenum Target)
+    {
+        static const GLenum BindingNames[GL_STATE_BUFFER_COUNT] =
+        {
+            GL_ARRAY_BUFFER_BINDING, GL_ELEMENT_ARRAY_BUFFER_BINDING, GL_UNIFORM_BUFFER_BINDING,
+            GL_SHADER_STORAGE_BUFFER_BINDING, GL_DRAW_INDIRECT_BUFFER_BINDING, GL_COPY_READ_BUFFER_BINDING,
+            GL_COPY_WRITE_BUFFER_BINDING, GL_PIXEL_PACK_BUFFER_BINDING, GL_PIXEL_UNPACK_BUFFER_BINDING,
+        };
+        int Slot = GetGLStateBuffer(Target);
+        assert(Slot >= 0);
+        return QueryGLState(&GetGLStateCache()->State.Buffers[Slot], BindingNames[Slot]);
+    }
+    
+    // GL_TEXTURE0 + n
+    inline GLenum
+        GetGLActiveTexture()
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        if (State->ActiveTexture == GL_STATE_UNKNOWN)
+        {
+            GLuint Unit = GL_STATE_UNKNOWN;
+            QueryGLState(&Unit, GL_ACTIVE_TEXTURE);
+            State->ActiveTexture = Unit - GL_TEXTURE0;
+        }
+        else
+        {
+            ++GetGLStateCache()->CachedQueryCount;
+        }
+        return GL_TEXTURE0 + State->ActiveTexture;
+    }
+    
+    // on the active unit
+    inline GLuint
+        GetGLTexture(GLenum Target)
+    {
+        static const GLenum BindingNames[GL_STATE_TEXTURE_COUNT] =
+        {
+            GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_3D, GL_TEXTURE_BINDING_CUBE_MAP, GL_TEXTURE_BINDING_2D_ARRAY,
+        };
+        gl_state *State = &GetGLStateCache()->State;
+        GetGLActiveTexture();
+        GLuint *Bound = GetGLTextureSlot(State, Target);
+        assert(Bound);
+        return QueryGLState(Bound, BindingNames[GetGLStateTexture(Target)]);
+    }
+    
+    inline bool
+        IsGLEnabled(GLenum Capability)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        int Slot = GetGLStateCapability(Capability);
+        assert(Slot >= 0);
+        if (Cache->State.Enabled[Slot] == 2)
+        {
+            Cache->State.Enabled[Slot] = glIsEnabled(Capability)? 1: 0;
+            ++Cache->DriverQueryCount;
+        }
+        else
+        {
+            ++Cache->CachedQueryCount;
+        }
+        return Cache->State.Enabled[Slot] == 1;
+    }
+    
+    inline void
+        GetGLBlendFunc(GLenum *SrcRGB, GLenum *DstRGB, GLenum *SrcAlpha, GLenum *DstAlpha)
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        *SrcRGB = QueryGLState(&State->BlendSrcRGB, GL_BLEND_SRC_RGB);
+        *DstRGB = QueryGLState(&State->BlendDstRGB, GL_BLEND_DST_RGB);
+        *SrcAlpha = QueryGLState(&State->BlendSrcAlpha, GL_BLEND_SRC_ALPHA);
+        *DstAlpha = QueryGLState(&State->BlendDstAlpha, GL_BLEND_DST_ALPHA);
+    }
+    
+    inline void
+        GetGLBlendEquation(GLenum *ModeRGB, GLenum *ModeAlpha)
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        *ModeRGB = QueryGLState(&State->BlendEquationRGB, GL_BLEND_EQUATION_RGB);
+        *ModeAlpha = QueryGLState(&State->BlendEquationAlpha, GL_BLEND_EQUATION_ALPHA);
+    }
+    
+    inline GLenum
+        GetGLDepthFunc()
+    {
+        return QueryGLState(&GetGLStateCache()->State.DepthFunc, GL_DEPTH_FUNC);
+    }
+    
+    inline bool
+        GetGLDepthMask()
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (Cache->State.DepthMask == 2)
+        {
+            GLboolean Mask = GL_TRUE;
+            glGetBooleanv(GL_DEPTH_WRITEMASK, &Mask);
+            Cache->State.DepthMask = Mask? 1: 0;
+            ++Cache->DriverQueryCount;
+        }
+        else
+        {
+            ++Cache->CachedQueryCount;
+        }
+        return Cache->State.DepthMask == 1;
+    }
+    
+    inline GLenum
+        GetGLCullFace()
+    {
+        return QueryGLState(&GetGLStateCache()->State.CullFace, GL_CULL_FACE_MODE);
+    }
+    
+    inline void
+        GetGLViewport(GLint *Viewport)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (!Cache->State.ViewportKnown)
+        {
+            glGetIntegerv(GL_VIEWPORT, Cache->State.Viewport);
+            Cache->State.ViewportKnown = true;
+            ++Cache->DriverQueryCount;
+        }
+        else
+        {
+            ++Cache->CachedQueryCount;
+        }
+        memcpy(Viewport, Cache->State.Viewport, sizeof(Cache->State.Viewport));
+    }
+    
+    inline void
+        GetGLScissor(GLint *Scissor)
+    {
+        gl_state_cache *Cache = GetGLStateCache();
+        if (!Cache->State.ScissorKnown)
+        {
+            glGetIntegerv(GL_SCISSOR_BOX, Cache->State.Scissor);
+            Cache->State.ScissorKnown = true;
+            ++Cache->DriverQueryCount;
+        }
+        else
+        {
+            ++Cache->CachedQueryCount;
+        }
+        memcpy(Scissor, Cache->State.Scissor, sizeof(Cache->State.Scissor));
+    }
+    
+    //
+    //
+    // deleting
+    
+    inline void
+        DeleteGLTextures(GLsizei Count, const GLuint *Textures)
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        for (GLsizei I = 0; I < Count; ++I)
+        {
+            for (int Unit = 0; Unit < CH_GL_STATE_TEXTURE_UNITS; ++Unit)
+            {
+                for (int Slot = 0; Slot < GL_STATE_TEXTURE_COUNT; ++Slot)
+                {
+                    if (State->Textures[Unit][Slot] == Textures[I]) State->Textures[Unit][Slot] = 0;
+                }
+            }
+        }
+        glDeleteTextures(Count, Textures);
+    }
+    
+    inline void
+        DeleteGLBuffers(GLsizei Count, const GLuint *Buffers)
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        for (GLsizei I = 0; I < Count; ++I)
+        {
+            for (int Slot = 0; Slot < GL_STATE_BUFFER_COUNT; ++Slot)
+            {
+                if (State->Buffers[Slot] == Buffers[I]) State->Buffers[Slot] = 0;
+            }
+        }
+        glDeleteBuffers(Count, Buffers);
+    }
+    
+    inline void
+        DeleteGLVertexArrays(GLsizei Count, const GLuint *VertexArrays)
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        for (GLsizei I = 0; I < Count; ++I)
+        {
+            if (State->VertexArray == VertexArrays[I])
+            {
+                State->VertexArray = 0;
+                State->Buffers[GL_STATE_ELEMENT_ARRAY_BUFFER] = 0;
+            }
+        }
+        glDeleteVertexArrays(Count, VertexArrays);
+    }
+    
+    //
+    //
+    // save and restore
+    
+    inline gl_state
+        SaveGLState()
+    {
+        GetGLProgram();
+        GetGLVertexArray();
+        for (int Slot = 0; Slot < GL_STATE_BUFFER_COUNT; ++Slot) GetGLBuffer(GL_STATE_BUFFER_TARGETS[Slot]);
+        for (int Slot = 0; Slot < GL_STATE_TEXTURE_COUNT; ++Slot) GetGLTexture(GL_STATE_TEXTURE_TARGETS[Slot]);
+        for (int Slot = 0; Slot < GL_STATE_CAPABILITY_COUNT; ++Slot) IsGLEnabled(GL_STATE_CAPABILITIES[Slot]);
+        GLenum Blend[4];
+        GetGLBlendFunc(&Blend[0], &Blend[1], &Blend[2], &Blend[3]);
+        GetGLBlendEquation(&Blend[0], &Blend[1]);
+        GetGLDepthFunc();
+        GetGLDepthMask();
+        GetGLCullFace();
+        GLint Rect[4];
+        GetGLViewport(Rect);
+        GetGLScissor(Rect);
+        return GetGLStateCache()->State;
+    }
+    
+    inline void
+        RestoreGLState(const gl_state *Saved)
+    {
+        gl_state *State = &GetGLStateCache()->State;
+        SetGLProgram(Saved->Program);
+        if (State->VertexArray != Saved->VertexArray)
+        {
+            // the vertex array brings its element buffer back
+            SetGLVertexArray(Saved->VertexArray);
+            State->Buffers[GL_STATE_ELEMENT_ARRAY_BUFFER] = Saved->Buffers[GL_STATE_ELEMENT_ARRAY_BUFFER];
+        }
+        for (int Slot = 0; Slot < GL_STATE_BUFFER_COUNT; ++Slot)
+        {
+            if (Saved->Buffers[Slot] != GL_STATE_UNKNOWN) SetGLBuffer(GL_STATE_BUFFER_TARGETS[Slot], Saved->Buffers[Slot]);
+        }
+        
+        for (GLuint Unit = 0; Unit < CH_GL_STATE_TEXTURE_UNITS; ++Unit)
+        {
+            for (int Slot = 0; Slot < GL_STATE_TEXTURE_COUNT; ++Slot)
+            {
+                GLuint Texture = Saved->Textures[Unit][Slot];
+                if (Texture != GL_STATE_UNKNOWN && Texture != State->Textures[Unit][Slot])
+                {
+                    SetGLActiveTexture(GL_TEXTURE0 + Unit);
+                    SetGLTexture(GL_STATE_TEXTURE_TARGETS[Slot], Texture);
+                }
+            }
+        }
+        if (Saved->ActiveTexture != GL_STATE_UNKNOWN) SetGLActiveTexture(GL_TEXTURE0 + Saved->ActiveTexture);
+        
+        for (int Slot = 0; Slot < GL_STATE_CAPABILITY_COUNT; ++Slot)
+        {
+            if (Saved->Enabled[Slot] != 2) SetGLEnabled(GL_STATE_CAPABILITIES[Slot], Saved->Enabled[Slot] == 1);
+        }
+        if (Saved->BlendSrcRGB != GL_STATE_UNKNOWN)
+        {
+            SetGLBlendFuncSeparate(Saved->BlendSrcRGB, Saved->BlendDstRGB, Saved->BlendSrcAlpha, Saved->BlendDstAlpha);
+        }
+        if (Saved->BlendEquationRGB != GL_STATE_UNKNOWN)
+        {
+            SetGLBlendEquationSeparate(Saved->BlendEquationRGB, Saved->BlendEquationAlpha);
+        }
+        if (Saved->DepthFunc != GL_STATE_UNKNOWN) SetGLDepthFunc(Saved->DepthFunc);
+        if (Saved->DepthMask != 2) SetGLDepthMask(Saved->DepthMask == 1);
+        if (Saved->CullFace != GL_STATE_UNKNOWN) SetGLCullFace(Saved->CullFace);
+        if (Saved->ViewportKnown) SetGLViewport(Saved->Viewport[0], Saved->Viewport[1], Saved->Viewport[2], Saved->Viewport[3]);
+        if (Saved->ScissorKnown) SetGLScissor(Saved->Scissor[0], Saved->Scissor[1], Saved->Scissor[2], Saved->Scissor[3]);
+    }
+};
\ No newline at end of file
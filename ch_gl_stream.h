@@ -0,0 +1,258 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch::gl_stream_buffer Stream = ch::CreateStreamBuffer(3 * (4 << 20)); // 4MB a frame
+
+ch::BeginStreamFrame(&Stream); // waits only if the GPU is 3 frames behind
+
+// copy in one go
+ch::gl_stream_allocation Indices = ch::WriteStream(&Stream, IndexData, IndexBytes, sizeof(u16));
+
+// or reserve the worst case, write straight into the mapping and commit what was written
+ch::gl_stream_allocation Vertices = ch::AllocateStream(&Stream, MaxVertexBytes, sizeof(vertex));
+int VertexCount = BuildVertices((vertex *)Vertices.Data);
+ch::CommitStream(&Stream, &Vertices, VertexCount * sizeof(vertex));
+
+ch::SetGLBuffer(GL_ARRAY_BUFFER, Stream.Buffer);
+ch::SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, Stream.Buffer);
+glDrawElementsBaseVertex(GL_TRIANGLES, IndexCount, GL_UNSIGNED_SHORT, (void *)Indices.Offset,
+                         GLint(Vertices.Offset / sizeof(vertex)));
+
+ch::EndStreamFrame(&Stream); // after the last draw reading this frame's data
+
+// debug lines, through their own stream buffer
+ch::gl_debug_lines Lines = ch::CreateDebugLines(1 << 16);
+ch::BeginDebugLines(&Lines);
+ch::PushDebugLine(&Lines, A, B, 0xFF0000FF); // any vector with X, Y, Z. Color is ABGR like ImGui's
+ch::DrawDebugLines(&Lines, &ViewProjection.Data[0][0]); // row major, like glUploadMatrix4
+
+Regions:
+
+The buffer is ch_gl_ring.h's persistently mapped ring of CH_GL_RING_FRAMES fenced
+regions, the same one ch_gl_block.h sub-allocates blocks from. Allocations are
+aligned to what they hold (any size, sizeof(ImDrawVert) is 20) so the offset
+divides into a base vertex. One allocation is open at a time, the next
+allocation starts after what was committed. What doesn't fit in the frame's
+region gets an empty allocation (Data is 0) and counts in FailedCount.
+*/
+
+#include "ch_gl_ring.h"
+#include "ch_gl_uniform.h"
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace ch
+{
+    //
+    //
+    // streaming buffer
+    
+    struct gl_stream_allocation
+    {
+        u8 *Data; // 0 when the region is full
+        u32 Offset;
+        u32 Size;
+    };
+    
+    // a frame ring of ch_gl_ring.h, bound to a target nobody draws from while it's created
+    // and destroyed, so VAOs keep their element buffers
+    typedef gl_frame_ring gl_stream_buffer;
+    
+    inline gl_stream_buffer
+        CreateStreamBuffer(u32 Size)
+    {
+        return CreateFrameRing(GL_COPY_WRITE_BUFFER, Size, 256);
+    }
+    
+    inline void
+        DestroyStreamBuffer(gl_stream_buffer *Stream)
+    {
+        DestroyFrameRing(Stream);
+    }
+    
+    inline void
+        BeginStreamFrame(gl_stream_buffer *Stream)
+    {
+        BeginRingFrame(Stream);
+    }
+    
+    inline void
+        EndStreamFrame(gl_stream_buffer *Stream)
+    {
+        EndRingFrame(Stream);
+    }
+    
+    // reserves Size bytes, nothing is taken until CommitStream
+    inline gl_stream_allocation
+        AllocateStream(gl_stream_buffer *Stream, u32 Size, u32 Alignment = 4)
+    {
+        gl_stream_allocation Allocation = {};
+        u32 Offset = 0;
+        if (!ReserveRing(Stream, Size, Alignment, &Offset))
+        {
+            return Allocation;
+        }
+        Allocation.Data = Stream->Mapped + Offset;
+        Allocation.Offset = Offset;
+        Allocation.Size = Size;
+        return Allocation;
+    }
+    
+    // UsedSize of the allocation was written and goes to the GPU
+    inline void
+        CommitStream(gl_stream_buffer *Stream, gl_stream_allocation *Allocation, u32 UsedSize)
+    {
+        if (!Allocation->Data) return;
+        assert(UsedSize <= Allocation->Size && Allocation->Offset >= Stream->Head);
+        Allocation->Size = UsedSize;
+        Stream->Head = Allocation->Offset + UsedSize;
+    }
+    
+    inline gl_stream_allocation
+        WriteStream(gl_stream_buffer *Stream, const void *Data, u32 Size, u32 Alignment = 4)
+    {
+        gl_stream_allocation Allocation = AllocateStream(Stream, Size, Alignment);
+        if (Allocation.Data)
+        {
+            memcpy(Allocation.Data, Data, Size);
+            CommitStream(Stream, &Allocation, Size);
+        }
+        return Allocation;
+    }
+    
+    //
+    //
+    // debug lines
+    
+    struct gl_debug_line_vertex
+    {
+        f32 P[3];
+        u32 Color;
+    };
+    
+    struct gl_debug_lines
+    {
+        gl_stream_buffer Stream;
+        GLuint Program;
+        GLuint VAO;
+        GLint ViewProjectionLocation;
+        
+        gl_stream_allocation Write; // open between BeginDebugLines and DrawDebugLines
+        u32 VertexCount;
+        u32 VertexCapacity;
+        u64 DroppedCount;           // lines past the frame's capacity
+    };
+    
+    // MaxLines a frame
+    inline gl_debug_lines
+        CreateDebugLines(u32 MaxLines)
+    {
+        gl_debug_lines Lines = {};
+        u32 RegionSize = (MaxLines * 2 * sizeof(gl_debug_line_vertex) + 255) / 256 * 256;
+        Lines.Stream = CreateStreamBuffer(CH_GL_RING_FRAMES * RegionSize);
+        
+        const GLchar *VertexSource =
+            "#version 330\n"
+            "uniform mat4 ViewProjection;\n"
+            "layout(location = 0) in vec3 Position;\n"
+            "layout(location = 1) in vec4 Color;\n"
+            "out vec4 FragColor;\n"
+            "void main()\n"
+            "{\n"
+            "    FragColor = Color;\n"
+            "    gl_Position = ViewProjection * vec4(Position, 1.0);\n"
+            "}\n";
+        const GLchar *FragmentSource =
+            "#version 330\n"
+            "in vec4 FragColor;\n"
+            "out vec4 OutColor;\n"
+            "void main()\n"
+            "{\n"
+            "    OutColor = FragColor;\n"
+            "}\n";
+        GLuint VertexShader = glCreateShader(GL_VERTEX_SHADER);
+        GLuint FragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(VertexShader, 1, &VertexSource, 0);
+        glShaderSource(FragmentShader, 1, &FragmentSource, 0);
+        glCompileShader(VertexShader);
+        glCompileShader(FragmentShader);
+        Lines.Program = glCreateProgram();
+        glAttachShader(Lines.Program, VertexShader);
+        glAttachShader(Lines.Program, FragmentShader);
+        glLinkProgram(Lines.Program);
+        glDeleteShader(VertexShader);
+        glDeleteShader(FragmentShader);
+        Lines.ViewProjectionLocation = glGetUniformLocation(Lines.Program, "ViewProjection");
+        
+        glGenVertexArrays(1, &Lines.VAO);
+        SetGLVertexArray(Lines.VAO);
+        SetGLBuffer(GL_ARRAY_BUFFER, Lines.Stream.Buffer);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(gl_debug_line_vertex), 0);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(gl_debug_line_vertex), (GLvoid *)offsetof(gl_debug_line_vertex, Color));
+        SetGLVertexArray(0);
+        SetGLBuffer(GL_ARRAY_BUFFER, 0);
+        return Lines;
+    }
+    
+    inline void
+        DestroyDebugLines(gl_debug_lines *Lines)
+    {
+        DeleteGLVertexArrays(1, &Lines->VAO);
+        DeleteGLProgram(Lines->Program);
+        DestroyStreamBuffer(&Lines->Stream);
+        *Lines = {};
+    }
+    
+    // lines are written into the stream buffer as they are pushed
+    inline void
+        BeginDebugLines(gl_debug_lines *Lines)
+    {
+        BeginStreamFrame(&Lines->Stream);
+        u32 Available = Lines->Stream.End - Lines->Stream.Head;
+        Lines->Write = AllocateStream(&Lines->Stream, Available / sizeof(gl_debug_line_vertex) * sizeof(gl_debug_line_vertex),
+                                      sizeof(gl_debug_line_vertex));
+        Lines->VertexCount = 0;
+        Lines->VertexCapacity = Lines->Write.Size / sizeof(gl_debug_line_vertex);
+    }
+    
+    template <typename vec3>
+    inline void
+        PushDebugLine(gl_debug_lines *Lines, vec3 A, vec3 B, u32 Color)
+    {
+        if (Lines->VertexCount + 2 > Lines->VertexCapacity)
+        {
+            ++Lines->DroppedCount;
+            return;
+        }
+        gl_debug_line_vertex *Vertex = (gl_debug_line_vertex *)Lines->Write.Data + Lines->VertexCount;
+        gl_debug_line_vertex VertexA = {{A.X, A.Y, A.Z}, Color};
+        gl_debug_line_vertex VertexB = {{B.X, B.Y, B.Z}, Color};
+        Vertex[0] = VertexA;
+        Vertex[1] = VertexB;
+        Lines->VertexCount += 2;
+    }
+    
+    // ViewProjection is row major, 16 floats
+    inline void
+        DrawDebugLines(gl_debug_lines *Lines, const f32 *ViewProjection)
+    {
+        CommitStream(&Lines->Stream, &Lines->Write, Lines->VertexCount * sizeof(gl_debug_line_vertex));
+        if (Lines->VertexCount)
+        {
+            SetGLProgram(Lines->Program);
+            glUniformMatrix4fv(Lines->ViewProjectionLocation, 1, GL_TRUE, ViewProjection);
+            SetGLVertexArray(Lines->VAO);
+            glDrawArrays(GL_LINES, GLint(Lines->Write.Offset / sizeof(gl_debug_line_vertex)), GLsizei(Lines->VertexCount));
+            SetGLVertexArray(0);
+        }
+        EndStreamFrame(&Lines->Stream);
+        Lines->Write = {};
+        Lines->VertexCount = 0;
+        Lines->VertexCapacity = 0;
+    }
+};
\ No newline at end of file
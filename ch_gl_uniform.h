@@ -0,0 +1,481 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// after linking, reflects every active uniform once (glGetActiveUniform)
+ch::gl_uniform_cache *Uniforms = ch::GetUniformCache(Program);
+ch::gl_uniform<mat4> Model = ch::GetUniform<mat4>(Uniforms, "Model");     // invalid if missing or not mat4 sized
+ch::gl_uniform<v3> Lights = ch::GetUniform<v3>(Uniforms, "LightPositions"); // vec3 LightPositions[4], not "LightPositions[2]"
+
+// per draw, values are only remembered until the flush
+ch::SetUniform(Uniforms, Model, ModelMatrix);
+ch::SetUniformArray(Uniforms, Lights, Positions, 4);
+glUseProgram(Program);
+ch::FlushUniforms(Uniforms); // a glUniform* per uniform that changed
+glDrawElements(...);
+
+// after relinking a program
+ch::ResetUniformCache(Program);
+
+// deleting through the registry, a new program that gets the same name starts clean
+ch::DeleteGLProgram(Program);
+
+// a location without a glGetUniformLocation, from the program's cache. kernel.h's
+// glUpload* don't use it, they ask the driver so they can't go stale
+GLint Location = ch::GetUniformLocation(Program, "Model");
+
+Caching:
+
+glGetUniformLocation is a string lookup in the driver. The cache asks for every
+active uniform of the default block once and answers lookups from an open
+addressed table keyed by a hash of the name, "Name[3]" included (array element
+locations are consecutive, GL 4.3). Block members have no location and are
+skipped, they go through buffers.
+
+Caches are per program name, and GL reuses the names of deleted programs.
+DeleteGLProgram drops the cache and ch_gl_state.h's binding with the program,
+and ch_gl_program.h drops whatever cache a name it gets back from glCreateProgram
+still had. A program deleted with glDeleteProgram and recreated some other way
+needs ResetUniformCache, or the cache answers with the old program's locations.
+Program 0 has no cache.
+
+Uploads:
+
+A cache keeps the last value set for every uniform. Setting the same value again
+does nothing, a new value marks the uniform dirty and FlushUniforms uploads what
+is dirty to the bound program. Values set since the last flush overwrite each
+other, so a uniform set three times between draws costs one glUniform call.
+Handles are typed by the C++ type set through them, its size has to match the
+GLSL type (v3 for vec3, mat4 for mat4, i32 for samplers and bools...). A handle
+is a whole uniform, arrays are set from their first element, so a name with an
+element index past [0] gives an invalid handle. Matrices
+go up transposed like glUploadMatrix4 does, kernel.h's and ch_math's matrices
+are row major. Everything here runs on the GL thread.
+*/
+
+#include "ch_gl.h"
+#include "ch_gl_state.h"
+#include "ch_hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace ch
+{
+    //
+    //
+    // reflection
+    
+    struct gl_uniform_info
+    {
+        const char *Name; // in gl_uniform_cache::Names, "[0]" stripped from arrays
+        u32 NameHash;
+        GLint Location;
+        GLenum Type;
+        i32 Count;         // array elements, 1 for everything else
+        u32 ElementSize;   // bytes
+        u32 Offset;        // into gl_uniform_cache::Values
+        i32 KnownElements; // leading elements whose value in the program is in Values
+        i32 DirtyElements; // leading elements to upload at the next flush
+    };
+    
+    struct gl_uniform_cache
+    {
+        GLuint Program;
+        gl_uniform_info *Uniforms;
+        int UniformCount;
+        char *Names;
+        int *Slots;   // Uniforms index + 1 by NameHash, 0 is empty
+        u32 SlotMask; // slot count - 1, a power of 2
+        u8 *Values;
+        int *DirtyList;
+        int DirtyCount;
+        GLboolean TransposeMatrices; // GL_TRUE, set it to GL_FALSE for column major matrices
+        
+        u64 UploadCount; // glUniform* calls made by flushes
+        u64 ElidedCount; // sets that didn't change a value
+    };
+    
+    template <typename T>
+    struct gl_uniform
+    {
+        int Index; // into gl_uniform_cache::Uniforms, -1 when the uniform doesn't exist
+    };
+    
+    // ch_hash.h's, like every other key
+    inline u32
+        HashUniformName(const char *Name, size_t Length)
+    {
+        return u32(HashBytes64(Name, Length));
+    }
+    
+    // bytes of one element as glUniform*v takes it
+    inline u32
+        GetUniformElementSize(GLenum Type)
+    {
+        switch (Type)
+        {
+            case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL: return 4;
+            case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: case GL_DOUBLE: return 8;
+            case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 12;
+            case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: case GL_FLOAT_MAT2: case GL_DOUBLE_VEC2: return 16;
+            case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: case GL_DOUBLE_VEC3: return 24;
+            case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: case GL_DOUBLE_VEC4: case GL_DOUBLE_MAT2: return 32;
+            case GL_FLOAT_MAT3: return 36;
+            case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: return 48;
+            case GL_FLOAT_MAT4: return 64;
+            case GL_DOUBLE_MAT3: return 72;
+            case GL_DOUBLE_MAT4: return 128;
+        }
+        return 4; // samplers and images, set like an int
+    }
+    
+    inline void
+        FreeUniformCache(gl_uniform_cache *Cache)
+    {
+        if (!Cache) return;
+        free(Cache->Uniforms);
+        free(Cache->Names);
+        free(Cache->Slots);
+        free(Cache->Values);
+        free(Cache->DirtyList);
+        free(Cache);
+    }
+    
+    // program has to be linked
+    inline gl_uniform_cache *
+        BuildUniformCache(GLuint Program)
+    {
+        gl_uniform_cache *Cache = (gl_uniform_cache *)calloc(1, sizeof(gl_uniform_cache));
+        Cache->Program = Program;
+        Cache->TransposeMatrices = GL_TRUE;
+        
+        GLint ActiveCount = 0, MaxLength = 0;
+        glGetProgramiv(Program, GL_ACTIVE_UNIFORMS, &ActiveCount);
+        glGetProgramiv(Program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &MaxLength);
+        if (ActiveCount <= 0)
+        {
+            return Cache;
+        }
+        if (MaxLength < 1) MaxLength = 1;
+        
+        Cache->Uniforms = (gl_uniform_info *)calloc(size_t(ActiveCount), sizeof(gl_uniform_info));
+        Cache->Names = (char *)malloc(size_t(ActiveCount) * size_t(MaxLength));
+        Cache->DirtyList = (int *)malloc(sizeof(int) * size_t(ActiveCount));
+        u32 ValueSize = 0;
+        char *NameAt = Cache->Names;
+        for (GLint ActiveI = 0; ActiveI < ActiveCount; ++ActiveI)
+        {
+            GLsizei Length = 0;
+            GLint Size = 0;
+            GLenum Type = 0;
+            glGetActiveUniform(Program, GLuint(ActiveI), MaxLength, &Length, &Size, &Type, NameAt);
+            if (Length > 3 && strcmp(NameAt + Length - 3, "[0]") == 0)
+            {
+                Length -= 3;
+                NameAt[Length] = 0;
+            }
+            
+            // block members and built-ins (gl_*) have no location
+            GLint Location = glGetUniformLocation(Program, NameAt);
+            if (Location < 0)
+            {
+                continue;
+            }
+            
+            gl_uniform_info *Info = &Cache->Uniforms[Cache->UniformCount++];
+            Info->Name = NameAt;
+            Info->NameHash = HashUniformName(NameAt, size_t(Length));
+            Info->Location = Location;
+            Info->Type = Type;
+            Info->Count = Size > 0? Size: 1;
+            Info->ElementSize = GetUniformElementSize(Type);
+            Info->Offset = ValueSize;
+            ValueSize += Info->ElementSize * u32(Info->Count);
+            NameAt += Length + 1;
+        }
+        Cache->Values = (u8 *)calloc(ValueSize? ValueSize: 1, 1);
+        
+        // at most half full
+        u32 SlotCount = 8;
+        while (SlotCount < u32(Cache->UniformCount) * 2) SlotCount *= 2;
+        Cache->Slots = (int *)calloc(SlotCount, sizeof(int));
+        Cache->SlotMask = SlotCount - 1;
+        for (int I = 0; I < Cache->UniformCount; ++I)
+        {
+            u32 Slot = Cache->Uniforms[I].NameHash & Cache->SlotMask;
+            while (Cache->Slots[Slot]) Slot = (Slot + 1) & Cache->SlotMask;
+            Cache->Slots[Slot] = I + 1;
+        }
+        return Cache;
+    }
+    
+    // -1 if it's not an active uniform, Element is set for "Name[3]"
+    inline int
+        FindUniformIndex(const gl_uniform_cache *Cache, const char *Name, int *Element = 0)
+    {
+        size_t Length = strlen(Name);
+        int ElementIndex = 0;
+        if (Length > 3 && Name[Length - 1] == ']')
+        {
+            size_t Open = Length - 2;
+            while (Open > 0 && Name[Open] >= '0' && Name[Open] <= '9') --Open;
+            if (Name[Open] == '[' && Open + 2 < Length)
+            {
+                ElementIndex = atoi(Name + Open + 1);
+                Length = Open;
+            }
+        }
+        
+        if (!Cache->Slots) return -1;
+        u32 Hash = HashUniformName(Name, Length);
+        for (u32 Slot = Hash & Cache->SlotMask; Cache->Slots[Slot]; Slot = (Slot + 1) & Cache->SlotMask)
+        {
+            int I = Cache->Slots[Slot] - 1;
+            const gl_uniform_info *Info = &Cache->Uniforms[I];
+            if (Info->NameHash == Hash && strncmp(Info->Name, Name, Length) == 0 && Info->Name[Length] == 0)
+            {
+                if (ElementIndex >= Info->Count) return -1;
+                if (Element) *Element = ElementIndex;
+                return I;
+            }
+        }
+        return -1;
+    }
+    
+    inline GLint
+        GetUniformLocation(const gl_uniform_cache *Cache, const char *Name)
+    {
+        int Element = 0;
+        int Index = FindUniformIndex(Cache, Name, &Element);
+        return Index < 0? -1: Cache->Uniforms[Index].Location + Element;
+    }
+    
+    //
+    //
+    // per-program registry
+    
+    struct gl_uniform_registry
+    {
+        GLuint *Programs; // 0 is an empty slot, reset programs keep theirs
+        gl_uniform_cache **Caches;
+        u32 Capacity;     // power of 2
+        u32 Used;
+    };
+    
+    inline gl_uniform_registry *
+        GetUniformRegistry()
+    {
+        static gl_uniform_registry Registry;
+        return &Registry;
+    }
+    
+    inline u32
+        FindUniformRegistrySlot(gl_uniform_registry *Registry, GLuint Program)
+    {
+        u32 Mask = Registry->Capacity - 1;
+        u32 Slot = (Program * 2654435761u) & Mask;
+        while (Registry->Programs[Slot] && Registry->Programs[Slot] != Program)
+        {
+            Slot = (Slot + 1) & Mask;
+        }
+        return Slot;
+    }
+    
+    // built on first use, 0 for program 0 (the registry's empty slot)
+    inline gl_uniform_cache *
+        GetUniformCache(GLuint Program)
+    {
+        if (!Program) return 0;
+        gl_uniform_registry *Registry = GetUniformRegistry();
+        if ((Registry->Used + 1) * 2 > Registry->Capacity)
+        {
+            gl_uniform_registry Grown = {};
+            Grown.Capacity = Registry->Capacity? Registry->Capacity * 2: 64;
+            Grown.Programs = (GLuint *)calloc(Grown.Capacity, sizeof(GLuint));
+            Grown.Caches = (gl_uniform_cache **)calloc(Grown.Capacity, sizeof(gl_uniform_cache *));
+            for (u32 I = 0; I < Registry->Capacity; ++I)
+            {
+                if (!Registry->Programs[I]) continue;
+                u32 Slot = FindUniformRegistrySlot(&Grown, Registry->Programs[I]);
+                Grown.Programs[Slot] = Registry->Programs[I];
+                Grown.Caches[Slot] = Registry->Caches[I];
+                ++Grown.Used;
+            }
+            free(Registry->Programs);
+            free(Registry->Caches);
+            *Registry = Grown;
+        }
+        
+        u32 Slot = FindUniformRegistrySlot(Registry, Program);
+        if (!Registry->Programs[Slot])
+        {
+            Registry->Programs[Slot] = Program;
+            ++Registry->Used;
+        }
+        if (!Registry->Caches[Slot])
+        {
+            Registry->Caches[Slot] = BuildUniformCache(Program);
+        }
+        return Registry->Caches[Slot];
+    }
+    
+    // the program was relinked or deleted, its cache is rebuilt on next use
+    inline void
+        ResetUniformCache(GLuint Program)
+    {
+        gl_uniform_registry *Registry = GetUniformRegistry();
+        if (!Registry->Capacity) return;
+        u32 Slot = FindUniformRegistrySlot(Registry, Program);
+        FreeUniformCache(Registry->Caches[Slot]);
+        Registry->Caches[Slot] = 0;
+    }
+    
+    // its name may come back from glCreateProgram, the cache goes with it. A bound
+    // program stays in use until the next glUseProgram, which has to reach the driver
+    inline void
+        DeleteGLProgram(GLuint Program)
+    {
+        ResetUniformCache(Program);
+        gl_state *State = &GetGLStateCache()->State;
+        if (State->Program == Program) State->Program = GL_STATE_UNKNOWN;
+        glDeleteProgram(Program);
+    }
+    
+    inline GLint
+        GetUniformLocation(GLuint Program, const char *Name)
+    {
+        gl_uniform_cache *Cache = GetUniformCache(Program);
+        return Cache? GetUniformLocation(Cache, Name): -1;
+    }
+    
+    //
+    //
+    // typed handles and dirty tracked uploads
+    
+    template <typename T>
+    inline gl_uniform<T>
+        GetUniform(const gl_uniform_cache *Cache, const char *Name)
+    {
+        int Element = 0;
+        gl_uniform<T> Handle = {FindUniformIndex(Cache, Name, &Element)};
+        
+        // a handle sets the array from its first element, "Lights[2]" would set Lights[0]
+        if (Handle.Index >= 0 && (Element != 0 || Cache->Uniforms[Handle.Index].ElementSize != sizeof(T)))
+        {
+            Handle.Index = -1;
+        }
+        return Handle;
+    }
+    
+    template <typename T>
+    inline bool
+        IsValid(gl_uniform<T> Handle)
+    {
+        return Handle.Index >= 0;
+    }
+    
+    // Count elements from the first
+    inline void
+        SetUniformData(gl_uniform_cache *Cache, int Index, const void *Data, int Count)
+    {
+        if (Index < 0) return;
+        gl_uniform_info *Info = &Cache->Uniforms[Index];
+        if (Count > Info->Count) Count = Info->Count;
+        if (Count <= 0) return;
+        
+        size_t Size = size_t(Info->ElementSize) * size_t(Count);
+        u8 *Value = Cache->Values + Info->Offset;
+        if (Count <= Info->KnownElements && memcmp(Value, Data, Size) == 0)
+        {
+            ++Cache->ElidedCount;
+            return;
+        }
+        memcpy(Value, Data, Size);
+        if (!Info->DirtyElements)
+        {
+            Cache->DirtyList[Cache->DirtyCount++] = Index;
+        }
+        if (Count > Info->DirtyElements) Info->DirtyElements = Count;
+    }
+    
+    template <typename T>
+    inline void
+        SetUniform(gl_uniform_cache *Cache, gl_uniform<T> Handle, const T &Value)
+    {
+        SetUniformData(Cache, Handle.Index, &Value, 1);
+    }
+    
+    template <typename T>
+    inline void
+        SetUniformArray(gl_uniform_cache *Cache, gl_uniform<T> Handle, const T *Values, int Count)
+    {
+        SetUniformData(Cache, Handle.Index, Values, Count);
+    }
+    
+    inline void
+        UploadUniform(const gl_uniform_info *Info, const void *Data, int Count, GLboolean Transpose)
+    {
+        GLint L = Info->Location;
+        const GLfloat *F = (const GLfloat *)Data;
+        const GLint *I = (const GLint *)Data;
+        const GLuint *U = (const GLuint *)Data;
+        const GLdouble *D = (const GLdouble *)Data;
+        switch (Info->Type)
+        {
+            case GL_FLOAT: glUniform1fv(L, Count, F); break;
+            case GL_FLOAT_VEC2: glUniform2fv(L, Count, F); break;
+            case GL_FLOAT_VEC3: glUniform3fv(L, Count, F); break;
+            case GL_FLOAT_VEC4: glUniform4fv(L, Count, F); break;
+            case GL_INT_VEC2: case GL_BOOL_VEC2: glUniform2iv(L, Count, I); break;
+            case GL_INT_VEC3: case GL_BOOL_VEC3: glUniform3iv(L, Count, I); break;
+            case GL_INT_VEC4: case GL_BOOL_VEC4: glUniform4iv(L, Count, I); break;
+            case GL_UNSIGNED_INT: glUniform1uiv(L, Count, U); break;
+            case GL_UNSIGNED_INT_VEC2: glUniform2uiv(L, Count, U); break;
+            case GL_UNSIGNED_INT_VEC3: glUniform3uiv(L, Count, U); break;
+            case GL_UNSIGNED_INT_VEC4: glUniform4uiv(L, Count, U); break;
+            case GL_DOUBLE: glUniform1dv(L, Count, D); break;
+            case GL_DOUBLE_VEC2: glUniform2dv(L, Count, D); break;
+            case GL_DOUBLE_VEC3: glUniform3dv(L, Count, D); break;
+            case GL_DOUBLE_VEC4: glUniform4dv(L, Count, D); break;
+            case GL_FLOAT_MAT2: glUniformMatrix2fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT3: glUniformMatrix3fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT2x3: glUniformMatrix2x3fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT3x2: glUniformMatrix3x2fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT2x4: glUniformMatrix2x4fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT4x2: glUniformMatrix4x2fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT3x4: glUniformMatrix3x4fv(L, Count, Transpose, F); break;
+            case GL_FLOAT_MAT4x3: glUniformMatrix4x3fv(L, Count, Transpose, F); break;
+            case GL_DOUBLE_MAT2: glUniformMatrix2dv(L, Count, Transpose, D); break;
+            case GL_DOUBLE_MAT3: glUniformMatrix3dv(L, Count, Transpose, D); break;
+            case GL_DOUBLE_MAT4: glUniformMatrix4dv(L, Count, Transpose, D); break;
+            default: glUniform1iv(L, Count, I); break; // int, bool, samplers and images
+        }
+    }
+    
+    // uploads what changed to Cache's program, which has to be bound
+    inline void
+        FlushUniforms(gl_uniform_cache *Cache)
+    {
+        for (int DirtyI = 0; DirtyI < Cache->DirtyCount; ++DirtyI)
+        {
+            gl_uniform_info *Info = &Cache->Uniforms[Cache->DirtyList[DirtyI]];
+            UploadUniform(Info, Cache->Values + Info->Offset, Info->DirtyElements, Cache->TransposeMatrices);
+            if (Info->DirtyElements > Info->KnownElements) Info->KnownElements = Info->DirtyElements;
+            Info->DirtyElements = 0;
+            ++Cache->UploadCount;
+        }
+        Cache->DirtyCount = 0;
+    }
+    
+    // the program's values were changed behind the cache's back, every set uploads again
+    inline void
+        ForgetUniformValues(gl_uniform_cache *Cache)
+    {
+        for (int I = 0; I < Cache->UniformCount; ++I)
+        {
+            Cache->Uniforms[I].KnownElements = 0;
+        }
+    }
+};
\ No newline at end of file
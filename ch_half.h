@@ -0,0 +1,208 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+u16 *Halves = ...;
+ch::PackHalf(Halves, Floats, Count);
+ch::UnpackHalf(Floats, Halves, Count);
+
+u16 One = ch::F32ToF16(1.0f); // 0x3C00, one at a time
+
+Format:
+
+IEEE 754 binary16, round to nearest even, denormals/inf/nan kept. Uses F16C
+when CH_F16C is on, an SSE2 version of the same bit tricks otherwise, 8 values
+per step either way. ch_pack.h's vertex formats and ch_imgproc.h's RGBA16F
+both go through here; this header needs neither ch_math.h nor kernel.h.
+*/
+
+#include "ch_simd.h"
+#include <stdint.h>
+#include <string.h>
+
+// the same as ch_math.h's and kernel.h's, this header goes with either
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef float f32;
+
+namespace ch
+{
+    inline u32
+        AsU32(f32 Value)
+    {
+        u32 Result;
+        memcpy(&Result, &Value, 4);
+        return Result;
+    }
+    
+    inline f32
+        AsF32(u32 Value)
+    {
+        f32 Result;
+        memcpy(&Result, &Value, 4);
+        return Result;
+    }
+    
+    inline u16
+        F32ToF16(f32 Value)
+    {
+        u32 F = AsU32(Value);
+        u32 Sign = F & 0x80000000;
+        F ^= Sign;
+        
+        u32 Result;
+        if (F >= 0x47800000)
+        {
+            // too big for a half: inf, nan stays a (quiet) nan
+            Result = F > 0x7F800000? 0x7E00: 0x7C00;
+        }
+        else if (F < 0x38800000)
+        {
+            //NOTE(chen): denormal or zero, adding 0.5 lines the half mantissa up with
+            //            the float mantissa and lets the FPU do the rounding
+            u32 DenormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+            Result = AsU32(AsF32(F) + AsF32(DenormMagic)) - DenormMagic;
+        }
+        else
+        {
+            u32 MantissaOdd = (F >> 13) & 1;
+            F += (u32(15 - 127) << 23) + 0xFFF; // rebias exponent, round
+            F += MantissaOdd; // ties to even
+            Result = F >> 13;
+        }
+        return u16(Result | (Sign >> 16));
+    }
+    
+    inline f32
+        F16ToF32(u16 Value)
+    {
+        u32 ShiftedExponent = 0x7C00 << 13;
+        u32 Result = (Value & 0x7FFF) << 13;
+        u32 Exponent = Result & ShiftedExponent;
+        Result += (127 - 15) << 23;
+        
+        if (Exponent == ShiftedExponent)
+        {
+            Result += (128 - 16) << 23; // inf/nan
+        }
+        else if (Exponent == 0)
+        {
+            // denormal, renormalize with the FPU
+            Result += 1 << 23;
+            Result = AsU32(AsF32(Result) - AsF32(113 << 23));
+        }
+        return AsF32(Result | ((Value & 0x8000) << 16));
+    }
+    
+#if CH_SSE2
+    // 4 floats to 4 halves, zero extended in 32-bit lanes
+    inline __m128i
+        F32ToF16SSE2(__m128 Value)
+    {
+        __m128i F = _mm_castps_si128(Value);
+        __m128i Sign = _mm_and_si128(F, _mm_set1_epi32(int(0x80000000)));
+        F = _mm_xor_si128(F, Sign);
+        
+        __m128i DenormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        __m128i Denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(F), _mm_castsi128_ps(DenormMagic))),
+                                       DenormMagic);
+        
+        __m128i MantissaOdd = _mm_and_si128(_mm_srli_epi32(F, 13), _mm_set1_epi32(1));
+        __m128i Normal = _mm_add_epi32(F, _mm_set1_epi32(int(u32(15 - 127) << 23) + 0xFFF));
+        Normal = _mm_srli_epi32(_mm_add_epi32(Normal, MantissaOdd), 13);
+        
+        __m128i IsNan = _mm_cmpgt_epi32(F, _mm_set1_epi32(0x7F800000));
+        __m128i InfNan = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(IsNan, _mm_set1_epi32(0x0200)));
+        
+        // F is positive, so signed compares work
+        __m128i IsDenorm = _mm_cmplt_epi32(F, _mm_set1_epi32(0x38800000));
+        __m128i IsInfNan = _mm_cmpgt_epi32(F, _mm_set1_epi32(0x477FFFFF));
+        __m128i Result = _mm_or_si128(_mm_and_si128(IsDenorm, Denorm), _mm_andnot_si128(IsDenorm, Normal));
+        Result = _mm_or_si128(_mm_and_si128(IsInfNan, InfNan), _mm_andnot_si128(IsInfNan, Result));
+        return _mm_or_si128(Result, _mm_srli_epi32(Sign, 16));
+    }
+    
+    // 4 halves zero extended in 32-bit lanes to 4 floats
+    inline __m128
+        F16ToF32SSE2(__m128i Value)
+    {
+        __m128i ShiftedExponent = _mm_set1_epi32(0x7C00 << 13);
+        __m128i Result = _mm_slli_epi32(_mm_and_si128(Value, _mm_set1_epi32(0x7FFF)), 13);
+        __m128i Exponent = _mm_and_si128(Result, ShiftedExponent);
+        Result = _mm_add_epi32(Result, _mm_set1_epi32((127 - 15) << 23));
+        
+        __m128i IsInfNan = _mm_cmpeq_epi32(Exponent, ShiftedExponent);
+        Result = _mm_add_epi32(Result, _mm_and_si128(IsInfNan, _mm_set1_epi32((128 - 16) << 23)));
+        
+        __m128i IsDenorm = _mm_cmpeq_epi32(Exponent, _mm_setzero_si128());
+        __m128 Denorm = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(Result, _mm_set1_epi32(1 << 23))),
+                                   _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+        Result = _mm_or_si128(_mm_and_si128(IsDenorm, _mm_castps_si128(Denorm)), _mm_andnot_si128(IsDenorm, Result));
+        
+        Result = _mm_or_si128(Result, _mm_slli_epi32(_mm_and_si128(Value, _mm_set1_epi32(0x8000)), 16));
+        return _mm_castsi128_ps(Result);
+    }
+    
+    // 8 32-bit lanes holding 16-bit values to 8 u16
+    inline __m128i
+        Pack32To16SSE2(__m128i Low, __m128i High)
+    {
+        // sign extend so the saturating pack leaves the bits alone
+        Low = _mm_srai_epi32(_mm_slli_epi32(Low, 16), 16);
+        High = _mm_srai_epi32(_mm_slli_epi32(High, 16), 16);
+        return _mm_packs_epi32(Low, High);
+    }
+#endif
+    
+    inline void
+        PackHalf(u16 *Out, f32 *In, int Count)
+    {
+        int I = 0;
+#if CH_F16C
+        for (; I + 8 <= Count; I += 8)
+        {
+            __m128i Low = _mm_cvtps_ph(_mm_loadu_ps(In + I), _MM_FROUND_TO_NEAREST_INT);
+            __m128i High = _mm_cvtps_ph(_mm_loadu_ps(In + I + 4), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128((__m128i *)(Out + I), _mm_unpacklo_epi64(Low, High));
+        }
+#elif CH_SSE2
+        for (; I + 8 <= Count; I += 8)
+        {
+            __m128i Low = F32ToF16SSE2(_mm_loadu_ps(In + I));
+            __m128i High = F32ToF16SSE2(_mm_loadu_ps(In + I + 4));
+            _mm_storeu_si128((__m128i *)(Out + I), Pack32To16SSE2(Low, High));
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            Out[I] = F32ToF16(In[I]);
+        }
+    }
+    
+    inline void
+        UnpackHalf(f32 *Out, u16 *In, int Count)
+    {
+        int I = 0;
+#if CH_F16C
+        for (; I + 8 <= Count; I += 8)
+        {
+            __m128i Halves = _mm_loadu_si128((__m128i *)(In + I));
+            _mm_storeu_ps(Out + I, _mm_cvtph_ps(Halves));
+            _mm_storeu_ps(Out + I + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(Halves, Halves)));
+        }
+#elif CH_SSE2
+        for (; I + 8 <= Count; I += 8)
+        {
+            __m128i Halves = _mm_loadu_si128((__m128i *)(In + I));
+            __m128i Zero = _mm_setzero_si128();
+            _mm_storeu_ps(Out + I, F16ToF32SSE2(_mm_unpacklo_epi16(Halves, Zero)));
+            _mm_storeu_ps(Out + I + 4, F16ToF32SSE2(_mm_unpackhi_epi16(Halves, Zero)));
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            Out[I] = F16ToF32(In[I]);
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+u64 Hash = ch::HashBytes64(Data, Size);          // seed 0
+u64 Both = ch::HashBytes64(More, MoreSize, Hash); // continued from a hash, as the seed
+
+Hash:
+
+xxHash64, so keys are comparable with other tools and it runs at memory speed.
+Every 64-bit key in the library goes through it: ch_texcache.h's entries,
+ch_gl_program.h's binaries and ch_gl_uniform.h's name lookups (the low 32 bits).
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// the same as ch_math.h's and kernel.h's, this header goes with either
+typedef uint8_t u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+namespace ch
+{
+    inline u64
+        RotateLeft64(u64 Value, int Count)
+    {
+        return (Value << Count) | (Value >> (64 - Count));
+    }
+    
+    inline u64
+        ReadU64(const u8 *P)
+    {
+        u64 Value;
+        memcpy(&Value, P, 8);
+        return Value;
+    }
+    
+    // an earlier hash as the Seed chains them, A then B
+    inline u64
+        HashBytes64(const void *Data, size_t Size, u64 Seed = 0)
+    {
+        const u64 P1 = 11400714785074694791ull;
+        const u64 P2 = 14029467366897019727ull;
+        const u64 P3 = 1609587929392839161ull;
+        const u64 P4 = 9650029242287828579ull;
+        const u64 P5 = 2870177450012600261ull;
+        
+        const u8 *P = (const u8 *)Data;
+        const u8 *End = P + Size;
+        u64 Hash;
+        if (Size >= 32)
+        {
+            u64 Lanes[4] = {Seed + P1 + P2, Seed + P2, Seed, Seed - P1};
+            do
+            {
+                for (int I = 0; I < 4; ++I)
+                {
+                    Lanes[I] = RotateLeft64(Lanes[I] + ReadU64(P + 8 * I) * P2, 31) * P1;
+                }
+                P += 32;
+            } while (End - P >= 32);
+            
+            Hash = RotateLeft64(Lanes[0], 1) + RotateLeft64(Lanes[1], 7) + RotateLeft64(Lanes[2], 12) + RotateLeft64(Lanes[3], 18);
+            for (int I = 0; I < 4; ++I)
+            {
+                Hash ^= RotateLeft64(Lanes[I] * P2, 31) * P1;
+                Hash = Hash * P1 + P4;
+            }
+        }
+        else
+        {
+            Hash = Seed + P5;
+        }
+        Hash += Size;
+        
+        for (; End - P >= 8; P += 8)
+        {
+            Hash ^= RotateLeft64(ReadU64(P) * P2, 31) * P1;
+            Hash = RotateLeft64(Hash, 27) * P1 + P4;
+        }
+        if (End - P >= 4)
+        {
+            u32 Value;
+            memcpy(&Value, P, 4);
+            Hash ^= u64(Value) * P1;
+            Hash = RotateLeft64(Hash, 23) * P2 + P3;
+            P += 4;
+        }
+        for (; P < End; ++P)
+        {
+            Hash ^= u64(*P) * P5;
+            Hash = RotateLeft64(Hash, 11) * P1;
+        }
+        
+        Hash ^= Hash >> 33;
+        Hash *= P2;
+        Hash ^= Hash >> 29;
+        Hash *= P3;
+        Hash ^= Hash >> 32;
+        return Hash;
+    }
+};
\ No newline at end of file
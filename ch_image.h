@@ -0,0 +1,2049 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// reading, into a buffer you own (any pitch >= Width * 4)
+size_t FileSize = 0;
+u8 *File = ch::ReadFileData("capture.tga", &FileSize);
+ch::image_info Info = {};
+if (ch::ReadImageInfo(File, FileSize, &Info))
+{
+    ch::image Image = ch::AllocateImage(Info.Width, Info.Height); // 64-byte aligned rows
+    ch::DecodeImage(File, FileSize, Image.Pixels, Image.Pitch);
+    ...
+    ch::FreeImage(&Image);
+}
+free(File);
+
+// or in one go
+ch::image Image = ch::LoadImageFile("capture.bmp"); // Image.Pixels == 0 on failure
+
+// writing, the result is malloc'd
+size_t Size = 0;
+u8 *QOI = ch::EncodeQOI(Image.Pixels, Image.Width, Image.Height, Image.Pitch, 4, &Size);
+u8 *PNG = ch::EncodePNG(Image.Pixels, Image.Width, Image.Height, Image.Pitch, 4, 0, &Size); // 0 = all threads
+ch::WriteFileData("capture.png", PNG, Size);
+free(PNG);
+
+Formats:
+
+read    BMP   uncompressed 8 (palette), 24 and 32-bit (BI_RGB or BI_BITFIELDS),
+              bottom-up and top-down
+        TGA   true color 24/32-bit and 8-bit gray, raw or RLE, either origin
+        PPM   binary P6 and P5 (PGM), any maxval up to 65535
+        QOI   everything
+write   QOI   3 or 4 channels
+        PNG   8-bit RGB or RGBA
+
+Pixels are always RGBA8, bytes R, G, B, A in memory (0xAABBGGRR as a u32),
+rows top to bottom. Channels = 3 on the encoders ignores alpha.
+
+The PNG encoder splits the image into horizontal stripes, one per thread.
+Each stripe is filtered and deflated on its own (dynamic huffman, hash chain
+LZ77) and ends in an empty stored block so the stripes line up on byte
+boundaries and can be concatenated. Stripes can't reference each other, so
+more threads costs a little compression, about as much as zlib's
+Z_FULL_FLUSH would. Every stripe becomes its own IDAT chunk, its CRC and
+Adler-32 are computed on the worker and combined at the end.
+*/
+
+#include "ch_math.h"
+#include "ch_simd.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+// longer chains compress a little better and a lot slower
+#ifndef CH_IMAGE_PNG_MAX_CHAIN
+#define CH_IMAGE_PNG_MAX_CHAIN 16
+#endif
+
+// rows per PNG stripe won't go below this, tiny stripes compress badly
+#ifndef CH_IMAGE_PNG_MIN_STRIPE_ROWS
+#define CH_IMAGE_PNG_MIN_STRIPE_ROWS 32
+#endif
+
+namespace ch
+{
+    enum image_format
+    {
+        ImageFormat_Unknown,
+        ImageFormat_BMP,
+        ImageFormat_TGA,
+        ImageFormat_PPM,
+        ImageFormat_QOI,
+    };
+    
+    struct image_info
+    {
+        image_format Format;
+        int Width;
+        int Height;
+        int Channels; // as stored in the file: 1 gray, 3 rgb, 4 rgba
+    };
+    
+    struct image
+    {
+        u8 *Pixels; // RGBA8
+        int Width;
+        int Height;
+        size_t Pitch; // bytes between rows
+        void *Allocation;
+    };
+    
+    //
+    //
+    // buffers and files
+    
+    // Pitch is rounded up to Alignment, which must be a power of 2
+    inline image
+        AllocateImage(int Width, int Height, size_t Alignment = 64)
+    {
+        image Image = {};
+        if (Width <= 0 || Height <= 0)
+        {
+            return Image;
+        }
+        
+        size_t Pitch = ((size_t)Width * 4 + Alignment - 1) & ~(Alignment - 1);
+        void *Allocation = malloc(Pitch * (size_t)Height + Alignment);
+        if (Allocation)
+        {
+            Image.Pixels = (u8 *)(((uintptr_t)Allocation + Alignment - 1) & ~(uintptr_t)(Alignment - 1));
+            Image.Width = Width;
+            Image.Height = Height;
+            Image.Pitch = Pitch;
+            Image.Allocation = Allocation;
+        }
+        return Image;
+    }
+    
+    inline void
+        FreeImage(image *Image)
+    {
+        free(Image->Allocation);
+        *Image = {};
+    }
+    
+    // malloc'd, 0 on failure
+    inline u8 *
+        ReadFileData(const char *Path, size_t *Size_Out)
+    {
+        u8 *Result = 0;
+        *Size_Out = 0;
+        
+        FILE *File = fopen(Path, "rb");
+        if (File)
+        {
+            fseek(File, 0, SEEK_END);
+            long Size = ftell(File);
+            fseek(File, 0, SEEK_SET);
+            if (Size >= 0)
+            {
+                Result = (u8 *)malloc((size_t)Size + 1);
+                if (Result && fread(Result, 1, (size_t)Size, File) == (size_t)Size)
+                {
+                    *Size_Out = (size_t)Size;
+                }
+                else
+                {
+                    free(Result);
+                    Result = 0;
+                }
+            }
+            fclose(File);
+        }
+        
+        return Result;
+    }
+    
+    inline bool
+        WriteFileData(const char *Path, const void *Data, size_t Size)
+    {
+        bool Result = false;
+        FILE *File = fopen(Path, "wb");
+        if (File)
+        {
+            Result = fwrite(Data, 1, Size, File) == Size;
+            Result = (fclose(File) == 0) && Result;
+        }
+        return Result;
+    }
+    
+    //
+    //
+    // pixel conversion, shared by the readers
+    
+    inline u32
+        ReadU16LE(const u8 *P)
+    {
+        return (u32)P[0] | ((u32)P[1] << 8);
+    }
+    
+    inline u32
+        ReadU32LE(const u8 *P)
+    {
+        return (u32)P[0] | ((u32)P[1] << 8) | ((u32)P[2] << 16) | ((u32)P[3] << 24);
+    }
+    
+    inline u32
+        ReadU32BE(const u8 *P)
+    {
+        return ((u32)P[0] << 24) | ((u32)P[1] << 16) | ((u32)P[2] << 8) | (u32)P[3];
+    }
+    
+    inline void
+        WriteU32BE(u8 *P, u32 Value)
+    {
+        P[0] = (u8)(Value >> 24);
+        P[1] = (u8)(Value >> 16);
+        P[2] = (u8)(Value >> 8);
+        P[3] = (u8)Value;
+    }
+    
+    // 4 bytes per pixel in, RGBA out, SwapRB for BGRA sources
+    inline void
+        CopyPixels32(u8 *Dest, const u8 *Src, int Count, bool SwapRB)
+    {
+        if (!SwapRB)
+        {
+            memcpy(Dest, Src, (size_t)Count * 4);
+            return;
+        }
+        
+        int I = 0;
+#if CH_SSSE3
+        __m128i Swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        for (; I + 4 <= Count; I += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((const __m128i *)(Src + 4 * I));
+            _mm_storeu_si128((__m128i *)(Dest + 4 * I), _mm_shuffle_epi8(Pixels, Swizzle));
+        }
+#elif CH_SSE2
+        __m128i KeepMask = _mm_set1_epi32((int)0xFF00FF00);
+        __m128i LowByte = _mm_set1_epi32(0xFF);
+        for (; I + 4 <= Count; I += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((const __m128i *)(Src + 4 * I));
+            __m128i Swapped = _mm_or_si128(_mm_and_si128(Pixels, KeepMask),
+                                           _mm_or_si128(_mm_and_si128(_mm_srli_epi32(Pixels, 16), LowByte),
+                                                        _mm_slli_epi32(_mm_and_si128(Pixels, LowByte), 16)));
+            _mm_storeu_si128((__m128i *)(Dest + 4 * I), Swapped);
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            Dest[4*I + 0] = Src[4*I + 2];
+            Dest[4*I + 1] = Src[4*I + 1];
+            Dest[4*I + 2] = Src[4*I + 0];
+            Dest[4*I + 3] = Src[4*I + 3];
+        }
+    }
+    
+    // 3 bytes per pixel in, RGBA out with alpha = 255, SwapRB for BGR sources
+    inline void
+        ExpandPixels24(u8 *Dest, const u8 *Src, int Count, bool SwapRB)
+    {
+        int I = 0;
+#if CH_SSSE3
+        //NOTE(chen): each load takes 16 bytes but only uses 12, the loop stops early
+        //            enough that the last load can't read past the row
+        __m128i Expand = (SwapRB?
+                          _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1):
+                          _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+        __m128i Alpha = _mm_set1_epi32((int)0xFF000000);
+        for (; I + 6 <= Count; I += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((const __m128i *)(Src + 3 * I));
+            _mm_storeu_si128((__m128i *)(Dest + 4 * I), _mm_or_si128(_mm_shuffle_epi8(Pixels, Expand), Alpha));
+        }
+#endif
+        int R = SwapRB? 2: 0;
+        int B = SwapRB? 0: 2;
+        for (; I < Count; ++I)
+        {
+            Dest[4*I + 0] = Src[3*I + R];
+            Dest[4*I + 1] = Src[3*I + 1];
+            Dest[4*I + 2] = Src[3*I + B];
+            Dest[4*I + 3] = 255;
+        }
+    }
+    
+    inline void
+        ExpandPixels8(u8 *Dest, const u8 *Src, int Count)
+    {
+        for (int I = 0; I < Count; ++I)
+        {
+            u32 Gray = Src[I];
+            u32 Pixel = Gray | (Gray << 8) | (Gray << 16) | 0xFF000000;
+            memcpy(Dest + 4 * I, &Pixel, 4);
+        }
+    }
+    
+    //
+    //
+    // BMP
+    
+    struct bmp_layout
+    {
+        int Width;
+        int Height;
+        bool TopDown;
+        int BitCount;
+        u32 Compression;
+        u32 DataOffset;
+        u32 RowStride;
+        u32 Masks[4]; // r, g, b, a for BI_BITFIELDS
+        const u8 *Palette; // BGRX
+        u32 PaletteCount;
+    };
+    
+    inline bool
+        ParseBMP(const u8 *Data, size_t Size, bmp_layout *Layout)
+    {
+        if (Size < 54 || Data[0] != 'B' || Data[1] != 'M')
+        {
+            return false;
+        }
+        
+        bmp_layout L = {};
+        L.DataOffset = ReadU32LE(Data + 10);
+        u32 HeaderSize = ReadU32LE(Data + 14);
+        if (HeaderSize < 40 || 14 + (u64)HeaderSize > Size)
+        {
+            return false;
+        }
+        
+        i32 Width = (i32)ReadU32LE(Data + 18);
+        i32 Height = (i32)ReadU32LE(Data + 22);
+        L.BitCount = (int)ReadU16LE(Data + 28);
+        L.Compression = ReadU32LE(Data + 30);
+        if (Width <= 0 || Height == 0 || Height == INT32_MIN)
+        {
+            return false;
+        }
+        L.Width = Width;
+        L.TopDown = Height < 0;
+        L.Height = Height < 0? -Height: Height;
+        
+        bool Supported = ((L.Compression == 0 && (L.BitCount == 8 || L.BitCount == 24 || L.BitCount == 32)) ||
+                          (L.Compression == 3 && L.BitCount == 32));
+        if (!Supported)
+        {
+            return false;
+        }
+        
+        if (L.Compression == 3)
+        {
+            // masks follow a 40-byte header, or are part of a v4/v5 one
+            if (14 + 40 + 16 > Size)
+            {
+                return false;
+            }
+            for (int I = 0; I < 4; ++I)
+            {
+                L.Masks[I] = ReadU32LE(Data + 54 + 4 * I);
+            }
+            if (HeaderSize == 40)
+            {
+                L.Masks[3] = 0; // only 3 masks follow a plain info header
+            }
+        }
+        
+        if (L.BitCount == 8)
+        {
+            u32 ColorsUsed = ReadU32LE(Data + 46);
+            L.PaletteCount = ColorsUsed? ColorsUsed: 256;
+            u64 PaletteOffset = 14 + (u64)HeaderSize;
+            if (L.PaletteCount > 256 || PaletteOffset + 4 * (u64)L.PaletteCount > Size)
+            {
+                return false;
+            }
+            L.Palette = Data + PaletteOffset;
+        }
+        
+        u64 RowStride = ((u64)L.Width * (u64)L.BitCount / 8 + 3) & ~(u64)3;
+        if ((u64)L.DataOffset + RowStride * (u64)L.Height > Size)
+        {
+            return false;
+        }
+        
+        L.RowStride = (u32)RowStride;
+        *Layout = L;
+        return true;
+    }
+    
+    inline u32
+        ExtractMasked(u32 Pixel, u32 Mask)
+    {
+        if (!Mask)
+        {
+            return 255;
+        }
+        
+        int Shift = 0;
+        while (!((Mask >> Shift) & 1)) ++Shift;
+        u32 Value = (Pixel & Mask) >> Shift;
+        u32 Max = Mask >> Shift;
+        return Max == 255? Value: (Value * 255 + Max / 2) / Max;
+    }
+    
+    inline bool
+        DecodeBMP(const u8 *Data, size_t Size, u8 *Pixels, size_t Pitch)
+    {
+        bmp_layout L;
+        if (!ParseBMP(Data, Size, &L))
+        {
+            return false;
+        }
+        
+        bool StandardMasks = (L.Compression == 0 ||
+                              (L.Masks[0] == 0x00FF0000 && L.Masks[1] == 0x0000FF00 && L.Masks[2] == 0x000000FF &&
+                               (L.Masks[3] == 0xFF000000 || L.Masks[3] == 0)));
+        
+        u32 AlphaOr = 0;
+        for (int Y = 0; Y < L.Height; ++Y)
+        {
+            const u8 *Src = Data + L.DataOffset + (size_t)L.RowStride * (L.TopDown? Y: L.Height - 1 - Y);
+            u8 *Dest = Pixels + Pitch * Y;
+            
+            if (L.BitCount == 24)
+            {
+                ExpandPixels24(Dest, Src, L.Width, true);
+            }
+            else if (L.BitCount == 8)
+            {
+                for (int X = 0; X < L.Width; ++X)
+                {
+                    u32 Index = Src[X] < L.PaletteCount? Src[X]: 0;
+                    const u8 *Color = L.Palette + 4 * Index;
+                    Dest[4*X + 0] = Color[2];
+                    Dest[4*X + 1] = Color[1];
+                    Dest[4*X + 2] = Color[0];
+                    Dest[4*X + 3] = 255;
+                }
+            }
+            else if (StandardMasks)
+            {
+                CopyPixels32(Dest, Src, L.Width, true);
+                if (L.Compression == 3 && L.Masks[3] == 0)
+                {
+                    for (int X = 0; X < L.Width; ++X) Dest[4*X + 3] = 255;
+                }
+                for (int X = 0; X < L.Width; ++X) AlphaOr |= Dest[4*X + 3];
+            }
+            else
+            {
+                for (int X = 0; X < L.Width; ++X)
+                {
+                    u32 Pixel = ReadU32LE(Src + 4 * X);
+                    Dest[4*X + 0] = (u8)ExtractMasked(Pixel, L.Masks[0]);
+                    Dest[4*X + 1] = (u8)ExtractMasked(Pixel, L.Masks[1]);
+                    Dest[4*X + 2] = (u8)ExtractMasked(Pixel, L.Masks[2]);
+                    Dest[4*X + 3] = (u8)ExtractMasked(Pixel, L.Masks[3]);
+                }
+                AlphaOr = 255;
+            }
+        }
+        
+        //NOTE(chen): the 4th byte of a 32-bit BI_RGB pixel is officially unused, lots
+        //            of writers leave it 0. All zero means there is no alpha.
+        if (L.BitCount == 32 && AlphaOr == 0)
+        {
+            for (int Y = 0; Y < L.Height; ++Y)
+            {
+                u8 *Dest = Pixels + Pitch * Y;
+                for (int X = 0; X < L.Width; ++X) Dest[4*X + 3] = 255;
+            }
+        }
+        
+        return true;
+    }
+    
+    //
+    //
+    // TGA
+    
+    struct tga_layout
+    {
+        int Width;
+        int Height;
+        int ImageType; // 2 color, 3 gray, +8 RLE
+        int BytesPerPixel;
+        bool TopDown;
+        bool RightToLeft;
+        size_t DataOffset;
+    };
+    
+    inline bool
+        ParseTGA(const u8 *Data, size_t Size, tga_layout *Layout)
+    {
+        if (Size < 18)
+        {
+            return false;
+        }
+        
+        tga_layout L = {};
+        u32 IDLength = Data[0];
+        u32 ColorMapType = Data[1];
+        L.ImageType = Data[2];
+        u32 ColorMapLength = ReadU16LE(Data + 5);
+        u32 ColorMapEntryBits = Data[7];
+        L.Width = (int)ReadU16LE(Data + 12);
+        L.Height = (int)ReadU16LE(Data + 14);
+        u32 PixelDepth = Data[16];
+        u32 Descriptor = Data[17];
+        
+        bool Color = L.ImageType == 2 || L.ImageType == 10;
+        bool Gray = L.ImageType == 3 || L.ImageType == 11;
+        if (ColorMapType > 1 || (!Color && !Gray) || L.Width == 0 || L.Height == 0)
+        {
+            return false;
+        }
+        if ((Color && PixelDepth != 24 && PixelDepth != 32) || (Gray && PixelDepth != 8))
+        {
+            return false;
+        }
+        
+        L.BytesPerPixel = (int)PixelDepth / 8;
+        L.TopDown = (Descriptor & 0x20) != 0;
+        L.RightToLeft = (Descriptor & 0x10) != 0;
+        
+        // a color map can be present even when it's not used, skip it
+        L.DataOffset = 18 + IDLength;
+        if (ColorMapType == 1)
+        {
+            L.DataOffset += ColorMapLength * ((ColorMapEntryBits + 7) / 8);
+        }
+        
+        u64 RawSize = (u64)L.Width * (u64)L.Height * (u64)L.BytesPerPixel;
+        bool RLE = L.ImageType >= 9;
+        if (L.DataOffset > Size || (!RLE && L.DataOffset + RawSize > Size))
+        {
+            return false;
+        }
+        
+        *Layout = L;
+        return true;
+    }
+    
+    // a run of Count pixels from Src into RGBA, BytesPerPixel 1, 3 or 4 (BGR/BGRA)
+    inline void
+        ConvertTGAPixels(u8 *Dest, const u8 *Src, int Count, int BytesPerPixel)
+    {
+        if (BytesPerPixel == 4)
+        {
+            CopyPixels32(Dest, Src, Count, true);
+        }
+        else if (BytesPerPixel == 3)
+        {
+            ExpandPixels24(Dest, Src, Count, true);
+        }
+        else
+        {
+            ExpandPixels8(Dest, Src, Count);
+        }
+    }
+    
+    inline bool
+        DecodeTGA(const u8 *Data, size_t Size, u8 *Pixels, size_t Pitch)
+    {
+        tga_layout L;
+        if (!ParseTGA(Data, Size, &L))
+        {
+            return false;
+        }
+        
+        const u8 *Src = Data + L.DataOffset;
+        const u8 *End = Data + Size;
+        int BPP = L.BytesPerPixel;
+        
+        if (L.ImageType < 9)
+        {
+            for (int Y = 0; Y < L.Height; ++Y)
+            {
+                u8 *Dest = Pixels + Pitch * (L.TopDown? Y: L.Height - 1 - Y);
+                ConvertTGAPixels(Dest, Src + (size_t)L.Width * BPP * Y, L.Width, BPP);
+            }
+        }
+        else
+        {
+            // packets can span rows
+            int X = 0;
+            int Y = 0;
+            while (Y < L.Height)
+            {
+                if (Src >= End)
+                {
+                    return false;
+                }
+                
+                u32 Header = *Src++;
+                int Count = (int)(Header & 0x7F) + 1;
+                bool Repeat = (Header & 0x80) != 0;
+                if (End - Src < (Repeat? BPP: Count * BPP))
+                {
+                    return false;
+                }
+                
+                u32 RepeatedPixel = 0;
+                if (Repeat)
+                {
+                    ConvertTGAPixels((u8 *)&RepeatedPixel, Src, 1, BPP);
+                    Src += BPP;
+                }
+                
+                while (Count > 0 && Y < L.Height)
+                {
+                    int RunLength = Count < L.Width - X? Count: L.Width - X;
+                    u8 *Dest = Pixels + Pitch * (L.TopDown? Y: L.Height - 1 - Y) + 4 * X;
+                    if (Repeat)
+                    {
+                        for (int I = 0; I < RunLength; ++I) memcpy(Dest + 4 * I, &RepeatedPixel, 4);
+                    }
+                    else
+                    {
+                        ConvertTGAPixels(Dest, Src, RunLength, BPP);
+                        Src += RunLength * BPP;
+                    }
+                    
+                    Count -= RunLength;
+                    X += RunLength;
+                    if (X == L.Width)
+                    {
+                        X = 0;
+                        ++Y;
+                    }
+                }
+            }
+        }
+        
+        if (L.RightToLeft)
+        {
+            for (int Y = 0; Y < L.Height; ++Y)
+            {
+                u32 *Row = (u32 *)(Pixels + Pitch * Y);
+                for (int A = 0, B = L.Width - 1; A < B; ++A, --B)
+                {
+                    u32 Temp = Row[A];
+                    Row[A] = Row[B];
+                    Row[B] = Temp;
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    //
+    //
+    // PPM
+    
+    struct ppm_layout
+    {
+        int Width;
+        int Height;
+        int Channels;
+        u32 MaxValue;
+        size_t DataOffset;
+    };
+    
+    // skips whitespace and # comments, then reads a decimal number
+    inline bool
+        ReadPPMNumber(const u8 *Data, size_t Size, size_t *At, u32 *Value)
+    {
+        size_t I = *At;
+        for (;;)
+        {
+            if (I >= Size) return false;
+            if (Data[I] == '#')
+            {
+                while (I < Size && Data[I] != '\n') ++I;
+            }
+            else if (Data[I] == ' ' || Data[I] == '\t' || Data[I] == '\n' || Data[I] == '\r')
+            {
+                ++I;
+            }
+            else
+            {
+                break;
+            }
+        }
+        
+        if (Data[I] < '0' || Data[I] > '9')
+        {
+            return false;
+        }
+        
+        u64 Result = 0;
+        while (I < Size && Data[I] >= '0' && Data[I] <= '9')
+        {
+            Result = Result * 10 + (Data[I] - '0');
+            if (Result > 0xFFFFFF) return false;
+            ++I;
+        }
+        
+        *Value = (u32)Result;
+        *At = I;
+        return true;
+    }
+    
+    inline bool
+        ParsePPM(const u8 *Data, size_t Size, ppm_layout *Layout)
+    {
+        if (Size < 3 || Data[0] != 'P' || (Data[1] != '5' && Data[1] != '6'))
+        {
+            return false;
+        }
+        
+        ppm_layout L = {};
+        L.Channels = Data[1] == '6'? 3: 1;
+        
+        size_t At = 2;
+        u32 Width, Height, MaxValue;
+        if (!ReadPPMNumber(Data, Size, &At, &Width) ||
+            !ReadPPMNumber(Data, Size, &At, &Height) ||
+            !ReadPPMNumber(Data, Size, &At, &MaxValue))
+        {
+            return false;
+        }
+        
+        // exactly one whitespace byte before the samples
+        if (At >= Size || Width == 0 || Height == 0 || MaxValue == 0 || MaxValue > 65535)
+        {
+            return false;
+        }
+        
+        L.Width = (int)Width;
+        L.Height = (int)Height;
+        L.MaxValue = MaxValue;
+        L.DataOffset = At + 1;
+        
+        u64 SampleBytes = MaxValue > 255? 2: 1;
+        if (L.DataOffset + (u64)Width * Height * L.Channels * SampleBytes > Size)
+        {
+            return false;
+        }
+        
+        *Layout = L;
+        return true;
+    }
+    
+    inline bool
+        DecodePPM(const u8 *Data, size_t Size, u8 *Pixels, size_t Pitch)
+    {
+        ppm_layout L;
+        if (!ParsePPM(Data, Size, &L))
+        {
+            return false;
+        }
+        
+        const u8 *Src = Data + L.DataOffset;
+        size_t SampleCount = (size_t)L.Width * L.Channels;
+        for (int Y = 0; Y < L.Height; ++Y)
+        {
+            u8 *Dest = Pixels + Pitch * Y;
+            if (L.MaxValue == 255)
+            {
+                const u8 *Row = Src + SampleCount * Y;
+                if (L.Channels == 3)
+                {
+                    ExpandPixels24(Dest, Row, L.Width, false);
+                }
+                else
+                {
+                    ExpandPixels8(Dest, Row, L.Width);
+                }
+            }
+            else
+            {
+                // rescale to 0..255, 16-bit samples are big endian
+                bool Wide = L.MaxValue > 255;
+                const u8 *Row = Src + SampleCount * Y * (Wide? 2: 1);
+                for (int X = 0; X < L.Width; ++X)
+                {
+                    u8 Samples[3] = {};
+                    for (int C = 0; C < L.Channels; ++C)
+                    {
+                        size_t I = (size_t)X * L.Channels + C;
+                        u32 Value = Wide? ((u32)Row[2*I] << 8) | Row[2*I + 1]: Row[I];
+                        if (Value > L.MaxValue) Value = L.MaxValue;
+                        Samples[C] = (u8)((Value * 255 + L.MaxValue / 2) / L.MaxValue);
+                    }
+                    Dest[4*X + 0] = Samples[0];
+                    Dest[4*X + 1] = Samples[L.Channels == 3? 1: 0];
+                    Dest[4*X + 2] = Samples[L.Channels == 3? 2: 0];
+                    Dest[4*X + 3] = 255;
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    //
+    //
+    // QOI
+    
+#define CH_QOI_OP_INDEX 0x00
+#define CH_QOI_OP_DIFF 0x40
+#define CH_QOI_OP_LUMA 0x80
+#define CH_QOI_OP_RUN 0xC0
+#define CH_QOI_OP_RGB 0xFE
+#define CH_QOI_OP_RGBA 0xFF
+    
+    inline u32
+        QOIHash(u32 Pixel)
+    {
+        u32 R = Pixel & 0xFF, G = (Pixel >> 8) & 0xFF, B = (Pixel >> 16) & 0xFF, A = Pixel >> 24;
+        return (R * 3 + G * 5 + B * 7 + A * 11) & 63;
+    }
+    
+    inline bool
+        ParseQOI(const u8 *Data, size_t Size, image_info *Info)
+    {
+        if (Size < 14 + 8 || memcmp(Data, "qoif", 4) != 0)
+        {
+            return false;
+        }
+        
+        u32 Width = ReadU32BE(Data + 4);
+        u32 Height = ReadU32BE(Data + 8);
+        int Channels = Data[12];
+        if (Width == 0 || Height == 0 || Width > 0x7FFFFFFF || Height > 0x7FFFFFFF ||
+            (Channels != 3 && Channels != 4) || (u64)Width * Height > (u64)1 << 36)
+        {
+            return false;
+        }
+        
+        Info->Format = ImageFormat_QOI;
+        Info->Width = (int)Width;
+        Info->Height = (int)Height;
+        Info->Channels = Channels;
+        return true;
+    }
+    
+    // malloc'd
+    inline u8 *
+        EncodeQOI(const u8 *Pixels, int Width, int Height, size_t Pitch, int Channels, size_t *Size_Out)
+    {
+        *Size_Out = 0;
+        if (Width <= 0 || Height <= 0 || (Channels != 3 && Channels != 4))
+        {
+            return 0;
+        }
+        
+        size_t MaxSize = 14 + (size_t)Width * Height * (Channels + 1) + 8;
+        u8 *Result = (u8 *)malloc(MaxSize);
+        if (!Result)
+        {
+            return 0;
+        }
+        
+        u8 *Out = Result;
+        memcpy(Out, "qoif", 4);
+        WriteU32BE(Out + 4, (u32)Width);
+        WriteU32BE(Out + 8, (u32)Height);
+        Out[12] = (u8)Channels;
+        Out[13] = 0; // sRGB with linear alpha
+        Out += 14;
+        
+        u32 Index[64] = {};
+        u32 Previous = 0xFF000000;
+        u32 AlphaMask = Channels == 3? 0xFF000000: 0;
+        int Run = 0;
+        
+        for (int Y = 0; Y < Height; ++Y)
+        {
+            const u8 *Row = Pixels + Pitch * Y;
+            for (int X = 0; X < Width; ++X)
+            {
+                u32 Pixel;
+                memcpy(&Pixel, Row + 4 * X, 4);
+                Pixel |= AlphaMask;
+                
+                if (Pixel == Previous)
+                {
+                    if (++Run == 62)
+                    {
+                        *Out++ = (u8)(CH_QOI_OP_RUN | (Run - 1));
+                        Run = 0;
+                    }
+                    continue;
+                }
+                
+                if (Run > 0)
+                {
+                    *Out++ = (u8)(CH_QOI_OP_RUN | (Run - 1));
+                    Run = 0;
+                }
+                
+                u32 Hash = QOIHash(Pixel);
+                if (Index[Hash] == Pixel)
+                {
+                    *Out++ = (u8)(CH_QOI_OP_INDEX | Hash);
+                }
+                else
+                {
+                    Index[Hash] = Pixel;
+                    if ((Pixel >> 24) == (Previous >> 24))
+                    {
+                        i32 DR = (i8)(u8)(Pixel - Previous);
+                        i32 DG = (i8)(u8)((Pixel >> 8) - (Previous >> 8));
+                        i32 DB = (i8)(u8)((Pixel >> 16) - (Previous >> 16));
+                        i32 DRG = DR - DG;
+                        i32 DBG = DB - DG;
+                        
+                        if (DR >= -2 && DR <= 1 && DG >= -2 && DG <= 1 && DB >= -2 && DB <= 1)
+                        {
+                            *Out++ = (u8)(CH_QOI_OP_DIFF | ((DR + 2) << 4) | ((DG + 2) << 2) | (DB + 2));
+                        }
+                        else if (DG >= -32 && DG <= 31 && DRG >= -8 && DRG <= 7 && DBG >= -8 && DBG <= 7)
+                        {
+                            *Out++ = (u8)(CH_QOI_OP_LUMA | (DG + 32));
+                            *Out++ = (u8)(((DRG + 8) << 4) | (DBG + 8));
+                        }
+                        else
+                        {
+                            Out[0] = CH_QOI_OP_RGB;
+                            Out[1] = (u8)Pixel;
+                            Out[2] = (u8)(Pixel >> 8);
+                            Out[3] = (u8)(Pixel >> 16);
+                            Out += 4;
+                        }
+                    }
+                    else
+                    {
+                        Out[0] = CH_QOI_OP_RGBA;
+                        memcpy(Out + 1, &Pixel, 4);
+                        Out += 5;
+                    }
+                }
+                Previous = Pixel;
+            }
+        }
+        
+        if (Run > 0)
+        {
+            *Out++ = (u8)(CH_QOI_OP_RUN | (Run - 1));
+        }
+        
+        static const u8 Padding[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+        memcpy(Out, Padding, 8);
+        Out += 8;
+        
+        *Size_Out = (size_t)(Out - Result);
+        return Result;
+    }
+    
+    inline bool
+        DecodeQOI(const u8 *Data, size_t Size, u8 *Pixels, size_t Pitch)
+    {
+        image_info Info;
+        if (!ParseQOI(Data, Size, &Info))
+        {
+            return false;
+        }
+        
+        const u8 *In = Data + 14;
+        const u8 *End = Data + Size - 8; // the padding is never part of an op
+        u32 Index[64] = {};
+        u32 Pixel = 0xFF000000;
+        int Run = 0;
+        
+        for (int Y = 0; Y < Info.Height; ++Y)
+        {
+            u8 *Row = Pixels + Pitch * Y;
+            for (int X = 0; X < Info.Width; ++X)
+            {
+                if (Run > 0)
+                {
+                    --Run;
+                }
+                else
+                {
+                    if (In >= End)
+                    {
+                        return false;
+                    }
+                    
+                    u32 Op = *In++;
+                    if (Op == CH_QOI_OP_RGB)
+                    {
+                        if (End - In < 3) return false;
+                        Pixel = (Pixel & 0xFF000000) | In[0] | ((u32)In[1] << 8) | ((u32)In[2] << 16);
+                        In += 3;
+                    }
+                    else if (Op == CH_QOI_OP_RGBA)
+                    {
+                        if (End - In < 4) return false;
+                        Pixel = ReadU32LE(In);
+                        In += 4;
+                    }
+                    else if ((Op & 0xC0) == CH_QOI_OP_INDEX)
+                    {
+                        Pixel = Index[Op];
+                    }
+                    else if ((Op & 0xC0) == CH_QOI_OP_DIFF)
+                    {
+                        u32 R = (Pixel + ((Op >> 4) & 3) - 2) & 0xFF;
+                        u32 G = ((Pixel >> 8) + ((Op >> 2) & 3) - 2) & 0xFF;
+                        u32 B = ((Pixel >> 16) + (Op & 3) - 2) & 0xFF;
+                        Pixel = (Pixel & 0xFF000000) | R | (G << 8) | (B << 16);
+                    }
+                    else if ((Op & 0xC0) == CH_QOI_OP_LUMA)
+                    {
+                        if (In >= End) return false;
+                        u32 Second = *In++;
+                        i32 DG = (i32)(Op & 0x3F) - 32;
+                        i32 DR = DG + (i32)(Second >> 4) - 8;
+                        i32 DB = DG + (i32)(Second & 0xF) - 8;
+                        u32 R = (u32)((i32)(Pixel & 0xFF) + DR) & 0xFF;
+                        u32 G = (u32)((i32)((Pixel >> 8) & 0xFF) + DG) & 0xFF;
+                        u32 B = (u32)((i32)((Pixel >> 16) & 0xFF) + DB) & 0xFF;
+                        Pixel = (Pixel & 0xFF000000) | R | (G << 8) | (B << 16);
+                    }
+                    else
+                    {
+                        Run = (int)(Op & 0x3F);
+                    }
+                    Index[QOIHash(Pixel)] = Pixel;
+                }
+                memcpy(Row + 4 * X, &Pixel, 4);
+            }
+        }
+        
+        return true;
+    }
+    
+    //
+    //
+    // reading, any format
+    
+    inline bool
+        ReadImageInfo(const void *File, size_t Size, image_info *Info)
+    {
+        const u8 *Data = (const u8 *)File;
+        *Info = {};
+        
+        bmp_layout BMP;
+        ppm_layout PPM;
+        tga_layout TGA;
+        if (ParseBMP(Data, Size, &BMP))
+        {
+            Info->Format = ImageFormat_BMP;
+            Info->Width = BMP.Width;
+            Info->Height = BMP.Height;
+            Info->Channels = BMP.BitCount == 32? 4: 3;
+        }
+        else if (ParsePPM(Data, Size, &PPM))
+        {
+            Info->Format = ImageFormat_PPM;
+            Info->Width = PPM.Width;
+            Info->Height = PPM.Height;
+            Info->Channels = PPM.Channels;
+        }
+        else if (ParseQOI(Data, Size, Info))
+        {
+        }
+        else if (ParseTGA(Data, Size, &TGA)) // no magic number, goes last
+        {
+            Info->Format = ImageFormat_TGA;
+            Info->Width = TGA.Width;
+            Info->Height = TGA.Height;
+            Info->Channels = TGA.BytesPerPixel == 1? 1: TGA.BytesPerPixel;
+        }
+        
+        return Info->Format != ImageFormat_Unknown;
+    }
+    
+    // Pixels must hold Height rows of Pitch >= Width * 4 bytes
+    inline bool
+        DecodeImage(const void *File, size_t Size, u8 *Pixels, size_t Pitch)
+    {
+        image_info Info;
+        if (!ReadImageInfo(File, Size, &Info) || Pitch < (size_t)Info.Width * 4)
+        {
+            return false;
+        }
+        
+        const u8 *Data = (const u8 *)File;
+        switch (Info.Format)
+        {
+            case ImageFormat_BMP: return DecodeBMP(Data, Size, Pixels, Pitch);
+            case ImageFormat_TGA: return DecodeTGA(Data, Size, Pixels, Pitch);
+            case ImageFormat_PPM: return DecodePPM(Data, Size, Pixels, Pitch);
+            case ImageFormat_QOI: return DecodeQOI(Data, Size, Pixels, Pitch);
+            default: return false;
+        }
+    }
+    
+    inline image
+        LoadImageFile(const char *Path, size_t Alignment = 64)
+    {
+        image Image = {};
+        
+        size_t Size = 0;
+        u8 *Data = ReadFileData(Path, &Size);
+        image_info Info;
+        if (Data && ReadImageInfo(Data, Size, &Info))
+        {
+            Image = AllocateImage(Info.Width, Info.Height, Alignment);
+            if (Image.Pixels && !DecodeImage(Data, Size, Image.Pixels, Image.Pitch))
+            {
+                FreeImage(&Image);
+            }
+        }
+        free(Data);
+        
+        return Image;
+    }
+    
+    //
+    //
+    // checksums
+    
+    struct crc32_table
+    {
+        u32 Entries[8][256];
+    };
+    
+    inline const crc32_table *
+        GetCRC32Table()
+    {
+        struct table_init
+        {
+            crc32_table Table;
+            table_init()
+            {
+                for (u32 I = 0; I < 256; ++I)
+                {
+                    u32 C = I;
+                    for (int K = 0; K < 8; ++K)
+                    {
+                        C = (C & 1)? 0xEDB88320 ^ (C >> 1): C >> 1;
+                    }
+                    Table.Entries[0][I] = C;
+                }
+                for (u32 I = 0; I < 256; ++I)
+                {
+                    for (int Slice = 1; Slice < 8; ++Slice)
+                    {
+                        u32 Previous = Table.Entries[Slice - 1][I];
+                        Table.Entries[Slice][I] = (Previous >> 8) ^ Table.Entries[0][Previous & 0xFF];
+                    }
+                }
+            }
+        };
+        static table_init Init; // thread safe since C++11
+        return &Init.Table;
+    }
+    
+    // State starts at 0xFFFFFFFF, the CRC is ~State
+    inline u32
+        UpdateCRC32(u32 State, const u8 *Data, size_t Size)
+    {
+        const crc32_table *T = GetCRC32Table();
+        
+        // slicing by 8
+        while (Size >= 8)
+        {
+            u32 Low = ReadU32LE(Data) ^ State;
+            u32 High = ReadU32LE(Data + 4);
+            State = (T->Entries[7][Low & 0xFF] ^ T->Entries[6][(Low >> 8) & 0xFF] ^
+                     T->Entries[5][(Low >> 16) & 0xFF] ^ T->Entries[4][Low >> 24] ^
+                     T->Entries[3][High & 0xFF] ^ T->Entries[2][(High >> 8) & 0xFF] ^
+                     T->Entries[1][(High >> 16) & 0xFF] ^ T->Entries[0][High >> 24]);
+            Data += 8;
+            Size -= 8;
+        }
+        while (Size--)
+        {
+            State = T->Entries[0][(State ^ *Data++) & 0xFF] ^ (State >> 8);
+        }
+        return State;
+    }
+    
+    inline u32
+        Adler32(const u8 *Data, size_t Size)
+    {
+        u32 A = 1;
+        u32 B = 0;
+        while (Size > 0)
+        {
+            // 5552 is the most bytes that can't overflow B before the modulo
+            size_t Count = Size < 5552? Size: 5552;
+            Size -= Count;
+            while (Count--)
+            {
+                A += *Data++;
+                B += A;
+            }
+            A %= 65521;
+            B %= 65521;
+        }
+        return A | (B << 16);
+    }
+    
+    // Adler-32 of A followed by B, from both checksums and B's length (same as zlib)
+    inline u32
+        CombineAdler32(u32 AdlerA, u32 AdlerB, size_t SizeB)
+    {
+        u32 Base = 65521;
+        u32 Remainder = (u32)(SizeB % Base);
+        u32 Sum1 = AdlerA & 0xFFFF;
+        u32 Sum2 = (u32)(((u64)Remainder * Sum1) % Base);
+        Sum1 += (AdlerB & 0xFFFF) + Base - 1;
+        Sum2 += (AdlerA >> 16) + (AdlerB >> 16) + Base - Remainder;
+        if (Sum1 >= Base) Sum1 -= Base;
+        if (Sum1 >= Base) Sum1 -= Base;
+        if (Sum2 >= (Base << 1)) Sum2 -= (Base << 1);
+        if (Sum2 >= Base) Sum2 -= Base;
+        return Sum1 | (Sum2 << 16);
+    }
+    
+    //
+    //
+    // deflate
+    
+    struct deflate_tables
+    {
+        u16 LengthCode[259]; // match length -> symbol 257..285
+        u8 LengthExtraBits[29];
+        u16 LengthBase[29];
+        u8 DistanceCodeLow[512]; // distance - 1 < 512
+        u8 DistanceCodeHigh[256]; // (distance - 1) >> 7
+        u8 DistanceExtraBits[30];
+        u16 DistanceBase[30];
+    };
+    
+    inline const deflate_tables *
+        GetDeflateTables()
+    {
+        struct table_init
+        {
+            deflate_tables Tables;
+            table_init()
+            {
+                deflate_tables *T = &Tables;
+                static const u8 LengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+                static const u8 DistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+                
+                u32 Base = 3;
+                for (int Code = 0; Code < 29; ++Code)
+                {
+                    T->LengthExtraBits[Code] = LengthExtra[Code];
+                    T->LengthBase[Code] = (u16)(Code == 28? 258: Base);
+                    for (u32 L = 0; L < (1u << LengthExtra[Code]) && Base + L <= 258; ++L)
+                    {
+                        T->LengthCode[Base + L] = (u16)(257 + Code);
+                    }
+                    Base += 1u << LengthExtra[Code];
+                }
+                T->LengthCode[258] = 285;
+                
+                Base = 1;
+                for (int Code = 0; Code < 30; ++Code)
+                {
+                    T->DistanceExtraBits[Code] = DistanceExtra[Code];
+                    T->DistanceBase[Code] = (u16)Base;
+                    for (u32 D = 0; D < (1u << DistanceExtra[Code]); ++D)
+                    {
+                        u32 Index = Base + D - 1;
+                        if (Index < 512) T->DistanceCodeLow[Index] = (u8)Code;
+                        T->DistanceCodeHigh[Index >> 7] = (u8)Code;
+                    }
+                    Base += 1u << DistanceExtra[Code];
+                }
+            }
+        };
+        static table_init Init;
+        return &Init.Tables;
+    }
+    
+    struct bit_writer
+    {
+        u8 *Data;
+        size_t Size;
+        size_t Capacity;
+        u64 Bits;
+        int BitCount;
+    };
+    
+    inline void
+        ReserveBytes(bit_writer *W, size_t Count)
+    {
+        if (W->Size + Count > W->Capacity)
+        {
+            size_t NewCapacity = W->Capacity * 2 > W->Size + Count? W->Capacity * 2: W->Size + Count + 4096;
+            W->Data = (u8 *)realloc(W->Data, NewCapacity);
+            W->Capacity = NewCapacity;
+        }
+    }
+    
+    // LSB first, Count <= 32
+    inline void
+        PutBits(bit_writer *W, u32 Value, int Count)
+    {
+        W->Bits |= (u64)Value << W->BitCount;
+        W->BitCount += Count;
+        if (W->BitCount >= 32)
+        {
+            if (W->Size + 4 > W->Capacity) ReserveBytes(W, 4);
+            u32 Low = (u32)W->Bits;
+            memcpy(W->Data + W->Size, &Low, 4); // little endian
+            W->Size += 4;
+            W->Bits >>= 32;
+            W->BitCount -= 32;
+        }
+    }
+    
+    inline void
+        AlignToByte(bit_writer *W)
+    {
+        ReserveBytes(W, 8);
+        while (W->BitCount > 0)
+        {
+            W->Data[W->Size++] = (u8)W->Bits;
+            W->Bits >>= 8;
+            W->BitCount = W->BitCount > 8? W->BitCount - 8: 0;
+        }
+        W->Bits = 0;
+    }
+    
+    inline u32
+        ReverseBits(u32 Code, int Length)
+    {
+        u32 Result = 0;
+        for (int I = 0; I < Length; ++I)
+        {
+            Result = (Result << 1) | ((Code >> I) & 1);
+        }
+        return Result;
+    }
+    
+    // length limited huffman code lengths, 0 for unused symbols
+    inline void
+        BuildHuffmanLengths(const u32 *Frequencies, int SymbolCount, int MaxLength, u8 *Lengths)
+    {
+        // leaves sorted by frequency, then internal nodes appended in order
+        u32 NodeFrequency[2 * 288];
+        int NodeParent[2 * 288];
+        int Symbols[288];
+        int LeafCount = 0;
+        for (int S = 0; S < SymbolCount; ++S)
+        {
+            Lengths[S] = 0;
+            if (Frequencies[S]) Symbols[LeafCount++] = S;
+        }
+        if (LeafCount == 0)
+        {
+            return;
+        }
+        if (LeafCount == 1)
+        {
+            // zlib rejects incomplete code length codes, pad with a second symbol
+            Lengths[Symbols[0]] = 1;
+            Lengths[Symbols[0] == 0? 1: 0] = 1;
+            return;
+        }
+        
+        for (int I = 1; I < LeafCount; ++I) // insertion sort, at most 288 symbols
+        {
+            int S = Symbols[I];
+            int J = I - 1;
+            while (J >= 0 && Frequencies[Symbols[J]] > Frequencies[S])
+            {
+                Symbols[J + 1] = Symbols[J];
+                --J;
+            }
+            Symbols[J + 1] = S;
+        }
+        for (int I = 0; I < LeafCount; ++I)
+        {
+            NodeFrequency[I] = Frequencies[Symbols[I]];
+        }
+        
+        // two queue huffman: internal nodes are created in frequency order
+        int NextLeaf = 0;
+        int NextNode = LeafCount;
+        int NodeCount = LeafCount;
+        for (int Merge = 0; Merge < LeafCount - 1; ++Merge)
+        {
+            int Picked[2];
+            for (int K = 0; K < 2; ++K)
+            {
+                if (NextLeaf < LeafCount && (NextNode >= NodeCount || NodeFrequency[NextLeaf] <= NodeFrequency[NextNode]))
+                {
+                    Picked[K] = NextLeaf++;
+                }
+                else
+                {
+                    Picked[K] = NextNode++;
+                }
+            }
+            NodeFrequency[NodeCount] = NodeFrequency[Picked[0]] + NodeFrequency[Picked[1]];
+            NodeParent[Picked[0]] = NodeCount;
+            NodeParent[Picked[1]] = NodeCount;
+            ++NodeCount;
+        }
+        
+        // parents always come after their children
+        int Depth[2 * 288];
+        int LengthCounts[64] = {};
+        Depth[NodeCount - 1] = 0;
+        for (int N = NodeCount - 2; N >= 0; --N)
+        {
+            Depth[N] = Depth[NodeParent[N]] + 1;
+        }
+        for (int I = 0; I < LeafCount; ++I)
+        {
+            int D = Depth[I] < 63? Depth[I]: 63;
+            LengthCounts[D]++;
+        }
+        
+        //NOTE(chen): clamp to MaxLength, then push codes down until the Kraft sum
+        //            fits again (same trick as miniz and stb)
+        for (int L = MaxLength + 1; L < 64; ++L)
+        {
+            LengthCounts[MaxLength] += LengthCounts[L];
+            LengthCounts[L] = 0;
+        }
+        u32 Total = 0;
+        for (int L = 1; L <= MaxLength; ++L)
+        {
+            Total += (u32)LengthCounts[L] << (MaxLength - L);
+        }
+        while (Total > (1u << MaxLength))
+        {
+            LengthCounts[MaxLength]--;
+            for (int L = MaxLength - 1; L > 0; --L)
+            {
+                if (LengthCounts[L])
+                {
+                    LengthCounts[L]--;
+                    LengthCounts[L + 1] += 2;
+                    break;
+                }
+            }
+            Total--;
+        }
+        
+        // least frequent symbols get the longest codes
+        int Leaf = 0;
+        for (int L = MaxLength; L > 0; --L)
+        {
+            for (int I = 0; I < LengthCounts[L]; ++I)
+            {
+                Lengths[Symbols[Leaf++]] = (u8)L;
+            }
+        }
+    }
+    
+    // canonical codes, bit reversed for the LSB first writer
+    inline void
+        BuildHuffmanCodes(const u8 *Lengths, int SymbolCount, u16 *Codes)
+    {
+        u32 LengthCounts[16] = {};
+        for (int S = 0; S < SymbolCount; ++S) LengthCounts[Lengths[S]]++;
+        LengthCounts[0] = 0;
+        
+        u32 NextCode[16] = {};
+        u32 Code = 0;
+        for (int L = 1; L < 16; ++L)
+        {
+            Code = (Code + LengthCounts[L - 1]) << 1;
+            NextCode[L] = Code;
+        }
+        for (int S = 0; S < SymbolCount; ++S)
+        {
+            Codes[S] = Lengths[S]? (u16)ReverseBits(NextCode[Lengths[S]]++, Lengths[S]): 0;
+        }
+    }
+    
+    // LZ77 output: literals are < 256, matches store length | distance << 9 with the top bit set
+    struct deflate_block
+    {
+        u32 *Symbols;
+        int SymbolCount;
+        u32 LitLenFrequencies[286];
+        u32 DistanceFrequencies[30];
+        const u8 *Start; // uncompressed bytes covered by the block
+        size_t Size;
+    };
+    
+    inline void
+        WriteStoredBlocks(bit_writer *W, const u8 *Data, size_t Size)
+    {
+        while (Size > 0)
+        {
+            u32 Count = Size < 65535? (u32)Size: 65535;
+            PutBits(W, 0, 3); // not final, stored
+            AlignToByte(W);
+            ReserveBytes(W, 4 + Count);
+            u8 *Out = W->Data + W->Size;
+            Out[0] = (u8)Count;
+            Out[1] = (u8)(Count >> 8);
+            Out[2] = (u8)~Count;
+            Out[3] = (u8)(~Count >> 8);
+            memcpy(Out + 4, Data, Count);
+            W->Size += 4 + Count;
+            Data += Count;
+            Size -= Count;
+        }
+    }
+    
+    inline void
+        WriteHuffmanBlock(bit_writer *W, deflate_block *Block)
+    {
+        const deflate_tables *T = GetDeflateTables();
+        Block->LitLenFrequencies[256] = 1;
+        bool NoDistances = true;
+        for (int S = 0; S < 30; ++S) NoDistances = NoDistances && !Block->DistanceFrequencies[S];
+        if (NoDistances)
+        {
+            Block->DistanceFrequencies[0] = 1; // some decoders choke on an empty distance code
+        }
+        
+        u8 LitLenLengths[286];
+        u8 DistanceLengths[30];
+        BuildHuffmanLengths(Block->LitLenFrequencies, 286, 15, LitLenLengths);
+        BuildHuffmanLengths(Block->DistanceFrequencies, 30, 15, DistanceLengths);
+        
+        int LitLenCount = 286;
+        while (LitLenCount > 257 && !LitLenLengths[LitLenCount - 1]) --LitLenCount;
+        int DistanceCount = 30;
+        while (DistanceCount > 1 && !DistanceLengths[DistanceCount - 1]) --DistanceCount;
+        
+        // code length alphabet: 0-15 literal, 16 repeat previous 3-6, 17 zeros 3-10, 18 zeros 11-138
+        u8 AllLengths[286 + 30];
+        int AllCount = 0;
+        for (int I = 0; I < LitLenCount; ++I) AllLengths[AllCount++] = LitLenLengths[I];
+        for (int I = 0; I < DistanceCount; ++I) AllLengths[AllCount++] = DistanceLengths[I];
+        
+        u16 RLE[286 + 30]; // symbol | extra value << 8
+        int RLECount = 0;
+        u32 CodeLengthFrequencies[19] = {};
+        for (int I = 0; I < AllCount;)
+        {
+            u8 Length = AllLengths[I];
+            int Run = 1;
+            while (I + Run < AllCount && AllLengths[I + Run] == Length) ++Run;
+            
+            if (Length == 0 && Run >= 3)
+            {
+                int Count = Run < 138? Run: 138;
+                u16 Symbol = (u16)(Count <= 10? 17: 18);
+                RLE[RLECount++] = (u16)(Symbol | ((Count - (Symbol == 17? 3: 11)) << 8));
+                CodeLengthFrequencies[Symbol]++;
+                I += Count;
+            }
+            else if (Length != 0 && Run >= 4)
+            {
+                RLE[RLECount++] = Length;
+                CodeLengthFrequencies[Length]++;
+                int Count = Run - 1 < 6? Run - 1: 6;
+                RLE[RLECount++] = (u16)(16 | ((Count - 3) << 8));
+                CodeLengthFrequencies[16]++;
+                I += 1 + Count;
+            }
+            else
+            {
+                RLE[RLECount++] = Length;
+                CodeLengthFrequencies[Length]++;
+                I += 1;
+            }
+        }
+        
+        u8 CodeLengthLengths[19];
+        u16 CodeLengthCodes[19];
+        BuildHuffmanLengths(CodeLengthFrequencies, 19, 7, CodeLengthLengths);
+        BuildHuffmanCodes(CodeLengthLengths, 19, CodeLengthCodes);
+        
+        static const u8 CodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        int CodeLengthCount = 19;
+        while (CodeLengthCount > 4 && !CodeLengthLengths[CodeLengthOrder[CodeLengthCount - 1]]) --CodeLengthCount;
+        
+        // compare with a stored block, incompressible stripes happen (noise)
+        u64 HuffmanBits = 3 + 5 + 5 + 4 + 3 * (u64)CodeLengthCount;
+        for (int I = 0; I < RLECount; ++I)
+        {
+            int Symbol = RLE[I] & 0xFF;
+            HuffmanBits += CodeLengthLengths[Symbol] + (Symbol == 16? 2: Symbol == 17? 3: Symbol == 18? 7: 0);
+        }
+        for (int S = 0; S < 286; ++S)
+        {
+            u32 Extra = S > 264 && S < 285? T->LengthExtraBits[S - 257]: 0;
+            HuffmanBits += (u64)Block->LitLenFrequencies[S] * (LitLenLengths[S] + Extra);
+        }
+        for (int S = 0; S < 30; ++S)
+        {
+            HuffmanBits += (u64)Block->DistanceFrequencies[S] * (DistanceLengths[S] + T->DistanceExtraBits[S]);
+        }
+        u64 StoredBits = 8 * (Block->Size + 5 * (Block->Size / 65535 + 1)) + 8;
+        if (StoredBits < HuffmanBits)
+        {
+            WriteStoredBlocks(W, Block->Start, Block->Size);
+            return;
+        }
+        
+        u16 LitLenCodes[286];
+        u16 DistanceCodes[30];
+        BuildHuffmanCodes(LitLenLengths, 286, LitLenCodes);
+        BuildHuffmanCodes(DistanceLengths, 30, DistanceCodes);
+        
+        PutBits(W, 2 << 1, 3); // not final, dynamic
+        PutBits(W, (u32)(LitLenCount - 257), 5);
+        PutBits(W, (u32)(DistanceCount - 1), 5);
+        PutBits(W, (u32)(CodeLengthCount - 4), 4);
+        for (int I = 0; I < CodeLengthCount; ++I)
+        {
+            PutBits(W, CodeLengthLengths[CodeLengthOrder[I]], 3);
+        }
+        for (int I = 0; I < RLECount; ++I)
+        {
+            int Symbol = RLE[I] & 0xFF;
+            PutBits(W, CodeLengthCodes[Symbol], CodeLengthLengths[Symbol]);
+            if (Symbol == 16) PutBits(W, RLE[I] >> 8, 2);
+            if (Symbol == 17) PutBits(W, RLE[I] >> 8, 3);
+            if (Symbol == 18) PutBits(W, RLE[I] >> 8, 7);
+        }
+        
+        for (int I = 0; I < Block->SymbolCount; ++I)
+        {
+            u32 Symbol = Block->Symbols[I];
+            if (Symbol < 256)
+            {
+                PutBits(W, LitLenCodes[Symbol], LitLenLengths[Symbol]);
+            }
+            else
+            {
+                u32 Length = Symbol & 0x1FF;
+                u32 Distance = (Symbol >> 9) & 0xFFFF;
+                u32 LengthSymbol = T->LengthCode[Length];
+                u32 LengthIndex = LengthSymbol - 257;
+                PutBits(W, LitLenCodes[LengthSymbol], LitLenLengths[LengthSymbol]);
+                PutBits(W, Length - T->LengthBase[LengthIndex], T->LengthExtraBits[LengthIndex]);
+                
+                u32 DistanceCode = Distance <= 512? T->DistanceCodeLow[Distance - 1]: T->DistanceCodeHigh[(Distance - 1) >> 7];
+                PutBits(W, DistanceCodes[DistanceCode], DistanceLengths[DistanceCode]);
+                PutBits(W, Distance - T->DistanceBase[DistanceCode], T->DistanceExtraBits[DistanceCode]);
+            }
+        }
+        PutBits(W, LitLenCodes[256], LitLenLengths[256]);
+    }
+    
+#define CH_DEFLATE_WINDOW 32768
+#define CH_DEFLATE_HASH_BITS 15
+#define CH_DEFLATE_BLOCK_SYMBOLS 32768
+    
+    inline u32
+        DeflateHash(const u8 *P)
+    {
+        u32 Value = (u32)P[0] | ((u32)P[1] << 8) | ((u32)P[2] << 16);
+        return (Value * 2654435761u) >> (32 - CH_DEFLATE_HASH_BITS);
+    }
+    
+    inline u32
+        MatchLength(const u8 *A, const u8 *B, u32 MaxLength)
+    {
+        u32 Length = 0;
+        while (Length + 8 <= MaxLength)
+        {
+            u64 X, Y;
+            memcpy(&X, A + Length, 8);
+            memcpy(&Y, B + Length, 8);
+            u64 Diff = X ^ Y;
+            if (Diff)
+            {
+                // first differing byte, little endian
+                while (!(Diff & 0xFF))
+                {
+                    Diff >>= 8;
+                    ++Length;
+                }
+                return Length;
+            }
+            Length += 8;
+        }
+        while (Length < MaxLength && A[Length] == B[Length]) ++Length;
+        return Length;
+    }
+    
+    // raw deflate blocks, none of them final, ends byte aligned with an empty
+    // stored block (a sync flush). Appending 0x03 0x00 closes the stream.
+    inline void
+        DeflateSyncFlushed(bit_writer *W, const u8 *Data, size_t Size, int MaxChain)
+    {
+        const deflate_tables *T = GetDeflateTables();
+        int *Head = (int *)malloc(sizeof(int) << CH_DEFLATE_HASH_BITS);
+        int *Previous = (int *)malloc(sizeof(int) * CH_DEFLATE_WINDOW);
+        for (int I = 0; I < (1 << CH_DEFLATE_HASH_BITS); ++I) Head[I] = -1;
+        
+        deflate_block Block = {};
+        Block.Symbols = (u32 *)malloc(sizeof(u32) * CH_DEFLATE_BLOCK_SYMBOLS);
+        Block.Start = Data;
+        
+        size_t At = 0;
+        while (At < Size)
+        {
+            u32 BestLength = 0;
+            u32 BestDistance = 0;
+            if (At + 3 <= Size)
+            {
+                u32 Hash = DeflateHash(Data + At);
+                int Candidate = Head[Hash];
+                u32 MaxLength = Size - At < 258? (u32)(Size - At): 258;
+                for (int Chain = 0; Chain < MaxChain && Candidate >= 0; ++Chain)
+                {
+                    size_t Distance = At - (size_t)Candidate;
+                    if (Distance > CH_DEFLATE_WINDOW)
+                    {
+                        break;
+                    }
+                    
+                    const u8 *A = Data + Candidate;
+                    const u8 *B = Data + At;
+                    if (A[BestLength] == B[BestLength] && A[0] == B[0])
+                    {
+                        u32 Length = MatchLength(A, B, MaxLength);
+                        if (Length > BestLength)
+                        {
+                            BestLength = Length;
+                            BestDistance = (u32)Distance;
+                            if (Length == MaxLength) break;
+                        }
+                    }
+                    
+                    int Next = Previous[Candidate & (CH_DEFLATE_WINDOW - 1)];
+                    if (Next >= Candidate) break; // the slot was reused by a newer position
+                    Candidate = Next;
+                }
+            }
+            
+            u32 Step = 1;
+            if (BestLength >= 3)
+            {
+                Block.Symbols[Block.SymbolCount++] = 0x80000000 | BestLength | (BestDistance << 9);
+                Block.LitLenFrequencies[T->LengthCode[BestLength]]++;
+                u32 DistanceCode = (BestDistance <= 512? T->DistanceCodeLow[BestDistance - 1]:
+                                    T->DistanceCodeHigh[(BestDistance - 1) >> 7]);
+                Block.DistanceFrequencies[DistanceCode]++;
+                Step = BestLength;
+            }
+            else
+            {
+                Block.Symbols[Block.SymbolCount++] = Data[At];
+                Block.LitLenFrequencies[Data[At]]++;
+            }
+            
+            // every position goes into the chains, including the ones inside a match
+            for (u32 I = 0; I < Step; ++I, ++At)
+            {
+                if (At + 3 <= Size)
+                {
+                    u32 Hash = DeflateHash(Data + At);
+                    Previous[At & (CH_DEFLATE_WINDOW - 1)] = Head[Hash];
+                    Head[Hash] = (int)At;
+                }
+            }
+            
+            if (Block.SymbolCount == CH_DEFLATE_BLOCK_SYMBOLS || At == Size)
+            {
+                Block.Size = (size_t)(Data + At - Block.Start);
+                WriteHuffmanBlock(W, &Block);
+                
+                u32 *Symbols = Block.Symbols;
+                Block = {};
+                Block.Symbols = Symbols;
+                Block.Start = Data + At;
+            }
+        }
+        
+        // sync flush
+        PutBits(W, 0, 3);
+        AlignToByte(W);
+        ReserveBytes(W, 4);
+        static const u8 Empty[4] = {0x00, 0x00, 0xFF, 0xFF};
+        memcpy(W->Data + W->Size, Empty, 4);
+        W->Size += 4;
+        
+        free(Block.Symbols);
+        free(Previous);
+        free(Head);
+    }
+    
+    //
+    //
+    // PNG
+    
+    inline u8
+        Paeth(u8 A, u8 B, u8 C)
+    {
+        int P = (int)A + (int)B - (int)C;
+        int PA = P > A? P - A: A - P;
+        int PB = P > B? P - B: B - P;
+        int PC = P > C? P - C: C - P;
+        if (PA <= PB && PA <= PC) return A;
+        if (PB <= PC) return B;
+        return C;
+    }
+    
+    // Above is a zero row for the first row of the image, returns sum of |signed bytes|
+    inline u32
+        ApplyPNGFilter(u8 *Out, int Filter, const u8 *Row, const u8 *Above, size_t RowBytes, int BPP)
+    {
+        size_t I = 0;
+        switch (Filter)
+        {
+            case 0:
+            {
+                memcpy(Out, Row, RowBytes);
+            } break;
+            
+            case 1:
+            {
+                for (; I < (size_t)BPP; ++I) Out[I] = Row[I];
+                for (; I < RowBytes; ++I) Out[I] = (u8)(Row[I] - Row[I - BPP]);
+            } break;
+            
+            case 2:
+            {
+                for (; I < RowBytes; ++I) Out[I] = (u8)(Row[I] - Above[I]);
+            } break;
+            
+            case 3:
+            {
+                for (; I < (size_t)BPP; ++I) Out[I] = (u8)(Row[I] - (Above[I] >> 1));
+                for (; I < RowBytes; ++I) Out[I] = (u8)(Row[I] - (((u32)Row[I - BPP] + Above[I]) >> 1));
+            } break;
+            
+            case 4:
+            {
+                for (; I < (size_t)BPP; ++I) Out[I] = (u8)(Row[I] - Above[I]);
+                for (; I < RowBytes; ++I) Out[I] = (u8)(Row[I] - Paeth(Row[I - BPP], Above[I], Above[I - BPP]));
+            } break;
+        }
+        
+        u32 Cost = 0;
+        for (I = 0; I < RowBytes; ++I)
+        {
+            u32 Value = Out[I];
+            Cost += Value < 128? Value: 256 - Value;
+        }
+        return Cost;
+    }
+    
+    // tries all five filters and keeps the one with the smallest cost, Scratch holds 2 rows
+    inline void
+        FilterPNGRow(u8 *Out, const u8 *Row, const u8 *Above, size_t RowBytes, int BPP, u8 *Scratch)
+    {
+        u8 *Best = Scratch;
+        u8 *Spare = Scratch + RowBytes;
+        int BestFilter = 0;
+        u32 BestCost = ApplyPNGFilter(Best, 0, Row, Above, RowBytes, BPP);
+        for (int Filter = 1; Filter < 5; ++Filter)
+        {
+            u32 Cost = ApplyPNGFilter(Spare, Filter, Row, Above, RowBytes, BPP);
+            if (Cost < BestCost)
+            {
+                BestCost = Cost;
+                BestFilter = Filter;
+                u8 *Temp = Best;
+                Best = Spare;
+                Spare = Temp;
+            }
+        }
+        
+        Out[0] = (u8)BestFilter;
+        memcpy(Out + 1, Best, RowBytes);
+    }
+    
+    struct png_stripe
+    {
+        int FirstRow;
+        int RowCount;
+        bit_writer Output; // "IDAT" + deflate data, length and CRC get added later
+        u32 CRCState;
+        u32 Adler;
+        size_t FilteredSize;
+    };
+    
+    inline void
+        EncodePNGStripe(png_stripe *Stripe, const u8 *Pixels, int Width, size_t Pitch, int Channels, bool First)
+    {
+        size_t RowBytes = (size_t)Width * Channels;
+        size_t FilteredSize = (RowBytes + 1) * Stripe->RowCount;
+        u8 *Filtered = (u8 *)malloc(FilteredSize);
+        u8 *Rows = (u8 *)calloc(4, RowBytes); // current, above, 2 filter scratch
+        u8 *Current = Rows;
+        u8 *Above = Rows + RowBytes;
+        u8 *Scratch = Rows + 2 * RowBytes;
+        
+        for (int Y = 0; Y < Stripe->RowCount; ++Y)
+        {
+            int Row = Stripe->FirstRow + Y;
+            const u8 *Source = Pixels + Pitch * Row;
+            if (Channels == 4)
+            {
+                memcpy(Current, Source, RowBytes);
+            }
+            else
+            {
+                for (int X = 0; X < Width; ++X)
+                {
+                    Current[3*X + 0] = Source[4*X + 0];
+                    Current[3*X + 1] = Source[4*X + 1];
+                    Current[3*X + 2] = Source[4*X + 2];
+                }
+            }
+            
+            // the row above can come from the previous stripe, filters may look across
+            if (Y == 0 && Row > 0)
+            {
+                const u8 *AboveSource = Pixels + Pitch * (Row - 1);
+                for (int X = 0; X < Width; ++X)
+                {
+                    memcpy(Above + Channels * X, AboveSource + 4 * X, Channels);
+                }
+            }
+            
+            FilterPNGRow(Filtered + (RowBytes + 1) * Y, Current, Above, RowBytes, Channels, Scratch);
+            
+            u8 *Temp = Above;
+            Above = Current;
+            Current = Temp;
+        }
+        
+        bit_writer *W = &Stripe->Output;
+        *W = {};
+        ReserveBytes(W, FilteredSize / 2 + 64);
+        memcpy(W->Data, "IDAT", 4);
+        W->Size = 4;
+        if (First)
+        {
+            W->Data[W->Size++] = 0x78; // deflate, 32K window
+            W->Data[W->Size++] = 0x01;
+        }
+        DeflateSyncFlushed(W, Filtered, FilteredSize, CH_IMAGE_PNG_MAX_CHAIN);
+        
+        Stripe->CRCState = UpdateCRC32(0xFFFFFFFF, W->Data, W->Size);
+        Stripe->Adler = Adler32(Filtered, FilteredSize);
+        Stripe->FilteredSize = FilteredSize;
+        
+        free(Rows);
+        free(Filtered);
+    }
+    
+    inline void
+        WritePNGChunk(u8 **Out, const char *Type, const u8 *Data, u32 Size)
+    {
+        WriteU32BE(*Out, Size);
+        memcpy(*Out + 4, Type, 4);
+        if (Size) memcpy(*Out + 8, Data, Size);
+        u32 CRC = ~UpdateCRC32(0xFFFFFFFF, *Out + 4, Size + 4);
+        WriteU32BE(*Out + 8 + Size, CRC);
+        *Out += 12 + Size;
+    }
+    
+    // Channels 3 (RGB) or 4 (RGBA), ThreadCount <= 0 uses all hardware threads. malloc'd
+    inline u8 *
+        EncodePNG(const u8 *Pixels, int Width, int Height, size_t Pitch, int Channels, int ThreadCount, size_t *Size_Out)
+    {
+        *Size_Out = 0;
+        if (Width <= 0 || Height <= 0 || (Channels != 3 && Channels != 4))
+        {
+            return 0;
+        }
+        
+        if (ThreadCount <= 0)
+        {
+            ThreadCount = (int)std::thread::hardware_concurrency();
+            if (ThreadCount <= 0) ThreadCount = 1;
+        }
+        int MaxStripes = (Height + CH_IMAGE_PNG_MIN_STRIPE_ROWS - 1) / CH_IMAGE_PNG_MIN_STRIPE_ROWS;
+        int StripeCount = ThreadCount < MaxStripes? ThreadCount: MaxStripes;
+        if (StripeCount > 64) StripeCount = 64;
+        
+        png_stripe Stripes[64] = {};
+        int RowsPerStripe = Height / StripeCount;
+        for (int I = 0; I < StripeCount; ++I)
+        {
+            Stripes[I].FirstRow = I * RowsPerStripe;
+            Stripes[I].RowCount = I == StripeCount - 1? Height - Stripes[I].FirstRow: RowsPerStripe;
+        }
+        
+        std::thread Workers[64];
+        for (int I = 1; I < StripeCount; ++I)
+        {
+            Workers[I] = std::thread(EncodePNGStripe, &Stripes[I], Pixels, Width, Pitch, Channels, false);
+        }
+        EncodePNGStripe(&Stripes[0], Pixels, Width, Pitch, Channels, true);
+        for (int I = 1; I < StripeCount; ++I)
+        {
+            Workers[I].join();
+        }
+        
+        // close the deflate stream on the last stripe: empty final block, then Adler-32
+        u32 Adler = Stripes[0].Adler;
+        for (int I = 1; I < StripeCount; ++I)
+        {
+            Adler = CombineAdler32(Adler, Stripes[I].Adler, Stripes[I].FilteredSize);
+        }
+        u8 Trailer[6] = {0x03, 0x00};
+        WriteU32BE(Trailer + 2, Adler);
+        png_stripe *Last = &Stripes[StripeCount - 1];
+        ReserveBytes(&Last->Output, sizeof(Trailer));
+        memcpy(Last->Output.Data + Last->Output.Size, Trailer, sizeof(Trailer));
+        Last->Output.Size += sizeof(Trailer);
+        Last->CRCState = UpdateCRC32(Last->CRCState, Trailer, sizeof(Trailer));
+        
+        size_t TotalSize = 8 + (12 + 13) + 12;
+        for (int I = 0; I < StripeCount; ++I)
+        {
+            TotalSize += 8 + Stripes[I].Output.Size; // length + data (with type) + crc
+        }
+        
+        u8 *Result = (u8 *)malloc(TotalSize);
+        if (Result)
+        {
+            u8 *Out = Result;
+            static const u8 Signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+            memcpy(Out, Signature, 8);
+            Out += 8;
+            
+            u8 Header[13];
+            WriteU32BE(Header, (u32)Width);
+            WriteU32BE(Header + 4, (u32)Height);
+            Header[8] = 8;
+            Header[9] = Channels == 4? 6: 2;
+            Header[10] = 0;
+            Header[11] = 0;
+            Header[12] = 0;
+            WritePNGChunk(&Out, "IHDR", Header, 13);
+            
+            for (int I = 0; I < StripeCount; ++I)
+            {
+                bit_writer *Chunk = &Stripes[I].Output;
+                u32 DataSize = (u32)(Chunk->Size - 4);
+                WriteU32BE(Out, DataSize);
+                memcpy(Out + 4, Chunk->Data, Chunk->Size);
+                WriteU32BE(Out + 4 + Chunk->Size, ~Stripes[I].CRCState);
+                Out += 8 + Chunk->Size;
+            }
+            
+            WritePNGChunk(&Out, "IEND", 0, 0);
+            *Size_Out = (size_t)(Out - Result);
+        }
+        
+        for (int I = 0; I < StripeCount; ++I)
+        {
+            free(Stripes[I].Output.Data);
+        }
+        return Result;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,828 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// full mip chain of an sRGB texture, filtered in linear space
+ch::mip_chain Chain = ch::BuildMipChain(Pixels, Width * 4, Width, Height, ch::PixelFormat_RGBA8_SRGB,
+                                        ch::MipFilter_Kaiser, 0); // 0 = all hardware threads
+for (int LevelI = 0; LevelI < Chain.LevelCount; ++LevelI)
+{
+    ch::image_level *Level = &Chain.Levels[LevelI];
+    upload Level->Pixels, Level->Width x Level->Height, rows Level->Pitch bytes apart
+}
+ch::FreeMipChain(&Chain);
+
+// format conversion, any pitch on either side
+ch::ConvertImage(Half, Width * 8, ch::PixelFormat_RGBA16F, Pixels, Width * 4, ch::PixelFormat_RGBA8,
+                 Width, Height, 0);
+
+// pitched copy, e.g. into a mapped upload heap (write combined memory wants NonTemporal)
+ch::CopyRows(Mapped, RowPitch, Pixels, Width * 4, Width * 4, Height, true);
+
+Formats:
+
+RGBA8        unorm, filtered as is
+RGBA8_SRGB   rgb decoded to linear before filtering and encoded back after, alpha is linear
+RGBA16F      half floats
+RGBA32F
+R32F         single channel
+
+Every level is 64-byte aligned. Level N+1 is made from level N, sizes round down
+(max 1) like D3D/GL mips. Edges clamp.
+
+Box averages 2x2 texels, for RGBA8 that's an exact integer SSE2 path. Kaiser is
+an 8x8 tap Kaiser windowed sinc, sharper than box with little ringing. Other
+formats and filters go through linear float rows, one texel per SSE register.
+Levels depend on the one above, so threads split the rows of each level; the
+small levels at the end of the chain run on the calling thread.
+*/
+
+#include "ch_half.h"
+#include "ch_simd.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#define CH_MAX_MIP_LEVELS 16
+
+// the same as ch_math.h's and kernel.h's, this header goes with either
+// (ch_d3d12.h has kernel.h's vectors, ch_math.h's would clash)
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int32_t i32;
+typedef int64_t i64;
+typedef float f32;
+typedef double f64;
+
+// levels with fewer texels than this per thread aren't worth a thread
+#ifndef CH_IMGPROC_MIN_TEXELS_PER_THREAD
+#define CH_IMGPROC_MIN_TEXELS_PER_THREAD (64 * 1024)
+#endif
+
+namespace ch
+{
+    enum pixel_format
+    {
+        PixelFormat_RGBA8,
+        PixelFormat_RGBA8_SRGB,
+        PixelFormat_RGBA16F,
+        PixelFormat_RGBA32F,
+        PixelFormat_R32F,
+    };
+    
+    enum mip_filter
+    {
+        MipFilter_Box,
+        MipFilter_Kaiser,
+    };
+    
+    struct image_level
+    {
+        void *Pixels;
+        int Width;
+        int Height;
+        size_t Pitch; // bytes between rows
+    };
+    
+    struct mip_chain
+    {
+        pixel_format Format;
+        int LevelCount;
+        image_level Levels[CH_MAX_MIP_LEVELS];
+        void *Allocation;
+    };
+    
+    inline int
+        GetPixelSize(pixel_format Format)
+    {
+        switch (Format)
+        {
+            case PixelFormat_RGBA8:
+            case PixelFormat_RGBA8_SRGB: return 4;
+            case PixelFormat_RGBA16F: return 8;
+            case PixelFormat_RGBA32F: return 16;
+            case PixelFormat_R32F: return 4;
+        }
+        return 0;
+    }
+    
+    inline int
+        GetMipLevelCount(int Width, int Height)
+    {
+        int Count = 1;
+        while ((Width > 1 || Height > 1) && Count < CH_MAX_MIP_LEVELS)
+        {
+            Width = Width > 1? Width / 2: 1;
+            Height = Height > 1? Height / 2: 1;
+            ++Count;
+        }
+        return Count;
+    }
+    
+    // calls Work(ThreadIndex) on ThreadCount threads, the caller is thread 0
+    template <typename F>
+        inline void
+        ImageParallel(int ThreadCount, F Work)
+    {
+        std::thread Workers[64];
+        assert(ThreadCount <= 64);
+        for (int I = 1; I < ThreadCount; ++I)
+        {
+            Workers[I] = std::thread(Work, I);
+        }
+        Work(0);
+        for (int I = 1; I < ThreadCount; ++I)
+        {
+            Workers[I].join();
+        }
+    }
+    
+    inline int
+        ResolveThreadCount(int ThreadCount, u64 TexelCount)
+    {
+        if (ThreadCount <= 0)
+        {
+            ThreadCount = int(std::thread::hardware_concurrency());
+            if (ThreadCount <= 0) ThreadCount = 1;
+        }
+        if (ThreadCount > 64) ThreadCount = 64;
+        
+        u64 Useful = TexelCount / CH_IMGPROC_MIN_TEXELS_PER_THREAD;
+        if (Useful < (u64)ThreadCount) ThreadCount = Useful > 1? (int)Useful: 1;
+        return ThreadCount;
+    }
+    
+    //
+    //
+    // row copies
+    
+    //NOTE(chen): non-temporal stores skip the cache, which is what you want when
+    //            writing to memory nobody reads back soon (upload heaps, mapped
+    //            buffers, big destination images). Rows are copied with aligned
+    //            streaming stores, the unaligned head and tail with memcpy.
+    inline void
+        CopyRows(void *Dest, size_t DestPitch, const void *Src, size_t SrcPitch,
+                 size_t RowBytes, int RowCount, bool NonTemporal = false)
+    {
+        u8 *D = (u8 *)Dest;
+        const u8 *S = (const u8 *)Src;
+        
+        if (DestPitch == RowBytes && SrcPitch == RowBytes && !NonTemporal)
+        {
+            memcpy(D, S, RowBytes * RowCount);
+            return;
+        }
+        
+#if CH_SSE2
+        if (NonTemporal)
+        {
+            for (int Y = 0; Y < RowCount; ++Y)
+            {
+                u8 *Out = D + DestPitch * Y;
+                const u8 *In = S + SrcPitch * Y;
+                size_t Head = (size_t)(-(intptr_t)Out & 15);
+                if (Head > RowBytes) Head = RowBytes;
+                memcpy(Out, In, Head);
+                
+                size_t I = Head;
+                for (; I + 64 <= RowBytes; I += 64)
+                {
+                    __m128i A = _mm_loadu_si128((const __m128i *)(In + I));
+                    __m128i B = _mm_loadu_si128((const __m128i *)(In + I + 16));
+                    __m128i C = _mm_loadu_si128((const __m128i *)(In + I + 32));
+                    __m128i E = _mm_loadu_si128((const __m128i *)(In + I + 48));
+                    _mm_stream_si128((__m128i *)(Out + I), A);
+                    _mm_stream_si128((__m128i *)(Out + I + 16), B);
+                    _mm_stream_si128((__m128i *)(Out + I + 32), C);
+                    _mm_stream_si128((__m128i *)(Out + I + 48), E);
+                }
+                for (; I + 16 <= RowBytes; I += 16)
+                {
+                    _mm_stream_si128((__m128i *)(Out + I), _mm_loadu_si128((const __m128i *)(In + I)));
+                }
+                memcpy(Out + I, In + I, RowBytes - I);
+            }
+            _mm_sfence(); // streaming stores are weakly ordered
+            return;
+        }
+#endif
+        for (int Y = 0; Y < RowCount; ++Y)
+        {
+            memcpy(D + DestPitch * Y, S + SrcPitch * Y, RowBytes);
+        }
+    }
+    
+    //
+    //
+    // sRGB
+    
+    struct srgb_tables
+    {
+        f32 ToLinear[256];
+        u8 FromLinear[4096]; // code at the start of each bucket of [0, 1]
+        f32 Thresholds[256]; // linear value halfway (in sRGB) between code i and i + 1
+    };
+    
+    inline f64
+        SRGBToLinearExact(f64 Value)
+    {
+        return Value <= 0.04045? Value / 12.92: pow((Value + 0.055) / 1.055, 2.4);
+    }
+    
+    inline const srgb_tables *
+        GetSRGBTables()
+    {
+        struct table_init
+        {
+            srgb_tables Tables;
+            table_init()
+            {
+                srgb_tables *T = &Tables;
+                for (int I = 0; I < 256; ++I)
+                {
+                    T->ToLinear[I] = (f32)SRGBToLinearExact(I / 255.0);
+                    T->Thresholds[I] = I < 255? (f32)SRGBToLinearExact((I + 0.5) / 255.0): 2.0f;
+                }
+                
+                int Code = 0;
+                for (int Bucket = 0; Bucket < 4096; ++Bucket)
+                {
+                    f32 Start = Bucket / 4095.0f;
+                    while (Start > T->Thresholds[Code]) ++Code;
+                    T->FromLinear[Bucket] = (u8)Code;
+                }
+            }
+        };
+        static table_init Init; // thread safe since C++11
+        return &Init.Tables;
+    }
+    
+    inline f32
+        SRGBToLinear(u8 Value)
+    {
+        return GetSRGBTables()->ToLinear[Value];
+    }
+    
+    // correctly rounded (to the nearest code in sRGB space)
+    inline u8
+        LinearToSRGB(const srgb_tables *T, f32 Value)
+    {
+        Value = Value > 0.0f? (Value < 1.0f? Value: 1.0f): 0.0f; // also takes care of nan
+        u32 Code = T->FromLinear[(int)(Value * 4095.0f)];
+        //NOTE(chen): buckets are narrower than the distance between two codes, so
+        //            at most one threshold can fall inside a bucket
+        Code += Value > T->Thresholds[Code];
+        return (u8)Code;
+    }
+    
+    inline u8
+        LinearToSRGB(f32 Value)
+    {
+        return LinearToSRGB(GetSRGBTables(), Value);
+    }
+    
+    //
+    //
+    // conversion, everything goes through linear RGBA f32
+    
+    // Count pixels of Format to 4 * Count floats
+    inline void
+        LoadPixels(f32 *Dest, const void *Src, pixel_format Format, int Count)
+    {
+        const u8 *In = (const u8 *)Src;
+        int I = 0;
+        switch (Format)
+        {
+            case PixelFormat_RGBA8:
+            {
+#if CH_SSE2
+                __m128 Scale = _mm_set1_ps(1.0f / 255.0f);
+                __m128i Zero = _mm_setzero_si128();
+                for (; I + 4 <= Count; I += 4)
+                {
+                    __m128i Pixels = _mm_loadu_si128((const __m128i *)(In + 4 * I));
+                    __m128i Low = _mm_unpacklo_epi8(Pixels, Zero);
+                    __m128i High = _mm_unpackhi_epi8(Pixels, Zero);
+                    f32 *Out = Dest + 4 * I;
+                    _mm_storeu_ps(Out + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Low, Zero)), Scale));
+                    _mm_storeu_ps(Out + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Low, Zero)), Scale));
+                    _mm_storeu_ps(Out + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(High, Zero)), Scale));
+                    _mm_storeu_ps(Out + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(High, Zero)), Scale));
+                }
+#endif
+                for (I *= 4; I < 4 * Count; ++I)
+                {
+                    Dest[I] = In[I] * (1.0f / 255.0f);
+                }
+            } break;
+            
+            case PixelFormat_RGBA8_SRGB:
+            {
+                const f32 *ToLinear = GetSRGBTables()->ToLinear;
+                for (; I < Count; ++I)
+                {
+                    Dest[4*I + 0] = ToLinear[In[4*I + 0]];
+                    Dest[4*I + 1] = ToLinear[In[4*I + 1]];
+                    Dest[4*I + 2] = ToLinear[In[4*I + 2]];
+                    Dest[4*I + 3] = In[4*I + 3] * (1.0f / 255.0f);
+                }
+            } break;
+            
+            case PixelFormat_RGBA16F:
+            {
+                UnpackHalf(Dest, (u16 *)In, 4 * Count);
+            } break;
+            
+            case PixelFormat_RGBA32F:
+            {
+                memcpy(Dest, In, (size_t)Count * 16);
+            } break;
+            
+            case PixelFormat_R32F:
+            {
+                for (; I < Count; ++I)
+                {
+                    memcpy(Dest + 4 * I, In + 4 * I, 4);
+                    Dest[4*I + 1] = 0.0f;
+                    Dest[4*I + 2] = 0.0f;
+                    Dest[4*I + 3] = 1.0f;
+                }
+            } break;
+        }
+    }
+    
+    // 4 * Count floats to Count pixels of Format, unorm formats clamp and round to nearest
+    inline void
+        StorePixels(void *Dest, const f32 *Src, pixel_format Format, int Count)
+    {
+        u8 *Out = (u8 *)Dest;
+        int I = 0;
+        switch (Format)
+        {
+            case PixelFormat_RGBA8:
+            {
+#if CH_SSE2
+                __m128 Scale = _mm_set1_ps(255.0f);
+                __m128 Max = _mm_set1_ps(255.0f);
+                __m128 Half = _mm_set1_ps(0.5f);
+                __m128 Zero = _mm_setzero_ps();
+                for (; I + 4 <= Count; I += 4)
+                {
+                    const f32 *In = Src + 4 * I;
+                    __m128i Q[4];
+                    for (int K = 0; K < 4; ++K)
+                    {
+                        // max first so nan becomes 0
+                        __m128 V = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(In + 4 * K), Scale), Zero), Max);
+                        Q[K] = _mm_cvttps_epi32(_mm_add_ps(V, Half));
+                    }
+                    __m128i Packed = _mm_packus_epi16(_mm_packs_epi32(Q[0], Q[1]), _mm_packs_epi32(Q[2], Q[3]));
+                    _mm_storeu_si128((__m128i *)(Out + 4 * I), Packed);
+                }
+#endif
+                for (I *= 4; I < 4 * Count; ++I)
+                {
+                    f32 V = Src[I] * 255.0f;
+                    V = V > 0.0f? (V < 255.0f? V: 255.0f): 0.0f;
+                    Out[I] = (u8)(V + 0.5f);
+                }
+            } break;
+            
+            case PixelFormat_RGBA8_SRGB:
+            {
+                const srgb_tables *T = GetSRGBTables();
+#if CH_SSE2
+                // clamping, bucket indices and alpha in SSE, only the table walk is scalar
+                __m128 Zero = _mm_setzero_ps();
+                __m128 One = _mm_set1_ps(1.0f);
+                __m128 Scale = _mm_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f);
+                __m128 Bias = _mm_setr_ps(0.0f, 0.0f, 0.0f, 0.5f);
+                for (; I < Count; ++I)
+                {
+                    __m128 V = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(Src + 4 * I), Zero), One);
+                    f32 Clamped[4];
+                    i32 Index[4];
+                    _mm_storeu_ps(Clamped, V);
+                    _mm_storeu_si128((__m128i *)Index, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(V, Scale), Bias)));
+                    for (int C = 0; C < 3; ++C)
+                    {
+                        u32 Code = T->FromLinear[Index[C]];
+                        Out[4*I + C] = (u8)(Code + (Clamped[C] > T->Thresholds[Code]));
+                    }
+                    Out[4*I + 3] = (u8)Index[3];
+                }
+#endif
+                for (; I < Count; ++I)
+                {
+                    Out[4*I + 0] = LinearToSRGB(T, Src[4*I + 0]);
+                    Out[4*I + 1] = LinearToSRGB(T, Src[4*I + 1]);
+                    Out[4*I + 2] = LinearToSRGB(T, Src[4*I + 2]);
+                    f32 A = Src[4*I + 3] * 255.0f;
+                    A = A > 0.0f? (A < 255.0f? A: 255.0f): 0.0f;
+                    Out[4*I + 3] = (u8)(A + 0.5f);
+                }
+            } break;
+            
+            case PixelFormat_RGBA16F:
+            {
+                PackHalf((u16 *)Out, (f32 *)Src, 4 * Count);
+            } break;
+            
+            case PixelFormat_RGBA32F:
+            {
+                memcpy(Out, Src, (size_t)Count * 16);
+            } break;
+            
+            case PixelFormat_R32F:
+            {
+                for (; I < Count; ++I)
+                {
+                    memcpy(Out + 4 * I, Src + 4 * I, 4);
+                }
+            } break;
+        }
+    }
+    
+    // Count pixels from one format to another
+    inline void
+        ConvertPixels(void *Dest, pixel_format DestFormat, const void *Src, pixel_format SrcFormat, int Count)
+    {
+        if (DestFormat == SrcFormat)
+        {
+            memcpy(Dest, Src, (size_t)Count * GetPixelSize(SrcFormat));
+            return;
+        }
+        
+        // through the stack in chunks that stay in L1
+        f32 Linear[4 * 256];
+        int SrcSize = GetPixelSize(SrcFormat);
+        int DestSize = GetPixelSize(DestFormat);
+        for (int I = 0; I < Count; I += 256)
+        {
+            int ChunkCount = Count - I < 256? Count - I: 256;
+            LoadPixels(Linear, (const u8 *)Src + (size_t)SrcSize * I, SrcFormat, ChunkCount);
+            StorePixels((u8 *)Dest + (size_t)DestSize * I, Linear, DestFormat, ChunkCount);
+        }
+    }
+    
+    // pitches in bytes, ThreadCount <= 0 uses all hardware threads
+    inline void
+        ConvertImage(void *Dest, size_t DestPitch, pixel_format DestFormat,
+                     const void *Src, size_t SrcPitch, pixel_format SrcFormat,
+                     int Width, int Height, int ThreadCount)
+    {
+        ThreadCount = ResolveThreadCount(ThreadCount, (u64)Width * Height);
+        ImageParallel(ThreadCount, [&](int ThreadI)
+                      {
+                          int Begin = int(i64(Height) * ThreadI / ThreadCount);
+                          int End = int(i64(Height) * (ThreadI + 1) / ThreadCount);
+                          for (int Y = Begin; Y < End; ++Y)
+                          {
+                              ConvertPixels((u8 *)Dest + DestPitch * Y, DestFormat,
+                                            (const u8 *)Src + SrcPitch * Y, SrcFormat, Width);
+                          }
+                      });
+    }
+    
+    //
+    //
+    // mip chains
+    
+    struct mip_kernel
+    {
+        int TapCount;
+        int FirstOffset; // source texel of tap 0 is 2 * X + FirstOffset
+        f32 Weights[8];
+    };
+    
+    inline f64
+        BesselI0(f64 X)
+    {
+        f64 Sum = 1.0;
+        f64 Term = 1.0;
+        for (int K = 1; K < 32; ++K)
+        {
+            Term *= (X / (2.0 * K)) * (X / (2.0 * K));
+            Sum += Term;
+        }
+        return Sum;
+    }
+    
+    inline mip_kernel
+        GetMipKernel(mip_filter Filter, bool Halving)
+    {
+        mip_kernel Kernel = {};
+        if (!Halving)
+        {
+            // the axis is already 1 texel wide
+            Kernel.TapCount = 1;
+            Kernel.Weights[0] = 1.0f;
+        }
+        else if (Filter == MipFilter_Box)
+        {
+            Kernel.TapCount = 2;
+            Kernel.Weights[0] = 0.5f;
+            Kernel.Weights[1] = 0.5f;
+        }
+        else
+        {
+            //NOTE(chen): taps sit at -3.5..3.5 source texels from the destination
+            //            texel's center, sinc is evaluated in destination texels and
+            //            windowed over 2 destination texels either side (beta = 4)
+            Kernel.TapCount = 8;
+            Kernel.FirstOffset = -3;
+            f64 Beta = 4.0;
+            f64 Sum = 0.0;
+            f64 Weights[8];
+            for (int I = 0; I < 8; ++I)
+            {
+                f64 T = 0.5 * (I - 3.5);
+                f64 Pi = 3.14159265358979323846;
+                f64 Sinc = sin(Pi * T) / (Pi * T);
+                f64 Window = BesselI0(Beta * sqrt(1.0 - (T / 2.0) * (T / 2.0))) / BesselI0(Beta);
+                Weights[I] = Sinc * Window;
+                Sum += Weights[I];
+            }
+            for (int I = 0; I < 8; ++I)
+            {
+                Kernel.Weights[I] = (f32)(Weights[I] / Sum);
+            }
+        }
+        return Kernel;
+    }
+    
+    // Out[X] = sum of Weights[I] * In[2X + FirstOffset + I], clamped at the edges. 4 floats per texel
+    inline void
+        FilterRowHorizontal(f32 *Out, int OutWidth, const f32 *In, int InWidth, const mip_kernel *Kernel)
+    {
+#if CH_SSE2
+        __m128 Weights[8];
+        for (int I = 0; I < Kernel->TapCount; ++I)
+        {
+            Weights[I] = _mm_set1_ps(Kernel->Weights[I]);
+        }
+#endif
+        for (int X = 0; X < OutWidth; ++X)
+        {
+            int First = 2 * X + Kernel->FirstOffset;
+            if (Kernel->TapCount == 1) First = X;
+            bool Interior = First >= 0 && First + Kernel->TapCount <= InWidth;
+#if CH_SSE2
+            __m128 Sum = _mm_setzero_ps();
+            if (Interior)
+            {
+                const f32 *Taps = In + 4 * First;
+                for (int I = 0; I < Kernel->TapCount; ++I)
+                {
+                    Sum = _mm_add_ps(Sum, _mm_mul_ps(Weights[I], _mm_loadu_ps(Taps + 4 * I)));
+                }
+            }
+            else
+            {
+                for (int I = 0; I < Kernel->TapCount; ++I)
+                {
+                    int S = First + I;
+                    S = S < 0? 0: (S >= InWidth? InWidth - 1: S);
+                    Sum = _mm_add_ps(Sum, _mm_mul_ps(Weights[I], _mm_loadu_ps(In + 4 * S)));
+                }
+            }
+            _mm_storeu_ps(Out + 4 * X, Sum);
+#else
+            f32 Sum[4] = {};
+            for (int I = 0; I < Kernel->TapCount; ++I)
+            {
+                int S = First + I;
+                if (!Interior) S = S < 0? 0: (S >= InWidth? InWidth - 1: S);
+                for (int C = 0; C < 4; ++C) Sum[C] += Kernel->Weights[I] * In[4*S + C];
+            }
+            memcpy(Out + 4 * X, Sum, sizeof(Sum));
+#endif
+        }
+    }
+    
+    // Out = sum of Weights[I] * Rows[I], Count floats
+    inline void
+        FilterRowsVertical(f32 *Out, const f32 *const *Rows, const mip_kernel *Kernel, int Count)
+    {
+        int I = 0;
+#if CH_SSE2
+        __m128 Weights[8];
+        for (int Tap = 0; Tap < Kernel->TapCount; ++Tap)
+        {
+            Weights[Tap] = _mm_set1_ps(Kernel->Weights[Tap]);
+        }
+        for (; I + 4 <= Count; I += 4)
+        {
+            __m128 Sum = _mm_mul_ps(Weights[0], _mm_loadu_ps(Rows[0] + I));
+            for (int Tap = 1; Tap < Kernel->TapCount; ++Tap)
+            {
+                Sum = _mm_add_ps(Sum, _mm_mul_ps(Weights[Tap], _mm_loadu_ps(Rows[Tap] + I)));
+            }
+            _mm_storeu_ps(Out + I, Sum);
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            f32 Sum = Kernel->Weights[0] * Rows[0][I];
+            for (int Tap = 1; Tap < Kernel->TapCount; ++Tap)
+            {
+                Sum += Kernel->Weights[Tap] * Rows[Tap][I];
+            }
+            Out[I] = Sum;
+        }
+    }
+    
+    // exact (A + B + C + D + 2) / 4 per channel, both axes halve
+    inline void
+        DownsampleBoxRGBA8(image_level *Dest, const image_level *Src, int FirstRow, int EndRow)
+    {
+        for (int Y = FirstRow; Y < EndRow; ++Y)
+        {
+            const u8 *A = (const u8 *)Src->Pixels + Src->Pitch * (2 * Y);
+            const u8 *B = (const u8 *)Src->Pixels + Src->Pitch * (2 * Y + 1);
+            u8 *Out = (u8 *)Dest->Pixels + Dest->Pitch * Y;
+            
+            int X = 0;
+#if CH_SSE2
+            __m128i Zero = _mm_setzero_si128();
+            __m128i Two = _mm_set1_epi16(2);
+            for (; X + 4 <= Dest->Width; X += 4)
+            {
+                __m128i Result[2];
+                for (int Half = 0; Half < 2; ++Half)
+                {
+                    // 4 source texels in each row -> 2 destination texels
+                    __m128i RowA = _mm_loadu_si128((const __m128i *)(A + 8 * X + 16 * Half));
+                    __m128i RowB = _mm_loadu_si128((const __m128i *)(B + 8 * X + 16 * Half));
+                    __m128i Sum01 = _mm_add_epi16(_mm_unpacklo_epi8(RowA, Zero), _mm_unpacklo_epi8(RowB, Zero));
+                    __m128i Sum23 = _mm_add_epi16(_mm_unpackhi_epi8(RowA, Zero), _mm_unpackhi_epi8(RowB, Zero));
+                    Sum01 = _mm_add_epi16(Sum01, _mm_shuffle_epi32(Sum01, _MM_SHUFFLE(1, 0, 3, 2)));
+                    Sum23 = _mm_add_epi16(Sum23, _mm_shuffle_epi32(Sum23, _MM_SHUFFLE(1, 0, 3, 2)));
+                    __m128i Sum = _mm_unpacklo_epi64(Sum01, Sum23);
+                    Result[Half] = _mm_srli_epi16(_mm_add_epi16(Sum, Two), 2);
+                }
+                _mm_storeu_si128((__m128i *)(Out + 4 * X), _mm_packus_epi16(Result[0], Result[1]));
+            }
+#endif
+            for (; X < Dest->Width; ++X)
+            {
+                for (int C = 0; C < 4; ++C)
+                {
+                    u32 Sum = (u32)A[8*X + C] + A[8*X + 4 + C] + B[8*X + C] + B[8*X + 4 + C];
+                    Out[4*X + C] = (u8)((Sum + 2) >> 2);
+                }
+            }
+        }
+    }
+    
+    // destination rows [FirstRow, EndRow) of Dest from Src, through linear float rows
+    inline void
+        DownsampleRows(image_level *Dest, const image_level *Src, pixel_format Format,
+                       const mip_kernel *KernelX, const mip_kernel *KernelY, int FirstRow, int EndRow)
+    {
+        //NOTE(chen): horizontally filtered source rows live in a ring, tagged with the
+        //            source row they hold. Consecutive destination rows share most
+        //            of their source rows, each one gets loaded and filtered once.
+        int RingSize = KernelY->TapCount + 2;
+        size_t RowFloats = 4 * (size_t)Dest->Width;
+        f32 *SourceRow = (f32 *)malloc(sizeof(f32) * 4 * Src->Width);
+        f32 *Ring = (f32 *)malloc(sizeof(f32) * RowFloats * RingSize);
+        f32 *OutRow = (f32 *)malloc(sizeof(f32) * RowFloats);
+        int Tags[16];
+        for (int I = 0; I < RingSize; ++I) Tags[I] = -1;
+        
+        for (int Y = FirstRow; Y < EndRow; ++Y)
+        {
+            const f32 *Rows[8];
+            int First = KernelY->TapCount == 1? Y: 2 * Y + KernelY->FirstOffset;
+            for (int Tap = 0; Tap < KernelY->TapCount; ++Tap)
+            {
+                int S = First + Tap;
+                S = S < 0? 0: (S >= Src->Height? Src->Height - 1: S);
+                int Slot = S % RingSize;
+                f32 *Row = Ring + RowFloats * Slot;
+                if (Tags[Slot] != S)
+                {
+                    LoadPixels(SourceRow, (const u8 *)Src->Pixels + Src->Pitch * S, Format, Src->Width);
+                    FilterRowHorizontal(Row, Dest->Width, SourceRow, Src->Width, KernelX);
+                    Tags[Slot] = S;
+                }
+                Rows[Tap] = Row;
+            }
+            
+            FilterRowsVertical(OutRow, Rows, KernelY, (int)RowFloats);
+            StorePixels((u8 *)Dest->Pixels + Dest->Pitch * Y, OutRow, Format, Dest->Width);
+        }
+        
+        free(OutRow);
+        free(Ring);
+        free(SourceRow);
+    }
+    
+    inline void
+        DownsampleLevel(image_level *Dest, const image_level *Src, pixel_format Format, mip_filter Filter, int ThreadCount)
+    {
+        bool HalveX = Dest->Width < Src->Width;
+        bool HalveY = Dest->Height < Src->Height;
+        mip_kernel KernelX = GetMipKernel(Filter, HalveX);
+        mip_kernel KernelY = GetMipKernel(Filter, HalveY);
+        bool IntegerBox = Filter == MipFilter_Box && Format == PixelFormat_RGBA8 && HalveX && HalveY;
+        
+        ThreadCount = ResolveThreadCount(ThreadCount, (u64)Dest->Width * Dest->Height);
+        ImageParallel(ThreadCount, [&](int ThreadI)
+                      {
+                          int Begin = int(i64(Dest->Height) * ThreadI / ThreadCount);
+                          int End = int(i64(Dest->Height) * (ThreadI + 1) / ThreadCount);
+                          if (IntegerBox)
+                          {
+                              DownsampleBoxRGBA8(Dest, Src, Begin, End);
+                          }
+                          else
+                          {
+                              DownsampleRows(Dest, Src, Format, &KernelX, &KernelY, Begin, End);
+                          }
+                      });
+    }
+    
+    // LevelCount <= 0 allocates the full chain down to 1x1, level 0 is left uninitialized
+    inline mip_chain
+        AllocateMipChain(int Width, int Height, pixel_format Format, int LevelCount = 0)
+    {
+        mip_chain Chain = {};
+        int MaxLevels = GetMipLevelCount(Width, Height);
+        if (Width <= 0 || Height <= 0)
+        {
+            return Chain;
+        }
+        if (LevelCount <= 0 || LevelCount > MaxLevels)
+        {
+            LevelCount = MaxLevels;
+        }
+        
+        size_t Offsets[CH_MAX_MIP_LEVELS];
+        size_t TotalSize = 0;
+        for (int LevelI = 0; LevelI < LevelCount; ++LevelI)
+        {
+            image_level *Level = &Chain.Levels[LevelI];
+            Level->Width = Width;
+            Level->Height = Height;
+            Level->Pitch = ((size_t)Width * GetPixelSize(Format) + 63) & ~(size_t)63;
+            Offsets[LevelI] = TotalSize;
+            TotalSize += Level->Pitch * Height;
+            Width = Width > 1? Width / 2: 1;
+            Height = Height > 1? Height / 2: 1;
+        }
+        
+        Chain.Allocation = malloc(TotalSize + 64);
+        if (!Chain.Allocation)
+        {
+            return {};
+        }
+        u8 *Base = (u8 *)(((uintptr_t)Chain.Allocation + 63) & ~(uintptr_t)63);
+        for (int LevelI = 0; LevelI < LevelCount; ++LevelI)
+        {
+            Chain.Levels[LevelI].Pixels = Base + Offsets[LevelI];
+        }
+        Chain.Format = Format;
+        Chain.LevelCount = LevelCount;
+        return Chain;
+    }
+    
+    inline void
+        FreeMipChain(mip_chain *Chain)
+    {
+        free(Chain->Allocation);
+        *Chain = {};
+    }
+    
+    // fills levels 1.. from level 0
+    inline void
+        GenerateMips(mip_chain *Chain, mip_filter Filter, int ThreadCount)
+    {
+        for (int LevelI = 1; LevelI < Chain->LevelCount; ++LevelI)
+        {
+            DownsampleLevel(&Chain->Levels[LevelI], &Chain->Levels[LevelI - 1], Chain->Format, Filter, ThreadCount);
+        }
+    }
+    
+    // copies Pixels into level 0 and generates the rest, Chain.Allocation == 0 on failure
+    inline mip_chain
+        BuildMipChain(const void *Pixels, size_t Pitch, int Width, int Height, pixel_format Format,
+                      mip_filter Filter, int ThreadCount, int LevelCount = 0)
+    {
+        mip_chain Chain = AllocateMipChain(Width, Height, Format, LevelCount);
+        if (Chain.Allocation)
+        {
+            image_level *Base = &Chain.Levels[0];
+            CopyRows(Base->Pixels, Base->Pitch, Pixels, Pitch, (size_t)Width * GetPixelSize(Format), Height);
+            GenerateMips(&Chain, Filter, ThreadCount);
+        }
+        return Chain;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,684 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch::job_system *Jobs = ch::CreateJobSystem(0); // all hardware threads, the caller is thread 0
+
+// fire and wait
+ch::job_counter Loaded;
+for (int I = 0; I < MeshCount; ++I)
+{
+    ch::RunJob(Jobs, [=]() { LoadMesh(Paths[I], &Meshes[I]); }, &Loaded);
+}
+ch::WaitForCounter(Jobs, &Loaded); // runs jobs until they are all done
+
+// dependencies: BuildBVH jobs start once everything on Loaded has finished
+ch::job_counter Built;
+for (int I = 0; I < MeshCount; ++I)
+{
+    ch::RunJob(Jobs, [=]() { BuildBVH(&Meshes[I]); }, &Built, &Loaded);
+}
+
+// parallel-for, Work(Begin, End) gets ranges of at most GrainSize indices
+ch::ParallelFor(Jobs, 0, VertexCount, 4096, [&](i64 Begin, i64 End)
+{
+    for (i64 I = Begin; I < End; ++I) Positions[I] = Positions[I] * Transform;
+});
+
+ch::DestroyJobSystem(Jobs);
+
+Scheduling:
+
+Every thread of the system owns a Chase-Lev deque. A thread pushes and pops the
+bottom of its own deque (LIFO, the data is still in cache), idle threads steal
+from the top of a random other deque (FIFO, the oldest and biggest pieces of
+work). ParallelFor splits its range in halves: the first half is worked on, the
+second is pushed and can be stolen and split again. So a thief takes half of
+what's left instead of one grain. Idle workers spin for a short while and then
+sleep until a job is pushed.
+
+Counters:
+
+A job_counter counts unfinished jobs. RunJob adds one, the job finishing takes
+it away. WaitForCounter never blocks, it runs (or steals) other jobs until the
+counter is 0, which is also how jobs can wait for other jobs. A job given a
+dependency counter is parked on it and pushed when it reaches 0 (right away if
+it already is). A counter must outlive the jobs counted on it and the jobs
+parked on it, wait for it before it goes out of scope.
+
+Threads:
+
+The thread that creates the system is thread 0. Its jobs and those of the
+workers go into their deques. Any other thread may call everything too, but
+the jobs it runs execute right away on that thread (after waiting for the
+dependency) and its waits only steal. Jobs are stored in place: the callable
+(a lambda and its captures) must fit in CH_JOB_STORAGE bytes, capture big
+things by reference or pointer. Each thread has CH_JOBS_PER_THREAD job slots
+and deque entries, a thread with a full deque runs its new jobs right away.
+*/
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#define CH_JOBS_PAUSE() _mm_pause()
+#else
+#define CH_JOBS_PAUSE()
+#endif
+
+// the same as ch_math.h's and kernel.h's, this header goes with either
+typedef uint8_t u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int64_t i64;
+
+#ifndef CH_JOBS_PER_THREAD
+#define CH_JOBS_PER_THREAD 4096 // power of 2
+#endif
+
+#ifndef CH_JOB_STORAGE
+#define CH_JOB_STORAGE 96 // bytes for the callable, the job is 128 bytes
+#endif
+
+#ifndef CH_JOBS_SPIN_COUNT
+#define CH_JOBS_SPIN_COUNT 256 // idle loops before a worker sleeps
+#endif
+
+namespace ch
+{
+    //
+    //
+    // jobs and counters
+    
+    struct job;
+    
+    // State is the unfinished job count times 2, bit 0 locks Parked
+    struct job_counter
+    {
+        std::atomic<u32> State;
+        std::atomic<job *> Parked; // jobs waiting for State to reach 0, linked by Next
+        
+        job_counter(): State(0), Parked(0)
+        {
+        }
+    };
+    
+    struct job
+    {
+        void (*Function)(job *Job); // runs and destroys the callable in Storage
+        job_counter *Counter;
+        job *Next;
+        std::atomic<u32> InUse;
+        alignas(16) u8 Storage[CH_JOB_STORAGE];
+    };
+    
+    //
+    //
+    // Chase-Lev deque
+    
+    //NOTE(chen): fixed size, a full deque fails the push. Seq-cst loads and stores
+    //            instead of the paper's standalone fences, they cost the same on x86
+    //            and thread sanitizers understand them
+    struct job_deque
+    {
+        std::atomic<i64> Bottom; // owner only writes
+        u8 Padding[64];
+        std::atomic<i64> Top;    // thieves advance it
+        u8 Padding2[64];
+        std::atomic<job *> *Slots;
+        i64 Mask;
+    };
+    
+    inline void
+        InitJobDeque(job_deque *Deque, u32 Capacity)
+    {
+        Deque->Bottom.store(0, std::memory_order_relaxed);
+        Deque->Top.store(0, std::memory_order_relaxed);
+        Deque->Slots = new std::atomic<job *>[Capacity]();
+        Deque->Mask = i64(Capacity) - 1;
+    }
+    
+    inline void
+        FreeJobDeque(job_deque *Deque)
+    {
+        delete[] Deque->Slots;
+        Deque->Slots = 0;
+    }
+    
+    // owner only, false if it's full
+    inline bool
+        PushJob(job_deque *Deque, job *Job)
+    {
+        i64 Bottom = Deque->Bottom.load(std::memory_order_relaxed);
+        i64 Top = Deque->Top.load(std::memory_order_acquire);
+        if (Bottom - Top > Deque->Mask)
+        {
+            return false;
+        }
+        Deque->Slots[Bottom & Deque->Mask].store(Job, std::memory_order_relaxed);
+        Deque->Bottom.store(Bottom + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // owner only, the newest job or 0
+    inline job *
+        PopJob(job_deque *Deque)
+    {
+        i64 Bottom = Deque->Bottom.load(std::memory_order_relaxed) - 1;
+        Deque->Bottom.store(Bottom, std::memory_order_seq_cst);
+        i64 Top = Deque->Top.load(std::memory_order_seq_cst);
+        if (Top > Bottom)
+        {
+            Deque->Bottom.store(Bottom + 1, std::memory_order_release);
+            return 0;
+        }
+        
+        job *Job = Deque->Slots[Bottom & Deque->Mask].load(std::memory_order_relaxed);
+        if (Top == Bottom)
+        {
+            // the last one, thieves may be after it too
+            if (!Deque->Top.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                Job = 0;
+            }
+            Deque->Bottom.store(Bottom + 1, std::memory_order_release);
+        }
+        return Job;
+    }
+    
+    // any thread, the oldest job or 0. Contended is set when another thread won the race
+    inline job *
+        StealJob(job_deque *Deque, bool *Contended)
+    {
+        i64 Top = Deque->Top.load(std::memory_order_seq_cst);
+        i64 Bottom = Deque->Bottom.load(std::memory_order_seq_cst);
+        if (Top >= Bottom)
+        {
+            return 0;
+        }
+        
+        job *Job = Deque->Slots[Top & Deque->Mask].load(std::memory_order_relaxed);
+        if (!Deque->Top.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            *Contended = true;
+            return 0;
+        }
+        return Job;
+    }
+    
+    //
+    //
+    // job system
+    
+    struct job_system;
+    
+    struct job_worker
+    {
+        job_deque Deque;
+        job *Jobs; // CH_JOBS_PER_THREAD slots, reused round robin
+        u64 NextJob;
+        job_system *System;
+        int Index;
+        std::thread Thread;
+    };
+    
+    struct job_system
+    {
+        job_worker *Workers;
+        int WorkerCount;
+        
+        std::atomic<i64> Pending; // jobs in deques, a hint for sleeping
+        std::atomic<int> Sleeping;
+        std::atomic<bool> Quit;
+        std::mutex SleepLock;
+        std::condition_variable WakeUp;
+    };
+    
+    inline job_worker *&
+        GetJobWorkerSlot()
+    {
+        static thread_local job_worker *Worker = 0;
+        return Worker;
+    }
+    
+    // 0 on threads that aren't part of System
+    inline job_worker *
+        GetJobWorker(job_system *System)
+    {
+        job_worker *Worker = GetJobWorkerSlot();
+        return Worker && Worker->System == System? Worker: 0;
+    }
+    
+    inline int
+        GetJobThreadCount(job_system *System)
+    {
+        return System->WorkerCount;
+    }
+    
+    // 0 to GetJobThreadCount - 1, -1 on threads that aren't part of System. For per-thread scratch memory
+    inline int
+        GetJobThreadIndex(job_system *System)
+    {
+        job_worker *Worker = GetJobWorker(System);
+        return Worker? Worker->Index: -1;
+    }
+    
+    inline u32
+        GetJobRandom()
+    {
+        static thread_local u32 State = 0;
+        if (!State)
+        {
+            State = u32(uintptr_t(&State) >> 4) * 2654435761u | 1;
+        }
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        return State;
+    }
+    
+    inline void ExecuteJob(job_system *System, job *Job);
+    
+    // from a thread of System onto its deque, other threads run it right away
+    inline void
+        ScheduleJob(job_system *System, job *Job)
+    {
+        job_worker *Worker = GetJobWorker(System);
+        if (!Worker || !PushJob(&Worker->Deque, Job))
+        {
+            ExecuteJob(System, Job);
+            return;
+        }
+        
+        //NOTE(chen): seq-cst on both sides, a worker going to sleep either sees the
+        //            pending job or is seen as sleeping and gets woken
+        System->Pending.fetch_add(1, std::memory_order_seq_cst);
+        if (System->Sleeping.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard<std::mutex> Lock(System->SleepLock);
+            System->WakeUp.notify_one();
+        }
+    }
+    
+    inline void
+        AddToJobCounter(job_counter *Counter)
+    {
+        u32 State = Counter->State.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (State & 1)
+            {
+                CH_JOBS_PAUSE();
+                State = Counter->State.load(std::memory_order_relaxed);
+            }
+            else if (Counter->State.compare_exchange_weak(State, State + 2, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+    }
+    
+    // the finishing job's part, the last one schedules the parked jobs
+    inline void
+        FinishJobCounter(job_system *System, job_counter *Counter)
+    {
+        u32 State = Counter->State.load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (State & 1)
+            {
+                CH_JOBS_PAUSE();
+                State = Counter->State.load(std::memory_order_acquire);
+            }
+            else if (State == 2)
+            {
+                //NOTE(chen): the last one always takes the lock and reads Parked under it. Seeing
+                //            no parked job and then going 2 -> 0 unlocked would lose a job
+                //            ParkJob pushed in between (it locks 2 -> 3 and stores 2 back)
+                if (Counter->State.compare_exchange_weak(State, 3, std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    job *Parked = Counter->Parked.exchange(0, std::memory_order_relaxed);
+                    
+                    // the last touch, waiters may free the counter from here on
+                    Counter->State.store(0, std::memory_order_release);
+                    while (Parked)
+                    {
+                        job *Next = Parked->Next;
+                        ScheduleJob(System, Parked);
+                        Parked = Next;
+                    }
+                    return;
+                }
+            }
+            else if (Counter->State.compare_exchange_weak(State, State - 2, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                return;
+            }
+        }
+    }
+    
+    // Job runs once Dependency reaches 0
+    inline void
+        ParkJob(job_system *System, job_counter *Dependency, job *Job)
+    {
+        u32 State = Dependency->State.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (State & 1)
+            {
+                CH_JOBS_PAUSE();
+                State = Dependency->State.load(std::memory_order_relaxed);
+            }
+            else if (Dependency->State.compare_exchange_weak(State, State | 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        
+        if (State == 0)
+        {
+            Dependency->State.store(0, std::memory_order_release);
+            ScheduleJob(System, Job);
+            return;
+        }
+        Job->Next = Dependency->Parked.load(std::memory_order_relaxed);
+        Dependency->Parked.store(Job, std::memory_order_relaxed);
+        Dependency->State.store(State, std::memory_order_release);
+    }
+    
+    inline void
+        ExecuteJob(job_system *System, job *Job)
+    {
+        Job->Function(Job);
+        job_counter *Counter = Job->Counter;
+        Job->InUse.store(0, std::memory_order_release);
+        if (Counter)
+        {
+            FinishJobCounter(System, Counter);
+        }
+    }
+    
+    inline job *
+        StealJobFromAny(job_system *System, job_worker *Thief)
+    {
+        int Count = System->WorkerCount;
+        for (;;)
+        {
+            bool Contended = false;
+            int Start = int(GetJobRandom() % u32(Count));
+            for (int I = 0; I < Count; ++I)
+            {
+                job_worker *Victim = &System->Workers[(Start + I) % Count];
+                if (Victim == Thief) continue;
+                
+                job *Job = StealJob(&Victim->Deque, &Contended);
+                if (Job)
+                {
+                    return Job;
+                }
+            }
+            if (!Contended)
+            {
+                return 0;
+            }
+        }
+    }
+    
+    // one job from Worker's deque or stolen, Worker is 0 on threads outside System
+    inline bool
+        TryRunJob(job_system *System, job_worker *Worker)
+    {
+        job *Job = Worker? PopJob(&Worker->Deque): 0;
+        if (!Job)
+        {
+            Job = StealJobFromAny(System, Worker);
+        }
+        if (!Job)
+        {
+            return false;
+        }
+        System->Pending.fetch_sub(1, std::memory_order_relaxed);
+        ExecuteJob(System, Job);
+        return true;
+    }
+    
+    inline bool
+        IsCounterDone(job_counter *Counter)
+    {
+        return Counter->State.load(std::memory_order_acquire) == 0;
+    }
+    
+    // runs other jobs until Counter is 0
+    inline void
+        WaitForCounter(job_system *System, job_counter *Counter)
+    {
+        job_worker *Worker = GetJobWorker(System);
+        int Idle = 0;
+        while (!IsCounterDone(Counter))
+        {
+            if (TryRunJob(System, Worker))
+            {
+                Idle = 0;
+            }
+            else if (++Idle < 64)
+            {
+                CH_JOBS_PAUSE();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    // a free slot of Worker's, helps while they're all taken
+    inline job *
+        AllocateJob(job_system *System, job_worker *Worker)
+    {
+        for (;;)
+        {
+            for (int Try = 0; Try < 8; ++Try)
+            {
+                job *Job = &Worker->Jobs[Worker->NextJob++ & (CH_JOBS_PER_THREAD - 1)];
+                if (!Job->InUse.load(std::memory_order_acquire))
+                {
+                    Job->InUse.store(1, std::memory_order_relaxed);
+                    return Job;
+                }
+            }
+            if (!TryRunJob(System, Worker))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    // Work() runs once on some thread. Counter (optional) counts it until it's done,
+    // with Dependency it only starts once Dependency reaches 0
+    template <typename F>
+        inline void
+        RunJob(job_system *System, F Work, job_counter *Counter = 0, job_counter *Dependency = 0)
+    {
+        static_assert(sizeof(F) <= CH_JOB_STORAGE, "job too big for CH_JOB_STORAGE, capture by reference");
+        static_assert(alignof(F) <= 16, "job callable over-aligned");
+        
+        job_worker *Worker = GetJobWorker(System);
+        if (!Worker)
+        {
+            if (Dependency)
+            {
+                WaitForCounter(System, Dependency);
+            }
+            Work();
+            return;
+        }
+        
+        job *Job = AllocateJob(System, Worker);
+        new (Job->Storage) F(Work);
+        Job->Function = [](job *Self)
+        {
+            F *Stored = (F *)Self->Storage;
+            (*Stored)();
+            Stored->~F();
+        };
+        Job->Counter = Counter;
+        if (Counter)
+        {
+            AddToJobCounter(Counter);
+        }
+        if (Dependency)
+        {
+            ParkJob(System, Dependency, Job);
+        }
+        else
+        {
+            ScheduleJob(System, Job);
+        }
+    }
+    
+    inline void
+        RunJobWorker(job_system *System, job_worker *Worker)
+    {
+        GetJobWorkerSlot() = Worker;
+        int Idle = 0;
+        while (!System->Quit.load(std::memory_order_relaxed))
+        {
+            if (TryRunJob(System, Worker))
+            {
+                Idle = 0;
+            }
+            else if (++Idle < CH_JOBS_SPIN_COUNT / 2)
+            {
+                CH_JOBS_PAUSE();
+            }
+            else if (Idle < CH_JOBS_SPIN_COUNT)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                std::unique_lock<std::mutex> Lock(System->SleepLock);
+                System->Sleeping.fetch_add(1, std::memory_order_seq_cst);
+                while (System->Pending.load(std::memory_order_seq_cst) <= 0 && !System->Quit.load(std::memory_order_relaxed))
+                {
+                    System->WakeUp.wait(Lock);
+                }
+                System->Sleeping.fetch_sub(1, std::memory_order_relaxed);
+                Idle = 0;
+            }
+        }
+        GetJobWorkerSlot() = 0;
+    }
+    
+    // ThreadCount includes the calling thread, <= 0 uses all hardware threads
+    inline job_system *
+        CreateJobSystem(int ThreadCount)
+    {
+        if (ThreadCount <= 0)
+        {
+            ThreadCount = int(std::thread::hardware_concurrency());
+            if (ThreadCount <= 0) ThreadCount = 1;
+        }
+        
+        job_system *System = new job_system();
+        System->Workers = new job_worker[ThreadCount]();
+        System->WorkerCount = ThreadCount;
+        for (int I = 0; I < ThreadCount; ++I)
+        {
+            job_worker *Worker = &System->Workers[I];
+            InitJobDeque(&Worker->Deque, CH_JOBS_PER_THREAD);
+            Worker->Jobs = new job[CH_JOBS_PER_THREAD]();
+            Worker->System = System;
+            Worker->Index = I;
+        }
+        
+        GetJobWorkerSlot() = &System->Workers[0];
+        for (int I = 1; I < ThreadCount; ++I)
+        {
+            System->Workers[I].Thread = std::thread(RunJobWorker, System, &System->Workers[I]);
+        }
+        return System;
+    }
+    
+    // on the creating thread, with every job done
+    inline void
+        DestroyJobSystem(job_system *System)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(System->SleepLock);
+            System->Quit.store(true, std::memory_order_relaxed);
+            System->WakeUp.notify_all();
+        }
+        for (int I = 1; I < System->WorkerCount; ++I)
+        {
+            System->Workers[I].Thread.join();
+        }
+        if (GetJobWorkerSlot() == &System->Workers[0])
+        {
+            GetJobWorkerSlot() = 0;
+        }
+        for (int I = 0; I < System->WorkerCount; ++I)
+        {
+            FreeJobDeque(&System->Workers[I].Deque);
+            delete[] System->Workers[I].Jobs;
+        }
+        delete[] System->Workers;
+        delete System;
+    }
+    
+    //
+    //
+    // parallel-for
+    
+    template <typename F>
+    struct parallel_for_job
+    {
+        job_system *System;
+        F *Work;
+        i64 Begin;
+        i64 End;
+        i64 GrainSize;
+        job_counter *Counter;
+        
+        void operator()() const
+        {
+            // pushes the upper half until a grain is left, thieves get the big halves first
+            i64 RangeEnd = End;
+            while (RangeEnd - Begin > GrainSize)
+            {
+                i64 Middle = Begin + (RangeEnd - Begin) / 2;
+                RunJob(System, parallel_for_job<F>{System, Work, Middle, RangeEnd, GrainSize, Counter}, Counter);
+                RangeEnd = Middle;
+            }
+            (*Work)(Begin, RangeEnd);
+        }
+    };
+    
+    // Work(Begin, End) over [Begin, End) in ranges of at most GrainSize, returns when
+    // they're all done. GrainSize <= 0 makes about 8 ranges per thread
+    template <typename F>
+        inline void
+        ParallelFor(job_system *System, i64 Begin, i64 End, i64 GrainSize, F Work)
+    {
+        if (End <= Begin)
+        {
+            return;
+        }
+        if (GrainSize <= 0)
+        {
+            GrainSize = (End - Begin) / (i64(System->WorkerCount) * 8);
+            if (GrainSize < 1) GrainSize = 1;
+        }
+        
+        job_counter Counter;
+        parallel_for_job<F> Root = {System, &Work, Begin, End, GrainSize, &Counter};
+        Root();
+        WaitForCounter(System, &Counter);
+    }
+};
\ No newline at end of file
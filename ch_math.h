@@ -2,6 +2,7 @@
 #include <math.h>
 #include <float.h>
 #include <stdint.h>
+#include "ch_simd.h"
 
 typedef uint8_t u8;
 typedef uint16_t u16;
@@ -24,7 +25,10 @@ typedef bool b8;
 #define U32Max UINT_MAX
 #define Pi32 3.1415926f
 
+// other headers define it too (ch_d3d12.h), whichever comes first wins
+#ifndef CH_ASSERT
 #define CH_ASSERT(X) do { if (!(X)) *(int *)0 = 0; } while (0)
+#endif
 
 //NOTE(chen): put your own assert here
 #ifndef ASSERT
@@ -36,11 +40,6 @@ struct v2
     f32 X, Y;
 };
 
-struct v2i
-{
-    i32 X, Y;
-};
-
 union v3
 {
     struct
@@ -60,11 +59,6 @@ union v3
     f32 Data[3];
 };
 
-struct v3i
-{
-    i32 X, Y, Z;
-};
-
 union v4
 {
     struct
@@ -93,29 +87,89 @@ struct quaternion
     f32 W;
 };
 
+//NOTE(chen): generic versions of the types above for f64 and i32 (and f32 when
+//            code is shared between them). Data comes first so it's the member
+//            brace init and the generic functions write, X/Y/Z/W alias it.
+//            In a constant expression only go through Data.
+template <typename T, int N>
+union vec
+{
+    T Data[N];
+};
+
+template <typename T>
+union vec<T, 2>
+{
+    T Data[2];
+    
+    struct
+    {
+        T X, Y;
+    };
+};
+
+template <typename T>
+union vec<T, 3>
+{
+    T Data[3];
+    
+    struct
+    {
+        T X, Y, Z;
+    };
+};
+
+template <typename T>
+union vec<T, 4>
+{
+    T Data[4];
+    
+    struct
+    {
+        T X, Y, Z, W;
+    };
+};
+
+// row vectors like mat4, translation lives in the last row
+template <typename T, int N>
+struct mat
+{
+    T Data[N][N];
+};
+
+typedef vec<i32, 2> v2i;
+typedef vec<i32, 3> v3i;
+typedef vec<i32, 4> v4i;
+
+typedef vec<f64, 2> v2d;
+typedef vec<f64, 3> v3d;
+typedef vec<f64, 4> v4d;
+typedef mat<f64, 3> mat3d;
+typedef mat<f64, 4> mat4d;
+
 //
 //
 // Misc
 
-inline f32
+constexpr f32
 Min(f32 A, f32 B)
 {
     return A < B? A: B;
 }
 
-inline f32
+constexpr f32
 Max(f32 A, f32 B)
 {
     return A > B? A: B;
 }
 
-inline v3
+constexpr v3
 Min(v3 A, v3 B)
 {
     return {Min(A.X, B.X), Min(A.Y, B.Y), Min(A.Z, B.Z)};
 }
 
-inline v3
+constexpr v3
 Max(v3 A, v3 B)
 {
     return {Max(A.X, B.X), Max(A.Y, B.Y), Max(A.Z, B.Z)};
@@ -149,13 +203,13 @@ Floor(v3 V)
     return Result;
 }
 
-inline f32
+constexpr f32
 Square(f32 A)
 {
     return A * A;
 }
 
-inline b32
+constexpr b32
 IsInRange(f32 Value, f32 Min, f32 Max)
 {
     return Value >= Min && Value <= Max;
@@ -167,13 +221,13 @@ Abs(f32 A)
     return fabsf(A);
 }
 
-inline f32
+constexpr f32
 MaxF32(f32 A, f32 B)
 {
     return A > B? A: B;
 }
 
-inline f32
+constexpr f32
 MinF32(f32 A, f32 B)
 {
     return A < B? A: B;
@@ -277,7 +331,7 @@ RoundF32ToI32(f32 Value)
     return Result;
 }
 
-inline f32
+constexpr f32
 DegreeToRadian(f32 Degree)
 {
     f32 Result = Degree / 180.0f * Pi32;
@@ -285,7 +339,7 @@ DegreeToRadian(f32 Degree)
 }
 
 template <typename T>
-inline T
+constexpr T
 Clamp(T Value, T Min, T Max)
 {
     if (Value < Min)
@@ -306,34 +360,34 @@ Clamp(T Value, T Min, T Max)
 //
 // Vector
 
-inline v2
+constexpr v2
 V2(f32 A, f32 B)
 {
     return {A, B};
 }
 
-inline v2
+constexpr v2
 V2(f32 A)
 {
     return {A, A};
 }
 
-inline v2
+constexpr v2
 V2(int A, int B)
 {
     return {(f32)A, (f32)B};
 }
 
-inline v2
+constexpr v2
 V2(v3 V)
 {
     return {V.X, V.Y};
 }
 
-inline v3
+constexpr v3
 V3(f32 Float)
 {
-    v3 Result;
+    v3 Result = {};
     
     Result.X = Float;
     Result.Y = Float;
@@ -352,16 +406,16 @@ fmodf(v3 A, v3 B)
     return Result;
 }
 
-inline v3
+constexpr v3
 V3(f32 A, f32 B, f32 C)
 {
     return {A, B, C};
 }
 
-inline v3
+constexpr v3
 V3(v4 V)
 {
-    v3 Result;
+    v3 Result = {};
     
     Result.X = V.X;
     Result.Y = V.Y;
@@ -370,10 +424,10 @@ V3(v4 V)
     return Result;
 }
 
-inline v2
+constexpr v2
 CastToV2(v2i V)
 {
-    v2 Result;
+    v2 Result = {};
     Result = {(f32)V.X, (f32)V.Y};
     return Result;
 }
@@ -394,140 +448,140 @@ SwapF32(f32 *A, f32 *B)
     *B = Temp;
 }
 
-inline v2
+constexpr v2
 operator+(v2 A, v2 B)
 {
     v2 Result = {A.X + B.X, A.Y + B.Y};
     return Result;
 }
 
-inline v2
+constexpr v2
 operator-(v2 A, v2 B)
 {
     v2 Result = {A.X - B.X, A.Y - B.Y};
     return Result;
 }
 
-inline v2
+constexpr v2
 operator*(f32 S, v2 A)
 {
     v2 Result = {A.X * S, A.Y * S};
     return Result;
 }
 
-inline void
+constexpr void
 operator+=(v2 &A, v2 B)
 {
     A = A + B;
 }
 
-inline void
+constexpr void
 operator-=(v2 &A, v2 B)
 {
     A = A - B;
 }
 
-inline void
+constexpr void
 operator*=(v2 &A, f32 B)
 {
     A = B * A;
 }
 
-inline v3
+constexpr v3
 ZeroV3()
 {
     return {};
 }
 
-inline v3
+constexpr v3
 operator+(v3 A, v3 B)
 {
     v3 Result = {A.X + B.X, A.Y + B.Y, A.Z + B.Z};
     return Result;
 }
 
-inline v3
+constexpr v3
 operator-(v3 A, v3 B)
 {
     v3 Result = {A.X - B.X, A.Y - B.Y, A.Z - B.Z};
     return Result;
 }
 
-inline v3 
+constexpr v3
 operator*(v3 A, v3 B)
 {
     v3 Result = {A.X * B.X, A.Y * B.Y, A.Z * B.Z};
     return Result;
 }
 
-inline v3
+constexpr v3
 operator*(f32 S, v3 A)
 {
     v3 Result = {A.X * S, A.Y * S, A.Z * S};
     return Result;
 }
 
-inline v3
+constexpr v3
 operator*(v3 A, f32 S)
 {
     v3 Result = {A.X * S, A.Y * S, A.Z * S};
     return Result;
 }
 
-inline v3
+constexpr v3
 operator/(v3 A, f32 B)
 {
     v3 Result = V3(A.X / B, A.Y / B, A.Z / B);
     return Result;
 }
 
-inline v3
+constexpr v3
 operator/(v3 A, v3 B)
 {
     v3 Result = V3(A.X / B.X, A.Y / B.Y, A.Z / B.Z);
     return Result;
 }
 
-inline void
+constexpr void
 operator*=(v3 &A, v3 B)
 {
     A = A * B;
 }
 
-inline void
+constexpr void
 operator+=(v3 &A, v3 B)
 {
     A = A + B;
 }
 
-inline void
+constexpr void
 operator-=(v3 &A, v3 B)
 {
     A = A - B;
 }
 
-inline void
+constexpr void
 operator*=(v3 &A, f32 B)
 {
     A = A * B;
 }
 
-inline void
+constexpr void
 operator/=(v3 &A, f32 B)
 {
     A = A / B;
 }
 
-inline void
+constexpr void
 operator/=(v3 &A, v3 B)
 {
     A = A / B;
 }
 
-inline v4
+constexpr v4
 V4(f32 X, f32 Y, f32 Z)
 {
-    v4 Result;
+    v4 Result = {};
     
     Result.X = X;
     Result.Y = Y;
@@ -537,73 +591,86 @@ V4(f32 X, f32 Y, f32 Z)
     return Result;
 }
 
-inline v4
+constexpr v4
+V4(f32 X, f32 Y, f32 Z, f32 W)
+{
+    v4 Result = {};
+    
+    Result.X = X;
+    Result.Y = Y;
+    Result.Z = Z;
+    Result.W = W;
+    
+    return Result;
+}
+
+constexpr v4
 V4(v3 A)
 {
     v4 Result = V4(A.X, A.Y, A.Z);
     return Result;
 }
 
-inline v4
+constexpr v4
 ZeroV4()
 {
     v4 Result = V4(0.0f, 0.0f, 0.0f);
     return Result;
 }
 
-inline v4
+constexpr v4
 operator+(v4 A, v4 B)
 {
     v4 Result = V4(A.X + B.X, A.Y + B.Y, A.Z + B.Z);
     return Result;
 }
 
-inline v4
+constexpr v4
 operator-(v4 A, v4 B)
 {
     v4 Result = V4(A.X - B.X, A.Y - B.Y, A.Z - B.Z);
     return Result;
 }
 
-inline v4
+constexpr v4
 operator*(v4 A, f32 S)
 {
     v4 Result = V4(A.X * S, A.Y * S, A.Z * S);
     return Result;
 }
 
-inline v4
+constexpr v4
 operator/(v4 A, f32 S)
 {
     v4 Result = V4(A.X / S, A.Y / S, A.Z / S);
     return Result;
 }
 
-inline void
+constexpr void
 operator+=(v4 &A, v4 B)
 {
     A = A + B;
 }
 
-inline void
+constexpr void
 operator-=(v4 &A, v4 B)
 {
     A = A - B;
 }
 
-inline void
+constexpr void
 operator*=(v4 &A, f32 B)
 {
     A = A * B;
 }
 
-inline void
+constexpr void
 operator/=(v4 &A, f32 B)
 {
     A = A / B;
 }
 
-inline v4
+constexpr v4
 DivideByW(v4 V)
 {
     v4 Result = V;
@@ -614,38 +681,38 @@ DivideByW(v4 V)
     return Result;
 }
 
-inline v3
+constexpr v3
 operator-(v3 A)
 {
     return A * -1.0f;
 }
 
-inline v3
+constexpr v3
 YAxis()
 {
     return {0.0f, 1.0f, 0.0f};
 }
 
-inline v3
+constexpr v3
 XAxis()
 {
     return {1.0f, 0.0f, 0.0f};
 }
 
-inline v3
+constexpr v3
 ZAxis()
 {
     return {0.0f, 0.0f, 1.0f};
 }
 
-inline f32
+constexpr f32
 Dot(v3 A, v3 B)
 {
     f32 Result = A.X * B.X + A.Y * B.Y + A.Z * B.Z;
     return Result;
 }
 
-inline f32
+constexpr f32
 Dot(v4 A, v4 B)
 {
     f32 Result = A.X * B.X + A.Y * B.Y + A.Z * B.Z;
@@ -673,7 +740,7 @@ Len(v4 A)
     return Result;
 }
 
-inline f32
+constexpr f32
 LenSquared(v3 A)
 {
     return Dot(A, A);
@@ -715,7 +782,7 @@ Normalize(v4 V)
     return Result;
 }
 
-inline v3
+constexpr v3
 Cross(v3 A, v3 B)
 {
     v3 Result = {};
@@ -727,7 +794,7 @@ Cross(v3 A, v3 B)
     return Result;
 }
 
-inline v4
+constexpr v4
 Cross(v4 A, v4 B)
 {
     f32 X = A.Y * B.Z - A.Z * B.Y;
@@ -742,7 +809,7 @@ Cross(v4 A, v4 B)
 //
 // Matrix
 
-inline mat4
+constexpr mat4
 operator*(mat4 A, mat4 B)
 {
     mat4 Result = {};
@@ -761,61 +828,52 @@ operator*(mat4 A, mat4 B)
     return Result;
 }
 
-inline v4
+//NOTE(chen): goes through X/Y/Z/W instead of Data, reading the union member that
+//            wasn't written last isn't allowed in a constant expression
+constexpr v4
 operator*(v4 B, mat4 A)
 {
-    v4 Result = B;
+    v4 Result = {};
     
-    for (i32 Col = 0; Col < 4; ++Col)
-    {
-        f32 Sum = 0.0f;
-        for (i32 I = 0; I < 4; ++I)
-        {
-            Sum += A.Data[I][Col] * B.Data[I];
-        }
-        Result.Data[Col] = Sum;
-    }
+    Result.X = B.X * A.Data[0][0] + B.Y * A.Data[1][0] + B.Z * A.Data[2][0] + B.W * A.Data[3][0];
+    Result.Y = B.X * A.Data[0][1] + B.Y * A.Data[1][1] + B.Z * A.Data[2][1] + B.W * A.Data[3][1];
+    Result.Z = B.X * A.Data[0][2] + B.Y * A.Data[1][2] + B.Z * A.Data[2][2] + B.W * A.Data[3][2];
+    Result.W = B.X * A.Data[0][3] + B.Y * A.Data[1][3] + B.Z * A.Data[2][3] + B.W * A.Data[3][3];
     
     return Result;
 }
 
-inline v3
+constexpr v3
 operator*(v3 B, mat3 A)
 {
-    v3 Result = B;
+    v3 Result = {};
     
-    for (i32 Col = 0; Col < 3; ++Col)
-    {
-        f32 Sum = 0.0f;
-        for (i32 I = 0; I < 3; ++I)
-        {
-            Sum += A.Data[I][Col] * B.Data[I];
-        }
-        Result.Data[Col] = Sum;
-    }
+    Result.X = B.X * A.Data[0][0] + B.Y * A.Data[1][0] + B.Z * A.Data[2][0];
+    Result.Y = B.X * A.Data[0][1] + B.Y * A.Data[1][1] + B.Z * A.Data[2][1];
+    Result.Z = B.X * A.Data[0][2] + B.Y * A.Data[1][2] + B.Z * A.Data[2][2];
     
     return Result;
 }
 
-inline void
+constexpr void
 operator*=(v4 &A, mat4 B)
 {
     A = A * B;
 }
 
-inline void
+constexpr void
 operator*=(v3 &A, mat3 B)
 {
     A = A * B;
 }
 
-inline void
+constexpr void
 operator*=(mat4 &A, mat4 B)
 {
     A = A * B;
 }
 
-inline mat3
+constexpr mat3
 Mat3Identity()
 {
     mat3 Result = {};
@@ -827,7 +885,7 @@ Mat3Identity()
     return Result;
 }
 
-inline mat3
+constexpr mat3
 Mat3(f32 E00, f32 E01, f32 E02,
      f32 E10, f32 E11, f32 E12,
      f32 E20, f32 E21, f32 E22)
@@ -847,7 +905,7 @@ Mat3(f32 E00, f32 E01, f32 E02,
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Mat4(f32 E00, f32 E01, f32 E02, f32 E03,
      f32 E10, f32 E11, f32 E12, f32 E13,
      f32 E20, f32 E21, f32 E22, f32 E23,
@@ -878,7 +936,7 @@ Mat4(f32 E00, f32 E01, f32 E02, f32 E03,
     return Result;
 }
 
-inline mat3
+constexpr mat3
 Mat3(mat4 Mat)
 {
     mat3 Result = Mat3Identity();
@@ -892,7 +950,7 @@ Mat3(mat4 Mat)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Mat4Identity()
 {
     mat4 Result = {};
@@ -1038,7 +1096,7 @@ Inverse(mat4 A)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Transpose(mat4 A)
 {
     mat4 Result = {};
@@ -1054,7 +1112,7 @@ Transpose(mat4 A)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Mat4Translate(f32 dX, f32 dY, f32 dZ)
 {
     mat4 Result = Mat4Identity();
@@ -1066,13 +1124,13 @@ Mat4Translate(f32 dX, f32 dY, f32 dZ)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Mat4Translate(v3 dP)
 {
     return Mat4Translate(dP.X, dP.Y, dP.Z);
 }
 
-inline mat4
+constexpr mat4
 Mat4Scale(f32 sX, f32 sY, f32 sZ)
 {
     mat4 Result = {};
@@ -1085,7 +1143,7 @@ Mat4Scale(f32 sX, f32 sY, f32 sZ)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Mat4Scale(v3 Scale)
 {
     mat4 Result = {};
@@ -1098,7 +1156,7 @@ Mat4Scale(v3 Scale)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Mat4Scale(f32 S)
 {
     return Mat4Scale(S, S, S);
@@ -1155,7 +1213,7 @@ Mat4Rotate(v3 Euler)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 Mat4Ortho(float Left, float Right, float Bottom, float Top, float Near, float Far)
 {
     mat4 Result = {};
@@ -1211,7 +1269,7 @@ Mat4LookAt(v3 P, v3 Target)
     return Result;
 }
 
-inline v3
+constexpr v3
 ExtractTranslation(mat4 Matrix)
 {
     v3 Translation = {};
@@ -1223,7 +1281,7 @@ ExtractTranslation(mat4 Matrix)
     return Translation;
 }
 
-inline quaternion
+constexpr quaternion
 Quaternion()
 {
     quaternion Result = {};
@@ -1245,7 +1303,7 @@ Quaternion(v3 Axis, f32 Angle)
     return Result;
 }
 
-inline quaternion
+constexpr quaternion
 Conjugate(quaternion A)
 {
     quaternion Result = A;
@@ -1257,10 +1315,10 @@ Conjugate(quaternion A)
     return Result;
 }
 
-inline quaternion
+constexpr quaternion
 operator*(quaternion A, quaternion B)
 {
-    quaternion Result;
+    quaternion Result = {};
     
     v4 AV = V4(A.X, A.Y, A.Z);
     v4 BV = V4(B.X, B.Y, B.Z);
@@ -1276,16 +1334,16 @@ operator*(quaternion A, quaternion B)
     return Result;
 }
 
-inline void
+constexpr void
 operator*=(quaternion &A, quaternion B)
 {
     A = A * B;
 }
 
-inline quaternion
+constexpr quaternion
 Quaternion(v3 V)
 {
-    quaternion Result;
+    quaternion Result = {};
     Result.X = V.X;
     Result.Y = V.Y;
     Result.Z = V.Z;
@@ -1294,10 +1352,10 @@ Quaternion(v3 V)
     return Result;
 }
 
-inline v3
+constexpr v3
 Rotate(v3 V, quaternion Q)
 {
-    v3 Result;
+    v3 Result = {};
     
     quaternion VectorAsQuaternion = Quaternion(V);
     quaternion ResultInQuaternion = Q * VectorAsQuaternion * Conjugate(Q);
@@ -1309,12 +1367,12 @@ Rotate(v3 V, quaternion Q)
     return Result;
 }
 
-inline v4 
+constexpr v4
 Rotate(v4 Vector, quaternion Quaternion)
 {
-    v4 Result;
+    v4 Result = {};
     
-    quaternion VectorAsQuaternion;
+    quaternion VectorAsQuaternion = {};
     VectorAsQuaternion.X = Vector.X;
     VectorAsQuaternion.Y = Vector.Y;
     VectorAsQuaternion.Z = Vector.Z;
@@ -1329,7 +1387,7 @@ Rotate(v4 Vector, quaternion Quaternion)
     return Result;
 }
 
-inline mat4
+constexpr mat4
 QuaternionToMat4(quaternion Q)
 {
     mat4 Result = Mat4Identity();
@@ -1409,10 +1467,10 @@ RotationToQuaternion(mat4 Mat)
     return Quat;
 }
 
-inline quaternion
+constexpr quaternion
 operator*(f32 S, quaternion A)
 {
-    quaternion Result;
+    quaternion Result = {};
     
     Result.X = A.X * S;
     Result.Y = A.Y * S;
@@ -1422,10 +1480,10 @@ operator*(f32 S, quaternion A)
     return Result;
 }
 
-inline quaternion
+constexpr quaternion
 operator+(quaternion A, quaternion B)
 {
-    quaternion Result;
+    quaternion Result = {};
     
     Result.X = A.X + B.X;
     Result.Y = A.Y + B.Y;
@@ -1435,7 +1493,7 @@ operator+(quaternion A, quaternion B)
     return Result;
 }
 
-inline f32
+constexpr f32
 Dot(quaternion A, quaternion B)
 {
     return A.X * B.X + A.Y * B.Y + A.Z * B.Z + A.W * B.W;
@@ -1483,13 +1541,13 @@ Slerp(quaternion A, quaternion B, f32 T)
     return Result;
 }
 
-inline f32
+constexpr f32
 Lerp(f32 A, f32 B, f32 T)
 {
     return A * (1.0f - T) + B * T;
 }
 
-inline v3
+constexpr v3
 Lerp(v3 A, v3 B, f32 T)
 {
     v3 Result = A * (1.0f - T) + B * T;
@@ -1497,13 +1555,13 @@ Lerp(v3 A, v3 B, f32 T)
     return Result;
 }
 
-inline f32
+constexpr f32
 Max(v3 V)
 {
     return Max(Max(V.X, V.Y), V.Z);
 }
 
-inline v3
+constexpr v3
 ApplyMat4(v3 V, mat4 Mat)
 {
     v4 _V = {V.X, V.Y, V.Z, 1.0f};
@@ -1532,3 +1590,721 @@ SolveForQuadraticRoots(f32 A, f32 B, f32 C)
     Result.Y = SecondRoot;
     return Result;
 }
+
+//
+//
+// Compile time tables
+
+//NOTE(chen): sinf/cosf can't run in a constant expression, these can. They're
+//            only meant for building tables at compile time, use sinf/cosf at runtime
+constexpr f64
+ConstSin(f64 X)
+{
+    f64 Pi = 3.14159265358979323846;
+    f64 TwoPi = 2.0 * Pi;
+    
+    // reduce to [-pi, pi], then to [-pi/2, pi/2] where the series converges fast
+    i64 Turns = (i64)(X / TwoPi + (X >= 0.0? 0.5: -0.5));
+    X -= (f64)Turns * TwoPi;
+    if (X > 0.5 * Pi)
+    {
+        X = Pi - X;
+    }
+    else if (X < -0.5 * Pi)
+    {
+        X = -Pi - X;
+    }
+    
+    f64 X2 = X * X;
+    f64 Term = X;
+    f64 Sum = X;
+    for (int N = 1; N < 12; ++N)
+    {
+        Term *= -X2 / (f64)((2 * N) * (2 * N + 1));
+        Sum += Term;
+    }
+    return Sum;
+}
+
+constexpr f64
+ConstCos(f64 X)
+{
+    return ConstSin(X + 0.5 * 3.14159265358979323846);
+}
+
+// Sin[I] = sin(2pi * I/N), same for Cos
+template <int N>
+struct sin_cos_table
+{
+    f32 Sin[N];
+    f32 Cos[N];
+};
+
+template <int N>
+constexpr sin_cos_table<N>
+MakeSinCosTable()
+{
+    sin_cos_table<N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        f64 Angle = 2.0 * 3.14159265358979323846 * (f64)I / (f64)N;
+        Result.Sin[I] = (f32)ConstSin(Angle);
+        Result.Cos[I] = (f32)ConstCos(Angle);
+    }
+    return Result;
+}
+
+// Spread2[B] puts bit I of B at bit 2*I, Spread3[B] at bit 3*I
+struct morton_table
+{
+    u32 Spread2[256];
+    u32 Spread3[256];
+};
+
+constexpr morton_table
+MakeMortonTable()
+{
+    morton_table Result = {};
+    for (u32 Byte = 0; Byte < 256; ++Byte)
+    {
+        u32 X = Byte;
+        X = (X | (X << 4)) & 0x0F0F;
+        X = (X | (X << 2)) & 0x3333;
+        X = (X | (X << 1)) & 0x5555;
+        Result.Spread2[Byte] = X;
+        
+        u32 Y = Byte;
+        Y = (Y | (Y << 8)) & 0x00F00F;
+        Y = (Y | (Y << 4)) & 0x0C30C3;
+        Y = (Y | (Y << 2)) & 0x249249;
+        Result.Spread3[Byte] = Y;
+    }
+    return Result;
+}
+
+constexpr morton_table MortonTable = MakeMortonTable();
+
+// X and Y are 16 bits
+constexpr u32
+MortonEncode2(u32 X, u32 Y)
+{
+    u32 SpreadX = MortonTable.Spread2[X & 0xFF] | (MortonTable.Spread2[(X >> 8) & 0xFF] << 16);
+    u32 SpreadY = MortonTable.Spread2[Y & 0xFF] | (MortonTable.Spread2[(Y >> 8) & 0xFF] << 16);
+    return SpreadX | (SpreadY << 1);
+}
+
+// X, Y and Z are 10 bits
+constexpr u32
+MortonEncode3(u32 X, u32 Y, u32 Z)
+{
+    u32 SpreadX = MortonTable.Spread3[X & 0xFF] | (MortonTable.Spread3[(X >> 8) & 0x3] << 24);
+    u32 SpreadY = MortonTable.Spread3[Y & 0xFF] | (MortonTable.Spread3[(Y >> 8) & 0x3] << 24);
+    u32 SpreadZ = MortonTable.Spread3[Z & 0xFF] | (MortonTable.Spread3[(Z >> 8) & 0x3] << 24);
+    return SpreadX | (SpreadY << 1) | (SpreadZ << 2);
+}
+
+// inverse of the spread, X = MortonCompact2(Code), Y = MortonCompact2(Code >> 1)
+constexpr u32
+MortonCompact2(u32 Code)
+{
+    Code &= 0x55555555;
+    Code = (Code | (Code >> 1)) & 0x33333333;
+    Code = (Code | (Code >> 2)) & 0x0F0F0F0F;
+    Code = (Code | (Code >> 4)) & 0x00FF00FF;
+    Code = (Code | (Code >> 8)) & 0x0000FFFF;
+    return Code;
+}
+
+// X = MortonCompact3(Code), Y = MortonCompact3(Code >> 1), Z = MortonCompact3(Code >> 2)
+constexpr u32
+MortonCompact3(u32 Code)
+{
+    Code &= 0x09249249;
+    Code = (Code | (Code >> 2)) & 0x030C30C3;
+    Code = (Code | (Code >> 4)) & 0x0300F00F;
+    Code = (Code | (Code >> 8)) & 0x030000FF;
+    Code = (Code | (Code >> 16)) & 0x000003FF;
+    return Code;
+}
+
+//
+//
+// Generic vectors and matrices
+
+//NOTE(chen): fixed trip count loops over Data, they unroll to the same code as
+//            the hand written v3/mat4 versions at -O2 and /O2
+template <typename T>
+struct scalar_type
+{
+    typedef T type; // keeps the scalar argument of operator* out of deduction
+};
+
+template <typename T>
+constexpr vec<T, 2>
+Vec(T X, T Y)
+{
+    vec<T, 2> Result = {};
+    Result.Data[0] = X;
+    Result.Data[1] = Y;
+    return Result;
+}
+
+template <typename T>
+constexpr vec<T, 3>
+Vec(T X, T Y, T Z)
+{
+    vec<T, 3> Result = {};
+    Result.Data[0] = X;
+    Result.Data[1] = Y;
+    Result.Data[2] = Z;
+    return Result;
+}
+
+template <typename T>
+constexpr vec<T, 4>
+Vec(T X, T Y, T Z, T W)
+{
+    vec<T, 4> Result = {};
+    Result.Data[0] = X;
+    Result.Data[1] = Y;
+    Result.Data[2] = Z;
+    Result.Data[3] = W;
+    return Result;
+}
+
+constexpr v3d
+V3D(f64 X, f64 Y, f64 Z)
+{
+    return Vec(X, Y, Z);
+}
+
+constexpr v3d
+V3D(v3 A)
+{
+    return Vec((f64)A.X, (f64)A.Y, (f64)A.Z);
+}
+
+constexpr v4d
+V4D(f64 X, f64 Y, f64 Z, f64 W)
+{
+    return Vec(X, Y, Z, W);
+}
+
+constexpr v3i
+V3I(i32 X, i32 Y, i32 Z)
+{
+    return Vec(X, Y, Z);
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+VecFill(T Value)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = Value;
+    }
+    return Result;
+}
+
+// VecCast<f32>(v3d) etc.
+template <typename U, typename T, int N>
+constexpr vec<U, N>
+VecCast(vec<T, N> A)
+{
+    vec<U, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = (U)A.Data[I];
+    }
+    return Result;
+}
+
+template <typename T>
+constexpr v3
+V3(vec<T, 3> A)
+{
+    return V3((f32)A.Data[0], (f32)A.Data[1], (f32)A.Data[2]);
+}
+
+template <typename T>
+constexpr v4
+V4(vec<T, 4> A)
+{
+    return V4((f32)A.Data[0], (f32)A.Data[1], (f32)A.Data[2], (f32)A.Data[3]);
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator+(vec<T, N> A, vec<T, N> B)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] + B.Data[I];
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator-(vec<T, N> A, vec<T, N> B)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] - B.Data[I];
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator-(vec<T, N> A)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = -A.Data[I];
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator*(vec<T, N> A, vec<T, N> B)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] * B.Data[I];
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator*(vec<T, N> A, typename scalar_type<T>::type S)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] * S;
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator*(typename scalar_type<T>::type S, vec<T, N> A)
+{
+    return A * S;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator/(vec<T, N> A, vec<T, N> B)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] / B.Data[I];
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator/(vec<T, N> A, typename scalar_type<T>::type S)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] / S;
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr void
+operator+=(vec<T, N> &A, vec<T, N> B)
+{
+    A = A + B;
+}
+
+template <typename T, int N>
+constexpr void
+operator-=(vec<T, N> &A, vec<T, N> B)
+{
+    A = A - B;
+}
+
+template <typename T, int N>
+constexpr void
+operator*=(vec<T, N> &A, typename scalar_type<T>::type S)
+{
+    A = A * S;
+}
+
+template <typename T, int N>
+constexpr void
+operator/=(vec<T, N> &A, typename scalar_type<T>::type S)
+{
+    A = A / S;
+}
+
+template <typename T, int N>
+constexpr bool
+operator==(vec<T, N> A, vec<T, N> B)
+{
+    for (int I = 0; I < N; ++I)
+    {
+        if (A.Data[I] != B.Data[I])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, int N>
+constexpr bool
+operator!=(vec<T, N> A, vec<T, N> B)
+{
+    return !(A == B);
+}
+
+template <typename T, int N>
+constexpr T
+Dot(vec<T, N> A, vec<T, N> B)
+{
+    T Result = A.Data[0] * B.Data[0];
+    for (int I = 1; I < N; ++I)
+    {
+        Result += A.Data[I] * B.Data[I];
+    }
+    return Result;
+}
+
+template <typename T>
+constexpr vec<T, 3>
+Cross(vec<T, 3> A, vec<T, 3> B)
+{
+    return Vec(A.Data[1] * B.Data[2] - A.Data[2] * B.Data[1],
+               A.Data[2] * B.Data[0] - A.Data[0] * B.Data[2],
+               A.Data[0] * B.Data[1] - A.Data[1] * B.Data[0]);
+}
+
+template <typename T, int N>
+constexpr T
+LenSquared(vec<T, N> A)
+{
+    return Dot(A, A);
+}
+
+inline f32
+GenericSquareRoot(f32 Value)
+{
+    return sqrtf(Value);
+}
+
+inline f64
+GenericSquareRoot(f64 Value)
+{
+    return sqrt(Value);
+}
+
+// floating point T only
+template <typename T, int N>
+inline T
+Len(vec<T, N> A)
+{
+    return GenericSquareRoot(Dot(A, A));
+}
+
+template <typename T, int N>
+inline vec<T, N>
+Normalize(vec<T, N> A)
+{
+    T Length = Len(A);
+    if (Length > (T)EPSILON)
+    {
+        A = A / Length;
+    }
+    return A;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+Min(vec<T, N> A, vec<T, N> B)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] < B.Data[I]? A.Data[I]: B.Data[I];
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+Max(vec<T, N> A, vec<T, N> B)
+{
+    vec<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I] = A.Data[I] > B.Data[I]? A.Data[I]: B.Data[I];
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+Lerp(vec<T, N> A, vec<T, N> B, typename scalar_type<T>::type T0)
+{
+    return A * ((T)1 - T0) + B * T0;
+}
+
+template <typename T, int N>
+constexpr mat<T, N>
+MatIdentity()
+{
+    mat<T, N> Result = {};
+    for (int I = 0; I < N; ++I)
+    {
+        Result.Data[I][I] = (T)1;
+    }
+    return Result;
+}
+
+template <typename U, typename T, int N>
+constexpr mat<U, N>
+MatCast(mat<T, N> A)
+{
+    mat<U, N> Result = {};
+    for (int Row = 0; Row < N; ++Row)
+    {
+        for (int Col = 0; Col < N; ++Col)
+        {
+            Result.Data[Row][Col] = (U)A.Data[Row][Col];
+        }
+    }
+    return Result;
+}
+
+template <typename T>
+constexpr mat4
+Mat4(mat<T, 4> A)
+{
+    mat4 Result = {};
+    for (int Row = 0; Row < 4; ++Row)
+    {
+        for (int Col = 0; Col < 4; ++Col)
+        {
+            Result.Data[Row][Col] = (f32)A.Data[Row][Col];
+        }
+    }
+    return Result;
+}
+
+constexpr mat4d
+Mat4D(mat4 A)
+{
+    mat4d Result = {};
+    for (int Row = 0; Row < 4; ++Row)
+    {
+        for (int Col = 0; Col < 4; ++Col)
+        {
+            Result.Data[Row][Col] = (f64)A.Data[Row][Col];
+        }
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr mat<T, N>
+operator*(mat<T, N> A, mat<T, N> B)
+{
+    mat<T, N> Result = {};
+    for (int Row = 0; Row < N; ++Row)
+    {
+        for (int Col = 0; Col < N; ++Col)
+        {
+            for (int I = 0; I < N; ++I)
+            {
+                Result.Data[Row][Col] += A.Data[Row][I] * B.Data[I][Col];
+            }
+        }
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr vec<T, N>
+operator*(vec<T, N> A, mat<T, N> B)
+{
+    vec<T, N> Result = {};
+    for (int Col = 0; Col < N; ++Col)
+    {
+        Result.Data[Col] = A.Data[0] * B.Data[0][Col];
+        for (int I = 1; I < N; ++I)
+        {
+            Result.Data[Col] += A.Data[I] * B.Data[I][Col];
+        }
+    }
+    return Result;
+}
+
+//NOTE(chen): written out, gcc leaves the generic version's outer loop rolled
+template <typename T>
+constexpr vec<T, 4>
+operator*(vec<T, 4> A, mat<T, 4> B)
+{
+    vec<T, 4> Result = {};
+    for (int Col = 0; Col < 4; ++Col)
+    {
+        Result.Data[Col] = (A.Data[0] * B.Data[0][Col] + A.Data[1] * B.Data[1][Col] +
+                            A.Data[2] * B.Data[2][Col] + A.Data[3] * B.Data[3][Col]);
+    }
+    return Result;
+}
+
+template <typename T, int N>
+constexpr void
+operator*=(mat<T, N> &A, mat<T, N> B)
+{
+    A = A * B;
+}
+
+template <typename T, int N>
+constexpr mat<T, N>
+Transpose(mat<T, N> A)
+{
+    mat<T, N> Result = {};
+    for (int Row = 0; Row < N; ++Row)
+    {
+        for (int Col = 0; Col < N; ++Col)
+        {
+            Result.Data[Row][Col] = A.Data[Col][Row];
+        }
+    }
+    return Result;
+}
+
+template <typename T>
+constexpr mat<T, 4>
+MatTranslate(vec<T, 3> dP)
+{
+    mat<T, 4> Result = MatIdentity<T, 4>();
+    Result.Data[3][0] = dP.Data[0];
+    Result.Data[3][1] = dP.Data[1];
+    Result.Data[3][2] = dP.Data[2];
+    return Result;
+}
+
+template <typename T>
+constexpr mat<T, 4>
+MatScale(vec<T, 3> Scale)
+{
+    mat<T, 4> Result = {};
+    Result.Data[0][0] = Scale.Data[0];
+    Result.Data[1][1] = Scale.Data[1];
+    Result.Data[2][2] = Scale.Data[2];
+    Result.Data[3][3] = (T)1;
+    return Result;
+}
+
+// point transform, w = 1
+template <typename T>
+constexpr vec<T, 3>
+ApplyMat(vec<T, 3> P, mat<T, 4> M)
+{
+    vec<T, 4> Result = Vec(P.Data[0], P.Data[1], P.Data[2], (T)1) * M;
+    return Vec(Result.Data[0], Result.Data[1], Result.Data[2]);
+}
+
+//
+//
+// Camera relative rebasing
+
+//NOTE(chen): f32 has 24 bits of mantissa, 10km from the origin that's ~1mm of
+//            precision and it gets worse from there. Keep world positions and
+//            transforms in f64, subtract the camera position while still in f64
+//            and only then convert, render data near the camera stays precise.
+//            Render with a view matrix built at the origin, e.g.
+//            Mat4LookAt(V3(0.0f), V3(Target - CameraP)).
+
+// In and Out are Count xyz triples
+inline void
+RebasePositions(f32 *Out, f64 *In, int Count, v3d Origin)
+{
+    int I = 0;
+#if CH_AVX2
+    // 4 positions = 12 doubles = 3 registers, the origin pattern repeats every 3
+    __m256d O0 = _mm256_setr_pd(Origin.X, Origin.Y, Origin.Z, Origin.X);
+    __m256d O1 = _mm256_setr_pd(Origin.Y, Origin.Z, Origin.X, Origin.Y);
+    __m256d O2 = _mm256_setr_pd(Origin.Z, Origin.X, Origin.Y, Origin.Z);
+    for (; I + 4 <= Count; I += 4)
+    {
+        f64 *Src = In + 3 * I;
+        f32 *Dest = Out + 3 * I;
+        _mm_storeu_ps(Dest + 0, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(Src + 0), O0)));
+        _mm_storeu_ps(Dest + 4, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(Src + 4), O1)));
+        _mm_storeu_ps(Dest + 8, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(Src + 8), O2)));
+    }
+#elif CH_SSE2
+    __m128d O0 = _mm_setr_pd(Origin.X, Origin.Y);
+    __m128d O1 = _mm_setr_pd(Origin.Z, Origin.X);
+    __m128d O2 = _mm_setr_pd(Origin.Y, Origin.Z);
+    for (; I + 4 <= Count; I += 4)
+    {
+        f64 *Src = In + 3 * I;
+        f32 *Dest = Out + 3 * I;
+        __m128 A = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(Src + 0), O0));
+        __m128 B = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(Src + 2), O1));
+        __m128 C = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(Src + 4), O2));
+        __m128 D = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(Src + 6), O0));
+        __m128 E = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(Src + 8), O1));
+        __m128 F = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(Src + 10), O2));
+        _mm_storeu_ps(Dest + 0, _mm_movelh_ps(A, B));
+        _mm_storeu_ps(Dest + 4, _mm_movelh_ps(C, D));
+        _mm_storeu_ps(Dest + 8, _mm_movelh_ps(E, F));
+    }
+#endif
+    for (; I < Count; ++I)
+    {
+        Out[3*I + 0] = (f32)(In[3*I + 0] - Origin.X);
+        Out[3*I + 1] = (f32)(In[3*I + 1] - Origin.Y);
+        Out[3*I + 2] = (f32)(In[3*I + 2] - Origin.Z);
+    }
+}
+
+inline void
+RebasePositions(v3 *Out, v3d *In, int Count, v3d Origin)
+{
+    RebasePositions(&Out[0].X, &In[0].Data[0], Count, Origin);
+}
+
+// World * Translate(-Origin) done in f64, then converted
+constexpr mat4
+RebaseMatrix(mat4d World, v3d Origin)
+{
+    for (int Row = 0; Row < 4; ++Row)
+    {
+        for (int Col = 0; Col < 3; ++Col)
+        {
+            World.Data[Row][Col] -= World.Data[Row][3] * Origin.Data[Col];
+        }
+    }
+    return Mat4(World);
+}
+
+inline void
+RebaseMatrices(mat4 *Out, mat4d *In, int Count, v3d Origin)
+{
+    for (int I = 0; I < Count; ++I)
+    {
+        Out[I] = RebaseMatrix(In[I], Origin);
+    }
+}
@@ -45,6 +45,18 @@ does not exist for that vertex.
  Any of vb, nb, and ib could be null, denoting that the buffer is empty.
 ib indexes directly into vb and nb.
 
+welding:
+
+ch_obj::Mesh ch_obj::weld_model(ch_obj::Model *model);
+void ch_obj::free_mesh(ch_obj::Mesh *mesh);
+
+Mesh is the GPU/rasterizer friendly form of a Model, every unique
+(position index, normal index) pair becomes one vertex:
+
+vb: x0|y0|z0|x1|y1|z1|....  (vertex_count vertices)
+nb: x0|y0|z0|x1|y1|z1|....  (vertex_count normals, null if the model has none)
+ib: 3 indices per triangle, indexing vertices (ib_count indices)
+
 
 */
 
@@ -74,6 +86,15 @@ namespace ch_obj
         char e_msg[256];
     };
     
+    struct Mesh
+    {
+        float *vb;
+        float *nb;
+        int vertex_count;
+        unsigned int *ib;
+        int ib_count;
+    };
+    
     template <typename T> struct Stretchy_Array
     {
         T *data;
@@ -755,6 +776,7 @@ namespace ch_obj
             pb.free();
             nb.free();
             ib.free();
+            tokens.free();
             
             free(text);
         }
@@ -766,4 +788,90 @@ namespace ch_obj
         
         return res;
     }
+    
+    //
+    //
+    // welding
+    
+    inline unsigned int hash_vertex(int p, int n)
+    {
+        unsigned int h = (unsigned int)p * 0x9E3779B1u;
+        h ^= (unsigned int)n * 0x85EBCA77u;
+        h ^= h >> 15;
+        return h;
+    }
+    
+    inline Mesh weld_model(Model *model)
+    {
+        Mesh res = {};
+        if (model->is_invalid || model->ib_count == 0) return res;
+        
+        bool has_normals = model->nb_count > 0;
+        
+        // open addressing table of (p, n) -> vertex index, sized to stay under half full
+        int table_cap = 1;
+        while (table_cap < 2 * model->ib_count) table_cap *= 2;
+        int *table = (int *)malloc(sizeof(int) * table_cap);
+        memset(table, 0xFF, sizeof(int) * table_cap);
+        int *keys = (int *)malloc(sizeof(int) * 2 * model->ib_count);
+        
+        res.ib = (unsigned int *)malloc(sizeof(unsigned int) * model->ib_count);
+        res.ib_count = model->ib_count;
+        
+        for (int i = 0; i < model->ib_count; ++i)
+        {
+            int p = model->ib[3*i];
+            int n = has_normals? model->ib[3*i + 2]: -1;
+            
+            unsigned int slot = hash_vertex(p, n) & (table_cap - 1);
+            while (table[slot] != -1)
+            {
+                int v = table[slot];
+                if (keys[2*v] == p && keys[2*v + 1] == n) break;
+                slot = (slot + 1) & (table_cap - 1);
+            }
+            
+            if (table[slot] == -1)
+            {
+                table[slot] = res.vertex_count;
+                keys[2*res.vertex_count] = p;
+                keys[2*res.vertex_count + 1] = n;
+                res.vertex_count += 1;
+            }
+            res.ib[i] = (unsigned int)table[slot];
+        }
+        
+        res.vb = (float *)malloc(sizeof(float) * 3 * res.vertex_count);
+        if (has_normals)
+        {
+            res.nb = (float *)malloc(sizeof(float) * 3 * res.vertex_count);
+        }
+        
+        for (int v = 0; v < res.vertex_count; ++v)
+        {
+            int p = keys[2*v];
+            int n = keys[2*v + 1];
+            for (int c = 0; c < 3; ++c)
+            {
+                res.vb[3*v + c] = model->vb[3*p + c];
+                if (has_normals)
+                {
+                    res.nb[3*v + c] = n >= 0? model->nb[3*n + c]: 0.0f;
+                }
+            }
+        }
+        
+        free(table);
+        free(keys);
+        
+        return res;
+    }
+    
+    inline void free_mesh(Mesh *mesh)
+    {
+        free(mesh->vb);
+        free(mesh->nb);
+        free(mesh->ib);
+        *mesh = {};
+    }
 }
\ No newline at end of file
@@ -0,0 +1,559 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch_obj::Model Model = ch_obj::load_model("bunny.obj");
+ch_obj::Mesh Mesh = ch_obj::weld_model(&Model);
+
+// 12 bytes per vertex instead of 24
+ch::packed_vertex *Vertices = ch::PackMesh(&Mesh);
+...
+free(Vertices);
+
+// batch conversions, all of them take and produce tightly packed arrays
+u16 *Halves = ...;          // 3 per vertex
+ch::PackHalf(Halves, Mesh.vb, 3 * Mesh.vertex_count);
+ch::UnpackHalf(Floats, Halves, 3 * Mesh.vertex_count);
+
+u32 *Normals = ...;         // 1 per vertex
+ch::PackOctNormals(Normals, Mesh.nb, Mesh.vertex_count);
+ch::UnpackOctNormals(Floats, Normals, Mesh.vertex_count);
+
+u32 *Packed = ...;
+ch::PackSnorm1010102(Packed, Mesh.nb, Mesh.vertex_count);   // w = 0
+
+// tangent frames, 8 bytes for normal + tangent + bitangent sign
+ch::qtangent Frame = ch::PackQTangent(N, T, BitangentSign);
+v3 N2, T2; f32 Sign2;
+ch::UnpackQTangent(Frame, &N2, &T2, &Sign2);
+
+Formats:
+
+half       IEEE 754 binary16, from ch_half.h.
+oct        unit vector projected onto an octahedron and unfolded onto a
+           square, x and y as snorm16 in the low/high half of a u32.
+           Max error is about 0.0035 degrees.
+1010102    x, y, z in bits 0..29 and w in 30..31, same layout as
+           GL_UNSIGNED_INT_2_10_10_10_REV/GL_INT_2_10_10_10_REV and
+           DXGI_FORMAT_R10G10B10A2_UNORM.
+qtangent   tangent frame as a quaternion (rotating X, Z onto T, N) in 4
+           snorm16, w is kept away from 0 so its sign can store the
+           bitangent sign: B = Sign * Cross(N, T).
+
+Every float to int conversion rounds half away from zero, in the SIMD paths
+too, so they produce the same bits as the scalar ones.
+*/
+
+#include "ch_math.h"
+#include "ch_obj.h"
+#include "ch_half.h"
+#include "ch_simd.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace ch
+{
+    struct qtangent
+    {
+        i16 X, Y, Z, W;
+    };
+    
+    struct packed_vertex
+    {
+        u16 P[4]; // half xyz, w = 1
+        u32 N; // oct
+    };
+    static_assert(sizeof(packed_vertex) == 12, "packed_vertex must stay 12 bytes");
+    
+    inline i32
+        RoundHalfAway(f32 Value)
+    {
+        return i32(Value + (Value >= 0.0f? 0.5f: -0.5f));
+    }
+    
+    //
+    //
+    // snorm/unorm helpers
+    
+    inline i32
+        F32ToSnorm(f32 Value, int Bits)
+    {
+        f32 Scale = f32((1 << (Bits - 1)) - 1);
+        return RoundHalfAway(Clamp(Value, -1.0f, 1.0f) * Scale);
+    }
+    
+    inline f32
+        SnormToF32(i32 Value, int Bits)
+    {
+        f32 Scale = f32((1 << (Bits - 1)) - 1);
+        return Max(f32(Value) / Scale, -1.0f);
+    }
+    
+    inline u32
+        F32ToUnorm(f32 Value, int Bits)
+    {
+        f32 Scale = f32((1u << Bits) - 1);
+        return u32(RoundHalfAway(Clamp(Value, 0.0f, 1.0f) * Scale));
+    }
+    
+    inline f32
+        UnormToF32(u32 Value, int Bits)
+    {
+        return f32(Value) / f32((1u << Bits) - 1);
+    }
+    
+    // sign extends the low Bits bits of Value
+    inline i32
+        SignExtend(u32 Value, int Bits)
+    {
+        return i32(Value << (32 - Bits)) >> (32 - Bits);
+    }
+    
+#if CH_SSE2
+    inline __m128i
+        RoundHalfAwaySSE2(__m128 Value)
+    {
+        __m128 Half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(Value, _mm_set1_ps(-0.0f)));
+        return _mm_cvttps_epi32(_mm_add_ps(Value, Half));
+    }
+    
+    // 4 xyz triples to SoA
+    inline void
+        LoadXYZ4(f32 *In, __m128 *X, __m128 *Y, __m128 *Z)
+    {
+        *X = _mm_setr_ps(In[0], In[3], In[6], In[9]);
+        *Y = _mm_setr_ps(In[1], In[4], In[7], In[10]);
+        *Z = _mm_setr_ps(In[2], In[5], In[8], In[11]);
+    }
+    
+    inline void
+        StoreXYZ4(f32 *Out, __m128 X, __m128 Y, __m128 Z)
+    {
+        f32 SX[4], SY[4], SZ[4];
+        _mm_storeu_ps(SX, X);
+        _mm_storeu_ps(SY, Y);
+        _mm_storeu_ps(SZ, Z);
+        for (int I = 0; I < 4; ++I)
+        {
+            Out[3*I + 0] = SX[I];
+            Out[3*I + 1] = SY[I];
+            Out[3*I + 2] = SZ[I];
+        }
+    }
+#endif
+    
+    //
+    //
+    // octahedral normals
+    
+    inline u32
+        PackOctNormal(v3 N)
+    {
+        f32 InvL1 = 1.0f / (Abs(N.X) + Abs(N.Y) + Abs(N.Z));
+        f32 X = N.X * InvL1;
+        f32 Y = N.Y * InvL1;
+        if (N.Z < 0.0f)
+        {
+            // fold the lower hemisphere over the diagonals
+            f32 FoldX = (1.0f - Abs(Y)) * (X >= 0.0f? 1.0f: -1.0f);
+            f32 FoldY = (1.0f - Abs(X)) * (Y >= 0.0f? 1.0f: -1.0f);
+            X = FoldX;
+            Y = FoldY;
+        }
+        u32 QX = u32(F32ToSnorm(X, 16)) & 0xFFFF;
+        u32 QY = u32(F32ToSnorm(Y, 16)) & 0xFFFF;
+        return QX | (QY << 16);
+    }
+    
+    inline v3
+        UnpackOctNormal(u32 Packed)
+    {
+        f32 X = SnormToF32(SignExtend(Packed, 16), 16);
+        f32 Y = SnormToF32(SignExtend(Packed >> 16, 16), 16);
+        v3 N = V3(X, Y, 1.0f - Abs(X) - Abs(Y));
+        f32 T = Max(-N.Z, 0.0f);
+        N.X += N.X >= 0.0f? -T: T;
+        N.Y += N.Y >= 0.0f? -T: T;
+        return Normalize(N);
+    }
+    
+    // In is Count xyz triples
+    inline void
+        PackOctNormals(u32 *Out, f32 *In, int Count)
+    {
+        int I = 0;
+#if CH_SSE2
+        __m128 SignMask = _mm_set1_ps(-0.0f);
+        __m128 One = _mm_set1_ps(1.0f);
+        __m128 Scale = _mm_set1_ps(32767.0f);
+        for (; I + 4 <= Count; I += 4)
+        {
+            __m128 X, Y, Z;
+            LoadXYZ4(In + 3 * I, &X, &Y, &Z);
+            __m128 AbsX = _mm_andnot_ps(SignMask, X);
+            __m128 AbsY = _mm_andnot_ps(SignMask, Y);
+            __m128 AbsZ = _mm_andnot_ps(SignMask, Z);
+            __m128 InvL1 = _mm_div_ps(One, _mm_add_ps(_mm_add_ps(AbsX, AbsY), AbsZ));
+            X = _mm_mul_ps(X, InvL1);
+            Y = _mm_mul_ps(Y, InvL1);
+            
+            // sign(x) with sign(0) = +1, as in the scalar version
+            __m128 SignX = _mm_or_ps(One, _mm_and_ps(_mm_cmplt_ps(X, _mm_setzero_ps()), SignMask));
+            __m128 SignY = _mm_or_ps(One, _mm_and_ps(_mm_cmplt_ps(Y, _mm_setzero_ps()), SignMask));
+            __m128 FoldX = _mm_mul_ps(_mm_sub_ps(One, _mm_andnot_ps(SignMask, Y)), SignX);
+            __m128 FoldY = _mm_mul_ps(_mm_sub_ps(One, _mm_andnot_ps(SignMask, X)), SignY);
+            __m128 Lower = _mm_cmplt_ps(Z, _mm_setzero_ps());
+            X = _mm_or_ps(_mm_and_ps(Lower, FoldX), _mm_andnot_ps(Lower, X));
+            Y = _mm_or_ps(_mm_and_ps(Lower, FoldY), _mm_andnot_ps(Lower, Y));
+            
+            X = _mm_min_ps(_mm_max_ps(X, _mm_sub_ps(_mm_setzero_ps(), One)), One);
+            Y = _mm_min_ps(_mm_max_ps(Y, _mm_sub_ps(_mm_setzero_ps(), One)), One);
+            __m128i QX = _mm_and_si128(RoundHalfAwaySSE2(_mm_mul_ps(X, Scale)), _mm_set1_epi32(0xFFFF));
+            __m128i QY = RoundHalfAwaySSE2(_mm_mul_ps(Y, Scale));
+            _mm_storeu_si128((__m128i *)(Out + I), _mm_or_si128(QX, _mm_slli_epi32(QY, 16)));
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            Out[I] = PackOctNormal(V3(In[3*I], In[3*I + 1], In[3*I + 2]));
+        }
+    }
+    
+    // Out is Count xyz triples
+    inline void
+        UnpackOctNormals(f32 *Out, u32 *In, int Count)
+    {
+        int I = 0;
+#if CH_SSE2
+        __m128 SignMask = _mm_set1_ps(-0.0f);
+        __m128 One = _mm_set1_ps(1.0f);
+        __m128 MinusOne = _mm_set1_ps(-1.0f);
+        __m128 InvScale = _mm_set1_ps(1.0f / 32767.0f);
+        for (; I + 4 <= Count; I += 4)
+        {
+            __m128i Packed = _mm_loadu_si128((__m128i *)(In + I));
+            __m128 X = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(Packed, 16), 16));
+            __m128 Y = _mm_cvtepi32_ps(_mm_srai_epi32(Packed, 16));
+            X = _mm_max_ps(_mm_mul_ps(X, InvScale), MinusOne);
+            Y = _mm_max_ps(_mm_mul_ps(Y, InvScale), MinusOne);
+            
+            __m128 Z = _mm_sub_ps(_mm_sub_ps(One, _mm_andnot_ps(SignMask, X)), _mm_andnot_ps(SignMask, Y));
+            __m128 T = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), Z), _mm_setzero_ps());
+            // x += x >= 0? -t: t
+            X = _mm_add_ps(X, _mm_xor_ps(T, _mm_andnot_ps(_mm_cmplt_ps(X, _mm_setzero_ps()), SignMask)));
+            Y = _mm_add_ps(Y, _mm_xor_ps(T, _mm_andnot_ps(_mm_cmplt_ps(Y, _mm_setzero_ps()), SignMask)));
+            
+            __m128 LengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(X, X), _mm_mul_ps(Y, Y)), _mm_mul_ps(Z, Z));
+            __m128 InvLength = _mm_div_ps(One, _mm_sqrt_ps(LengthSq));
+            StoreXYZ4(Out + 3 * I, _mm_mul_ps(X, InvLength), _mm_mul_ps(Y, InvLength), _mm_mul_ps(Z, InvLength));
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            v3 N = UnpackOctNormal(In[I]);
+            Out[3*I + 0] = N.X;
+            Out[3*I + 1] = N.Y;
+            Out[3*I + 2] = N.Z;
+        }
+    }
+    
+    //
+    //
+    // 10-10-10-2
+    
+    inline u32
+        PackUnorm1010102(v4 V)
+    {
+        return (F32ToUnorm(V.X, 10) | (F32ToUnorm(V.Y, 10) << 10) |
+                (F32ToUnorm(V.Z, 10) << 20) | (F32ToUnorm(V.W, 2) << 30));
+    }
+    
+    inline v4
+        UnpackUnorm1010102(u32 Packed)
+    {
+        v4 Result;
+        Result.X = UnormToF32(Packed & 0x3FF, 10);
+        Result.Y = UnormToF32((Packed >> 10) & 0x3FF, 10);
+        Result.Z = UnormToF32((Packed >> 20) & 0x3FF, 10);
+        Result.W = UnormToF32(Packed >> 30, 2);
+        return Result;
+    }
+    
+    inline u32
+        PackSnorm1010102(v4 V)
+    {
+        return ((u32(F32ToSnorm(V.X, 10)) & 0x3FF) | ((u32(F32ToSnorm(V.Y, 10)) & 0x3FF) << 10) |
+                ((u32(F32ToSnorm(V.Z, 10)) & 0x3FF) << 20) | (u32(F32ToSnorm(V.W, 2)) << 30));
+    }
+    
+    inline v4
+        UnpackSnorm1010102(u32 Packed)
+    {
+        v4 Result;
+        Result.X = SnormToF32(SignExtend(Packed, 10), 10);
+        Result.Y = SnormToF32(SignExtend(Packed >> 10, 10), 10);
+        Result.Z = SnormToF32(SignExtend(Packed >> 20, 10), 10);
+        Result.W = SnormToF32(SignExtend(Packed >> 30, 2), 2);
+        return Result;
+    }
+    
+    // In is Count xyz triples (normals, tangents), w is written as 0
+    inline void
+        PackSnorm1010102(u32 *Out, f32 *In, int Count)
+    {
+        int I = 0;
+#if CH_SSE2
+        __m128 One = _mm_set1_ps(1.0f);
+        __m128 MinusOne = _mm_set1_ps(-1.0f);
+        __m128 Scale = _mm_set1_ps(511.0f);
+        __m128i Mask = _mm_set1_epi32(0x3FF);
+        for (; I + 4 <= Count; I += 4)
+        {
+            __m128 X, Y, Z;
+            LoadXYZ4(In + 3 * I, &X, &Y, &Z);
+            X = _mm_min_ps(_mm_max_ps(X, MinusOne), One);
+            Y = _mm_min_ps(_mm_max_ps(Y, MinusOne), One);
+            Z = _mm_min_ps(_mm_max_ps(Z, MinusOne), One);
+            __m128i QX = _mm_and_si128(RoundHalfAwaySSE2(_mm_mul_ps(X, Scale)), Mask);
+            __m128i QY = _mm_and_si128(RoundHalfAwaySSE2(_mm_mul_ps(Y, Scale)), Mask);
+            __m128i QZ = _mm_and_si128(RoundHalfAwaySSE2(_mm_mul_ps(Z, Scale)), Mask);
+            __m128i Packed = _mm_or_si128(_mm_or_si128(QX, _mm_slli_epi32(QY, 10)), _mm_slli_epi32(QZ, 20));
+            _mm_storeu_si128((__m128i *)(Out + I), Packed);
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            Out[I] = PackSnorm1010102(V4(In[3*I], In[3*I + 1], In[3*I + 2], 0.0f));
+        }
+    }
+    
+    // Out is Count xyz triples, w is dropped
+    inline void
+        UnpackSnorm1010102(f32 *Out, u32 *In, int Count)
+    {
+        int I = 0;
+#if CH_SSE2
+        __m128 MinusOne = _mm_set1_ps(-1.0f);
+        __m128 InvScale = _mm_set1_ps(1.0f / 511.0f);
+        for (; I + 4 <= Count; I += 4)
+        {
+            __m128i Packed = _mm_loadu_si128((__m128i *)(In + I));
+            __m128 X = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(Packed, 22), 22));
+            __m128 Y = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(Packed, 12), 22));
+            __m128 Z = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(Packed, 2), 22));
+            StoreXYZ4(Out + 3 * I,
+                      _mm_max_ps(_mm_mul_ps(X, InvScale), MinusOne),
+                      _mm_max_ps(_mm_mul_ps(Y, InvScale), MinusOne),
+                      _mm_max_ps(_mm_mul_ps(Z, InvScale), MinusOne));
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            v4 V = UnpackSnorm1010102(In[I]);
+            Out[3*I + 0] = V.X;
+            Out[3*I + 1] = V.Y;
+            Out[3*I + 2] = V.Z;
+        }
+    }
+    
+    //
+    //
+    // quaternion tangent frames
+    
+    // rotation taking the X, Y, Z axes onto the orthonormal, right handed basis AxisX, AxisY, AxisZ
+    inline quaternion
+        QuaternionFromBasis(v3 AxisX, v3 AxisY, v3 AxisZ)
+    {
+        // m[row][col], the basis vectors are the columns
+        f32 M00 = AxisX.X, M01 = AxisY.X, M02 = AxisZ.X;
+        f32 M10 = AxisX.Y, M11 = AxisY.Y, M12 = AxisZ.Y;
+        f32 M20 = AxisX.Z, M21 = AxisY.Z, M22 = AxisZ.Z;
+        
+        quaternion Q;
+        f32 Trace = M00 + M11 + M22;
+        if (Trace > 0.0f)
+        {
+            f32 S = 0.5f / SquareRoot(Trace + 1.0f);
+            Q.W = 0.25f / S;
+            Q.X = (M21 - M12) * S;
+            Q.Y = (M02 - M20) * S;
+            Q.Z = (M10 - M01) * S;
+        }
+        else if (M00 > M11 && M00 > M22)
+        {
+            f32 S = 2.0f * SquareRoot(1.0f + M00 - M11 - M22);
+            Q.W = (M21 - M12) / S;
+            Q.X = 0.25f * S;
+            Q.Y = (M01 + M10) / S;
+            Q.Z = (M02 + M20) / S;
+        }
+        else if (M11 > M22)
+        {
+            f32 S = 2.0f * SquareRoot(1.0f + M11 - M00 - M22);
+            Q.W = (M02 - M20) / S;
+            Q.X = (M01 + M10) / S;
+            Q.Y = 0.25f * S;
+            Q.Z = (M12 + M21) / S;
+        }
+        else
+        {
+            f32 S = 2.0f * SquareRoot(1.0f + M22 - M00 - M11);
+            Q.W = (M10 - M01) / S;
+            Q.X = (M02 + M20) / S;
+            Q.Y = (M12 + M21) / S;
+            Q.Z = 0.25f * S;
+        }
+        return Normalize(Q);
+    }
+    
+    // T doesn't have to be orthogonal to N, it's Gram-Schmidt'ed first
+    inline qtangent
+        PackQTangent(v3 N, v3 T, f32 BitangentSign)
+    {
+        N = Normalize(N);
+        T = Normalize(T - Dot(T, N) * N);
+        quaternion Q = QuaternionFromBasis(T, Cross(N, T), N);
+        
+        // q and -q are the same rotation, keep w >= 0 so its sign is free
+        if (Q.W < 0.0f)
+        {
+            Q.X = -Q.X; Q.Y = -Q.Y; Q.Z = -Q.Z; Q.W = -Q.W;
+        }
+        
+        qtangent Result;
+        Result.X = i16(F32ToSnorm(Q.X, 16));
+        Result.Y = i16(F32ToSnorm(Q.Y, 16));
+        Result.Z = i16(F32ToSnorm(Q.Z, 16));
+        Result.W = i16(F32ToSnorm(Q.W, 16));
+        
+        //NOTE(chen): w must not quantize to 0 or the sign is lost, the
+        //            smallest step is a negligible rotation error
+        if (Result.W == 0) Result.W = 1;
+        if (BitangentSign < 0.0f)
+        {
+            Result.X = i16(-Result.X); Result.Y = i16(-Result.Y);
+            Result.Z = i16(-Result.Z); Result.W = i16(-Result.W);
+        }
+        return Result;
+    }
+    
+    inline void
+        UnpackQTangent(qtangent Packed, v3 *N_Out, v3 *T_Out, f32 *BitangentSign_Out)
+    {
+        quaternion Q;
+        Q.X = SnormToF32(Packed.X, 16);
+        Q.Y = SnormToF32(Packed.Y, 16);
+        Q.Z = SnormToF32(Packed.Z, 16);
+        Q.W = SnormToF32(Packed.W, 16);
+        Q = Normalize(Q);
+        
+        // first and third rows of the rotation matrix
+        *T_Out = V3(1.0f - 2.0f * (Q.Y*Q.Y + Q.Z*Q.Z), 2.0f * (Q.X*Q.Y + Q.Z*Q.W), 2.0f * (Q.X*Q.Z - Q.Y*Q.W));
+        *N_Out = V3(2.0f * (Q.X*Q.Z + Q.Y*Q.W), 2.0f * (Q.Y*Q.Z - Q.X*Q.W), 1.0f - 2.0f * (Q.X*Q.X + Q.Y*Q.Y));
+        *BitangentSign_Out = Packed.W < 0? -1.0f: 1.0f;
+    }
+    
+    // N, T are Count xyz triples, Signs may be null (all +1)
+    inline void
+        PackQTangents(qtangent *Out, f32 *N, f32 *T, f32 *Signs, int Count)
+    {
+        for (int I = 0; I < Count; ++I)
+        {
+            v3 Normal = V3(N[3*I], N[3*I + 1], N[3*I + 2]);
+            v3 Tangent = V3(T[3*I], T[3*I + 1], T[3*I + 2]);
+            Out[I] = PackQTangent(Normal, Tangent, Signs? Signs[I]: 1.0f);
+        }
+    }
+    
+    // N, T are Count xyz triples, Signs may be null
+    inline void
+        UnpackQTangents(f32 *N, f32 *T, f32 *Signs, qtangent *In, int Count)
+    {
+        int I = 0;
+#if CH_SSE2
+        __m128 One = _mm_set1_ps(1.0f);
+        __m128 Two = _mm_set1_ps(2.0f);
+        for (; I + 4 <= Count; I += 4)
+        {
+            // 4 x (x y z w) i16 to SoA floats, the snorm scale cancels out in the normalize
+            __m128i Low = _mm_loadu_si128((__m128i *)(In + I)); // q0 q1
+            __m128i High = _mm_loadu_si128((__m128i *)(In + I + 2)); // q2 q3
+            __m128i A = _mm_unpacklo_epi16(Low, High); // x0 x2 y0 y2 z0 z2 w0 w2
+            __m128i B = _mm_unpackhi_epi16(Low, High); // x1 x3 y1 y3 z1 z3 w1 w3
+            __m128i XY = _mm_unpacklo_epi16(A, B); // x0 x1 x2 x3 y0 y1 y2 y3
+            __m128i ZW = _mm_unpackhi_epi16(A, B); // z0 z1 z2 z3 w0 w1 w2 w3
+            __m128 X = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(XY, XY), 16));
+            __m128 Y = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(XY, XY), 16));
+            __m128 Z = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(ZW, ZW), 16));
+            __m128 W = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(ZW, ZW), 16));
+            
+            __m128 LengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(X, X), _mm_mul_ps(Y, Y)),
+                                         _mm_add_ps(_mm_mul_ps(Z, Z), _mm_mul_ps(W, W)));
+            __m128 InvLength = _mm_div_ps(One, _mm_sqrt_ps(LengthSq));
+            __m128 Sign = _mm_or_ps(One, _mm_and_ps(W, _mm_set1_ps(-0.0f)));
+            X = _mm_mul_ps(X, InvLength);
+            Y = _mm_mul_ps(Y, InvLength);
+            Z = _mm_mul_ps(Z, InvLength);
+            W = _mm_mul_ps(W, InvLength);
+            
+            __m128 XX = _mm_mul_ps(X, X), YY = _mm_mul_ps(Y, Y), ZZ = _mm_mul_ps(Z, Z);
+            __m128 XY2 = _mm_mul_ps(X, Y), XZ = _mm_mul_ps(X, Z), YZ = _mm_mul_ps(Y, Z);
+            __m128 XW = _mm_mul_ps(X, W), YW = _mm_mul_ps(Y, W), ZW2 = _mm_mul_ps(Z, W);
+            
+            StoreXYZ4(T + 3 * I,
+                      _mm_sub_ps(One, _mm_mul_ps(Two, _mm_add_ps(YY, ZZ))),
+                      _mm_mul_ps(Two, _mm_add_ps(XY2, ZW2)),
+                      _mm_mul_ps(Two, _mm_sub_ps(XZ, YW)));
+            StoreXYZ4(N + 3 * I,
+                      _mm_mul_ps(Two, _mm_add_ps(XZ, YW)),
+                      _mm_mul_ps(Two, _mm_sub_ps(YZ, XW)),
+                      _mm_sub_ps(One, _mm_mul_ps(Two, _mm_add_ps(XX, YY))));
+            if (Signs) _mm_storeu_ps(Signs + I, Sign);
+        }
+#endif
+        for (; I < Count; ++I)
+        {
+            v3 Normal, Tangent;
+            f32 Sign;
+            UnpackQTangent(In[I], &Normal, &Tangent, &Sign);
+            N[3*I + 0] = Normal.X; N[3*I + 1] = Normal.Y; N[3*I + 2] = Normal.Z;
+            T[3*I + 0] = Tangent.X; T[3*I + 1] = Tangent.Y; T[3*I + 2] = Tangent.Z;
+            if (Signs) Signs[I] = Sign;
+        }
+    }
+    
+    //
+    //
+    // meshes
+    
+    // half positions + oct normals, caller frees. Meshes without normals get +Z
+    inline packed_vertex *
+        PackMesh(ch_obj::Mesh *Mesh)
+    {
+        int Count = Mesh->vertex_count;
+        packed_vertex *Result = (packed_vertex *)malloc(sizeof(packed_vertex) * Count);
+        u16 *Halves = (u16 *)malloc(sizeof(u16) * 3 * Count);
+        u32 *Normals = (u32 *)malloc(sizeof(u32) * Count);
+        
+        PackHalf(Halves, Mesh->vb, 3 * Count);
+        if (Mesh->nb)
+        {
+            PackOctNormals(Normals, Mesh->nb, Count);
+        }
+        
+        u32 Up = PackOctNormal(V3(0.0f, 0.0f, 1.0f));
+        for (int I = 0; I < Count; ++I)
+        {
+            Result[I].P[0] = Halves[3*I + 0];
+            Result[I].P[1] = Halves[3*I + 1];
+            Result[I].P[2] = Halves[3*I + 2];
+            Result[I].P[3] = 0x3C00; // 1.0
+            Result[I].N = Mesh->nb? Normals[I]: Up;
+        }
+        
+        free(Halves);
+        free(Normals);
+        return Result;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,552 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+// timing
+u64 Begin = ch::GetTicks(); // rdtsc on x86, the OS clock elsewhere
+...
+f64 Milliseconds = ch::TicksToMilliseconds(ch::GetTicks() - Begin);
+f64 Now = ch::GetSeconds();
+
+// zones, on any thread. Names must outlive the profiler (string literals)
+void UpdateWorld()
+{
+    CH_ZONE_FUNCTION();
+    {
+        CH_ZONE("physics");
+        ...
+    } // "physics" ends here, through defer
+}
+
+ch::SetProfileThreadName("render"); // shows up in the trace viewer
+ch::SaveChromeTrace("trace.json");  // chrome://tracing, ui.perfetto.dev or speedscope
+
+Timing:
+
+GetTicks reads the TSC on x86 and the monotonic OS clock (clock_gettime or
+QueryPerformanceCounter) elsewhere, or everywhere with CH_PROFILE_NO_TSC. The tick
+rate is calibrated against the OS clock the first time it's needed, that takes
+CH_PROFILE_CALIBRATION_MS. It assumes an invariant TSC, which every x86 CPU of the
+last decade has.
+
+Zones:
+
+CH_ZONE pushes a begin event and defers the end event to the end of the scope.
+An event is a timestamp and a name, the end event has no name. Each thread
+writes into its own ring of CH_PROFILE_RING_SIZE events. There are no locks and
+no shared cache lines with other writers. ExportChromeTrace is the only reader.
+It takes everything recorded since the last export. A full ring drops new zones
+until the next export. Zones are dropped whole and the end of every open zone
+has room reserved, so the trace always nests. Build with CH_PROFILE=0 to compile
+zones out.
+*/
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if !defined(CH_PROFILE_NO_TSC) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CH_PROFILE_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define CH_PROFILE_TSC 0
+#endif
+
+#ifndef CH_PROFILE
+#define CH_PROFILE 1
+#endif
+
+#ifndef CH_PROFILE_RING_SIZE
+#define CH_PROFILE_RING_SIZE (64 * 1024) // events per thread, power of 2
+#endif
+
+#ifndef CH_PROFILE_MAX_TRACKS
+#define CH_PROFILE_MAX_TRACKS 256
+#endif
+
+#ifndef CH_PROFILE_CALIBRATION_MS
+#define CH_PROFILE_CALIBRATION_MS 20
+#endif
+
+// the same as ch_math.h's and kernel.h's, this header goes with either
+typedef uint8_t u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int64_t i64;
+typedef double f64;
+
+// same as kernel.h's, whichever comes first defines it
+#ifndef defer
+template <typename F>
+struct FunctionWrapper
+{
+    F Function;
+    FunctionWrapper(F Function): Function(Function)
+    {
+    }
+    ~FunctionWrapper()
+    {
+        Function();
+    }
+};
+template <typename F>
+FunctionWrapper<F> DeferFunction(F Function)
+{
+    return FunctionWrapper<F>(Function);
+}
+#define DEFER_1(X, Y) X##Y
+#define DEFER_2(X, Y) DEFER_1(X, Y)
+#define DEFER_3(Name) DEFER_2(Name, __COUNTER__)
+#define defer(code) auto DEFER_3(_defer_) = DeferFunction([&](){code;})
+#endif
+
+#if CH_PROFILE
+#define CH_ZONE(Name) ch::BeginZone(Name); defer(ch::EndZone())
+#else
+#define CH_ZONE(Name)
+#endif
+#define CH_ZONE_FUNCTION() CH_ZONE(__FUNCTION__)
+
+namespace ch
+{
+    //
+    //
+    // timing
+    
+    // monotonic, not affected by clock changes
+    inline u64
+        GetClockNanoseconds()
+    {
+#if defined(_WIN32)
+        static const u64 Frequency = []()
+        {
+            LARGE_INTEGER Result;
+            QueryPerformanceFrequency(&Result);
+            return u64(Result.QuadPart);
+        }();
+        LARGE_INTEGER Counter;
+        QueryPerformanceCounter(&Counter);
+        u64 Seconds = u64(Counter.QuadPart) / Frequency;
+        u64 Remainder = u64(Counter.QuadPart) % Frequency;
+        return Seconds * 1000000000ull + Remainder * 1000000000ull / Frequency;
+#else
+        timespec Time;
+        clock_gettime(CLOCK_MONOTONIC, &Time);
+        return u64(Time.tv_sec) * 1000000000ull + u64(Time.tv_nsec);
+#endif
+    }
+    
+    inline u64
+        GetTicks()
+    {
+#if CH_PROFILE_TSC
+        return __rdtsc();
+#else
+        return GetClockNanoseconds();
+#endif
+    }
+    
+    struct tick_clock
+    {
+        f64 TicksPerSecond;
+        f64 SecondsPerTick;
+        
+        tick_clock()
+        {
+#if CH_PROFILE_TSC
+            //NOTE(chen): both clock reads are bracketed by two TSC reads so a preemption
+            //            in between can't skew the rate by more than the bracket. The wait
+            //            only reads the OS clock, some hypervisors trap RDTSC and their
+            //            emulated TSC drifts when it's read in a tight loop. The first read
+            //            of the OS clock can be slow, it's not part of a bracket
+            GetClockNanoseconds();
+            u64 Before = GetTicks();
+            u64 ClockBegin = GetClockNanoseconds();
+            u64 TicksBegin = Before + (GetTicks() - Before) / 2;
+            while (GetClockNanoseconds() - ClockBegin < CH_PROFILE_CALIBRATION_MS * 1000000ull)
+            {
+            }
+            Before = GetTicks();
+            u64 ClockEnd = GetClockNanoseconds();
+            u64 TicksEnd = Before + (GetTicks() - Before) / 2;
+            TicksPerSecond = f64(TicksEnd - TicksBegin) * 1e9 / f64(ClockEnd - ClockBegin);
+#else
+            TicksPerSecond = 1e9;
+#endif
+            SecondsPerTick = 1.0 / TicksPerSecond;
+        }
+    };
+    
+    // one calibration per program, not per translation unit
+    inline const tick_clock *
+        GetTickClock()
+    {
+        static tick_clock Clock;
+        return &Clock;
+    }
+    
+    inline f64
+        GetTicksPerSecond()
+    {
+        return GetTickClock()->TicksPerSecond;
+    }
+    
+    inline f64
+        TicksToSeconds(u64 Ticks)
+    {
+        return f64(Ticks) * GetTickClock()->SecondsPerTick;
+    }
+    
+    inline f64
+        TicksToMilliseconds(u64 Ticks)
+    {
+        return 1000.0 * TicksToSeconds(Ticks);
+    }
+    
+    inline f64
+        GetSeconds()
+    {
+        return f64(GetClockNanoseconds()) * 1e-9;
+    }
+    
+    //
+    //
+    // zones
+    
+    struct profile_event
+    {
+        u64 Ticks;
+        const char *Name; // 0 ends the innermost open zone
+    };
+    
+    struct profile_track
+    {
+        // owning thread only
+        profile_event *Events;
+        u64 Mask;
+        u64 WriteHead;
+        u64 CachedTail;
+        u32 Depth;     // open zones, their end events have room reserved
+        u32 SkipDepth; // open zones that got dropped, their ends are dropped too
+        
+        std::atomic<u64> Head;
+        std::atomic<u64> Dropped;
+        std::atomic<const char *> Name;
+        int Id;
+        
+        // exporter only, on its own cache line
+        u8 Padding[64];
+        std::atomic<u64> Tail;
+        u32 ExportDepth;
+    };
+    
+    struct profiler
+    {
+        std::atomic<int> TrackCount;
+        std::atomic<profile_track *> Tracks[CH_PROFILE_MAX_TRACKS];
+        std::mutex ExportLock;
+        u64 BaseTicks; // trace timestamps are relative to this
+    };
+    
+    inline profiler *
+        GetProfiler()
+    {
+        static profiler Profiler;
+        return &Profiler;
+    }
+    
+    // a timeline of its own, for threads or anything else with begin/end events (GPU
+    // timers). Only one thread may push to a track. Capacity is rounded up to a power of 2
+    inline profile_track *
+        CreateProfileTrack(const char *Name, u32 Capacity = CH_PROFILE_RING_SIZE)
+    {
+        u32 RoundedCapacity = 2;
+        while (RoundedCapacity < Capacity) RoundedCapacity *= 2;
+        
+        profile_track *Track = new profile_track();
+        Track->Events = new profile_event[RoundedCapacity];
+        Track->Mask = RoundedCapacity - 1;
+        Track->Name.store(Name, std::memory_order_relaxed);
+        
+        // past the limit the track still works, it just never gets exported
+        profiler *Profiler = GetProfiler();
+        int Index = Profiler->TrackCount.fetch_add(1, std::memory_order_relaxed);
+        Track->Id = Index + 1;
+        if (Index < CH_PROFILE_MAX_TRACKS)
+        {
+            Profiler->Tracks[Index].store(Track, std::memory_order_release);
+        }
+        return Track;
+    }
+    
+    inline profile_track *&
+        GetThreadTrackSlot()
+    {
+        static thread_local profile_track *Track = 0;
+        return Track;
+    }
+    
+    inline profile_track *
+        GetThreadTrack()
+    {
+        profile_track *&Track = GetThreadTrackSlot();
+        if (!Track)
+        {
+            Track = CreateProfileTrack("thread");
+        }
+        return Track;
+    }
+    
+    inline void
+        SetProfileThreadName(const char *Name)
+    {
+        GetThreadTrack()->Name.store(Name, std::memory_order_relaxed);
+    }
+    
+    // Ticks from GetTicks, or anything on the same timeline
+    inline void
+        PushZoneBegin(profile_track *Track, const char *Name, u64 Ticks)
+    {
+        u64 Head = Track->WriteHead;
+        u64 Needed = Head - Track->CachedTail + Track->Depth + 2; // this begin and its end
+        if (Track->SkipDepth || Needed > Track->Mask + 1)
+        {
+            Track->CachedTail = Track->Tail.load(std::memory_order_acquire);
+            Needed = Head - Track->CachedTail + Track->Depth + 2;
+            if (Track->SkipDepth || Needed > Track->Mask + 1)
+            {
+                ++Track->SkipDepth;
+                Track->Dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        
+        profile_event *Event = &Track->Events[Head & Track->Mask];
+        Event->Ticks = Ticks;
+        Event->Name = Name;
+        ++Track->Depth;
+        Track->WriteHead = Head + 1;
+        Track->Head.store(Head + 1, std::memory_order_release);
+    }
+    
+    inline void
+        PushZoneEnd(profile_track *Track, u64 Ticks)
+    {
+        if (Track->SkipDepth)
+        {
+            --Track->SkipDepth;
+            return;
+        }
+        if (!Track->Depth)
+        {
+            return; // an end without a begin
+        }
+        
+        u64 Head = Track->WriteHead;
+        profile_event *Event = &Track->Events[Head & Track->Mask];
+        Event->Ticks = Ticks;
+        Event->Name = 0;
+        --Track->Depth;
+        Track->WriteHead = Head + 1;
+        Track->Head.store(Head + 1, std::memory_order_release);
+    }
+    
+    inline void
+        BeginZone(const char *Name)
+    {
+        PushZoneBegin(GetThreadTrack(), Name, GetTicks());
+    }
+    
+    inline void
+        EndZone()
+    {
+        PushZoneEnd(GetThreadTrack(), GetTicks());
+    }
+    
+    //
+    //
+    // chrome trace export
+    
+    struct profile_text
+    {
+        char *Data;
+        size_t Size;
+        size_t Capacity;
+    };
+    
+    inline void
+        AppendProfileText(profile_text *Text, const char *Format, ...)
+    {
+        for (;;)
+        {
+            va_list Args;
+            va_start(Args, Format);
+            int Length = vsnprintf(Text->Data + Text->Size, Text->Capacity - Text->Size, Format, Args);
+            va_end(Args);
+            if (Length >= 0 && Text->Size + size_t(Length) < Text->Capacity)
+            {
+                Text->Size += size_t(Length);
+                return;
+            }
+            Text->Capacity = Text->Capacity * 2 + (Length > 0? size_t(Length): 0) + 4096;
+            Text->Data = (char *)realloc(Text->Data, Text->Capacity);
+        }
+    }
+    
+    inline void
+        AppendProfileBytes(profile_text *Text, const char *Bytes, size_t Size)
+    {
+        if (Text->Size + Size + 1 > Text->Capacity)
+        {
+            Text->Capacity = Text->Capacity * 2 + Size + 4096;
+            Text->Data = (char *)realloc(Text->Data, Text->Capacity);
+        }
+        memcpy(Text->Data + Text->Size, Bytes, Size);
+        Text->Size += Size;
+        Text->Data[Text->Size] = 0;
+    }
+    
+    // as a JSON string, quotes included
+    inline void
+        AppendProfileString(profile_text *Text, const char *String)
+    {
+        AppendProfileBytes(Text, "\"", 1);
+        const char *Run = String;
+        for (const char *C = String; *C; ++C)
+        {
+            if (*C == '"' || *C == '\\' || (u8)*C < 0x20)
+            {
+                AppendProfileBytes(Text, Run, size_t(C - Run));
+                if ((u8)*C < 0x20) AppendProfileText(Text, "\\u%04x", (u8)*C);
+                else AppendProfileText(Text, "\\%c", *C);
+                Run = C + 1;
+            }
+        }
+        AppendProfileBytes(Text, Run, strlen(Run));
+        AppendProfileBytes(Text, "\"", 1);
+    }
+    
+    // malloc'd Chrome trace event JSON with every event since the last export, Size_Out excludes
+    // the terminating 0. Zones still open show up when they end, in the next export
+    inline char *
+        ExportChromeTrace(size_t *Size_Out)
+    {
+        profiler *Profiler = GetProfiler();
+        std::lock_guard<std::mutex> Guard(Profiler->ExportLock);
+        f64 MicrosecondsPerTick = 1e6 * GetTickClock()->SecondsPerTick;
+        
+        profile_text Text = {};
+        AppendProfileText(&Text, "{\"traceEvents\":[\n");
+        bool First = true;
+        
+        int TrackCount = Profiler->TrackCount.load(std::memory_order_relaxed);
+        TrackCount = TrackCount < CH_PROFILE_MAX_TRACKS? TrackCount: CH_PROFILE_MAX_TRACKS;
+        u64 Heads[CH_PROFILE_MAX_TRACKS];
+        for (int TrackI = 0; TrackI < TrackCount; ++TrackI)
+        {
+            profile_track *Track = Profiler->Tracks[TrackI].load(std::memory_order_acquire);
+            Heads[TrackI] = Track? Track->Head.load(std::memory_order_acquire): 0;
+        }
+        
+        // the first export starts the timeline at its earliest event
+        if (!Profiler->BaseTicks)
+        {
+            u64 Earliest = UINT64_MAX;
+            for (int TrackI = 0; TrackI < TrackCount; ++TrackI)
+            {
+                profile_track *Track = Profiler->Tracks[TrackI].load(std::memory_order_acquire);
+                u64 Tail = Track? Track->Tail.load(std::memory_order_relaxed): 0;
+                if (Track && Tail != Heads[TrackI] && Track->Events[Tail & Track->Mask].Ticks < Earliest)
+                {
+                    Earliest = Track->Events[Tail & Track->Mask].Ticks;
+                }
+            }
+            Profiler->BaseTicks = Earliest != UINT64_MAX? Earliest: 0;
+        }
+        
+        for (int TrackI = 0; TrackI < TrackCount; ++TrackI)
+        {
+            profile_track *Track = Profiler->Tracks[TrackI].load(std::memory_order_acquire);
+            if (!Track) continue; // registered a moment ago, not published yet
+            
+            u64 Head = Heads[TrackI];
+            u64 Tail = Track->Tail.load(std::memory_order_relaxed);
+            
+            AppendProfileText(&Text, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                              First? "": ",\n", Track->Id);
+            AppendProfileString(&Text, Track->Name.load(std::memory_order_relaxed));
+            AppendProfileText(&Text, "}}");
+            First = false;
+            
+            for (u64 I = Tail; I < Head; ++I)
+            {
+                const profile_event *Event = &Track->Events[I & Track->Mask];
+                f64 Timestamp = f64(i64(Event->Ticks - Profiler->BaseTicks)) * MicrosecondsPerTick;
+                if (Event->Name)
+                {
+                    AppendProfileBytes(&Text, ",\n{\"name\":", 10);
+                    AppendProfileString(&Text, Event->Name);
+                    AppendProfileText(&Text, ",\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", Track->Id, Timestamp);
+                    ++Track->ExportDepth;
+                }
+                else if (Track->ExportDepth)
+                {
+                    AppendProfileText(&Text, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", Track->Id, Timestamp);
+                    --Track->ExportDepth;
+                }
+            }
+            Track->Tail.store(Head, std::memory_order_release);
+        }
+        
+        AppendProfileText(&Text, "\n],\"displayTimeUnit\":\"ms\"}\n");
+        *Size_Out = Text.Size;
+        return Text.Data;
+    }
+    
+    inline bool
+        SaveChromeTrace(const char *Path)
+    {
+        size_t Size = 0;
+        char *Trace = ExportChromeTrace(&Size);
+        bool Result = false;
+        FILE *File = fopen(Path, "wb");
+        if (File)
+        {
+            Result = fwrite(Trace, 1, Size, File) == Size;
+            Result = (fclose(File) == 0) && Result;
+        }
+        free(Trace);
+        return Result;
+    }
+    
+    // zones the full rings had to drop, over all tracks
+    inline u64
+        GetDroppedZoneCount()
+    {
+        profiler *Profiler = GetProfiler();
+        int TrackCount = Profiler->TrackCount.load(std::memory_order_relaxed);
+        TrackCount = TrackCount < CH_PROFILE_MAX_TRACKS? TrackCount: CH_PROFILE_MAX_TRACKS;
+        u64 Result = 0;
+        for (int TrackI = 0; TrackI < TrackCount; ++TrackI)
+        {
+            profile_track *Track = Profiler->Tracks[TrackI].load(std::memory_order_acquire);
+            if (Track) Result += Track->Dropped.load(std::memory_order_relaxed);
+        }
+        return Result;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,846 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch_obj::Model Model = ch_obj::load_model("bunny.obj");
+ch_obj::Mesh Mesh = ch_obj::weld_model(&Model);
+
+ch::raster_context Raster = ch::InitRasterContext(1920, 1080, 0); // 0 = all hardware threads
+
+ch::raster_draw Draw = {};
+Draw.Mesh = &Mesh;
+Draw.Transform = Mat4Identity();
+Draw.Color = 0xFFC0C0C0;
+
+mat4 ViewProj = Mat4LookAt(Eye, Target) * Mat4Perspective(60.0f, 16.0f/9.0f, 0.1f, 100.0f);
+ch::ClearFramebuffer(&Raster.Framebuffer, 0xFF202020);
+ch::Render(&Raster, &Draw, 1, ViewProj, Normalize(V3(-1.0f, -1.0f, 1.0f)));
+
+CH_BMP::WriteImageToBMP("out.bmp", Raster.Framebuffer.Color, 1920, 1080);
+ch::FreeRasterContext(&Raster);
+
+Pipeline:
+
+1. vertices of every draw are transformed to clip space and shaded (lambert),
+   split evenly across threads
+2. triangles are split into contiguous ranges per thread, clipped against the
+   near plane and guard band, snapped to 1/16th of a pixel, set up (integer
+   edge functions, depth, 1/w and shade planes) and binned into the screen
+   tiles they touch. Every thread owns its own bins, so binning doesn't take
+   any locks. Integer edge functions of a shared edge are exact negations of
+   each other, so meshes rasterize without cracks or double hits
+3. threads grab whole tiles and walk them in 8x8 pixel blocks. Edge functions
+   evaluated at the block corners reject a block or drop the edges that fully
+   cover it, the rest is shaded 4 pixels at a time. Bins are replayed in thread order, which
+   is submission order, so the output doesn't depend on the thread count
+
+Framebuffer rows go bottom to top (NDC y = -1 is row 0) and colors are
+0xAARRGGBB, which is the layout CH_BMP::WriteImageToBMP writes out.
+*/
+
+#include "ch_math.h"
+#include "ch_obj.h"
+#include "ch_buf.h"
+#include "ch_simd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <atomic>
+
+#ifndef CH_RASTER_TILE_SIZE
+#define CH_RASTER_TILE_SIZE 64
+#endif
+
+// clip space triangles are clipped to |x|, |y| <= GUARD_BAND * w, which bounds
+// screen coordinates so the fixed point edge functions can't overflow
+#ifndef CH_RASTER_GUARD_BAND
+#define CH_RASTER_GUARD_BAND 4.0f
+#endif
+
+#define CH_RASTER_BLOCK_SIZE 8
+#define CH_RASTER_SUBPIXEL_BITS 4
+static_assert(CH_RASTER_TILE_SIZE % CH_RASTER_BLOCK_SIZE == 0,
+              "tiles must be made of whole blocks");
+
+namespace ch
+{
+    enum raster_cull_mode
+    {
+        RasterCull_None,
+        RasterCull_CW, // cull triangles that are clockwise on screen
+        RasterCull_CCW,
+    };
+    
+    struct framebuffer
+    {
+        u32 *Color;
+        f32 *Depth; // 0 near, 1 far
+        int Width;
+        int Height;
+    };
+    
+    struct raster_draw
+    {
+        ch_obj::Mesh *Mesh;
+        mat4 Transform; // object to world
+        u32 Color; // 0xAARRGGBB
+    };
+    
+    struct raster_vertex
+    {
+        v4 P; // clip space
+        f32 Shade; // -1 if the mesh has no normals
+        
+        // screen space, only valid if P is inside the guard band
+        i32 FX, FY; // subpixel units
+        f32 Z;
+        f32 InvW;
+    };
+    
+    // edges are E(x, y) = A*x + B*y + C in subpixel units, a pixel is covered
+    // when all three are >= 0. Attribute planes are in pixel units relative to
+    // the first vertex: V(x, y) = A*(x - OriginX) + B*(y - OriginY) + C
+    struct raster_triangle
+    {
+        i32 EdgeA[3], EdgeB[3];
+        i64 EdgeC[3]; // fill rule bias folded in
+        f32 OriginX, OriginY;
+        f32 ZA, ZB, ZC;
+        f32 InvWA, InvWB, InvWC;
+        f32 ShadeA, ShadeB, ShadeC; // shade / w
+        i32 MinX, MinY, MaxX, MaxY;
+        u32 Color;
+    };
+    
+    struct raster_thread
+    {
+        raster_triangle *Triangles; // ch_buf
+        u32 **Bins; // one ch_buf per tile, indexes Triangles
+    };
+    
+    struct raster_stats
+    {
+        u64 SubmittedTriangles;
+        u64 BinnedTriangles; // survived culling and clipping
+    };
+    
+    struct raster_context
+    {
+        framebuffer Framebuffer;
+        int ThreadCount;
+        int TileCountX;
+        int TileCountY;
+        raster_thread *Threads;
+        raster_vertex *Vertices;
+        int VertexCap;
+        
+        raster_cull_mode CullMode;
+        f32 Ambient;
+        raster_stats Stats;
+    };
+    
+    //
+    //
+    // framebuffer
+    
+    inline framebuffer
+        InitFramebuffer(int Width, int Height)
+    {
+        framebuffer FB = {};
+        FB.Width = Width;
+        FB.Height = Height;
+        FB.Color = (u32 *)malloc(sizeof(u32) * Width * Height);
+        FB.Depth = (f32 *)malloc(sizeof(f32) * Width * Height);
+        return FB;
+    }
+    
+    inline void
+        FreeFramebuffer(framebuffer *FB)
+    {
+        free(FB->Color);
+        free(FB->Depth);
+        *FB = {};
+    }
+    
+    inline void
+        ClearFramebuffer(framebuffer *FB, u32 Color, f32 Depth = 1.0f)
+    {
+        int PixelCount = FB->Width * FB->Height;
+        for (int I = 0; I < PixelCount; ++I)
+        {
+            FB->Color[I] = Color;
+            FB->Depth[I] = Depth;
+        }
+    }
+    
+    //
+    //
+    // context
+    
+    // runs Work(ThreadIndex) on ThreadCount threads, the calling thread being index 0
+    template <typename F>
+        inline void
+        RasterParallel(int ThreadCount, F Work)
+    {
+        std::thread Workers[64];
+        CH_ASSERT(ThreadCount <= 64);
+        for (int I = 1; I < ThreadCount; ++I)
+        {
+            Workers[I] = std::thread(Work, I);
+        }
+        Work(0);
+        for (int I = 1; I < ThreadCount; ++I)
+        {
+            Workers[I].join();
+        }
+    }
+    
+    // ThreadCount <= 0 uses std::thread::hardware_concurrency()
+    inline raster_context
+        InitRasterContext(int Width, int Height, int ThreadCount)
+    {
+        raster_context Context = {};
+        
+        if (ThreadCount <= 0)
+        {
+            ThreadCount = int(std::thread::hardware_concurrency());
+            if (ThreadCount <= 0) ThreadCount = 1;
+        }
+        if (ThreadCount > 64) ThreadCount = 64;
+        
+        Context.Framebuffer = InitFramebuffer(Width, Height);
+        Context.ThreadCount = ThreadCount;
+        Context.TileCountX = (Width + CH_RASTER_TILE_SIZE - 1) / CH_RASTER_TILE_SIZE;
+        Context.TileCountY = (Height + CH_RASTER_TILE_SIZE - 1) / CH_RASTER_TILE_SIZE;
+        Context.Threads = (raster_thread *)calloc(ThreadCount, sizeof(raster_thread));
+        
+        int TileCount = Context.TileCountX * Context.TileCountY;
+        for (int ThreadI = 0; ThreadI < ThreadCount; ++ThreadI)
+        {
+            Context.Threads[ThreadI].Bins = (u32 **)calloc(TileCount, sizeof(u32 *));
+        }
+        
+        Context.CullMode = RasterCull_None;
+        Context.Ambient = 0.15f;
+        
+        return Context;
+    }
+    
+    inline void
+        FreeRasterContext(raster_context *Context)
+    {
+        int TileCount = Context->TileCountX * Context->TileCountY;
+        for (int ThreadI = 0; ThreadI < Context->ThreadCount; ++ThreadI)
+        {
+            raster_thread *Thread = Context->Threads + ThreadI;
+            for (int TileI = 0; TileI < TileCount; ++TileI)
+            {
+                ChBufFree(Thread->Bins[TileI]);
+            }
+            free(Thread->Bins);
+            ChBufFree(Thread->Triangles);
+        }
+        free(Context->Threads);
+        free(Context->Vertices);
+        FreeFramebuffer(&Context->Framebuffer);
+        *Context = {};
+    }
+    
+    //
+    //
+    // geometry
+    
+    inline raster_vertex
+        LerpVertex(raster_vertex A, raster_vertex B, f32 T)
+    {
+        raster_vertex Result = {};
+        Result.P.X = Lerp(A.P.X, B.P.X, T);
+        Result.P.Y = Lerp(A.P.Y, B.P.Y, T);
+        Result.P.Z = Lerp(A.P.Z, B.P.Z, T);
+        Result.P.W = Lerp(A.P.W, B.P.W, T);
+        Result.Shade = Lerp(A.Shade, B.Shade, T);
+        return Result;
+    }
+    
+    // ch_math's Dot(v4, v4) only looks at xyz
+    inline f32
+        PlaneDistance(v4 P, v4 Plane)
+    {
+        return P.X * Plane.X + P.Y * Plane.Y + P.Z * Plane.Z + P.W * Plane.W;
+    }
+    
+    // keeps the part of the polygon where PlaneDistance(P, Plane) >= 0, returns the new vertex count
+    inline int
+        ClipPolygon(raster_vertex *In, int InCount, raster_vertex *Out, v4 Plane)
+    {
+        int OutCount = 0;
+        for (int I = 0; I < InCount; ++I)
+        {
+            raster_vertex A = In[I];
+            raster_vertex B = In[(I + 1) % InCount];
+            f32 DistA = PlaneDistance(A.P, Plane);
+            f32 DistB = PlaneDistance(B.P, Plane);
+            
+            if (DistA >= 0.0f)
+            {
+                Out[OutCount++] = A;
+            }
+            if ((DistA >= 0.0f) != (DistB >= 0.0f))
+            {
+                Out[OutCount++] = LerpVertex(A, B, DistA / (DistA - DistB));
+            }
+        }
+        return OutCount;
+    }
+    
+    inline bool
+        IsInsideGuardBand(v4 P)
+    {
+        f32 Limit = CH_RASTER_GUARD_BAND * P.W;
+        return P.Z >= -P.W && Abs(P.X) <= Limit && Abs(P.Y) <= Limit;
+    }
+    
+    // clips against the near plane (z >= -w) and the guard band, Out needs room for 8 vertices
+    inline int
+        ClipTriangle(raster_vertex *In, raster_vertex *Out)
+    {
+        f32 G = CH_RASTER_GUARD_BAND;
+        v4 Planes[5] = {
+            {0.0f, 0.0f, 1.0f, 1.0f},
+            {-1.0f, 0.0f, 0.0f, G}, {1.0f, 0.0f, 0.0f, G},
+            {0.0f, -1.0f, 0.0f, G}, {0.0f, 1.0f, 0.0f, G},
+        };
+        
+        raster_vertex Temp[8];
+        raster_vertex *Src = Temp, *Dest = Out;
+        Temp[0] = In[0];
+        Temp[1] = In[1];
+        Temp[2] = In[2];
+        int Count = 3;
+        for (int PlaneI = 0; PlaneI < 5 && Count > 0; ++PlaneI)
+        {
+            Count = ClipPolygon(Src, Count, Dest, Planes[PlaneI]);
+            raster_vertex *Swap = Src;
+            Src = Dest;
+            Dest = Swap;
+        }
+        if (Src != Out)
+        {
+            memcpy(Out, Src, sizeof(raster_vertex) * Count);
+        }
+        return Count;
+    }
+    
+    template <typename T>
+        inline void
+        RasterSwap(T *A, T *B)
+    {
+        T Temp = *A;
+        *A = *B;
+        *B = Temp;
+    }
+    
+    inline i32
+        RasterMin(i32 *V)
+    {
+        i32 Result = V[0] < V[1]? V[0]: V[1];
+        return Result < V[2]? Result: V[2];
+    }
+    
+    inline i32
+        RasterMax(i32 *V)
+    {
+        i32 Result = V[0] > V[1]? V[0]: V[1];
+        return Result > V[2]? Result: V[2];
+    }
+    
+    // round to nearest, without the libm call
+    inline i32
+        RasterRound(f32 Value)
+    {
+        return i32(Value + (Value >= 0.0f? 0.5f: -0.5f));
+    }
+    
+    // perspective divide and snap, done once per vertex since most of them are shared
+    inline void
+        ProjectVertex(raster_vertex *V, framebuffer *FB)
+    {
+        f32 SubpixelScale = f32(1 << CH_RASTER_SUBPIXEL_BITS);
+        V->InvW = 1.0f / V->P.W;
+        V->FX = RasterRound((V->P.X * V->InvW + 1.0f) * (0.5f * SubpixelScale * f32(FB->Width)));
+        V->FY = RasterRound((V->P.Y * V->InvW + 1.0f) * (0.5f * SubpixelScale * f32(FB->Height)));
+        V->Z = V->P.Z * V->InvW * 0.5f + 0.5f;
+    }
+    
+    // vertices must be projected, Indices is the source triangle for flat shading
+    inline void
+        SetupTriangle(raster_context *Context, raster_thread *Thread,
+                      raster_vertex *V0, raster_vertex *V1, raster_vertex *V2,
+                      raster_draw *Draw, u32 *Indices, v3 ToLight)
+    {
+        framebuffer *FB = &Context->Framebuffer;
+        f32 SubpixelScale = f32(1 << CH_RASTER_SUBPIXEL_BITS);
+        
+        raster_vertex *Verts[3] = {V0, V1, V2};
+        i32 FX[3] = {V0->FX, V1->FX, V2->FX};
+        i32 FY[3] = {V0->FY, V1->FY, V2->FY};
+        
+        i64 Area = i64(FX[1] - FX[0]) * (FY[2] - FY[0]) - i64(FX[2] - FX[0]) * (FY[1] - FY[0]);
+        if (Area == 0) return;
+        if (Context->CullMode == RasterCull_CCW && Area > 0) return;
+        if (Context->CullMode == RasterCull_CW && Area < 0) return;
+        
+        if (Area < 0)
+        {
+            // make it counter-clockwise so every edge function is positive inside
+            RasterSwap(&FX[1], &FX[2]);
+            RasterSwap(&FY[1], &FY[2]);
+            RasterSwap(&Verts[1], &Verts[2]);
+            Area = -Area;
+        }
+        
+        // only pixels whose centers can be covered, this drops most subpixel triangles right here
+        raster_triangle Tri = {};
+        int Half = 1 << (CH_RASTER_SUBPIXEL_BITS - 1);
+        int RoundUp = (1 << CH_RASTER_SUBPIXEL_BITS) - 1;
+        Tri.MinX = (RasterMin(FX) - Half + RoundUp) >> CH_RASTER_SUBPIXEL_BITS;
+        Tri.MinY = (RasterMin(FY) - Half + RoundUp) >> CH_RASTER_SUBPIXEL_BITS;
+        Tri.MaxX = (RasterMax(FX) - Half) >> CH_RASTER_SUBPIXEL_BITS;
+        Tri.MaxY = (RasterMax(FY) - Half) >> CH_RASTER_SUBPIXEL_BITS;
+        if (Tri.MinX < 0) Tri.MinX = 0;
+        if (Tri.MinY < 0) Tri.MinY = 0;
+        if (Tri.MaxX > FB->Width - 1) Tri.MaxX = FB->Width - 1;
+        if (Tri.MaxY > FB->Height - 1) Tri.MaxY = FB->Height - 1;
+        if (Tri.MinX > Tri.MaxX || Tri.MinY > Tri.MaxY) return;
+        
+        for (int I = 0; I < 3; ++I)
+        {
+            int A = (I + 1) % 3;
+            int B = (I + 2) % 3;
+            Tri.EdgeA[I] = FY[A] - FY[B];
+            Tri.EdgeB[I] = FX[B] - FX[A];
+            Tri.EdgeC[I] = -(i64(Tri.EdgeA[I]) * FX[A] + i64(Tri.EdgeB[I]) * FY[A]);
+            
+            //NOTE(chen): a shared edge has opposite normals in its two triangles
+            //            and the integer edge functions are exact negations of
+            //            each other, so exactly one of them owns a pixel on it
+            bool OwnsEdge = Tri.EdgeA[I] > 0 || (Tri.EdgeA[I] == 0 && Tri.EdgeB[I] > 0);
+            if (!OwnsEdge) Tri.EdgeC[I] -= 1;
+        }
+        
+        f32 X[3], Y[3], Z[3], InvW[3], Shade[3];
+        for (int I = 0; I < 3; ++I)
+        {
+            X[I] = f32(FX[I]) / SubpixelScale;
+            Y[I] = f32(FY[I]) / SubpixelScale;
+            Z[I] = Verts[I]->Z;
+            InvW[I] = Verts[I]->InvW;
+            Shade[I] = Verts[I]->Shade * InvW[I];
+        }
+        
+        //NOTE(chen): planes are anchored at vertex 0 instead of the screen origin,
+        //            otherwise the constant term cancels catastrophically for
+        //            small triangles far from the origin
+        f32 InvArea = SubpixelScale * SubpixelScale / f32(Area);
+        f32 DX1 = X[1] - X[0], DY1 = Y[1] - Y[0];
+        f32 DX2 = X[2] - X[0], DY2 = Y[2] - Y[0];
+        Tri.OriginX = X[0];
+        Tri.OriginY = Y[0];
+#define CH_RASTER_PLANE(OutA, OutB, OutC, Value) \
+        OutA = ((Value[1] - Value[0]) * DY2 - (Value[2] - Value[0]) * DY1) * InvArea; \
+        OutB = ((Value[2] - Value[0]) * DX1 - (Value[1] - Value[0]) * DX2) * InvArea; \
+        OutC = Value[0];
+        
+        CH_RASTER_PLANE(Tri.ZA, Tri.ZB, Tri.ZC, Z);
+        if (!Draw->Mesh->nb)
+        {
+            //NOTE(chen): no normals, light the face two-sided since
+            //            winding conventions differ between assets
+            v3 *Positions = (v3 *)Draw->Mesh->vb;
+            v3 P0 = ApplyMat4(Positions[Indices[0]], Draw->Transform);
+            v3 P1 = ApplyMat4(Positions[Indices[1]], Draw->Transform);
+            v3 P2 = ApplyMat4(Positions[Indices[2]], Draw->Transform);
+            v3 N = Normalize(Cross(P1 - P0, P2 - P0));
+            Tri.InvWC = 1.0f;
+            Tri.ShadeC = Context->Ambient + (1.0f - Context->Ambient) * Abs(Dot(N, ToLight));
+        }
+        else
+        {
+            CH_RASTER_PLANE(Tri.InvWA, Tri.InvWB, Tri.InvWC, InvW);
+            CH_RASTER_PLANE(Tri.ShadeA, Tri.ShadeB, Tri.ShadeC, Shade);
+        }
+#undef CH_RASTER_PLANE
+        Tri.Color = Draw->Color;
+        
+        u32 TriIndex = Thread->Triangles? u32(ChBufCount(Thread->Triangles)): 0;
+        ChBufPush(Thread->Triangles, Tri);
+        
+        int TileX0 = Tri.MinX / CH_RASTER_TILE_SIZE;
+        int TileY0 = Tri.MinY / CH_RASTER_TILE_SIZE;
+        int TileX1 = Tri.MaxX / CH_RASTER_TILE_SIZE;
+        int TileY1 = Tri.MaxY / CH_RASTER_TILE_SIZE;
+        for (int TileY = TileY0; TileY <= TileY1; ++TileY)
+        {
+            for (int TileX = TileX0; TileX <= TileX1; ++TileX)
+            {
+                int TileI = TileY * Context->TileCountX + TileX;
+                u32 *Bin = Thread->Bins[TileI];
+                ChBufPush(Bin, TriIndex);
+                Thread->Bins[TileI] = Bin;
+            }
+        }
+    }
+    
+    inline bool
+        IsOutsideFrustum(v4 A, v4 B, v4 C)
+    {
+        if (A.X > A.W && B.X > B.W && C.X > C.W) return true;
+        if (A.X < -A.W && B.X < -B.W && C.X < -C.W) return true;
+        if (A.Y > A.W && B.Y > B.W && C.Y > C.W) return true;
+        if (A.Y < -A.W && B.Y < -B.W && C.Y < -C.W) return true;
+        if (A.Z > A.W && B.Z > B.W && C.Z > C.W) return true;
+        return false;
+    }
+    
+    //
+    //
+    // rasterization
+    
+    inline u32
+        ShadeColor(u32 Color, f32 Shade)
+    {
+        Shade = Clamp(Shade, 0.0f, 1.0f);
+        u32 R = u32(f32((Color >> 16) & 0xFF) * Shade);
+        u32 G = u32(f32((Color >> 8) & 0xFF) * Shade);
+        u32 B = u32(f32(Color & 0xFF) * Shade);
+        return (Color & 0xFF000000) | (R << 16) | (G << 8) | B;
+    }
+    
+    // pixel center of pixel X in subpixel units
+    inline i64
+        SubpixelCenter(int X)
+    {
+        return (i64(X) << CH_RASTER_SUBPIXEL_BITS) + (1 << (CH_RASTER_SUBPIXEL_BITS - 1));
+    }
+    
+    inline i64
+        EvalEdge(raster_triangle *Tri, int I, int X, int Y)
+    {
+        return Tri->EdgeA[I] * SubpixelCenter(X) + Tri->EdgeB[I] * SubpixelCenter(Y) + Tri->EdgeC[I];
+    }
+    
+    // reference path, also used for blocks that hang off the framebuffer
+    inline void
+        RasterBlockScalar(framebuffer *FB, raster_triangle *Tri,
+                          int X0, int Y0, int X1, int Y1)
+    {
+        for (int Y = Y0; Y <= Y1; ++Y)
+        {
+            f32 DY = f32(Y) + 0.5f - Tri->OriginY;
+            for (int X = X0; X <= X1; ++X)
+            {
+                if ((EvalEdge(Tri, 0, X, Y) | EvalEdge(Tri, 1, X, Y) | EvalEdge(Tri, 2, X, Y)) < 0) continue;
+                
+                f32 DX = f32(X) + 0.5f - Tri->OriginX;
+                f32 Z = Tri->ZA * DX + (Tri->ZB * DY + Tri->ZC);
+                f32 *Depth = FB->Depth + Y * FB->Width + X;
+                if (!(Z < *Depth)) continue;
+                
+                f32 InvW = Tri->InvWA * DX + (Tri->InvWB * DY + Tri->InvWC);
+                f32 Shade = (Tri->ShadeA * DX + (Tri->ShadeB * DY + Tri->ShadeC)) / InvW;
+                *Depth = Z;
+                FB->Color[Y * FB->Width + X] = ShadeColor(Tri->Color, Shade);
+            }
+        }
+    }
+    
+#if CH_SSE2
+    // the 8x8 block at BX must be inside the framebuffer, only its X0..X1, Y0..Y1
+    // part is walked, 4 pixels per step. Edges set in SkipEdges cover the
+    // whole block, the others cross it so their values fit in 32 bits
+    inline void
+        RasterBlockSSE2(framebuffer *FB, raster_triangle *Tri, int BX,
+                        int X0, int Y0, int X1, int Y1, u32 SkipEdges)
+    {
+        int QuadX0 = BX + ((X0 - BX) & ~3);
+        int Step = 1 << CH_RASTER_SUBPIXEL_BITS;
+        
+        __m128i EdgeRow[3], EdgeStepX[3], EdgeStepY[3];
+        for (int I = 0; I < 3; ++I)
+        {
+            if (SkipEdges & (1 << I))
+            {
+                EdgeRow[I] = EdgeStepX[I] = EdgeStepY[I] = _mm_setzero_si128();
+                continue;
+            }
+            i32 E = i32(EvalEdge(Tri, I, QuadX0, Y0));
+            i32 A = Tri->EdgeA[I] * Step;
+            EdgeRow[I] = _mm_add_epi32(_mm_set1_epi32(E), _mm_setr_epi32(0, A, 2 * A, 3 * A));
+            EdgeStepX[I] = _mm_set1_epi32(4 * A);
+            EdgeStepY[I] = _mm_set1_epi32(Tri->EdgeB[I] * Step);
+        }
+        
+        __m128 Zero = _mm_setzero_ps();
+        __m128 One = _mm_set1_ps(1.0f);
+        __m128 LaneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128 OriginX = _mm_set1_ps(Tri->OriginX);
+        __m128 ZA = _mm_set1_ps(Tri->ZA);
+        __m128 InvWA = _mm_set1_ps(Tri->InvWA);
+        __m128 ShadeA = _mm_set1_ps(Tri->ShadeA);
+        
+        __m128 R = _mm_set1_ps(f32((Tri->Color >> 16) & 0xFF));
+        __m128 G = _mm_set1_ps(f32((Tri->Color >> 8) & 0xFF));
+        __m128 B = _mm_set1_ps(f32(Tri->Color & 0xFF));
+        __m128i Alpha = _mm_set1_epi32(int(Tri->Color & 0xFF000000));
+        
+        for (int Y = Y0; Y <= Y1; ++Y)
+        {
+            f32 DY = f32(Y) + 0.5f - Tri->OriginY;
+            __m128 ZRow = _mm_set1_ps(Tri->ZB * DY + Tri->ZC);
+            __m128 InvWRow = _mm_set1_ps(Tri->InvWB * DY + Tri->InvWC);
+            __m128 ShadeRow = _mm_set1_ps(Tri->ShadeB * DY + Tri->ShadeC);
+            
+            __m128i E0 = EdgeRow[0], E1 = EdgeRow[1], E2 = EdgeRow[2];
+            for (int X = QuadX0; X <= X1; X += 4)
+            {
+                // a pixel is covered when no edge function is negative
+                __m128i Signs = _mm_srai_epi32(_mm_or_si128(_mm_or_si128(E0, E1), E2), 31);
+                __m128 Mask = _mm_castsi128_ps(_mm_xor_si128(Signs, _mm_set1_epi32(-1)));
+                E0 = _mm_add_epi32(E0, EdgeStepX[0]);
+                E1 = _mm_add_epi32(E1, EdgeStepX[1]);
+                E2 = _mm_add_epi32(E2, EdgeStepX[2]);
+                if (!_mm_movemask_ps(Mask)) continue;
+                
+                __m128 DX = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(f32(X)), LaneOffsets), OriginX);
+                f32 *DepthPtr = FB->Depth + Y * FB->Width + X;
+                __m128 Z = _mm_add_ps(_mm_mul_ps(ZA, DX), ZRow);
+                __m128 OldZ = _mm_loadu_ps(DepthPtr);
+                Mask = _mm_and_ps(Mask, _mm_cmplt_ps(Z, OldZ));
+                if (!_mm_movemask_ps(Mask)) continue;
+                
+                __m128 InvW = _mm_add_ps(_mm_mul_ps(InvWA, DX), InvWRow);
+                __m128 Shade = _mm_div_ps(_mm_add_ps(_mm_mul_ps(ShadeA, DX), ShadeRow), InvW);
+                Shade = _mm_min_ps(_mm_max_ps(Shade, Zero), One);
+                
+                __m128i Color = _mm_or_si128(Alpha, _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(R, Shade)), 16));
+                Color = _mm_or_si128(Color, _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(G, Shade)), 8));
+                Color = _mm_or_si128(Color, _mm_cvttps_epi32(_mm_mul_ps(B, Shade)));
+                
+                __m128i *ColorPtr = (__m128i *)(FB->Color + Y * FB->Width + X);
+                __m128i OldColor = _mm_loadu_si128(ColorPtr);
+                __m128i IMask = _mm_castps_si128(Mask);
+                _mm_storeu_ps(DepthPtr, _mm_or_ps(_mm_and_ps(Mask, Z), _mm_andnot_ps(Mask, OldZ)));
+                _mm_storeu_si128(ColorPtr, _mm_or_si128(_mm_and_si128(IMask, Color),
+                                                        _mm_andnot_si128(IMask, OldColor)));
+            }
+            
+            EdgeRow[0] = _mm_add_epi32(EdgeRow[0], EdgeStepY[0]);
+            EdgeRow[1] = _mm_add_epi32(EdgeRow[1], EdgeStepY[1]);
+            EdgeRow[2] = _mm_add_epi32(EdgeRow[2], EdgeStepY[2]);
+        }
+    }
+#endif
+    
+    inline void
+        RasterTriangleInTile(framebuffer *FB, raster_triangle *Tri, int TileX, int TileY)
+    {
+        int TileMinX = TileX * CH_RASTER_TILE_SIZE;
+        int TileMinY = TileY * CH_RASTER_TILE_SIZE;
+        int MinX = Tri->MinX > TileMinX? Tri->MinX: TileMinX;
+        int MinY = Tri->MinY > TileMinY? Tri->MinY: TileMinY;
+        int MaxX = Tri->MaxX < TileMinX + CH_RASTER_TILE_SIZE - 1? Tri->MaxX: TileMinX + CH_RASTER_TILE_SIZE - 1;
+        int MaxY = Tri->MaxY < TileMinY + CH_RASTER_TILE_SIZE - 1? Tri->MaxY: TileMinY + CH_RASTER_TILE_SIZE - 1;
+        
+        // blocks are aligned to the tile grid
+        int BlockX0 = MinX & ~(CH_RASTER_BLOCK_SIZE - 1);
+        int BlockY0 = MinY & ~(CH_RASTER_BLOCK_SIZE - 1);
+        i64 BlockExtent = i64(CH_RASTER_BLOCK_SIZE - 1) << CH_RASTER_SUBPIXEL_BITS;
+        for (int BY = BlockY0; BY <= MaxY; BY += CH_RASTER_BLOCK_SIZE)
+        {
+            for (int BX = BlockX0; BX <= MaxX; BX += CH_RASTER_BLOCK_SIZE)
+            {
+                // edge functions at the block corners decide rejection and full coverage
+                bool Rejected = false;
+                u32 FullEdges = 0;
+                for (int I = 0; I < 3; ++I)
+                {
+                    i64 E = EvalEdge(Tri, I, BX, BY);
+                    i64 DX = Tri->EdgeA[I] * BlockExtent;
+                    i64 DY = Tri->EdgeB[I] * BlockExtent;
+                    i64 EMax = E + (DX > 0? DX: 0) + (DY > 0? DY: 0);
+                    i64 EMin = E + (DX < 0? DX: 0) + (DY < 0? DY: 0);
+                    if (EMax < 0) Rejected = true;
+                    if (EMin >= 0) FullEdges |= 1 << I;
+                }
+                if (Rejected) continue;
+                
+                int X0 = BX > MinX? BX: MinX;
+                int Y0 = BY > MinY? BY: MinY;
+                int X1 = BX + CH_RASTER_BLOCK_SIZE - 1 < MaxX? BX + CH_RASTER_BLOCK_SIZE - 1: MaxX;
+                int Y1 = BY + CH_RASTER_BLOCK_SIZE - 1 < MaxY? BY + CH_RASTER_BLOCK_SIZE - 1: MaxY;
+#if CH_SSE2
+                if (BX + CH_RASTER_BLOCK_SIZE <= FB->Width)
+                {
+                    RasterBlockSSE2(FB, Tri, BX, X0, Y0, X1, Y1, FullEdges);
+                    continue;
+                }
+#endif
+                RasterBlockScalar(FB, Tri, X0, Y0, X1, Y1);
+            }
+        }
+    }
+    
+    //
+    //
+    // render
+    
+    inline void
+        Render(raster_context *Context, raster_draw *Draws, int DrawCount,
+               mat4 ViewProj, v3 LightDir)
+    {
+        int ThreadCount = Context->ThreadCount;
+        int TileCount = Context->TileCountX * Context->TileCountY;
+        
+        // flat offsets of every draw's vertices and triangles
+        int VertexCount = 0;
+        int TriangleCount = 0;
+        int *VertexOffsets = (int *)malloc(sizeof(int) * (DrawCount + 1));
+        int *TriangleOffsets = (int *)malloc(sizeof(int) * (DrawCount + 1));
+        for (int DrawI = 0; DrawI < DrawCount; ++DrawI)
+        {
+            VertexOffsets[DrawI] = VertexCount;
+            TriangleOffsets[DrawI] = TriangleCount;
+            VertexCount += Draws[DrawI].Mesh->vertex_count;
+            TriangleCount += Draws[DrawI].Mesh->ib_count / 3;
+        }
+        VertexOffsets[DrawCount] = VertexCount;
+        TriangleOffsets[DrawCount] = TriangleCount;
+        
+        if (VertexCount > Context->VertexCap)
+        {
+            free(Context->Vertices);
+            Context->Vertices = (raster_vertex *)malloc(sizeof(raster_vertex) * VertexCount);
+            Context->VertexCap = VertexCount;
+        }
+        
+        v3 ToLight = -Normalize(LightDir);
+        f32 Ambient = Context->Ambient;
+        
+        RasterParallel(ThreadCount, [&](int ThreadI)
+                       {
+                           for (int DrawI = 0; DrawI < DrawCount; ++DrawI)
+                           {
+                               raster_draw *Draw = Draws + DrawI;
+                               ch_obj::Mesh *Mesh = Draw->Mesh;
+                               mat4 MVP = Draw->Transform * ViewProj;
+                               mat3 NormalMat = Mat3(Draw->Transform);
+                
+                               int Begin = int(i64(Mesh->vertex_count) * ThreadI / ThreadCount);
+                               int End = int(i64(Mesh->vertex_count) * (ThreadI + 1) / ThreadCount);
+                               raster_vertex *Out = Context->Vertices + VertexOffsets[DrawI];
+                               v3 *Positions = (v3 *)Mesh->vb;
+                               v3 *Normals = (v3 *)Mesh->nb;
+                               for (int VI = Begin; VI < End; ++VI)
+                               {
+                                   Out[VI].P = V4(Positions[VI]) * MVP;
+                                   Out[VI].Shade = -1.0f;
+                                   if (Normals)
+                                   {
+                                       v3 N = Normalize(Normals[VI] * NormalMat);
+                                       Out[VI].Shade = Ambient + (1.0f - Ambient) * Max(0.0f, Dot(N, ToLight));
+                                   }
+                                   if (IsInsideGuardBand(Out[VI].P))
+                                   {
+                                       ProjectVertex(Out + VI, &Context->Framebuffer);
+                                   }
+                               }
+                           }
+                       });
+        
+        RasterParallel(ThreadCount, [&](int ThreadI)
+                       {
+                           raster_thread *Thread = Context->Threads + ThreadI;
+                           if (Thread->Triangles) ChBufCount(Thread->Triangles) = 0;
+                           for (int TileI = 0; TileI < TileCount; ++TileI)
+                           {
+                               if (Thread->Bins[TileI]) ChBufCount(Thread->Bins[TileI]) = 0;
+                           }
+            
+                           int Begin = int(i64(TriangleCount) * ThreadI / ThreadCount);
+                           int End = int(i64(TriangleCount) * (ThreadI + 1) / ThreadCount);
+                           int DrawI = 0;
+                           while (TriangleOffsets[DrawI + 1] <= Begin && DrawI < DrawCount) DrawI += 1;
+            
+                           for (int TriI = Begin; TriI < End; ++TriI)
+                           {
+                               while (TriangleOffsets[DrawI + 1] <= TriI) DrawI += 1;
+                
+                               raster_draw *Draw = Draws + DrawI;
+                               ch_obj::Mesh *Mesh = Draw->Mesh;
+                               raster_vertex *Verts = Context->Vertices + VertexOffsets[DrawI];
+                               u32 *Indices = Mesh->ib + 3 * (TriI - TriangleOffsets[DrawI]);
+                
+                               raster_vertex *V0 = Verts + Indices[0];
+                               raster_vertex *V1 = Verts + Indices[1];
+                               raster_vertex *V2 = Verts + Indices[2];
+                               if (IsOutsideFrustum(V0->P, V1->P, V2->P)) continue;
+                
+                               if (IsInsideGuardBand(V0->P) && IsInsideGuardBand(V1->P) && IsInsideGuardBand(V2->P))
+                               {
+                                   SetupTriangle(Context, Thread, V0, V1, V2, Draw, Indices, ToLight);
+                                   continue;
+                               }
+                
+                               raster_vertex In[3] = {*V0, *V1, *V2};
+                               raster_vertex Clipped[8];
+                               int ClippedCount = ClipTriangle(In, Clipped);
+                               for (int I = 0; I < ClippedCount; ++I)
+                               {
+                                   ProjectVertex(Clipped + I, &Context->Framebuffer);
+                               }
+                               for (int I = 2; I < ClippedCount; ++I)
+                               {
+                                   SetupTriangle(Context, Thread, Clipped, Clipped + I - 1, Clipped + I,
+                                                 Draw, Indices, ToLight);
+                               }
+                           }
+                       });
+        
+        std::atomic<int> NextTile(0);
+        RasterParallel(ThreadCount, [&](int)
+                       {
+                           for (;;)
+                           {
+                               int TileI = NextTile.fetch_add(1);
+                               if (TileI >= TileCount) break;
+                
+                               int TileX = TileI % Context->TileCountX;
+                               int TileY = TileI / Context->TileCountX;
+                               for (int ThreadI = 0; ThreadI < ThreadCount; ++ThreadI)
+                               {
+                                   raster_thread *Thread = Context->Threads + ThreadI;
+                                   u32 *Bin = Thread->Bins[TileI];
+                                   if (!Bin) continue;
+                    
+                                   for (u64 I = 0; I < ChBufCount(Bin); ++I)
+                                   {
+                                       RasterTriangleInTile(&Context->Framebuffer, Thread->Triangles + Bin[I],
+                                                            TileX, TileY);
+                                   }
+                               }
+                           }
+                       });
+        
+        Context->Stats.SubmittedTriangles = u64(TriangleCount);
+        Context->Stats.BinnedTriangles = 0;
+        for (int ThreadI = 0; ThreadI < ThreadCount; ++ThreadI)
+        {
+            raster_thread *Thread = Context->Threads + ThreadI;
+            Context->Stats.BinnedTriangles += Thread->Triangles? ChBufCount(Thread->Triangles): 0;
+        }
+        
+        free(VertexOffsets);
+        free(TriangleOffsets);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+
+/*
+NOTE: compile time and runtime SIMD detection shared by the ch_* headers.
+
+Every SIMD path in ch-lib is guarded by one of the CH_<ISA> macros below and
+always has a scalar fallback. Define CH_NO_SIMD before including any ch_*
+header to force the scalar paths (useful for testing them).
+
+MSVC doesn't define __SSSE3__/__SSE4_1__/__F16C__, /arch:AVX and up imply them.
+
+Runtime:
+
+The macros say what the compiler may use, GetSupportedISA says what the CPU (and
+the OS, for the AVX register state) can run. A build made for a higher ISA than
+the machine has dies on the first such instruction, so builds per ISA pick
+between each other at startup (see test/ch_dispatch.cpp). The ISAs are levels:
+
+SSE2    every x86-64 CPU
+AVX2    AVX2, FMA, F16C, BMI1/2, LZCNT, MOVBE (x86-64-v3)
+AVX512  AVX-512 F/BW/CD/DQ/VL on top (x86-64-v4)
+*/
+
+#if !defined(CH_NO_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || (defined(_MSC_VER) && defined(__AVX__))
+#define CH_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && defined(__AVX__))
+#define CH_SSE41 1
+#include <smmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define CH_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) && defined(__AVX512VL__)
+#define CH_AVX512 1
+#include <immintrin.h>
+#endif
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define CH_F16C 1
+#include <immintrin.h>
+#endif
+
+#endif
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CH_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace ch
+{
+    enum simd_isa
+    {
+        SIMDISA_None, // scalar only, or not x86
+        SIMDISA_SSE2,
+        SIMDISA_AVX2,
+        SIMDISA_AVX512,
+    };
+    
+    inline const char *
+        GetISAName(simd_isa ISA)
+    {
+        static const char *Names[] = {"none", "sse2", "avx2", "avx512"};
+        return Names[ISA];
+    }
+    
+    // what this translation unit was compiled for
+    inline simd_isa
+        GetCompiledISA()
+    {
+#if defined(CH_AVX512)
+        return SIMDISA_AVX512;
+#elif defined(CH_AVX2)
+        return SIMDISA_AVX2;
+#elif defined(CH_SSE2)
+        return SIMDISA_SSE2;
+#else
+        return SIMDISA_None;
+#endif
+    }
+    
+#if CH_X86
+    inline void
+        ReadCPUID(uint32_t Leaf, uint32_t Subleaf, uint32_t *Registers)
+    {
+#ifdef _MSC_VER
+        int Result[4];
+        __cpuidex(Result, (int)Leaf, (int)Subleaf);
+        for (int I = 0; I < 4; ++I) Registers[I] = (uint32_t)Result[I];
+#else
+        __cpuid_count(Leaf, Subleaf, Registers[0], Registers[1], Registers[2], Registers[3]);
+#endif
+    }
+    
+    // XCR0, which register state the OS saves on context switches
+    inline uint64_t
+        ReadXCR0()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        uint32_t Low, High;
+        __asm__ __volatile__("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+        return ((uint64_t)High << 32) | Low;
+#endif
+    }
+#endif
+    
+    // the highest level this machine runs, queried once
+    inline simd_isa
+        GetSupportedISA()
+    {
+        static const simd_isa Supported = []()
+        {
+            simd_isa Result = SIMDISA_None;
+#if CH_X86
+            uint32_t Leaf0[4], Leaf1[4], Leaf7[4] = {}, Extended[4] = {};
+            ReadCPUID(0, 0, Leaf0);
+            ReadCPUID(1, 0, Leaf1);
+            if (Leaf0[0] >= 7) ReadCPUID(7, 0, Leaf7);
+            ReadCPUID(0x80000000u, 0, Extended);
+            uint32_t ExtendedECX = 0;
+            if (Extended[0] >= 0x80000001u)
+            {
+                uint32_t Leaf81[4];
+                ReadCPUID(0x80000001u, 0, Leaf81);
+                ExtendedECX = Leaf81[2];
+            }
+            
+            uint32_t ECX1 = Leaf1[2], EDX1 = Leaf1[3], EBX7 = Leaf7[1];
+            bool SSE2 = (EDX1 >> 26) & 1;
+            bool OSXSAVE = (ECX1 >> 27) & 1;
+            uint64_t XCR0 = OSXSAVE? ReadXCR0(): 0;
+            bool OSSavesYMM = (XCR0 & 0x6) == 0x6;
+            bool OSSavesZMM = (XCR0 & 0xE6) == 0xE6;
+            
+            bool AVX2 = OSSavesYMM &&
+                ((ECX1 >> 28) & 1) &&  // AVX
+                ((ECX1 >> 12) & 1) &&  // FMA
+                ((ECX1 >> 29) & 1) &&  // F16C
+                ((ECX1 >> 22) & 1) &&  // MOVBE
+                ((EBX7 >> 5) & 1) &&   // AVX2
+                ((EBX7 >> 3) & 1) &&   // BMI1
+                ((EBX7 >> 8) & 1) &&   // BMI2
+                ((ExtendedECX >> 5) & 1); // LZCNT
+            bool AVX512 = AVX2 && OSSavesZMM &&
+                ((EBX7 >> 16) & 1) &&  // F
+                ((EBX7 >> 17) & 1) &&  // DQ
+                ((EBX7 >> 28) & 1) &&  // CD
+                ((EBX7 >> 30) & 1) &&  // BW
+                ((EBX7 >> 31) & 1);    // VL
+            
+            if (SSE2) Result = SIMDISA_SSE2;
+            if (SSE2 && AVX2) Result = SIMDISA_AVX2;
+            if (SSE2 && AVX512) Result = SIMDISA_AVX512;
+#endif
+            return Result;
+        }();
+        return Supported;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,547 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+ch::texture_cache Cache = ch::InitTextureCache("texcache"); // creates the directory if needed
+ch::texture_file Texture = {};
+if (ch::LoadCachedTexture(&Texture, &Cache, "assets/brick.tga", ch::TextureFormat_BC7_SRGB,
+                          ch::DefaultTextureBuildOptions()))
+{
+    const ch::texture_file_header *Header = Texture.Header;
+    for (u32 LevelI = 0; LevelI < Header->LevelCount; ++LevelI)
+    {
+        const ch::texture_file_level *Level = &Header->Levels[LevelI];
+        const u8 *Rows = Texture.Data + Level->Offset; // Level->RowCount rows, Level->RowPitch apart
+        ...
+    }
+    ch::CloseTextureFile(&Texture);
+}
+
+Cache:
+
+The key is a 64-bit hash of the source file's bytes, the target format and the
+build options (filter, quality, level count) that change the output. An entry is
+one .chtex file named after the key. A hit reads and hashes the source, then maps
+the entry: no decoding, no mips and no block compression. A miss (or an entry that
+doesn't validate) decodes the source with ch_image, builds the mip chain with
+ch_imgproc, compresses it with ch_bc and writes the entry through a temporary
+file and a rename. If the cache directory can't be written, the texture that
+was built in memory is still returned.
+
+Container (.chtex, little endian):
+
+texture_file_header, padded to CH_TEXTURE_PLACEMENT_ALIGNMENT
+level 0 rows, padded to CH_TEXTURE_PLACEMENT_ALIGNMENT
+level 1 rows ...
+
+Rows are CH_TEXTURE_PITCH_ALIGNMENT bytes apart and levels start on placement
+aligned offsets. With the defaults (256, 512) that is exactly the layout D3D12's
+GetCopyableFootprints gives a mip chain, so all Header->DataSize bytes go into
+an upload buffer with one copy. BC rows are rows of 4x4 blocks. D3D wants the
+width and height of a BC texture's top level to be multiples of 4.
+
+Formats have the same values as their DXGI_FORMAT. Sources are RGBA8. The float
+formats read them as unorm, and the sRGB formats filter their mips in linear.
+*/
+
+#include "ch_bc.h"
+#include "ch_hash.h"
+#include "ch_image.h"
+#include "ch_imgproc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef CH_TEXTURE_PITCH_ALIGNMENT
+#define CH_TEXTURE_PITCH_ALIGNMENT 256
+#endif
+
+#ifndef CH_TEXTURE_PLACEMENT_ALIGNMENT
+#define CH_TEXTURE_PLACEMENT_ALIGNMENT 512
+#endif
+
+#define CH_TEXTURE_FILE_MAGIC 0x58544843 // "CHTX"
+#define CH_TEXTURE_FILE_VERSION 1
+
+namespace ch
+{
+    enum texture_format
+    {
+        TextureFormat_Unknown = 0,
+        TextureFormat_RGBA16F = 10,
+        TextureFormat_RGBA8 = 28,
+        TextureFormat_RGBA8_SRGB = 29,
+        TextureFormat_R32F = 41,
+        TextureFormat_BC1 = 71,
+        TextureFormat_BC1_SRGB = 72,
+        TextureFormat_BC3 = 77,
+        TextureFormat_BC3_SRGB = 78,
+        TextureFormat_BC4 = 80,
+        TextureFormat_BC5 = 83,
+        TextureFormat_BC7 = 98,
+        TextureFormat_BC7_SRGB = 99,
+    };
+    
+    struct texture_build_options
+    {
+        mip_filter Filter;
+        bc_quality Quality;
+        int LevelCount;  // <= 0 for the full chain
+        int ThreadCount; // <= 0 uses all hardware threads, doesn't change the output
+    };
+    
+    struct texture_file_level
+    {
+        u64 Offset; // from texture_file::Data
+        u64 Size;   // RowPitch * RowCount
+        u32 Width;
+        u32 Height;
+        u32 RowPitch;
+        u32 RowCount; // texel rows, or rows of blocks
+    };
+    
+    struct texture_file_header
+    {
+        u32 Magic;
+        u32 Version;
+        u64 Key;
+        u64 SourceHash;
+        u32 Format; // texture_format
+        u32 Width;
+        u32 Height;
+        u32 LevelCount;
+        u64 DataOffset; // from the start of the file
+        u64 DataSize;
+        texture_file_level Levels[CH_MAX_MIP_LEVELS];
+    };
+    
+    struct mapped_file
+    {
+        void *Data;
+        size_t Size;
+#ifdef _WIN32
+        HANDLE File;
+        HANDLE Mapping;
+#endif
+    };
+    
+    struct texture_file
+    {
+        const texture_file_header *Header;
+        const u8 *Data; // Header->DataSize bytes
+        mapped_file Mapping; // a cache hit is mapped...
+        void *Allocation;    // ...a fresh build lives here
+    };
+    
+    struct texture_cache
+    {
+        char Directory[512];
+        u64 Hits;
+        u64 Builds;
+        u64 WriteFailures;
+    };
+    
+    inline texture_build_options
+        DefaultTextureBuildOptions()
+    {
+        texture_build_options Options = {};
+        Options.Filter = MipFilter_Kaiser;
+        Options.Quality = BCQuality_Fast;
+        return Options;
+    }
+    
+    //
+    //
+    // keys
+    
+    // everything that changes the bytes of an entry, the thread count doesn't
+    inline u64
+        GetTextureCacheKey(u64 SourceHash, texture_format Format, texture_build_options Options)
+    {
+        u64 Fields[6] = {
+            SourceHash, u64(Format), u64(Options.Filter), u64(Options.Quality),
+            u64(Options.LevelCount > 0? Options.LevelCount: 0), CH_TEXTURE_FILE_VERSION,
+        };
+        return HashBytes64(Fields, sizeof(Fields));
+    }
+    
+    //
+    //
+    // formats and layout
+    
+    // false for formats the builder can't produce
+    inline bool
+        GetTextureFormatInfo(texture_format Format, pixel_format *MipFormat, bool *Compressed, bc_format *BCFormat)
+    {
+        *Compressed = true;
+        *BCFormat = BCFormat_BC1;
+        *MipFormat = PixelFormat_RGBA8;
+        switch (Format)
+        {
+            case TextureFormat_RGBA16F: *MipFormat = PixelFormat_RGBA16F; *Compressed = false; return true;
+            case TextureFormat_RGBA8: *Compressed = false; return true;
+            case TextureFormat_RGBA8_SRGB: *MipFormat = PixelFormat_RGBA8_SRGB; *Compressed = false; return true;
+            case TextureFormat_R32F: *MipFormat = PixelFormat_R32F; *Compressed = false; return true;
+            case TextureFormat_BC1: return true;
+            case TextureFormat_BC1_SRGB: *MipFormat = PixelFormat_RGBA8_SRGB; return true;
+            case TextureFormat_BC3: *BCFormat = BCFormat_BC3; return true;
+            case TextureFormat_BC3_SRGB: *BCFormat = BCFormat_BC3; *MipFormat = PixelFormat_RGBA8_SRGB; return true;
+            case TextureFormat_BC4: *BCFormat = BCFormat_BC4; return true;
+            case TextureFormat_BC5: *BCFormat = BCFormat_BC5; return true;
+            case TextureFormat_BC7: *BCFormat = BCFormat_BC7; return true;
+            case TextureFormat_BC7_SRGB: *BCFormat = BCFormat_BC7; *MipFormat = PixelFormat_RGBA8_SRGB; return true;
+            default: return false;
+        }
+    }
+    
+    inline u64
+        AlignTextureOffset(u64 Value, u64 Alignment)
+    {
+        return (Value + Alignment - 1) & ~(Alignment - 1);
+    }
+    
+    // fills everything but the key and source hash, returns the file size (0 for unsupported formats)
+    inline u64
+        InitTextureFileHeader(texture_file_header *Header, texture_format Format, int Width, int Height, int LevelCount)
+    {
+        pixel_format MipFormat;
+        bool Compressed;
+        bc_format BCFormat;
+        if (!GetTextureFormatInfo(Format, &MipFormat, &Compressed, &BCFormat) || Width <= 0 || Height <= 0)
+        {
+            return 0;
+        }
+        int MaxLevels = GetMipLevelCount(Width, Height);
+        if (LevelCount <= 0 || LevelCount > MaxLevels)
+        {
+            LevelCount = MaxLevels;
+        }
+        
+        memset(Header, 0, sizeof(*Header));
+        Header->Magic = CH_TEXTURE_FILE_MAGIC;
+        Header->Version = CH_TEXTURE_FILE_VERSION;
+        Header->Format = u32(Format);
+        Header->Width = u32(Width);
+        Header->Height = u32(Height);
+        Header->LevelCount = u32(LevelCount);
+        Header->DataOffset = AlignTextureOffset(sizeof(texture_file_header), CH_TEXTURE_PLACEMENT_ALIGNMENT);
+        
+        u64 Offset = 0;
+        for (int LevelI = 0; LevelI < LevelCount; ++LevelI)
+        {
+            texture_file_level *Level = &Header->Levels[LevelI];
+            Level->Width = u32(Width);
+            Level->Height = u32(Height);
+            u64 RowBytes = Compressed? GetBCRowPitch(Width, BCFormat): (u64)Width * GetPixelSize(MipFormat);
+            Level->RowPitch = u32(AlignTextureOffset(RowBytes, CH_TEXTURE_PITCH_ALIGNMENT));
+            Level->RowCount = u32(Compressed? (Height + 3) / 4: Height);
+            Level->Offset = Offset;
+            Level->Size = u64(Level->RowPitch) * Level->RowCount;
+            Offset = AlignTextureOffset(Offset + Level->Size, CH_TEXTURE_PLACEMENT_ALIGNMENT);
+            Width = Width > 1? Width / 2: 1;
+            Height = Height > 1? Height / 2: 1;
+        }
+        Header->DataSize = Offset;
+        return Header->DataOffset + Header->DataSize;
+    }
+    
+    // a header that matches Key and the layout this version would have written
+    inline bool
+        ValidateTextureFile(const void *File, size_t FileSize, u64 Key)
+    {
+        if (FileSize < sizeof(texture_file_header))
+        {
+            return false;
+        }
+        const texture_file_header *Header = (const texture_file_header *)File;
+        if (Header->Magic != CH_TEXTURE_FILE_MAGIC || Header->Version != CH_TEXTURE_FILE_VERSION ||
+            Header->Key != Key || Header->Width > 65536 || Header->Height > 65536)
+        {
+            return false;
+        }
+        
+        texture_file_header Expected;
+        u64 ExpectedSize = InitTextureFileHeader(&Expected, texture_format(Header->Format),
+                                                 int(Header->Width), int(Header->Height), int(Header->LevelCount));
+        return ExpectedSize && ExpectedSize <= FileSize && Expected.LevelCount == Header->LevelCount &&
+            Expected.DataOffset == Header->DataOffset && Expected.DataSize == Header->DataSize &&
+            memcmp(Expected.Levels, Header->Levels, sizeof(Expected.Levels)) == 0;
+    }
+    
+    //
+    //
+    // building
+    
+    // RGBA8 source to a complete .chtex file in memory (malloc'd), 0 on failure
+    inline u8 *
+        BuildTextureFile(const void *Pixels, size_t Pitch, int Width, int Height, texture_format Format,
+                         texture_build_options Options, u64 Key, u64 SourceHash, size_t *Size_Out)
+    {
+        *Size_Out = 0;
+        texture_file_header Header;
+        u64 FileSize = InitTextureFileHeader(&Header, Format, Width, Height, Options.LevelCount);
+        if (!FileSize)
+        {
+            return 0;
+        }
+        Header.Key = Key;
+        Header.SourceHash = SourceHash;
+        
+        pixel_format MipFormat;
+        bool Compressed;
+        bc_format BCFormat;
+        GetTextureFormatInfo(Format, &MipFormat, &Compressed, &BCFormat);
+        
+        // padding is zeroed so the same source always gives the same bytes
+        u8 *File = (u8 *)calloc(1, size_t(FileSize));
+        mip_chain Chain = AllocateMipChain(Width, Height, MipFormat, int(Header.LevelCount));
+        if (!File || !Chain.Allocation)
+        {
+            free(File);
+            FreeMipChain(&Chain);
+            return 0;
+        }
+        memcpy(File, &Header, sizeof(Header));
+        
+        pixel_format SourceFormat = MipFormat == PixelFormat_RGBA8_SRGB? PixelFormat_RGBA8_SRGB: PixelFormat_RGBA8;
+        ConvertImage(Chain.Levels[0].Pixels, Chain.Levels[0].Pitch, MipFormat, Pixels, Pitch, SourceFormat,
+                     Width, Height, Options.ThreadCount);
+        GenerateMips(&Chain, Options.Filter, Options.ThreadCount);
+        
+        u8 *Data = File + Header.DataOffset;
+        for (u32 LevelI = 0; LevelI < Header.LevelCount; ++LevelI)
+        {
+            const texture_file_level *Level = &Header.Levels[LevelI];
+            const image_level *Source = &Chain.Levels[LevelI];
+            if (Compressed)
+            {
+                EncodeBC(Data + Level->Offset, Level->RowPitch, Source->Pixels, Source->Pitch,
+                         Source->Width, Source->Height, BCFormat, Options.Quality, Options.ThreadCount);
+            }
+            else
+            {
+                CopyRows(Data + Level->Offset, Level->RowPitch, Source->Pixels, Source->Pitch,
+                         (size_t)Source->Width * GetPixelSize(MipFormat), Source->Height);
+            }
+        }
+        
+        FreeMipChain(&Chain);
+        *Size_Out = size_t(FileSize);
+        return File;
+    }
+    
+    //
+    //
+    // files
+    
+    inline bool
+        MapFile(mapped_file *Out, const char *Path)
+    {
+        *Out = {};
+#ifdef _WIN32
+        HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (File == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER Size;
+        if (!GetFileSizeEx(File, &Size) || Size.QuadPart == 0)
+        {
+            CloseHandle(File);
+            return false;
+        }
+        HANDLE Mapping = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+        void *Data = Mapping? MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0): 0;
+        if (!Data)
+        {
+            if (Mapping) CloseHandle(Mapping);
+            CloseHandle(File);
+            return false;
+        }
+        Out->Data = Data;
+        Out->Size = size_t(Size.QuadPart);
+        Out->File = File;
+        Out->Mapping = Mapping;
+#else
+        int File = open(Path, O_RDONLY);
+        if (File < 0)
+        {
+            return false;
+        }
+        struct stat Stat;
+        void *Data = MAP_FAILED;
+        if (fstat(File, &Stat) == 0 && Stat.st_size > 0)
+        {
+            Data = mmap(0, size_t(Stat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+        }
+        close(File); // the mapping keeps the file alive
+        if (Data == MAP_FAILED)
+        {
+            return false;
+        }
+        Out->Data = Data;
+        Out->Size = size_t(Stat.st_size);
+#endif
+        return true;
+    }
+    
+    inline void
+        UnmapFile(mapped_file *File)
+    {
+        if (File->Data)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(File->Data);
+            CloseHandle(File->Mapping);
+            CloseHandle(File->File);
+#else
+            munmap(File->Data, File->Size);
+#endif
+        }
+        *File = {};
+    }
+    
+    // maps a .chtex, false if it's missing or doesn't validate against Key
+    inline bool
+        OpenTextureFile(texture_file *Out, const char *Path, u64 Key)
+    {
+        *Out = {};
+        if (!MapFile(&Out->Mapping, Path))
+        {
+            return false;
+        }
+        if (!ValidateTextureFile(Out->Mapping.Data, Out->Mapping.Size, Key))
+        {
+            UnmapFile(&Out->Mapping);
+            return false;
+        }
+        Out->Header = (const texture_file_header *)Out->Mapping.Data;
+        Out->Data = (const u8 *)Out->Mapping.Data + Out->Header->DataOffset;
+        return true;
+    }
+    
+    inline void
+        CloseTextureFile(texture_file *File)
+    {
+        UnmapFile(&File->Mapping);
+        free(File->Allocation);
+        *File = {};
+    }
+    
+    // writes next to Path and renames, so a crash or a concurrent reader never sees half a file
+    inline bool
+        WriteFileAtomic(const char *Path, const void *Data, size_t Size)
+    {
+        char TempPath[640];
+        snprintf(TempPath, sizeof(TempPath), "%s.tmp", Path);
+        if (!WriteFileData(TempPath, Data, Size))
+        {
+            remove(TempPath);
+            return false;
+        }
+#ifdef _WIN32
+        bool Result = MoveFileExA(TempPath, Path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool Result = rename(TempPath, Path) == 0;
+#endif
+        if (!Result)
+        {
+            remove(TempPath);
+        }
+        return Result;
+    }
+    
+    //
+    //
+    // cache
+    
+    inline texture_cache
+        InitTextureCache(const char *Directory)
+    {
+        texture_cache Cache = {};
+        snprintf(Cache.Directory, sizeof(Cache.Directory), "%s", Directory);
+#ifdef _WIN32
+        _mkdir(Directory);
+#else
+        mkdir(Directory, 0755);
+#endif
+        return Cache;
+    }
+    
+    inline void
+        GetTextureCachePath(char *Out, size_t OutSize, const texture_cache *Cache, u64 Key)
+    {
+        snprintf(Out, OutSize, "%s/%016llx.chtex", Cache->Directory, (unsigned long long)Key);
+    }
+    
+    // false if the source can't be read or decoded, or the format isn't supported
+    inline bool
+        LoadCachedTexture(texture_file *Out, texture_cache *Cache, const char *SourcePath,
+                          texture_format Format, texture_build_options Options)
+    {
+        *Out = {};
+        size_t SourceSize = 0;
+        u8 *Source = ReadFileData(SourcePath, &SourceSize);
+        if (!Source)
+        {
+            return false;
+        }
+        
+        u64 SourceHash = HashBytes64(Source, SourceSize);
+        u64 Key = GetTextureCacheKey(SourceHash, Format, Options);
+        char Path[600];
+        GetTextureCachePath(Path, sizeof(Path), Cache, Key);
+        if (OpenTextureFile(Out, Path, Key))
+        {
+            ++Cache->Hits;
+            free(Source);
+            return true;
+        }
+        
+        image_info Info;
+        image Image = {};
+        if (ReadImageInfo(Source, SourceSize, &Info))
+        {
+            Image = AllocateImage(Info.Width, Info.Height);
+            if (Image.Pixels && !DecodeImage(Source, SourceSize, Image.Pixels, Image.Pitch))
+            {
+                FreeImage(&Image);
+            }
+        }
+        free(Source);
+        if (!Image.Pixels)
+        {
+            return false;
+        }
+        
+        size_t FileSize = 0;
+        u8 *File = BuildTextureFile(Image.Pixels, Image.Pitch, Image.Width, Image.Height, Format, Options,
+                                    Key, SourceHash, &FileSize);
+        FreeImage(&Image);
+        if (!File)
+        {
+            return false;
+        }
+        ++Cache->Builds;
+        if (!WriteFileAtomic(Path, File, FileSize))
+        {
+            ++Cache->WriteFailures;
+        }
+        
+        Out->Allocation = File;
+        Out->Header = (const texture_file_header *)File;
+        Out->Data = File + Out->Header->DataOffset;
+        return true;
+    }
+};
\ No newline at end of file
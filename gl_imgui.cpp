@@ -1,9 +1,18 @@
+#include "ch_gl_stream.h"
+#include "ch_gl_state.h"
+#include "ch_gl_profile.h"
+
+// bytes of vertices and indices for all the frames in flight, to begin with.
+// A frame that needs more doubles it
+#ifndef IMGUI_STREAM_BUFFER_SIZE
+#define IMGUI_STREAM_BUFFER_SIZE (CH_GL_RING_FRAMES * (2 << 20))
+#endif
+
 global_variable GLuint g_ShaderHandle;
 global_variable GLuint g_VertHandle;
 global_variable GLuint g_FragHandle;
 
-global_variable GLuint g_VboHandle;
-global_variable GLuint g_ElementsHandle;
+global_variable ch::gl_stream_buffer g_StreamBuffer; // vertices and indices, persistently mapped
 global_variable GLuint g_VaoHandle;
 
 global_variable GLint g_AttribLocationTex;
@@ -12,6 +21,33 @@ global_variable GLint g_AttribLocationPosition;
 global_variable GLint g_AttribLocationUV;
 global_variable GLint g_AttribLocationColor;
 
+// (re)creates the stream buffer and the VAO that reads from it
+internal void
+CreateImguiStream(u32 Size)
+{
+    if (g_VaoHandle)
+    {
+        // the GPU keeps what it's still reading until it's done
+        ch::DestroyStreamBuffer(&g_StreamBuffer);
+        ch::DeleteGLVertexArrays(1, &g_VaoHandle);
+    }
+    g_StreamBuffer = ch::CreateStreamBuffer(Size);
+    
+    glGenVertexArrays(1, &g_VaoHandle);
+    ch::SetGLVertexArray(g_VaoHandle);
+    ch::SetGLBuffer(GL_ARRAY_BUFFER, g_StreamBuffer.Buffer);
+    ch::SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, g_StreamBuffer.Buffer);
+    glEnableVertexAttribArray(g_AttribLocationPosition);
+    glEnableVertexAttribArray(g_AttribLocationUV);
+    glEnableVertexAttribArray(g_AttribLocationColor);
+    
+#define OFFSETOF(TYPE, ELEMENT) ((size_t)&(((TYPE *)0)->ELEMENT))
+    glVertexAttribPointer(g_AttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, pos));
+    glVertexAttribPointer(g_AttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, uv));
+    glVertexAttribPointer(g_AttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, col));
+#undef OFFSETOF
+}
+
 internal void
 RenderImgui(ImDrawData *DrawData)
 {
@@ -22,35 +58,23 @@ RenderImgui(ImDrawData *DrawData)
     if (FBWidth == 0 || FBHeight == 0)
         return;
     DrawData->ScaleClipRects(IO.DisplayFramebufferScale);
+    CH_GL_ZONE("imgui"); // GPU time of the pass, with ch_gl_profile.h initialized
     
-    // Backup GL state
-    GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-    GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-    GLint last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, &last_active_texture);
-    GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-    GLint last_element_array_buffer; glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-    GLint last_vertex_array; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
-    GLint last_blend_src; glGetIntegerv(GL_BLEND_SRC, &last_blend_src);
-    GLint last_blend_dst; glGetIntegerv(GL_BLEND_DST, &last_blend_dst);
-    GLint last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, &last_blend_equation_rgb);
-    GLint last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &last_blend_equation_alpha);
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+    // Backup GL state. Binds go through ch_gl_state.h, so this is a copy of its shadow
+    // state; whatever touched GL directly invalidated what it touched where it did
+    ch::gl_state LastState = ch::SaveGLState();
     
     // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_SCISSOR_TEST);
-    glActiveTexture(GL_TEXTURE0);
+    ch::SetGLEnabled(GL_BLEND, true);
+    ch::SetGLBlendEquation(GL_FUNC_ADD);
+    ch::SetGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    ch::SetGLEnabled(GL_CULL_FACE, false);
+    ch::SetGLEnabled(GL_DEPTH_TEST, false);
+    ch::SetGLEnabled(GL_SCISSOR_TEST, true);
+    ch::SetGLActiveTexture(GL_TEXTURE0);
     
     // Setup viewport, orthographic projection matrix
-    glViewport(0, 0, (GLsizei)FBWidth, (GLsizei)FBHeight);
+    ch::SetGLViewport(0, 0, (GLsizei)FBWidth, (GLsizei)FBHeight);
     const float ortho_projection[4][4] =
     {
         { 2.0f/IO.DisplaySize.x, 0.0f,                   0.0f, 0.0f },
@@ -58,52 +82,58 @@ RenderImgui(ImDrawData *DrawData)
         { 0.0f,                  0.0f,                  -1.0f, 0.0f },
         {-1.0f,                  1.0f,                   0.0f, 1.0f },
     };
-    glUseProgram(g_ShaderHandle);
+    ch::SetGLProgram(g_ShaderHandle);
     glUniform1i(g_AttribLocationTex, 0);
     glUniformMatrix4fv(g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
-    glBindVertexArray(g_VaoHandle);
+    
+    // every list's vertices and indices, and the worst case of aligning each,
+    // have to fit in the frame's region, or the stream grows before it begins
+    u64 FrameSize = (u64)DrawData->TotalVtxCount * sizeof(ImDrawVert) + (u64)DrawData->TotalIdxCount * sizeof(ImDrawIdx) +
+        (u64)DrawData->CmdListsCount * (sizeof(ImDrawVert) + sizeof(ImDrawIdx));
+    if (FrameSize > g_StreamBuffer.RegionSize)
+    {
+        u64 Size = g_StreamBuffer.Size;
+        while (Size / CH_GL_RING_FRAMES < FrameSize + g_StreamBuffer.Alignment) Size *= 2;
+        CreateImguiStream((u32)Size);
+    }
+    ch::SetGLVertexArray(g_VaoHandle);
+    ch::BeginStreamFrame(&g_StreamBuffer);
     
     for (int n = 0; n < DrawData->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = DrawData->CmdLists[n];
-        const ImDrawIdx* idx_buffer_offset = 0;
         
-        glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.size() * sizeof(ImDrawVert), (GLvoid*)&cmd_list->VtxBuffer.front(), GL_STREAM_DRAW);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx), (GLvoid*)&cmd_list->IdxBuffer.front(), GL_STREAM_DRAW);
+        // written into this frame's region of the stream buffer, no reallocation in the driver
+        ch::gl_stream_allocation Vertices = ch::WriteStream(&g_StreamBuffer, &cmd_list->VtxBuffer.front(), (u32)(cmd_list->VtxBuffer.size() * sizeof(ImDrawVert)), sizeof(ImDrawVert));
+        ch::gl_stream_allocation Indices = ch::WriteStream(&g_StreamBuffer, &cmd_list->IdxBuffer.front(), (u32)(cmd_list->IdxBuffer.size() * sizeof(ImDrawIdx)), sizeof(ImDrawIdx));
+        assert(Vertices.Data && Indices.Data); // the region was grown to the frame
+        if (!Vertices.Data || !Indices.Data) continue;
+        const ImDrawIdx* idx_buffer_offset = (const ImDrawIdx *)(intptr_t)Indices.Offset;
+        GLint BaseVertex = (GLint)(Vertices.Offset / sizeof(ImDrawVert));
         
         for (const ImDrawCmd* pcmd = cmd_list->CmdBuffer.begin(); pcmd != cmd_list->CmdBuffer.end(); pcmd++)
         {
             if (pcmd->UserCallback)
             {
                 pcmd->UserCallback(cmd_list, pcmd);
+                
+                // the callback may have called GL itself, nothing is known of what it
+                // touched. The restore sets everything back and knows it again
+                ch::InvalidateGLState();
             }
             else
             {
-                glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
-                glScissor((int)pcmd->ClipRect.x, (int)(FBHeight - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-                glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset);
+                ch::SetGLTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
+                ch::SetGLScissor((int)pcmd->ClipRect.x, (int)(FBHeight - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
+                glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset, BaseVertex);
             }
             idx_buffer_offset += pcmd->ElemCount;
         }
     }
+    ch::EndStreamFrame(&g_StreamBuffer);
     
-    // Restore modified GL state
-    glUseProgram(last_program);
-    glActiveTexture(last_active_texture);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-    glBindVertexArray(last_vertex_array);
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFunc(last_blend_src, last_blend_dst);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
+    // Restore modified GL state, only what differs reaches the driver
+    ch::RestoreGLState(&LastState);
 }
 
 internal void
@@ -116,7 +146,7 @@ InitImgui()
     // Display size, render callback, and fonts
     
     GLint Viewport[4];
-    glGetIntegerv(GL_VIEWPORT, Viewport);
+    ch::GetGLViewport(Viewport);
     
     IO.DisplaySize.x = (f32)Viewport[2];
     IO.DisplaySize.y = (f32)Viewport[3];
@@ -127,31 +157,27 @@ InitImgui()
     int Width, Height;
     IO.Fonts->GetTexDataAsRGBA32(&Pixels, &Width, &Height);
     
-    GLint LastTextureID = 0;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &LastTextureID);
+    GLuint LastTextureID = ch::GetGLTexture(GL_TEXTURE_2D);
     
     GLuint FontTextureID = 0;
     glGenTextures(1, &FontTextureID);
-    glBindTexture(GL_TEXTURE_2D, FontTextureID);
+    ch::SetGLTexture(GL_TEXTURE_2D, FontTextureID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, Pixels);
-    glBindTexture(GL_TEXTURE_2D, 0);
     IO.Fonts->TexID = (void *)((u64)FontTextureID);
     
-    glBindTexture(GL_TEXTURE_2D, LastTextureID);
+    ch::SetGLTexture(GL_TEXTURE_2D, LastTextureID);
     
     //
     //
     // Shader and Devices
     
     // Backup GL state
-    GLint last_texture, last_array_buffer, last_vertex_array;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
+    GLuint last_array_buffer = ch::GetGLBuffer(GL_ARRAY_BUFFER);
+    GLuint last_vertex_array = ch::GetGLVertexArray();
     
     const GLchar *vertex_shader =
         "#version 330\n"
@@ -196,26 +222,11 @@ InitImgui()
     g_AttribLocationUV = glGetAttribLocation(g_ShaderHandle, "UV");
     g_AttribLocationColor = glGetAttribLocation(g_ShaderHandle, "Color");
     
-    glGenBuffers(1, &g_VboHandle);
-    glGenBuffers(1, &g_ElementsHandle);
-    
-    glGenVertexArrays(1, &g_VaoHandle);
-    glBindVertexArray(g_VaoHandle);
-    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-    glEnableVertexAttribArray(g_AttribLocationPosition);
-    glEnableVertexAttribArray(g_AttribLocationUV);
-    glEnableVertexAttribArray(g_AttribLocationColor);
-    
-#define OFFSETOF(TYPE, ELEMENT) ((size_t)&(((TYPE *)0)->ELEMENT))
-    glVertexAttribPointer(g_AttribLocationPosition, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, pos));
-    glVertexAttribPointer(g_AttribLocationUV, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, uv));
-    glVertexAttribPointer(g_AttribLocationColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)OFFSETOF(ImDrawVert, col));
-#undef OFFSETOF
+    CreateImguiStream(IMGUI_STREAM_BUFFER_SIZE);
     
     // Restore modified GL state
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBindVertexArray(last_vertex_array);
+    ch::SetGLBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+    ch::SetGLVertexArray(last_vertex_array);
 }
 
 
@@ -26,6 +26,7 @@ typedef u8 byte;
 #define ASSERT(Value) do { if (!(Value)) *(i32 *)0 = 0; } while (0)
 
 
+#ifndef defer
 template <typename F> 
 struct FunctionWrapper 
 { 
@@ -47,6 +48,7 @@ template <typename F>
 #define DEFER_2(X, Y) DEFER_1(X, Y) 
 #define DEFER_3(Name) DEFER_2(Name, __COUNTER__)  
 #define defer(code) auto DEFER_3(_defer_) = DeferFunction([&](){code;}) 
+#endif
 
 //
 //
@@ -1248,7 +1250,8 @@ Lerp(v3 A, v3 B, f32 T)
 inline f32
 Max(v3 V)
 {
-    return Max(Max(V.X, V.Y), V.Z);
+    f32 Result = V.X > V.Y? V.X: V.Y;
+    return Result > V.Z? Result: V.Z;
 }
 
 inline v3
@@ -6318,6 +6321,10 @@ extern "C" {
 }
 #endif
 
+#ifndef _WIN32
+#define __stdcall
+#endif
+
 typedef  void __stdcall GLCULLFACE (GLenum mode);
 GLCULLFACE *glCullFace;
 typedef  void __stdcall GLFRONTFACE (GLenum mode);
@@ -6396,7 +6403,7 @@ typedef  void __stdcall GLGETFLOATV (GLenum pname, GLfloat *data);
 GLGETFLOATV *glGetFloatv;
 typedef  void __stdcall GLGETINTEGERV (GLenum pname, GLint *data);
 GLGETINTEGERV *glGetIntegerv;
-typedef  const GLubyte  __stdcall GLGETSTRING (GLenum name);
+typedef  const GLubyte * __stdcall GLGETSTRING (GLenum name);
 GLGETSTRING *glGetString;
 typedef  void __stdcall GLGETTEXIMAGE (GLenum target, GLint level, GLenum format, GLenum type, void *pixels);
 GLGETTEXIMAGE *glGetTexImage;
@@ -6516,7 +6523,7 @@ typedef  void __stdcall GLBUFFERSUBDATA (GLenum target, GLintptr offset, GLsizei
 GLBUFFERSUBDATA *glBufferSubData;
 typedef  void __stdcall GLGETBUFFERSUBDATA (GLenum target, GLintptr offset, GLsizeiptr size, void *data);
 GLGETBUFFERSUBDATA *glGetBufferSubData;
-typedef  void  __stdcall GLMAPBUFFER (GLenum target, GLenum access);
+typedef  void * __stdcall GLMAPBUFFER (GLenum target, GLenum access);
 GLMAPBUFFER *glMapBuffer;
 typedef  GLboolean __stdcall GLUNMAPBUFFER (GLenum target);
 GLUNMAPBUFFER *glUnmapBuffer;
@@ -6836,7 +6843,7 @@ typedef  void __stdcall GLCLEARBUFFERFV (GLenum buffer, GLint drawbuffer, const
 GLCLEARBUFFERFV *glClearBufferfv;
 typedef  void __stdcall GLCLEARBUFFERFI (GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil);
 GLCLEARBUFFERFI *glClearBufferfi;
-typedef  const GLubyte  __stdcall GLGETSTRINGI (GLenum name, GLuint index);
+typedef  const GLubyte * __stdcall GLGETSTRINGI (GLenum name, GLuint index);
 GLGETSTRINGI *glGetStringi;
 typedef  GLboolean __stdcall GLISRENDERBUFFER (GLuint renderbuffer);
 GLISRENDERBUFFER *glIsRenderbuffer;
@@ -6878,7 +6885,7 @@ typedef  void __stdcall GLRENDERBUFFERSTORAGEMULTISAMPLE (GLenum target, GLsizei
 GLRENDERBUFFERSTORAGEMULTISAMPLE *glRenderbufferStorageMultisample;
 typedef  void __stdcall GLFRAMEBUFFERTEXTURELAYER (GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
 GLFRAMEBUFFERTEXTURELAYER *glFramebufferTextureLayer;
-typedef  void  __stdcall GLMAPBUFFERRANGE (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef  void * __stdcall GLMAPBUFFERRANGE (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
 GLMAPBUFFERRANGE *glMapBufferRange;
 typedef  void __stdcall GLFLUSHMAPPEDBUFFERRANGE (GLenum target, GLintptr offset, GLsizeiptr length);
 GLFLUSHMAPPEDBUFFERRANGE *glFlushMappedBufferRange;
@@ -7432,9 +7439,9 @@ typedef  void __stdcall GLCLEARNAMEDBUFFERDATA (GLuint buffer, GLenum internalfo
 GLCLEARNAMEDBUFFERDATA *glClearNamedBufferData;
 typedef  void __stdcall GLCLEARNAMEDBUFFERSUBDATA (GLuint buffer, GLenum internalformat, GLintptr offset, GLsizeiptr size, GLenum format, GLenum type, const void *data);
 GLCLEARNAMEDBUFFERSUBDATA *glClearNamedBufferSubData;
-typedef  void  __stdcall GLMAPNAMEDBUFFER (GLuint buffer, GLenum access);
+typedef  void * __stdcall GLMAPNAMEDBUFFER (GLuint buffer, GLenum access);
 GLMAPNAMEDBUFFER *glMapNamedBuffer;
-typedef  void  __stdcall GLMAPNAMEDBUFFERRANGE (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef  void * __stdcall GLMAPNAMEDBUFFERRANGE (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
 GLMAPNAMEDBUFFERRANGE *glMapNamedBufferRange;
 typedef  GLboolean __stdcall GLUNMAPNAMEDBUFFER (GLuint buffer);
 GLUNMAPNAMEDBUFFER *glUnmapNamedBuffer;
@@ -7960,7 +7967,7 @@ typedef  void __stdcall GLNAMEDBUFFERDATAEXT (GLuint buffer, GLsizeiptr size, co
 GLNAMEDBUFFERDATAEXT *glNamedBufferDataEXT;
 typedef  void __stdcall GLNAMEDBUFFERSUBDATAEXT (GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data);
 GLNAMEDBUFFERSUBDATAEXT *glNamedBufferSubDataEXT;
-typedef  void  __stdcall GLMAPNAMEDBUFFEREXT (GLuint buffer, GLenum access);
+typedef  void * __stdcall GLMAPNAMEDBUFFEREXT (GLuint buffer, GLenum access);
 GLMAPNAMEDBUFFEREXT *glMapNamedBufferEXT;
 typedef  GLboolean __stdcall GLUNMAPNAMEDBUFFEREXT (GLuint buffer);
 GLUNMAPNAMEDBUFFEREXT *glUnmapNamedBufferEXT;
@@ -8184,7 +8191,7 @@ typedef  void __stdcall GLGETVERTEXARRAYINTEGERI_VEXT (GLuint vaobj, GLuint inde
 GLGETVERTEXARRAYINTEGERI_VEXT *glGetVertexArrayIntegeri_vEXT;
 typedef  void __stdcall GLGETVERTEXARRAYPOINTERI_VEXT (GLuint vaobj, GLuint index, GLenum pname, void **param);
 GLGETVERTEXARRAYPOINTERI_VEXT *glGetVertexArrayPointeri_vEXT;
-typedef  void  __stdcall GLMAPNAMEDBUFFERRANGEEXT (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef  void * __stdcall GLMAPNAMEDBUFFERRANGEEXT (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
 GLMAPNAMEDBUFFERRANGEEXT *glMapNamedBufferRangeEXT;
 typedef  void __stdcall GLFLUSHMAPPEDNAMEDBUFFERRANGEEXT (GLuint buffer, GLintptr offset, GLsizeiptr length);
 GLFLUSHMAPPEDNAMEDBUFFERRANGEEXT *glFlushMappedNamedBufferRangeEXT;
@@ -9674,16 +9681,21 @@ void LoadGLFunctions(load_function *LoadFunction) {
 //
 //@ OpenGL helper functions
 
+#include "ch_gl_state.h"
+#include "ch_gl_uniform.h"
+
+//NOTE(chen): every call builds a new VAO and quad buffer, the caller owns them. New
+//            passes should use ch_gl_post.h's DrawGLFullscreenTriangle instead, it
+//            shares one VAO, needs no vertex buffer and doesn't shade the diagonal twice
 inline GLuint
 BuildScreenVAO()
 {
     GLuint ScreenVAO = 0;
     glGenVertexArrays(1, &ScreenVAO);
-    GLuint Result = 0;
     
     GLuint QuadVBO = 0;
     glGenBuffers(1, &QuadVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, QuadVBO);
+    ch::SetGLBuffer(GL_ARRAY_BUFFER, QuadVBO);
     f32 QuadVertices[] = {
         //position          screen tex coord
         1.0f, 1.0f, 0.0f,   1.0f, 1.0f,
@@ -9694,51 +9706,52 @@ BuildScreenVAO()
         1.0f, -1.0f, 0.0f,  1.0f, 0.0f,
     };
     glBufferData(GL_ARRAY_BUFFER, ARRAY_COUNT(QuadVertices) * sizeof(f32), (GLvoid *)QuadVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     
-    glBindVertexArray(ScreenVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, QuadVBO);
+    ch::SetGLVertexArray(ScreenVAO);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(f32), 0);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(f32), (GLvoid *)(3 * sizeof(f32)));
     glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ch::SetGLVertexArray(0);
+    ch::SetGLBuffer(GL_ARRAY_BUFFER, 0);
     
     return ScreenVAO;
 }
+//NOTE(chen): these ask the driver for the location on every upload, so they stay
+//            right across relinks and reused program names. Per-draw uniforms
+//            are cheaper through ch_gl_uniform.h's typed gl_uniform<T> handles
 inline void 
 glUploadVec2(GLuint ShaderProgram, char *UniformIdentifier, v2 V)
 {
-    GLuint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
+    GLint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
     glUniform2fv(UniformLoc, 1, (GLfloat *)&V);
 }
 
 inline void 
 glUploadVec3(GLuint ShaderProgram, char *UniformIdentifier, v3 V)
 {
-    GLuint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
+    GLint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
     glUniform3fv(UniformLoc, 1, (GLfloat *)&V);
 }
 
 inline void
 glUploadVec3Array(GLuint ShaderProgram, char *UniformIdentifier, v3 *V, int Count)
 {
-    GLuint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
+    GLint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
     glUniform3fv(UniformLoc, Count, (GLfloat *)V);
 }
 
 inline void 
 glUploadVec4(GLuint ShaderProgram, char *UniformIdentifier, v4 V)
 {
-    GLuint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
+    GLint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
     glUniform4fv(UniformLoc, 1, (GLfloat *)&V);
 }
 
 inline void 
 glUploadFloat(GLuint ShaderProgram, char *UniformIdentifier, f32 Float)
 {
-    GLuint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
+    GLint UniformLoc = glGetUniformLocation(ShaderProgram, UniformIdentifier);
     glUniform1f(UniformLoc, Float);
 }
 
@@ -7,6 +7,42 @@ ctime -begin tests.ctm
 REM cl -nologo -Z7 -FC -WX -W4 ..\ch_buf_test.cpp /link -incremental:no
 REM cl -nologo -Z7 -FC -WX -W4 ..\ch_math_test.cpp /link -incremental:no
 REM cl -nologo -Z7 -FC -WX -W4 -wd4189 -wd4505 ..\ch_win32_test.cpp User32.lib Gdi32.lib
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_bvh_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_bvh_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_raster_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_raster_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_pack_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_bmp_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_image_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_image_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_capture_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_capture_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_imgproc_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_imgproc_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_bc_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_bc_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_texcache_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_texcache_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_profile_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_profile_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_bench_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_suite_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_jobs_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_jobs_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_uniform_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_ring_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_block_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_stream_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_state_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_load_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_load_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_command_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_command_bench.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_mesh_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_program_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_profile_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\ch_gl_post_test.cpp /link -incremental:no
+REM cl -nologo -O2 -Z7 -FC -EHsc ..\gl_imgui_test.cpp /link -incremental:no
 cl -nologo -Z7 -FC -WX -W4 -wd4189 -wd4505 -wd4100 ..\ch_d3d12_test.cpp /link -incremental:no User32.lib Gdi32.lib d3d12.lib dxgi.lib d3dcompiler.lib
 ctime -end tests.ctm
 
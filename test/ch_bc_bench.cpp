@@ -0,0 +1,146 @@
+#include "../ch_bc.h"
+#include "../ch_image.h"
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+/*
+usage: ch_bc_bench [image file | size]
+
+Encodes an image (BMP/TGA/PPM/QOI, or a size x size synthetic texture with alpha,
+default 512) to every format in both qualities at 1 thread up to all hardware
+threads, then decodes it. Prints megapixels per second and the PSNR over the
+channels the format stores. BC1 gets the texture with alpha forced to 255 (it
+would punch holes otherwise), BC5 as a tangent space normal map.
+*/
+
+static f64
+GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<f64>(steady_clock::now().time_since_epoch()).count();
+}
+
+// runs Work until at least a quarter of a second went by, returns seconds per run;
+// the high quality encoders can take longer than that once, then one run is all we time
+template <typename F>
+static f64
+TimeIt(F Work)
+{
+    f64 Begin = GetSeconds();
+    Work();
+    f64 First = GetSeconds() - Begin;
+    if (First > 0.25) return First;
+    
+    int RunCount = 0;
+    Begin = GetSeconds();
+    f64 Elapsed = 0.0;
+    do
+    {
+        Work();
+        ++RunCount;
+        Elapsed = GetSeconds() - Begin;
+    } while (Elapsed < 0.25);
+    return Elapsed / f64(RunCount);
+}
+
+int main(int ArgCount, char **Args)
+{
+    ch::image Image = {};
+    if (ArgCount > 1 && atoi(Args[1]) == 0)
+    {
+        Image = ch::LoadImageFile(Args[1]);
+        if (!Image.Pixels)
+        {
+            printf("can't load %s\n", Args[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        int Size = ArgCount > 1? atoi(Args[1]): 512;
+        Image = ch::AllocateImage(Size, Size);
+        for (int Y = 0; Y < Size; ++Y)
+        {
+            u8 *Row = Image.Pixels + Image.Pitch * Y;
+            for (int X = 0; X < Size; ++X)
+            {
+                u32 Noise = u32(X * 2654435761u) ^ u32(Y * 40503u);
+                f32 U = f32(X) / f32(Size), V = f32(Y) / f32(Size);
+                Row[4 * X + 0] = u8(230.0f * (0.5f + 0.5f * sinf(12.0f * U + 5.0f * V)) + (Noise & 15));
+                Row[4 * X + 1] = u8(200.0f * V + ((X / 32 + Y / 32) & 1) * 30 + ((Noise >> 8) & 15));
+                Row[4 * X + 2] = u8(230.0f * U * V + ((Noise >> 16) & 15));
+                Row[4 * X + 3] = u8(230.0f * (0.5f + 0.5f * cosf(9.0f * V)) + ((Noise >> 24) & 15));
+            }
+        }
+    }
+    int Width = Image.Width, Height = Image.Height;
+    u64 PixelCount = (u64)Width * Height;
+    printf("%dx%d\n", Width, Height);
+    
+    // opaque copy for BC1, normal map for BC5 from the gradients of the red channel
+    ch::image Opaque = ch::AllocateImage(Width, Height);
+    ch::image Normals = ch::AllocateImage(Width, Height);
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        for (int X = 0; X < Width; ++X)
+        {
+            u8 *Solid = Opaque.Pixels + Opaque.Pitch * Y + 4 * X;
+            memcpy(Solid, Image.Pixels + Image.Pitch * Y + 4 * X, 3);
+            Solid[3] = 255;
+            
+            const u8 *P = Image.Pixels + Image.Pitch * Y + 4 * X;
+            int DX = int(P[X + 1 < Width? 4: 0]) - int(P[0]);
+            int DY = int(P[Y + 1 < Height? Image.Pitch: 0]) - int(P[0]);
+            v3 N = Normalize(V3(-f32(DX) / 32.0f, -f32(DY) / 32.0f, 1.0f));
+            u8 *Out = Normals.Pixels + Normals.Pitch * Y + 4 * X;
+            Out[0] = u8(127.5f + 127.5f * N.X);
+            Out[1] = u8(127.5f + 127.5f * N.Y);
+            Out[2] = u8(127.5f + 127.5f * N.Z);
+            Out[3] = 255;
+        }
+    }
+    
+    int MaxThreads = int(std::thread::hardware_concurrency());
+    if (MaxThreads <= 0) MaxThreads = 1;
+    
+    const ch::bc_format Formats[5] = {ch::BCFormat_BC1, ch::BCFormat_BC3, ch::BCFormat_BC4, ch::BCFormat_BC5, ch::BCFormat_BC7};
+    const char *FormatNames[5] = {"bc1", "bc3", "bc4", "bc5", "bc7"};
+    const char *QualityNames[2] = {"fast", "high"};
+    std::vector<u8> Decoded((size_t)Width * Height * 4);
+    for (int FormatI = 0; FormatI < 5; ++FormatI)
+    {
+        ch::bc_format Format = Formats[FormatI];
+        const ch::image *Source = Format == ch::BCFormat_BC1? &Opaque: (Format == ch::BCFormat_BC5? &Normals: &Image);
+        size_t BlockPitch = ch::GetBCRowPitch(Width, Format);
+        std::vector<u8> Blocks(ch::GetBCImageSize(Width, Height, Format));
+        for (int Quality = ch::BCQuality_Fast; Quality <= ch::BCQuality_High; ++Quality)
+        {
+            for (int ThreadCount = 1; ThreadCount <= MaxThreads; ThreadCount = ThreadCount < MaxThreads && ThreadCount * 2 > MaxThreads? MaxThreads: ThreadCount * 2)
+            {
+                f64 Seconds = TimeIt([&]()
+                                     {
+                                         ch::EncodeBC(Blocks.data(), BlockPitch, Source->Pixels, Source->Pitch, Width, Height,
+                                                      Format, (ch::bc_quality)Quality, ThreadCount);
+                                     });
+                ch::DecodeBC(Decoded.data(), (size_t)Width * 4, Blocks.data(), BlockPitch, Width, Height, Format, 1);
+                f64 PSNR = ch::ComputePSNR(Source->Pixels, Source->Pitch, Decoded.data(), (size_t)Width * 4, Width, Height,
+                                           ch::GetBCChannelCount(Format));
+                printf("encode %s %s %2d threads %9.2f MP/s %9.2f ms %6.2f dB\n", FormatNames[FormatI], QualityNames[Quality],
+                       ThreadCount, f64(PixelCount) / Seconds / 1e6, 1000.0 * Seconds, PSNR);
+                if (ThreadCount == MaxThreads) break;
+            }
+        }
+        
+        f64 Seconds = TimeIt([&]()
+                             {
+                                 ch::DecodeBC(Decoded.data(), (size_t)Width * 4, Blocks.data(), BlockPitch, Width, Height, Format, 1);
+                             });
+        printf("decode %s            %9.2f MP/s %9.2f ms\n", FormatNames[FormatI], f64(PixelCount) / Seconds / 1e6, 1000.0 * Seconds);
+    }
+    
+    ch::FreeImage(&Normals);
+    ch::FreeImage(&Opaque);
+    ch::FreeImage(&Image);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "../ch_bc.h"
+#include <assert.h>
+#include <stdio.h>
+#include <vector>
+
+static u32
+Hash(u32 X)
+{
+    X ^= X >> 16;
+    X *= 0x7feb352d;
+    X ^= X >> 15;
+    X *= 0x846ca68b;
+    X ^= X >> 16;
+    return X;
+}
+
+// smooth color and alpha ramps with some noise on top, roughly what a real texture looks like
+static void
+FillTexture(std::vector<u8> *Pixels, int Width, int Height)
+{
+    Pixels->resize((size_t)Width * Height * 4);
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        for (int X = 0; X < Width; ++X)
+        {
+            u8 *P = &(*Pixels)[4 * ((size_t)Y * Width + X)];
+            u32 Noise = Hash(u32(Y * Width + X));
+            f32 U = f32(X) / f32(Width), V = f32(Y) / f32(Height);
+            P[0] = u8(255.0f * (0.5f + 0.5f * sinf(6.0f * U + 2.0f * V)) * 0.9f + (Noise & 15));
+            P[1] = u8(200.0f * V + ((Noise >> 8) & 15));
+            P[2] = u8(255.0f * U * V * 0.9f + ((Noise >> 16) & 15));
+            P[3] = u8(255.0f * (0.5f + 0.5f * cosf(4.0f * V)) * 0.9f + ((Noise >> 24) & 15));
+        }
+    }
+}
+
+struct round_trip
+{
+    f64 PSNR;
+    std::vector<u8> Blocks;
+};
+
+static round_trip
+RoundTrip(const std::vector<u8> &Pixels, int Width, int Height, ch::bc_format Format, ch::bc_quality Quality, int ThreadCount)
+{
+    round_trip Result;
+    size_t BlockPitch = ch::GetBCRowPitch(Width, Format);
+    Result.Blocks.resize(ch::GetBCImageSize(Width, Height, Format));
+    ch::EncodeBC(Result.Blocks.data(), BlockPitch, Pixels.data(), (size_t)Width * 4, Width, Height, Format, Quality, ThreadCount);
+    std::vector<u8> Decoded(Pixels.size());
+    ch::DecodeBC(Decoded.data(), (size_t)Width * 4, Result.Blocks.data(), BlockPitch, Width, Height, Format, ThreadCount);
+    Result.PSNR = ch::ComputePSNR(Pixels.data(), (size_t)Width * 4, Decoded.data(), (size_t)Width * 4, Width, Height,
+                                  ch::GetBCChannelCount(Format));
+    return Result;
+}
+
+int main()
+{
+    const ch::bc_format Formats[5] = {ch::BCFormat_BC1, ch::BCFormat_BC3, ch::BCFormat_BC4, ch::BCFormat_BC5, ch::BCFormat_BC7};
+    const char *FormatNames[5] = {"BC1", "BC3", "BC4", "BC5", "BC7"};
+    
+    // decoders against a reference decoder: FNV-1a of the channels each format stores,
+    // over 4096 random blocks (BC7 blocks avoid the reserved mode)
+    {
+        const u32 FormatNumbers[5] = {1, 3, 4, 5, 7};
+        const u32 Expected[5] = {0x847d6df8, 0x6e34770d, 0xd024517e, 0x3d166ec4, 0x8e31f7b0};
+        for (int FormatI = 0; FormatI < 5; ++FormatI)
+        {
+            ch::bc_format Format = Formats[FormatI];
+            int BlockSize = ch::GetBCBlockSize(Format);
+            int ChannelCount = Format == ch::BCFormat_BC4? 1: (Format == ch::BCFormat_BC5? 2: 4);
+            u32 Fnv = 0x811c9dc5;
+            for (u32 BlockI = 0; BlockI < 4096; ++BlockI)
+            {
+                u8 Block[16];
+                for (int I = 0; I < BlockSize; ++I)
+                {
+                    Block[I] = (u8)Hash(FormatNumbers[FormatI] * 1000003u + BlockI * BlockSize + I);
+                }
+                if (Format == ch::BCFormat_BC7 && Block[0] == 0) Block[0] = 0x80;
+                u8 Texels[16][4];
+                ch::DecodeBCBlock(Texels, Block, Format);
+                for (int T = 0; T < 16; ++T)
+                {
+                    for (int C = 0; C < ChannelCount; ++C) Fnv = (Fnv ^ Texels[T][C]) * 0x01000193;
+                }
+            }
+            assert(Fnv == Expected[FormatI]);
+        }
+    }
+    
+    // BC7 blocks of every mode survive unpack/pack bit for bit, the reserved mode decodes to zeros
+    {
+        for (u32 BlockI = 0; BlockI < 4096; ++BlockI)
+        {
+            u8 Block[16], Repacked[16];
+            for (int I = 0; I < 16; ++I) Block[I] = (u8)Hash(BlockI * 16 + I);
+            Block[0] = u8((Block[0] | 1) << (BlockI & 7));
+            ch::bc7_block Unpacked;
+            ch::UnpackBC7Block(&Unpacked, Block);
+            assert(Unpacked.Mode == int(BlockI & 7));
+            ch::PackBC7Block(Repacked, &Unpacked);
+            assert(memcmp(Block, Repacked, 16) == 0);
+        }
+        u8 Reserved[16] = {};
+        Reserved[5] = 0xAB;
+        u8 Texels[16][4];
+        ch::DecodeBC7Block(Texels, Reserved);
+        for (int T = 0; T < 16; ++T) assert(Texels[T][0] == 0 && Texels[T][3] == 0);
+    }
+    
+    // flat blocks: BC4 is exact, BC1 within the 565 interpolation error and BC7 within 1 (mode 6
+    // has one p-bit for all channels of an endpoint, mixed parity colors can't be hit exactly)
+    for (int Value = 0; Value < 256; ++Value)
+    {
+        u8 Texels[16][4];
+        for (int T = 0; T < 16; ++T)
+        {
+            Texels[T][0] = (u8)Value;
+            Texels[T][1] = (u8)(255 - Value);
+            Texels[T][2] = (u8)(Value * 7);
+            Texels[T][3] = (u8)(Value ^ 0x5A);
+        }
+        for (int FormatI = 0; FormatI < 5; ++FormatI)
+        {
+            for (int Quality = 0; Quality < 2; ++Quality)
+            {
+                ch::bc_format Format = Formats[FormatI];
+                u8 Block[16], Decoded[16][4];
+                ch::EncodeBCBlock(Block, Texels, Format, (ch::bc_quality)Quality);
+                ch::DecodeBCBlock(Decoded, Block, Format);
+                int ChannelCount = ch::GetBCChannelCount(Format);
+                for (int T = 0; T < 16; ++T)
+                {
+                    for (int C = 0; C < ChannelCount; ++C)
+                    {
+                        int Expected = (Format == ch::BCFormat_BC1 && Texels[T][3] < 128)? 0: Texels[T][C];
+                        int Diff = abs(int(Decoded[T][C]) - Expected);
+                        bool ColorInBC1 = (Format == ch::BCFormat_BC1 || Format == ch::BCFormat_BC3) && C < 3;
+                        assert(Diff <= (ColorInBC1? 3: Format == ch::BCFormat_BC7? 1: 0));
+                    }
+                }
+            }
+        }
+    }
+    
+    // BC1 punch-through: alpha below 128 decodes to transparent black, the rest stays opaque
+    {
+        u8 Texels[16][4];
+        for (int T = 0; T < 16; ++T)
+        {
+            Texels[T][0] = u8(T * 16);
+            Texels[T][1] = u8(255 - T * 16);
+            Texels[T][2] = 90;
+            Texels[T][3] = (T % 3 == 0)? 10: 250;
+        }
+        for (int Quality = 0; Quality < 2; ++Quality)
+        {
+            u8 Block[8], Decoded[16][4];
+            ch::EncodeBCBlock(Block, Texels, ch::BCFormat_BC1, (ch::bc_quality)Quality);
+            ch::DecodeBCBlock(Decoded, Block, ch::BCFormat_BC1);
+            for (int T = 0; T < 16; ++T)
+            {
+                if (T % 3 == 0)
+                {
+                    assert(Decoded[T][0] == 0 && Decoded[T][1] == 0 && Decoded[T][2] == 0 && Decoded[T][3] == 0);
+                }
+                else
+                {
+                    assert(Decoded[T][3] == 255);
+                }
+            }
+        }
+    }
+    
+    // quality on a texture-like image, high quality never loses to fast
+    {
+        int Width = 128, Height = 128;
+        std::vector<u8> Pixels;
+        FillTexture(&Pixels, Width, Height);
+        std::vector<u8> Opaque = Pixels; // BC1 would punch holes into the alpha < 128 parts
+        for (size_t I = 3; I < Opaque.size(); I += 4) Opaque[I] = 255;
+        const f64 MinPSNR[5] = {34.0, 35.0, 47.0, 48.0, 34.0};
+        for (int FormatI = 0; FormatI < 5; ++FormatI)
+        {
+            const std::vector<u8> &Source = Formats[FormatI] == ch::BCFormat_BC1? Opaque: Pixels;
+            round_trip Fast = RoundTrip(Source, Width, Height, Formats[FormatI], ch::BCQuality_Fast, 1);
+            round_trip High = RoundTrip(Source, Width, Height, Formats[FormatI], ch::BCQuality_High, 1);
+            printf("%s fast %.2f dB, high %.2f dB\n", FormatNames[FormatI], Fast.PSNR, High.PSNR);
+            assert(Fast.PSNR > MinPSNR[FormatI]);
+            assert(High.PSNR >= Fast.PSNR);
+        }
+    }
+    
+    // threads split rows of blocks and produce the same bytes; odd sizes clamp the edge blocks
+    // and decoding never writes past the image
+    {
+        const int Sizes[3][2] = {{520, 260}, {13, 7}, {1, 1}};
+        for (int SizeI = 0; SizeI < 3; ++SizeI)
+        {
+            int Width = Sizes[SizeI][0], Height = Sizes[SizeI][1];
+            std::vector<u8> Pixels;
+            FillTexture(&Pixels, Width, Height);
+            for (int FormatI = 0; FormatI < 5; ++FormatI)
+            {
+                ch::bc_format Format = Formats[FormatI];
+                round_trip One = RoundTrip(Pixels, Width, Height, Format, ch::BCQuality_Fast, 1);
+                round_trip Many = RoundTrip(Pixels, Width, Height, Format, ch::BCQuality_Fast, 3);
+                assert(One.Blocks == Many.Blocks);
+                
+                size_t Pitch = (size_t)Width * 4 + 8;
+                std::vector<u8> Decoded(Pitch * Height + 8, 0xCD);
+                ch::DecodeBC(Decoded.data(), Pitch, One.Blocks.data(), ch::GetBCRowPitch(Width, Format), Width, Height, Format, 2);
+                for (int Y = 0; Y < Height; ++Y)
+                {
+                    for (int I = 0; I < 8; ++I) assert(Decoded[Pitch * Y + (size_t)Width * 4 + I] == 0xCD);
+                }
+            }
+        }
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "../ch_bench.h"
+#include <assert.h>
+
+static ch::bench_result
+MakeResult(const char *Name, f64 Median, f64 Cycles)
+{
+    ch::bench_result Result = {};
+    snprintf(Result.Name, sizeof(Result.Name), "%s", Name);
+    Result.Iterations = 10;
+    Result.Repetitions = 5;
+    Result.Min = 0.9 * Median;
+    Result.Median = Median;
+    Result.P90 = 1.1 * Median;
+    Result.P99 = 1.2 * Median;
+    Result.Max = 1.25 * Median;
+    Result.Mean = 1.01 * Median;
+    Result.Cycles = Cycles;
+    return Result;
+}
+
+static ch::bench_suite
+MakeSuite(const char *CycleSource)
+{
+    ch::bench_options Options = ch::DefaultBenchOptions();
+    Options.Log = 0;
+    ch::bench_suite Suite = ch::InitBenchSuite(Options);
+    snprintf(Suite.CycleSource, sizeof(Suite.CycleSource), "%s", CycleSource);
+    return Suite;
+}
+
+int main()
+{
+    // percentiles
+    {
+        f64 Samples[5] = {5.0, 1.0, 4.0, 2.0, 3.0};
+        ch::SortSamples(Samples, 5);
+        for (int I = 0; I < 5; ++I) assert(Samples[I] == f64(I + 1));
+        assert(ch::GetPercentile(Samples, 5, 0.0) == 1.0);
+        assert(ch::GetPercentile(Samples, 5, 50.0) == 3.0);
+        assert(ch::GetPercentile(Samples, 5, 100.0) == 5.0);
+        assert(fabs(ch::GetPercentile(Samples, 5, 90.0) - 4.6) < 1e-9);
+        assert(ch::GetPercentile(Samples, 1, 99.0) == 1.0);
+    }
+    
+    // a 20us busy wait measures as about that
+    ch::bench_options Options = ch::DefaultBenchOptions();
+    Options.WarmupSeconds = 0.01;
+    Options.RepetitionSeconds = 0.002;
+    Options.RepetitionCount = 7;
+    Options.Log = 0;
+    ch::bench_suite Suite = ch::InitBenchSuite(Options);
+    assert(strcmp(Suite.CycleSource, "cpu") == 0 || strcmp(Suite.CycleSource, "tsc") == 0);
+    {
+        int Calls = 0;
+        const ch::bench_result *Result = ch::RunBenchmark(&Suite, "spin/20us", 2.0, [&]()
+                                                          {
+                                                              u64 Begin = ch::GetClockNanoseconds();
+                                                              while (ch::GetClockNanoseconds() - Begin < 20000) {}
+                                                              ++Calls;
+                                                          });
+        assert(Result && Suite.ResultCount == 1);
+        assert(strcmp(Result->Name, "spin/20us") == 0);
+        assert(Result->Repetitions == 7 && Result->Iterations >= 1 && Result->Items == 2.0);
+        assert(u64(Calls) >= 7 * Result->Iterations);
+        assert(Result->Min <= Result->Median && Result->Median <= Result->P90 && Result->P90 <= Result->P99 && Result->P99 <= Result->Max);
+        assert(Result->Min <= Result->Mean && Result->Mean <= Result->Max);
+        assert(Result->Median >= 19000.0 && Result->Median < 2e6);
+        assert(Result->Cycles > 0.0);
+        
+        // the cheap one gets more calls per repetition
+        u64 Counter = 0;
+        const ch::bench_result *Cheap = ch::RunBenchmark(&Suite, "cheap", 0.0, [&]() { ch::KeepValue(++Counter); });
+        assert(Cheap->Iterations > 10 * Suite.Results[0].Iterations);
+        assert(Cheap->Median < Suite.Results[0].Median);
+    }
+    
+    // filtered out
+    {
+        ch::bench_suite Filtered = ch::InitBenchSuite(Options);
+        Filtered.Options.Filter = "math/";
+        bool Ran = false;
+        assert(!ch::RunBenchmark(&Filtered, "bc/bc7", 0.0, [&]() { Ran = true; }));
+        assert(!Ran && Filtered.ResultCount == 0);
+        assert(ch::RunBenchmark(&Filtered, "math/mat4_mul", 0.0, [&]() { Ran = true; }));
+        assert(Ran && Filtered.ResultCount == 1);
+        ch::FreeBenchSuite(&Filtered);
+    }
+    
+    // json round trip
+    {
+        ch::bench_suite Written = MakeSuite("cpu");
+        *ch::AddBenchResult(&Written, "a") = MakeResult("odd \"name\" \\", 1234.5678901234567, 4321.0);
+        *ch::AddBenchResult(&Written, "b") = MakeResult("b", 1e-3, 0.0);
+        Written.Results[1].Items = 65536.0;
+        Written.Results[1].Iterations = 1ull << 40;
+        assert(ch::WriteBenchJSON(&Written, "ch_bench_test.json"));
+        
+        ch::bench_suite Read = {};
+        assert(ch::ReadBenchJSON(&Read, "ch_bench_test.json"));
+        assert(strcmp(Read.CycleSource, "cpu") == 0);
+        assert(Read.ResultCount == 2);
+        for (int I = 0; I < 2; ++I)
+        {
+            const ch::bench_result *A = &Written.Results[I], *B = &Read.Results[I];
+            assert(strcmp(A->Name, B->Name) == 0);
+            assert(A->Iterations == B->Iterations && A->Repetitions == B->Repetitions && A->Items == B->Items);
+            assert(A->Min == B->Min && A->Median == B->Median && A->P90 == B->P90 && A->P99 == B->P99);
+            assert(A->Max == B->Max && A->Mean == B->Mean && A->Cycles == B->Cycles);
+        }
+        assert(ch::FindBenchResult(&Read, "odd \"name\" \\"));
+        assert(!ch::FindBenchResult(&Read, "c"));
+        
+        // truncated or missing files are rejected
+        FILE *File = fopen("ch_bench_test.json", "rb");
+        char Text[4096];
+        size_t Size = fread(Text, 1, sizeof(Text), File);
+        fclose(File);
+        File = fopen("ch_bench_test.json", "wb");
+        fwrite(Text, 1, Size / 2, File);
+        fclose(File);
+        ch::bench_suite Truncated = {};
+        assert(!ch::ReadBenchJSON(&Truncated, "ch_bench_test.json"));
+        remove("ch_bench_test.json");
+        ch::bench_suite Missing = {};
+        assert(!ch::ReadBenchJSON(&Missing, "ch_bench_test.json"));
+        
+        ch::FreeBenchSuite(&Truncated);
+        ch::FreeBenchSuite(&Read);
+        ch::FreeBenchSuite(&Written);
+    }
+    
+    // comparing
+    {
+        ch::bench_suite Baseline = MakeSuite("tsc");
+        *ch::AddBenchResult(&Baseline, "math/mul") = MakeResult("math/mul", 100.0, 300.0);
+        *ch::AddBenchResult(&Baseline, "math/inverse") = MakeResult("math/inverse", 100.0, 300.0);
+        *ch::AddBenchResult(&Baseline, "bc/bc7") = MakeResult("bc/bc7", 100.0, 300.0);
+        *ch::AddBenchResult(&Baseline, "gone") = MakeResult("gone", 100.0, 300.0);
+        
+        ch::bench_suite Current = MakeSuite("tsc");
+        *ch::AddBenchResult(&Current, "math/mul") = MakeResult("math/mul", 105.0, 600.0);     // within 10%
+        *ch::AddBenchResult(&Current, "math/inverse") = MakeResult("math/inverse", 80.0, 300.0);
+        *ch::AddBenchResult(&Current, "bc/bc7") = MakeResult("bc/bc7", 120.0, 300.0);       // 20% slower
+        *ch::AddBenchResult(&Current, "fresh") = MakeResult("fresh", 1.0, 1.0);
+        
+        f64 Ratio = 0.0;
+        assert(ch::CompareBenchResult(&Current.Results[0], &Baseline.Results[0], false, 0.1, &Ratio) == ch::BenchVerdict_Same);
+        assert(fabs(Ratio - 1.05) < 1e-9);
+        assert(ch::CompareBenchResult(&Current.Results[1], &Baseline.Results[1], false, 0.1) == ch::BenchVerdict_Faster);
+        assert(ch::CompareBenchResult(&Current.Results[2], &Baseline.Results[2], false, 0.1) == ch::BenchVerdict_Slower);
+        assert(ch::CompareBenchResult(&Current.Results[3], 0, false, 0.1) == ch::BenchVerdict_New);
+        
+        assert(ch::CompareBenchSuites(&Current, &Baseline, 0.1) == 1);
+        assert(ch::CompareBenchSuites(&Current, &Baseline, 0.25) == 0);
+        
+        // per benchmark tolerances, the last match wins
+        ch::bench_tolerance Tolerances[] = {{"bc/*", 0.05}, {"bc/bc7", 0.3}, {"math/*", 0.01}};
+        assert(ch::GetBenchTolerance("bc/bc1", 0.1, Tolerances, 3) == 0.05);
+        assert(ch::GetBenchTolerance("bc/bc7", 0.1, Tolerances, 3) == 0.3);
+        assert(ch::GetBenchTolerance("math/mul", 0.1, Tolerances, 3) == 0.01);
+        assert(ch::GetBenchTolerance("mathematics", 0.1, Tolerances, 3) == 0.1);
+        assert(ch::CompareBenchSuites(&Current, &Baseline, 0.1, Tolerances, 3) == 1); // math/mul now, not bc/bc7
+        
+        // cycles decide once both runs counted them, math/mul doubled
+        snprintf(Current.CycleSource, sizeof(Current.CycleSource), "cpu");
+        assert(ch::CompareBenchSuites(&Current, &Baseline, 0.1) == 1);
+        snprintf(Baseline.CycleSource, sizeof(Baseline.CycleSource), "cpu");
+        assert(ch::CompareBenchSuites(&Current, &Baseline, 0.25) == 1);
+        
+        ch::FreeBenchSuite(&Current);
+        ch::FreeBenchSuite(&Baseline);
+    }
+    
+    ch::FreeBenchSuite(&Suite);
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "../ch_bmp.h"
+#include <assert.h>
+#include <thread>
+#include <vector>
+
+static std::vector<uint8_t>
+ReadFile(const char *Path)
+{
+    std::vector<uint8_t> Result;
+    FILE *File = fopen(Path, "rb");
+    assert(File);
+    fseek(File, 0, SEEK_END);
+    Result.resize((size_t)ftell(File));
+    fseek(File, 0, SEEK_SET);
+    size_t Read = fread(Result.data(), 1, Result.size(), File);
+    assert(Read == Result.size());
+    fclose(File);
+    return Result;
+}
+
+static uint32_t
+TestPixel(int X, int Y)
+{
+    return (uint32_t)(X * 7 + Y * 13) | ((uint32_t)(X ^ Y) << 8) | ((uint32_t)(X + 3 * Y) << 16) | ((uint32_t)(X * Y) << 24);
+}
+
+// checks the headers and every pixel of a file written from TestPixel
+static void
+CheckFile(const char *Path, int Width, int Height, int BitCount, CH_BMP::bmp_pixel_format Format, bool TopRowFirst)
+{
+    std::vector<uint8_t> File = ReadFile(Path);
+    CH_BMP::bmp_file_header FileHeader;
+    CH_BMP::bmp_image_header ImageHeader;
+    memcpy(&FileHeader, File.data(), sizeof(FileHeader));
+    memcpy(&ImageHeader, File.data() + sizeof(FileHeader), sizeof(ImageHeader));
+    
+    uint32_t Stride = ((uint32_t)Width * BitCount / 8 + 3) & ~3u;
+    assert(FileHeader.bfType[0] == 'B' && FileHeader.bfType[1] == 'M');
+    assert(FileHeader.bfSize == File.size());
+    assert(FileHeader.bfOffbits == 54);
+    assert(ImageHeader.biSize == 40);
+    assert(ImageHeader.biWidth == Width);
+    assert(ImageHeader.biHeight == (TopRowFirst? -Height: Height));
+    assert(ImageHeader.biBitCount == BitCount);
+    assert(ImageHeader.biSizeImage == Stride * Height);
+    assert(File.size() == 54 + Stride * Height);
+    
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        uint8_t *Row = File.data() + 54 + (size_t)Stride * Y;
+        for (int X = 0; X < Width; ++X)
+        {
+            uint32_t Pixel = TestPixel(X, Y);
+            uint8_t R = (uint8_t)(Format == CH_BMP::BMPPixel_BGRA8? Pixel >> 16: Pixel);
+            uint8_t G = (uint8_t)(Pixel >> 8);
+            uint8_t B = (uint8_t)(Format == CH_BMP::BMPPixel_BGRA8? Pixel: Pixel >> 16);
+            uint8_t *P = Row + X * BitCount / 8;
+            assert(P[0] == B && P[1] == G && P[2] == R);
+            if (BitCount == 32)
+            {
+                assert(P[3] == (uint8_t)(Pixel >> 24));
+            }
+        }
+        for (uint32_t Pad = (uint32_t)Width * BitCount / 8; Pad < Stride; ++Pad)
+        {
+            assert(Row[Pad] == 0);
+        }
+    }
+}
+
+int main()
+{
+    const char *Path = "ch_bmp_test.bmp";
+    int Widths[] = {1, 2, 3, 5, 16, 17, 33, 64, 101};
+    
+    // every format, widths that hit each padding amount and the SIMD tails
+    for (int W = 0; W < (int)(sizeof(Widths) / sizeof(Widths[0])); ++W)
+    {
+        int Width = Widths[W];
+        int Height = 9;
+        std::vector<uint32_t> Image(Width * Height);
+        for (int Y = 0; Y < Height; ++Y)
+        {
+            for (int X = 0; X < Width; ++X)
+            {
+                Image[Y * Width + X] = TestPixel(X, Y);
+            }
+        }
+        
+        for (int BitCount = 24; BitCount <= 32; BitCount += 8)
+        {
+            for (int F = 0; F < 2; ++F)
+            {
+                CH_BMP::bmp_pixel_format Format = (CH_BMP::bmp_pixel_format)F;
+                
+                // one row at a time, bottom to top, from a pitched buffer
+                CH_BMP::bmp_writer Writer;
+                assert(CH_BMP::BeginBMP(&Writer, Path, Width, Height, BitCount, Format));
+                size_t Pitch = (Width + 3) * 4;
+                std::vector<uint32_t> Pitched(Pitch / 4 * Height, 0xDEADBEEF);
+                for (int Y = 0; Y < Height; ++Y)
+                {
+                    memcpy(&Pitched[Y * Pitch / 4], &Image[Y * Width], Width * 4);
+                }
+                for (int Y = Height - 1; Y >= 0; --Y)
+                {
+                    assert(CH_BMP::WriteBMPRows(&Writer, Y, 1, &Pitched[Y * Pitch / 4], Pitch));
+                }
+                assert(CH_BMP::EndBMP(&Writer));
+                CheckFile(Path, Width, Height, BitCount, Format, true);
+            }
+        }
+        
+        assert(CH_BMP::WriteImageToBMP(Path, Image.data(), Width, Height));
+        CheckFile(Path, Width, Height, 32, CH_BMP::BMPPixel_BGRA8, false);
+    }
+    
+    // several producer threads writing interleaved chunks
+    {
+        int Width = 1000;
+        int Height = 777;
+        int ChunkRows = 16;
+        std::vector<uint32_t> Image(Width * Height);
+        for (int Y = 0; Y < Height; ++Y)
+        {
+            for (int X = 0; X < Width; ++X)
+            {
+                Image[Y * Width + X] = TestPixel(X, Y);
+            }
+        }
+        
+        CH_BMP::bmp_writer Writer;
+        assert(CH_BMP::BeginBMP(&Writer, Path, Width, Height, 24, CH_BMP::BMPPixel_RGBA8));
+        int ThreadCount = 4;
+        std::vector<std::thread> Threads;
+        for (int T = 0; T < ThreadCount; ++T)
+        {
+            Threads.emplace_back([&, T]()
+                                 {
+                                     for (int Row = T * ChunkRows; Row < Height; Row += ThreadCount * ChunkRows)
+                                     {
+                                         int Count = Row + ChunkRows <= Height? ChunkRows: Height - Row;
+                                         bool Written = CH_BMP::WriteBMPRows(&Writer, Row, Count, &Image[Row * Width]);
+                                         assert(Written);
+                                     }
+                                 });
+        }
+        for (size_t T = 0; T < Threads.size(); ++T)
+        {
+            Threads[T].join();
+        }
+        assert(CH_BMP::EndBMP(&Writer));
+        CheckFile(Path, Width, Height, 24, CH_BMP::BMPPixel_RGBA8, true);
+    }
+    
+    // missing rows and bad arguments are reported
+    {
+        uint32_t Row[2 * 4] = {};
+        CH_BMP::bmp_writer Writer;
+        assert(!CH_BMP::BeginBMP(&Writer, Path, 4, 2, 16));
+        assert(CH_BMP::BeginBMP(&Writer, Path, 4, 2));
+        assert(!CH_BMP::WriteBMPRows(&Writer, 2, 1, Row));
+        assert(CH_BMP::WriteBMPRows(&Writer, 0, 1, Row));
+        assert(!CH_BMP::EndBMP(&Writer));
+        
+        // a row written twice doesn't make up for one never written
+        assert(CH_BMP::BeginBMP(&Writer, Path, 4, 3));
+        assert(CH_BMP::WriteBMPRows(&Writer, 0, 2, Row));
+        assert(CH_BMP::WriteBMPRows(&Writer, 1, 1, Row));
+        assert(Writer.RowsWritten == 2);
+        assert(!CH_BMP::EndBMP(&Writer));
+    }
+    
+    remove(Path);
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "../ch_bvh.h"
+#include <stdio.h>
+#include <chrono>
+
+/*
+usage: ch_bvh_bench [model.obj]
+
+Without an argument a ~1M triangle displaced sphere is generated.
+Primary rays are shot from a pinhole camera looking at the model bounds.
+*/
+
+static f64
+GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<f64>(steady_clock::now().time_since_epoch()).count();
+}
+
+static ch_obj::Model
+GenerateSphere(int Rings, int Segments)
+{
+    ch_obj::Model Model = {};
+    int VertCount = (Rings + 1) * (Segments + 1);
+    Model.vb_count = 3 * VertCount;
+    Model.vb = (float *)malloc(sizeof(float) * Model.vb_count);
+    Model.ib_count = 6 * Rings * Segments;
+    Model.ib = (int *)malloc(sizeof(int) * 3 * Model.ib_count);
+    
+    for (int R = 0; R <= Rings; ++R)
+    {
+        for (int S = 0; S <= Segments; ++S)
+        {
+            f32 Theta = Pi32 * f32(R) / f32(Rings);
+            f32 Phi = 2.0f * Pi32 * f32(S) / f32(Segments);
+            f32 Radius = 1.0f + 0.05f * sinf(13.0f * Theta) * cosf(17.0f * Phi);
+            f32 *P = Model.vb + 3 * (R * (Segments + 1) + S);
+            P[0] = Radius * sinf(Theta) * cosf(Phi);
+            P[1] = Radius * cosf(Theta);
+            P[2] = Radius * sinf(Theta) * sinf(Phi);
+        }
+    }
+    
+    int *Index = Model.ib;
+    for (int R = 0; R < Rings; ++R)
+    {
+        for (int S = 0; S < Segments; ++S)
+        {
+            int I0 = R * (Segments + 1) + S;
+            int I1 = I0 + 1;
+            int I2 = I0 + Segments + 1;
+            int I3 = I2 + 1;
+            int Quad[6] = {I0, I2, I1, I1, I2, I3};
+            for (int I = 0; I < 6; ++I)
+            {
+                *Index++ = Quad[I];
+                *Index++ = -1;
+                *Index++ = -1;
+            }
+        }
+    }
+    
+    return Model;
+}
+
+struct camera
+{
+    v3 P;
+    v3 Forward, Right, Up;
+};
+
+static v3
+PixelDirection(camera *Camera, int X, int Y, int Size)
+{
+    f32 U = (f32(X) + 0.5f) / f32(Size) * 2.0f - 1.0f;
+    f32 V = (f32(Y) + 0.5f) / f32(Size) * 2.0f - 1.0f;
+    return Normalize(Camera->Forward + U * Camera->Right + V * Camera->Up);
+}
+
+template <int W, int H>
+static f64
+TracePackets(ch::bvh *BVH, camera *Camera, int Size, bool AnyHit, int *HitCount_Out)
+{
+    int HitCount = 0;
+    f64 Begin = GetSeconds();
+    for (int Y = 0; Y < Size; Y += H)
+    {
+        for (int X = 0; X < Size; X += W)
+        {
+            ch::ray_packet<W*H> Packet;
+            for (int Lane = 0; Lane < W*H; ++Lane)
+            {
+                v3 D = PixelDirection(Camera, X + Lane % W, Y + Lane / W, Size);
+                Packet.OX[Lane] = Camera->P.X; Packet.OY[Lane] = Camera->P.Y; Packet.OZ[Lane] = Camera->P.Z;
+                Packet.DX[Lane] = D.X; Packet.DY[Lane] = D.Y; Packet.DZ[Lane] = D.Z;
+                Packet.TMin[Lane] = 0.0f;
+                Packet.TMax[Lane] = F32Max;
+            }
+            
+            if (AnyHit)
+            {
+                bool Occluded[W*H];
+                BVH->Occluded(&Packet, Occluded);
+                for (int Lane = 0; Lane < W*H; ++Lane) HitCount += Occluded[Lane]? 1: 0;
+            }
+            else
+            {
+                ch::hit Hits[W*H];
+                BVH->Intersect(&Packet, Hits);
+                for (int Lane = 0; Lane < W*H; ++Lane) HitCount += Hits[Lane].TriangleIndex != -1? 1: 0;
+            }
+        }
+    }
+    *HitCount_Out = HitCount;
+    return GetSeconds() - Begin;
+}
+
+static f64
+TraceSingle(ch::bvh *BVH, camera *Camera, int Size, bool AnyHit, int *HitCount_Out)
+{
+    int HitCount = 0;
+    f64 Begin = GetSeconds();
+    for (int Y = 0; Y < Size; ++Y)
+    {
+        for (int X = 0; X < Size; ++X)
+        {
+            ch::ray Ray = ch::Ray(Camera->P, PixelDirection(Camera, X, Y, Size));
+            if (AnyHit)
+            {
+                HitCount += BVH->Occluded(Ray)? 1: 0;
+            }
+            else
+            {
+                ch::hit Hit;
+                HitCount += BVH->Intersect(Ray, &Hit)? 1: 0;
+            }
+        }
+    }
+    *HitCount_Out = HitCount;
+    return GetSeconds() - Begin;
+}
+
+int main(int ArgCount, char **Args)
+{
+    ch_obj::Model Model = {};
+    if (ArgCount > 1)
+    {
+        Model = ch_obj::load_model(Args[1]);
+        if (Model.is_invalid)
+        {
+            printf("%s\n", Model.e_msg);
+            return 1;
+        }
+    }
+    else
+    {
+        Model = GenerateSphere(512, 1024);
+    }
+    printf("triangles: %d\n", Model.ib_count / 3);
+    
+    int MaxThreads = int(std::thread::hardware_concurrency());
+    if (MaxThreads <= 0) MaxThreads = 1;
+    
+    ch::bvh BVH = {};
+    for (int ThreadCount = 1; ThreadCount <= MaxThreads; ThreadCount *= 2)
+    {
+        BVH.Free();
+        f64 Begin = GetSeconds();
+        BVH = ch::BuildBVH(&Model, ThreadCount);
+        printf("build (%2d threads): %8.2f ms, %d nodes\n", ThreadCount,
+               1000.0 * (GetSeconds() - Begin), BVH.NodeCount);
+    }
+    
+    v3 BoundsMin = BVH.Nodes[0].Min;
+    v3 BoundsMax = BVH.Nodes[0].Max;
+    v3 Center = 0.5f * (BoundsMin + BoundsMax);
+    f32 Radius = 0.5f * Len(BoundsMax - BoundsMin);
+    
+    camera Camera = {};
+    Camera.P = Center - V3(0.0f, 0.0f, 2.5f * Radius);
+    Camera.Forward = ZAxis();
+    Camera.Right = 0.5f * XAxis();
+    Camera.Up = 0.5f * YAxis();
+    
+    int Size = 1024;
+    f64 RayCount = f64(Size) * f64(Size);
+    for (int AnyHit = 0; AnyHit <= 1; ++AnyHit)
+    {
+        const char *Kind = AnyHit? "any-hit    ": "closest-hit";
+        int Hits = 0;
+        f64 Time = TraceSingle(&BVH, &Camera, Size, AnyHit != 0, &Hits);
+        printf("%s single   : %8.2f Mrays/s (%d hits)\n", Kind, RayCount / Time / 1e6, Hits);
+        Time = TracePackets<2, 2>(&BVH, &Camera, Size, AnyHit != 0, &Hits);
+        printf("%s packet x4: %8.2f Mrays/s (%d hits)\n", Kind, RayCount / Time / 1e6, Hits);
+        Time = TracePackets<4, 2>(&BVH, &Camera, Size, AnyHit != 0, &Hits);
+        printf("%s packet x8: %8.2f Mrays/s (%d hits)\n", Kind, RayCount / Time / 1e6, Hits);
+    }
+    
+    BVH.Free();
+    return 0;
+}
\ No newline at end of file
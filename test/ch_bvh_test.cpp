@@ -0,0 +1,145 @@
+#include "../ch_bvh.h"
+#include <assert.h>
+#include <stdio.h>
+
+static f32
+RandomF32(u32 *State)
+{
+    *State ^= *State << 13;
+    *State ^= *State >> 17;
+    *State ^= *State << 5;
+    return f32(*State & 0xFFFFFF) / f32(0xFFFFFF);
+}
+
+static v3
+RandomV3(u32 *State)
+{
+    return V3(RandomF32(State), RandomF32(State), RandomF32(State));
+}
+
+// triangle soup, each triangle owns its 3 vertices
+static ch_obj::Model
+RandomModel(int TriCount, u32 *State)
+{
+    ch_obj::Model Model = {};
+    Model.vb_count = 9 * TriCount;
+    Model.vb = (float *)malloc(sizeof(float) * Model.vb_count);
+    Model.ib_count = 3 * TriCount;
+    Model.ib = (int *)malloc(sizeof(int) * 3 * Model.ib_count);
+    
+    for (int TriI = 0; TriI < TriCount; ++TriI)
+    {
+        v3 Center = 10.0f * RandomV3(State);
+        for (int VI = 0; VI < 3; ++VI)
+        {
+            v3 P = Center + RandomV3(State) - V3(0.5f);
+            int Index = 3 * TriI + VI;
+            Model.vb[3*Index + 0] = P.X;
+            Model.vb[3*Index + 1] = P.Y;
+            Model.vb[3*Index + 2] = P.Z;
+            Model.ib[3*Index + 0] = Index;
+            Model.ib[3*Index + 1] = -1;
+            Model.ib[3*Index + 2] = -1;
+        }
+    }
+    
+    return Model;
+}
+
+static ch::hit
+BruteForce(ch_obj::Model *Model, ch::ray Ray)
+{
+    ch::hit Hit = {};
+    Hit.TriangleIndex = -1;
+    
+    v3 *Positions = (v3 *)Model->vb;
+    for (int TriI = 0; TriI < Model->ib_count / 3; ++TriI)
+    {
+        ch::bvh_triangle Tri = {};
+        Tri.V0 = Positions[Model->ib[9*TriI + 0]];
+        Tri.E1 = Positions[Model->ib[9*TriI + 3]] - Tri.V0;
+        Tri.E2 = Positions[Model->ib[9*TriI + 6]] - Tri.V0;
+        
+        f32 T, U, V;
+        if (ch::IntersectTriangle(&Ray, &Tri, &T, &U, &V))
+        {
+            Ray.TMax = T;
+            Hit.T = T;
+            Hit.TriangleIndex = TriI;
+        }
+    }
+    
+    return Hit;
+}
+
+int main()
+{
+    u32 State = 0x12345;
+    ch_obj::Model Model = RandomModel(2000, &State);
+    
+    for (int ThreadCount = 1; ThreadCount <= 4; ThreadCount *= 2)
+    {
+        ch::bvh BVH = ch::BuildBVH(&Model, ThreadCount);
+        assert(BVH.NodeCount <= 2 * BVH.TriangleCount);
+        assert(sizeof(ch::bvh_node) == 32);
+        
+        int HitCount = 0;
+        for (int RayI = 0; RayI < 512; RayI += 8)
+        {
+            ch::ray_packet8 Packet = {};
+            ch::ray_packet4 Packet4 = {};
+            ch::hit Expected[8];
+            for (int Lane = 0; Lane < 8; ++Lane)
+            {
+                v3 O = V3(-5.0f) + 20.0f * RandomV3(&State);
+                v3 D = Normalize(V3(5.0f) + 2.0f * RandomV3(&State) - O);
+                ch::ray Ray = ch::Ray(O, D);
+                
+                Expected[Lane] = BruteForce(&Model, Ray);
+                
+                ch::hit Hit;
+                bool DidHit = BVH.Intersect(Ray, &Hit);
+                assert(DidHit == (Expected[Lane].TriangleIndex != -1));
+                assert(Hit.TriangleIndex == Expected[Lane].TriangleIndex);
+                assert(BVH.Occluded(Ray) == DidHit);
+                HitCount += DidHit? 1: 0;
+                
+                Packet.OX[Lane] = O.X; Packet.OY[Lane] = O.Y; Packet.OZ[Lane] = O.Z;
+                Packet.DX[Lane] = D.X; Packet.DY[Lane] = D.Y; Packet.DZ[Lane] = D.Z;
+                Packet.TMin[Lane] = 0.0f;
+                Packet.TMax[Lane] = F32Max;
+                if (Lane < 4)
+                {
+                    Packet4.OX[Lane] = O.X; Packet4.OY[Lane] = O.Y; Packet4.OZ[Lane] = O.Z;
+                    Packet4.DX[Lane] = D.X; Packet4.DY[Lane] = D.Y; Packet4.DZ[Lane] = D.Z;
+                    Packet4.TMin[Lane] = 0.0f;
+                    Packet4.TMax[Lane] = F32Max;
+                }
+            }
+            
+            ch::hit Hits[8];
+            bool Occluded[8];
+            BVH.Intersect(&Packet, Hits);
+            BVH.Occluded(&Packet, Occluded);
+            for (int Lane = 0; Lane < 8; ++Lane)
+            {
+                assert(Hits[Lane].TriangleIndex == Expected[Lane].TriangleIndex);
+                assert(Occluded[Lane] == (Expected[Lane].TriangleIndex != -1));
+            }
+            
+            BVH.Intersect(&Packet4, Hits);
+            BVH.Occluded(&Packet4, Occluded);
+            for (int Lane = 0; Lane < 4; ++Lane)
+            {
+                assert(Hits[Lane].TriangleIndex == Expected[Lane].TriangleIndex);
+                assert(Occluded[Lane] == (Expected[Lane].TriangleIndex != -1));
+            }
+        }
+        assert(HitCount > 0);
+        
+        BVH.Free();
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
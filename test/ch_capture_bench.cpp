@@ -0,0 +1,82 @@
+#include "../ch_capture.h"
+#include <stdio.h>
+#include <vector>
+
+/*
+usage: ch_capture_bench [frame count]
+
+Pretends to be a 60 fps render loop at 1920x1080 that captures every frame, once
+per format. Prints how long SubmitCaptureFrame held up the render thread (average
+and worst), how long the writer took per frame and how many frames got dropped.
+Frames are written to the working directory and deleted afterwards.
+*/
+
+int main(int ArgCount, char **Args)
+{
+    int FrameCount = ArgCount > 1? atoi(Args[1]): 120;
+    int Width = 1920, Height = 1080;
+    
+    // something between a flat clear and noise, like a real frame
+    std::vector<u32> Pixels((size_t)Width * Height);
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        for (int X = 0; X < Width; ++X)
+        {
+            u32 Noise = ((u32)(X * 2654435761u) ^ (u32)(Y * 40503u)) & 0x070707;
+            Pixels[(size_t)Y * Width + X] = ((X / 64 + Y / 64) & 1)? 0xFF202020: (0xFF000000 | (X & 0xFF) | ((Y & 0xFF) << 8) | Noise);
+        }
+    }
+    
+    const char *FormatNames[3] = {"bmp", "qoi", "png"};
+    const ch::capture_policy Policies[2] = {ch::CapturePolicy_Block, ch::CapturePolicy_DropOldest};
+    const char *PolicyNames[2] = {"block", "drop oldest"};
+    for (int Format = ch::CaptureFormat_BMP; Format <= ch::CaptureFormat_PNG; ++Format)
+    {
+        for (int PolicyI = 0; PolicyI < 2; ++PolicyI)
+        {
+            ch::capture_queue Queue;
+            ch::InitCaptureQueue(&Queue, Width, Height, 4, Policies[PolicyI], (ch::capture_format)Format);
+            
+            f64 FrameTime = 1.0 / 60.0;
+            f64 TotalSubmit = 0.0, MaxSubmit = 0.0;
+            f64 Start = ch::GetCaptureSeconds();
+            for (int FrameI = 0; FrameI < FrameCount; ++FrameI)
+            {
+                char Path[64];
+                snprintf(Path, sizeof(Path), "ch_capture_bench_%03d.%s", FrameI % 8, FormatNames[Format]);
+                
+                f64 Begin = ch::GetCaptureSeconds();
+                ch::SubmitCaptureFrame(&Queue, Path, Pixels.data(), Width, Height, (size_t)Width * 4);
+                f64 Submit = ch::GetCaptureSeconds() - Begin;
+                TotalSubmit += Submit;
+                MaxSubmit = Submit > MaxSubmit? Submit: MaxSubmit;
+                
+                // rest of the frame
+                f64 Deadline = Start + FrameTime * (FrameI + 1);
+                while (ch::GetCaptureSeconds() < Deadline)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+            ch::FreeCaptureQueue(&Queue);
+            
+            ch::capture_stats *Stats = &Queue.Stats;
+            printf("%s, %-11s submit %6.2f ms avg %6.2f ms max | write %6.2f ms avg %6.2f ms max | "
+                   "%3llu dropped, max depth %d, %.1f MB/frame\n",
+                   FormatNames[Format], PolicyNames[PolicyI],
+                   1000.0 * TotalSubmit / FrameCount, 1000.0 * MaxSubmit,
+                   1000.0 * Stats->TotalEncodeSeconds / f64(Stats->Written + Stats->Failed), 1000.0 * Stats->MaxEncodeSeconds,
+                   (unsigned long long)Stats->Dropped, Stats->MaxQueueDepth,
+                   f64(Stats->BytesWritten) / f64(Stats->Written) / 1e6);
+            
+            for (int I = 0; I < 8; ++I)
+            {
+                char Path[64];
+                snprintf(Path, sizeof(Path), "ch_capture_bench_%03d.%s", I, FormatNames[Format]);
+                remove(Path);
+            }
+        }
+    }
+    
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "../ch_capture.h"
+#include <assert.h>
+#include <atomic>
+#include <vector>
+
+// holds the writer inside the callback until the test opens the gate
+struct gate
+{
+    std::mutex Lock;
+    std::condition_variable Opened;
+    bool Open;
+    std::atomic<int> Entered;
+    std::vector<u64> Indices;
+    std::vector<u32> FirstPixels;
+};
+
+static bool
+GatedWrite(const ch::capture_frame *Frame, void *UserData)
+{
+    gate *Gate = (gate *)UserData;
+    Gate->Entered++;
+    std::unique_lock<std::mutex> Guard(Gate->Lock);
+    Gate->Opened.wait(Guard, [Gate]() { return Gate->Open; });
+    Gate->Indices.push_back(Frame->Index);
+    u32 Pixel;
+    memcpy(&Pixel, Frame->Pixels, 4);
+    Gate->FirstPixels.push_back(Pixel);
+    return true;
+}
+
+static void
+OpenGate(gate *Gate)
+{
+    std::unique_lock<std::mutex> Guard(Gate->Lock);
+    Gate->Open = true;
+    Gate->Opened.notify_all();
+}
+
+static void
+WaitForWriter(gate *Gate, int Count)
+{
+    while (Gate->Entered < Count)
+    {
+        std::this_thread::yield();
+    }
+}
+
+// starts a 2 frame queue with the writer stuck on frame 0 and frame 1 waiting
+static void
+FillQueue(ch::capture_queue *Queue, gate *Gate, ch::capture_policy Policy)
+{
+    assert(ch::InitCaptureQueue(Queue, 4, 4, 2, Policy));
+    Queue->WriteCallback = GatedWrite;
+    Queue->CallbackData = Gate;
+    
+    for (u32 I = 0; I < 2; ++I)
+    {
+        u32 Pixels[16] = {I};
+        assert(ch::SubmitCaptureFrame(Queue, "unused", Pixels, 4, 4, 16));
+        if (I == 0) WaitForWriter(Gate, 1);
+    }
+    ch::capture_stats Stats = ch::GetCaptureStats(Queue);
+    assert(Stats.QueueDepth == 1 && Stats.Submitted == 2);
+}
+
+int main()
+{
+    int Width = 67, Height = 35;
+    std::vector<u32> Image((size_t)Width * Height);
+    for (size_t I = 0; I < Image.size(); ++I)
+    {
+        Image[I] = (u32)(I * 2654435761u) | 0xFF000000;
+    }
+    
+    // every format, BGRA and bottom-up input, read back through ch_image
+    for (int Format = ch::CaptureFormat_BMP; Format <= ch::CaptureFormat_PNG; ++Format)
+    {
+        ch::capture_queue Queue;
+        assert(ch::InitCaptureQueue(&Queue, 128, 64, 3, ch::CapturePolicy_Block, (ch::capture_format)Format));
+        const char *Paths[4] = {"ch_capture_test0.img", "ch_capture_test1.img", "ch_capture_test2.img", "ch_capture_test3.img"};
+        for (int I = 0; I < 4; ++I)
+        {
+            ch::capture_pixel_format PixelFormat = (I & 1)? ch::CapturePixel_BGRA8: ch::CapturePixel_RGBA8;
+            assert(ch::SubmitCaptureFrame(&Queue, Paths[I], Image.data(), Width, Height, (size_t)Width * 4, PixelFormat, I >= 2));
+        }
+        ch::FlushCaptureQueue(&Queue);
+        
+        ch::capture_stats Stats = ch::GetCaptureStats(&Queue);
+        assert(Stats.Submitted == 4 && Stats.Written == 4 && Stats.Dropped == 0 && Stats.Failed == 0);
+        assert(Stats.QueueDepth == 0 && Stats.MaxQueueDepth >= 1 && Stats.MaxQueueDepth <= 3);
+        assert(Stats.TotalEncodeSeconds > 0.0 && Stats.MaxEncodeSeconds <= Stats.TotalEncodeSeconds);
+        
+        u64 TotalSize = 0;
+        for (int I = 0; I < 4; ++I)
+        {
+            size_t Size = 0;
+            u8 *File = ch::ReadFileData(Paths[I], &Size);
+            assert(File);
+            TotalSize += Size;
+            if (Format == ch::CaptureFormat_PNG)
+            {
+                assert(Size > 8 && memcmp(File, "\x89PNG", 4) == 0);
+            }
+            else
+            {
+                ch::image Decoded = ch::AllocateImage(Width, Height);
+                assert(ch::DecodeImage(File, Size, Decoded.Pixels, Decoded.Pitch));
+                for (int Y = 0; Y < Height; ++Y)
+                {
+                    for (int X = 0; X < Width; ++X)
+                    {
+                        u32 Expected = Image[(size_t)(I >= 2? Height - 1 - Y: Y) * Width + X];
+                        if (I & 1) Expected = (Expected & 0xFF00FF00) | ((Expected >> 16) & 0xFF) | ((Expected & 0xFF) << 16);
+                        u32 Pixel;
+                        memcpy(&Pixel, Decoded.Pixels + Decoded.Pitch * Y + 4 * X, 4);
+                        assert(Pixel == Expected);
+                    }
+                }
+                ch::FreeImage(&Decoded);
+            }
+            free(File);
+            remove(Paths[I]);
+        }
+        assert(Stats.BytesWritten == TotalSize);
+        
+        // too big and unwritable frames are counted, not queued
+        assert(!ch::SubmitCaptureFrame(&Queue, Paths[0], Image.data(), 129, 1, 129 * 4));
+        assert(ch::SubmitCaptureFrame(&Queue, "no/such/directory/x.img", Image.data(), 1, 1, 4));
+        ch::FlushCaptureQueue(&Queue);
+        assert(ch::GetCaptureStats(&Queue).Failed == 2);
+        ch::FreeCaptureQueue(&Queue);
+    }
+    
+    // DropNewest: the frame being captured is skipped
+    {
+        ch::capture_queue Queue;
+        gate Gate = {};
+        FillQueue(&Queue, &Gate, ch::CapturePolicy_DropNewest);
+        u32 Pixels[16] = {2};
+        assert(!ch::SubmitCaptureFrame(&Queue, "unused", Pixels, 4, 4, 16));
+        OpenGate(&Gate);
+        ch::FlushCaptureQueue(&Queue);
+        
+        ch::capture_stats Stats = ch::GetCaptureStats(&Queue);
+        assert(Stats.Written == 2 && Stats.Dropped == 1);
+        assert(Gate.FirstPixels.size() == 2 && Gate.FirstPixels[0] == 0 && Gate.FirstPixels[1] == 1);
+        
+        // cancelled frames go back to the pool
+        ch::capture_frame *Frames[2] = {ch::BeginCaptureFrame(&Queue), ch::BeginCaptureFrame(&Queue)};
+        assert(Frames[0] && Frames[1] && !ch::BeginCaptureFrame(&Queue));
+        ch::CancelCaptureFrame(&Queue, Frames[0]);
+        ch::CancelCaptureFrame(&Queue, Frames[1]);
+        assert(ch::GetCaptureStats(&Queue).Written == 2);
+        ch::FreeCaptureQueue(&Queue);
+    }
+    
+    // DropOldest: the queued frame gets replaced
+    {
+        ch::capture_queue Queue;
+        gate Gate = {};
+        FillQueue(&Queue, &Gate, ch::CapturePolicy_DropOldest);
+        u32 Pixels[16] = {2};
+        assert(ch::SubmitCaptureFrame(&Queue, "unused", Pixels, 4, 4, 16));
+        OpenGate(&Gate);
+        ch::FlushCaptureQueue(&Queue);
+        
+        ch::capture_stats Stats = ch::GetCaptureStats(&Queue);
+        assert(Stats.Written == 2 && Stats.Dropped == 1);
+        assert(Gate.FirstPixels.size() == 2 && Gate.FirstPixels[0] == 0 && Gate.FirstPixels[1] == 2);
+        assert(Gate.Indices[1] == 2);
+        ch::FreeCaptureQueue(&Queue);
+    }
+    
+    // Block: the producer waits for the writer, nothing is lost
+    {
+        ch::capture_queue Queue;
+        gate Gate = {};
+        FillQueue(&Queue, &Gate, ch::CapturePolicy_Block);
+        
+        std::atomic<bool> Submitted(false);
+        std::thread Producer([&]()
+                             {
+                                 u32 Pixels[16] = {2};
+                                 bool Result = ch::SubmitCaptureFrame(&Queue, "unused", Pixels, 4, 4, 16);
+                                 assert(Result);
+                                 Submitted = true;
+                             });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        assert(!Submitted);
+        OpenGate(&Gate);
+        Producer.join();
+        
+        ch::FreeCaptureQueue(&Queue); // writes what's left
+        assert(Queue.Stats.Written == 3 && Queue.Stats.Dropped == 0 && Queue.Stats.BlockedSeconds > 0.0);
+        assert(Gate.Indices.size() == 3 && Gate.Indices[0] == 0 && Gate.Indices[1] == 1 && Gate.Indices[2] == 2);
+        assert(Gate.FirstPixels[2] == 2);
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
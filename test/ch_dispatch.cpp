@@ -0,0 +1,121 @@
+#include "../ch_simd.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+The runtime dispatch of the CMake build: every test and benchmark is built once per
+ISA level (ch_bc_bench_sse2, ch_bc_bench_avx2, ...) and ch_bc_bench is this launcher,
+compiled for the baseline with CH_DISPATCH_TARGET "ch_bc_bench" and
+CH_DISPATCH_VARIANTS "sse2,avx2,avx512". It runs the highest variant the CPU
+supports, with the same arguments, from its own directory.
+
+CH_ISA=<variant> in the environment forces one, the launcher exits with 77 (what
+CTest takes as skipped) when the CPU can't run it. "scalar" variants are built
+with CH_NO_SIMD and always run.
+*/
+
+#ifndef CH_DISPATCH_TARGET
+#error CH_DISPATCH_TARGET is the name of the executable to dispatch to
+#endif
+
+#ifndef CH_DISPATCH_VARIANTS
+#error CH_DISPATCH_VARIANTS is the ,-separated list of variants that were built
+#endif
+
+static ch::simd_isa
+GetVariantISA(const char *Variant)
+{
+    if (strcmp(Variant, "avx512") == 0) return ch::SIMDISA_AVX512;
+    if (strcmp(Variant, "avx2") == 0) return ch::SIMDISA_AVX2;
+    if (strcmp(Variant, "sse2") == 0) return ch::SIMDISA_SSE2;
+    return ch::SIMDISA_None;
+}
+
+static bool
+HasVariant(const char *Variant)
+{
+    size_t Length = strlen(Variant);
+    for (const char *At = CH_DISPATCH_VARIANTS; *At;)
+    {
+        const char *End = strchr(At, ',');
+        size_t Size = End? size_t(End - At): strlen(At);
+        if (Size == Length && strncmp(At, Variant, Length) == 0) return true;
+        At += Size + (End? 1: 0);
+    }
+    return false;
+}
+
+int main(int, char **Args)
+{
+    ch::simd_isa Supported = ch::GetSupportedISA();
+    const char *Variant = getenv("CH_ISA");
+    if (Variant && *Variant)
+    {
+        if (!HasVariant(Variant))
+        {
+            fprintf(stderr, "%s: no %s variant was built (%s)\n", CH_DISPATCH_TARGET, Variant, CH_DISPATCH_VARIANTS);
+            return 77;
+        }
+        if (GetVariantISA(Variant) > Supported)
+        {
+            fprintf(stderr, "%s: this CPU can't run %s (up to %s)\n", CH_DISPATCH_TARGET, Variant, ch::GetISAName(Supported));
+            return 77;
+        }
+    }
+    else
+    {
+        static const char *Preferred[] = {"avx512", "avx2", "sse2", "generic", "scalar"};
+        Variant = 0;
+        for (int I = 0; I < 5 && !Variant; ++I)
+        {
+            if (HasVariant(Preferred[I]) && GetVariantISA(Preferred[I]) <= Supported) Variant = Preferred[I];
+        }
+        if (!Variant)
+        {
+            fprintf(stderr, "%s: this CPU can't run any of %s\n", CH_DISPATCH_TARGET, CH_DISPATCH_VARIANTS);
+            return 1;
+        }
+    }
+    
+    // the variant sits next to the launcher
+    char Self[4096];
+    snprintf(Self, sizeof(Self), "%s", Args[0]);
+#if defined(_WIN32)
+    GetModuleFileNameA(0, Self, sizeof(Self));
+    const char *Extension = ".exe";
+#else
+#if defined(__linux__)
+    ssize_t SelfLength = readlink("/proc/self/exe", Self, sizeof(Self) - 1);
+    if (SelfLength > 0) Self[SelfLength] = 0;
+#endif
+    const char *Extension = "";
+#endif
+    const char *Slash = strrchr(Self, '/');
+    const char *Backslash = strrchr(Self, '\\');
+    if (!Slash || (Backslash && Backslash > Slash)) Slash = Backslash;
+    int DirectoryLength = Slash? int(Slash - Self + 1): 0;
+    char Path[4096 + 256];
+    snprintf(Path, sizeof(Path), "%.*s%s_%s%s", DirectoryLength, Self, CH_DISPATCH_TARGET, Variant, Extension);
+    
+    Args[0] = Path;
+#ifdef _WIN32
+    intptr_t Result = _spawnv(_P_WAIT, Path, Args);
+#else
+    execv(Path, Args);
+    int Result = -1;
+#endif
+    if (Result == -1)
+    {
+        fprintf(stderr, "%s: can't run %s\n", CH_DISPATCH_TARGET, Path);
+        return 1;
+    }
+    return (int)Result;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "../kernel.h"
+#include "../ch_gl_block.h"
+#include "ch_gl_mock.h"
+
+struct object_data
+{
+    mat4 Model;
+    v3 Color;
+    f32 Roughness;
+    v3 Lights[4];
+};
+
+struct mixed_data
+{
+    f32 A;
+    f32 Weights[3];
+    v2 B;
+    mat3 Normal;
+    i32 Flags;
+};
+
+struct double_data
+{
+    f32 X;
+    f64 D[3];
+};
+
+int main()
+{
+    ch::gl_block_member ObjectMembers[] =
+    {
+        CH_GL_MEMBER(object_data, Model, GL_FLOAT_MAT4),
+        CH_GL_MEMBER(object_data, Color, GL_FLOAT_VEC3),
+        CH_GL_MEMBER(object_data, Roughness, GL_FLOAT),
+        CH_GL_MEMBER_ARRAY(object_data, Lights, GL_FLOAT_VEC3, 4),
+    };
+    ch::gl_block_member MixedMembers[] =
+    {
+        CH_GL_MEMBER(mixed_data, A, GL_FLOAT),
+        CH_GL_MEMBER_ARRAY(mixed_data, Weights, GL_FLOAT, 3),
+        CH_GL_MEMBER(mixed_data, B, GL_FLOAT_VEC2),
+        CH_GL_MEMBER(mixed_data, Normal, GL_FLOAT_MAT3),
+        CH_GL_MEMBER(mixed_data, Flags, GL_INT),
+    };
+    ch::gl_block_member DoubleMembers[] =
+    {
+        CH_GL_MEMBER(double_data, X, GL_FLOAT),
+        CH_GL_MEMBER(double_data, D, GL_DOUBLE_VEC3),
+    };
+    
+    // std140 and std430 offsets, worked out by hand from the GLSL spec's rules
+    {
+        ch::gl_block_layout Layout = ch::BuildBlockLayout(ObjectMembers, 4, ch::GL_BLOCK_STD140);
+        assert(ObjectMembers[0].Offset == 0 && ObjectMembers[0].MatrixStride == 16);
+        assert(ObjectMembers[1].Offset == 64);
+        assert(ObjectMembers[2].Offset == 76);
+        assert(ObjectMembers[3].Offset == 80 && ObjectMembers[3].ArrayStride == 16);
+        assert(Layout.Size == 144 && Layout.Alignment == 16);
+    }
+    {
+        ch::gl_block_layout Layout = ch::BuildBlockLayout(MixedMembers, 5, ch::GL_BLOCK_STD140);
+        assert(MixedMembers[0].Offset == 0);
+        assert(MixedMembers[1].Offset == 16 && MixedMembers[1].ArrayStride == 16);
+        assert(MixedMembers[2].Offset == 64);
+        assert(MixedMembers[3].Offset == 80 && MixedMembers[3].MatrixStride == 16);
+        assert(MixedMembers[4].Offset == 128);
+        assert(Layout.Size == 144);
+    }
+    {
+        ch::gl_block_layout Layout = ch::BuildBlockLayout(MixedMembers, 5, ch::GL_BLOCK_STD430);
+        assert(MixedMembers[0].Offset == 0);
+        assert(MixedMembers[1].Offset == 4 && MixedMembers[1].ArrayStride == 4);
+        assert(MixedMembers[2].Offset == 16);
+        assert(MixedMembers[3].Offset == 32 && MixedMembers[3].MatrixStride == 16);
+        assert(MixedMembers[4].Offset == 80);
+        assert(Layout.Size == 96 && Layout.Alignment == 16);
+    }
+    {
+        ch::gl_block_layout Layout = ch::BuildBlockLayout(DoubleMembers, 2, ch::GL_BLOCK_STD430);
+        assert(DoubleMembers[1].Offset == 32);
+        assert(Layout.Size == 64 && Layout.Alignment == 32);
+    }
+    
+    // packing: padded arrays, transposed matrices, padding left alone
+    {
+        ch::gl_block_layout Layout = ch::BuildBlockLayout(MixedMembers, 5, ch::GL_BLOCK_STD140);
+        mixed_data Data = {};
+        Data.A = 1.0f;
+        Data.Weights[0] = 2.0f;
+        Data.Weights[1] = 3.0f;
+        Data.Weights[2] = 4.0f;
+        Data.B = V2(5.0f, 6.0f);
+        for (int Row = 0; Row < 3; ++Row)
+        {
+            for (int Column = 0; Column < 3; ++Column) Data.Normal.Data[Row][Column] = f32(10 * Row + Column);
+        }
+        Data.Flags = 7;
+        
+        u8 Packed[144];
+        memset(Packed, 0xCD, sizeof(Packed));
+        ch::PackBlock(&Layout, &Data, Packed);
+        f32 F;
+        memcpy(&F, Packed + 0, 4); assert(F == 1.0f);
+        memcpy(&F, Packed + 16, 4); assert(F == 2.0f);
+        memcpy(&F, Packed + 32, 4); assert(F == 3.0f);
+        memcpy(&F, Packed + 48, 4); assert(F == 4.0f);
+        memcpy(&F, Packed + 68, 4); assert(F == 6.0f);
+        for (int Column = 0; Column < 3; ++Column)
+        {
+            for (int Row = 0; Row < 3; ++Row)
+            {
+                memcpy(&F, Packed + 80 + 16 * Column + 4 * Row, 4);
+                assert(F == Data.Normal.Data[Row][Column]);
+            }
+        }
+        i32 Flags;
+        memcpy(&Flags, Packed + 128, 4);
+        assert(Flags == 7);
+        assert(Packed[4] == 0xCD && Packed[92] == 0xCD && Packed[132] == 0xCD);
+        
+        // column major sources go as they are
+        Layout.TransposeMatrices = false;
+        ch::PackBlock(&Layout, &Data, Packed);
+        memcpy(&F, Packed + 80 + 16, 4);
+        assert(F == Data.Normal.Data[1][0]);
+    }
+    
+    // the GLSL declaration
+    {
+        ch::gl_block_layout Layout = ch::BuildBlockLayout(ObjectMembers, 4, ch::GL_BLOCK_STD140);
+        char Declaration[512];
+        assert(ch::WriteBlockGLSL(&Layout, "ObjectData", 2, Declaration, sizeof(Declaration)));
+        assert(strcmp(Declaration,
+                      "layout(std140, binding = 2) uniform ObjectData\n{\n"
+                      "    mat4 Model;\n    vec3 Color;\n    float Roughness;\n    vec3 Lights[4];\n};\n") == 0);
+        Layout.Packing = ch::GL_BLOCK_STD430;
+        assert(ch::WriteBlockGLSL(&Layout, "Objects", 0, Declaration, sizeof(Declaration)));
+        assert(strncmp(Declaration, "layout(std430, binding = 0) buffer Objects\n", 43) == 0);
+        assert(!ch::WriteBlockGLSL(&Layout, "Objects", 0, Declaration, 40));
+    }
+    
+    // the ring: aligned sub-allocations per frame, fences per segment
+    {
+        MockGLReset();
+        GetMockGL().Integers[GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT] = 256;
+        LoadGLFunctions(MockGLLoad);
+        
+        ch::gl_block_layout Layout = ch::BuildBlockLayout(ObjectMembers, 4, ch::GL_BLOCK_STD140);
+        ch::gl_block_ring Ring = ch::CreateBlockRing(GL_UNIFORM_BUFFER, 3 * 1024 + 100);
+        assert(Ring.Alignment == 256 && Ring.RegionSize == 1024 && Ring.Size == 3072);
+        mock_gl_buffer *Buffer = MockGLFindBuffer(Ring.Buffer);
+        assert(Buffer && Buffer->Storage.size() == 3072 && Buffer->Mapped);
+        assert(Buffer->Flags == (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
+        
+        object_data Objects[2] = {};
+        Objects[0].Model = Mat4Identity();
+        Objects[0].Roughness = 0.5f;
+        Objects[1].Lights[3] = V3(1.0f, 2.0f, 3.0f);
+        
+        ch::BeginBlockFrame(&Ring);
+        ch::gl_block_range Ranges[5];
+        for (int I = 0; I < 5; ++I) Ranges[I] = ch::PushBlock(&Ring, &Layout, &Objects[I % 2]);
+        for (int I = 0; I < 4; ++I)
+        {
+            assert(Ranges[I].Data && Ranges[I].Offset == 256 * I && Ranges[I].Size == 144);
+            ch::BindBlockRange(&Ring, Ranges[I], 1);
+        }
+        assert(!Ranges[4].Data && Ring.FailedCount == 1);
+        ch::BindBlockRange(&Ring, Ranges[4], 1);
+        assert(GetMockGL().BindRanges.size() == 4);
+        assert(GetMockGL().BindRanges[3].Target == GL_UNIFORM_BUFFER && GetMockGL().BindRanges[3].Index == 1);
+        assert(GetMockGL().BindRanges[3].Buffer == Ring.Buffer && GetMockGL().BindRanges[3].Offset == 768);
+        f32 F;
+        memcpy(&F, Buffer->Storage.data() + 256 * 2 + 76, 4);
+        assert(F == 0.5f);
+        memcpy(&F, Buffer->Storage.data() + 256 * 3 + 80 + 3 * 16 + 8, 4);
+        assert(F == 3.0f);
+        ch::EndBlockFrame(&Ring);
+        
+        // an array of blocks in one range
+        ch::BeginBlockFrame(&Ring);
+        ch::gl_block_range Both = ch::PushBlock(&Ring, &Layout, Objects, 2);
+        assert(Both.Offset == 1024 && Both.Size == 288);
+        memcpy(&F, Buffer->Storage.data() + 1024 + 144 + 80 + 3 * 16 + 4, 4);
+        assert(F == 2.0f);
+        ch::EndBlockFrame(&Ring);
+        
+        ch::BeginBlockFrame(&Ring);
+        assert(ch::AllocateBlock(&Ring, 16).Offset == 2048);
+        ch::EndBlockFrame(&Ring);
+        assert(MockGLCalls("glClientWaitSync") == 0);
+        
+        // back to the first segment: waits on frame 0's fence, which is still busy twice
+        GetMockGL().PendingSyncs[1] = 2;
+        ch::BeginBlockFrame(&Ring);
+        assert(MockGLCalls("glClientWaitSync") == 3 && Ring.WaitCount == 1);
+        assert(ch::AllocateBlock(&Ring, 16).Offset == 0);
+        ch::EndBlockFrame(&Ring);
+        ch::BeginBlockFrame(&Ring);
+        assert(Ring.WaitCount == 1);
+        ch::EndBlockFrame(&Ring);
+        
+        GLuint BufferId = Ring.Buffer;
+        ch::DestroyBlockRing(&Ring);
+        assert(GetMockGL().LiveSyncs == 0);
+        assert(!MockGLFindBuffer(BufferId));
+        assert(MockGLCalls("glUnmapBuffer") == 1);
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "../kernel.h"
+#include "../ch_gl_command.h"
+#include "ch_gl_mock.h"
+#include <thread>
+#include <vector>
+
+static ch::gl_command_buffer *
+Replayable(ch::gl_command_buffer *Buffer)
+{
+    ch::EndGLCommandBuffer(Buffer);
+    return Buffer;
+}
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    ch::gl_state_cache *Cache = ch::GetGLStateCache();
+    ch::gl_command_replay Replay = {};
+    
+    // keys order pass, then program, material and depth
+    {
+        assert(ch::MakeGLSortKey(1, 0, 0, 0.0f) > ch::MakeGLSortKey(0, 0xFFFF, 0xFFFF, 1e30f));
+        assert(ch::MakeGLSortKey(0, 2, 0, 0.0f) > ch::MakeGLSortKey(0, 1, 0xFFFF, 1e30f));
+        assert(ch::MakeGLSortKey(0, 1, 2, 0.0f) > ch::MakeGLSortKey(0, 1, 1, 1e30f));
+        assert(ch::MakeGLSortKey(0, 1, 1, 2.0f) > ch::MakeGLSortKey(0, 1, 1, 1.0f));
+        assert(ch::MakeGLSortKey(0, 1, 1, 0.5f) > ch::MakeGLSortKey(0, 1, 1, 0.25f));
+        assert(ch::MakeGLSortKey(0, 1, 1, -1.0f) == ch::MakeGLSortKey(0, 1, 1, 0.0f));
+    }
+    
+    // every command reaches the driver with its arguments, nothing does while recording
+    {
+        ch::gl_command_buffer *Buffer = ch::CreateGLCommandBuffer();
+        GLuint Target = 0;
+        glGenBuffers(1, &Target);
+        glBindBuffer(GL_ARRAY_BUFFER, Target);
+        glBufferData(GL_ARRAY_BUFFER, 64, 0, GL_DYNAMIC_DRAW);
+        ch::InvalidateGLState();
+        int CallsBefore = int(GetMockGL().Calls.size());
+        
+        f32 Matrix[16];
+        for (int I = 0; I < 16; ++I) Matrix[I] = f32(I);
+        i32 Sampler = 3;
+        u8 Bytes[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+        ch::BeginGLPacket(Buffer, 0);
+        ch::RecordGLUseProgram(Buffer, 7);
+        ch::RecordGLBindVertexArray(Buffer, 8);
+        ch::RecordGLBindTexture(Buffer, GL_TEXTURE2, GL_TEXTURE_2D, 9);
+        ch::RecordGLBindBufferRange(Buffer, GL_UNIFORM_BUFFER, 1, 10, 256, 128);
+        ch::RecordGLUniform(Buffer, 4, GL_FLOAT_MAT4, Matrix);
+        ch::RecordGLUniform(Buffer, 5, GL_SAMPLER_2D, &Sampler);
+        ch::RecordGLBufferData(Buffer, Target, 16, sizeof(Bytes), Bytes);
+        ch::RecordGLDrawArrays(Buffer, GL_TRIANGLES, 3, 6);
+        ch::RecordGLDrawElements(Buffer, GL_TRIANGLES, 36, GL_UNSIGNED_INT, 64, 100);
+        ch::RecordGLDrawElements(Buffer, GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, 0, 0, 50);
+        ch::RecordGLDrawArrays(Buffer, GL_POINTS, 0, 1, 4);
+        memset(Matrix, 0, sizeof(Matrix)); // copied when recorded
+        memset(Bytes, 0, sizeof(Bytes));
+        assert(int(GetMockGL().Calls.size()) == CallsBefore && Buffer->CommandCount == 11);
+        
+        ch::gl_command_buffer *Buffers[] = {Replayable(Buffer)};
+        ch::ReplayGLCommandBuffers(&Replay, Buffers, 1);
+        mock_gl &GL = GetMockGL();
+        assert(Replay.PacketCount == 1 && Replay.CommandCount == 11 && Replay.DrawCount == 4);
+        assert(GL.CurrentProgram == 7 && GL.CurrentVAO == 8 && GL.ActiveTexture == GL_TEXTURE2);
+        assert(GL.Textures[std::make_pair(GLenum(GL_TEXTURE2), GLenum(GL_TEXTURE_2D))] == 9);
+        assert(GL.BindRanges.size() == 1 && GL.BindRanges[0].Index == 1 && GL.BindRanges[0].Buffer == 10);
+        assert(GL.BindRanges[0].Offset == 256 && GL.BindRanges[0].Size == 128);
+        assert(ch::GetGLBuffer(GL_UNIFORM_BUFFER) == 10 && MockGLBinding(GL_UNIFORM_BUFFER) == 10);
+        
+        assert(GL.Uploads.size() == 2);
+        assert(GL.Uploads[0].Function == "glUniformMatrix4fv" && GL.Uploads[0].Location == 4 && GL.Uploads[0].Transpose == GL_TRUE);
+        for (int I = 0; I < 16; ++I) Matrix[I] = f32(I);
+        assert(memcmp(GL.Uploads[0].Bytes.data(), Matrix, sizeof(Matrix)) == 0);
+        assert(GL.Uploads[1].Function == "glUniform1iv" && GL.Uploads[1].Location == 5);
+        assert(*(const i32 *)GL.Uploads[1].Bytes.data() == 3);
+        
+        const unsigned char *Stored = MockGLFindBuffer(Target)->Storage.data();
+        assert(Stored[15] == 0 && Stored[16] == 1 && Stored[31] == 16 && Stored[32] == 0);
+        assert(ch::GetGLBuffer(GL_COPY_WRITE_BUFFER) == Target);
+        
+        assert(GL.Draws.size() == 4);
+        assert(GL.Draws[0].Function == "glDrawArrays" && GL.Draws[0].First == 3 && GL.Draws[0].Count == 6);
+        assert(GL.Draws[1].Function == "glDrawElementsBaseVertex" && GL.Draws[1].IndexOffset == 64 && GL.Draws[1].BaseVertex == 100);
+        assert(GL.Draws[2].Function == "glDrawElementsInstancedBaseVertex" && GL.Draws[2].Type == GL_UNSIGNED_SHORT);
+        assert(GL.Draws[2].InstanceCount == 50);
+        assert(GL.Draws[3].Function == "glDrawArraysInstanced" && GL.Draws[3].InstanceCount == 4);
+        ch::DestroyGLCommandBuffer(Buffer);
+    }
+    
+    // sorted by key, equal keys in recording order, redundant binds elided
+    {
+        MockGLReset();
+        ch::InvalidateGLState();
+        ch::gl_command_buffer *Buffer = ch::CreateGLCommandBuffer();
+        GLuint Programs[] = {30, 10, 20, 10, 30, 20, 10};
+        for (int I = 0; I < 7; ++I)
+        {
+            ch::BeginGLPacket(Buffer, ch::MakeGLSortKey(0, Programs[I], 0, 0.0f));
+            ch::RecordGLUseProgram(Buffer, Programs[I]);
+            ch::RecordGLBindVertexArray(Buffer, 5);
+            ch::RecordGLDrawArrays(Buffer, GL_TRIANGLES, I, 3);
+        }
+        ch::gl_command_buffer *Buffers[] = {Replayable(Buffer)};
+        
+        ch::ReplayGLCommandBuffers(&Replay, Buffers, 1, false);
+        assert(MockGLCalls("glUseProgram") == 7 && MockGLCalls("glBindVertexArray") == 1);
+        for (int I = 0; I < 7; ++I) assert(GetMockGL().Draws[I].First == I);
+        
+        MockGLReset();
+        ch::InvalidateGLState();
+        u64 Elided = Cache->ElidedCount;
+        ch::ReplayGLCommandBuffers(&Replay, Buffers, 1);
+        assert(MockGLCalls("glUseProgram") == 3 && MockGLCalls("glBindVertexArray") == 1);
+        assert(Cache->ElidedCount - Elided == 4 + 6);
+        int Expected[] = {1, 3, 6, 2, 5, 0, 4};
+        for (int I = 0; I < 7; ++I) assert(GetMockGL().Draws[I].First == Expected[I]);
+        
+        // reset keeps the memory and forgets the packets
+        size_t Bytes = Buffer->ChunkBytes;
+        ch::ResetGLCommandBuffer(Buffer);
+        ch::EndGLCommandBuffer(Buffer);
+        ch::ReplayGLCommandBuffers(&Replay, Buffers, 1);
+        assert(Replay.PacketCount == 0 && Replay.DrawCount == 0 && Buffer->ChunkBytes == Bytes);
+        ch::DestroyGLCommandBuffer(Buffer);
+    }
+    
+    // commands span chunks, payloads bigger than a chunk get their own
+    {
+        MockGLReset();
+        ch::InvalidateGLState();
+        GLuint Target = 0;
+        std::vector<u8> Big(2 * CH_GL_COMMAND_CHUNK_SIZE + 5);
+        for (size_t I = 0; I < Big.size(); ++I) Big[I] = u8(I * 7);
+        
+        ch::gl_command_buffer *Buffer = ch::CreateGLCommandBuffer();
+        for (int Frame = 0; Frame < 3; ++Frame)
+        {
+            ch::ResetGLCommandBuffer(Buffer);
+            MockGLReset();
+            ch::InvalidateGLState();
+            glGenBuffers(1, &Target);
+            glBindBuffer(GL_ARRAY_BUFFER, Target);
+            glBufferData(GL_ARRAY_BUFFER, 3 * CH_GL_COMMAND_CHUNK_SIZE, 0, GL_DYNAMIC_DRAW);
+            
+            const int DrawCount = 20000;
+            for (int I = 0; I < DrawCount; ++I)
+            {
+                ch::BeginGLPacket(Buffer, u64(DrawCount - I));
+                f32 Value = f32(I);
+                ch::RecordGLUniform(Buffer, 1, GL_FLOAT, &Value);
+                ch::RecordGLDrawArrays(Buffer, GL_TRIANGLES, I, 3);
+                if (I == 5000) ch::RecordGLBufferData(Buffer, Target, 1, GLsizeiptr(Big.size()), Big.data());
+                if (I % 1000 == 0) ch::BeginGLPacket(Buffer, 0); // empty packets are fine
+            }
+            ch::gl_command_buffer *Buffers[] = {Replayable(Buffer)};
+            ch::ReplayGLCommandBuffers(&Replay, Buffers, 1);
+            
+            mock_gl &GL = GetMockGL();
+            assert(Replay.DrawCount == DrawCount && GL.Draws.size() == size_t(DrawCount));
+            for (int I = 0; I < DrawCount; ++I)
+            {
+                assert(GL.Draws[I].First == DrawCount - 1 - I);
+                assert(*(const f32 *)GL.Uploads[I].Bytes.data() == f32(DrawCount - 1 - I));
+            }
+            assert(memcmp(MockGLFindBuffer(Target)->Storage.data() + 1, Big.data(), Big.size()) == 0);
+        }
+        assert(Buffer->ChunkBytes > Big.size() + 20000 * 48);
+        assert(Buffer->ChunkBytes < 2 * (Big.size() + 20000 * 56)); // reused, not grown per frame
+        ch::DestroyGLCommandBuffer(Buffer);
+    }
+    
+    // workers record, the GL thread replays everything sorted
+    {
+        MockGLReset();
+        ch::InvalidateGLState();
+        const int WorkerCount = 4;
+        const int PerWorker = 3000;
+        ch::gl_command_buffer *Buffers[WorkerCount];
+        std::vector<std::thread> Workers;
+        for (int WorkerI = 0; WorkerI < WorkerCount; ++WorkerI)
+        {
+            Buffers[WorkerI] = ch::CreateGLCommandBuffer();
+            Workers.push_back(std::thread([&Buffers, WorkerI]()
+                                          {
+                                              ch::gl_command_buffer *Buffer = Buffers[WorkerI];
+                                              for (int I = 0; I < PerWorker; ++I)
+                                              {
+                                                  u32 Program = 1 + u32(I % 8);
+                                                  u32 Material = u32((I / 8) % 16);
+                                                  ch::BeginGLPacket(Buffer, ch::MakeGLSortKey(0, Program, Material, 0.0f));
+                                                  ch::RecordGLUseProgram(Buffer, Program);
+                                                  ch::RecordGLBindTexture(Buffer, GL_TEXTURE0, GL_TEXTURE_2D, 100 + Material);
+                                                  ch::RecordGLDrawArrays(Buffer, GL_TRIANGLES, WorkerI * PerWorker + I, 3);
+                                              }
+                                              ch::EndGLCommandBuffer(Buffer);
+                                          }));
+        }
+        for (std::thread &Worker: Workers) Worker.join();
+        
+        ch::ReplayGLCommandBuffers(&Replay, Buffers, WorkerCount);
+        assert(Replay.DrawCount == WorkerCount * PerWorker);
+        assert(MockGLCalls("glUseProgram") == 8 && MockGLCalls("glBindTexture") == 8 * 16);
+        
+        // within a key: the first buffer first, in its order
+        std::vector<mock_gl_draw> &Draws = GetMockGL().Draws;
+        for (size_t I = 1; I < Draws.size(); ++I)
+        {
+            int A = Draws[I - 1].First;
+            int B = Draws[I].First;
+            u64 KeyA = ch::MakeGLSortKey(0, 1 + u32(A % PerWorker % 8), u32((A % PerWorker / 8) % 16), 0.0f);
+            u64 KeyB = ch::MakeGLSortKey(0, 1 + u32(B % PerWorker % 8), u32((B % PerWorker / 8) % 16), 0.0f);
+            assert(KeyA < KeyB || (KeyA == KeyB && A < B));
+        }
+        for (int WorkerI = 0; WorkerI < WorkerCount; ++WorkerI) ch::DestroyGLCommandBuffer(Buffers[WorkerI]);
+    }
+    
+    ch::FreeGLCommandReplay(&Replay);
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
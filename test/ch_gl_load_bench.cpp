@@ -0,0 +1,104 @@
+#include "../ch_bench.h"
+#include "../ch_gl_load.h"
+#include <string>
+#include <vector>
+
+/*
+usage: ch_gl_load_bench [--filter text] [--repetitions n] [--seconds s] [--json out.json]
+
+Startup cost of the loading modes in ch_gl_load.h against a mock loader: each
+lookup strcmps every name in the table, the same cost for any name, standing in
+for wglGetProcAddress/glXGetProcAddress (real ones cost more, and a real driver
+returns 0 for what it doesn't have). Items are the lookups each mode makes.
+
+eager          LoadGLFunctions, all 1115 entry points
+minimal_3_3    core 3.3
+minimal_4_5    core 4.5 plus GL_ARB_bindless_texture and GL_KHR_blend_equation_advanced
+lazy           trampolines only, no lookups
+lazy_used_150  trampolines, then the first 150 core entry points resolved as if called
+*/
+
+static std::vector<std::string> DriverNames;
+static char DriverFunction;
+
+static void *
+MockDriverLoad(char *Name)
+{
+    void *Found = 0;
+    for (const std::string &DriverName: DriverNames)
+    {
+        if (strcmp(DriverName.c_str(), Name) == 0) Found = &DriverFunction;
+    }
+    return Found;
+}
+
+int main(int ArgCount, char **Args)
+{
+    ch::bench_options Options = ch::DefaultBenchOptions();
+    const char *JSONPath = 0;
+    for (int ArgI = 1; ArgI < ArgCount; ++ArgI)
+    {
+        const char *Arg = Args[ArgI];
+        const char *Value = ArgI + 1 < ArgCount? Args[ArgI + 1]: 0;
+        if (!Value)
+        {
+            printf("%s needs a value\n", Arg);
+            return 2;
+        }
+        ++ArgI;
+        if (strcmp(Arg, "--filter") == 0) Options.Filter = Value;
+        else if (strcmp(Arg, "--repetitions") == 0) Options.RepetitionCount = atoi(Value);
+        else if (strcmp(Arg, "--seconds") == 0) Options.RepetitionSeconds = atof(Value);
+        else if (strcmp(Arg, "--json") == 0) JSONPath = Value;
+        else
+        {
+            printf("unknown option %s\n", Arg);
+            return 2;
+        }
+    }
+    
+    for (int FunctionI = 0; FunctionI < ch::GL_FUNCTION_COUNT; ++FunctionI)
+    {
+        DriverNames.push_back(ch::GL_FUNCTION_ENTRIES[FunctionI].Name);
+    }
+    const char *Extensions[] = {"GL_ARB_bindless_texture", "GL_KHR_blend_equation_advanced"};
+    ch::gl_load_result Core33 = ch::LoadGLFunctionsMinimal(MockDriverLoad, 3, 3);
+    ch::gl_load_result Core45 = ch::LoadGLFunctionsMinimal(MockDriverLoad, 4, 5, Extensions, 2);
+    
+    ch::bench_suite Suite = ch::InitBenchSuite(Options);
+    const ch::bench_result *Eager = ch::RunBenchmark(&Suite, "gl_load/eager", f64(ch::GL_FUNCTION_COUNT), [&]()
+                                                     {
+                                                         LoadGLFunctions(MockDriverLoad);
+                                                     });
+    ch::RunBenchmark(&Suite, "gl_load/minimal_3_3", f64(Core33.LoadedCount), [&]()
+                     {
+                         ch::KeepValue(ch::LoadGLFunctionsMinimal(MockDriverLoad, 3, 3).LoadedCount);
+                     });
+    ch::RunBenchmark(&Suite, "gl_load/minimal_4_5", f64(Core45.LoadedCount), [&]()
+                     {
+                         ch::KeepValue(ch::LoadGLFunctionsMinimal(MockDriverLoad, 4, 5, Extensions, 2).LoadedCount);
+                     });
+    const ch::bench_result *Lazy = ch::RunBenchmark(&Suite, "gl_load/lazy", 0.0, [&]()
+                                                    {
+                                                        ch::LoadGLFunctionsLazy(MockDriverLoad);
+                                                    });
+    ch::RunBenchmark(&Suite, "gl_load/lazy_used_150", 150.0, [&]()
+                     {
+                         ch::LoadGLFunctionsLazy(MockDriverLoad);
+                         for (int FunctionI = 0; FunctionI < 150; ++FunctionI)
+                         {
+                             ch::ResolveGLFunction(FunctionI);
+                         }
+                     });
+    if (Eager && Lazy && Lazy->Median > 0.0)
+    {
+        printf("\nlazy installs %.0fx faster than eager loading\n", Eager->Median / Lazy->Median);
+    }
+    
+    if (JSONPath && !ch::WriteBenchJSON(&Suite, JSONPath))
+    {
+        printf("can't write %s\n", JSONPath);
+    }
+    ch::FreeBenchSuite(&Suite);
+    return 0;
+}
\ No newline at end of file
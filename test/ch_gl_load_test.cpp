@@ -0,0 +1,117 @@
+#include "../kernel.h"
+#include "../ch_gl_load.h"
+#include "ch_gl_mock.h"
+
+// counts lookups on the way to the mock
+static int LookupCount;
+
+static void *
+CountingLoad(char *Name)
+{
+    ++LookupCount;
+    return MockGLLoad(Name);
+}
+
+int main()
+{
+    MockGLReset();
+    
+    // the table is everything LoadGLFunctions looks up, groups cover it without gaps
+    {
+        LookupCount = 0;
+        LoadGLFunctions(CountingLoad);
+        assert(LookupCount == ch::GL_FUNCTION_COUNT && ch::GL_FUNCTION_COUNT == 1115);
+        int Next = 0;
+        for (int GroupI = 0; GroupI < ch::GL_FUNCTION_GROUP_COUNT; ++GroupI)
+        {
+            assert(ch::GL_FUNCTION_GROUPS[GroupI].First == Next);
+            Next += ch::GL_FUNCTION_GROUPS[GroupI].Count;
+        }
+        assert(Next == ch::GL_FUNCTION_COUNT);
+        assert(ch::FindGLFunctionGroup("GL_VERSION_4_5")->Major == 4);
+        assert(ch::FindGLFunctionGroup("GL_NV_path_rendering")->Major == 0);
+    }
+    
+    // minimal: core up to the version, the extensions asked for, the rest 0
+    {
+        LookupCount = 0;
+        ch::gl_load_result Result = ch::LoadGLFunctionsMinimal(CountingLoad, 3, 3);
+        int CoreCount = 0;
+        for (int GroupI = 0; GroupI < ch::GL_FUNCTION_GROUP_COUNT; ++GroupI)
+        {
+            const ch::gl_function_group *Group = &ch::GL_FUNCTION_GROUPS[GroupI];
+            if (Group->Major && (Group->Major < 3 || (Group->Major == 3 && Group->Minor <= 3))) CoreCount += Group->Count;
+        }
+        assert(LookupCount == CoreCount && CoreCount < 500);
+        assert(int(Result.LoadedCount + Result.MissingCount) == CoreCount);
+        assert(int(Result.SkippedCount) == ch::GL_FUNCTION_COUNT - CoreCount && Result.UnknownCount == 0);
+        assert(glUseProgram && glBindVertexArray && glDrawElementsBaseVertex);
+        assert(!glBufferStorage && !glCullFace == !MockGLLoad((char *)"glCullFace"));
+        
+        const char *Extensions[] = {"GL_NV_path_rendering", "GL_ARB_ES2_compatibility", "GL_VERSION_4_5"};
+        LookupCount = 0;
+        Result = ch::LoadGLFunctionsMinimal(CountingLoad, 4, 4, Extensions, 3);
+        assert(Result.UnknownCount == 2);
+        assert(LookupCount == CoreCount + 46 + 88 + 12 + 43 + 9 + 57);
+        assert(glBufferStorage && !glCreateBuffers);
+        assert(!glPathCommandsNV && Result.MissingCount > 57); // the mock has none of them
+    }
+    
+    // lazy: nothing looked up until called, then once
+    {
+        LookupCount = 0;
+        ch::LoadGLFunctionsLazy(CountingLoad);
+        assert(LookupCount == 0);
+        assert(!ch::IsGLFunctionResolved((void *)glUseProgram) && !ch::IsGLFunctionResolved((void *)glCreateProgram));
+        
+        glUseProgram(5);
+        assert(LookupCount == 1 && GetMockGL().CurrentProgram == 5);
+        assert((void *)glUseProgram == MockGLLoad((char *)"glUseProgram") && ch::IsGLFunctionResolved((void *)glUseProgram));
+        glUseProgram(6);
+        assert(LookupCount == 1 && GetMockGL().CurrentProgram == 6 && MockGLCalls("glUseProgram") == 2);
+        
+        // results and pointer arguments go through
+        GLuint Program = glCreateProgram();
+        assert(Program && MockGLFindProgram(Program) && LookupCount == 2);
+        GetMockGL().Integers[GL_MAX_UNIFORM_BLOCK_SIZE] = 65536;
+        GLint Value = 0;
+        glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &Value);
+        assert(Value == 65536 && LookupCount == 3);
+        f32 Color[3] = {0.25f, 0.5f, 1.0f};
+        glUniform3fv(4, 1, Color);
+        assert(GetMockGL().Uploads.size() == 1 && GetMockGL().Uploads[0].Location == 4);
+        assert(memcmp(GetMockGL().Uploads[0].Bytes.data(), Color, sizeof(Color)) == 0);
+        assert(!ch::IsGLFunctionResolved((void *)glDrawArrays) && LookupCount == 4);
+        
+        // every trampoline is found as its own entry
+        for (int FunctionI = 0; FunctionI < ch::GL_FUNCTION_COUNT; ++FunctionI)
+        {
+            assert(ch::FindGLTrampoline(ch::GL_FUNCTION_ENTRIES[FunctionI].Trampoline) == FunctionI);
+        }
+        assert(ch::FindGLTrampoline(MockGLLoad((char *)"glUseProgram")) == -1);
+    }
+    
+    // what the driver doesn't have: existence checks see it, calls don't crash
+    {
+        LookupCount = 0;
+        ch::LoadGLFunctionsLazy(CountingLoad);
+        assert(glPathCommandsNV && glUseProgram);
+        assert(!ch::IsGLFunctionAvailable((void *)glPathCommandsNV) && LookupCount == 1);
+        assert(ch::IsGLFunctionAvailable((void *)glUseProgram) && LookupCount == 2);
+        assert(ch::IsGLFunctionResolved((void *)glUseProgram) && !ch::IsGLFunctionResolved((void *)glPathCommandsNV));
+        
+        u64 MissingCalls = ch::GetGLLazyLoader()->MissingCalls;
+        assert(!glIsPathNV(3));
+        glPathCommandsNV(1, 0, 0, 0, GL_FLOAT, 0);
+        assert(ch::GetGLLazyLoader()->MissingCalls == MissingCalls + 2 && LookupCount == 3);
+        glPathCommandsNV(1, 0, 0, 0, GL_FLOAT, 0);
+        assert(!ch::IsGLFunctionAvailable((void *)glPathCommandsNV) && LookupCount == 3);
+        
+        // the other modes answer from the pointer
+        LoadGLFunctions(MockGLLoad);
+        assert(!ch::IsGLFunctionAvailable((void *)glPathCommandsNV) && ch::IsGLFunctionAvailable((void *)glUseProgram));
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "../kernel.h"
+#include "../ch_gl_mesh.h"
+#include "ch_gl_mock.h"
+
+static f32 CubePositions[] =
+{
+    -1, -1, -1,  1, -1, -1,  1, 1, -1,  -1, 1, -1,
+    -1, -1, 1,   1, -1, 1,   1, 1, 1,   -1, 1, 1,
+};
+
+static unsigned int CubeIndices[] =
+{
+    0, 2, 1, 0, 3, 2,  4, 5, 6, 4, 6, 7,  0, 1, 5, 0, 5, 4,
+    3, 6, 2, 3, 7, 6,  0, 4, 7, 0, 7, 3,  1, 2, 6, 1, 6, 5,
+};
+
+static f32 TrianglePositions[] = {2, 0, 0,  4, 0, 0,  3, 2, 0};
+static f32 TriangleNormals[] = {0, 0, 1,  0, 0, 1,  0, 0, 1};
+static unsigned int TriangleIndices[] = {0, 1, 2};
+
+// row major translate and uniform scale
+static void
+MakeTransform(f32 *M, f32 X, f32 Y, f32 Z, f32 Scale)
+{
+    memset(M, 0, 16 * sizeof(f32));
+    M[0] = M[5] = M[10] = Scale;
+    M[3] = X;
+    M[7] = Y;
+    M[11] = Z;
+    M[15] = 1.0f;
+}
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    ch::InvalidateGLState();
+    
+    ch::gl_mesh_registry Registry = ch::CreateGLMeshRegistry(64, 128);
+    mock_gl_buffer *Vertices = MockGLFindBuffer(Registry.VertexBuffer);
+    mock_gl_buffer *Indices = MockGLFindBuffer(Registry.IndexBuffer);
+    assert(Vertices->Storage.size() == 64 * 24 && Indices->Storage.size() == 128 * 4);
+    assert(Vertices->Flags == GL_DYNAMIC_STORAGE_BIT && GetMockGL().ElementBuffers[Registry.VertexArray] == Registry.IndexBuffer);
+    
+    // meshes pack one after the other, indices as they were
+    int Cube = 0;
+    int Triangle = 0;
+    {
+        ch_obj::Mesh Welded = {CubePositions, 0, 8, CubeIndices, 36};
+        Cube = ch::AddGLMesh(&Registry, &Welded);
+        Triangle = ch::AddGLMeshData(&Registry, TrianglePositions, TriangleNormals, 3, TriangleIndices, 3);
+        assert(Cube == 0 && Triangle == 1 && Registry.VertexCount == 11 && Registry.IndexCount == 39);
+        
+        const ch::gl_mesh_range *Range = &Registry.Meshes[Triangle];
+        assert(Range->FirstIndex == 36 && Range->IndexCount == 3 && Range->BaseVertex == 8 && Range->VertexCount == 3);
+        assert(Range->Center[0] == 3.0f && Range->Center[1] == 1.0f && Range->Center[2] == 0.0f);
+        assert(fabsf(Range->Radius - sqrtf(2.0f)) < 1e-6f);
+        assert(Registry.Meshes[Cube].Center[0] == 0.0f && fabsf(Registry.Meshes[Cube].Radius - sqrtf(3.0f)) < 1e-6f);
+        
+        const ch::gl_mesh_vertex *Stored = (const ch::gl_mesh_vertex *)Vertices->Storage.data();
+        assert(Stored[6].Position[0] == 1.0f && Stored[6].Position[2] == 1.0f && Stored[6].Normal[2] == 0.0f);
+        assert(Stored[10].Position[0] == 3.0f && Stored[10].Position[1] == 2.0f && Stored[10].Normal[2] == 1.0f);
+        const u32 *StoredIndices = (const u32 *)Indices->Storage.data();
+        assert(memcmp(StoredIndices, CubeIndices, sizeof(CubeIndices)) == 0);
+        assert(StoredIndices[36] == 0 && StoredIndices[38] == 2);
+        
+        // what doesn't fit isn't added
+        f32 Many[3 * 60] = {};
+        assert(ch::AddGLMeshData(&Registry, Many, 0, 60, TriangleIndices, 3) == -1);
+        assert(ch::AddGLMeshData(&Registry, TrianglePositions, 0, 3, CubeIndices, 90) == -1);
+        assert(Registry.FailedCount == 2 && Registry.MeshCount == 2 && Registry.VertexCount == 11);
+    }
+    
+    ch::gl_mesh_draws Draws = ch::CreateGLMeshDraws(256);
+    
+    // world spheres follow the transform
+    {
+        f32 Transform[16];
+        MakeTransform(Transform, 10.0f, 20.0f, 30.0f, 2.0f);
+        ch::PushGLMeshDraw(&Draws, &Registry, Triangle, 7, Transform, 3);
+        ch::PushGLMeshDraw(&Draws, &Registry, Cube, 8);
+        assert(Draws.Count == 2);
+        assert(Draws.Spheres[0][0] == 16.0f && Draws.Spheres[0][1] == 22.0f && Draws.Spheres[0][2] == 30.0f);
+        assert(fabsf(Draws.Spheres[0][3] - 2.0f * sqrtf(2.0f)) < 1e-5f);
+        assert(Draws.Commands[0].Count == 3 && Draws.Commands[0].FirstIndex == 36 && Draws.Commands[0].BaseVertex == 8);
+        assert(Draws.Commands[0].InstanceCount == 3 && Draws.Commands[0].BaseInstance == 7);
+        assert(Draws.Spheres[1][0] == 0.0f && Draws.Commands[1].Count == 36 && Draws.Commands[1].InstanceCount == 1);
+    }
+    
+    // culling keeps what touches the frustum, in order
+    {
+        ch::ResetGLMeshDraws(&Draws);
+        for (int I = 0; I < 100; ++I)
+        {
+            f32 Transform[16];
+            MakeTransform(Transform, f32(I * 10 - 500), 0.0f, 0.0f, 1.0f);
+            ch::PushGLMeshDraw(&Draws, &Registry, I % 2? Triangle: Cube, u32(I), Transform);
+        }
+        
+        // orthographic, x, y and z in [-50, 50]
+        f32 ViewProjection[16];
+        MakeTransform(ViewProjection, 0.0f, 0.0f, 0.0f, 1.0f / 50.0f);
+        f32 Planes[6][4];
+        ch::GetGLFrustumPlanes(Planes, ViewProjection);
+        assert(Planes[0][0] == 1.0f && Planes[0][3] == 50.0f && Planes[1][0] == -1.0f);
+        
+        // 45 to 54, the triangle placed at 50 is centered at 53 and falls out
+        u32 Kept = ch::CullGLMeshDraws(&Draws, Planes);
+        assert(Kept == 10 && Draws.Count == 10 && Draws.CulledCount == 90);
+        for (u32 DrawI = 0; DrawI < Kept; ++DrawI)
+        {
+            assert(Draws.Commands[DrawI].BaseInstance == 45 + DrawI);
+            assert(Draws.Spheres[DrawI][0] == f32((45 + int(DrawI)) * 10 - 500) + (DrawI % 2? 0.0f: 3.0f));
+        }
+        
+        // one call for all of them, the commands the GPU reads are the list's
+        int CallsBefore = MockGLCalls("glMultiDrawElementsIndirect");
+        int Uploads = MockGLCalls("glBufferData") + MockGLCalls("glBufferSubData");
+        ch::SubmitGLMeshDraws(&Registry, &Draws);
+        assert(MockGLCalls("glMultiDrawElementsIndirect") == CallsBefore + 1);
+        assert(MockGLCalls("glDrawElementsBaseVertex") == 0);
+        assert(GetMockGL().CurrentVAO == Registry.VertexArray && MockGLBinding(GL_DRAW_INDIRECT_BUFFER) == Draws.Indirect.Buffer);
+        assert(MockGLCalls("glBufferData") + MockGLCalls("glBufferSubData") == Uploads);
+        const std::vector<mock_gl_draw> &Issued = GetMockGL().Draws;
+        assert(Issued.size() == 10);
+        for (u32 DrawI = 0; DrawI < 10; ++DrawI)
+        {
+            bool IsCube = (45 + DrawI) % 2 == 0;
+            assert(Issued[DrawI].Mode == GL_TRIANGLES && Issued[DrawI].Type == GL_UNSIGNED_INT);
+            assert(Issued[DrawI].Count == (IsCube? 36: 3));
+            assert(Issued[DrawI].IndexOffset == (IsCube? 0u: 36u * 4u));
+            assert(Issued[DrawI].BaseVertex == (IsCube? 0: 8));
+            assert(Issued[DrawI].InstanceCount == 1 && Issued[DrawI].BaseInstance == 45 + DrawI);
+        }
+        
+        // the next submit writes the next region, the first is fenced until the GPU is done with it
+        assert(Draws.Indirect.Frame == 1 && GetMockGL().LiveSyncs == 1);
+        Draws.Commands[0].InstanceCount = 3;
+        ch::SubmitGLMeshDraws(&Registry, &Draws);
+        assert(Issued.size() == 20 && Issued[10].InstanceCount == 3 && Issued[11].InstanceCount == 1);
+        assert(Draws.Indirect.Frame == 2 && Draws.Indirect.WaitCount == 0);
+        assert(Draws.Indirect.Head == Draws.Indirect.RegionSize + 10 * sizeof(ch::gl_draw_elements_indirect_command));
+        
+        // an empty list draws nothing
+        ch::ResetGLMeshDraws(&Draws);
+        ch::SubmitGLMeshDraws(&Registry, &Draws);
+        assert(MockGLCalls("glMultiDrawElementsIndirect") == CallsBefore + 2);
+    }
+    
+    // a full list drops and counts
+    {
+        ch::gl_mesh_draws Small = ch::CreateGLMeshDraws(2);
+        for (int I = 0; I < 5; ++I) ch::PushGLMeshDraw(&Small, &Registry, Cube, u32(I));
+        assert(Small.Count == 2 && Small.DroppedCount == 3);
+        ch::DestroyGLMeshDraws(&Small);
+    }
+    
+    GLuint VertexArray = Registry.VertexArray;
+    ch::DestroyGLMeshDraws(&Draws);
+    ch::DestroyGLMeshRegistry(&Registry);
+    assert(ch::GetGLVertexArray() == 0 && GetMockGL().CurrentVAO == 0 && VertexArray);
+    assert(!MockGLFindBuffer(1) && Registry.Meshes == 0);
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,1256 @@
+#pragma once
+
+/*
+A fake GL for the ch_gl_* tests and benches, no context or driver needed:
+
+MockGLReset();
+mock_gl_program *Program = MockGLAddProgram(3);
+MockGLAddUniform(Program, "Color", GL_FLOAT_VEC3, 1);
+LoadGLFunctions(MockGLLoad);
+...
+assert(MockGLCalls("glGetUniformLocation") == 1);
+
+Every mocked entry point counts its calls by name, uniform uploads are recorded
+with their bytes. Buffers have storage in memory, fences signal right away unless
+PendingSyncs says otherwise, timer queries are available up to FinishedQueries. Bindings and fixed function state are kept like a
+driver keeps them, glGetIntegerv answers from them (or from Integers).
+Entry points that aren't mocked load as 0, so a test crashes on anything it
+didn't expect.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct mock_gl_uniform
+{
+    char Name[64];
+    GLenum Type;
+    GLint Size;
+    GLint Location; // -1 for block members
+};
+
+struct mock_gl_program
+{
+    GLuint Id;
+    std::vector<mock_gl_uniform> Uniforms;
+    std::vector<GLuint> Shaders; // attached
+    bool LinkFailed;
+    std::string Binary;          // what glGetProgramBinary gives, the attached sources
+};
+
+struct mock_gl_shader
+{
+    GLenum Type;
+    std::string Source;
+    bool Compiled;
+    bool Failed; // sources with #error in them fail
+};
+
+struct mock_gl_upload
+{
+    std::string Function;
+    GLint Location;
+    GLsizei Count;
+    GLboolean Transpose;
+    std::vector<unsigned char> Bytes;
+};
+
+struct mock_gl_buffer
+{
+    GLuint Id;
+    std::vector<unsigned char> Storage;
+    GLbitfield Flags;
+    bool Mapped;
+};
+
+struct mock_gl_bind_range
+{
+    GLenum Target;
+    GLuint Index;
+    GLuint Buffer;
+    GLintptr Offset;
+    GLsizeiptr Size;
+};
+
+struct mock_gl_texture
+{
+    GLenum Format; // from glTexStorage2D or glTexImage2D
+    GLsizei Width;
+    GLsizei Height;
+    std::map<GLenum, GLint> Parameters;
+};
+
+struct mock_gl_query
+{
+    GLuint64 Timestamp;
+    size_t Serial; // 0 until glQueryCounter
+};
+
+struct mock_gl_draw
+{
+    std::string Function;
+    GLenum Mode;
+    GLint First;       // glDrawArrays
+    GLsizei Count;
+    GLenum Type;       // the rest for indexed draws
+    size_t IndexOffset;
+    GLint BaseVertex;
+    GLsizei InstanceCount;
+    GLuint BaseInstance;
+};
+
+struct mock_gl
+{
+    std::map<std::string, int> Calls;
+    std::vector<std::string> CallOrder;
+    std::deque<mock_gl_program> Programs; // stable pointers
+    std::vector<mock_gl_upload> Uploads;
+    GLint NextLocation;
+    
+    std::deque<mock_gl_buffer> Buffers;
+    std::map<GLenum, GLuint> BoundBuffers;
+    std::vector<mock_gl_bind_range> BindRanges;
+    std::map<GLenum, GLint> Integers; // what glGetIntegerv answers
+    std::map<size_t, int> PendingSyncs; // glClientWaitSync times out this many times
+    size_t NextSync;
+    size_t LiveSyncs;
+    
+    std::map<GLuint, mock_gl_query> Queries;
+    GLuint64 GPUTime;        // nanoseconds, glQueryCounter takes it and adds GPUTimeStep
+    GLuint64 GPUTimeStep;
+    size_t NextQuerySerial;
+    size_t FinishedQueries;  // timestamps up to this serial are available
+    int QueryStalls;         // results read before they were available
+    
+    std::vector<mock_gl_draw> Draws;
+    GLuint NextObject; // shaders, programs and VAOs
+    GLuint CurrentProgram;
+    GLuint CurrentVAO;
+    std::map<GLuint, mock_gl_shader> Shaders;
+    std::string Strings[3];        // vendor, renderer, version
+    GLenum ProgramBinaryFormat;    // glProgramBinary takes only this one
+    
+    std::map<GLuint, GLuint> ElementBuffers; // per VAO
+    std::map<GLenum, bool> Enabled;
+    GLenum BlendFunc[4];                     // src/dst RGB, src/dst alpha
+    GLenum BlendEquation[2];
+    GLenum DepthFunc;
+    GLboolean DepthMask;
+    GLenum CullFace;
+    GLint Viewport[4];
+    GLint Scissor[4];
+    GLenum ActiveTexture;
+    std::map<std::pair<GLenum, GLenum>, GLuint> Textures; // by unit and target
+    std::map<GLuint, mock_gl_texture> TextureObjects;
+    std::map<GLuint, GLuint> FramebufferColors; // color attachment 0 by framebuffer
+    GLuint CurrentFramebuffer;
+};
+
+inline mock_gl &
+GetMockGL()
+{
+    static mock_gl MockGL;
+    return MockGL;
+}
+
+inline void
+MockGLReset()
+{
+    mock_gl &GL = GetMockGL();
+    GL.Calls.clear();
+    GL.CallOrder.clear();
+    GL.Programs.clear();
+    GL.Uploads.clear();
+    GL.NextLocation = 0;
+    GL.Buffers.clear();
+    GL.BoundBuffers.clear();
+    GL.BindRanges.clear();
+    GL.Integers.clear();
+    GL.PendingSyncs.clear();
+    GL.NextSync = 0;
+    GL.LiveSyncs = 0;
+    GL.Queries.clear();
+    GL.GPUTime = 1000000;
+    GL.GPUTimeStep = 1000;
+    GL.NextQuerySerial = 0;
+    GL.FinishedQueries = (size_t)-1;
+    GL.QueryStalls = 0;
+    GL.Draws.clear();
+    GL.NextObject = 1000;
+    GL.CurrentProgram = 0;
+    GL.CurrentVAO = 0;
+    GL.Shaders.clear();
+    GL.Strings[0] = "Mock Vendor";
+    GL.Strings[1] = "Mock Renderer";
+    GL.Strings[2] = "4.6.0 Mock 1.0";
+    GL.ProgramBinaryFormat = 0x9001;
+    GL.ElementBuffers.clear();
+    GL.Enabled.clear();
+    GL.BlendFunc[0] = GL.BlendFunc[2] = GL_ONE;
+    GL.BlendFunc[1] = GL.BlendFunc[3] = GL_ZERO;
+    GL.BlendEquation[0] = GL.BlendEquation[1] = GL_FUNC_ADD;
+    GL.DepthFunc = GL_LESS;
+    GL.DepthMask = GL_TRUE;
+    GL.CullFace = GL_BACK;
+    memset(GL.Viewport, 0, sizeof(GL.Viewport));
+    memset(GL.Scissor, 0, sizeof(GL.Scissor));
+    GL.ActiveTexture = GL_TEXTURE0;
+    GL.Textures.clear();
+    GL.TextureObjects.clear();
+    GL.FramebufferColors.clear();
+    GL.CurrentFramebuffer = 0;
+}
+
+inline int
+MockGLCalls(const char *Function)
+{
+    std::map<std::string, int>::iterator Found = GetMockGL().Calls.find(Function);
+    return Found == GetMockGL().Calls.end()? 0: Found->second;
+}
+
+inline void
+MockGLCount(const char *Function)
+{
+    GetMockGL().Calls[Function] += 1;
+    GetMockGL().CallOrder.push_back(Function);
+}
+
+inline mock_gl_program *
+MockGLAddProgram(GLuint Id)
+{
+    mock_gl_program Program = {};
+    Program.Id = Id;
+    GetMockGL().Programs.push_back(Program);
+    return &GetMockGL().Programs.back();
+}
+
+inline mock_gl_program *
+MockGLFindProgram(GLuint Id)
+{
+    for (mock_gl_program &Program: GetMockGL().Programs)
+    {
+        if (Program.Id == Id) return &Program;
+    }
+    return 0;
+}
+
+// arrays take Size locations, like drivers do. Block members get none
+inline void
+MockGLAddUniform(mock_gl_program *Program, const char *Name, GLenum Type, GLint Size, bool InBlock = false)
+{
+    mock_gl_uniform Uniform = {};
+    snprintf(Uniform.Name, sizeof(Uniform.Name), "%s", Name);
+    Uniform.Type = Type;
+    Uniform.Size = Size;
+    Uniform.Location = -1;
+    if (!InBlock)
+    {
+        Uniform.Location = GetMockGL().NextLocation;
+        GetMockGL().NextLocation += Size;
+    }
+    Program->Uniforms.push_back(Uniform);
+}
+
+//
+// programs and uniforms
+
+static void __stdcall
+Mock_glGetProgramiv(GLuint Id, GLenum Name, GLint *Params)
+{
+    MockGLCount("glGetProgramiv");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    *Params = 0;
+    if (!Program) return;
+    if (Name == GL_ACTIVE_UNIFORMS)
+    {
+        *Params = GLint(Program->Uniforms.size());
+    }
+    else if (Name == GL_ACTIVE_UNIFORM_MAX_LENGTH)
+    {
+        for (mock_gl_uniform &Uniform: Program->Uniforms)
+        {
+            // arrays are reported as Name[0]
+            GLint Length = GLint(strlen(Uniform.Name)) + (Uniform.Size > 1? 3: 0) + 1;
+            if (Length > *Params) *Params = Length;
+        }
+    }
+    else if (Name == GL_LINK_STATUS)
+    {
+        *Params = Program->LinkFailed? GL_FALSE: GL_TRUE;
+    }
+    else if (Name == GL_PROGRAM_BINARY_LENGTH)
+    {
+        *Params = GLint(Program->Binary.size());
+    }
+    else if (Name == GL_INFO_LOG_LENGTH)
+    {
+        *Params = Program->LinkFailed? 12: 0;
+    }
+}
+
+static void __stdcall
+Mock_glGetActiveUniform(GLuint Id, GLuint Index, GLsizei BufSize, GLsizei *Length, GLint *Size, GLenum *Type, GLchar *Name)
+{
+    MockGLCount("glGetActiveUniform");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    assert(Program && Index < Program->Uniforms.size());
+    mock_gl_uniform *Uniform = &Program->Uniforms[Index];
+    int Written = snprintf(Name, size_t(BufSize), Uniform->Size > 1? "%s[0]": "%s", Uniform->Name);
+    if (Written >= BufSize) Written = BufSize - 1;
+    if (Length) *Length = Written;
+    *Size = Uniform->Size;
+    *Type = Uniform->Type;
+}
+
+static GLint __stdcall
+Mock_glGetUniformLocation(GLuint Id, const GLchar *Name)
+{
+    MockGLCount("glGetUniformLocation");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    if (!Program) return -1;
+    for (mock_gl_uniform &Uniform: Program->Uniforms)
+    {
+        size_t Length = strlen(Uniform.Name);
+        if (strncmp(Name, Uniform.Name, Length) != 0) continue;
+        if (Name[Length] == 0) return Uniform.Location;
+        if (Name[Length] == '[' && Uniform.Location >= 0)
+        {
+            int Element = atoi(Name + Length + 1);
+            return Element < Uniform.Size? Uniform.Location + Element: -1;
+        }
+    }
+    return -1;
+}
+
+inline void
+MockGLRecordUpload(const char *Function, GLint Location, GLsizei Count, GLboolean Transpose, const void *Data, size_t Size)
+{
+    MockGLCount(Function);
+    mock_gl_upload Upload;
+    Upload.Function = Function;
+    Upload.Location = Location;
+    Upload.Count = Count;
+    Upload.Transpose = Transpose;
+    Upload.Bytes.assign((const unsigned char *)Data, (const unsigned char *)Data + Size);
+    GetMockGL().Uploads.push_back(Upload);
+}
+
+#define MOCK_GL_UNIFORM_V(Name, Type, Components) \
+static void __stdcall Mock_##Name(GLint Location, GLsizei Count, const Type *Value) \
+{ \
+    MockGLRecordUpload(#Name, Location, Count, GL_FALSE, Value, sizeof(Type) * Components * size_t(Count)); \
+}
+#define MOCK_GL_UNIFORM_MATRIX(Name, Type, Components) \
+static void __stdcall Mock_##Name(GLint Location, GLsizei Count, GLboolean Transpose, const Type *Value) \
+{ \
+    MockGLRecordUpload(#Name, Location, Count, Transpose, Value, sizeof(Type) * Components * size_t(Count)); \
+}
+
+MOCK_GL_UNIFORM_V(glUniform1fv, GLfloat, 1)
+MOCK_GL_UNIFORM_V(glUniform2fv, GLfloat, 2)
+MOCK_GL_UNIFORM_V(glUniform3fv, GLfloat, 3)
+MOCK_GL_UNIFORM_V(glUniform4fv, GLfloat, 4)
+MOCK_GL_UNIFORM_V(glUniform1iv, GLint, 1)
+MOCK_GL_UNIFORM_V(glUniform2iv, GLint, 2)
+MOCK_GL_UNIFORM_V(glUniform3iv, GLint, 3)
+MOCK_GL_UNIFORM_V(glUniform4iv, GLint, 4)
+MOCK_GL_UNIFORM_V(glUniform1uiv, GLuint, 1)
+MOCK_GL_UNIFORM_V(glUniform2uiv, GLuint, 2)
+MOCK_GL_UNIFORM_V(glUniform3uiv, GLuint, 3)
+MOCK_GL_UNIFORM_V(glUniform4uiv, GLuint, 4)
+MOCK_GL_UNIFORM_V(glUniform1dv, GLdouble, 1)
+MOCK_GL_UNIFORM_V(glUniform2dv, GLdouble, 2)
+MOCK_GL_UNIFORM_V(glUniform3dv, GLdouble, 3)
+MOCK_GL_UNIFORM_V(glUniform4dv, GLdouble, 4)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix2fv, GLfloat, 4)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix3fv, GLfloat, 9)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix4fv, GLfloat, 16)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix2x3fv, GLfloat, 6)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix3x2fv, GLfloat, 6)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix2x4fv, GLfloat, 8)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix4x2fv, GLfloat, 8)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix3x4fv, GLfloat, 12)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix4x3fv, GLfloat, 12)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix2dv, GLdouble, 4)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix3dv, GLdouble, 9)
+MOCK_GL_UNIFORM_MATRIX(glUniformMatrix4dv, GLdouble, 16)
+
+static void __stdcall
+Mock_glUniform1f(GLint Location, GLfloat V0)
+{
+    MockGLRecordUpload("glUniform1f", Location, 1, GL_FALSE, &V0, sizeof(V0));
+}
+
+static void __stdcall
+Mock_glUniform1i(GLint Location, GLint V0)
+{
+    MockGLRecordUpload("glUniform1i", Location, 1, GL_FALSE, &V0, sizeof(V0));
+}
+
+static void __stdcall
+Mock_glUniform1ui(GLint Location, GLuint V0)
+{
+    MockGLRecordUpload("glUniform1ui", Location, 1, GL_FALSE, &V0, sizeof(V0));
+}
+
+//
+// buffers, state queries and syncs
+
+inline mock_gl_buffer *
+MockGLFindBuffer(GLuint Id)
+{
+    for (mock_gl_buffer &Buffer: GetMockGL().Buffers)
+    {
+        if (Buffer.Id == Id) return &Buffer;
+    }
+    return 0;
+}
+
+static void __stdcall
+Mock_glGenBuffers(GLsizei Count, GLuint *Ids)
+{
+    MockGLCount("glGenBuffers");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        mock_gl_buffer Buffer = {};
+        Buffer.Id = GLuint(GetMockGL().Buffers.size() + 1);
+        GetMockGL().Buffers.push_back(Buffer);
+        Ids[I] = Buffer.Id;
+    }
+}
+
+static void __stdcall
+Mock_glDeleteBuffers(GLsizei Count, const GLuint *Ids)
+{
+    MockGLCount("glDeleteBuffers");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        mock_gl_buffer *Buffer = MockGLFindBuffer(Ids[I]);
+        if (Buffer)
+        {
+            Buffer->Id = 0;
+            Buffer->Storage.clear();
+        }
+        
+        // deleting a bound buffer unbinds it
+        for (auto &Bound: GetMockGL().BoundBuffers)
+        {
+            if (Bound.second == Ids[I]) Bound.second = 0;
+        }
+        for (auto &Bound: GetMockGL().ElementBuffers)
+        {
+            if (Bound.second == Ids[I]) Bound.second = 0;
+        }
+    }
+}
+
+static void __stdcall
+Mock_glBindBuffer(GLenum Target, GLuint Id)
+{
+    MockGLCount("glBindBuffer");
+    if (Target == GL_ELEMENT_ARRAY_BUFFER) GetMockGL().ElementBuffers[GetMockGL().CurrentVAO] = Id;
+    else GetMockGL().BoundBuffers[Target] = Id;
+}
+
+// the element buffer is the current VAO's
+inline GLuint
+MockGLBinding(GLenum Target)
+{
+    if (Target == GL_ELEMENT_ARRAY_BUFFER) return GetMockGL().ElementBuffers[GetMockGL().CurrentVAO];
+    return GetMockGL().BoundBuffers[Target];
+}
+
+inline mock_gl_buffer *
+MockGLBoundBuffer(GLenum Target)
+{
+    mock_gl_buffer *Buffer = MockGLFindBuffer(MockGLBinding(Target));
+    assert(Buffer);
+    return Buffer;
+}
+
+static void __stdcall
+Mock_glBufferStorage(GLenum Target, GLsizeiptr Size, const void *Data, GLbitfield Flags)
+{
+    MockGLCount("glBufferStorage");
+    mock_gl_buffer *Buffer = MockGLBoundBuffer(Target);
+    assert(Buffer->Storage.empty());
+    Buffer->Storage.assign(size_t(Size), 0);
+    if (Data) memcpy(Buffer->Storage.data(), Data, size_t(Size));
+    Buffer->Flags = Flags;
+}
+
+static void __stdcall
+Mock_glBufferData(GLenum Target, GLsizeiptr Size, const void *Data, GLenum)
+{
+    MockGLCount("glBufferData");
+    mock_gl_buffer *Buffer = MockGLBoundBuffer(Target);
+    Buffer->Storage.assign(size_t(Size), 0);
+    if (Data) memcpy(Buffer->Storage.data(), Data, size_t(Size));
+}
+
+static void __stdcall
+Mock_glBufferSubData(GLenum Target, GLintptr Offset, GLsizeiptr Size, const void *Data)
+{
+    MockGLCount("glBufferSubData");
+    mock_gl_buffer *Buffer = MockGLBoundBuffer(Target);
+    assert(size_t(Offset + Size) <= Buffer->Storage.size());
+    memcpy(Buffer->Storage.data() + Offset, Data, size_t(Size));
+}
+
+static void * __stdcall
+Mock_glMapBufferRange(GLenum Target, GLintptr Offset, GLsizeiptr Length, GLbitfield Access)
+{
+    MockGLCount("glMapBufferRange");
+    mock_gl_buffer *Buffer = MockGLBoundBuffer(Target);
+    assert(!Buffer->Mapped && size_t(Offset + Length) <= Buffer->Storage.size());
+    assert(!(Access & GL_MAP_PERSISTENT_BIT) || (Buffer->Flags & GL_MAP_PERSISTENT_BIT));
+    Buffer->Mapped = true;
+    return Buffer->Storage.data() + Offset;
+}
+
+static GLboolean __stdcall
+Mock_glUnmapBuffer(GLenum Target)
+{
+    MockGLCount("glUnmapBuffer");
+    mock_gl_buffer *Buffer = MockGLBoundBuffer(Target);
+    assert(Buffer->Mapped);
+    Buffer->Mapped = false;
+    return GL_TRUE;
+}
+
+static void __stdcall
+Mock_glBindBufferRange(GLenum Target, GLuint Index, GLuint Buffer, GLintptr Offset, GLsizeiptr Size)
+{
+    MockGLCount("glBindBufferRange");
+    mock_gl_bind_range Range = {Target, Index, Buffer, Offset, Size};
+    GetMockGL().BindRanges.push_back(Range);
+    GetMockGL().BoundBuffers[Target] = Buffer; // the generic binding too
+}
+
+static void __stdcall
+Mock_glGetIntegerv(GLenum Name, GLint *Data)
+{
+    MockGLCount("glGetIntegerv");
+    mock_gl &GL = GetMockGL();
+    switch (Name)
+    {
+        case GL_CURRENT_PROGRAM: *Data = GLint(GL.CurrentProgram); break;
+        case GL_VERTEX_ARRAY_BINDING: *Data = GLint(GL.CurrentVAO); break;
+        case GL_ARRAY_BUFFER_BINDING: *Data = GLint(MockGLBinding(GL_ARRAY_BUFFER)); break;
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING: *Data = GLint(MockGLBinding(GL_ELEMENT_ARRAY_BUFFER)); break;
+        case GL_UNIFORM_BUFFER_BINDING: *Data = GLint(MockGLBinding(GL_UNIFORM_BUFFER)); break;
+        case GL_COPY_WRITE_BUFFER_BINDING: *Data = GLint(MockGLBinding(GL_COPY_WRITE_BUFFER)); break;
+        case GL_ACTIVE_TEXTURE: *Data = GLint(GL.ActiveTexture); break;
+        case GL_TEXTURE_BINDING_2D: *Data = GLint(GL.Textures[std::make_pair(GL.ActiveTexture, GLenum(GL_TEXTURE_2D))]); break;
+        case GL_TEXTURE_BINDING_3D: *Data = GLint(GL.Textures[std::make_pair(GL.ActiveTexture, GLenum(GL_TEXTURE_3D))]); break;
+        case GL_TEXTURE_BINDING_CUBE_MAP: *Data = GLint(GL.Textures[std::make_pair(GL.ActiveTexture, GLenum(GL_TEXTURE_CUBE_MAP))]); break;
+        case GL_TEXTURE_BINDING_2D_ARRAY: *Data = GLint(GL.Textures[std::make_pair(GL.ActiveTexture, GLenum(GL_TEXTURE_2D_ARRAY))]); break;
+        case GL_BLEND_SRC_RGB: *Data = GLint(GL.BlendFunc[0]); break;
+        case GL_BLEND_DST_RGB: *Data = GLint(GL.BlendFunc[1]); break;
+        case GL_BLEND_SRC_ALPHA: *Data = GLint(GL.BlendFunc[2]); break;
+        case GL_BLEND_DST_ALPHA: *Data = GLint(GL.BlendFunc[3]); break;
+        case GL_BLEND_EQUATION_RGB: *Data = GLint(GL.BlendEquation[0]); break;
+        case GL_BLEND_EQUATION_ALPHA: *Data = GLint(GL.BlendEquation[1]); break;
+        case GL_DEPTH_FUNC: *Data = GLint(GL.DepthFunc); break;
+        case GL_CULL_FACE_MODE: *Data = GLint(GL.CullFace); break;
+        case GL_VIEWPORT: memcpy(Data, GL.Viewport, sizeof(GL.Viewport)); break;
+        case GL_SCISSOR_BOX: memcpy(Data, GL.Scissor, sizeof(GL.Scissor)); break;
+        default: *Data = GL.Integers[Name];
+    }
+}
+
+static GLsync __stdcall
+Mock_glFenceSync(GLenum Condition, GLbitfield)
+{
+    MockGLCount("glFenceSync");
+    assert(Condition == GL_SYNC_GPU_COMMANDS_COMPLETE);
+    ++GetMockGL().LiveSyncs;
+    return (GLsync)++GetMockGL().NextSync;
+}
+
+static GLenum __stdcall
+Mock_glClientWaitSync(GLsync Sync, GLbitfield, GLuint64)
+{
+    MockGLCount("glClientWaitSync");
+    int &Pending = GetMockGL().PendingSyncs[size_t(Sync)];
+    if (Pending > 0)
+    {
+        --Pending;
+        return GL_TIMEOUT_EXPIRED;
+    }
+    return GL_ALREADY_SIGNALED;
+}
+
+static void __stdcall
+Mock_glDeleteSync(GLsync)
+{
+    MockGLCount("glDeleteSync");
+    assert(GetMockGL().LiveSyncs > 0);
+    --GetMockGL().LiveSyncs;
+}
+
+//
+// timer queries
+
+static void __stdcall
+Mock_glGenQueries(GLsizei Count, GLuint *Ids)
+{
+    MockGLCount("glGenQueries");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        Ids[I] = GetMockGL().NextObject++;
+        GetMockGL().Queries[Ids[I]] = mock_gl_query();
+    }
+}
+
+static void __stdcall
+Mock_glDeleteQueries(GLsizei Count, const GLuint *Ids)
+{
+    MockGLCount("glDeleteQueries");
+    for (GLsizei I = 0; I < Count; ++I) GetMockGL().Queries.erase(Ids[I]);
+}
+
+static void __stdcall
+Mock_glQueryCounter(GLuint Id, GLenum Target)
+{
+    MockGLCount("glQueryCounter");
+    mock_gl &GL = GetMockGL();
+    assert(Target == GL_TIMESTAMP && GL.Queries.count(Id));
+    mock_gl_query &Query = GL.Queries[Id];
+    Query.Timestamp = GL.GPUTime;
+    Query.Serial = ++GL.NextQuerySerial;
+    GL.GPUTime += GL.GPUTimeStep;
+}
+
+inline bool
+MockGLQueryAvailable(GLuint Id)
+{
+    mock_gl_query &Query = GetMockGL().Queries[Id];
+    return Query.Serial && Query.Serial <= GetMockGL().FinishedQueries;
+}
+
+static void __stdcall
+Mock_glGetQueryObjectiv(GLuint Id, GLenum Name, GLint *Params)
+{
+    MockGLCount("glGetQueryObjectiv");
+    assert(Name == GL_QUERY_RESULT_AVAILABLE);
+    *Params = MockGLQueryAvailable(Id)? GL_TRUE: GL_FALSE;
+}
+
+// a real driver waits for a result that isn't available, this counts it
+static void __stdcall
+Mock_glGetQueryObjectui64v(GLuint Id, GLenum Name, GLuint64 *Params)
+{
+    MockGLCount("glGetQueryObjectui64v");
+    if (Name == GL_QUERY_RESULT_AVAILABLE)
+    {
+        *Params = MockGLQueryAvailable(Id)? GL_TRUE: GL_FALSE;
+        return;
+    }
+    assert(Name == GL_QUERY_RESULT);
+    if (!MockGLQueryAvailable(Id)) ++GetMockGL().QueryStalls;
+    *Params = GetMockGL().Queries[Id].Timestamp;
+}
+
+static void __stdcall
+Mock_glGetInteger64v(GLenum Name, GLint64 *Data)
+{
+    MockGLCount("glGetInteger64v");
+    *Data = Name == GL_TIMESTAMP? GLint64(GetMockGL().GPUTime): GLint64(GetMockGL().Integers[Name]);
+}
+
+//
+// shaders, vertex arrays and draws
+
+static GLuint __stdcall
+Mock_glCreateShader(GLenum Type)
+{
+    MockGLCount("glCreateShader");
+    GLuint Id = GetMockGL().NextObject++;
+    mock_gl_shader Shader = {};
+    Shader.Type = Type;
+    GetMockGL().Shaders[Id] = Shader;
+    return Id;
+}
+
+static void __stdcall
+Mock_glShaderSource(GLuint Id, GLsizei Count, const GLchar *const *Strings, const GLint *Lengths)
+{
+    MockGLCount("glShaderSource");
+    std::string &Source = GetMockGL().Shaders[Id].Source;
+    Source.clear();
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        if (Lengths && Lengths[I] >= 0) Source.append(Strings[I], size_t(Lengths[I]));
+        else Source.append(Strings[I]);
+    }
+}
+
+static void __stdcall
+Mock_glCompileShader(GLuint Id)
+{
+    MockGLCount("glCompileShader");
+    mock_gl_shader &Shader = GetMockGL().Shaders[Id];
+    Shader.Compiled = true;
+    Shader.Failed = Shader.Source.find("#error") != std::string::npos;
+}
+
+static void __stdcall
+Mock_glGetShaderiv(GLuint Id, GLenum Name, GLint *Params)
+{
+    MockGLCount("glGetShaderiv");
+    mock_gl_shader &Shader = GetMockGL().Shaders[Id];
+    *Params = 0;
+    if (Name == GL_COMPILE_STATUS) *Params = Shader.Compiled && !Shader.Failed? GL_TRUE: GL_FALSE;
+    else if (Name == GL_INFO_LOG_LENGTH) *Params = Shader.Failed? 14: 0;
+    else if (Name == GL_SHADER_TYPE) *Params = GLint(Shader.Type);
+}
+
+static void __stdcall
+Mock_glGetShaderInfoLog(GLuint, GLsizei Size, GLsizei *Length, GLchar *Log)
+{
+    MockGLCount("glGetShaderInfoLog");
+    GLsizei Written = GLsizei(snprintf(Log, size_t(Size), "error: #error"));
+    if (Length) *Length = Written < Size? Written: Size - 1;
+}
+
+static void __stdcall
+Mock_glDeleteShader(GLuint Id)
+{
+    MockGLCount("glDeleteShader");
+    GetMockGL().Shaders.erase(Id);
+}
+
+// programs made here have no uniforms, add them with MockGLFindProgram
+static GLuint __stdcall
+Mock_glCreateProgram()
+{
+    MockGLCount("glCreateProgram");
+    return MockGLAddProgram(GetMockGL().NextObject++)->Id;
+}
+
+static void __stdcall
+Mock_glAttachShader(GLuint Program, GLuint Shader)
+{
+    MockGLCount("glAttachShader");
+    MockGLFindProgram(Program)->Shaders.push_back(Shader);
+}
+
+static void __stdcall
+Mock_glDetachShader(GLuint Program, GLuint Shader)
+{
+    MockGLCount("glDetachShader");
+    std::vector<GLuint> &Shaders = MockGLFindProgram(Program)->Shaders;
+    for (size_t I = 0; I < Shaders.size(); ++I)
+    {
+        if (Shaders[I] == Shader) Shaders.erase(Shaders.begin() + I--);
+    }
+}
+
+// links if every attached shader compiled, the binary is their sources
+static void __stdcall
+Mock_glLinkProgram(GLuint Id)
+{
+    MockGLCount("glLinkProgram");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    Program->LinkFailed = Program->Shaders.empty();
+    Program->Binary.clear();
+    for (GLuint ShaderId: Program->Shaders)
+    {
+        mock_gl_shader &Shader = GetMockGL().Shaders[ShaderId];
+        if (!Shader.Compiled || Shader.Failed) Program->LinkFailed = true;
+        Program->Binary += Shader.Source;
+    }
+    if (Program->LinkFailed) Program->Binary.clear();
+}
+
+// the vertex shaders' "in" declarations in order, locations from 0
+static GLint __stdcall
+Mock_glGetAttribLocation(GLuint Id, const GLchar *Name)
+{
+    MockGLCount("glGetAttribLocation");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    if (!Program) return -1;
+    GLint Location = 0;
+    for (GLuint ShaderId: Program->Shaders)
+    {
+        mock_gl_shader &Shader = GetMockGL().Shaders[ShaderId];
+        if (Shader.Type != GL_VERTEX_SHADER) continue;
+        for (size_t At = Shader.Source.find("\nin "); At != std::string::npos; At = Shader.Source.find("\nin ", At + 1))
+        {
+            size_t End = Shader.Source.find(';', At);
+            size_t Begin = Shader.Source.rfind(' ', End) + 1;
+            if (Shader.Source.compare(Begin, End - Begin, Name) == 0) return Location;
+            ++Location;
+        }
+    }
+    return -1;
+}
+
+static void __stdcall
+Mock_glGetProgramInfoLog(GLuint, GLsizei Size, GLsizei *Length, GLchar *Log)
+{
+    MockGLCount("glGetProgramInfoLog");
+    GLsizei Written = GLsizei(snprintf(Log, size_t(Size), "link failed"));
+    if (Length) *Length = Written < Size? Written: Size - 1;
+}
+
+static void __stdcall
+Mock_glProgramParameteri(GLuint, GLenum, GLint)
+{
+    MockGLCount("glProgramParameteri");
+}
+
+static void __stdcall
+Mock_glGetProgramBinary(GLuint Id, GLsizei Size, GLsizei *Length, GLenum *Format, void *Binary)
+{
+    MockGLCount("glGetProgramBinary");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    assert(GLsizei(Program->Binary.size()) <= Size);
+    memcpy(Binary, Program->Binary.data(), Program->Binary.size());
+    if (Length) *Length = GLsizei(Program->Binary.size());
+    *Format = GetMockGL().ProgramBinaryFormat;
+}
+
+// a binary in another format (another driver) doesn't link
+static void __stdcall
+Mock_glProgramBinary(GLuint Id, GLenum Format, const void *Binary, GLsizei Length)
+{
+    MockGLCount("glProgramBinary");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    Program->LinkFailed = Format != GetMockGL().ProgramBinaryFormat;
+    Program->Binary = Program->LinkFailed? std::string(): std::string((const char *)Binary, size_t(Length));
+}
+
+static const GLubyte * __stdcall
+Mock_glGetString(GLenum Name)
+{
+    MockGLCount("glGetString");
+    mock_gl &GL = GetMockGL();
+    switch (Name)
+    {
+        case GL_VENDOR: return (const GLubyte *)GL.Strings[0].c_str();
+        case GL_RENDERER: return (const GLubyte *)GL.Strings[1].c_str();
+        case GL_VERSION: return (const GLubyte *)GL.Strings[2].c_str();
+    }
+    return 0;
+}
+
+// the program can't be found anymore, its name may be added again
+static void __stdcall
+Mock_glDeleteProgram(GLuint Id)
+{
+    MockGLCount("glDeleteProgram");
+    mock_gl_program *Program = MockGLFindProgram(Id);
+    if (Program) Program->Id = 0;
+}
+
+static void __stdcall
+Mock_glUseProgram(GLuint Program)
+{
+    MockGLCount("glUseProgram");
+    GetMockGL().CurrentProgram = Program;
+}
+
+static void __stdcall
+Mock_glGenVertexArrays(GLsizei Count, GLuint *Ids)
+{
+    MockGLCount("glGenVertexArrays");
+    for (GLsizei I = 0; I < Count; ++I) Ids[I] = GetMockGL().NextObject++;
+}
+
+static void __stdcall
+Mock_glDeleteVertexArrays(GLsizei Count, const GLuint *Ids)
+{
+    MockGLCount("glDeleteVertexArrays");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        if (GetMockGL().CurrentVAO == Ids[I]) GetMockGL().CurrentVAO = 0;
+        GetMockGL().ElementBuffers.erase(Ids[I]);
+    }
+}
+
+static void __stdcall
+Mock_glBindVertexArray(GLuint VAO)
+{
+    MockGLCount("glBindVertexArray");
+    GetMockGL().CurrentVAO = VAO;
+}
+
+static void __stdcall
+Mock_glEnableVertexAttribArray(GLuint)
+{
+    MockGLCount("glEnableVertexAttribArray");
+}
+
+static void __stdcall
+Mock_glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void *)
+{
+    MockGLCount("glVertexAttribPointer");
+}
+
+static void __stdcall
+Mock_glDrawArrays(GLenum Mode, GLint First, GLsizei Count)
+{
+    MockGLCount("glDrawArrays");
+    mock_gl_draw Draw = {"glDrawArrays", Mode, First, Count, 0, 0, 0, 1, 0};
+    GetMockGL().Draws.push_back(Draw);
+}
+
+static void __stdcall
+Mock_glDrawArraysInstanced(GLenum Mode, GLint First, GLsizei Count, GLsizei InstanceCount)
+{
+    MockGLCount("glDrawArraysInstanced");
+    mock_gl_draw Draw = {"glDrawArraysInstanced", Mode, First, Count, 0, 0, 0, InstanceCount, 0};
+    GetMockGL().Draws.push_back(Draw);
+}
+
+static void __stdcall
+Mock_glDrawElementsBaseVertex(GLenum Mode, GLsizei Count, GLenum Type, const void *Indices, GLint BaseVertex)
+{
+    MockGLCount("glDrawElementsBaseVertex");
+    mock_gl_draw Draw = {"glDrawElementsBaseVertex", Mode, 0, Count, Type, size_t(Indices), BaseVertex, 1, 0};
+    GetMockGL().Draws.push_back(Draw);
+}
+
+static void __stdcall
+Mock_glDrawElementsInstancedBaseVertex(GLenum Mode, GLsizei Count, GLenum Type, const void *Indices, GLsizei InstanceCount, GLint BaseVertex)
+{
+    MockGLCount("glDrawElementsInstancedBaseVertex");
+    mock_gl_draw Draw = {"glDrawElementsInstancedBaseVertex", Mode, 0, Count, Type, size_t(Indices), BaseVertex, InstanceCount, 0};
+    GetMockGL().Draws.push_back(Draw);
+}
+
+// one draw per command read from the bound indirect buffer
+static void __stdcall
+Mock_glMultiDrawElementsIndirect(GLenum Mode, GLenum Type, const void *Indirect, GLsizei DrawCount, GLsizei Stride)
+{
+    MockGLCount("glMultiDrawElementsIndirect");
+    mock_gl_buffer *Buffer = MockGLBoundBuffer(GL_DRAW_INDIRECT_BUFFER);
+    size_t Offset = size_t(Indirect);
+    size_t Step = Stride? size_t(Stride): 5 * sizeof(GLuint);
+    assert(Offset + size_t(DrawCount) * Step <= Buffer->Storage.size());
+    size_t IndexSize = Type == GL_UNSIGNED_INT? 4: Type == GL_UNSIGNED_SHORT? 2: 1;
+    for (GLsizei DrawI = 0; DrawI < DrawCount; ++DrawI)
+    {
+        GLuint Command[5];
+        memcpy(Command, Buffer->Storage.data() + Offset + DrawI * Step, sizeof(Command));
+        mock_gl_draw Draw = {"glMultiDrawElementsIndirect", Mode, 0, GLsizei(Command[0]), Type, Command[2] * IndexSize,
+            GLint(Command[3]), GLsizei(Command[1]), Command[4]};
+        GetMockGL().Draws.push_back(Draw);
+    }
+}
+
+//
+// fixed function state and textures
+
+static void __stdcall
+Mock_glEnable(GLenum Capability)
+{
+    MockGLCount("glEnable");
+    GetMockGL().Enabled[Capability] = true;
+}
+
+static void __stdcall
+Mock_glDisable(GLenum Capability)
+{
+    MockGLCount("glDisable");
+    GetMockGL().Enabled[Capability] = false;
+}
+
+static GLboolean __stdcall
+Mock_glIsEnabled(GLenum Capability)
+{
+    MockGLCount("glIsEnabled");
+    return GetMockGL().Enabled[Capability]? GL_TRUE: GL_FALSE;
+}
+
+inline void
+MockGLSetBlend(GLenum SrcRGB, GLenum DstRGB, GLenum SrcAlpha, GLenum DstAlpha)
+{
+    GLenum *Func = GetMockGL().BlendFunc;
+    Func[0] = SrcRGB;
+    Func[1] = DstRGB;
+    Func[2] = SrcAlpha;
+    Func[3] = DstAlpha;
+}
+
+static void __stdcall
+Mock_glBlendFunc(GLenum Src, GLenum Dst)
+{
+    MockGLCount("glBlendFunc");
+    MockGLSetBlend(Src, Dst, Src, Dst);
+}
+
+static void __stdcall
+Mock_glBlendFuncSeparate(GLenum SrcRGB, GLenum DstRGB, GLenum SrcAlpha, GLenum DstAlpha)
+{
+    MockGLCount("glBlendFuncSeparate");
+    MockGLSetBlend(SrcRGB, DstRGB, SrcAlpha, DstAlpha);
+}
+
+static void __stdcall
+Mock_glBlendEquation(GLenum Mode)
+{
+    MockGLCount("glBlendEquation");
+    GetMockGL().BlendEquation[0] = GetMockGL().BlendEquation[1] = Mode;
+}
+
+static void __stdcall
+Mock_glBlendEquationSeparate(GLenum ModeRGB, GLenum ModeAlpha)
+{
+    MockGLCount("glBlendEquationSeparate");
+    GetMockGL().BlendEquation[0] = ModeRGB;
+    GetMockGL().BlendEquation[1] = ModeAlpha;
+}
+
+static void __stdcall
+Mock_glDepthFunc(GLenum Func)
+{
+    MockGLCount("glDepthFunc");
+    GetMockGL().DepthFunc = Func;
+}
+
+static void __stdcall
+Mock_glDepthMask(GLboolean Write)
+{
+    MockGLCount("glDepthMask");
+    GetMockGL().DepthMask = Write;
+}
+
+static void __stdcall
+Mock_glGetBooleanv(GLenum Name, GLboolean *Data)
+{
+    MockGLCount("glGetBooleanv");
+    *Data = Name == GL_DEPTH_WRITEMASK? GetMockGL().DepthMask: GLboolean(GetMockGL().Integers[Name]);
+}
+
+static void __stdcall
+Mock_glCullFace(GLenum Face)
+{
+    MockGLCount("glCullFace");
+    GetMockGL().CullFace = Face;
+}
+
+static void __stdcall
+Mock_glViewport(GLint X, GLint Y, GLsizei Width, GLsizei Height)
+{
+    MockGLCount("glViewport");
+    GLint Viewport[4] = {X, Y, Width, Height};
+    memcpy(GetMockGL().Viewport, Viewport, sizeof(Viewport));
+}
+
+static void __stdcall
+Mock_glScissor(GLint X, GLint Y, GLsizei Width, GLsizei Height)
+{
+    MockGLCount("glScissor");
+    GLint Scissor[4] = {X, Y, Width, Height};
+    memcpy(GetMockGL().Scissor, Scissor, sizeof(Scissor));
+}
+
+static void __stdcall
+Mock_glActiveTexture(GLenum Unit)
+{
+    MockGLCount("glActiveTexture");
+    GetMockGL().ActiveTexture = Unit;
+}
+
+static void __stdcall
+Mock_glBindTexture(GLenum Target, GLuint Texture)
+{
+    MockGLCount("glBindTexture");
+    GetMockGL().Textures[std::make_pair(GetMockGL().ActiveTexture, Target)] = Texture;
+}
+
+// deleting a bound texture unbinds it from every unit
+static void __stdcall
+Mock_glDeleteTextures(GLsizei Count, const GLuint *Textures)
+{
+    MockGLCount("glDeleteTextures");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        for (auto &Bound: GetMockGL().Textures)
+        {
+            if (Bound.second == Textures[I]) Bound.second = 0;
+        }
+        GetMockGL().TextureObjects.erase(Textures[I]);
+    }
+}
+
+static void __stdcall
+Mock_glGenTextures(GLsizei Count, GLuint *Textures)
+{
+    MockGLCount("glGenTextures");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        Textures[I] = GetMockGL().NextObject++;
+        GetMockGL().TextureObjects[Textures[I]] = mock_gl_texture();
+    }
+}
+
+inline mock_gl_texture *
+MockGLBoundTexture(GLenum Target)
+{
+    mock_gl &GL = GetMockGL();
+    GLuint Texture = GL.Textures[std::make_pair(GL.ActiveTexture, Target)];
+    assert(Texture && GL.TextureObjects.count(Texture));
+    return &GL.TextureObjects[Texture];
+}
+
+static void __stdcall
+Mock_glTexStorage2D(GLenum Target, GLsizei Levels, GLenum Format, GLsizei Width, GLsizei Height)
+{
+    MockGLCount("glTexStorage2D");
+    assert(Levels > 0);
+    mock_gl_texture *Texture = MockGLBoundTexture(Target);
+    assert(!Texture->Format); // immutable
+    Texture->Format = Format;
+    Texture->Width = Width;
+    Texture->Height = Height;
+}
+
+static void __stdcall
+Mock_glTexImage2D(GLenum Target, GLint Level, GLint Format, GLsizei Width, GLsizei Height, GLint,
+                  GLenum, GLenum, const void *)
+{
+    MockGLCount("glTexImage2D");
+    mock_gl_texture *Texture = MockGLBoundTexture(Target);
+    if (Level != 0) return;
+    Texture->Format = GLenum(Format);
+    Texture->Width = Width;
+    Texture->Height = Height;
+}
+
+static void __stdcall
+Mock_glTexParameteri(GLenum Target, GLenum Name, GLint Value)
+{
+    MockGLCount("glTexParameteri");
+    MockGLBoundTexture(Target)->Parameters[Name] = Value;
+}
+
+//
+// framebuffers
+
+static void __stdcall
+Mock_glGenFramebuffers(GLsizei Count, GLuint *Framebuffers)
+{
+    MockGLCount("glGenFramebuffers");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        Framebuffers[I] = GetMockGL().NextObject++;
+        GetMockGL().FramebufferColors[Framebuffers[I]] = 0;
+    }
+}
+
+static void __stdcall
+Mock_glDeleteFramebuffers(GLsizei Count, const GLuint *Framebuffers)
+{
+    MockGLCount("glDeleteFramebuffers");
+    for (GLsizei I = 0; I < Count; ++I)
+    {
+        if (GetMockGL().CurrentFramebuffer == Framebuffers[I]) GetMockGL().CurrentFramebuffer = 0;
+        GetMockGL().FramebufferColors.erase(Framebuffers[I]);
+    }
+}
+
+static void __stdcall
+Mock_glBindFramebuffer(GLenum Target, GLuint Framebuffer)
+{
+    MockGLCount("glBindFramebuffer");
+    assert(Target == GL_FRAMEBUFFER && (!Framebuffer || GetMockGL().FramebufferColors.count(Framebuffer)));
+    GetMockGL().CurrentFramebuffer = Framebuffer;
+}
+
+static void __stdcall
+Mock_glFramebufferTexture2D(GLenum Target, GLenum Attachment, GLenum TextureTarget, GLuint Texture, GLint Level)
+{
+    MockGLCount("glFramebufferTexture2D");
+    mock_gl &GL = GetMockGL();
+    assert(Target == GL_FRAMEBUFFER && Attachment == GL_COLOR_ATTACHMENT0 && TextureTarget == GL_TEXTURE_2D && Level == 0);
+    assert(GL.CurrentFramebuffer && (!Texture || GL.TextureObjects.count(Texture)));
+    GL.FramebufferColors[GL.CurrentFramebuffer] = Texture;
+}
+
+// complete with a color attachment that has storage and isn't empty
+static GLenum __stdcall
+Mock_glCheckFramebufferStatus(GLenum)
+{
+    MockGLCount("glCheckFramebufferStatus");
+    mock_gl &GL = GetMockGL();
+    GLuint Texture = GL.FramebufferColors[GL.CurrentFramebuffer];
+    mock_gl_texture *Attached = Texture && GL.TextureObjects.count(Texture)? &GL.TextureObjects[Texture]: 0;
+    bool Complete = Attached && Attached->Format && Attached->Width > 0 && Attached->Height > 0;
+    return Complete? GL_FRAMEBUFFER_COMPLETE: GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT;
+}
+
+//
+// loader
+
+struct mock_gl_function
+{
+    const char *Name;
+    void *Function;
+};
+
+#define MOCK_GL_ENTRY(Name) {#Name, (void *)Mock_##Name}
+
+static const mock_gl_function MockGLFunctions[] =
+{
+    MOCK_GL_ENTRY(glGetProgramiv),
+    MOCK_GL_ENTRY(glGetActiveUniform),
+    MOCK_GL_ENTRY(glGetUniformLocation),
+    MOCK_GL_ENTRY(glUniform1fv), MOCK_GL_ENTRY(glUniform2fv), MOCK_GL_ENTRY(glUniform3fv), MOCK_GL_ENTRY(glUniform4fv),
+    MOCK_GL_ENTRY(glUniform1iv), MOCK_GL_ENTRY(glUniform2iv), MOCK_GL_ENTRY(glUniform3iv), MOCK_GL_ENTRY(glUniform4iv),
+    MOCK_GL_ENTRY(glUniform1uiv), MOCK_GL_ENTRY(glUniform2uiv), MOCK_GL_ENTRY(glUniform3uiv), MOCK_GL_ENTRY(glUniform4uiv),
+    MOCK_GL_ENTRY(glUniform1dv), MOCK_GL_ENTRY(glUniform2dv), MOCK_GL_ENTRY(glUniform3dv), MOCK_GL_ENTRY(glUniform4dv),
+    MOCK_GL_ENTRY(glUniformMatrix2fv), MOCK_GL_ENTRY(glUniformMatrix3fv), MOCK_GL_ENTRY(glUniformMatrix4fv),
+    MOCK_GL_ENTRY(glUniformMatrix2x3fv), MOCK_GL_ENTRY(glUniformMatrix3x2fv), MOCK_GL_ENTRY(glUniformMatrix2x4fv),
+    MOCK_GL_ENTRY(glUniformMatrix4x2fv), MOCK_GL_ENTRY(glUniformMatrix3x4fv), MOCK_GL_ENTRY(glUniformMatrix4x3fv),
+    MOCK_GL_ENTRY(glUniformMatrix2dv), MOCK_GL_ENTRY(glUniformMatrix3dv), MOCK_GL_ENTRY(glUniformMatrix4dv),
+    MOCK_GL_ENTRY(glUniform1f), MOCK_GL_ENTRY(glUniform1i), MOCK_GL_ENTRY(glUniform1ui),
+    MOCK_GL_ENTRY(glGenBuffers), MOCK_GL_ENTRY(glDeleteBuffers), MOCK_GL_ENTRY(glBindBuffer),
+    MOCK_GL_ENTRY(glBufferStorage), MOCK_GL_ENTRY(glBufferData), MOCK_GL_ENTRY(glBufferSubData), MOCK_GL_ENTRY(glMapBufferRange),
+    MOCK_GL_ENTRY(glUnmapBuffer), MOCK_GL_ENTRY(glBindBufferRange), MOCK_GL_ENTRY(glGetIntegerv),
+    MOCK_GL_ENTRY(glFenceSync), MOCK_GL_ENTRY(glClientWaitSync), MOCK_GL_ENTRY(glDeleteSync),
+    MOCK_GL_ENTRY(glGenQueries), MOCK_GL_ENTRY(glDeleteQueries), MOCK_GL_ENTRY(glQueryCounter),
+    MOCK_GL_ENTRY(glGetQueryObjectiv), MOCK_GL_ENTRY(glGetQueryObjectui64v), MOCK_GL_ENTRY(glGetInteger64v),
+    MOCK_GL_ENTRY(glCreateShader), MOCK_GL_ENTRY(glShaderSource), MOCK_GL_ENTRY(glCompileShader),
+    MOCK_GL_ENTRY(glGetShaderiv), MOCK_GL_ENTRY(glGetShaderInfoLog), MOCK_GL_ENTRY(glDetachShader),
+    MOCK_GL_ENTRY(glGetProgramInfoLog), MOCK_GL_ENTRY(glProgramParameteri), MOCK_GL_ENTRY(glGetProgramBinary),
+    MOCK_GL_ENTRY(glProgramBinary), MOCK_GL_ENTRY(glGetString),
+    MOCK_GL_ENTRY(glDeleteShader), MOCK_GL_ENTRY(glCreateProgram), MOCK_GL_ENTRY(glAttachShader),
+    MOCK_GL_ENTRY(glLinkProgram), MOCK_GL_ENTRY(glDeleteProgram), MOCK_GL_ENTRY(glUseProgram),
+    MOCK_GL_ENTRY(glGetAttribLocation),
+    MOCK_GL_ENTRY(glGenVertexArrays), MOCK_GL_ENTRY(glDeleteVertexArrays), MOCK_GL_ENTRY(glBindVertexArray),
+    MOCK_GL_ENTRY(glEnableVertexAttribArray), MOCK_GL_ENTRY(glVertexAttribPointer),
+    MOCK_GL_ENTRY(glDrawArrays), MOCK_GL_ENTRY(glDrawElementsBaseVertex),
+    MOCK_GL_ENTRY(glDrawArraysInstanced), MOCK_GL_ENTRY(glDrawElementsInstancedBaseVertex),
+    MOCK_GL_ENTRY(glMultiDrawElementsIndirect),
+    MOCK_GL_ENTRY(glEnable), MOCK_GL_ENTRY(glDisable), MOCK_GL_ENTRY(glIsEnabled),
+    MOCK_GL_ENTRY(glBlendFunc), MOCK_GL_ENTRY(glBlendFuncSeparate),
+    MOCK_GL_ENTRY(glBlendEquation), MOCK_GL_ENTRY(glBlendEquationSeparate),
+    MOCK_GL_ENTRY(glDepthFunc), MOCK_GL_ENTRY(glDepthMask), MOCK_GL_ENTRY(glGetBooleanv), MOCK_GL_ENTRY(glCullFace),
+    MOCK_GL_ENTRY(glViewport), MOCK_GL_ENTRY(glScissor),
+    MOCK_GL_ENTRY(glActiveTexture), MOCK_GL_ENTRY(glBindTexture), MOCK_GL_ENTRY(glDeleteTextures),
+    MOCK_GL_ENTRY(glGenTextures), MOCK_GL_ENTRY(glTexStorage2D), MOCK_GL_ENTRY(glTexImage2D),
+    MOCK_GL_ENTRY(glTexParameteri),
+    MOCK_GL_ENTRY(glGenFramebuffers), MOCK_GL_ENTRY(glDeleteFramebuffers), MOCK_GL_ENTRY(glBindFramebuffer),
+    MOCK_GL_ENTRY(glFramebufferTexture2D), MOCK_GL_ENTRY(glCheckFramebufferStatus),
+};
+
+inline void *
+MockGLLoad(char *Name)
+{
+    for (const mock_gl_function &Function: MockGLFunctions)
+    {
+        if (strcmp(Function.Name, Name) == 0) return Function.Function;
+    }
+    return 0;
+}
\ No newline at end of file
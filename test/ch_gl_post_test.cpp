@@ -0,0 +1,119 @@
+#include "../kernel.h"
+#include "../ch_gl_post.h"
+#include "ch_gl_mock.h"
+
+static GLuint
+BoundTexture()
+{
+    return GetMockGL().Textures[std::make_pair(GLenum(GL_TEXTURE0), GLenum(GL_TEXTURE_2D))];
+}
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    ch::InvalidateGLState();
+    
+    // one VAO for every triangle, no vertex buffer
+    {
+        ch::DrawGLFullscreenTriangle();
+        ch::DrawGLFullscreenTriangle();
+        GLuint VertexArray = ch::GetGLFullscreenVAO();
+        assert(VertexArray && GetMockGL().CurrentVAO == VertexArray);
+        assert(MockGLCalls("glGenVertexArrays") == 1 && MockGLCalls("glGenBuffers") == 0);
+        assert(MockGLCalls("glBindVertexArray") == 1 && GetMockGL().Draws.size() == 2);
+        const mock_gl_draw &Draw = GetMockGL().Draws[0];
+        assert(Draw.Function == "glDrawArrays" && Draw.Mode == GL_TRIANGLES && Draw.First == 0 && Draw.Count == 3);
+        
+        // and a new one after it's released
+        ch::ReleaseGLFullscreenVAO();
+        assert(GetMockGL().CurrentVAO == 0 && ch::GetGLVertexArray() == 0);
+        ch::DrawGLFullscreenTriangle();
+        assert(MockGLCalls("glGenVertexArrays") == 2 && ch::GetGLFullscreenVAO() != VertexArray);
+    }
+    
+    // the old quad VAO is still the caller's own, one per call, bound through the cache
+    {
+        GLuint ScreenVAO = BuildScreenVAO();
+        GLuint Other = BuildScreenVAO();
+        assert(ScreenVAO && Other && Other != ScreenVAO && Other != ch::GetGLFullscreenVAO());
+        assert(MockGLCalls("glGenBuffers") == 2 && MockGLCalls("glGenVertexArrays") == 4);
+        assert(GetMockGL().CurrentVAO == 0 && ch::GetGLVertexArray() == 0);
+        assert(MockGLBinding(GL_ARRAY_BUFFER) == 0 && ch::GetGLBuffer(GL_ARRAY_BUFFER) == 0);
+        ch::DeleteGLVertexArrays(1, &ScreenVAO);
+        ch::DeleteGLVertexArrays(1, &Other);
+    }
+    
+    ch::gl_post_chain Chain = ch::CreateGLPostChain(640, 360);
+    assert(Chain.FailedCount == 0 && Chain.Framebuffers[0] && Chain.Framebuffers[1] && Chain.Textures[0] != Chain.Textures[1]);
+    for (int ImageI = 0; ImageI < 2; ++ImageI)
+    {
+        mock_gl_texture &Texture = GetMockGL().TextureObjects[Chain.Textures[ImageI]];
+        assert(Texture.Format == GL_RGBA16F && Texture.Width == 640 && Texture.Height == 360);
+        assert(Texture.Parameters[GL_TEXTURE_MIN_FILTER] == GL_LINEAR && Texture.Parameters[GL_TEXTURE_WRAP_S] == GL_CLAMP_TO_EDGE);
+        assert(GetMockGL().FramebufferColors[Chain.Framebuffers[ImageI]] == Chain.Textures[ImageI]);
+    }
+    assert(GetMockGL().CurrentFramebuffer == 0);
+    
+    // passes ping-pong, each reads what the one before wrote
+    {
+        GLuint Scene = 77;
+        size_t DrawsBefore = GetMockGL().Draws.size();
+        ch::SetGLEnabled(GL_DEPTH_TEST, true);
+        ch::ApplyGLPostPass(&Chain, 5, Scene);
+        assert(GetMockGL().CurrentFramebuffer == Chain.Framebuffers[1] && BoundTexture() == Scene);
+        assert(GetMockGL().CurrentProgram == 5 && !GetMockGL().Enabled[GL_DEPTH_TEST]);
+        assert(GetMockGL().Viewport[2] == 640 && GetMockGL().Viewport[3] == 360);
+        assert(ch::GetGLPostTexture(&Chain) == Chain.Textures[1]);
+        
+        ch::ApplyGLPostPass(&Chain, 6);
+        assert(GetMockGL().CurrentFramebuffer == Chain.Framebuffers[0] && BoundTexture() == Chain.Textures[1]);
+        ch::ApplyGLPostPass(&Chain, 7);
+        assert(GetMockGL().CurrentFramebuffer == Chain.Framebuffers[1] && BoundTexture() == Chain.Textures[0]);
+        
+        // the last one goes to the window and leaves the chain where it was
+        ch::ApplyGLPostPass(&Chain, 8, 0, 0, 1280, 720);
+        assert(GetMockGL().CurrentFramebuffer == 0 && BoundTexture() == Chain.Textures[1]);
+        assert(GetMockGL().Viewport[2] == 1280 && ch::GetGLPostTexture(&Chain) == Chain.Textures[1]);
+        
+        // every pass is the same triangle, no vertex array churn
+        assert(GetMockGL().Draws.size() == DrawsBefore + 4 && GetMockGL().CurrentVAO == ch::GetGLFullscreenVAO());
+        for (size_t DrawI = DrawsBefore; DrawI < GetMockGL().Draws.size(); ++DrawI)
+        {
+            assert(GetMockGL().Draws[DrawI].Count == 3);
+        }
+    }
+    
+    // resizing keeps the framebuffers and replaces the textures
+    {
+        GLuint Framebuffers[2] = {Chain.Framebuffers[0], Chain.Framebuffers[1]};
+        GLuint OldTexture = Chain.Textures[0];
+        int TexturesBefore = MockGLCalls("glGenTextures");
+        ch::ResizeGLPostChain(&Chain, 640, 360);
+        assert(MockGLCalls("glGenTextures") == TexturesBefore);
+        
+        ch::ResizeGLPostChain(&Chain, 1920, 1080);
+        assert(Chain.Framebuffers[0] == Framebuffers[0] && Chain.Framebuffers[1] == Framebuffers[1]);
+        assert(MockGLCalls("glGenFramebuffers") == 1 && Chain.FailedCount == 0 && Chain.Current == 0);
+        assert(!GetMockGL().TextureObjects.count(OldTexture) && GetMockGL().TextureObjects.size() == 2);
+        assert(GetMockGL().TextureObjects[Chain.Textures[1]].Width == 1920);
+        assert(GetMockGL().FramebufferColors[Framebuffers[1]] == Chain.Textures[1]);
+        
+        ch::ApplyGLPostPass(&Chain, 5);
+        assert(GetMockGL().Viewport[2] == 1920 && GetMockGL().Viewport[3] == 1080);
+    }
+    
+    // an incomplete framebuffer is counted
+    {
+        ch::gl_post_chain Empty = ch::CreateGLPostChain(0, 0);
+        assert(Empty.FailedCount == 2);
+        ch::DestroyGLPostChain(&Empty);
+    }
+    
+    ch::DestroyGLPostChain(&Chain);
+    assert(GetMockGL().FramebufferColors.empty() && GetMockGL().TextureObjects.empty() && Chain.Framebuffers[0] == 0);
+    assert(BoundTexture() == 0 && ch::GetGLTexture(GL_TEXTURE_2D) == 0);
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "../kernel.h"
+#include "../ch_gl_profile.h"
+#include "ch_gl_mock.h"
+#include <math.h>
+
+static void
+MarkQueriesFinished()
+{
+    GetMockGL().FinishedQueries = GetMockGL().NextQuerySerial;
+}
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    
+    // nothing happens before init
+    {
+        CH_GL_ZONE("early");
+        ch::BeginGLProfileFrame();
+        assert(MockGLCalls("glQueryCounter") == 0);
+    }
+    
+    ch::InitGLProfiler();
+    ch::gl_profiler *Profiler = ch::GetGLProfiler();
+    assert(GetMockGL().Queries.size() == CH_GL_PROFILE_FRAMES * CH_GL_PROFILE_FRAME_EVENTS);
+    assert(MockGLCalls("glGetInteger64v") == 1 && Profiler->GPUBase == 1000000);
+    
+    // the GPU is behind, nothing is read and nothing waits
+    GetMockGL().FinishedQueries = 0;
+    ch::BeginGLProfileFrame();
+    {
+        CH_GL_ZONE("outer");
+        {
+            CH_GL_ZONE("inner");
+        }
+    }
+    {
+        CH_GL_ZONE("after");
+    }
+    assert(Profiler->Frames[Profiler->FrameIndex].EventCount == 7);
+    ch::BeginGLProfileFrame();
+    assert(Profiler->ReadFrames == 0 && ch::GetGLFrameMilliseconds() == 0.0);
+    assert(MockGLCalls("glGetQueryObjectui64v") == 0);
+    
+    // once it catches up the first frame is read, the second only ended now
+    MarkQueriesFinished();
+    ch::BeginGLProfileFrame();
+    assert(Profiler->ReadFrames == 1 && Profiler->LateFrames == 0 && GetMockGL().QueryStalls == 0);
+    assert(MockGLCalls("glGetQueryObjectui64v") == 8);
+    
+    // 8 queries a microsecond apart
+    assert(fabs(ch::GetGLFrameMilliseconds() - 0.007) < 1e-5);
+    
+    // exported with the CPU zones, nested as they were issued
+    {
+        size_t Size = 0;
+        char *Trace = ch::ExportChromeTrace(&Size);
+        assert(strstr(Trace, "\"args\":{\"name\":\"gpu\"}"));
+        const char *Outer = strstr(Trace, "{\"name\":\"outer\",\"ph\":\"B\"");
+        const char *Inner = strstr(Trace, "{\"name\":\"inner\",\"ph\":\"B\"");
+        const char *After = strstr(Trace, "{\"name\":\"after\",\"ph\":\"B\"");
+        assert(Outer && Inner && After && Outer < Inner && Inner < After);
+        assert(!strstr(Trace, "early"));
+        
+        int Begins = 0;
+        int Ends = 0;
+        for (const char *At = Trace; (At = strstr(At, "\"ph\":\"")) != 0; At += 6)
+        {
+            if (At[6] == 'B') ++Begins;
+            if (At[6] == 'E') ++Ends;
+        }
+        assert(Begins == 4 && Ends == 4);
+        
+        // a query step is a microsecond
+        const char *Timestamp = strstr(Inner, "\"ts\":");
+        const char *OuterTimestamp = strstr(Outer, "\"ts\":");
+        f64 Difference = atof(Timestamp + 5) - atof(OuterTimestamp + 5);
+        assert(fabs(Difference - 1.0) < 0.01);
+        free(Trace);
+    }
+    
+    // a frame not done when its queries come around is dropped, not waited for
+    {
+        MarkQueriesFinished();
+        ch::BeginGLProfileFrame();
+        u64 ReadBefore = Profiler->ReadFrames;
+        GetMockGL().FinishedQueries = GetMockGL().NextQuerySerial;
+        for (int FrameI = 0; FrameI < CH_GL_PROFILE_FRAMES; ++FrameI)
+        {
+            CH_GL_ZONE("slow");
+            ch::BeginGLProfileFrame();
+        }
+        // the frame that was done is read on the way, the next one never finishes in time
+        assert(Profiler->ReadFrames == ReadBefore + 1 && Profiler->LateFrames == 1);
+        assert(GetMockGL().QueryStalls == 0);
+        
+        // the ones still in flight are read once the GPU catches up, but for the one ended now
+        MarkQueriesFinished();
+        ch::BeginGLProfileFrame();
+        assert(Profiler->ReadFrames == ReadBefore + CH_GL_PROFILE_FRAMES);
+        assert(GetMockGL().QueryStalls == 0);
+    }
+    
+    // a full frame drops whole zones and still ends the open ones
+    {
+        ch::BeginGLProfileFrame();
+        {
+            CH_GL_ZONE("open");
+            for (int ZoneI = 0; ZoneI < 200; ++ZoneI)
+            {
+                CH_GL_ZONE("many");
+                CH_GL_ZONE("nested");
+            }
+            ch::gl_profile_frame *Frame = &Profiler->Frames[Profiler->FrameIndex];
+            assert(Frame->EventCount + Profiler->Depth <= CH_GL_PROFILE_FRAME_EVENTS);
+            assert(Profiler->DroppedZones > 0 && Profiler->SkipDepth == 0 && Profiler->Depth == 2);
+        }
+        assert(Profiler->Depth == 1);
+        ch::BeginGLProfileFrame();
+        ch::gl_profile_frame *Previous = &Profiler->Frames[(Profiler->FrameIndex + CH_GL_PROFILE_FRAMES - 1) % CH_GL_PROFILE_FRAMES];
+        int Open = 0;
+        for (u32 EventI = 0; EventI < Previous->EventCount; ++EventI)
+        {
+            Open += Previous->Names[EventI]? 1: -1;
+            assert(Open >= 0);
+        }
+        assert(Open == 0 && Previous->EventCount == CH_GL_PROFILE_FRAME_EVENTS);
+        assert(Profiler->DroppedZones == 400 - (CH_GL_PROFILE_FRAME_EVENTS - 4) / 2);
+    }
+    
+    ch::ShutdownGLProfiler();
+    assert(GetMockGL().Queries.empty());
+    ch::BeginGLProfileFrame();
+    {
+        CH_GL_ZONE("late");
+    }
+    assert(!Profiler->Initialized && Profiler->Depth == 0);
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
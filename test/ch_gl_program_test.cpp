@@ -0,0 +1,204 @@
+#include "../kernel.h"
+#include "../ch_gl_program.h"
+#include "ch_gl_mock.h"
+
+static const char *VertexSource = "#version 450\nvoid main() { gl_Position = vec4(0); }\n";
+static const char *FragmentSource = "#version 450\nout vec4 Color;\nvoid main() { Color = vec4(1); }\n";
+static const char *BrokenSource = "#version 450\n#error nope\n";
+
+static const char *CacheDirectory = "ch_gl_program_test_cache";
+
+static ch::gl_program_desc
+MakeDesc(const char *Name, const char *Fragment, const char *Defines = 0)
+{
+    ch::gl_program_desc Desc = {};
+    Desc.Name = Name;
+    Desc.Stages[0] = {GL_VERTEX_SHADER, VertexSource};
+    Desc.Stages[1] = {GL_FRAGMENT_SHADER, Fragment};
+    Desc.StageCount = 2;
+    Desc.Defines = Defines;
+    return Desc;
+}
+
+static void
+RemoveEntry(ch::gl_program_cache *Cache, const ch::gl_program_desc *Desc)
+{
+    char Path[600];
+    ch::GetGLProgramCachePath(Path, sizeof(Path), Cache, ch::GetGLProgramKey(Cache, Desc));
+    remove(Path);
+}
+
+// the first place Function appears in the call order, -1 if it doesn't
+static int
+FirstCall(const char *Function)
+{
+    const std::vector<std::string> &Calls = GetMockGL().CallOrder;
+    for (size_t I = 0; I < Calls.size(); ++I)
+    {
+        if (Calls[I] == Function) return int(I);
+    }
+    return -1;
+}
+
+static int
+LastCall(const char *Function)
+{
+    const std::vector<std::string> &Calls = GetMockGL().CallOrder;
+    for (size_t I = Calls.size(); I > 0; --I)
+    {
+        if (Calls[I - 1] == Function) return int(I - 1);
+    }
+    return -1;
+}
+
+int main()
+{
+    MockGLReset();
+    GetMockGL().Integers[GL_NUM_PROGRAM_BINARY_FORMATS] = 1;
+    LoadGLFunctions(MockGLLoad);
+    
+    ch::gl_program_desc Descs[3] =
+    {
+        MakeDesc("plain", FragmentSource),
+        MakeDesc("defined", FragmentSource, "#define SHADOWS 1\n"),
+        MakeDesc("other", VertexSource),
+    };
+    
+    ch::gl_program_cache Cache = ch::InitGLProgramCache(CacheDirectory);
+    assert(Cache.BinariesSupported && strcmp(Cache.Directory, CacheDirectory) == 0);
+    for (int DescI = 0; DescI < 3; ++DescI) RemoveEntry(&Cache, &Descs[DescI]);
+    
+    // keys follow sources, defines and the driver
+    {
+        u64 Keys[3];
+        for (int DescI = 0; DescI < 3; ++DescI) Keys[DescI] = ch::GetGLProgramKey(&Cache, &Descs[DescI]);
+        assert(Keys[0] != Keys[1] && Keys[0] != Keys[2] && Keys[1] != Keys[2]);
+        assert(ch::GetGLProgramKey(&Cache, &Descs[0]) == Keys[0]);
+        
+        GetMockGL().Strings[1] = "Other Renderer";
+        ch::gl_program_cache Other = ch::InitGLProgramCache(0);
+        assert(ch::GetGLProgramKey(&Other, &Descs[0]) != Keys[0] && !Other.Directory[0]);
+        GetMockGL().Strings[1] = "Mock Renderer";
+        Other = ch::InitGLProgramCache(0);
+        assert(ch::GetGLProgramKey(&Other, &Descs[0]) == Keys[0]);
+    }
+    
+    // first run compiles everything before asking how it went, and keeps the binaries
+    GLuint Programs[3];
+    {
+        GetMockGL().CallOrder.clear();
+        assert(ch::BuildGLPrograms(&Cache, Descs, 3, Programs) == 3);
+        assert(Programs[0] && Programs[1] && Programs[2]);
+        assert(Cache.Builds == 3 && Cache.Hits == 0 && Cache.Failures == 0 && Cache.WriteFailures == 0);
+        assert(MockGLCalls("glCompileShader") == 6 && MockGLCalls("glLinkProgram") == 3);
+        assert(MockGLCalls("glGetShaderiv") == 0 && MockGLCalls("glGetProgramBinary") == 3);
+        assert(LastCall("glLinkProgram") < FirstCall("glGetProgramiv"));
+        assert(LastCall("glCompileShader") < FirstCall("glCreateProgram"));
+        assert(MockGLCalls("glDeleteShader") == 6 && GetMockGL().Shaders.empty());
+        
+        // the defines went after #version
+        const std::string &Binary = MockGLFindProgram(Programs[1])->Binary;
+        assert(Binary.find("#version 450\n#define SHADOWS 1\nvoid main()") == 0);
+        assert(MockGLFindProgram(Programs[0])->Binary.find("#version 450\nvoid main()") == 0);
+    }
+    
+    // the next run takes the binaries, nothing compiles
+    {
+        MockGLReset();
+        GetMockGL().Integers[GL_NUM_PROGRAM_BINARY_FORMATS] = 1;
+        ch::gl_program_cache Next = ch::InitGLProgramCache(CacheDirectory);
+        assert(ch::BuildGLPrograms(&Next, Descs, 3, Programs) == 3);
+        assert(Next.Hits == 3 && Next.Builds == 0 && Next.Rejects == 0);
+        assert(MockGLCalls("glCompileShader") == 0 && MockGLCalls("glCreateShader") == 0);
+        assert(MockGLCalls("glProgramBinary") == 3);
+        assert(MockGLFindProgram(Programs[1])->Binary.find("#define SHADOWS 1") != std::string::npos);
+    }
+    
+    // a driver that refuses the binary gets the program compiled
+    {
+        MockGLReset();
+        GetMockGL().Integers[GL_NUM_PROGRAM_BINARY_FORMATS] = 1;
+        GetMockGL().ProgramBinaryFormat = 0x9002;
+        ch::gl_program_cache Next = ch::InitGLProgramCache(CacheDirectory);
+        GLuint Program = ch::BuildGLProgram(&Next, &Descs[0]);
+        assert(Program && !MockGLFindProgram(Program)->LinkFailed);
+        assert(Next.Rejects == 1 && Next.Hits == 0 && Next.Builds == 1);
+        assert(MockGLCalls("glCompileShader") == 2 && MockGLCalls("glDeleteProgram") == 1);
+        
+        // and its binary replaces the old one
+        MockGLReset();
+        GetMockGL().Integers[GL_NUM_PROGRAM_BINARY_FORMATS] = 1;
+        GetMockGL().ProgramBinaryFormat = 0x9002;
+        Next = ch::InitGLProgramCache(CacheDirectory);
+        assert(ch::BuildGLProgram(&Next, &Descs[0]) && Next.Hits == 1 && Next.Rejects == 0);
+    }
+    
+    // a broken program is 0 with a log, the others still build
+    {
+        MockGLReset();
+        GetMockGL().Integers[GL_NUM_PROGRAM_BINARY_FORMATS] = 1;
+        ch::gl_program_cache Next = ch::InitGLProgramCache(CacheDirectory);
+        ch::gl_program_desc Mixed[3] = {MakeDesc("broken", BrokenSource), Descs[2], MakeDesc("new", FragmentSource, "#define X 2\n")};
+        RemoveEntry(&Next, &Mixed[2]);
+        GetMockGL().CallOrder.clear();
+        assert(ch::BuildGLPrograms(&Next, Mixed, 3, Programs) == 2);
+        assert(Programs[0] == 0 && Programs[1] && Programs[2]);
+        assert(Next.Failures == 1 && Next.Hits == 1 && Next.Builds == 1);
+        assert(strcmp(Next.Log, "broken: error: #error") == 0);
+        assert(LastCall("glCompileShader") < FirstCall("glGetShaderiv"));
+        assert(LastCall("glLinkProgram") < FirstCall("glGetShaderiv"));
+        assert(GetMockGL().Shaders.empty());
+        
+        // the log is the last failure's
+        ch::gl_program_desc Again = MakeDesc("again", BrokenSource);
+        assert(!ch::BuildGLProgram(&Next, &Again));
+        assert(Next.Failures == 2 && strcmp(Next.Log, "again: error: #error") == 0);
+        
+        char Path[600];
+        ch::GetGLProgramCachePath(Path, sizeof(Path), &Next, ch::GetGLProgramKey(&Next, &Mixed[0]));
+        FILE *File = fopen(Path, "rb");
+        assert(!File);
+        RemoveEntry(&Next, &Mixed[2]);
+    }
+    
+    // a damaged entry is a miss
+    {
+        MockGLReset();
+        GetMockGL().Integers[GL_NUM_PROGRAM_BINARY_FORMATS] = 1;
+        ch::gl_program_cache Next = ch::InitGLProgramCache(CacheDirectory);
+        char Path[600];
+        ch::GetGLProgramCachePath(Path, sizeof(Path), &Next, ch::GetGLProgramKey(&Next, &Descs[1]));
+        FILE *File = fopen(Path, "wb");
+        fwrite("junk", 1, 4, File);
+        fclose(File);
+        assert(ch::BuildGLProgram(&Next, &Descs[1]) && Next.Hits == 0 && Next.Builds == 1);
+        assert(MockGLCalls("glProgramBinary") == 0);
+    }
+    
+    // no binary formats, no files
+    {
+        MockGLReset();
+        ch::gl_program_cache Next = ch::InitGLProgramCache(CacheDirectory);
+        assert(!Next.BinariesSupported && !Next.Directory[0]);
+        assert(ch::BuildGLProgram(&Next, &Descs[0]) && Next.Builds == 1);
+        assert(MockGLCalls("glGetProgramBinary") == 0 && MockGLCalls("glProgramParameteri") == 0);
+    }
+    
+    // a name deleted around the uniform registry and handed out again doesn't keep its locations
+    {
+        MockGLReset();
+        GLuint Reused = GetMockGL().NextObject + 2; // what glCreateProgram gives after the two shaders
+        MockGLAddUniform(MockGLAddProgram(Reused), "Stale", GL_FLOAT, 1);
+        assert(ch::GetUniformLocation(Reused, "Stale") >= 0);
+        glDeleteProgram(Reused);
+        ch::gl_program_cache Next = ch::InitGLProgramCache(0);
+        assert(ch::BuildGLProgram(&Next, &Descs[0]) == Reused);
+        assert(ch::GetUniformLocation(Reused, "Stale") == -1);
+    }
+    
+    for (int DescI = 0; DescI < 3; ++DescI) RemoveEntry(&Cache, &Descs[DescI]);
+    remove(CacheDirectory);
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "../kernel.h"
+#include "../ch_gl_ring.h"
+#include "ch_gl_mock.h"
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    
+    ch::gl_frame_ring Ring = ch::CreateFrameRing(GL_UNIFORM_BUFFER, 3 * 1000, 256);
+    assert(Ring.RegionSize == 768 && Ring.Size == 3 * 768 && Ring.Alignment == 256);
+    mock_gl_buffer *Buffer = MockGLFindBuffer(Ring.Buffer);
+    assert(Buffer && Buffer->Storage.size() == Ring.Size && Buffer->Mapped && Ring.Mapped);
+    assert(GetMockGL().BoundBuffers[GL_UNIFORM_BUFFER] == 0);
+    
+    // a reservation is aligned from the head and doesn't move it
+    {
+        ch::BeginRingFrame(&Ring);
+        u32 Offset = 1;
+        assert(ch::ReserveRing(&Ring, 100, 16, &Offset) && Offset == 0 && Ring.Head == 0);
+        Ring.Head = 100;
+        assert(ch::ReserveRing(&Ring, 100, 16, &Offset) && Offset == 112);
+        
+        // up to the end of the region, not past it, and nothing at all isn't a reservation
+        assert(ch::ReserveRing(&Ring, 768 - 112, 16, &Offset));
+        assert(!ch::ReserveRing(&Ring, 768 - 111, 16, &Offset) && Ring.FailedCount == 1);
+        assert(!ch::ReserveRing(&Ring, 0, 16, &Offset) && Ring.FailedCount == 2);
+        Ring.Head = 768;
+        assert(!ch::ReserveRing(&Ring, 1, 1, &Offset) && Offset == 112 && Ring.FailedCount == 3);
+        ch::EndRingFrame(&Ring);
+    }
+    
+    // frames go round the regions, a region still read by the GPU is waited on
+    {
+        for (u32 FrameI = 1; FrameI < CH_GL_RING_FRAMES; ++FrameI)
+        {
+            ch::BeginRingFrame(&Ring);
+            assert(Ring.Head == FrameI * 768 && Ring.End == Ring.Head + 768);
+            ch::EndRingFrame(&Ring);
+        }
+        assert(MockGLCalls("glClientWaitSync") == 0 && GetMockGL().LiveSyncs == CH_GL_RING_FRAMES);
+        
+        GetMockGL().PendingSyncs[1] = 2;
+        ch::BeginRingFrame(&Ring);
+        assert(Ring.Head == 0 && Ring.WaitCount == 1 && MockGLCalls("glClientWaitSync") == 3);
+        assert(GetMockGL().LiveSyncs == CH_GL_RING_FRAMES - 1);
+        ch::EndRingFrame(&Ring);
+        assert(ch::WaitForRingFence(Ring.Fences[1]) == false);
+    }
+    
+    GLuint Id = Ring.Buffer;
+    ch::DestroyFrameRing(&Ring);
+    assert(!MockGLFindBuffer(Id) && GetMockGL().LiveSyncs == 0 && Ring.Buffer == 0);
+    assert(GetMockGL().BoundBuffers[GL_UNIFORM_BUFFER] == 0);
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
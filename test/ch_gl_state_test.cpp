@@ -0,0 +1,259 @@
+#include "../kernel.h"
+#include "../ch_gl_state.h"
+#include "ch_gl_mock.h"
+
+// the cache and the mock's actual state have to agree
+static void
+CheckAgainstMock()
+{
+    mock_gl &GL = GetMockGL();
+    u64 DriverQueries = ch::GetGLStateCache()->DriverQueryCount;
+    assert(ch::GetGLProgram() == GL.CurrentProgram);
+    assert(ch::GetGLVertexArray() == GL.CurrentVAO);
+    assert(ch::GetGLBuffer(GL_ARRAY_BUFFER) == MockGLBinding(GL_ARRAY_BUFFER));
+    assert(ch::GetGLBuffer(GL_ELEMENT_ARRAY_BUFFER) == MockGLBinding(GL_ELEMENT_ARRAY_BUFFER));
+    assert(ch::GetGLBuffer(GL_UNIFORM_BUFFER) == MockGLBinding(GL_UNIFORM_BUFFER));
+    assert(ch::GetGLActiveTexture() == GL.ActiveTexture);
+    assert(ch::GetGLTexture(GL_TEXTURE_2D) == GL.Textures[std::make_pair(GL.ActiveTexture, GLenum(GL_TEXTURE_2D))]);
+    assert(ch::GetGLTexture(GL_TEXTURE_3D) == GL.Textures[std::make_pair(GL.ActiveTexture, GLenum(GL_TEXTURE_3D))]);
+    for (GLenum Capability: {GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST})
+    {
+        assert(ch::IsGLEnabled(Capability) == GL.Enabled[Capability]);
+    }
+    GLenum Blend[4];
+    ch::GetGLBlendFunc(&Blend[0], &Blend[1], &Blend[2], &Blend[3]);
+    assert(memcmp(Blend, GL.BlendFunc, sizeof(Blend)) == 0);
+    ch::GetGLBlendEquation(&Blend[0], &Blend[1]);
+    assert(Blend[0] == GL.BlendEquation[0] && Blend[1] == GL.BlendEquation[1]);
+    assert(ch::GetGLDepthFunc() == GL.DepthFunc);
+    assert(ch::GetGLDepthMask() == (GL.DepthMask == GL_TRUE));
+    assert(ch::GetGLCullFace() == GL.CullFace);
+    GLint Rect[4];
+    ch::GetGLViewport(Rect);
+    assert(memcmp(Rect, GL.Viewport, sizeof(Rect)) == 0);
+    ch::GetGLScissor(Rect);
+    assert(memcmp(Rect, GL.Scissor, sizeof(Rect)) == 0);
+    
+    // the element buffer after a vertex array change is the only thing it can't know
+    assert(ch::GetGLStateCache()->DriverQueryCount - DriverQueries <= 1);
+}
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    ch::gl_state_cache *Cache = ch::GetGLStateCache();
+    
+    // a fresh context: known without asking, except the viewport and scissor box
+    {
+        GetMockGL().Viewport[2] = 1280;
+        GetMockGL().Viewport[3] = 720;
+        GetMockGL().Scissor[2] = 1280;
+        GetMockGL().Scissor[3] = 720;
+        assert(ch::GetGLProgram() == 0 && !ch::IsGLEnabled(GL_BLEND) && ch::GetGLDepthFunc() == GL_LESS);
+        assert(MockGLCalls("glGetIntegerv") == 0 && MockGLCalls("glIsEnabled") == 0);
+        
+        GLint Viewport[4];
+        ch::GetGLViewport(Viewport);
+        ch::GetGLViewport(Viewport);
+        assert(Viewport[2] == 1280 && Viewport[3] == 720);
+        assert(MockGLCalls("glGetIntegerv") == 1 && Cache->DriverQueryCount == 1);
+        CheckAgainstMock();
+        assert(MockGLCalls("glGetIntegerv") == 2 && MockGLCalls("glIsEnabled") == 0 && MockGLCalls("glGetBooleanv") == 0);
+    }
+    
+    // what changes nothing doesn't reach the driver
+    {
+        u64 Calls = Cache->CallCount;
+        u64 Elided = Cache->ElidedCount;
+        ch::SetGLProgram(7);
+        ch::SetGLProgram(7);
+        ch::SetGLEnabled(GL_BLEND, true);
+        ch::SetGLEnabled(GL_BLEND, true);
+        ch::SetGLEnabled(GL_DEPTH_TEST, false);
+        ch::SetGLViewport(0, 0, 1280, 720);
+        ch::SetGLViewport(0, 0, 640, 360);
+        assert(MockGLCalls("glUseProgram") == 1 && MockGLCalls("glEnable") == 1 && MockGLCalls("glDisable") == 0);
+        assert(MockGLCalls("glViewport") == 1);
+        assert(Cache->CallCount - Calls == 3 && Cache->ElidedCount - Elided == 4);
+        
+        // the plain entry points when RGB and alpha agree
+        ch::SetGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        ch::SetGLBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+        ch::SetGLBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+        ch::SetGLBlendEquation(GL_FUNC_ADD);
+        ch::SetGLBlendEquationSeparate(GL_FUNC_ADD, GL_MAX);
+        assert(MockGLCalls("glBlendFunc") == 1 && MockGLCalls("glBlendFuncSeparate") == 1);
+        assert(MockGLCalls("glBlendEquation") == 0 && MockGLCalls("glBlendEquationSeparate") == 1);
+        
+        // textures per unit
+        ch::SetGLActiveTexture(GL_TEXTURE0);
+        ch::SetGLTexture(GL_TEXTURE_2D, 11);
+        ch::SetGLActiveTexture(GL_TEXTURE3);
+        ch::SetGLTexture(GL_TEXTURE_2D, 11);
+        ch::SetGLActiveTexture(GL_TEXTURE0);
+        ch::SetGLTexture(GL_TEXTURE_2D, 11);
+        assert(MockGLCalls("glActiveTexture") == 2 && MockGLCalls("glBindTexture") == 2);
+        CheckAgainstMock();
+    }
+    
+    // vertex arrays hold the element buffer, deleting unbinds
+    {
+        ch::SetGLVertexArray(20);
+        ch::SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, 30);
+        ch::SetGLVertexArray(21);
+        ch::SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, 31);
+        int Binds = MockGLCalls("glBindBuffer");
+        ch::SetGLVertexArray(20);
+        ch::SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, 30);
+        assert(MockGLCalls("glBindBuffer") == Binds + 1);
+        CheckAgainstMock();
+        
+        GLuint Buffer = 0;
+        glGenBuffers(1, &Buffer);
+        ch::SetGLBuffer(GL_ARRAY_BUFFER, Buffer);
+        ch::DeleteGLBuffers(1, &Buffer);
+        assert(ch::GetGLBuffer(GL_ARRAY_BUFFER) == 0);
+        GLuint Texture = 11;
+        ch::DeleteGLTextures(1, &Texture);
+        ch::SetGLActiveTexture(GL_TEXTURE3);
+        assert(ch::GetGLTexture(GL_TEXTURE_2D) == 0);
+        CheckAgainstMock();
+        
+        GLuint VertexArray = 20;
+        ch::DeleteGLVertexArrays(1, &VertexArray);
+        CheckAgainstMock();
+    }
+    
+    // random changes through the cache, the driver sees only the real ones
+    {
+        u32 Seed = 12345;
+        for (int Step = 0; Step < 5000; ++Step)
+        {
+            Seed = Seed * 1664525u + 1013904223u;
+            u32 R = Seed >> 8;
+            u32 Value = (R >> 4) % 3;
+            switch (R % 12)
+            {
+                case 0: ch::SetGLProgram(Value); break;
+                case 1: ch::SetGLVertexArray(40 + Value); break;
+                case 2: ch::SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, 50 + Value); break;
+                case 3: ch::SetGLBuffer(GL_UNIFORM_BUFFER, Value); break;
+                case 4: ch::SetGLActiveTexture(GL_TEXTURE0 + Value); break;
+                case 5: ch::SetGLTexture(Value == 2? GL_TEXTURE_3D: GL_TEXTURE_2D, 60 + Value); break;
+                case 6: ch::SetGLEnabled(Value == 0? GL_CULL_FACE: GL_SCISSOR_TEST, (R >> 10) & 1); break;
+                case 7: ch::SetGLBlendFuncSeparate(GL_ONE, Value == 0? GL_ZERO: GL_ONE, GL_ONE, Value == 1? GL_ZERO: GL_ONE); break;
+                case 8: ch::SetGLDepthMask(Value == 0); break;
+                case 9: ch::SetGLCullFace(Value == 0? GL_FRONT: GL_BACK); break;
+                case 10: ch::SetGLScissor(0, 0, 10 * GLsizei(Value), 10); break;
+                case 11: ch::SetGLDepthFunc(Value == 0? GL_LEQUAL: GL_LESS); break;
+            }
+            if (Step % 50 == 0) CheckAgainstMock();
+        }
+        CheckAgainstMock();
+        assert(Cache->ElidedCount > Cache->CallCount / 2);
+    }
+    
+    // a UI pass: save, change, restore. Nothing is asked of the driver once the state is known
+    {
+        ch::SetGLVertexArray(0);
+        ch::SetGLBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        ch::SetGLEnabled(GL_DEPTH_TEST, true);
+        ch::SetGLEnabled(GL_CULL_FACE, true);
+        ch::SetGLProgram(2);
+        ch::SetGLActiveTexture(GL_TEXTURE1);
+        mock_gl Before = GetMockGL();
+        
+        for (int Frame = 0; Frame < 3; ++Frame)
+        {
+            int Queries = MockGLCalls("glGetIntegerv") + MockGLCalls("glIsEnabled") + MockGLCalls("glGetBooleanv");
+            u64 Calls = Cache->CallCount;
+            ch::gl_state Saved = ch::SaveGLState();
+            ch::SetGLEnabled(GL_BLEND, true);
+            ch::SetGLBlendEquation(GL_FUNC_ADD);
+            ch::SetGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            ch::SetGLEnabled(GL_CULL_FACE, false);
+            ch::SetGLEnabled(GL_DEPTH_TEST, false);
+            ch::SetGLEnabled(GL_SCISSOR_TEST, true);
+            ch::SetGLActiveTexture(GL_TEXTURE0);
+            ch::SetGLViewport(0, 0, 1280, 720);
+            ch::SetGLProgram(90);
+            ch::SetGLVertexArray(91);
+            for (int Command = 0; Command < 4; ++Command)
+            {
+                ch::SetGLTexture(GL_TEXTURE_2D, 92);
+                ch::SetGLScissor(0, 0, 100 * Command, 50);
+            }
+            ch::RestoreGLState(&Saved);
+            
+            assert(MockGLCalls("glGetIntegerv") + MockGLCalls("glIsEnabled") + MockGLCalls("glGetBooleanv") == Queries);
+            assert(GetMockGL().CurrentProgram == Before.CurrentProgram && GetMockGL().CurrentVAO == Before.CurrentVAO);
+            assert(GetMockGL().ActiveTexture == Before.ActiveTexture && GetMockGL().Textures == Before.Textures);
+            assert(GetMockGL().Enabled == Before.Enabled && GetMockGL().ElementBuffers == Before.ElementBuffers);
+            assert(memcmp(GetMockGL().BlendFunc, Before.BlendFunc, sizeof(Before.BlendFunc)) == 0);
+            assert(memcmp(GetMockGL().BlendEquation, Before.BlendEquation, sizeof(Before.BlendEquation)) == 0);
+            assert(memcmp(GetMockGL().Viewport, Before.Viewport, sizeof(Before.Viewport)) == 0);
+            assert(memcmp(GetMockGL().Scissor, Before.Scissor, sizeof(Before.Scissor)) == 0);
+            
+            // changes and restores, no more than a pair per piece of state
+            assert(Cache->CallCount - Calls <= 2 * 13);
+            CheckAgainstMock();
+        }
+    }
+    
+    // after GL called around the cache: unknown, asked once, then known again
+    {
+        glUseProgram(77);
+        glEnable(GL_BLEND);
+        glBindVertexArray(78);
+        ch::InvalidateGLState();
+        int Queries = MockGLCalls("glGetIntegerv");
+        assert(ch::GetGLProgram() == 77 && ch::IsGLEnabled(GL_BLEND) && ch::GetGLVertexArray() == 78);
+        assert(ch::GetGLProgram() == 77);
+        assert(MockGLCalls("glGetIntegerv") == Queries + 2 && MockGLCalls("glIsEnabled") == 1);
+        
+        // setting unknown state always goes through
+        int Disables = MockGLCalls("glDisable");
+        ch::SetGLEnabled(GL_DEPTH_TEST, false);
+        assert(MockGLCalls("glDisable") == Disables + 1);
+        
+        ch::SaveGLState();
+        CheckAgainstMock();
+    }
+    
+    // a UI pass after the app changed state around the cache and invalidated what it changed:
+    // only that is asked for, the restore puts back what the driver had
+    {
+        ch::SetGLProgram(2);
+        ch::SetGLEnabled(GL_DEPTH_TEST, true);
+        ch::SetGLViewport(0, 0, 640, 360);
+        glUseProgram(81);
+        glDisable(GL_DEPTH_TEST);
+        glBindVertexArray(82);
+        glViewport(0, 0, 320, 180);
+        ch::InvalidateGLState(ch::GL_STATE_PROGRAM_BIT | ch::GL_STATE_ENABLES_BIT |
+                              ch::GL_STATE_VERTEX_ARRAY_BIT | ch::GL_STATE_VIEWPORT_BIT);
+        mock_gl Before = GetMockGL();
+        
+        int Queries = MockGLCalls("glGetIntegerv");
+        int EnabledQueries = MockGLCalls("glIsEnabled");
+        ch::gl_state Saved = ch::SaveGLState();
+        
+        // program, vertex array and its element buffer, viewport; the four enables
+        assert(MockGLCalls("glGetIntegerv") == Queries + 4);
+        assert(MockGLCalls("glIsEnabled") == EnabledQueries + ch::GL_STATE_CAPABILITY_COUNT);
+        ch::SetGLEnabled(GL_DEPTH_TEST, false);
+        ch::SetGLViewport(0, 0, 1280, 720);
+        ch::SetGLProgram(90);
+        ch::SetGLVertexArray(91);
+        ch::RestoreGLState(&Saved);
+        
+        assert(GetMockGL().CurrentProgram == 81 && GetMockGL().CurrentVAO == 82);
+        assert(GetMockGL().Enabled == Before.Enabled && !GetMockGL().Enabled[GL_DEPTH_TEST]);
+        assert(memcmp(GetMockGL().Viewport, Before.Viewport, sizeof(Before.Viewport)) == 0);
+        CheckAgainstMock();
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "../kernel.h"
+#include "../ch_gl_stream.h"
+#include "ch_gl_mock.h"
+
+// like ImDrawVert, 20 bytes
+struct ui_vertex
+{
+    f32 Position[2];
+    f32 UV[2];
+    u32 Color;
+};
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    
+    // allocate/write/commit inside a frame's region
+    {
+        ch::gl_stream_buffer Stream = ch::CreateStreamBuffer(3 * 1000);
+        assert(Stream.RegionSize == 768 && Stream.Size == 3 * 768);
+        mock_gl_buffer *Buffer = MockGLFindBuffer(Stream.Buffer);
+        assert(Buffer && Buffer->Storage.size() == Stream.Size && Buffer->Mapped);
+        assert(Buffer->Flags == (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
+        assert(GetMockGL().BoundBuffers[GL_COPY_WRITE_BUFFER] == 0);
+        assert(GetMockGL().BoundBuffers[GL_ARRAY_BUFFER] == 0 && GetMockGL().BoundBuffers[GL_ELEMENT_ARRAY_BUFFER] == 0);
+        
+        ch::BeginStreamFrame(&Stream);
+        ui_vertex Vertices[3] = {{{1, 2}, {0, 0}, 0xFFu}, {{3, 4}, {1, 0}, 0xFF00u}, {{5, 6}, {1, 1}, 0xFF0000u}};
+        u16 Indices[6] = {0, 1, 2, 2, 1, 0};
+        ch::gl_stream_allocation VertexWrite = ch::WriteStream(&Stream, Vertices, sizeof(Vertices), sizeof(ui_vertex));
+        ch::gl_stream_allocation IndexWrite = ch::WriteStream(&Stream, Indices, sizeof(Indices), sizeof(u16));
+        assert(VertexWrite.Data && VertexWrite.Offset == 0 && VertexWrite.Size == 60);
+        assert(IndexWrite.Data && IndexWrite.Offset == 60 && IndexWrite.Size == 12);
+        assert(memcmp(Buffer->Storage.data(), Vertices, sizeof(Vertices)) == 0);
+        assert(memcmp(Buffer->Storage.data() + 60, Indices, sizeof(Indices)) == 0);
+        
+        // the next vertices start at a whole vertex, so the offset is a base vertex
+        ch::gl_stream_allocation Reserved = ch::AllocateStream(&Stream, 500, sizeof(ui_vertex));
+        assert(Reserved.Data && Reserved.Offset == 80 && Reserved.Offset % sizeof(ui_vertex) == 0);
+        memset(Reserved.Data, 0xAB, 100);
+        ch::CommitStream(&Stream, &Reserved, 100);
+        assert(Reserved.Size == 100 && Stream.Head == 180);
+        
+        // doesn't fit the region: empty, counted, committing it does nothing
+        ch::gl_stream_allocation TooBig = ch::AllocateStream(&Stream, 600);
+        assert(!TooBig.Data && Stream.FailedCount == 1);
+        ch::CommitStream(&Stream, &TooBig, 0);
+        assert(Stream.Head == 180);
+        assert(ch::AllocateStream(&Stream, 768 - 180).Data);
+        ch::EndStreamFrame(&Stream);
+        
+        // each frame its own region, a region comes back after CH_GL_RING_FRAMES frames
+        ch::BeginStreamFrame(&Stream);
+        assert(ch::WriteStream(&Stream, Indices, 4).Offset == 768);
+        ch::EndStreamFrame(&Stream);
+        ch::BeginStreamFrame(&Stream);
+        assert(ch::WriteStream(&Stream, Indices, 4).Offset == 2 * 768);
+        ch::EndStreamFrame(&Stream);
+        assert(MockGLCalls("glClientWaitSync") == 0);
+        
+        GetMockGL().PendingSyncs[1] = 3;
+        ch::BeginStreamFrame(&Stream);
+        assert(Stream.WaitCount == 1 && MockGLCalls("glClientWaitSync") == 4);
+        assert(ch::WriteStream(&Stream, Indices, 4).Offset == 0);
+        ch::EndStreamFrame(&Stream);
+        ch::BeginStreamFrame(&Stream);
+        assert(Stream.WaitCount == 1);
+        ch::EndStreamFrame(&Stream);
+        
+        GLuint Id = Stream.Buffer;
+        ch::DestroyStreamBuffer(&Stream);
+        assert(!MockGLFindBuffer(Id));
+        assert(GetMockGL().LiveSyncs == 0);
+    }
+    
+    // debug lines: written into the mapping as they are pushed, one draw a frame
+    {
+        MockGLReset();
+        ch::gl_debug_lines Lines = ch::CreateDebugLines(4);
+        assert(Lines.Program && Lines.VAO);
+        assert(MockGLCalls("glCompileShader") == 2 && MockGLCalls("glLinkProgram") == 1);
+        assert(Lines.Stream.RegionSize == 256);
+        mock_gl_buffer *Buffer = MockGLFindBuffer(Lines.Stream.Buffer);
+        
+        ch::BeginDebugLines(&Lines);
+        assert(Lines.VertexCapacity == 16);
+        for (int I = 0; I < 9; ++I)
+        {
+            ch::PushDebugLine(&Lines, V3(f32(I), 0, 0), V3(f32(I), 1, 2), 0xFF00FF00u);
+        }
+        assert(Lines.VertexCount == 16 && Lines.DroppedCount == 1);
+        ch::gl_debug_line_vertex Last;
+        memcpy(&Last, Buffer->Storage.data() + 15 * sizeof(Last), sizeof(Last));
+        assert(Last.P[0] == 7.0f && Last.P[1] == 1.0f && Last.P[2] == 2.0f && Last.Color == 0xFF00FF00u);
+        
+        mat4 ViewProjection = Mat4Identity();
+        ch::DrawDebugLines(&Lines, &ViewProjection.Data[0][0]);
+        assert(GetMockGL().Draws.size() == 1);
+        assert(GetMockGL().Draws[0].Mode == GL_LINES && GetMockGL().Draws[0].First == 0 && GetMockGL().Draws[0].Count == 16);
+        assert(GetMockGL().Uploads.size() == 1 && GetMockGL().Uploads[0].Transpose == GL_TRUE);
+        assert(GetMockGL().CurrentProgram == Lines.Program && GetMockGL().CurrentVAO == 0);
+        
+        // the next frame draws from the next region
+        ch::BeginDebugLines(&Lines);
+        ch::PushDebugLine(&Lines, V3(0, 0, 0), V3(1, 1, 1), 0xFFFFFFFFu);
+        ch::DrawDebugLines(&Lines, &ViewProjection.Data[0][0]);
+        assert(GetMockGL().Draws.size() == 2);
+        assert(GetMockGL().Draws[1].First == 256 / 16 && GetMockGL().Draws[1].Count == 2);
+        
+        // nothing pushed, nothing drawn, the region is still fenced
+        ch::BeginDebugLines(&Lines);
+        ch::DrawDebugLines(&Lines, &ViewProjection.Data[0][0]);
+        assert(GetMockGL().Draws.size() == 2 && GetMockGL().LiveSyncs == 3);
+        
+        // still bound, the cache mustn't take a program that gets the name back for it
+        ch::DestroyDebugLines(&Lines);
+        assert(GetMockGL().LiveSyncs == 0);
+        assert(ch::GetGLStateCache()->State.Program == ch::GL_STATE_UNKNOWN);
+        assert(MockGLCalls("glDeleteProgram") == 1 && MockGLCalls("glDeleteVertexArrays") == 1);
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
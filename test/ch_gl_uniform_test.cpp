@@ -0,0 +1,204 @@
+#include "../kernel.h"
+#include "../ch_gl_uniform.h"
+#include "ch_gl_mock.h"
+
+int main()
+{
+    MockGLReset();
+    mock_gl_program *Program = MockGLAddProgram(7);
+    MockGLAddUniform(Program, "Model", GL_FLOAT_MAT4, 1);
+    MockGLAddUniform(Program, "Color", GL_FLOAT_VEC3, 1);
+    MockGLAddUniform(Program, "LightPositions", GL_FLOAT_VEC3, 4);
+    MockGLAddUniform(Program, "Albedo", GL_SAMPLER_2D, 1);
+    MockGLAddUniform(Program, "FrameIndex", GL_UNSIGNED_INT, 1);
+    MockGLAddUniform(Program, "Camera.View", GL_FLOAT_MAT4, 1, true);
+    LoadGLFunctions(MockGLLoad);
+    
+    // reflection: one glGetUniformLocation per uniform, none after
+    ch::gl_uniform_cache *Cache = ch::GetUniformCache(7);
+    assert(Cache == ch::GetUniformCache(7));
+    assert(Cache->UniformCount == 5);
+    assert(MockGLCalls("glGetActiveUniform") == 6);
+    int BuildLookups = MockGLCalls("glGetUniformLocation");
+    assert(BuildLookups == 6);
+    assert(ch::GetUniformLocation(Cache, "Model") == 0);
+    assert(ch::GetUniformLocation(Cache, "Color") == 1);
+    assert(ch::GetUniformLocation(Cache, "LightPositions") == 2);
+    assert(ch::GetUniformLocation(Cache, "LightPositions[0]") == 2);
+    assert(ch::GetUniformLocation(Cache, "LightPositions[3]") == 5);
+    assert(ch::GetUniformLocation(Cache, "LightPositions[4]") == -1);
+    assert(ch::GetUniformLocation(Cache, "Albedo") == 6);
+    assert(ch::GetUniformLocation(Cache, "Camera.View") == -1);
+    assert(ch::GetUniformLocation(Cache, "Colo") == -1);
+    assert(ch::GetUniformLocation(Cache, "Color[0]") == 1);
+    assert(ch::GetUniformLocation(7u, "FrameIndex") == 7);
+    assert(MockGLCalls("glGetUniformLocation") == BuildLookups);
+    
+    // typed handles have to match the GLSL type's size
+    ch::gl_uniform<mat4> Model = ch::GetUniform<mat4>(Cache, "Model");
+    ch::gl_uniform<v3> Color = ch::GetUniform<v3>(Cache, "Color");
+    ch::gl_uniform<v3> Lights = ch::GetUniform<v3>(Cache, "LightPositions");
+    ch::gl_uniform<i32> Albedo = ch::GetUniform<i32>(Cache, "Albedo");
+    ch::gl_uniform<u32> Frame = ch::GetUniform<u32>(Cache, "FrameIndex");
+    assert(ch::IsValid(Model) && ch::IsValid(Color) && ch::IsValid(Lights) && ch::IsValid(Albedo) && ch::IsValid(Frame));
+    assert(!ch::IsValid(ch::GetUniform<v4>(Cache, "Color")));
+    assert(!ch::IsValid(ch::GetUniform<f32>(Cache, "Missing")));
+    
+    // a handle is the whole array, an element past the first would silently be the first
+    assert(!ch::IsValid(ch::GetUniform<v3>(Cache, "LightPositions[2]")));
+    assert(ch::GetUniform<v3>(Cache, "LightPositions[0]").Index == Lights.Index);
+    
+    // nothing set, nothing uploaded
+    ch::FlushUniforms(Cache);
+    assert(GetMockGL().Uploads.empty());
+    
+    // first sets upload with the right entry point, transposed matrices
+    mat4 Matrix = Mat4Identity();
+    Matrix.Data[0][3] = 5.0f;
+    v3 Red = {1.0f, 0.0f, 0.0f};
+    ch::SetUniform(Cache, Model, Matrix);
+    ch::SetUniform(Cache, Color, Red);
+    ch::SetUniform(Cache, Albedo, 3);
+    ch::SetUniform(Cache, Frame, 9u);
+    ch::FlushUniforms(Cache);
+    assert(GetMockGL().Uploads.size() == 4);
+    assert(Cache->UploadCount == 4);
+    mock_gl_upload &MatrixUpload = GetMockGL().Uploads[0];
+    assert(MatrixUpload.Function == "glUniformMatrix4fv" && MatrixUpload.Location == 0);
+    assert(MatrixUpload.Count == 1 && MatrixUpload.Transpose == GL_TRUE);
+    assert(memcmp(MatrixUpload.Bytes.data(), &Matrix, sizeof(Matrix)) == 0);
+    assert(GetMockGL().Uploads[1].Function == "glUniform3fv" && GetMockGL().Uploads[1].Location == 1);
+    assert(GetMockGL().Uploads[2].Function == "glUniform1iv" && GetMockGL().Uploads[2].Location == 6);
+    assert(GetMockGL().Uploads[3].Function == "glUniform1uiv" && GetMockGL().Uploads[3].Location == 7);
+    
+    // the same values again are elided
+    GetMockGL().Uploads.clear();
+    ch::SetUniform(Cache, Model, Matrix);
+    ch::SetUniform(Cache, Color, Red);
+    ch::SetUniform(Cache, Albedo, 3);
+    ch::FlushUniforms(Cache);
+    assert(GetMockGL().Uploads.empty());
+    assert(Cache->ElidedCount == 3);
+    
+    // several sets before a flush are one upload of the last value
+    v3 Green = {0.0f, 1.0f, 0.0f};
+    v3 Blue = {0.0f, 0.0f, 1.0f};
+    ch::SetUniform(Cache, Color, Green);
+    ch::SetUniform(Cache, Color, Blue);
+    ch::FlushUniforms(Cache);
+    assert(GetMockGL().Uploads.size() == 1);
+    assert(memcmp(GetMockGL().Uploads[0].Bytes.data(), &Blue, sizeof(Blue)) == 0);
+    
+    // arrays: a partial set uploads its elements, a longer one isn't elided by the shorter
+    GetMockGL().Uploads.clear();
+    v3 Positions[5] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}, {10, 11, 12}, {13, 14, 15}};
+    ch::SetUniformArray(Cache, Lights, Positions, 2);
+    ch::FlushUniforms(Cache);
+    ch::SetUniformArray(Cache, Lights, Positions, 2);
+    ch::SetUniformArray(Cache, Lights, Positions, 5);
+    ch::FlushUniforms(Cache);
+    assert(GetMockGL().Uploads.size() == 2);
+    assert(GetMockGL().Uploads[0].Count == 2 && GetMockGL().Uploads[0].Location == 2);
+    assert(GetMockGL().Uploads[1].Count == 4);
+    assert(memcmp(GetMockGL().Uploads[1].Bytes.data(), Positions, 4 * sizeof(v3)) == 0);
+    ch::SetUniformArray(Cache, Lights, Positions, 4);
+    ch::FlushUniforms(Cache);
+    assert(GetMockGL().Uploads.size() == 2);
+    
+    // forgotten values upload again
+    ch::ForgetUniformValues(Cache);
+    ch::SetUniform(Cache, Color, Blue);
+    ch::FlushUniforms(Cache);
+    assert(GetMockGL().Uploads.size() == 3);
+    
+    // kernel.h's helpers upload right away and ask the driver for the location every time
+    GetMockGL().Uploads.clear();
+    glUploadVec3(7, (char *)"Color", Red);
+    glUploadMatrix4(7, (char *)"Model", &Matrix);
+    glUploadVec3Array(7, (char *)"LightPositions", Positions, 4);
+    glUploadInt32(7, (char *)"Albedo", 2);
+    assert(GetMockGL().Uploads.size() == 4);
+    assert(GetMockGL().Uploads[0].Location == 1 && GetMockGL().Uploads[0].Function == "glUniform3fv");
+    assert(GetMockGL().Uploads[1].Location == 0 && GetMockGL().Uploads[1].Transpose == GL_TRUE);
+    assert(GetMockGL().Uploads[2].Count == 4);
+    assert(GetMockGL().Uploads[3].Location == 6);
+    assert(MockGLCalls("glGetUniformLocation") == BuildLookups + 4);
+    BuildLookups += 4;
+    
+    // a relinked program is reflected again
+    MockGLAddUniform(Program, "Exposure", GL_FLOAT, 1);
+    assert(ch::GetUniformLocation(7u, "Exposure") == -1);
+    ch::ResetUniformCache(7);
+    assert(ch::GetUniformLocation(7u, "Exposure") == 8);
+    assert(MockGLCalls("glGetUniformLocation") == BuildLookups + 7);
+    
+    // the registry grows past its first table
+    for (GLuint Id = 100; Id < 300; ++Id)
+    {
+        mock_gl_program *Other = MockGLAddProgram(Id);
+        MockGLAddUniform(Other, "Tint", GL_FLOAT_VEC4, 1);
+    }
+    for (GLuint Id = 100; Id < 300; ++Id)
+    {
+        assert(ch::GetUniformLocation(Id, "Tint") == GLint(9 + Id - 100));
+    }
+    assert(ch::GetUniformLocation(7u, "Model") == 0);
+    
+    // hot reload: the program is deleted and its name comes back with other uniforms
+    {
+        ch::DeleteGLProgram(7);
+        assert(!MockGLFindProgram(7) && MockGLCalls("glDeleteProgram") == 1);
+        mock_gl_program *Reloaded = MockGLAddProgram(7);
+        MockGLAddUniform(Reloaded, "Exposure", GL_FLOAT, 1);
+        MockGLAddUniform(Reloaded, "Model", GL_FLOAT_MAT4, 1);
+        GLint Exposure = ch::GetUniformLocation(7u, "Exposure");
+        assert(Exposure >= 0 && ch::GetUniformLocation(7u, "Model") == Exposure + 1);
+        assert(ch::GetUniformLocation(7u, "Color") == -1);
+    }
+    
+    // deleted and recreated around the registry: the cache is stale, the helpers aren't
+    {
+        glDeleteProgram(7);
+        mock_gl_program *Recreated = MockGLAddProgram(7);
+        MockGLAddUniform(Recreated, "Tint", GL_FLOAT_VEC4, 1);
+        GetMockGL().Uploads.clear();
+        v4 White = {1, 1, 1, 1};
+        glUploadVec4(7, (char *)"Tint", White);
+        assert(GetMockGL().Uploads.size() == 1 && GetMockGL().Uploads[0].Location == glGetUniformLocation(7, "Tint"));
+        assert(GetMockGL().Uploads[0].Location >= 0 && ch::GetUniformLocation(7u, "Tint") == -1);
+        ch::ResetUniformCache(7);
+    }
+    
+    // program 0 has no cache and takes no registry slot
+    {
+        u32 Used = ch::GetUniformRegistry()->Used;
+        for (int I = 0; I < 1000; ++I)
+        {
+            assert(!ch::GetUniformCache(0) && ch::GetUniformLocation(0u, "Model") == -1);
+        }
+        assert(ch::GetUniformRegistry()->Used == Used);
+    }
+    
+    // the table stays right with many uniforms
+    {
+        mock_gl_program *Many = MockGLAddProgram(400);
+        char Name[32];
+        for (int I = 0; I < 100; ++I)
+        {
+            snprintf(Name, sizeof(Name), "Value%d", I);
+            MockGLAddUniform(Many, Name, GL_FLOAT, 1);
+        }
+        ch::gl_uniform_cache *ManyCache = ch::GetUniformCache(400);
+        assert(ManyCache->UniformCount == 100 && ManyCache->SlotMask + 1 >= 200);
+        GLint First = ch::GetUniformLocation(ManyCache, "Value0");
+        for (int I = 0; I < 100; ++I)
+        {
+            snprintf(Name, sizeof(Name), "Value%d", I);
+            assert(ch::GetUniformLocation(ManyCache, Name) == First + I);
+        }
+        assert(ch::GetUniformLocation(ManyCache, "Value100") == -1);
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "../ch_raster.h"
+#include "../ch_bmp.h"
+#include "../ch_image.h"
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+/*
+usage: ch_image_bench [image.bmp|.tga|.ppm|.qoi]
+
+Without an image a 1920x1080 ch_raster frame (4x4 grid of displaced spheres) is
+rendered and used instead. Every codec runs on the same pixels, throughput is
+uncompressed RGBA8 megabytes per second so the numbers line up across formats.
+*/
+
+static f64
+GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<f64>(steady_clock::now().time_since_epoch()).count();
+}
+
+// runs Work until at least a quarter of a second went by, returns seconds per run
+template <typename F>
+static f64
+TimeIt(F Work)
+{
+    Work(); // warm up caches and the allocator
+    int RunCount = 0;
+    f64 Begin = GetSeconds();
+    f64 Elapsed = 0.0;
+    do
+    {
+        Work();
+        ++RunCount;
+        Elapsed = GetSeconds() - Begin;
+    } while (Elapsed < 0.25);
+    return Elapsed / f64(RunCount);
+}
+
+static void
+Report(const char *Name, f64 Seconds, size_t RawSize, size_t FileSize)
+{
+    printf("%-22s %9.1f MB/s %8.2f ms", Name, f64(RawSize) / Seconds / 1e6, 1000.0 * Seconds);
+    if (FileSize)
+    {
+        printf(" %10zu bytes (%5.1f%%)", FileSize, 100.0 * f64(FileSize) / f64(RawSize));
+    }
+    printf("\n");
+}
+
+static ch_obj::Model
+GenerateSphere(int Rings, int Segments)
+{
+    ch_obj::Model Model = {};
+    int VertCount = (Rings + 1) * (Segments + 1);
+    Model.vb_count = 3 * VertCount;
+    Model.vb = (float *)malloc(sizeof(float) * Model.vb_count);
+    Model.nb_count = 3 * VertCount;
+    Model.nb = (float *)malloc(sizeof(float) * Model.nb_count);
+    Model.ib_count = 6 * Rings * Segments;
+    Model.ib = (int *)malloc(sizeof(int) * 3 * Model.ib_count);
+    
+    for (int R = 0; R <= Rings; ++R)
+    {
+        for (int S = 0; S <= Segments; ++S)
+        {
+            f32 Theta = Pi32 * f32(R) / f32(Rings);
+            f32 Phi = 2.0f * Pi32 * f32(S) / f32(Segments);
+            f32 Radius = 1.0f + 0.05f * sinf(13.0f * Theta) * cosf(17.0f * Phi);
+            v3 N = V3(sinf(Theta) * cosf(Phi), cosf(Theta), sinf(Theta) * sinf(Phi));
+            int Index = R * (Segments + 1) + S;
+            for (int Axis = 0; Axis < 3; ++Axis)
+            {
+                Model.vb[3*Index + Axis] = Radius * N.Data[Axis];
+                Model.nb[3*Index + Axis] = N.Data[Axis];
+            }
+        }
+    }
+    
+    int *Index = Model.ib;
+    for (int R = 0; R < Rings; ++R)
+    {
+        for (int S = 0; S < Segments; ++S)
+        {
+            int I0 = R * (Segments + 1) + S;
+            int I1 = I0 + 1;
+            int I2 = I0 + Segments + 1;
+            int I3 = I2 + 1;
+            int Quad[6] = {I0, I2, I1, I1, I2, I3};
+            for (int I = 0; I < 6; ++I)
+            {
+                *Index++ = Quad[I];
+                *Index++ = -1;
+                *Index++ = Quad[I];
+            }
+        }
+    }
+    
+    return Model;
+}
+
+static ch::image
+RenderTestImage()
+{
+    ch_obj::Model Model = GenerateSphere(128, 256);
+    ch_obj::Mesh Mesh = ch_obj::weld_model(&Model);
+    
+    const int GridSize = 4;
+    ch::raster_draw Draws[GridSize * GridSize];
+    for (int I = 0; I < GridSize * GridSize; ++I)
+    {
+        f32 X = 2.2f * (f32(I % GridSize) - 0.5f * f32(GridSize - 1));
+        f32 Y = 2.2f * (f32(I / GridSize) - 0.5f * f32(GridSize - 1));
+        Draws[I] = {};
+        Draws[I].Mesh = &Mesh;
+        Draws[I].Transform = Mat4Scale(1.0f / 1.05f) * Mat4Translate(V3(X, Y, 0.0f));
+        Draws[I].Color = 0xFFFF8040 | ((I * 0x1F) & 0xFF) << 8;
+    }
+    
+    int Width = 1920, Height = 1080;
+    mat4 ViewProj = Mat4LookAt(V3(0.0f, 0.0f, -9.0f), V3(0.0f)) *
+        Mat4Perspective(60.0f, f32(Width) / f32(Height), 0.1f, 100.0f);
+    ch::raster_context Raster = ch::InitRasterContext(Width, Height, 0);
+    ch::ClearFramebuffer(&Raster.Framebuffer, 0xFF202020);
+    ch::Render(&Raster, Draws, GridSize * GridSize, ViewProj, Normalize(V3(1.0f, -1.0f, 2.0f)));
+    
+    ch::image Image = ch::AllocateImage(Width, Height);
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        memcpy(Image.Pixels + Image.Pitch * Y, Raster.Framebuffer.Color + (size_t)Width * Y, (size_t)Width * 4);
+    }
+    
+    ch::FreeRasterContext(&Raster);
+    ch_obj::free_mesh(&Mesh);
+    return Image;
+}
+
+int main(int ArgCount, char **Args)
+{
+    ch::image Image = {};
+    if (ArgCount > 1)
+    {
+        Image = ch::LoadImageFile(Args[1]);
+        if (!Image.Pixels)
+        {
+            printf("can't read %s\n", Args[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        Image = RenderTestImage();
+    }
+    
+    int Width = Image.Width, Height = Image.Height;
+    size_t RawSize = (size_t)Width * Height * 4;
+    ch::image Decoded = ch::AllocateImage(Width, Height);
+    printf("%dx%d, %.1f MB raw\n", Width, Height, f64(RawSize) / 1e6);
+    
+    // files for the readers, written the simple way
+    const char *BMPPath = "ch_image_bench.bmp";
+    CH_BMP::bmp_writer Writer;
+    CH_BMP::BeginBMP(&Writer, BMPPath, Width, Height, 32, CH_BMP::BMPPixel_RGBA8);
+    CH_BMP::WriteBMPRows(&Writer, 0, Height, (u32 *)Image.Pixels, Image.Pitch);
+    CH_BMP::EndBMP(&Writer);
+    f64 Seconds = TimeIt([&]()
+                         {
+                             CH_BMP::BeginBMP(&Writer, BMPPath, Width, Height, 32, CH_BMP::BMPPixel_RGBA8);
+                             CH_BMP::WriteBMPRows(&Writer, 0, Height, (u32 *)Image.Pixels, Image.Pitch);
+                             CH_BMP::EndBMP(&Writer);
+                         });
+    size_t BMPSize = 0;
+    u8 *BMP = ch::ReadFileData(BMPPath, &BMPSize);
+    remove(BMPPath);
+    Report("bmp write (to disk)", Seconds, RawSize, BMPSize);
+    
+    std::vector<u8> TGA(18);
+    TGA[2] = 2;
+    TGA[12] = (u8)Width;
+    TGA[13] = (u8)(Width >> 8);
+    TGA[14] = (u8)Height;
+    TGA[15] = (u8)(Height >> 8);
+    TGA[16] = 32;
+    TGA[17] = 0x28; // top-down, 8 alpha bits
+    std::vector<u8> PPM(32);
+    PPM.resize((size_t)snprintf((char *)PPM.data(), PPM.size(), "P6\n%d %d\n255\n", Width, Height));
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        const u8 *Row = Image.Pixels + Image.Pitch * Y;
+        for (int X = 0; X < Width; ++X)
+        {
+            const u8 *P = Row + 4 * X;
+            u8 BGRA[4] = {P[2], P[1], P[0], P[3]};
+            TGA.insert(TGA.end(), BGRA, BGRA + 4);
+            PPM.insert(PPM.end(), P, P + 3);
+        }
+    }
+    
+    Seconds = TimeIt([&]() { ch::DecodeImage(BMP, BMPSize, Decoded.Pixels, Decoded.Pitch); });
+    Report("bmp read", Seconds, RawSize, 0);
+    Seconds = TimeIt([&]() { ch::DecodeImage(TGA.data(), TGA.size(), Decoded.Pixels, Decoded.Pitch); });
+    Report("tga read", Seconds, RawSize, 0);
+    Seconds = TimeIt([&]() { ch::DecodeImage(PPM.data(), PPM.size(), Decoded.Pixels, Decoded.Pitch); });
+    Report("ppm read", Seconds, RawSize, 0);
+    
+    size_t QOISize = 0;
+    u8 *QOI = 0;
+    Seconds = TimeIt([&]()
+                     {
+                         free(QOI);
+                         QOI = ch::EncodeQOI(Image.Pixels, Width, Height, Image.Pitch, 4, &QOISize);
+                     });
+    Report("qoi encode", Seconds, RawSize, QOISize);
+    Seconds = TimeIt([&]() { ch::DecodeImage(QOI, QOISize, Decoded.Pixels, Decoded.Pitch); });
+    Report("qoi decode", Seconds, RawSize, 0);
+    
+    int MaxThreads = int(std::thread::hardware_concurrency());
+    if (MaxThreads <= 0) MaxThreads = 1;
+    for (int ThreadCount = 1; ThreadCount <= MaxThreads; ThreadCount = ThreadCount < MaxThreads && ThreadCount * 2 > MaxThreads? MaxThreads: ThreadCount * 2)
+    {
+        size_t PNGSize = 0;
+        Seconds = TimeIt([&]()
+                         {
+                             u8 *PNG = ch::EncodePNG(Image.Pixels, Width, Height, Image.Pitch, 4, ThreadCount, &PNGSize);
+                             free(PNG);
+                         });
+        char Name[64];
+        snprintf(Name, sizeof(Name), "png encode %2d threads", ThreadCount);
+        Report(Name, Seconds, RawSize, PNGSize);
+        if (ThreadCount == MaxThreads) break;
+    }
+    
+    free(QOI);
+    free(BMP);
+    ch::FreeImage(&Decoded);
+    ch::FreeImage(&Image);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,517 @@
+#include "../ch_image.h"
+#include "../ch_bmp.h"
+#include <assert.h>
+#include <vector>
+
+static u32
+TestPixel(int X, int Y)
+{
+    // smooth areas, flat runs and noise so every QOI op and deflate block type shows up
+    u32 Noise = (u32)(X * 2654435761u) ^ (u32)(Y * 40503u);
+    if ((X / 16 + Y / 16) % 3 == 0) return 0xFF204080;
+    if ((X / 16 + Y / 16) % 3 == 1) return (u32)(X + Y) | ((u32)(X * 2) << 8) | ((u32)(Y * 3) << 16) | 0xFF000000;
+    return Noise ^ ((u32)(X & 1) << 24);
+}
+
+static std::vector<u32>
+MakeImage(int Width, int Height)
+{
+    std::vector<u32> Result((size_t)Width * Height);
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        for (int X = 0; X < Width; ++X)
+        {
+            Result[(size_t)Y * Width + X] = TestPixel(X, Y);
+        }
+    }
+    return Result;
+}
+
+// decodes into a pitched buffer and compares against Expected (tightly packed)
+static void
+CheckDecode(const std::vector<u8> &File, ch::image_format Format, int Width, int Height, const u32 *Expected, u32 AlphaMask = 0)
+{
+    ch::image_info Info;
+    assert(ch::ReadImageInfo(File.data(), File.size(), &Info));
+    assert(Info.Format == Format && Info.Width == Width && Info.Height == Height);
+    
+    ch::image Image = ch::AllocateImage(Width, Height);
+    assert(((uintptr_t)Image.Pixels & 63) == 0 && Image.Pitch % 64 == 0);
+    assert(ch::DecodeImage(File.data(), File.size(), Image.Pixels, Image.Pitch));
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        for (int X = 0; X < Width; ++X)
+        {
+            u32 Pixel;
+            memcpy(&Pixel, Image.Pixels + Image.Pitch * Y + 4 * X, 4);
+            assert(Pixel == (Expected[(size_t)Y * Width + X] | AlphaMask));
+        }
+    }
+    ch::FreeImage(&Image);
+    
+    // truncated files fail instead of reading past the end
+    std::vector<u8> Pixels((size_t)Width * Height * 4);
+    for (size_t Size = 0; Size < File.size(); Size += 1 + File.size() / 64)
+    {
+        ch::DecodeImage(File.data(), Size, Pixels.data(), (size_t)Width * 4);
+    }
+}
+
+//
+//
+// a small inflate, to check the PNG encoder without zlib
+
+struct bit_reader
+{
+    const u8 *Data;
+    size_t Size;
+    size_t BitPosition;
+};
+
+static u32
+GetBits(bit_reader *R, int Count)
+{
+    u32 Result = 0;
+    for (int I = 0; I < Count; ++I)
+    {
+        size_t Byte = R->BitPosition >> 3;
+        assert(Byte < R->Size);
+        Result |= (u32)((R->Data[Byte] >> (R->BitPosition & 7)) & 1) << I;
+        R->BitPosition++;
+    }
+    return Result;
+}
+
+struct huffman
+{
+    u16 Counts[16];
+    u16 Symbols[288];
+};
+
+static void
+BuildHuffman(huffman *H, const u8 *Lengths, int Count)
+{
+    memset(H, 0, sizeof(*H));
+    for (int S = 0; S < Count; ++S) H->Counts[Lengths[S]]++;
+    H->Counts[0] = 0;
+    
+    u16 Offsets[16] = {};
+    for (int L = 1; L < 16; ++L) Offsets[L] = (u16)(Offsets[L - 1] + H->Counts[L - 1]);
+    for (int S = 0; S < Count; ++S)
+    {
+        if (Lengths[S]) H->Symbols[Offsets[Lengths[S]]++] = (u16)S;
+    }
+}
+
+static int
+DecodeSymbol(bit_reader *R, const huffman *H)
+{
+    int Code = 0, First = 0, Index = 0;
+    for (int L = 1; L < 16; ++L)
+    {
+        Code |= (int)GetBits(R, 1);
+        int Count = H->Counts[L];
+        if (Code - First < Count) return H->Symbols[Index + Code - First];
+        Index += Count;
+        First = (First + Count) << 1;
+        Code <<= 1;
+    }
+    assert(!"bad huffman code");
+    return -1;
+}
+
+static std::vector<u8>
+Inflate(const u8 *Data, size_t Size)
+{
+    static const u16 LengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const u8 LengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const u16 DistanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const u8 DistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    static const u8 Order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    
+    std::vector<u8> Out;
+    bit_reader R = {Data, Size, 0};
+    bool Final = false;
+    while (!Final)
+    {
+        Final = GetBits(&R, 1) != 0;
+        u32 Type = GetBits(&R, 2);
+        if (Type == 0)
+        {
+            R.BitPosition = (R.BitPosition + 7) & ~(size_t)7;
+            u32 Length = GetBits(&R, 16);
+            u32 Complement = GetBits(&R, 16);
+            assert((Length ^ 0xFFFF) == Complement);
+            for (u32 I = 0; I < Length; ++I) Out.push_back((u8)GetBits(&R, 8));
+            continue;
+        }
+        assert(Type == 1 || Type == 2);
+        
+        u8 Lengths[320] = {};
+        int LitLenCount = 288, DistanceCount = 30;
+        if (Type == 1)
+        {
+            for (int I = 0; I < 288; ++I) Lengths[I] = I < 144? 8: I < 256? 9: I < 280? 7: 8;
+            for (int I = 0; I < 30; ++I) Lengths[288 + I] = 5;
+        }
+        else
+        {
+            LitLenCount = (int)GetBits(&R, 5) + 257;
+            DistanceCount = (int)GetBits(&R, 5) + 1;
+            int CodeLengthCount = (int)GetBits(&R, 4) + 4;
+            u8 CodeLengths[19] = {};
+            for (int I = 0; I < CodeLengthCount; ++I) CodeLengths[Order[I]] = (u8)GetBits(&R, 3);
+            huffman CodeLengthCode;
+            BuildHuffman(&CodeLengthCode, CodeLengths, 19);
+            
+            u8 All[320] = {};
+            int Count = 0;
+            while (Count < LitLenCount + DistanceCount)
+            {
+                int Symbol = DecodeSymbol(&R, &CodeLengthCode);
+                if (Symbol < 16)
+                {
+                    All[Count++] = (u8)Symbol;
+                    continue;
+                }
+                int Repeat = Symbol == 16? 3 + (int)GetBits(&R, 2): Symbol == 17? 3 + (int)GetBits(&R, 3): 11 + (int)GetBits(&R, 7);
+                assert(Symbol != 16 || Count > 0);
+                u8 Value = Symbol == 16? All[Count - 1]: 0;
+                assert(Count + Repeat <= LitLenCount + DistanceCount);
+                while (Repeat--) All[Count++] = Value;
+            }
+            memcpy(Lengths, All, LitLenCount);
+            memcpy(Lengths + 288, All + LitLenCount, DistanceCount);
+        }
+        
+        huffman LitLen, Distance;
+        BuildHuffman(&LitLen, Lengths, LitLenCount);
+        BuildHuffman(&Distance, Lengths + 288, DistanceCount);
+        for (;;)
+        {
+            int Symbol = DecodeSymbol(&R, &LitLen);
+            if (Symbol < 256)
+            {
+                Out.push_back((u8)Symbol);
+            }
+            else if (Symbol == 256)
+            {
+                break;
+            }
+            else
+            {
+                Symbol -= 257;
+                u32 Length = LengthBase[Symbol] + GetBits(&R, LengthExtra[Symbol]);
+                int DistanceSymbol = DecodeSymbol(&R, &Distance);
+                u32 Offset = DistanceBase[DistanceSymbol] + GetBits(&R, DistanceExtra[DistanceSymbol]);
+                assert(Offset <= Out.size());
+                size_t From = Out.size() - Offset;
+                for (u32 I = 0; I < Length; ++I) Out.push_back(Out[From + I]);
+            }
+        }
+    }
+    
+    u32 Adler = ch::ReadU32BE(Data + ((R.BitPosition + 7) >> 3));
+    assert(Adler == ch::Adler32(Out.data(), Out.size()));
+    return Out;
+}
+
+// parses the chunks, inflates and unfilters, returns tightly packed RGBA
+static std::vector<u32>
+ReadPNG(const std::vector<u8> &File, int *Width, int *Height, int *IDATCount)
+{
+    static const u8 Signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    assert(File.size() > 8 && memcmp(File.data(), Signature, 8) == 0);
+    
+    std::vector<u8> Compressed;
+    int Channels = 0;
+    *IDATCount = 0;
+    size_t At = 8;
+    bool SawEnd = false;
+    while (At < File.size())
+    {
+        u32 Length = ch::ReadU32BE(&File[At]);
+        const u8 *Type = &File[At + 4];
+        const u8 *Data = &File[At + 8];
+        u32 CRC = ch::ReadU32BE(&File[At + 8 + Length]);
+        assert(CRC == ~ch::UpdateCRC32(0xFFFFFFFF, Type, Length + 4));
+        if (memcmp(Type, "IHDR", 4) == 0)
+        {
+            *Width = (int)ch::ReadU32BE(Data);
+            *Height = (int)ch::ReadU32BE(Data + 4);
+            assert(Data[8] == 8 && (Data[9] == 2 || Data[9] == 6));
+            Channels = Data[9] == 6? 4: 3;
+        }
+        else if (memcmp(Type, "IDAT", 4) == 0)
+        {
+            Compressed.insert(Compressed.end(), Data, Data + Length);
+            ++*IDATCount;
+        }
+        else if (memcmp(Type, "IEND", 4) == 0)
+        {
+            SawEnd = true;
+        }
+        At += 12 + Length;
+    }
+    assert(SawEnd && At == File.size());
+    assert(Compressed[0] == 0x78 && (Compressed[0] * 256 + Compressed[1]) % 31 == 0);
+    
+    std::vector<u8> Filtered = Inflate(Compressed.data() + 2, Compressed.size() - 2);
+    size_t RowBytes = (size_t)*Width * Channels;
+    assert(Filtered.size() == (RowBytes + 1) * *Height);
+    
+    std::vector<u8> Raw(RowBytes * *Height);
+    for (int Y = 0; Y < *Height; ++Y)
+    {
+        u8 Filter = Filtered[(RowBytes + 1) * Y];
+        const u8 *In = &Filtered[(RowBytes + 1) * Y + 1];
+        u8 *Row = &Raw[RowBytes * Y];
+        const u8 *Above = Y > 0? Row - RowBytes: 0;
+        for (size_t I = 0; I < RowBytes; ++I)
+        {
+            u8 A = I >= (size_t)Channels? Row[I - Channels]: 0;
+            u8 B = Above? Above[I]: 0;
+            u8 C = (Above && I >= (size_t)Channels)? Above[I - Channels]: 0;
+            u8 Predicted = Filter == 0? 0: Filter == 1? A: Filter == 2? B: Filter == 3? (u8)((A + B) >> 1): ch::Paeth(A, B, C);
+            assert(Filter <= 4);
+            Row[I] = (u8)(In[I] + Predicted);
+        }
+    }
+    
+    std::vector<u32> Result((size_t)*Width * *Height);
+    for (size_t I = 0; I < Result.size(); ++I)
+    {
+        const u8 *P = &Raw[I * Channels];
+        Result[I] = (u32)P[0] | ((u32)P[1] << 8) | ((u32)P[2] << 16) | (Channels == 4? (u32)P[3] << 24: 0xFF000000);
+    }
+    return Result;
+}
+
+int main()
+{
+    const char *Path = "ch_image_test.bmp";
+    
+    // BMP, as written by ch_bmp and with an 8-bit palette
+    for (int Width = 1; Width <= 37; Width += 6)
+    {
+        int Height = 5;
+        std::vector<u32> Image = MakeImage(Width, Height);
+        for (int BitCount = 24; BitCount <= 32; BitCount += 8)
+        {
+            for (int TopRowFirst = 0; TopRowFirst < 2; ++TopRowFirst)
+            {
+                CH_BMP::bmp_writer Writer;
+                assert(CH_BMP::BeginBMP(&Writer, Path, Width, Height, BitCount, CH_BMP::BMPPixel_RGBA8, TopRowFirst != 0));
+                assert(CH_BMP::WriteBMPRows(&Writer, 0, Height, Image.data()));
+                assert(CH_BMP::EndBMP(&Writer));
+                
+                // without TopRowFirst row 0 ends up at the bottom
+                std::vector<u32> Expected = Image;
+                for (int Y = 0; !TopRowFirst && Y < Height; ++Y)
+                {
+                    memcpy(&Expected[(size_t)Y * Width], &Image[(size_t)(Height - 1 - Y) * Width], (size_t)Width * 4);
+                }
+                
+                size_t Size = 0;
+                u8 *Data = ch::ReadFileData(Path, &Size);
+                assert(Data);
+                CheckDecode(std::vector<u8>(Data, Data + Size), ch::ImageFormat_BMP, Width, Height, Expected.data(), BitCount == 24? 0xFF000000: 0);
+                free(Data);
+            }
+        }
+    }
+    {
+        // 2x2 palette, bottom-up, rows padded to 4 bytes
+        u8 File[54 + 4 * 3 + 8] = {'B', 'M'};
+        u32 Offset = 54 + 12;
+        memcpy(File + 10, &Offset, 4);
+        u32 HeaderSize = 40, Width = 2, Height = 2, ColorsUsed = 3;
+        u16 Planes = 1, BitCount = 8;
+        memcpy(File + 14, &HeaderSize, 4);
+        memcpy(File + 18, &Width, 4);
+        memcpy(File + 22, &Height, 4);
+        memcpy(File + 26, &Planes, 2);
+        memcpy(File + 28, &BitCount, 2);
+        memcpy(File + 46, &ColorsUsed, 4);
+        u8 Palette[12] = {0, 0, 255, 0, 0, 255, 0, 0, 255, 0, 0, 0}; // red, green, blue (BGRX)
+        memcpy(File + 54, Palette, 12);
+        u8 Indices[8] = {2, 1, 0, 0, 0, 2, 0, 0};
+        memcpy(File + Offset, Indices, 8);
+        u32 Expected[4] = {0xFF0000FF, 0xFFFF0000, 0xFFFF0000, 0xFF00FF00};
+        CheckDecode(std::vector<u8>(File, File + sizeof(File)), ch::ImageFormat_BMP, 2, 2, Expected);
+    }
+    remove(Path);
+    
+    // TGA: raw and RLE, 32/24/8-bit, both origins, runs crossing rows
+    {
+        int Width = 7, Height = 3;
+        std::vector<u32> Image = MakeImage(Width, Height);
+        for (int BPP = 1; BPP <= 4; ++BPP)
+        {
+            if (BPP == 2) continue;
+            for (int RLE = 0; RLE < 2; ++RLE)
+            {
+                for (int TopDown = 0; TopDown < 2; ++TopDown)
+                {
+                    std::vector<u8> File(18);
+                    File[0] = 2; // id length, skipped
+                    File.push_back('h');
+                    File.push_back('i');
+                    File[2] = (u8)((BPP == 1? 3: 2) + (RLE? 8: 0));
+                    File[12] = (u8)Width;
+                    File[14] = (u8)Height;
+                    File[16] = (u8)(BPP * 8);
+                    File[17] = TopDown? 0x20: 0;
+                    
+                    std::vector<u32> Expected(Image.size());
+                    std::vector<u8> Samples;
+                    for (int Row = 0; Row < Height; ++Row)
+                    {
+                        int Y = TopDown? Row: Height - 1 - Row;
+                        for (int X = 0; X < Width; ++X)
+                        {
+                            u32 Pixel = Image[(size_t)Y * Width + X];
+                            // the first 5 pixels of each row repeat so RLE has something to do
+                            if (X < 5) Pixel = Image[0];
+                            u8 R = (u8)Pixel, G = (u8)(Pixel >> 8), B = (u8)(Pixel >> 16), A = (u8)(Pixel >> 24);
+                            if (BPP == 1)
+                            {
+                                Samples.push_back(G);
+                                Expected[(size_t)Y * Width + X] = G | (G << 8) | (G << 16) | 0xFF000000u;
+                            }
+                            else
+                            {
+                                Samples.push_back(B);
+                                Samples.push_back(G);
+                                Samples.push_back(R);
+                                if (BPP == 4) Samples.push_back(A);
+                                Expected[(size_t)Y * Width + X] = BPP == 4? Pixel: Pixel | 0xFF000000;
+                            }
+                        }
+                    }
+                    
+                    if (!RLE)
+                    {
+                        File.insert(File.end(), Samples.begin(), Samples.end());
+                    }
+                    else
+                    {
+                        // alternating repeat and raw packets, neither lines up with rows
+                        size_t PixelCount = Samples.size() / BPP;
+                        for (size_t I = 0; I < PixelCount;)
+                        {
+                            size_t Count = PixelCount - I < 4? PixelCount - I: 4;
+                            bool Repeat = memcmp(&Samples[I * BPP], &Samples[(I + Count - 1) * BPP], BPP) == 0 && Count > 1;
+                            for (size_t K = 1; Repeat && K < Count; ++K)
+                            {
+                                Repeat = memcmp(&Samples[I * BPP], &Samples[(I + K) * BPP], BPP) == 0;
+                            }
+                            File.push_back((u8)((Repeat? 0x80: 0) | (Count - 1)));
+                            File.insert(File.end(), Samples.begin() + I * BPP, Samples.begin() + (I + (Repeat? 1: Count)) * BPP);
+                            I += Count;
+                        }
+                    }
+                    CheckDecode(File, ch::ImageFormat_TGA, Width, Height, Expected.data());
+                }
+            }
+        }
+    }
+    
+    // PPM/PGM with comments, maxval rescaling and 16-bit samples
+    {
+        const char Header[] = "P6\n# comment\n3 1 # another\n255\n";
+        std::vector<u8> File(Header, Header + sizeof(Header) - 1);
+        u8 Samples[9] = {1, 2, 3, 255, 0, 128, 9, 8, 7};
+        File.insert(File.end(), Samples, Samples + 9);
+        u32 Expected[3] = {0xFF030201, 0xFF8000FF, 0xFF070809};
+        CheckDecode(File, ch::ImageFormat_PPM, 3, 1, Expected);
+    }
+    {
+        const char Header[] = "P5 2 2 15\n";
+        std::vector<u8> File(Header, Header + sizeof(Header) - 1);
+        u8 Samples[4] = {0, 15, 5, 10};
+        File.insert(File.end(), Samples, Samples + 4);
+        u32 Expected[4] = {0xFF000000, 0xFFFFFFFF, 0xFF555555, 0xFFAAAAAA};
+        CheckDecode(File, ch::ImageFormat_PPM, 2, 2, Expected);
+    }
+    {
+        const char Header[] = "P6 1 1 65535\n";
+        std::vector<u8> File(Header, Header + sizeof(Header) - 1);
+        u8 Samples[6] = {0xFF, 0xFF, 0x80, 0x00, 0x00, 0x00};
+        File.insert(File.end(), Samples, Samples + 6);
+        u32 Expected[1] = {0xFF0080FF};
+        CheckDecode(File, ch::ImageFormat_PPM, 1, 1, Expected);
+    }
+    
+    // QOI: known encodings, then round trips
+    {
+        u32 Black = 0xFF000000;
+        size_t Size = 0;
+        u8 *Data = ch::EncodeQOI((u8 *)&Black, 1, 1, 4, 4, &Size);
+        u8 Expected[14 + 1 + 8] = {'q', 'o', 'i', 'f', 0, 0, 0, 1, 0, 0, 0, 1, 4, 0, 0xC0, 0, 0, 0, 0, 0, 0, 0, 1};
+        assert(Size == sizeof(Expected) && memcmp(Data, Expected, Size) == 0);
+        free(Data);
+        
+        // rgb, diff, luma, index, rgba
+        u32 Pixels[5] = {0xFF102030, 0xFF112131, 0xFF1A2838, 0xFF102030, 0x80102030};
+        Data = ch::EncodeQOI((u8 *)Pixels, 5, 1, 20, 4, &Size);
+        u8 Ops[] = {0xFE, 0x30, 0x20, 0x10, 0x40 | (3 << 4) | (3 << 2) | 3, 0x80 | (7 + 32), (u8)((0 + 8) << 4 | (2 + 8)),
+            (u8)(0x00 | ch::QOIHash(0xFF102030)), 0xFF, 0x30, 0x20, 0x10, 0x80};
+        assert(Size == 14 + sizeof(Ops) + 8 && memcmp(Data + 14, Ops, sizeof(Ops)) == 0);
+        free(Data);
+    }
+    for (int Width = 1; Width <= 300; Width += 97)
+    {
+        int Height = 70; // runs longer than 62
+        std::vector<u32> Image = MakeImage(Width, Height);
+        for (int Channels = 3; Channels <= 4; ++Channels)
+        {
+            size_t Size = 0;
+            u8 *Data = ch::EncodeQOI((u8 *)Image.data(), Width, Height, (size_t)Width * 4, Channels, &Size);
+            assert(Data && Size <= 14 + (size_t)Width * Height * (Channels + 1) + 8);
+            CheckDecode(std::vector<u8>(Data, Data + Size), ch::ImageFormat_QOI, Width, Height, Image.data(), Channels == 3? 0xFF000000: 0);
+            free(Data);
+        }
+    }
+    
+    // PNG at several thread counts, checked through the inflate above
+    {
+        int Width = 193, Height = 211;
+        std::vector<u32> Image = MakeImage(Width, Height);
+        for (int Channels = 3; Channels <= 4; ++Channels)
+        {
+            for (int ThreadCount = 1; ThreadCount <= 7; ThreadCount += 2)
+            {
+                size_t Size = 0;
+                u8 *Data = ch::EncodePNG((u8 *)Image.data(), Width, Height, (size_t)Width * 4, Channels, ThreadCount, &Size);
+                assert(Data);
+                
+                int DecodedWidth = 0, DecodedHeight = 0, IDATCount = 0;
+                std::vector<u32> Decoded = ReadPNG(std::vector<u8>(Data, Data + Size), &DecodedWidth, &DecodedHeight, &IDATCount);
+                assert(DecodedWidth == Width && DecodedHeight == Height);
+                assert(IDATCount == ThreadCount);
+                for (size_t I = 0; I < Image.size(); ++I)
+                {
+                    assert(Decoded[I] == (Image[I] | (Channels == 3? 0xFF000000: 0)));
+                }
+                free(Data);
+            }
+        }
+        
+        // 1 pixel, and a flat image that's all matches and no literals past the first
+        for (int Size = 1; Size <= 256; Size += 255)
+        {
+            std::vector<u32> Flat((size_t)Size * Size, 0xFF336699);
+            size_t FileSize = 0;
+            u8 *Data = ch::EncodePNG((u8 *)Flat.data(), Size, Size, (size_t)Size * 4, 4, 0, &FileSize);
+            int W, H, IDATCount;
+            std::vector<u32> Decoded = ReadPNG(std::vector<u8>(Data, Data + FileSize), &W, &H, &IDATCount);
+            assert(W == Size && H == Size && Decoded == Flat);
+            assert(Size == 1 || FileSize < 1000);
+            free(Data);
+        }
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
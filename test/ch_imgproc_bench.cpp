@@ -0,0 +1,153 @@
+#include "../ch_imgproc.h"
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+/*
+usage: ch_imgproc_bench [size]
+
+Mip chains of a size x size (default 4096) noise image for every filter and a few
+formats, at 1 thread up to all hardware threads, then format conversions and a
+pitched upload-style copy (memcpy rows, streaming stores and the byte loop
+ch_d3d12 used to do). Throughput is megapixels of the source image per second.
+*/
+
+static f64
+GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<f64>(steady_clock::now().time_since_epoch()).count();
+}
+
+// runs Work until at least a quarter of a second went by, returns seconds per run
+template <typename F>
+static f64
+TimeIt(F Work)
+{
+    Work(); // warm up caches and the allocator
+    int RunCount = 0;
+    f64 Begin = GetSeconds();
+    f64 Elapsed = 0.0;
+    do
+    {
+        Work();
+        ++RunCount;
+        Elapsed = GetSeconds() - Begin;
+    } while (Elapsed < 0.25);
+    return Elapsed / f64(RunCount);
+}
+
+static void
+Report(const char *Name, f64 Seconds, u64 PixelCount)
+{
+    printf("%-34s %9.1f MP/s %8.2f ms\n", Name, f64(PixelCount) / Seconds / 1e6, 1000.0 * Seconds);
+}
+
+int main(int ArgCount, char **Args)
+{
+    int Size = ArgCount > 1? atoi(Args[1]): 4096;
+    u64 PixelCount = (u64)Size * Size;
+    printf("%dx%d\n", Size, Size);
+    
+    ch::mip_chain Source = ch::AllocateMipChain(Size, Size, ch::PixelFormat_RGBA8, 1);
+    ch::image_level *Base = &Source.Levels[0];
+    u32 State = 1;
+    for (int Y = 0; Y < Size; ++Y)
+    {
+        u32 *Row = (u32 *)((u8 *)Base->Pixels + Base->Pitch * Y);
+        for (int X = 0; X < Size; ++X)
+        {
+            State = State * 1664525u + 1013904223u;
+            Row[X] = State;
+        }
+    }
+    
+    int MaxThreads = int(std::thread::hardware_concurrency());
+    if (MaxThreads <= 0) MaxThreads = 1;
+    
+    const ch::pixel_format Formats[3] = {ch::PixelFormat_RGBA8, ch::PixelFormat_RGBA8_SRGB, ch::PixelFormat_RGBA16F};
+    const char *FormatNames[3] = {"rgba8", "srgb8", "rgba16f"};
+    const char *FilterNames[2] = {"box", "kaiser"};
+    for (int FormatI = 0; FormatI < 3; ++FormatI)
+    {
+        ch::pixel_format Format = Formats[FormatI];
+        ch::mip_chain Chain = ch::AllocateMipChain(Size, Size, Format);
+        ch::image_level *Level0 = &Chain.Levels[0];
+        ch::ConvertImage(Level0->Pixels, Level0->Pitch, Format, Base->Pixels, Base->Pitch, ch::PixelFormat_RGBA8, Size, Size, 0);
+        for (int Filter = ch::MipFilter_Box; Filter <= ch::MipFilter_Kaiser; ++Filter)
+        {
+            for (int ThreadCount = 1; ThreadCount <= MaxThreads; ThreadCount = ThreadCount < MaxThreads && ThreadCount * 2 > MaxThreads? MaxThreads: ThreadCount * 2)
+            {
+                f64 Seconds = TimeIt([&]() { ch::GenerateMips(&Chain, (ch::mip_filter)Filter, ThreadCount); });
+                char Name[64];
+                snprintf(Name, sizeof(Name), "mips %-7s %-6s %2d threads", FormatNames[FormatI], FilterNames[Filter], ThreadCount);
+                Report(Name, Seconds, PixelCount);
+                if (ThreadCount == MaxThreads) break;
+            }
+        }
+        ch::FreeMipChain(&Chain);
+    }
+    
+    // conversions, single threaded
+    {
+        ch::mip_chain Half = ch::AllocateMipChain(Size, Size, ch::PixelFormat_RGBA16F, 1);
+        ch::mip_chain Float = ch::AllocateMipChain(Size, Size, ch::PixelFormat_R32F, 1);
+        ch::mip_chain Bytes = ch::AllocateMipChain(Size, Size, ch::PixelFormat_RGBA8, 1);
+        struct conversion
+        {
+            const char *Name;
+            ch::image_level *Dest;
+            ch::pixel_format DestFormat;
+            ch::image_level *Src;
+            ch::pixel_format SrcFormat;
+        } Conversions[] = {
+            {"convert rgba8 -> rgba16f", &Half.Levels[0], ch::PixelFormat_RGBA16F, Base, ch::PixelFormat_RGBA8},
+            {"convert rgba16f -> rgba8", &Bytes.Levels[0], ch::PixelFormat_RGBA8, &Half.Levels[0], ch::PixelFormat_RGBA16F},
+            {"convert srgb8 -> rgba16f", &Half.Levels[0], ch::PixelFormat_RGBA16F, Base, ch::PixelFormat_RGBA8_SRGB},
+            {"convert rgba16f -> srgb8", &Bytes.Levels[0], ch::PixelFormat_RGBA8_SRGB, &Half.Levels[0], ch::PixelFormat_RGBA16F},
+            {"convert rgba8 -> r32f", &Float.Levels[0], ch::PixelFormat_R32F, Base, ch::PixelFormat_RGBA8},
+        };
+        for (conversion &C : Conversions)
+        {
+            f64 Seconds = TimeIt([&]()
+                                 {
+                                     ch::ConvertImage(C.Dest->Pixels, C.Dest->Pitch, C.DestFormat,
+                                                      C.Src->Pixels, C.Src->Pitch, C.SrcFormat, Size, Size, 1);
+                                 });
+            Report(C.Name, Seconds, PixelCount);
+        }
+        ch::FreeMipChain(&Bytes);
+        ch::FreeMipChain(&Float);
+        ch::FreeMipChain(&Half);
+    }
+    
+    // rows into a 256-byte pitched buffer, what a D3D12 texture upload does
+    {
+        size_t RowBytes = (size_t)Size * 4;
+        size_t RowPitch = (RowBytes + 255) & ~(size_t)255;
+        std::vector<u8> Staging(RowPitch * Size + 64);
+        u8 *Dest = Staging.data() + 16;
+        f64 Seconds = TimeIt([&]()
+                             {
+                                 const u8 *Reader = (const u8 *)Base->Pixels;
+                                 u8 *Writer = Dest;
+                                 for (int Y = 0; Y < Size; ++Y)
+                                 {
+                                     for (size_t X = 0; X < RowBytes; ++X)
+                                     {
+                                         Writer[X] = Reader[X];
+                                     }
+                                     Writer += RowPitch;
+                                     Reader += Base->Pitch;
+                                 }
+                             });
+        Report("copy rows, byte loop", Seconds, PixelCount);
+        Seconds = TimeIt([&]() { ch::CopyRows(Dest, RowPitch, Base->Pixels, Base->Pitch, RowBytes, Size, false); });
+        Report("copy rows, memcpy", Seconds, PixelCount);
+        Seconds = TimeIt([&]() { ch::CopyRows(Dest, RowPitch, Base->Pixels, Base->Pitch, RowBytes, Size, true); });
+        Report("copy rows, streaming stores", Seconds, PixelCount);
+    }
+    
+    ch::FreeMipChain(&Source);
+    return 0;
+}
\ No newline at end of file
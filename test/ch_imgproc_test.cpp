@@ -0,0 +1,327 @@
+#include "../ch_imgproc.h"
+#include <assert.h>
+#include <stdio.h>
+#include <vector>
+
+static u32
+Hash(u32 X)
+{
+    X ^= X >> 16;
+    X *= 0x7feb352d;
+    X ^= X >> 15;
+    X *= 0x846ca68b;
+    X ^= X >> 16;
+    return X;
+}
+
+static void
+FillNoise(ch::image_level *Level, u32 Seed)
+{
+    for (int Y = 0; Y < Level->Height; ++Y)
+    {
+        u8 *Row = (u8 *)Level->Pixels + Level->Pitch * Y;
+        for (int X = 0; X < Level->Width * 4; ++X)
+        {
+            Row[X] = (u8)Hash(Seed + (u32)(Y * 7919 + X));
+        }
+    }
+}
+
+static bool
+LevelsEqual(const ch::mip_chain *A, const ch::mip_chain *B)
+{
+    if (A->LevelCount != B->LevelCount) return false;
+    int PixelSize = ch::GetPixelSize(A->Format);
+    for (int LevelI = 0; LevelI < A->LevelCount; ++LevelI)
+    {
+        const ch::image_level *LA = &A->Levels[LevelI];
+        const ch::image_level *LB = &B->Levels[LevelI];
+        for (int Y = 0; Y < LA->Height; ++Y)
+        {
+            if (memcmp((u8 *)LA->Pixels + LA->Pitch * Y, (u8 *)LB->Pixels + LB->Pitch * Y, (size_t)LA->Width * PixelSize))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    // sRGB encode is exact: decode/encode round trips and matches the reference formula
+    for (int I = 0; I < 256; ++I)
+    {
+        assert(ch::LinearToSRGB(ch::SRGBToLinear((u8)I)) == I);
+    }
+    for (int I = 0; I <= 100000; ++I)
+    {
+        f32 Linear = I / 100000.0f;
+        f64 Encoded = Linear <= 0.0031308? 12.92 * Linear: 1.055 * pow((f64)Linear, 1.0 / 2.4) - 0.055;
+        int Expected = (int)(Encoded * 255.0 + 0.5);
+        int Got = ch::LinearToSRGB(Linear);
+        // the reference rounds in double, allow for a value right at a midpoint
+        assert(Got == Expected || (abs(Got - Expected) == 1 && fabs(Encoded * 255.0 - (Got + Expected) * 0.5) < 1e-4));
+    }
+    assert(ch::LinearToSRGB(-1.0f) == 0 && ch::LinearToSRGB(2.0f) == 255 && ch::LinearToSRGB(NAN) == 0);
+    
+    // conversions
+    {
+        const int Count = 1031;
+        std::vector<u8> RGBA8(4 * Count), Back(4 * Count);
+        for (int I = 0; I < 4 * Count; ++I) RGBA8[I] = (u8)Hash(I);
+        
+        const ch::pixel_format Formats[3] = {ch::PixelFormat_RGBA8_SRGB, ch::PixelFormat_RGBA16F, ch::PixelFormat_RGBA32F};
+        for (int FormatI = 0; FormatI < 3; ++FormatI)
+        {
+            std::vector<u8> Wide((size_t)Count * ch::GetPixelSize(Formats[FormatI]));
+            ch::ConvertPixels(Wide.data(), Formats[FormatI], RGBA8.data(), ch::PixelFormat_RGBA8, Count);
+            ch::ConvertPixels(Back.data(), ch::PixelFormat_RGBA8, Wide.data(), Formats[FormatI], Count);
+            if (Formats[FormatI] == ch::PixelFormat_RGBA8_SRGB)
+            {
+                // 8 bits of linear don't survive sRGB, but the order does and the ends are exact
+                assert(Back[3] == RGBA8[3]);
+            }
+            else
+            {
+                assert(Back == RGBA8);
+            }
+        }
+        
+        // unorm stores round to nearest and clamp
+        f32 Floats[8] = {-1.0f, 0.5f / 255.0f - 1e-6f, 0.5f / 255.0f + 1e-6f, 1.5f, 0.25f, 0.75f, NAN, 1.0f};
+        u8 Bytes[8];
+        ch::StorePixels(Bytes, Floats, ch::PixelFormat_RGBA8, 2);
+        assert(Bytes[0] == 0 && Bytes[1] == 0 && Bytes[2] == 1 && Bytes[3] == 255);
+        assert(Bytes[4] == 64 && Bytes[5] == 191 && Bytes[6] == 0 && Bytes[7] == 255);
+        
+        // R32F widens to (r, 0, 0, 1) and keeps r
+        f32 Red[3] = {0.25f, -3.0f, 1e6f}, RedBack[3];
+        f32 Wide[12];
+        ch::LoadPixels(Wide, Red, ch::PixelFormat_R32F, 3);
+        assert(Wide[4] == -3.0f && Wide[5] == 0.0f && Wide[6] == 0.0f && Wide[7] == 1.0f);
+        ch::StorePixels(RedBack, Wide, ch::PixelFormat_R32F, 3);
+        assert(memcmp(Red, RedBack, sizeof(Red)) == 0);
+        
+        // pitched and threaded
+        int Width = 37, Height = 300;
+        std::vector<u8> Src((size_t)Height * 160), Half((size_t)Height * 320), Dest((size_t)Height * 160);
+        for (size_t I = 0; I < Src.size(); ++I) Src[I] = (u8)Hash((u32)I);
+        ch::ConvertImage(Half.data(), 320, ch::PixelFormat_RGBA16F, Src.data(), 160, ch::PixelFormat_RGBA8, Width, Height, 3);
+        ch::ConvertImage(Dest.data(), 160, ch::PixelFormat_RGBA8, Half.data(), 320, ch::PixelFormat_RGBA16F, Width, Height, 4);
+        for (int Y = 0; Y < Height; ++Y)
+        {
+            assert(memcmp(&Src[(size_t)Y * 160], &Dest[(size_t)Y * 160], (size_t)Width * 4) == 0);
+        }
+    }
+    
+    // row copies, every head alignment, with and without streaming stores
+    {
+        std::vector<u8> Src(4096), Dest(8192), Expected(8192);
+        for (size_t I = 0; I < Src.size(); ++I) Src[I] = (u8)Hash((u32)I);
+        for (int Offset = 0; Offset < 17; ++Offset)
+        {
+            size_t RowBytes = 100 + Offset * 13;
+            for (int NonTemporal = 0; NonTemporal < 2; ++NonTemporal)
+            {
+                memset(Dest.data(), 0xCD, Dest.size());
+                Expected = Dest;
+                for (int Y = 0; Y < 7; ++Y)
+                {
+                    memcpy(&Expected[Offset + 1000 * Y], &Src[3 + 300 * Y], RowBytes);
+                }
+                ch::CopyRows(&Dest[Offset], 1000, &Src[3], 300, RowBytes, 7, NonTemporal != 0);
+                assert(Dest == Expected);
+            }
+        }
+        memset(Dest.data(), 0, Dest.size());
+        ch::CopyRows(Dest.data(), 64, Src.data(), 64, 64, 64);
+        assert(memcmp(Dest.data(), Src.data(), 4096) == 0);
+    }
+    
+    // chain layout
+    assert(ch::GetMipLevelCount(1, 1) == 1 && ch::GetMipLevelCount(256, 256) == 9 && ch::GetMipLevelCount(300, 5) == 9);
+    {
+        ch::mip_chain Chain = ch::AllocateMipChain(300, 5, ch::PixelFormat_RGBA16F);
+        assert(Chain.LevelCount == 9);
+        int Widths[9] = {300, 150, 75, 37, 18, 9, 4, 2, 1};
+        int Heights[9] = {5, 2, 1, 1, 1, 1, 1, 1, 1};
+        for (int I = 0; I < 9; ++I)
+        {
+            ch::image_level *Level = &Chain.Levels[I];
+            assert(Level->Width == Widths[I] && Level->Height == Heights[I]);
+            assert(((uintptr_t)Level->Pixels & 63) == 0 && (Level->Pitch & 63) == 0 && Level->Pitch >= (size_t)Level->Width * 8);
+        }
+        ch::FreeMipChain(&Chain);
+        assert(!Chain.Allocation);
+        
+        Chain = ch::AllocateMipChain(64, 64, ch::PixelFormat_RGBA8, 3);
+        assert(Chain.LevelCount == 3 && Chain.Levels[2].Width == 16);
+        ch::FreeMipChain(&Chain);
+    }
+    
+    // flat images stay flat, in every format and with every filter
+    {
+        const ch::pixel_format Formats[5] = {ch::PixelFormat_RGBA8, ch::PixelFormat_RGBA8_SRGB, ch::PixelFormat_RGBA16F,
+                                             ch::PixelFormat_RGBA32F, ch::PixelFormat_R32F};
+        for (int FormatI = 0; FormatI < 5; ++FormatI)
+        {
+            for (int Filter = ch::MipFilter_Box; Filter <= ch::MipFilter_Kaiser; ++Filter)
+            {
+                int Width = 45, Height = 23;
+                f32 Color[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+                std::vector<f32> Linear(4 * (size_t)Width);
+                for (int X = 0; X < Width; ++X) memcpy(&Linear[4 * X], Color, sizeof(Color));
+                
+                ch::pixel_format Format = Formats[FormatI];
+                ch::mip_chain Chain = ch::AllocateMipChain(Width, Height, Format);
+                ch::image_level *Base = &Chain.Levels[0];
+                for (int Y = 0; Y < Height; ++Y)
+                {
+                    ch::StorePixels((u8 *)Base->Pixels + Base->Pitch * Y, Linear.data(), Format, Width);
+                }
+                ch::GenerateMips(&Chain, (ch::mip_filter)Filter, 1);
+                
+                u8 Reference[16];
+                memcpy(Reference, Base->Pixels, ch::GetPixelSize(Format));
+                for (int LevelI = 1; LevelI < Chain.LevelCount; ++LevelI)
+                {
+                    ch::image_level *Level = &Chain.Levels[LevelI];
+                    for (int Y = 0; Y < Level->Height; ++Y)
+                    {
+                        for (int X = 0; X < Level->Width; ++X)
+                        {
+                            f32 Texel[4], Expected[4];
+                            ch::LoadPixels(Texel, (u8 *)Level->Pixels + Level->Pitch * Y + ch::GetPixelSize(Format) * X, Format, 1);
+                            ch::LoadPixels(Expected, Reference, Format, 1);
+                            for (int C = 0; C < 4; ++C) assert(fabsf(Texel[C] - Expected[C]) < 1e-5f);
+                        }
+                    }
+                }
+                ch::FreeMipChain(&Chain);
+            }
+        }
+    }
+    
+    // a black/white checker averages to linear 0.5, which is 188 in sRGB and 128 in unorm
+    {
+        std::vector<u32> Checker(64 * 64);
+        for (int Y = 0; Y < 64; ++Y)
+        {
+            for (int X = 0; X < 64; ++X)
+            {
+                Checker[Y * 64 + X] = ((X ^ Y) & 1)? 0xFFFFFFFF: 0xFF000000;
+            }
+        }
+        for (int Filter = ch::MipFilter_Box; Filter <= ch::MipFilter_Kaiser; ++Filter)
+        {
+            ch::mip_chain SRGB = ch::BuildMipChain(Checker.data(), 256, 64, 64, ch::PixelFormat_RGBA8_SRGB, (ch::mip_filter)Filter, 1);
+            ch::mip_chain Unorm = ch::BuildMipChain(Checker.data(), 256, 64, 64, ch::PixelFormat_RGBA8, (ch::mip_filter)Filter, 1);
+            for (int LevelI = 1; LevelI < SRGB.LevelCount; ++LevelI)
+            {
+                // center texel, clamping at the edges breaks the pattern for the wide kernel
+                ch::image_level *Level = &SRGB.Levels[LevelI];
+                size_t Center = Level->Pitch * (Level->Height / 2) + 4 * (Level->Width / 2);
+                const u8 *S = (const u8 *)Level->Pixels + Center;
+                const u8 *U = (const u8 *)Unorm.Levels[LevelI].Pixels + Center;
+                assert(abs(S[0] - 188) <= 1 && abs(S[1] - 188) <= 1 && S[3] == 255);
+                assert(abs(U[0] - 128) <= 1 && U[3] == 255);
+            }
+            ch::FreeMipChain(&SRGB);
+            ch::FreeMipChain(&Unorm);
+        }
+    }
+    
+    // the integer box path agrees with the float path
+    {
+        int Width = 131, Height = 77;
+        ch::mip_chain Integer = ch::AllocateMipChain(Width, Height, ch::PixelFormat_RGBA8);
+        FillNoise(&Integer.Levels[0], 1);
+        ch::GenerateMips(&Integer, ch::MipFilter_Box, 1);
+        
+        ch::mip_chain Float = ch::AllocateMipChain(Width, Height, ch::PixelFormat_RGBA32F);
+        ch::ConvertImage(Float.Levels[0].Pixels, Float.Levels[0].Pitch, ch::PixelFormat_RGBA32F,
+                         Integer.Levels[0].Pixels, Integer.Levels[0].Pitch, ch::PixelFormat_RGBA8, Width, Height, 1);
+        ch::image_level *Level1 = &Float.Levels[1];
+        ch::DownsampleLevel(Level1, &Float.Levels[0], ch::PixelFormat_RGBA32F, ch::MipFilter_Box, 1);
+        for (int Y = 0; Y < Level1->Height; ++Y)
+        {
+            std::vector<u8> Bytes(4 * (size_t)Level1->Width);
+            ch::ConvertPixels(Bytes.data(), ch::PixelFormat_RGBA8, (u8 *)Level1->Pixels + Level1->Pitch * Y, ch::PixelFormat_RGBA32F, Level1->Width);
+            const u8 *Row = (const u8 *)Integer.Levels[1].Pixels + Integer.Levels[1].Pitch * Y;
+            for (int X = 0; X < 4 * Level1->Width; ++X)
+            {
+                assert(abs(Row[X] - Bytes[X]) <= 1);
+            }
+        }
+        ch::FreeMipChain(&Integer);
+        ch::FreeMipChain(&Float);
+    }
+    
+    // threads don't change the result
+    {
+        const ch::pixel_format Formats[3] = {ch::PixelFormat_RGBA8, ch::PixelFormat_RGBA8_SRGB, ch::PixelFormat_RGBA16F};
+        for (int FormatI = 0; FormatI < 3; ++FormatI)
+        {
+            for (int Filter = ch::MipFilter_Box; Filter <= ch::MipFilter_Kaiser; ++Filter)
+            {
+                int Width = 613, Height = 509;
+                ch::mip_chain Base = ch::AllocateMipChain(Width, Height, ch::PixelFormat_RGBA8, 1);
+                FillNoise(&Base.Levels[0], 7);
+                ch::mip_chain Source = ch::AllocateMipChain(Width, Height, Formats[FormatI], 1);
+                ch::ConvertImage(Source.Levels[0].Pixels, Source.Levels[0].Pitch, Formats[FormatI],
+                                 Base.Levels[0].Pixels, Base.Levels[0].Pitch, ch::PixelFormat_RGBA8, Width, Height, 1);
+                
+                ch::mip_chain Single = ch::BuildMipChain(Source.Levels[0].Pixels, Source.Levels[0].Pitch, Width, Height,
+                                                         Formats[FormatI], (ch::mip_filter)Filter, 1);
+                ch::mip_chain Threaded = ch::BuildMipChain(Source.Levels[0].Pixels, Source.Levels[0].Pitch, Width, Height,
+                                                           Formats[FormatI], (ch::mip_filter)Filter, 5);
+                assert(Single.LevelCount == 10 && Single.Levels[9].Width == 1 && Single.Levels[9].Height == 1);
+                assert(LevelsEqual(&Single, &Threaded));
+                
+                ch::FreeMipChain(&Threaded);
+                ch::FreeMipChain(&Single);
+                ch::FreeMipChain(&Source);
+                ch::FreeMipChain(&Base);
+            }
+        }
+    }
+    
+    // kaiser lets through less of what aliases (above the new nyquist) and more of what doesn't
+    {
+        int Width = 256;
+        f32 Periods[2] = {2.5f, 10.0f};
+        f32 Contrast[2][2];
+        for (int PeriodI = 0; PeriodI < 2; ++PeriodI)
+        {
+            std::vector<f32> Rows(4 * (size_t)Width * 4);
+            for (int Y = 0; Y < 4; ++Y)
+            {
+                for (int X = 0; X < Width; ++X)
+                {
+                    f32 V = 0.5f + 0.5f * sinf(2.0f * 3.1415926f * X / Periods[PeriodI]);
+                    for (int C = 0; C < 4; ++C) Rows[4 * ((size_t)Y * Width + X) + C] = V;
+                }
+            }
+            for (int Filter = 0; Filter < 2; ++Filter)
+            {
+                ch::mip_chain Chain = ch::BuildMipChain(Rows.data(), (size_t)Width * 16, Width, 4, ch::PixelFormat_RGBA32F,
+                                                        (ch::mip_filter)Filter, 1, 2);
+                const f32 *Out = (const f32 *)Chain.Levels[1].Pixels;
+                f32 Min = 1.0f, Max = 0.0f;
+                for (int X = 8; X < 120; ++X)
+                {
+                    Min = Out[4 * X] < Min? Out[4 * X]: Min;
+                    Max = Out[4 * X] > Max? Out[4 * X]: Max;
+                }
+                Contrast[PeriodI][Filter] = Max - Min;
+                ch::FreeMipChain(&Chain);
+            }
+        }
+        assert(Contrast[0][ch::MipFilter_Kaiser] < 0.25f * Contrast[0][ch::MipFilter_Box]);
+        assert(Contrast[1][ch::MipFilter_Kaiser] > Contrast[1][ch::MipFilter_Box]);
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "../ch_bench.h"
+#include "../ch_jobs.h"
+#include <vector>
+
+/*
+usage: ch_jobs_bench [--threads n] [--filter text] [--repetitions n] [--seconds s] [--json out.json]
+
+Scaling of ch_jobs from 1 thread up to --threads (default 64, past the hardware
+threads it measures oversubscription). Each thread count gets a fresh system:
+
+parallel_for  2^20 floats through a few dozen flops each, grain 4096
+empty_jobs    4096 jobs that do nothing and a wait, the scheduling cost
+fibonacci     fib(25) with a job per call down to fib(12), every job waits on its child
+
+The table at the end is the speedup over 1 thread by median time.
+*/
+
+static int
+Fibonacci(ch::job_system *Jobs, int N)
+{
+    if (N < 2) return N;
+    if (N < 12) return Fibonacci(Jobs, N - 1) + Fibonacci(Jobs, N - 2);
+    int A = 0;
+    ch::job_counter Counter;
+    ch::RunJob(Jobs, [=, &A]() { A = Fibonacci(Jobs, N - 1); }, &Counter);
+    int B = Fibonacci(Jobs, N - 2);
+    ch::WaitForCounter(Jobs, &Counter);
+    return A + B;
+}
+
+int main(int ArgCount, char **Args)
+{
+    ch::bench_options Options = ch::DefaultBenchOptions();
+    const char *JSONPath = 0;
+    int MaxThreads = 64;
+    for (int ArgI = 1; ArgI < ArgCount; ++ArgI)
+    {
+        const char *Arg = Args[ArgI];
+        const char *Value = ArgI + 1 < ArgCount? Args[ArgI + 1]: 0;
+        if (!Value)
+        {
+            printf("%s needs a value\n", Arg);
+            return 2;
+        }
+        ++ArgI;
+        if (strcmp(Arg, "--threads") == 0) MaxThreads = atoi(Value);
+        else if (strcmp(Arg, "--filter") == 0) Options.Filter = Value;
+        else if (strcmp(Arg, "--repetitions") == 0) Options.RepetitionCount = atoi(Value);
+        else if (strcmp(Arg, "--seconds") == 0) Options.RepetitionSeconds = atof(Value);
+        else if (strcmp(Arg, "--json") == 0) JSONPath = Value;
+        else
+        {
+            printf("unknown option %s\n", Arg);
+            return 2;
+        }
+    }
+    if (MaxThreads < 1) MaxThreads = 1;
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    
+    const int ElementCount = 1 << 20;
+    std::vector<float> Elements(ElementCount);
+    for (int I = 0; I < ElementCount; ++I) Elements[I] = float(I % 1000) * 0.001f;
+    
+    const char *KernelNames[] = {"parallel_for", "empty_jobs", "fibonacci"};
+    const int KernelCount = 3;
+    int ThreadCounts[16];
+    f64 Medians[16][KernelCount] = {};
+    int RowCount = 0;
+    
+    ch::bench_suite Suite = ch::InitBenchSuite(Options);
+    for (int ThreadCount = 1; ThreadCount <= MaxThreads && RowCount < 16; ThreadCount = ThreadCount < MaxThreads && ThreadCount * 2 > MaxThreads? MaxThreads: ThreadCount * 2)
+    {
+        ch::job_system *Jobs = ch::CreateJobSystem(ThreadCount);
+        char Name[96];
+        const ch::bench_result *Results[KernelCount];
+        
+        snprintf(Name, sizeof(Name), "jobs/parallel_for/%d", ThreadCount);
+        Results[0] = ch::RunBenchmark(&Suite, Name, f64(ElementCount), [&]()
+                                      {
+                                          ch::ParallelFor(Jobs, 0, ElementCount, 4096, [&](i64 Begin, i64 End)
+                                                          {
+                                                              for (i64 I = Begin; I < End; ++I)
+                                                              {
+                                                                  float X = Elements[size_t(I)];
+                                                                  for (int Step = 0; Step < 16; ++Step) X = X * 0.75f + 0.125f;
+                                                                  Elements[size_t(I)] = X;
+                                                              }
+                                                          });
+                                      });
+        
+        snprintf(Name, sizeof(Name), "jobs/empty_jobs/%d", ThreadCount);
+        Results[1] = ch::RunBenchmark(&Suite, Name, 4096.0, [&]()
+                                      {
+                                          ch::job_counter Counter;
+                                          for (int I = 0; I < 4096; ++I)
+                                          {
+                                              ch::RunJob(Jobs, []() {}, &Counter);
+                                          }
+                                          ch::WaitForCounter(Jobs, &Counter);
+                                      });
+        
+        snprintf(Name, sizeof(Name), "jobs/fibonacci/%d", ThreadCount);
+        Results[2] = ch::RunBenchmark(&Suite, Name, 0.0, [&]()
+                                      {
+                                          ch::KeepValue(Fibonacci(Jobs, 25));
+                                      });
+        
+        ThreadCounts[RowCount] = ThreadCount;
+        for (int KernelI = 0; KernelI < KernelCount; ++KernelI)
+        {
+            Medians[RowCount][KernelI] = Results[KernelI]? Results[KernelI]->Median: 0.0;
+        }
+        ++RowCount;
+        ch::DestroyJobSystem(Jobs);
+        if (ThreadCount == MaxThreads) break;
+    }
+    
+    printf("\nspeedup over 1 thread\nthreads");
+    for (int KernelI = 0; KernelI < KernelCount; ++KernelI) printf(" %14s", KernelNames[KernelI]);
+    printf("\n");
+    for (int RowI = 0; RowI < RowCount; ++RowI)
+    {
+        printf("%7d", ThreadCounts[RowI]);
+        for (int KernelI = 0; KernelI < KernelCount; ++KernelI)
+        {
+            f64 Base = Medians[0][KernelI];
+            f64 Median = Medians[RowI][KernelI];
+            if (Base > 0.0 && Median > 0.0) printf(" %13.2fx", Base / Median);
+            else printf(" %14s", "-");
+        }
+        printf("\n");
+    }
+    
+    if (JSONPath && !ch::WriteBenchJSON(&Suite, JSONPath))
+    {
+        printf("can't write %s\n", JSONPath);
+    }
+    ch::FreeBenchSuite(&Suite);
+    return 0;
+}
\ No newline at end of file
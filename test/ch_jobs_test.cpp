@@ -0,0 +1,271 @@
+#include "../ch_jobs.h"
+#include <assert.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+static int
+Fibonacci(ch::job_system *Jobs, int N)
+{
+    if (N < 2) return N;
+    if (N < 12) return Fibonacci(Jobs, N - 1) + Fibonacci(Jobs, N - 2);
+    
+    // a job that waits on its children by running jobs
+    int A = 0;
+    ch::job_counter Counter;
+    ch::RunJob(Jobs, [=, &A]() { A = Fibonacci(Jobs, N - 1); }, &Counter);
+    int B = Fibonacci(Jobs, N - 2);
+    ch::WaitForCounter(Jobs, &Counter);
+    return A + B;
+}
+
+// WaitForCounter that gives up, a lost job shows up as false instead of a hang
+static bool
+WaitForCounterFor(ch::job_system *Jobs, ch::job_counter *Counter, double Seconds)
+{
+    ch::job_worker *Worker = ch::GetJobWorker(Jobs);
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    while (!ch::IsCounterDone(Counter))
+    {
+        if (!ch::TryRunJob(Jobs, Worker)) std::this_thread::yield();
+        if (std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count() > Seconds) return false;
+    }
+    return true;
+}
+
+int main()
+{
+    // deque: LIFO for the owner, FIFO for thieves, fixed size
+    {
+        ch::job_deque Deque = {};
+        ch::InitJobDeque(&Deque, 4);
+        ch::job Jobs[5] = {};
+        bool Contended = false;
+        assert(!ch::PopJob(&Deque));
+        assert(!ch::StealJob(&Deque, &Contended));
+        for (int I = 0; I < 4; ++I) assert(ch::PushJob(&Deque, &Jobs[I]));
+        assert(!ch::PushJob(&Deque, &Jobs[4]));
+        assert(ch::StealJob(&Deque, &Contended) == &Jobs[0]);
+        assert(ch::PopJob(&Deque) == &Jobs[3]);
+        assert(ch::PushJob(&Deque, &Jobs[4]));
+        assert(ch::PushJob(&Deque, &Jobs[3]));
+        assert(ch::StealJob(&Deque, &Contended) == &Jobs[1]);
+        assert(ch::PopJob(&Deque) == &Jobs[3]);
+        assert(ch::PopJob(&Deque) == &Jobs[4]);
+        assert(ch::PopJob(&Deque) == &Jobs[2]);
+        assert(!ch::PopJob(&Deque));
+        assert(!ch::StealJob(&Deque, &Contended));
+        assert(!Contended);
+        ch::FreeJobDeque(&Deque);
+    }
+    
+    // deque: the owner and thieves racing, every job is taken exactly once
+    {
+        const int JobCount = 200000;
+        const int ThiefCount = 3;
+        ch::job_deque Deque = {};
+        ch::InitJobDeque(&Deque, 256);
+        std::vector<ch::job> Jobs(JobCount);
+        std::vector<std::atomic<int>> Taken(JobCount);
+        for (std::atomic<int> &Count: Taken) Count = 0;
+        std::atomic<bool> Done(false);
+        std::vector<std::thread> Thieves;
+        for (int I = 0; I < ThiefCount; ++I)
+        {
+            Thieves.emplace_back([&]()
+                                 {
+                                     while (!Done.load())
+                                     {
+                                         bool Contended = false;
+                                         ch::job *Job = ch::StealJob(&Deque, &Contended);
+                                         if (Job) Taken[Job - Jobs.data()]++;
+                                         else std::this_thread::yield();
+                                     }
+                                 });
+        }
+        for (int I = 0; I < JobCount; ++I)
+        {
+            while (!ch::PushJob(&Deque, &Jobs[I]))
+            {
+                ch::job *Job = ch::PopJob(&Deque);
+                if (Job) Taken[Job - Jobs.data()]++;
+            }
+            if (I % 3 == 0)
+            {
+                ch::job *Job = ch::PopJob(&Deque);
+                if (Job) Taken[Job - Jobs.data()]++;
+            }
+        }
+        while (ch::job *Job = ch::PopJob(&Deque)) Taken[Job - Jobs.data()]++;
+        Done = true;
+        for (std::thread &Thief: Thieves) Thief.join();
+        for (int I = 0; I < JobCount; ++I) assert(Taken[I].load() == 1);
+        ch::FreeJobDeque(&Deque);
+    }
+    
+    for (int ThreadCount: {1, 2, 4, 8})
+    {
+        ch::job_system *Jobs = ch::CreateJobSystem(ThreadCount);
+        assert(ch::GetJobThreadCount(Jobs) == ThreadCount);
+        assert(ch::GetJobThreadIndex(Jobs) == 0);
+        
+        // plain jobs, more than a thread has slots
+        {
+            const int JobCount = 3 * CH_JOBS_PER_THREAD;
+            std::vector<std::atomic<int>> Ran(JobCount);
+            for (std::atomic<int> &Count: Ran) Count = 0;
+            std::vector<std::atomic<int>> PerThread(ThreadCount);
+            for (std::atomic<int> &Count: PerThread) Count = 0;
+            ch::job_counter Counter;
+            for (int I = 0; I < JobCount; ++I)
+            {
+                ch::RunJob(Jobs, [&, I]()
+                           {
+                               Ran[I]++;
+                               int Index = ch::GetJobThreadIndex(Jobs);
+                               assert(Index >= 0 && Index < ThreadCount);
+                               PerThread[Index]++;
+                           }, &Counter);
+            }
+            ch::WaitForCounter(Jobs, &Counter);
+            assert(ch::IsCounterDone(&Counter));
+            int Total = 0;
+            for (int I = 0; I < JobCount; ++I) assert(Ran[I].load() == 1);
+            for (int I = 0; I < ThreadCount; ++I) Total += PerThread[I].load();
+            assert(Total == JobCount);
+        }
+        
+        // parallel-for covers every index once, in ranges no bigger than the grain
+        for (i64 Count: {0, 1, 7, 1000, 100003})
+        {
+            for (i64 Grain: {0, 1, 64, 100000})
+            {
+                std::vector<std::atomic<int>> Hits((size_t)Count);
+                for (std::atomic<int> &Hit: Hits) Hit = 0;
+                std::atomic<i64> MaxRange(0);
+                ch::ParallelFor(Jobs, 5, 5 + Count, Grain, [&](i64 Begin, i64 End)
+                                {
+                                    assert(Begin >= 5 && End <= 5 + Count && Begin < End);
+                                    i64 Range = End - Begin;
+                                    i64 Max = MaxRange.load();
+                                    while (Range > Max && !MaxRange.compare_exchange_weak(Max, Range)) {}
+                                    for (i64 I = Begin; I < End; ++I) Hits[size_t(I - 5)]++;
+                                });
+                for (i64 I = 0; I < Count; ++I) assert(Hits[size_t(I)].load() == 1);
+                if (Grain > 0) assert(MaxRange.load() <= Grain);
+            }
+        }
+        
+        // nested parallel-for
+        {
+            std::vector<std::atomic<int>> Hits(64 * 64);
+            for (std::atomic<int> &Hit: Hits) Hit = 0;
+            ch::ParallelFor(Jobs, 0, 64, 1, [&](i64 RowBegin, i64 RowEnd)
+                            {
+                                for (i64 Row = RowBegin; Row < RowEnd; ++Row)
+                                {
+                                    ch::ParallelFor(Jobs, 0, 64, 8, [&](i64 Begin, i64 End)
+                                                    {
+                                                        for (i64 I = Begin; I < End; ++I) Hits[size_t(Row * 64 + I)]++;
+                                                    });
+                                }
+                            });
+            for (std::atomic<int> &Hit: Hits) assert(Hit.load() == 1);
+        }
+        
+        // dependencies: the second stage starts after the whole first stage
+        {
+            const int StageSize = 500;
+            std::atomic<int> FirstDone(0);
+            std::atomic<int> TooEarly(0);
+            std::atomic<int> SecondDone(0);
+            ch::job_counter First, Second, Third;
+            
+            // parked before the first stage has any jobs: runs right away
+            std::atomic<int> Immediate(0);
+            ch::RunJob(Jobs, [&]() { Immediate++; }, &Third, &First);
+            ch::WaitForCounter(Jobs, &Third);
+            assert(Immediate.load() == 1);
+            
+            for (int I = 0; I < StageSize; ++I)
+            {
+                ch::RunJob(Jobs, [&]()
+                           {
+                               for (volatile int Spin = 0; Spin < 1000; ++Spin) {}
+                               FirstDone++;
+                           }, &First);
+            }
+            for (int I = 0; I < StageSize; ++I)
+            {
+                ch::RunJob(Jobs, [&]()
+                           {
+                               if (FirstDone.load() != StageSize) TooEarly++;
+                               SecondDone++;
+                           }, &Second, &First);
+            }
+            ch::RunJob(Jobs, [&]() { assert(SecondDone.load() == StageSize); }, &Third, &Second);
+            ch::WaitForCounter(Jobs, &Third);
+            assert(ch::IsCounterDone(&First) && ch::IsCounterDone(&Second));
+            assert(FirstDone.load() == StageSize && SecondDone.load() == StageSize);
+            assert(TooEarly.load() == 0);
+        }
+        
+        // parking while the dependency finishes, none of the parked jobs may get lost
+        {
+            const int RoundCount = 20000;
+            const int ParkerCount = 3;
+            std::atomic<int> Ran(0);
+            for (int Round = 0; Round < RoundCount; ++Round)
+            {
+                // the parkers go once the first job is about to finish (or after a while, with one thread)
+                std::atomic<int> Go(0);
+                ch::job_counter First, Parkers, Parked;
+                ch::RunJob(Jobs, [&]()
+                           {
+                               for (int Spin = 0; Spin < 1000 && !Go.load(); ++Spin) CH_JOBS_PAUSE();
+                               Go.store(1);
+                           }, &First);
+                for (int I = 0; I < ParkerCount; ++I)
+                {
+                    ch::RunJob(Jobs, [&]()
+                               {
+                                   Go.store(1);
+                                   for (int Spin = 0; Spin < Round % 32; ++Spin) CH_JOBS_PAUSE();
+                                   ch::RunJob(Jobs, [&]() { Ran++; }, &Parked, &First);
+                               }, &Parkers);
+                }
+                assert(WaitForCounterFor(Jobs, &Parkers, 10.0));
+                assert(WaitForCounterFor(Jobs, &Parked, 10.0));
+            }
+            assert(Ran.load() == RoundCount * ParkerCount);
+        }
+        
+        // recursive jobs waiting on their children
+        assert(Fibonacci(Jobs, 22) == 17711);
+        
+        // from a thread outside the system, jobs run on that thread
+        {
+            std::thread Outside([&]()
+                                {
+                                    assert(ch::GetJobThreadIndex(Jobs) == -1);
+                                    ch::job_counter Counter;
+                                    int Ran = 0;
+                                    ch::RunJob(Jobs, [&]() { ++Ran; }, &Counter);
+                                    assert(Ran == 1);
+                                    ch::WaitForCounter(Jobs, &Counter);
+                                    std::atomic<i64> Sum(0);
+                                    ch::ParallelFor(Jobs, 0, 1000, 10, [&](i64 Begin, i64 End)
+                                                    {
+                                                        for (i64 I = Begin; I < End; ++I) Sum += I;
+                                                    });
+                                    assert(Sum.load() == 999 * 1000 / 2);
+                                });
+            Outside.join();
+        }
+        
+        ch::DestroyJobSystem(Jobs);
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
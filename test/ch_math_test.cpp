@@ -1,7 +1,156 @@
 #include "../ch_math.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+constexpr f32
+AbsDiff(f32 A, f32 B)
+{
+    return A > B? A - B: B - A;
+}
+
+// all of these are folded by the compiler, nothing runs at startup
+constexpr v3 Offset = 2.0f * XAxis() + V3(0.0f, 1.0f, 0.0f) - ZAxis();
+static_assert(Offset.X == 2.0f && Offset.Y == 1.0f && Offset.Z == -1.0f, "v3 arithmetic");
+static_assert(Dot(Offset, Offset) == 6.0f, "dot");
+static_assert(Cross(XAxis(), YAxis()).Z == 1.0f, "cross");
+static_assert(Lerp(V3(0.0f), V3(2.0f), 0.25f).Y == 0.5f, "lerp");
+
+constexpr mat4 Model = Mat4Scale(2.0f) * Mat4Translate(1.0f, 2.0f, 3.0f);
+constexpr v4 Transformed = V4(1.0f, 1.0f, 1.0f) * Model;
+static_assert(Transformed.X == 3.0f && Transformed.Y == 4.0f && Transformed.Z == 5.0f && Transformed.W == 1.0f,
+              "row vector times matrix");
+static_assert(Transpose(Model).Data[0][3] == 1.0f, "transpose");
+static_assert((Mat4Identity() * Model).Data[3][2] == 3.0f, "identity");
+static_assert(ApplyMat4(ZeroV3(), Model).Y == 2.0f, "apply");
+
+constexpr v3 Normal = V3(1.0f, 0.0f, 0.0f) * Mat3(Mat4Scale(4.0f));
+static_assert(Normal.X == 4.0f, "mat3");
+
+// 90 degrees around Z
+constexpr quaternion Quarter = {0.0f, 0.0f, 0.70710678f, 0.70710678f};
+constexpr v3 Rotated = Rotate(XAxis(), Quarter);
+static_assert(AbsDiff(Rotated.X, 0.0f) < 1e-6f && AbsDiff(Rotated.Y, 1.0f) < 1e-6f, "quaternion rotate");
+static_assert(AbsDiff(QuaternionToMat4(Quarter).Data[0][1], 1.0f) < 1e-6f, "quaternion to mat4");
+static_assert((Quarter * Conjugate(Quarter)).Z == 0.0f, "quaternion product");
+
+constexpr sin_cos_table<64> SinCos = MakeSinCosTable<64>();
+static_assert(SinCos.Sin[0] == 0.0f && SinCos.Cos[0] == 1.0f, "sin/cos table");
+static_assert(SinCos.Sin[16] == 1.0f && AbsDiff(SinCos.Cos[32], -1.0f) < 1e-7f, "sin/cos table");
+
+static_assert(MortonEncode2(0xFFFF, 0) == 0x55555555, "morton 2d");
+static_assert(MortonEncode2(0, 0xFFFF) == 0xAAAAAAAA, "morton 2d");
+static_assert(MortonEncode3(0x3FF, 0, 0) == 0x09249249, "morton 3d");
+static_assert(MortonCompact3(MortonEncode3(5, 6, 7) >> 1) == 6, "morton 3d");
+
+// generic vectors, constant expressions go through Data
+constexpr v3d FarAway = V3D(1e7, 2.0, -3.0) + 0.5 * V3D(1.0, 2.0, 2.0);
+static_assert(FarAway.Data[0] == 10000000.5 && FarAway.Data[1] == 3.0 && FarAway.Data[2] == -2.0, "v3d");
+static_assert(Dot(V3I(1, 2, 3), V3I(4, 5, 6)) == 32, "int dot");
+static_assert(Cross(V3I(1, 0, 0), V3I(0, 1, 0)) == V3I(0, 0, 1), "int cross");
+static_assert(Max(V3I(1, 5, -2), V3I(3, 0, -1)) == V3I(3, 5, -1), "int max");
+static_assert(V3I(7, 8, 9) / 2 == V3I(3, 4, 4), "int divide");
+static_assert(ApplyMat(V3D(1.0, 1.0, 1.0), MatTranslate(V3D(1.0, 2.0, 3.0)) * MatScale(V3D(2.0, 2.0, 2.0))) ==
+              V3D(4.0, 6.0, 8.0), "mat4d");
+static_assert(RebaseMatrix(Mat4D(Mat4Translate(1.0f, 2.0f, 3.0f)), V3D(1.0, 2.0, 3.0)).Data[3][0] == 0.0f, "rebase");
+
+static u32
+SlowMorton(u32 *Coords, int Dim, int Bits)
+{
+    u32 Result = 0;
+    for (int Bit = 0; Bit < Bits; ++Bit)
+    {
+        for (int D = 0; D < Dim; ++D)
+        {
+            Result |= ((Coords[D] >> Bit) & 1) << (Bit * Dim + D);
+        }
+    }
+    return Result;
+}
 
 int main()
 {
+    // the compile time versions agree with libm
+    for (int I = -2000; I <= 2000; ++I)
+    {
+        f64 X = 0.01 * I;
+        assert(fabs(ConstSin(X) - sin(X)) < 1e-12);
+        assert(fabs(ConstCos(X) - cos(X)) < 1e-12);
+    }
+    
+    constexpr sin_cos_table<256> Table = MakeSinCosTable<256>();
+    for (int I = 0; I < 256; ++I)
+    {
+        f64 Angle = 2.0 * 3.14159265358979323846 * I / 256.0;
+        assert(fabs(Table.Sin[I] - sin(Angle)) < 1e-7);
+        assert(fabs(Table.Cos[I] - cos(Angle)) < 1e-7);
+    }
+    
+    u32 State = 1;
+    for (int I = 0; I < 100000; ++I)
+    {
+        State = State * 1664525 + 1013904223;
+        u32 Coords[3] = {State & 0xFFFF, State >> 16, (State >> 5) & 0x3FF};
+        u32 Code2 = MortonEncode2(Coords[0], Coords[1]);
+        assert(Code2 == SlowMorton(Coords, 2, 16));
+        assert(MortonCompact2(Code2) == Coords[0] && MortonCompact2(Code2 >> 1) == Coords[1]);
+        
+        Coords[0] &= 0x3FF;
+        Coords[1] &= 0x3FF;
+        u32 Code3 = MortonEncode3(Coords[0], Coords[1], Coords[2]);
+        assert(Code3 == SlowMorton(Coords, 3, 10));
+        assert(MortonCompact3(Code3) == Coords[0] && MortonCompact3(Code3 >> 1) == Coords[1] &&
+               MortonCompact3(Code3 >> 2) == Coords[2]);
+    }
+    
+    // generic f32 instantiation matches the hand written types bit for bit
+    mat4 Perspective = Mat4Perspective(70.0f, 1.7f, 0.1f, 1000.0f) * Mat4LookAt(V3(1.0f, 2.0f, 3.0f), V3(-2.0f, 0.5f, 7.0f));
+    mat<f32, 4> GenericPerspective = {};
+    memcpy(&GenericPerspective, &Perspective, sizeof(mat4));
+    for (int I = 0; I < 100; ++I)
+    {
+        v4 P = V4(0.37f * I, -1.3f * I, 2.1f + I, 1.0f);
+        v4 Q = P * (Perspective * Perspective);
+        vec<f32, 4> GenericQ = Vec(P.X, P.Y, P.Z, P.W) * (GenericPerspective * GenericPerspective);
+        assert(memcmp(&Q, &GenericQ, sizeof(v4)) == 0);
+        assert(Dot(V3(P), V3(Q)) == Dot(Vec(P.X, P.Y, P.Z), Vec(Q.X, Q.Y, Q.Z)));
+    }
+    
+    // rebasing keeps precision that f32 world positions lose
+    v3d Camera = V3D(6371000.0, 1234567.25, -4000000.0);
+    const int Count = 1003;
+    static v3d World[Count];
+    static v3 Local[Count];
+    for (int I = 0; I < Count; ++I)
+    {
+        World[I] = Camera + V3D(0.001 * I, -0.0005 * I, 0.25 + 0.0001 * I);
+    }
+    RebasePositions(Local, World, Count, Camera);
+    f64 MaxError = 0.0;
+    f64 MaxNaiveError = 0.0;
+    for (int I = 0; I < Count; ++I)
+    {
+        v3d Expected = World[I] - Camera;
+        assert(Local[I].X == (f32)Expected.X && Local[I].Y == (f32)Expected.Y && Local[I].Z == (f32)Expected.Z);
+        MaxError = fmax(MaxError, Len(V3D(Local[I]) - Expected));
+        
+        v3 Naive = V3(World[I]) - V3(Camera);
+        MaxNaiveError = fmax(MaxNaiveError, Len(V3D(Naive) - Expected));
+    }
+    assert(MaxError < 1e-7);
+    assert(MaxNaiveError > 0.01);
+    
+    mat4d Model = Mat4D(Mat4RotateAroundY(0.3f)) * MatTranslate(World[10]);
+    mat4d Models[5] = {Model, Model, Model, Model, Model};
+    mat4 Rebased[5];
+    RebaseMatrices(Rebased, Models, 5, Camera);
+    v4 Origin = V4(0.0f, 0.0f, 0.0f) * Rebased[4];
+    assert(Origin.X == Local[10].X && Origin.Y == Local[10].Y && Origin.Z == Local[10].Z);
+    
+    // runtime results didn't change
+    v4 P = V4(1.0f, -2.0f, 3.0f) * Mat4Perspective(60.0f, 1.5f, 0.1f, 100.0f) * Inverse(Mat4Perspective(60.0f, 1.5f, 0.1f, 100.0f));
+    assert(AbsDiff(P.X, 1.0f) < 1e-4f && AbsDiff(P.Y, -2.0f) < 1e-4f && AbsDiff(P.Z, 3.0f) < 1e-4f);
     
+    printf("OK\n");
     return 0;
-}
\ No newline at end of file
+}
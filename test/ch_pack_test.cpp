@@ -0,0 +1,260 @@
+#include "../ch_pack.h"
+#include <assert.h>
+#include <stdio.h>
+
+static f32
+RandomF32(u32 *State)
+{
+    *State ^= *State << 13;
+    *State ^= *State >> 17;
+    *State ^= *State << 5;
+    return f32(*State & 0xFFFFFF) / f32(0xFFFFFF);
+}
+
+static v3
+RandomUnitV3(u32 *State)
+{
+    for (;;)
+    {
+        v3 V = V3(RandomF32(State), RandomF32(State), RandomF32(State)) * 2.0f - V3(1.0f);
+        f32 L = Len(V);
+        if (L > 0.01f && L <= 1.0f) return V / L;
+    }
+}
+
+static f32
+AngleInDegrees(v3 A, v3 B)
+{
+    // atan2 stays accurate for tiny angles, acos(dot) doesn't in float
+    A = Normalize(A);
+    B = Normalize(B);
+    return atan2f(Len(Cross(A, B)), Dot(A, B)) * 180.0f / Pi32;
+}
+
+static void
+TestHalf()
+{
+    // every half survives half -> float -> half, nans stay nans
+    for (u32 H = 0; H < 0x10000; ++H)
+    {
+        f32 F = ch::F16ToF32(u16(H));
+        u16 Back = ch::F32ToF16(F);
+        bool IsNan = (H & 0x7C00) == 0x7C00 && (H & 0x3FF);
+        if (IsNan)
+        {
+            assert((Back & 0x7C00) == 0x7C00 && (Back & 0x3FF));
+        }
+        else
+        {
+            assert(Back == H);
+        }
+    }
+    
+    assert(ch::F32ToF16(1.0f) == 0x3C00);
+    assert(ch::F32ToF16(-2.0f) == 0xC000);
+    assert(ch::F32ToF16(65504.0f) == 0x7BFF);
+    assert(ch::F32ToF16(65520.0f) == 0x7C00); // rounds up to inf
+    assert(ch::F32ToF16(1e-8f) == 0x0000); // below the smallest denormal
+    assert(ch::F32ToF16(5.9604645e-8f) == 0x0001);
+    assert(ch::F16ToF32(0x0001) == 5.9604645e-8f);
+    assert(ch::F32ToF16(1.0f + 1.0f / 2048.0f) == 0x3C00); // tie, to even
+    assert(ch::F32ToF16(1.0f + 3.0f / 2048.0f) == 0x3C02); // tie, to even
+    
+    // batch paths agree with the scalar ones, including the tail
+    u32 State = 0xC0FFEE;
+    const int Count = 1003;
+    f32 In[Count];
+    for (int I = 0; I < Count; ++I)
+    {
+        f32 Magnitude = powf(2.0f, RandomF32(&State) * 40.0f - 28.0f);
+        In[I] = (RandomF32(&State) < 0.5f? -1.0f: 1.0f) * Magnitude;
+    }
+    In[0] = 0.0f; In[1] = -0.0f; In[2] = 1e30f; In[3] = -1e30f;
+    
+    u16 Halves[Count];
+    f32 Out[Count];
+    ch::PackHalf(Halves, In, Count);
+    ch::UnpackHalf(Out, Halves, Count);
+    for (int I = 0; I < Count; ++I)
+    {
+        assert(Halves[I] == ch::F32ToF16(In[I]));
+        assert(ch::AsU32(Out[I]) == ch::AsU32(ch::F16ToF32(Halves[I])));
+        
+        // normal range: relative error within half an ulp
+        f32 A = Abs(In[I]);
+        if (A >= 6.1035156e-5f && A <= 65504.0f)
+        {
+            assert(Abs(Out[I] - In[I]) <= A * (1.0f / 2048.0f));
+        }
+    }
+}
+
+static void
+TestOct()
+{
+    u32 State = 0x1234;
+    const int Count = 4099;
+    static f32 Normals[3 * Count], Out[3 * Count];
+    for (int I = 0; I < Count; ++I)
+    {
+        v3 N = RandomUnitV3(&State);
+        Normals[3*I + 0] = N.X; Normals[3*I + 1] = N.Y; Normals[3*I + 2] = N.Z;
+    }
+    
+    // the axes and octant corners are the usual trouble spots
+    v3 Special[] = {V3(1, 0, 0), V3(-1, 0, 0), V3(0, 1, 0), V3(0, -1, 0), V3(0, 0, 1), V3(0, 0, -1),
+        Normalize(V3(1, 1, -1)), Normalize(V3(-1, -1, -1))};
+    for (int I = 0; I < 8; ++I)
+    {
+        Normals[3*I + 0] = Special[I].X; Normals[3*I + 1] = Special[I].Y; Normals[3*I + 2] = Special[I].Z;
+    }
+    
+    static u32 Packed[Count];
+    ch::PackOctNormals(Packed, Normals, Count);
+    ch::UnpackOctNormals(Out, Packed, Count);
+    
+    f32 MaxError = 0.0f;
+    for (int I = 0; I < Count; ++I)
+    {
+        v3 N = V3(Normals[3*I], Normals[3*I + 1], Normals[3*I + 2]);
+        assert(Packed[I] == ch::PackOctNormal(N));
+        
+        v3 Decoded = V3(Out[3*I], Out[3*I + 1], Out[3*I + 2]);
+        v3 Scalar = ch::UnpackOctNormal(Packed[I]);
+        assert(Len(Decoded - Scalar) < 1e-6f);
+        assert(Abs(Len(Decoded) - 1.0f) < 1e-5f);
+        MaxError = Max(MaxError, AngleInDegrees(N, Decoded));
+    }
+    assert(MaxError < 0.005f);
+}
+
+static void
+Test1010102()
+{
+    u32 State = 0x777;
+    for (int I = 0; I < 1000; ++I)
+    {
+        v4 V = V4(RandomF32(&State), RandomF32(&State), RandomF32(&State), 0.0f);
+        V.W = f32(I % 4) / 3.0f;
+        v4 U = ch::UnpackUnorm1010102(ch::PackUnorm1010102(V));
+        assert(Abs(U.X - V.X) <= 0.5f / 1023.0f + 1e-6f);
+        assert(Abs(U.Y - V.Y) <= 0.5f / 1023.0f + 1e-6f);
+        assert(Abs(U.Z - V.Z) <= 0.5f / 1023.0f + 1e-6f);
+        assert(Abs(U.W - V.W) < 1e-6f);
+    }
+    assert(ch::PackUnorm1010102(V4(1.0f, 0.0f, 0.0f, 0.0f)) == 0x3FF);
+    assert(ch::PackUnorm1010102(V4(0.0f, 0.0f, 0.0f, 1.0f)) == 0xC0000000);
+    
+    const int Count = 1001;
+    static f32 Normals[3 * Count], Out[3 * Count];
+    static u32 Packed[Count];
+    for (int I = 0; I < Count; ++I)
+    {
+        v3 N = RandomUnitV3(&State);
+        Normals[3*I + 0] = N.X; Normals[3*I + 1] = N.Y; Normals[3*I + 2] = N.Z;
+    }
+    ch::PackSnorm1010102(Packed, Normals, Count);
+    ch::UnpackSnorm1010102(Out, Packed, Count);
+    for (int I = 0; I < Count; ++I)
+    {
+        v3 N = V3(Normals[3*I], Normals[3*I + 1], Normals[3*I + 2]);
+        assert(Packed[I] == ch::PackSnorm1010102(V4(N.X, N.Y, N.Z, 0.0f)));
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            assert(Abs(Out[3*I + Axis] - N.Data[Axis]) <= 0.5f / 511.0f + 1e-6f);
+        }
+    }
+    
+    v4 Negative = ch::UnpackSnorm1010102(ch::PackSnorm1010102(V4(-1.0f, 1.0f, -0.5f, -1.0f)));
+    assert(Negative.X == -1.0f && Negative.Y == 1.0f && Negative.W == -1.0f);
+    assert(Abs(Negative.Z + 0.5f) <= 0.5f / 511.0f);
+}
+
+static void
+TestQTangent()
+{
+    // the basis conversion agrees with ch_math's Rotate
+    quaternion Q = Quaternion(V3(1.0f, 2.0f, 3.0f), 1.3f);
+    quaternion R = ch::QuaternionFromBasis(Rotate(V3(1, 0, 0), Q), Rotate(V3(0, 1, 0), Q), Rotate(V3(0, 0, 1), Q));
+    assert(Abs(Abs(Dot(Q, R)) - 1.0f) < 1e-5f);
+    
+    u32 State = 0xBEEF;
+    const int Count = 1002;
+    static f32 N[3 * Count], T[3 * Count], Signs[Count];
+    static f32 OutN[3 * Count], OutT[3 * Count], OutSigns[Count];
+    static ch::qtangent Packed[Count];
+    for (int I = 0; I < Count; ++I)
+    {
+        v3 Normal = RandomUnitV3(&State);
+        v3 Tangent = Normalize(Cross(Normal, RandomUnitV3(&State)));
+        if (I == 0) { Normal = V3(0, 0, 1); Tangent = V3(1, 0, 0); } // w = 1
+        if (I == 1) { Normal = V3(0, 0, -1); Tangent = V3(1, 0, 0); } // w = 0
+        if (I == 2) { Normal = V3(0, 0, -1); Tangent = V3(-1, 0, 0); } // w = 0
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            N[3*I + Axis] = Normal.Data[Axis];
+            T[3*I + Axis] = Tangent.Data[Axis];
+        }
+        Signs[I] = (I & 1)? -1.0f: 1.0f;
+    }
+    
+    ch::PackQTangents(Packed, N, T, Signs, Count);
+    ch::UnpackQTangents(OutN, OutT, OutSigns, Packed, Count);
+    
+    f32 MaxError = 0.0f;
+    for (int I = 0; I < Count; ++I)
+    {
+        v3 Normal = V3(N[3*I], N[3*I + 1], N[3*I + 2]);
+        v3 Tangent = V3(T[3*I], T[3*I + 1], T[3*I + 2]);
+        v3 DecodedN = V3(OutN[3*I], OutN[3*I + 1], OutN[3*I + 2]);
+        v3 DecodedT = V3(OutT[3*I], OutT[3*I + 1], OutT[3*I + 2]);
+        assert(OutSigns[I] == Signs[I]);
+        
+        v3 ScalarN, ScalarT;
+        f32 ScalarSign;
+        ch::UnpackQTangent(Packed[I], &ScalarN, &ScalarT, &ScalarSign);
+        assert(Len(ScalarN - DecodedN) < 1e-5f && Len(ScalarT - DecodedT) < 1e-5f);
+        assert(ScalarSign == Signs[I]);
+        
+        MaxError = Max(MaxError, AngleInDegrees(Normal, DecodedN));
+        MaxError = Max(MaxError, AngleInDegrees(Tangent, DecodedT));
+        assert(Abs(Dot(DecodedN, DecodedT)) < 1e-4f);
+    }
+    assert(MaxError < 0.005f);
+}
+
+static void
+TestPackMesh()
+{
+    ch_obj::Mesh Mesh = {};
+    Mesh.vertex_count = 3;
+    f32 P[9] = {0.0f, 1.0f, 2.0f,  -3.5f, 100.25f, 0.125f,  1.0f, 1.0f, 1.0f};
+    f32 NB[9] = {0.0f, 0.0f, 1.0f,  0.0f, 1.0f, 0.0f,  -1.0f, 0.0f, 0.0f};
+    Mesh.vb = P;
+    Mesh.nb = NB;
+    
+    ch::packed_vertex *Vertices = ch::PackMesh(&Mesh);
+    for (int I = 0; I < 3; ++I)
+    {
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            assert(ch::F16ToF32(Vertices[I].P[Axis]) == P[3*I + Axis]);
+        }
+        assert(ch::F16ToF32(Vertices[I].P[3]) == 1.0f);
+        v3 N = ch::UnpackOctNormal(Vertices[I].N);
+        assert(AngleInDegrees(N, V3(NB[3*I], NB[3*I + 1], NB[3*I + 2])) < 0.01f);
+    }
+    free(Vertices);
+}
+
+int main()
+{
+    TestHalf();
+    TestOct();
+    Test1010102();
+    TestQTangent();
+    TestPackMesh();
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
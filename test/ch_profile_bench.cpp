@@ -0,0 +1,137 @@
+#include "../ch_profile.h"
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/*
+usage: ch_profile_bench
+
+Nanoseconds per clock read and per empty zone (begin, end, through CH_ZONE) at 1
+thread up to all hardware threads. Every thread records batches small enough
+for its ring and the main thread exports in between, like a frame would. The
+export time is not counted, the zone budget is 20 ns.
+*/
+
+// keeps the clock reads from being optimized out
+static volatile u64 Sink;
+
+template <typename F>
+static f64
+NanosecondsPerCall(F Work, int CallsPerRun)
+{
+    int RunCount = 0;
+    u64 Begin = ch::GetClockNanoseconds();
+    u64 Elapsed = 0;
+    do
+    {
+        Work();
+        ++RunCount;
+        Elapsed = ch::GetClockNanoseconds() - Begin;
+    } while (Elapsed < 250000000ull);
+    return f64(Elapsed) / (f64(RunCount) * f64(CallsPerRun));
+}
+
+static void
+EmptyZones(int Count)
+{
+    for (int I = 0; I < Count; ++I)
+    {
+        CH_ZONE("empty");
+    }
+}
+
+int main()
+{
+    printf("%.3f GHz ticks, tsc %s\n", ch::GetTicksPerSecond() / 1e9, CH_PROFILE_TSC? "on": "off");
+    
+    f64 TickCost = NanosecondsPerCall([]()
+                                      {
+                                          u64 Sum = 0;
+                                          for (int I = 0; I < 1000; ++I) Sum += ch::GetTicks();
+                                          Sink += Sum;
+                                      }, 1000);
+    f64 ClockCost = NanosecondsPerCall([]()
+                                       {
+                                           u64 Sum = 0;
+                                           for (int I = 0; I < 1000; ++I) Sum += ch::GetClockNanoseconds();
+                                           Sink += Sum;
+                                       }, 1000);
+    printf("GetTicks            %6.2f ns\n", TickCost);
+    printf("GetClockNanoseconds %6.2f ns\n", ClockCost);
+    
+    // a quarter of the ring per batch, exported after every batch, only the recording is timed
+    const int BatchSize = CH_PROFILE_RING_SIZE / 8;
+    ch::profile_track *Track = ch::CreateProfileTrack("explicit");
+    for (int Variant = 0; Variant < 2; ++Variant)
+    {
+        u64 Recording = 0, Exporting = 0;
+        int RunCount = 0;
+        u64 Begin = ch::GetClockNanoseconds();
+        do
+        {
+            u64 RecordBegin = ch::GetClockNanoseconds();
+            if (Variant == 0)
+            {
+                EmptyZones(BatchSize);
+            }
+            else
+            {
+                for (int I = 0; I < BatchSize; ++I)
+                {
+                    ch::PushZoneBegin(Track, "empty", ch::GetTicks());
+                    ch::PushZoneEnd(Track, ch::GetTicks());
+                }
+            }
+            u64 ExportBegin = ch::GetClockNanoseconds();
+            size_t Size = 0;
+            free(ch::ExportChromeTrace(&Size));
+            Recording += ExportBegin - RecordBegin;
+            Exporting += ch::GetClockNanoseconds() - ExportBegin;
+            ++RunCount;
+        } while (ch::GetClockNanoseconds() - Begin < 250000000ull);
+        printf("%s %6.2f ns per zone, export %6.2f ns per zone\n", Variant == 0? "CH_ZONE            ": "own track          ",
+               f64(Recording) / (f64(RunCount) * BatchSize), f64(Exporting) / (f64(RunCount) * BatchSize));
+    }
+    
+    int MaxThreads = int(std::thread::hardware_concurrency());
+    if (MaxThreads <= 0) MaxThreads = 1;
+    for (int ThreadCount = 1; ThreadCount <= MaxThreads; ThreadCount = ThreadCount < MaxThreads && ThreadCount * 2 > MaxThreads? MaxThreads: ThreadCount * 2)
+    {
+        const int BatchCount = 16;
+        std::atomic<int> Batches(0);
+        std::atomic<int> Exported(0);
+        std::atomic<u64> Nanoseconds(0);
+        std::vector<std::thread> Threads;
+        for (int ThreadI = 0; ThreadI < ThreadCount; ++ThreadI)
+        {
+            Threads.emplace_back([&]()
+                                 {
+                                     for (int BatchI = 0; BatchI < BatchCount; ++BatchI)
+                                     {
+                                         // waits for the export of the last batch
+                                         while (Exported.load() < BatchI) std::this_thread::yield();
+                                         u64 Begin = ch::GetClockNanoseconds();
+                                         EmptyZones(BatchSize);
+                                         Nanoseconds += ch::GetClockNanoseconds() - Begin;
+                                         Batches += 1;
+                                     }
+                                 });
+        }
+        for (int BatchI = 0; BatchI < BatchCount; ++BatchI)
+        {
+            while (Batches.load() < ThreadCount * (BatchI + 1)) std::this_thread::yield();
+            size_t Size = 0;
+            free(ch::ExportChromeTrace(&Size));
+            Exported = BatchI + 1;
+        }
+        for (std::thread &Thread: Threads) Thread.join();
+        printf("%2d threads          %6.2f ns per zone per thread\n", ThreadCount,
+               f64(Nanoseconds.load()) / (f64(BatchCount) * BatchSize * ThreadCount));
+        size_t Size = 0;
+        free(ch::ExportChromeTrace(&Size));
+        if (ThreadCount == MaxThreads) break;
+    }
+    printf("%llu zones dropped\n", (unsigned long long)ch::GetDroppedZoneCount());
+    return 0;
+}
\ No newline at end of file
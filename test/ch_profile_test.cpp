@@ -0,0 +1,237 @@
+#include "../ch_profile.h"
+#include <assert.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int
+CountString(const char *Text, const char *Pattern)
+{
+    int Count = 0;
+    size_t Length = strlen(Pattern);
+    for (const char *At = strstr(Text, Pattern); At; At = strstr(At + Length, Pattern))
+    {
+        ++Count;
+    }
+    return Count;
+}
+
+static int
+CountEvents(const char *Text, const char *Phase, int TrackId)
+{
+    char Pattern[64];
+    snprintf(Pattern, sizeof(Pattern), "\"ph\":\"%s\",\"pid\":1,\"tid\":%d,", Phase, TrackId);
+    return CountString(Text, Pattern);
+}
+
+// every end closes an earlier begin on the same track
+static bool
+IsBalanced(const char *Text, int TrackId)
+{
+    char Begin[64], End[64];
+    snprintf(Begin, sizeof(Begin), "\"ph\":\"B\",\"pid\":1,\"tid\":%d,", TrackId);
+    snprintf(End, sizeof(End), "\"ph\":\"E\",\"pid\":1,\"tid\":%d,", TrackId);
+    int Depth = 0;
+    for (const char *Line = Text; Line; Line = strchr(Line, '\n'), Line = Line? Line + 1: 0)
+    {
+        const char *LineEnd = strchr(Line, '\n');
+        size_t Length = LineEnd? size_t(LineEnd - Line): strlen(Line);
+        std::string Event(Line, Length);
+        if (strstr(Event.c_str(), Begin)) ++Depth;
+        if (strstr(Event.c_str(), End) && --Depth < 0) return false;
+    }
+    return Depth == 0;
+}
+
+static void
+Inner()
+{
+    CH_ZONE_FUNCTION();
+}
+
+int main()
+{
+    // ticks and calibration
+    {
+        u64 Previous = ch::GetTicks();
+        for (int I = 0; I < 1000; ++I)
+        {
+            u64 Ticks = ch::GetTicks();
+            assert(Ticks >= Previous);
+            Previous = Ticks;
+        }
+        assert(ch::GetTicksPerSecond() > 1e6);
+        
+        u64 TicksBegin = ch::GetTicks();
+        f64 SecondsBegin = ch::GetSeconds();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        f64 Seconds = ch::TicksToSeconds(ch::GetTicks() - TicksBegin);
+        f64 ClockSeconds = ch::GetSeconds() - SecondsBegin;
+        assert(Seconds >= 0.045 && Seconds < 1.0);
+        assert(fabs(Seconds - ClockSeconds) < 0.05 * ClockSeconds + 0.001);
+        assert(fabs(ch::TicksToMilliseconds(ch::GetTicks() - TicksBegin) - 1000.0 * Seconds) < 100.0);
+    }
+    
+    // nested zones on this thread, through the defer macro
+    int MainId = ch::GetThreadTrack()->Id;
+    ch::SetProfileThreadName("main thread");
+    {
+        CH_ZONE("outer");
+        for (int I = 0; I < 3; ++I)
+        {
+            Inner();
+        }
+    }
+    {
+        size_t Size = 0;
+        char *Trace = ch::ExportChromeTrace(&Size);
+        assert(Size == strlen(Trace));
+        assert(strstr(Trace, "{\"traceEvents\":[") == Trace);
+        assert(strstr(Trace, "\"args\":{\"name\":\"main thread\"}"));
+        assert(CountEvents(Trace, "B", MainId) == 4);
+        assert(CountEvents(Trace, "E", MainId) == 4);
+        assert(CountString(Trace, "\"name\":\"Inner\"") == 3);
+        assert(IsBalanced(Trace, MainId));
+        const char *Outer = strstr(Trace, "\"name\":\"outer\"");
+        assert(Outer && Outer < strstr(Trace, "\"name\":\"Inner\""));
+        
+        // the first event starts the timeline
+        assert(strstr(Outer, "\"ts\":0.000}"));
+        free(Trace);
+    }
+    
+    // an export only takes what's new, open zones end in a later export
+    {
+        ch::BeginZone("open");
+        size_t Size = 0;
+        char *Trace = ch::ExportChromeTrace(&Size);
+        assert(CountEvents(Trace, "B", MainId) == 1);
+        assert(CountEvents(Trace, "E", MainId) == 0);
+        free(Trace);
+        
+        ch::EndZone();
+        ch::EndZone(); // an end without a begin is ignored
+        Trace = ch::ExportChromeTrace(&Size);
+        assert(CountEvents(Trace, "B", MainId) == 0);
+        assert(CountEvents(Trace, "E", MainId) == 1);
+        free(Trace);
+    }
+    
+    // names are escaped
+    {
+        ch::BeginZone("say \"hi\"\\\n");
+        ch::EndZone();
+        size_t Size = 0;
+        char *Trace = ch::ExportChromeTrace(&Size);
+        assert(strstr(Trace, "\"name\":\"say \\\"hi\\\"\\\\\\u000a\""));
+        free(Trace);
+    }
+    
+    // full rings drop whole zones and keep the nesting
+    {
+        ch::profile_track *Track = ch::CreateProfileTrack("small", 16);
+        assert(Track->Mask == 15);
+        u64 DroppedBefore = ch::GetDroppedZoneCount();
+        
+        // 8 open zones and their 8 reserved ends fill the 16 events
+        for (int I = 0; I < 10; ++I) ch::PushZoneBegin(Track, "nested", 100 + I);
+        for (int I = 0; I < 10; ++I) ch::PushZoneEnd(Track, 200 + I);
+        assert(ch::GetDroppedZoneCount() - DroppedBefore == 2);
+        
+        size_t Size = 0;
+        char *Trace = ch::ExportChromeTrace(&Size);
+        assert(CountEvents(Trace, "B", Track->Id) == 8);
+        assert(CountEvents(Trace, "E", Track->Id) == 8);
+        assert(IsBalanced(Trace, Track->Id));
+        free(Trace);
+        
+        // sequential zones, 8 fit
+        for (int I = 0; I < 20; ++I)
+        {
+            ch::PushZoneBegin(Track, "flat", 300 + 2 * I);
+            ch::PushZoneEnd(Track, 301 + 2 * I);
+        }
+        assert(ch::GetDroppedZoneCount() - DroppedBefore == 14);
+        Trace = ch::ExportChromeTrace(&Size);
+        assert(CountEvents(Trace, "B", Track->Id) == 8);
+        assert(CountEvents(Trace, "E", Track->Id) == 8);
+        free(Trace);
+        
+        // and it records again once exported
+        ch::PushZoneBegin(Track, "again", 400);
+        ch::PushZoneEnd(Track, 401);
+        Trace = ch::ExportChromeTrace(&Size);
+        assert(CountString(Trace, "\"name\":\"again\"") == 1);
+        free(Trace);
+    }
+    
+    // threads record while another thread exports
+    {
+        const int ThreadCount = 4;
+        const int ZoneCount = 10000;
+        std::atomic<int> Finished(0);
+        std::vector<int> Ids(ThreadCount);
+        std::vector<std::thread> Threads;
+        for (int ThreadI = 0; ThreadI < ThreadCount; ++ThreadI)
+        {
+            Threads.emplace_back([&, ThreadI]()
+                                 {
+                                     ch::SetProfileThreadName("worker");
+                                     Ids[ThreadI] = ch::GetThreadTrack()->Id;
+                                     for (int I = 0; I < ZoneCount; ++I)
+                                     {
+                                         CH_ZONE("work");
+                                         if (I % 16 == 0)
+                                         {
+                                             CH_ZONE("detail");
+                                         }
+                                     }
+                                     Finished++;
+                                 });
+        }
+        
+        std::string All;
+        while (Finished.load() < ThreadCount)
+        {
+            size_t Size = 0;
+            char *Trace = ch::ExportChromeTrace(&Size);
+            All += Trace;
+            free(Trace);
+        }
+        for (std::thread &Thread: Threads) Thread.join();
+        size_t Size = 0;
+        char *Trace = ch::ExportChromeTrace(&Size);
+        All += Trace;
+        free(Trace);
+        
+        int DetailCount = (ZoneCount + 15) / 16;
+        for (int ThreadI = 0; ThreadI < ThreadCount; ++ThreadI)
+        {
+            assert(CountEvents(All.c_str(), "B", Ids[ThreadI]) == ZoneCount + DetailCount);
+            assert(CountEvents(All.c_str(), "E", Ids[ThreadI]) == ZoneCount + DetailCount);
+            assert(IsBalanced(All.c_str(), Ids[ThreadI]));
+        }
+    }
+    
+    // to a file
+    {
+        {
+            CH_ZONE("saved");
+        }
+        assert(ch::SaveChromeTrace("ch_profile_test.json"));
+        FILE *File = fopen("ch_profile_test.json", "rb");
+        assert(File);
+        char Buffer[4096] = {};
+        fread(Buffer, 1, sizeof(Buffer) - 1, File);
+        fclose(File);
+        assert(strstr(Buffer, "\"name\":\"saved\""));
+        assert(strstr(Buffer, "\"displayTimeUnit\":\"ms\"}"));
+        remove("ch_profile_test.json");
+        assert(!ch::SaveChromeTrace("no_such_directory/trace.json"));
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
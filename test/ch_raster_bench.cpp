@@ -0,0 +1,158 @@
+#include "../ch_raster.h"
+#include "../ch_bmp.h"
+#include <stdio.h>
+#include <chrono>
+
+/*
+usage: ch_raster_bench [model.obj|-] [out.bmp]
+
+Without a model (or with -) a ~260K triangle displaced sphere is generated. The model is
+drawn as a 4x4 grid of instances at 1920x1080, once per thread count, and
+the last frame can be written out as a bmp to eyeball the result.
+*/
+
+static f64
+GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<f64>(steady_clock::now().time_since_epoch()).count();
+}
+
+static ch_obj::Model
+GenerateSphere(int Rings, int Segments)
+{
+    ch_obj::Model Model = {};
+    int VertCount = (Rings + 1) * (Segments + 1);
+    Model.vb_count = 3 * VertCount;
+    Model.vb = (float *)malloc(sizeof(float) * Model.vb_count);
+    Model.nb_count = 3 * VertCount;
+    Model.nb = (float *)malloc(sizeof(float) * Model.nb_count);
+    Model.ib_count = 6 * Rings * Segments;
+    Model.ib = (int *)malloc(sizeof(int) * 3 * Model.ib_count);
+    
+    for (int R = 0; R <= Rings; ++R)
+    {
+        for (int S = 0; S <= Segments; ++S)
+        {
+            f32 Theta = Pi32 * f32(R) / f32(Rings);
+            f32 Phi = 2.0f * Pi32 * f32(S) / f32(Segments);
+            f32 Radius = 1.0f + 0.05f * sinf(13.0f * Theta) * cosf(17.0f * Phi);
+            v3 N = V3(sinf(Theta) * cosf(Phi), cosf(Theta), sinf(Theta) * sinf(Phi));
+            int Index = R * (Segments + 1) + S;
+            for (int Axis = 0; Axis < 3; ++Axis)
+            {
+                Model.vb[3*Index + Axis] = Radius * N.Data[Axis];
+                Model.nb[3*Index + Axis] = N.Data[Axis];
+            }
+        }
+    }
+    
+    int *Index = Model.ib;
+    for (int R = 0; R < Rings; ++R)
+    {
+        for (int S = 0; S < Segments; ++S)
+        {
+            int I0 = R * (Segments + 1) + S;
+            int I1 = I0 + 1;
+            int I2 = I0 + Segments + 1;
+            int I3 = I2 + 1;
+            int Quad[6] = {I0, I2, I1, I1, I2, I3};
+            for (int I = 0; I < 6; ++I)
+            {
+                *Index++ = Quad[I];
+                *Index++ = -1;
+                *Index++ = Quad[I];
+            }
+        }
+    }
+    
+    return Model;
+}
+
+int main(int ArgCount, char **Args)
+{
+    ch_obj::Model Model = {};
+    if (ArgCount > 1 && strcmp(Args[1], "-") != 0)
+    {
+        Model = ch_obj::load_model(Args[1]);
+        if (Model.is_invalid)
+        {
+            printf("%s\n", Model.e_msg);
+            return 1;
+        }
+    }
+    else
+    {
+        Model = GenerateSphere(256, 512);
+    }
+    
+    ch_obj::Mesh Mesh = ch_obj::weld_model(&Model);
+    
+    v3 BoundsMin = V3(F32Max), BoundsMax = V3(-F32Max);
+    for (int I = 0; I < Mesh.vertex_count; ++I)
+    {
+        v3 P = V3(Mesh.vb[3*I], Mesh.vb[3*I + 1], Mesh.vb[3*I + 2]);
+        BoundsMin = Min(BoundsMin, P);
+        BoundsMax = Max(BoundsMax, P);
+    }
+    v3 Center = 0.5f * (BoundsMin + BoundsMax);
+    f32 Radius = 0.5f * Len(BoundsMax - BoundsMin);
+    
+    // 4x4 grid of instances, each scaled to a unit bounding sphere
+    const int GridSize = 4;
+    ch::raster_draw Draws[GridSize * GridSize];
+    for (int I = 0; I < GridSize * GridSize; ++I)
+    {
+        f32 X = 2.2f * (f32(I % GridSize) - 0.5f * f32(GridSize - 1));
+        f32 Y = 2.2f * (f32(I / GridSize) - 0.5f * f32(GridSize - 1));
+        Draws[I] = {};
+        Draws[I].Mesh = &Mesh;
+        Draws[I].Transform = Mat4Translate(-Center) * Mat4Scale(1.0f / Radius) * Mat4Translate(V3(X, Y, 0.0f));
+        Draws[I].Color = 0xFFFF8040 | ((I * 0x1F) & 0xFF) << 8;
+    }
+    
+    int Width = 1920, Height = 1080;
+    mat4 ViewProj = Mat4LookAt(V3(0.0f, 0.0f, -9.0f), V3(0.0f)) *
+        Mat4Perspective(60.0f, f32(Width) / f32(Height), 0.1f, 100.0f);
+    v3 LightDir = Normalize(V3(1.0f, -1.0f, 2.0f));
+    
+    int MaxThreads = int(std::thread::hardware_concurrency());
+    if (MaxThreads <= 0) MaxThreads = 1;
+    printf("triangles: %d x %d instances, %dx%d\n",
+           Mesh.ib_count / 3, GridSize * GridSize, Width, Height);
+    
+    ch::raster_context Raster = {};
+    for (int ThreadCount = 1; ThreadCount <= MaxThreads; ThreadCount = ThreadCount < MaxThreads && ThreadCount * 2 > MaxThreads? MaxThreads: ThreadCount * 2)
+    {
+        Raster = ch::InitRasterContext(Width, Height, ThreadCount);
+        
+        // first frame warms up the bins
+        ch::ClearFramebuffer(&Raster.Framebuffer, 0xFF202020);
+        ch::Render(&Raster, Draws, GridSize * GridSize, ViewProj, LightDir);
+        
+        int FrameCount = 5;
+        f64 Begin = GetSeconds();
+        for (int FrameI = 0; FrameI < FrameCount; ++FrameI)
+        {
+            ch::ClearFramebuffer(&Raster.Framebuffer, 0xFF202020);
+            ch::Render(&Raster, Draws, GridSize * GridSize, ViewProj, LightDir);
+        }
+        f64 FrameTime = (GetSeconds() - Begin) / f64(FrameCount);
+        
+        printf("%2d threads: %8.2f ms/frame, %8.2f Mtris/s (%llu binned)\n", ThreadCount,
+               1000.0 * FrameTime, f64(Raster.Stats.SubmittedTriangles) / FrameTime / 1e6,
+               (unsigned long long)Raster.Stats.BinnedTriangles);
+        
+        if (ThreadCount == MaxThreads) break;
+        ch::FreeRasterContext(&Raster);
+    }
+    
+    if (ArgCount > 2)
+    {
+        CH_BMP::WriteImageToBMP(Args[2], Raster.Framebuffer.Color, Width, Height);
+    }
+    
+    ch::FreeRasterContext(&Raster);
+    ch_obj::free_mesh(&Mesh);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "../ch_raster.h"
+#include <assert.h>
+#include <stdio.h>
+
+static f32
+RandomF32(u32 *State)
+{
+    *State ^= *State << 13;
+    *State ^= *State >> 17;
+    *State ^= *State << 5;
+    return f32(*State & 0xFFFFFF) / f32(0xFFFFFF);
+}
+
+static ch_obj::Mesh
+MakeMesh(int VertexCount, int TriCount)
+{
+    ch_obj::Mesh Mesh = {};
+    Mesh.vertex_count = VertexCount;
+    Mesh.vb = (float *)malloc(sizeof(float) * 3 * VertexCount);
+    Mesh.ib_count = 3 * TriCount;
+    Mesh.ib = (unsigned int *)malloc(sizeof(unsigned int) * Mesh.ib_count);
+    return Mesh;
+}
+
+// axis aligned quad at depth Z, split along its diagonal
+static ch_obj::Mesh
+Quad(f32 X0, f32 Y0, f32 X1, f32 Y1, f32 Z)
+{
+    ch_obj::Mesh Mesh = MakeMesh(4, 2);
+    f32 P[12] = {X0, Y0, Z,  X1, Y0, Z,  X1, Y1, Z,  X0, Y1, Z};
+    unsigned int I[6] = {0, 1, 2,  0, 2, 3};
+    memcpy(Mesh.vb, P, sizeof(P));
+    memcpy(Mesh.ib, I, sizeof(I));
+    return Mesh;
+}
+
+static int
+CountPixels(ch::framebuffer *FB, u32 Color)
+{
+    int Count = 0;
+    for (int I = 0; I < FB->Width * FB->Height; ++I)
+    {
+        if (FB->Color[I] == Color) Count += 1;
+    }
+    return Count;
+}
+
+static ch::raster_draw
+Draw(ch_obj::Mesh *Mesh, u32 Color)
+{
+    ch::raster_draw Result = {};
+    Result.Mesh = Mesh;
+    Result.Transform = Mat4Identity();
+    Result.Color = Color;
+    return Result;
+}
+
+static void
+TestCoverage()
+{
+    // odd sizes so both the SIMD and the scalar edge blocks get exercised
+    ch::raster_context Raster = ch::InitRasterContext(100, 70, 2);
+    Raster.Ambient = 1.0f;
+    
+    // covers pixel centers [16, 48) x [16, 48) exactly, the diagonal goes
+    // through pixel centers so the shared edge rule is tested too
+    ch_obj::Mesh Mesh = Quad(16.0f / 50.0f - 1.0f, 16.0f / 35.0f - 1.0f,
+                             48.0f / 50.0f - 1.0f, 48.0f / 35.0f - 1.0f, 0.0f);
+    
+    ch::raster_draw D = Draw(&Mesh, 0xFFFFFFFF);
+    ch::ClearFramebuffer(&Raster.Framebuffer, 0);
+    ch::Render(&Raster, &D, 1, Mat4Identity(), V3(0.0f, 0.0f, 1.0f));
+    assert(CountPixels(&Raster.Framebuffer, 0xFFFFFFFF) == 32 * 32);
+    assert(Raster.Framebuffer.Color[16 * 100 + 16] == 0xFFFFFFFF);
+    assert(Raster.Framebuffer.Color[47 * 100 + 47] == 0xFFFFFFFF);
+    assert(Raster.Framebuffer.Color[48 * 100 + 47] == 0);
+    
+    // each half alone, no pixel may be owned by both
+    int HalfCounts = 0;
+    for (int Half = 0; Half < 2; ++Half)
+    {
+        ch_obj::Mesh HalfMesh = Mesh;
+        HalfMesh.ib = Mesh.ib + 3 * Half;
+        HalfMesh.ib_count = 3;
+        D.Mesh = &HalfMesh;
+        ch::ClearFramebuffer(&Raster.Framebuffer, 0);
+        ch::Render(&Raster, &D, 1, Mat4Identity(), V3(0.0f, 0.0f, 1.0f));
+        HalfCounts += CountPixels(&Raster.Framebuffer, 0xFFFFFFFF);
+    }
+    assert(HalfCounts == 32 * 32);
+    
+    // fullscreen quad covers everything, including the partial blocks on the edges
+    ch_obj::Mesh Full = Quad(-1.0f, -1.0f, 1.0f, 1.0f, 0.0f);
+    D.Mesh = &Full;
+    ch::ClearFramebuffer(&Raster.Framebuffer, 0);
+    ch::Render(&Raster, &D, 1, Mat4Identity(), V3(0.0f, 0.0f, 1.0f));
+    assert(CountPixels(&Raster.Framebuffer, 0xFFFFFFFF) == 100 * 70);
+    
+    ch::FreeRasterContext(&Raster);
+}
+
+static void
+TestDepth()
+{
+    ch::raster_context Raster = ch::InitRasterContext(64, 64, 1);
+    Raster.Ambient = 1.0f;
+    
+    ch_obj::Mesh Far = Quad(-0.5f, -0.5f, 0.5f, 0.5f, 0.5f);
+    ch_obj::Mesh Near = Quad(0.0f, 0.0f, 1.0f, 1.0f, -0.5f);
+    u32 Red = 0xFFFF0000, Green = 0xFF00FF00;
+    
+    for (int Order = 0; Order < 2; ++Order)
+    {
+        ch::raster_draw Draws[2] = {Draw(&Far, Red), Draw(&Near, Green)};
+        if (Order)
+        {
+            ch::raster_draw Temp = Draws[0];
+            Draws[0] = Draws[1];
+            Draws[1] = Temp;
+        }
+        
+        ch::ClearFramebuffer(&Raster.Framebuffer, 0);
+        ch::Render(&Raster, Draws, 2, Mat4Identity(), V3(0.0f, 0.0f, 1.0f));
+        
+        // far quad is 32x32, near one covers a 16x16 corner of it
+        assert(CountPixels(&Raster.Framebuffer, Red) == 32 * 32 - 16 * 16);
+        assert(CountPixels(&Raster.Framebuffer, Green) == 32 * 32);
+        f32 Depth = Raster.Framebuffer.Depth[40 * 64 + 40];
+        assert(Depth > 0.24f && Depth < 0.26f);
+    }
+    
+    ch::FreeRasterContext(&Raster);
+}
+
+static void
+TestThreadCountInvariance()
+{
+    u32 State = 0x1234567;
+    int TriCount = 3000;
+    ch_obj::Mesh Mesh = MakeMesh(3 * TriCount, TriCount);
+    for (int I = 0; I < 3 * TriCount; ++I)
+    {
+        Mesh.ib[I] = I;
+    }
+    for (int TriI = 0; TriI < TriCount; ++TriI)
+    {
+        v3 Center = V3(RandomF32(&State), RandomF32(&State), RandomF32(&State)) * 10.0f - V3(5.0f);
+        for (int VI = 0; VI < 3; ++VI)
+        {
+            for (int Axis = 0; Axis < 3; ++Axis)
+            {
+                Mesh.vb[9*TriI + 3*VI + Axis] = Center.Data[Axis] + RandomF32(&State) * 2.0f - 1.0f;
+            }
+        }
+    }
+    
+    // camera sits inside the soup so the near plane clipper gets work
+    mat4 ViewProj = Mat4LookAt(V3(0.0f, 0.0f, -2.0f), V3(0.0f)) * Mat4Perspective(70.0f, 1.5f, 0.1f, 50.0f);
+    u32 *Reference = 0;
+    for (int ThreadCount = 1; ThreadCount <= 3; ++ThreadCount)
+    {
+        ch::raster_context Raster = ch::InitRasterContext(150, 100, ThreadCount);
+        ch::raster_draw D = Draw(&Mesh, 0xFF80C0FF);
+        ch::ClearFramebuffer(&Raster.Framebuffer, 0xFF000000);
+        ch::Render(&Raster, &D, 1, ViewProj, Normalize(V3(1.0f, -1.0f, 1.0f)));
+        assert(Raster.Stats.SubmittedTriangles == u64(TriCount));
+        assert(Raster.Stats.BinnedTriangles > 0);
+        
+        size_t Size = sizeof(u32) * 150 * 100;
+        if (!Reference)
+        {
+            Reference = (u32 *)malloc(Size);
+            memcpy(Reference, Raster.Framebuffer.Color, Size);
+            assert(CountPixels(&Raster.Framebuffer, 0xFF000000) < 150 * 100);
+        }
+        else
+        {
+            assert(memcmp(Reference, Raster.Framebuffer.Color, Size) == 0);
+        }
+        ch::FreeRasterContext(&Raster);
+    }
+    free(Reference);
+}
+
+int main()
+{
+    TestCoverage();
+    TestDepth();
+    TestThreadCountInvariance();
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
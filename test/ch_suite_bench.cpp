@@ -0,0 +1,571 @@
+#include "../ch_bench.h"
+#include "../ch_hashtable.h"
+#include "../ch_buf.h"
+#include "../ch_pack.h"
+#include "../ch_bmp.h"
+#include "../ch_bvh.h"
+#include "../ch_raster.h"
+#include "../ch_texcache.h"
+#include "../ch_capture.h"
+
+/*
+usage: ch_suite_bench [--filter text] [--repetitions n] [--seconds s] [--json out.json]
+                      [--baseline in.json] [--tolerance t] [--tolerance name=t ...]
+
+The regression suite: a few benchmarks per portable header, each on one thread
+so runs on different machine loads stay comparable (the threaded scaling has its
+own benches). Everything works on generated data. --json writes the results,
+--baseline compares against an earlier --json and exits with 1 if anything got
+slower than its tolerance (default 10%). --tolerance 0.2 changes the default,
+--tolerance bvh/build=0.2 one benchmark and --tolerance bc*=0.25 a prefix. A
+typical loop:
+
+ch_suite_bench --json baseline.json           before the change
+ch_suite_bench --baseline baseline.json       after it
+
+ch_simd.h has no code of its own, it's measured through everything built on it.
+Files go to ./ch_suite_bench_dir and are deleted afterwards.
+*/
+
+static ch_obj::Model
+GenerateSphere(int Rings, int Segments)
+{
+    ch_obj::Model Model = {};
+    int VertCount = (Rings + 1) * (Segments + 1);
+    Model.vb_count = 3 * VertCount;
+    Model.vb = (float *)malloc(sizeof(float) * Model.vb_count);
+    Model.nb_count = 3 * VertCount;
+    Model.nb = (float *)malloc(sizeof(float) * Model.nb_count);
+    Model.ib_count = 6 * Rings * Segments;
+    Model.ib = (int *)malloc(sizeof(int) * 3 * Model.ib_count);
+    
+    for (int R = 0; R <= Rings; ++R)
+    {
+        for (int S = 0; S <= Segments; ++S)
+        {
+            f32 Theta = Pi32 * f32(R) / f32(Rings);
+            f32 Phi = 2.0f * Pi32 * f32(S) / f32(Segments);
+            f32 Radius = 1.0f + 0.05f * sinf(13.0f * Theta) * cosf(17.0f * Phi);
+            v3 N = V3(sinf(Theta) * cosf(Phi), cosf(Theta), sinf(Theta) * sinf(Phi));
+            int Index = R * (Segments + 1) + S;
+            for (int Axis = 0; Axis < 3; ++Axis)
+            {
+                Model.vb[3*Index + Axis] = Radius * N.Data[Axis];
+                Model.nb[3*Index + Axis] = N.Data[Axis];
+            }
+        }
+    }
+    
+    int *Index = Model.ib;
+    for (int R = 0; R < Rings; ++R)
+    {
+        for (int S = 0; S < Segments; ++S)
+        {
+            int I0 = R * (Segments + 1) + S;
+            int I1 = I0 + 1;
+            int I2 = I0 + Segments + 1;
+            int I3 = I2 + 1;
+            int Quad[6] = {I0, I2, I1, I1, I2, I3};
+            for (int I = 0; I < 6; ++I)
+            {
+                *Index++ = Quad[I];
+                *Index++ = -1;
+                *Index++ = Quad[I];
+            }
+        }
+    }
+    
+    return Model;
+}
+
+static void
+FreeModel(ch_obj::Model *Model)
+{
+    free(Model->vb);
+    free(Model->nb);
+    free(Model->ib);
+    *Model = {};
+}
+
+// the sphere as an .obj, for the parser
+static bool
+WriteOBJ(const char *Path, ch_obj::Model *Model)
+{
+    FILE *File = fopen(Path, "wb");
+    if (!File) return false;
+    for (int I = 0; I < Model->vb_count; I += 3)
+    {
+        fprintf(File, "v %f %f %f\n", Model->vb[I], Model->vb[I + 1], Model->vb[I + 2]);
+    }
+    for (int I = 0; I < Model->nb_count; I += 3)
+    {
+        fprintf(File, "vn %f %f %f\n", Model->nb[I], Model->nb[I + 1], Model->nb[I + 2]);
+    }
+    for (int I = 0; I < Model->ib_count; I += 3)
+    {
+        int *Corner = Model->ib + 3 * I;
+        fprintf(File, "f %d//%d %d//%d %d//%d\n", Corner[0] + 1, Corner[2] + 1, Corner[3] + 1, Corner[5] + 1,
+                Corner[6] + 1, Corner[8] + 1);
+    }
+    return fclose(File) == 0;
+}
+
+// RGBA8 with smooth gradients, edges and a bit of noise, like a real texture
+static ch::image
+GenerateImage(int Size)
+{
+    ch::image Image = ch::AllocateImage(Size, Size);
+    for (int Y = 0; Y < Size; ++Y)
+    {
+        u8 *Row = Image.Pixels + Image.Pitch * Y;
+        for (int X = 0; X < Size; ++X)
+        {
+            u32 Noise = u32(X * 2654435761u) ^ u32(Y * 40503u);
+            f32 U = f32(X) / f32(Size), V = f32(Y) / f32(Size);
+            Row[4 * X + 0] = u8(230.0f * (0.5f + 0.5f * sinf(12.0f * U + 5.0f * V)) + (Noise & 15));
+            Row[4 * X + 1] = u8(200.0f * V + ((X / 32 + Y / 32) & 1) * 30 + ((Noise >> 8) & 15));
+            Row[4 * X + 2] = u8(230.0f * U * V + ((Noise >> 16) & 15));
+            Row[4 * X + 3] = u8(230.0f * (0.5f + 0.5f * cosf(9.0f * V)) + ((Noise >> 24) & 15));
+        }
+    }
+    return Image;
+}
+
+static bool
+DiscardCapture(const ch::capture_frame *, void *)
+{
+    return true;
+}
+
+int main(int ArgCount, char **Args)
+{
+    ch::bench_options Options = ch::DefaultBenchOptions();
+    const char *JSONPath = 0;
+    const char *BaselinePath = 0;
+    f64 DefaultTolerance = 0.10;
+    ch::bench_tolerance Tolerances[64];
+    int ToleranceCount = 0;
+    char ToleranceNames[64][96];
+    for (int ArgI = 1; ArgI < ArgCount; ++ArgI)
+    {
+        const char *Arg = Args[ArgI];
+        const char *Value = ArgI + 1 < ArgCount? Args[ArgI + 1]: 0;
+        if (!Value)
+        {
+            printf("%s needs a value\n", Arg);
+            return 2;
+        }
+        ++ArgI;
+        if (strcmp(Arg, "--filter") == 0) Options.Filter = Value;
+        else if (strcmp(Arg, "--repetitions") == 0) Options.RepetitionCount = atoi(Value);
+        else if (strcmp(Arg, "--seconds") == 0) Options.RepetitionSeconds = atof(Value);
+        else if (strcmp(Arg, "--json") == 0) JSONPath = Value;
+        else if (strcmp(Arg, "--baseline") == 0) BaselinePath = Value;
+        else if (strcmp(Arg, "--tolerance") == 0)
+        {
+            const char *Equals = strrchr(Value, '=');
+            if (!Equals)
+            {
+                DefaultTolerance = atof(Value);
+            }
+            else if (ToleranceCount < 64)
+            {
+                snprintf(ToleranceNames[ToleranceCount], sizeof(ToleranceNames[0]), "%.*s", int(Equals - Value), Value);
+                Tolerances[ToleranceCount].Pattern = ToleranceNames[ToleranceCount];
+                Tolerances[ToleranceCount].Tolerance = atof(Equals + 1);
+                ++ToleranceCount;
+            }
+        }
+        else
+        {
+            printf("unknown option %s\n", Arg);
+            return 2;
+        }
+    }
+    
+    ch::bench_suite Baseline = {};
+    if (BaselinePath && !ch::ReadBenchJSON(&Baseline, BaselinePath))
+    {
+        printf("can't read baseline %s\n", BaselinePath);
+        return 2;
+    }
+    
+    const char *Directory = "ch_suite_bench_dir";
+#ifdef _WIN32
+    _mkdir(Directory);
+#else
+    mkdir(Directory, 0755);
+#endif
+    ch::bench_suite Suite = ch::InitBenchSuite(Options);
+    printf("%.3f GHz ticks, %s cycles\n", ch::GetTicksPerSecond() / 1e9, Suite.CycleSource);
+    
+    //
+    // ch_math
+    {
+        const int Count = 1024;
+        mat4 *Matrices = (mat4 *)malloc(sizeof(mat4) * Count);
+        v3 *Vectors = (v3 *)malloc(sizeof(v3) * Count);
+        quaternion *Rotations = (quaternion *)malloc(sizeof(quaternion) * Count);
+        for (int I = 0; I < Count; ++I)
+        {
+            f32 T = f32(I) * 0.01f;
+            Matrices[I] = Mat4Rotate(V3(T, 2.0f * T, 3.0f * T)) * Mat4Translate(V3(T, -T, 1.0f));
+            Vectors[I] = V3(sinf(T) + 1.5f, cosf(3.0f * T), T);
+            Rotations[I] = Quaternion(Normalize(Vectors[I]), T);
+        }
+        ch::RunBenchmark(&Suite, "math/mat4_mul", Count, [&]()
+                         {
+                             mat4 Product = Matrices[0];
+                             for (int I = 1; I < Count; ++I) Product = Product * Matrices[I];
+                             ch::KeepValue(Product);
+                         });
+        ch::RunBenchmark(&Suite, "math/mat4_inverse", Count, [&]()
+                         {
+                             for (int I = 0; I < Count; ++I) ch::KeepValue(Inverse(Matrices[I]));
+                         });
+        ch::RunBenchmark(&Suite, "math/mat4_transform", Count, [&]()
+                         {
+                             for (int I = 0; I < Count; ++I) ch::KeepValue(V4(Vectors[I].X, Vectors[I].Y, Vectors[I].Z, 1.0f) * Matrices[I]);
+                         });
+        ch::RunBenchmark(&Suite, "math/v3_normalize", Count, [&]()
+                         {
+                             for (int I = 0; I < Count; ++I) ch::KeepValue(Normalize(Vectors[I]));
+                         });
+        ch::RunBenchmark(&Suite, "math/quaternion_slerp", Count, [&]()
+                         {
+                             for (int I = 1; I < Count; ++I) ch::KeepValue(Slerp(Rotations[I - 1], Rotations[I], 0.3f));
+                         });
+        free(Rotations);
+        free(Vectors);
+        free(Matrices);
+    }
+    
+    //
+    // ch_hashtable
+    {
+        const int Count = 4096;
+        char (*Keys)[16] = (char (*)[16])malloc(16 * Count);
+        for (int I = 0; I < Count; ++I) snprintf(Keys[I], 16, "key%d", I * 7919);
+        ch::RunBenchmark(&Suite, "hashtable/push", Count, [&]()
+                         {
+                             ch::hash_table<int> Table = {};
+                             for (int I = 0; I < Count; ++I) Table.Push(Keys[I], I);
+                             for (int I = 0; I < Table.Cap; ++I) free(Table.Entries[I].Key);
+                             free(Table.Entries);
+                         });
+        ch::hash_table<int> Table = {};
+        for (int I = 0; I < Count; ++I) Table.Push(Keys[I], I);
+        ch::RunBenchmark(&Suite, "hashtable/lookup", Count, [&]()
+                         {
+                             int Sum = 0;
+                             for (int I = 0; I < Count; ++I) Sum += Table[Keys[I]];
+                             ch::KeepValue(Sum);
+                         });
+        for (int I = 0; I < Table.Cap; ++I) free(Table.Entries[I].Key);
+        free(Table.Entries);
+        free(Keys);
+    }
+    
+    //
+    // ch_buf
+    {
+        const int Count = 4096;
+        ch::RunBenchmark(&Suite, "buf/push", Count, [&]()
+                         {
+                             int *Buffer = ChBufInit(0, int);
+                             for (int I = 0; I < Count; ++I) ChBufPush(Buffer, I);
+                             ch::KeepValue(Buffer);
+                             ChBufFree(Buffer);
+                         });
+    }
+    
+    //
+    // ch_obj, ch_pack, ch_bvh, ch_raster on a 32K triangle sphere
+    {
+        ch_obj::Model Sphere = GenerateSphere(128, 128);
+        char OBJPath[256];
+        snprintf(OBJPath, sizeof(OBJPath), "%s/sphere.obj", Directory);
+        if (WriteOBJ(OBJPath, &Sphere))
+        {
+            ch::RunBenchmark(&Suite, "obj/load_model", Sphere.ib_count / 3, [&]()
+                             {
+                                 ch_obj::Model Model = ch_obj::load_model(OBJPath);
+                                 FreeModel(&Model);
+                             });
+            remove(OBJPath);
+        }
+        ch::RunBenchmark(&Suite, "obj/weld_model", Sphere.ib_count / 3, [&]()
+                         {
+                             ch_obj::Mesh Mesh = ch_obj::weld_model(&Sphere);
+                             ch_obj::free_mesh(&Mesh);
+                         });
+        
+        ch_obj::Mesh Mesh = ch_obj::weld_model(&Sphere);
+        ch::RunBenchmark(&Suite, "pack/pack_mesh", Mesh.vertex_count, [&]()
+                         {
+                             ch::packed_vertex *Vertices = ch::PackMesh(&Mesh);
+                             ch::KeepValue(Vertices);
+                             free(Vertices);
+                         });
+        int FloatCount = 3 * Mesh.vertex_count;
+        u16 *Halves = (u16 *)malloc(sizeof(u16) * FloatCount);
+        u32 *Octs = (u32 *)malloc(sizeof(u32) * Mesh.vertex_count);
+        ch::RunBenchmark(&Suite, "pack/half", FloatCount, [&]()
+                         {
+                             ch::PackHalf(Halves, Mesh.vb, FloatCount);
+                             ch::KeepValue(Halves[0]);
+                         });
+        ch::RunBenchmark(&Suite, "pack/oct_normals", Mesh.vertex_count, [&]()
+                         {
+                             ch::PackOctNormals(Octs, Mesh.nb, Mesh.vertex_count);
+                             ch::KeepValue(Octs[0]);
+                         });
+        free(Octs);
+        free(Halves);
+        
+        ch::RunBenchmark(&Suite, "bvh/build", Sphere.ib_count / 3, [&]()
+                         {
+                             ch::bvh BVH = ch::BuildBVH(&Sphere, 1);
+                             BVH.Free();
+                         });
+        ch::bvh BVH = ch::BuildBVH(&Sphere, 1);
+        const int RayCount = 4096;
+        ch::ray *Rays = (ch::ray *)malloc(sizeof(ch::ray) * RayCount);
+        for (int I = 0; I < RayCount; ++I)
+        {
+            f32 U = f32(I % 64) / 32.0f - 1.0f, V = f32(I / 64) / 32.0f - 1.0f;
+            Rays[I] = ch::Ray(V3(0.0f, 0.0f, -3.0f), Normalize(V3(0.5f * U, 0.5f * V, 1.0f)));
+        }
+        ch::RunBenchmark(&Suite, "bvh/intersect", RayCount, [&]()
+                         {
+                             int HitCount = 0;
+                             for (int I = 0; I < RayCount; ++I)
+                             {
+                                 ch::hit Hit;
+                                 HitCount += BVH.Intersect(Rays[I], &Hit);
+                             }
+                             ch::KeepValue(HitCount);
+                         });
+        ch::RunBenchmark(&Suite, "bvh/occluded", RayCount, [&]()
+                         {
+                             int HitCount = 0;
+                             for (int I = 0; I < RayCount; ++I) HitCount += BVH.Occluded(Rays[I]);
+                             ch::KeepValue(HitCount);
+                         });
+        ch::RunBenchmark(&Suite, "bvh/intersect_packet8", RayCount, [&]()
+                         {
+                             ch::hit Hits[8];
+                             for (int I = 0; I < RayCount; I += 8)
+                             {
+                                 ch::ray_packet8 Packet;
+                                 for (int Lane = 0; Lane < 8; ++Lane)
+                                 {
+                                     const ch::ray *Ray = &Rays[I + Lane];
+                                     Packet.OX[Lane] = Ray->O.X; Packet.OY[Lane] = Ray->O.Y; Packet.OZ[Lane] = Ray->O.Z;
+                                     Packet.DX[Lane] = Ray->D.X; Packet.DY[Lane] = Ray->D.Y; Packet.DZ[Lane] = Ray->D.Z;
+                                     Packet.TMin[Lane] = Ray->TMin;
+                                     Packet.TMax[Lane] = Ray->TMax;
+                                 }
+                                 BVH.Intersect(&Packet, Hits);
+                                 ch::KeepValue(Hits);
+                             }
+                         });
+        free(Rays);
+        BVH.Free();
+        
+        ch::raster_context Raster = ch::InitRasterContext(640, 360, 1);
+        ch::raster_draw Draws[4];
+        for (int I = 0; I < 4; ++I)
+        {
+            Draws[I] = {};
+            Draws[I].Mesh = &Mesh;
+            Draws[I].Transform = Mat4Translate(V3(2.2f * (f32(I) - 1.5f), 0.0f, 0.0f));
+            Draws[I].Color = 0xFFFF8040;
+        }
+        mat4 ViewProj = Mat4LookAt(V3(0.0f, 0.0f, -7.0f), V3(0.0f)) * Mat4Perspective(60.0f, 640.0f / 360.0f, 0.1f, 100.0f);
+        ch::RunBenchmark(&Suite, "raster/render_640x360", 4.0 * Mesh.ib_count / 3, [&]()
+                         {
+                             ch::ClearFramebuffer(&Raster.Framebuffer, 0xFF202020);
+                             ch::Render(&Raster, Draws, 4, ViewProj, Normalize(V3(1.0f, -1.0f, 2.0f)));
+                         });
+        ch::FreeRasterContext(&Raster);
+        ch_obj::free_mesh(&Mesh);
+        FreeModel(&Sphere);
+    }
+    
+    //
+    // ch_image, ch_bmp, ch_imgproc, ch_bc, ch_texcache, ch_capture on a 256x256 texture
+    {
+        const int Size = 256;
+        const f64 PixelCount = f64(Size) * Size;
+        ch::image Image = GenerateImage(Size);
+        u8 *Decoded = (u8 *)malloc((size_t)Size * Size * 4);
+        
+        size_t QOISize = 0;
+        u8 *QOI = ch::EncodeQOI(Image.Pixels, Size, Size, Image.Pitch, 4, &QOISize);
+        ch::RunBenchmark(&Suite, "image/qoi_encode", PixelCount, [&]()
+                         {
+                             size_t EncodedSize = 0;
+                             free(ch::EncodeQOI(Image.Pixels, Size, Size, Image.Pitch, 4, &EncodedSize));
+                         });
+        ch::RunBenchmark(&Suite, "image/qoi_decode", PixelCount, [&]()
+                         {
+                             ch::DecodeImage(QOI, QOISize, Decoded, (size_t)Size * 4);
+                             ch::KeepValue(Decoded[0]);
+                         });
+        ch::RunBenchmark(&Suite, "image/png_encode", PixelCount, [&]()
+                         {
+                             size_t EncodedSize = 0;
+                             free(ch::EncodePNG(Image.Pixels, Size, Size, Image.Pitch, 4, 1, &EncodedSize));
+                         });
+        
+        char BMPPath[256];
+        snprintf(BMPPath, sizeof(BMPPath), "%s/image.bmp", Directory);
+        ch::RunBenchmark(&Suite, "bmp/write", PixelCount, [&]()
+                         {
+                             CH_BMP::WriteImageToBMP(BMPPath, (uint32_t *)Image.Pixels, Size, Size);
+                         });
+        size_t BMPSize = 0;
+        u8 *BMP = ch::ReadFileData(BMPPath, &BMPSize);
+        if (BMP)
+        {
+            ch::RunBenchmark(&Suite, "image/bmp_decode", PixelCount, [&]()
+                             {
+                                 ch::DecodeImage(BMP, BMPSize, Decoded, (size_t)Size * 4);
+                                 ch::KeepValue(Decoded[0]);
+                             });
+            free(BMP);
+        }
+        remove(BMPPath);
+        
+        ch::RunBenchmark(&Suite, "imgproc/mips_box_rgba8", PixelCount, [&]()
+                         {
+                             ch::mip_chain Chain = ch::BuildMipChain(Image.Pixels, Image.Pitch, Size, Size, ch::PixelFormat_RGBA8,
+                                                                     ch::MipFilter_Box, 1);
+                             ch::FreeMipChain(&Chain);
+                         });
+        ch::RunBenchmark(&Suite, "imgproc/mips_kaiser_srgb", PixelCount, [&]()
+                         {
+                             ch::mip_chain Chain = ch::BuildMipChain(Image.Pixels, Image.Pitch, Size, Size, ch::PixelFormat_RGBA8_SRGB,
+                                                                     ch::MipFilter_Kaiser, 1);
+                             ch::FreeMipChain(&Chain);
+                         });
+        f32 *Floats = (f32 *)malloc((size_t)Size * Size * 16);
+        ch::RunBenchmark(&Suite, "imgproc/convert_srgb_to_f32", PixelCount, [&]()
+                         {
+                             ch::ConvertImage(Floats, (size_t)Size * 16, ch::PixelFormat_RGBA32F, Image.Pixels, Image.Pitch,
+                                              ch::PixelFormat_RGBA8_SRGB, Size, Size, 1);
+                             ch::KeepValue(Floats[0]);
+                         });
+        free(Floats);
+        
+        const ch::bc_format Formats[3] = {ch::BCFormat_BC1, ch::BCFormat_BC5, ch::BCFormat_BC7};
+        const char *FormatNames[3] = {"bc1", "bc5", "bc7"};
+        for (int FormatI = 0; FormatI < 3; ++FormatI)
+        {
+            ch::bc_format Format = Formats[FormatI];
+            size_t BlockPitch = ch::GetBCRowPitch(Size, Format);
+            u8 *Blocks = (u8 *)malloc(ch::GetBCImageSize(Size, Size, Format));
+            char Name[64];
+            snprintf(Name, sizeof(Name), "bc/%s_fast_encode", FormatNames[FormatI]);
+            ch::RunBenchmark(&Suite, Name, PixelCount, [&]()
+                             {
+                                 ch::EncodeBC(Blocks, BlockPitch, Image.Pixels, Image.Pitch, Size, Size, Format, ch::BCQuality_Fast, 1);
+                                 ch::KeepValue(Blocks[0]);
+                             });
+            snprintf(Name, sizeof(Name), "bc/%s_decode", FormatNames[FormatI]);
+            ch::RunBenchmark(&Suite, Name, PixelCount, [&]()
+                             {
+                                 ch::DecodeBC(Decoded, (size_t)Size * 4, Blocks, BlockPitch, Size, Size, Format, 1);
+                                 ch::KeepValue(Decoded[0]);
+                             });
+            free(Blocks);
+        }
+        
+        // a warm load is what every run after the first pays
+        char SourcePath[256];
+        snprintf(SourcePath, sizeof(SourcePath), "%s/source.qoi", Directory);
+        ch::texture_cache Cache = ch::InitTextureCache(Directory);
+        ch::texture_build_options BuildOptions = ch::DefaultTextureBuildOptions();
+        BuildOptions.ThreadCount = 1;
+        ch::texture_file File;
+        if (ch::WriteFileData(SourcePath, QOI, QOISize) &&
+            ch::LoadCachedTexture(&File, &Cache, SourcePath, ch::TextureFormat_BC7_SRGB, BuildOptions))
+        {
+            u64 Key = File.Header->Key;
+            ch::CloseTextureFile(&File);
+            ch::RunBenchmark(&Suite, "texcache/warm_load_bc7", PixelCount, [&]()
+                             {
+                                 if (ch::LoadCachedTexture(&File, &Cache, SourcePath, ch::TextureFormat_BC7_SRGB, BuildOptions))
+                                 {
+                                     ch::KeepValue(File.Data[0]);
+                                     ch::CloseTextureFile(&File);
+                                 }
+                             });
+            char EntryPath[600];
+            ch::GetTextureCachePath(EntryPath, sizeof(EntryPath), &Cache, Key);
+            remove(EntryPath);
+        }
+        remove(SourcePath);
+        
+        // what the render thread pays per frame, the writer throws the frames away
+        ch::capture_queue Capture;
+        if (ch::InitCaptureQueue(&Capture, Size, Size, 4, ch::CapturePolicy_Block))
+        {
+            Capture.WriteCallback = DiscardCapture;
+            ch::RunBenchmark(&Suite, "capture/submit", PixelCount, [&]()
+                             {
+                                 ch::SubmitCaptureFrame(&Capture, "unused", Image.Pixels, Size, Size, Image.Pitch,
+                                                        ch::CapturePixel_RGBA8, true);
+                             });
+            ch::FreeCaptureQueue(&Capture);
+        }
+        
+        free(QOI);
+        free(Decoded);
+        ch::FreeImage(&Image);
+    }
+    
+    //
+    // ch_profile
+    {
+        const int Count = 1024;
+        ch::RunBenchmark(&Suite, "profile/ticks", Count, [&]()
+                         {
+                             u64 Sum = 0;
+                             for (int I = 0; I < Count; ++I) Sum += ch::GetTicks();
+                             ch::KeepValue(Sum);
+                         });
+        ch::RunBenchmark(&Suite, "profile/zone_and_export", Count, [&]()
+                         {
+                             for (int I = 0; I < Count; ++I)
+                             {
+                                 CH_ZONE("bench");
+                             }
+                             size_t TraceSize = 0;
+                             free(ch::ExportChromeTrace(&TraceSize));
+                         });
+    }
+    
+#ifdef _WIN32
+    _rmdir(Directory);
+#else
+    rmdir(Directory);
+#endif
+    
+    int Result = 0;
+    if (JSONPath && !ch::WriteBenchJSON(&Suite, JSONPath))
+    {
+        printf("can't write %s\n", JSONPath);
+        Result = 2;
+    }
+    if (BaselinePath)
+    {
+        printf("\n");
+        int Regressions = ch::CompareBenchSuites(&Suite, &Baseline, DefaultTolerance, Tolerances, ToleranceCount, stdout);
+        if (Regressions) Result = 1;
+    }
+    ch::FreeBenchSuite(&Baseline);
+    ch::FreeBenchSuite(&Suite);
+    return Result;
+}
\ No newline at end of file
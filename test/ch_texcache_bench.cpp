@@ -0,0 +1,117 @@
+#include "../ch_texcache.h"
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+/*
+usage: ch_texcache_bench [image file | size]
+
+What the cache saves per texture: a cold load (decode, mips, block compression,
+writing the entry) against a warm one (read and hash the source, map the entry)
+for a few formats. Uses a size x size (default 1024) synthetic QOI when no file
+is given. Entries go to ./ch_texcache_bench_dir and are deleted afterwards. Also
+prints the source hash throughput, which bounds every warm load.
+*/
+
+// keeps the hashing and the reads from being optimized out
+static volatile u64 Sink;
+
+static f64
+GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<f64>(steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int ArgCount, char **Args)
+{
+    const char *SourcePath = "ch_texcache_bench_source.qoi";
+    bool Synthetic = !(ArgCount > 1 && atoi(Args[1]) == 0);
+    if (Synthetic)
+    {
+        int Size = ArgCount > 1? atoi(Args[1]): 1024;
+        std::vector<u32> Pixels((size_t)Size * Size);
+        for (int Y = 0; Y < Size; ++Y)
+        {
+            for (int X = 0; X < Size; ++X)
+            {
+                u32 Noise = (u32(X * 2654435761u) ^ u32(Y * 40503u)) & 0x0F0F0F;
+                Pixels[(size_t)Y * Size + X] = (0xFF000000 | u32(X * 255 / Size) | u32(Y * 255 / Size) << 8 | u32((X ^ Y) & 0xFF) << 16) ^ Noise;
+            }
+        }
+        size_t FileSize = 0;
+        u8 *QOI = ch::EncodeQOI((const u8 *)Pixels.data(), Size, Size, (size_t)Size * 4, 4, &FileSize);
+        ch::WriteFileData(SourcePath, QOI, FileSize);
+        free(QOI);
+    }
+    else
+    {
+        SourcePath = Args[1];
+    }
+    
+    size_t SourceSize = 0;
+    u8 *Source = ch::ReadFileData(SourcePath, &SourceSize);
+    if (!Source)
+    {
+        printf("can't read %s\n", SourcePath);
+        return 1;
+    }
+    f64 Begin = GetSeconds();
+    int HashRuns = 0;
+    do
+    {
+        Sink += ch::HashBytes64(Source, SourceSize);
+        ++HashRuns;
+    } while (GetSeconds() - Begin < 0.25);
+    printf("source %.2f MB, hash %.2f GB/s\n", f64(SourceSize) / 1e6, f64(SourceSize) * HashRuns / (GetSeconds() - Begin) / 1e9);
+    free(Source);
+    
+    ch::texture_cache Cache = ch::InitTextureCache("ch_texcache_bench_dir");
+    const ch::texture_format Formats[4] = {ch::TextureFormat_RGBA8_SRGB, ch::TextureFormat_BC1_SRGB, ch::TextureFormat_BC5, ch::TextureFormat_BC7_SRGB};
+    const char *FormatNames[4] = {"rgba8 srgb", "bc1 srgb", "bc5", "bc7 srgb"};
+    for (int FormatI = 0; FormatI < 4; ++FormatI)
+    {
+        ch::texture_build_options Options = ch::DefaultTextureBuildOptions();
+        ch::texture_file File;
+        
+        f64 ColdBegin = GetSeconds();
+        if (!ch::LoadCachedTexture(&File, &Cache, SourcePath, Formats[FormatI], Options))
+        {
+            printf("can't load %s\n", SourcePath);
+            return 1;
+        }
+        f64 Cold = GetSeconds() - ColdBegin;
+        u64 Key = File.Header->Key;
+        u64 EntrySize = File.Header->DataOffset + File.Header->DataSize;
+        ch::CloseTextureFile(&File);
+        
+        // touch every byte of the entry, like an upload would
+        int RunCount = 0;
+        f64 WarmBegin = GetSeconds();
+        do
+        {
+            ch::LoadCachedTexture(&File, &Cache, SourcePath, Formats[FormatI], Options);
+            for (u64 I = 0; I < File.Header->DataSize; I += 64) Sink += File.Data[I];
+            ch::CloseTextureFile(&File);
+            ++RunCount;
+        } while (GetSeconds() - WarmBegin < 0.25);
+        f64 Warm = (GetSeconds() - WarmBegin) / RunCount;
+        
+        printf("%-10s %8.2f MB entry, cold %9.2f ms, warm %7.2f ms (%.0fx)\n", FormatNames[FormatI], f64(EntrySize) / 1e6,
+               1000.0 * Cold, 1000.0 * Warm, Cold / Warm);
+        
+        char Path[600];
+        ch::GetTextureCachePath(Path, sizeof(Path), &Cache, Key);
+        remove(Path);
+    }
+    printf("%llu hits, %llu builds, %llu failed writes\n", (unsigned long long)Cache.Hits,
+           (unsigned long long)Cache.Builds, (unsigned long long)Cache.WriteFailures);
+    
+#ifdef _WIN32
+    _rmdir("ch_texcache_bench_dir");
+#else
+    rmdir("ch_texcache_bench_dir");
+#endif
+    if (Synthetic) remove(SourcePath);
+    return 0;
+}
\ No newline at end of file
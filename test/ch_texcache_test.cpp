@@ -0,0 +1,265 @@
+#include "../ch_texcache.h"
+#include <assert.h>
+#include <stdio.h>
+#include <vector>
+
+#define TEST_DIR "ch_texcache_test_dir"
+
+static u32
+Hash(u32 X)
+{
+    X ^= X >> 16;
+    X *= 0x7feb352d;
+    X ^= X >> 15;
+    X *= 0x846ca68b;
+    X ^= X >> 16;
+    return X;
+}
+
+// a QOI file of a smooth image with some noise
+static void
+WriteSource(const char *Path, int Width, int Height, u32 Seed, std::vector<u8> *Pixels_Out)
+{
+    std::vector<u8> &Pixels = *Pixels_Out;
+    Pixels.resize((size_t)Width * Height * 4);
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        for (int X = 0; X < Width; ++X)
+        {
+            u8 *P = &Pixels[4 * ((size_t)Y * Width + X)];
+            u32 Noise = Hash(Seed + u32(Y * Width + X));
+            P[0] = u8(X * 255 / Width + (Noise & 7));
+            P[1] = u8(Y * 255 / Height);
+            P[2] = u8((X + Y) * 2 + (Noise >> 8 & 7));
+            P[3] = u8(200 + (Noise >> 16 & 31));
+        }
+    }
+    size_t Size = 0;
+    u8 *QOI = ch::EncodeQOI(Pixels.data(), Width, Height, (size_t)Width * 4, 4, &Size);
+    assert(QOI && ch::WriteFileData(Path, QOI, Size));
+    free(QOI);
+}
+
+// every entry the test made, removed at the end
+static u64 Keys[64];
+static int KeyCount;
+
+static void
+Track(const ch::texture_file *File)
+{
+    Keys[KeyCount++] = File->Header->Key;
+}
+
+static bool
+FileExists(const char *Path)
+{
+    FILE *File = fopen(Path, "rb");
+    if (File) fclose(File);
+    return File != 0;
+}
+
+int main()
+{
+    // xxHash64 reference values
+    {
+        assert(ch::HashBytes64("", 0) == 0xef46db3751d8e999ull);
+        assert(ch::HashBytes64("a", 1) == 0xd24ec4f1a98c6e5bull);
+        assert(ch::HashBytes64("abc", 3) == 0x44bc2cf5ad770999ull);
+        u8 Data[1000];
+        for (int I = 0; I < 1000; ++I) Data[I] = u8(I * 7 + 3);
+        const int Sizes[6] = {5, 31, 32, 33, 100, 1000};
+        const u64 Expected[6][2] = {
+            {0xc7608efddb7051feull, 0xf0941d6dd5fa78a1ull},
+            {0xa2aa5f33cc4a6119ull, 0x8086bf60119a7308ull},
+            {0x23c3c17ef790fd97ull, 0x244c3905cf320c2dull},
+            {0x50a7cfc7ba588784ull, 0x1edc993457cf1fd8ull},
+            {0xa61f8d4c170fe531ull, 0xacb8a02891fea7d2ull},
+            {0x5f235fa033f1a3fbull, 0x365c39a0c5a4c88eull},
+        };
+        for (int I = 0; I < 6; ++I)
+        {
+            assert(ch::HashBytes64(Data, Sizes[I]) == Expected[I][0]);
+            assert(ch::HashBytes64(Data, Sizes[I], 12345) == Expected[I][1]);
+        }
+    }
+    
+    // container layout: placement aligned levels, pitch aligned rows of blocks, down to 1x1
+    {
+        ch::texture_file_header Header;
+        u64 FileSize = ch::InitTextureFileHeader(&Header, ch::TextureFormat_BC7, 100, 60, 0);
+        assert(Header.LevelCount == 7);
+        assert(Header.DataOffset % CH_TEXTURE_PLACEMENT_ALIGNMENT == 0 && Header.DataOffset >= sizeof(Header));
+        assert(FileSize == Header.DataOffset + Header.DataSize);
+        for (u32 LevelI = 0; LevelI < Header.LevelCount; ++LevelI)
+        {
+            const ch::texture_file_level *Level = &Header.Levels[LevelI];
+            assert(Level->Offset % CH_TEXTURE_PLACEMENT_ALIGNMENT == 0);
+            assert(Level->RowPitch % CH_TEXTURE_PITCH_ALIGNMENT == 0);
+            assert(Level->RowPitch >= (Level->Width + 3) / 4 * 16);
+            assert(Level->RowCount == (Level->Height + 3) / 4);
+            assert(Level->Offset + Level->Size <= Header.DataSize);
+        }
+        assert(Header.Levels[0].RowPitch == 512 && Header.Levels[0].RowCount == 15);
+        assert(Header.Levels[6].Width == 1 && Header.Levels[6].Height == 1);
+        assert(ch::InitTextureFileHeader(&Header, ch::texture_format(2), 16, 16, 0) == 0);
+    }
+    
+    ch::texture_build_options Options = ch::DefaultTextureBuildOptions();
+    Options.ThreadCount = 2;
+    int Width = 96, Height = 64;
+    std::vector<u8> Pixels;
+    WriteSource(TEST_DIR "_source.qoi", Width, Height, 1, &Pixels);
+    
+    ch::texture_cache Cache = ch::InitTextureCache(TEST_DIR);
+    char EntryPath[600];
+    
+    // miss builds and writes an entry, the next load maps the same bytes
+    {
+        ch::texture_file Built;
+        assert(ch::LoadCachedTexture(&Built, &Cache, TEST_DIR "_source.qoi", ch::TextureFormat_BC7, Options));
+        Track(&Built);
+        assert(Cache.Builds == 1 && Cache.Hits == 0 && Cache.WriteFailures == 0);
+        assert(Built.Allocation && !Built.Mapping.Data);
+        assert(Built.Header->Width == u32(Width) && Built.Header->Height == u32(Height) && Built.Header->LevelCount == 7);
+        ch::GetTextureCachePath(EntryPath, sizeof(EntryPath), &Cache, Built.Header->Key);
+        assert(FileExists(EntryPath));
+        
+        std::vector<u8> Decoded((size_t)Width * Height * 4);
+        ch::DecodeBC(Decoded.data(), (size_t)Width * 4, Built.Data + Built.Header->Levels[0].Offset, Built.Header->Levels[0].RowPitch,
+                     Width, Height, ch::BCFormat_BC7, 1);
+        assert(ch::ComputePSNR(Pixels.data(), (size_t)Width * 4, Decoded.data(), (size_t)Width * 4, Width, Height, 4) > 35.0);
+        
+        ch::texture_file Cached;
+        assert(ch::LoadCachedTexture(&Cached, &Cache, TEST_DIR "_source.qoi", ch::TextureFormat_BC7, Options));
+        Track(&Cached);
+        assert(Cache.Builds == 1 && Cache.Hits == 1);
+        assert(Cached.Mapping.Data && !Cached.Allocation);
+        assert(Cached.Header->DataSize == Built.Header->DataSize);
+        assert(memcmp(Cached.Header, Built.Header, sizeof(ch::texture_file_header)) == 0);
+        assert(memcmp(Cached.Data, Built.Data, size_t(Built.Header->DataSize)) == 0);
+        
+        // the thread count doesn't change a byte
+        ch::texture_build_options OneThread = Options;
+        OneThread.ThreadCount = 1;
+        size_t Size = 0;
+        u8 *Rebuilt = ch::BuildTextureFile(Pixels.data(), (size_t)Width * 4, Width, Height, ch::TextureFormat_BC7, OneThread,
+                                           Built.Header->Key, Built.Header->SourceHash, &Size);
+        assert(Size == Cached.Mapping.Size && memcmp(Rebuilt, Cached.Mapping.Data, Size) == 0);
+        free(Rebuilt);
+        
+        ch::CloseTextureFile(&Cached);
+        ch::CloseTextureFile(&Built);
+        assert(!Cached.Mapping.Data && !Built.Allocation);
+    }
+    
+    // keyed by content: a copy under another name hits, other formats and options miss
+    {
+        std::vector<u8> Copy;
+        WriteSource(TEST_DIR "_copy.qoi", Width, Height, 1, &Copy);
+        ch::texture_file File;
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_copy.qoi", ch::TextureFormat_BC7, Options));
+        Track(&File);
+        assert(Cache.Hits == 2 && Cache.Builds == 1);
+        ch::CloseTextureFile(&File);
+        
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_copy.qoi", ch::TextureFormat_BC1, Options));
+        Track(&File);
+        assert(Cache.Builds == 2);
+        ch::CloseTextureFile(&File);
+        
+        ch::texture_build_options High = Options;
+        High.Quality = ch::BCQuality_High;
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_copy.qoi", ch::TextureFormat_BC1, High));
+        Track(&File);
+        assert(Cache.Builds == 3);
+        ch::CloseTextureFile(&File);
+        
+        WriteSource(TEST_DIR "_copy.qoi", Width, Height, 2, &Copy);
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_copy.qoi", ch::TextureFormat_BC7, Options));
+        Track(&File);
+        assert(Cache.Builds == 4);
+        ch::CloseTextureFile(&File);
+        remove(TEST_DIR "_copy.qoi");
+    }
+    
+    // a truncated or foreign entry gets rebuilt
+    {
+        size_t Size = 0;
+        u8 *Entry = ch::ReadFileData(EntryPath, &Size);
+        assert(Entry && ch::WriteFileData(EntryPath, Entry, Size - 100));
+        ch::texture_file File;
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_source.qoi", ch::TextureFormat_BC7, Options));
+        Track(&File);
+        assert(Cache.Builds == 5 && File.Allocation);
+        ch::CloseTextureFile(&File);
+        
+        ((ch::texture_file_header *)Entry)->Key ^= 1;
+        assert(ch::WriteFileData(EntryPath, Entry, Size));
+        assert(!ch::OpenTextureFile(&File, EntryPath, ((ch::texture_file_header *)Entry)->Key ^ 1));
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_source.qoi", ch::TextureFormat_BC7, Options));
+        Track(&File);
+        assert(Cache.Builds == 6);
+        ch::CloseTextureFile(&File);
+        free(Entry);
+        
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_source.qoi", ch::TextureFormat_BC7, Options));
+        
+        Track(&File);
+        assert(Cache.Builds == 6 && File.Mapping.Data);
+        ch::CloseTextureFile(&File);
+    }
+    
+    // uncompressed formats keep rows as they are (RGBA8) or converted (float)
+    {
+        ch::texture_file File;
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_source.qoi", ch::TextureFormat_RGBA8, Options));
+        Track(&File);
+        const ch::texture_file_level *Level = &File.Header->Levels[0];
+        assert(Level->RowPitch == 512 && Level->RowCount == u32(Height));
+        for (int Y = 0; Y < Height; ++Y)
+        {
+            assert(memcmp(File.Data + Level->Offset + (size_t)Level->RowPitch * Y, &Pixels[(size_t)Y * Width * 4], (size_t)Width * 4) == 0);
+        }
+        ch::CloseTextureFile(&File);
+        
+        assert(ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_source.qoi", ch::TextureFormat_R32F, Options));
+        
+        Track(&File);
+        Level = &File.Header->Levels[0];
+        assert(Level->RowPitch == 512);
+        const f32 *Row = (const f32 *)(File.Data + Level->Offset + Level->RowPitch * 5);
+        assert(Row[7] == Pixels[4 * (5 * Width + 7)] / 255.0f);
+        ch::CloseTextureFile(&File);
+    }
+    
+    // an unwritable cache still hands out the texture, bad sources and formats fail
+    {
+        ch::texture_cache Nowhere = ch::InitTextureCache(TEST_DIR "_missing/deeper");
+        ch::texture_file File;
+        assert(ch::LoadCachedTexture(&File, &Nowhere, TEST_DIR "_source.qoi", ch::TextureFormat_BC4, Options));
+        Track(&File);
+        assert(Nowhere.Builds == 1 && Nowhere.WriteFailures == 1 && File.Allocation);
+        ch::CloseTextureFile(&File);
+        
+        assert(!ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_nothing.qoi", ch::TextureFormat_BC7, Options));
+        assert(!ch::LoadCachedTexture(&File, &Cache, TEST_DIR "_source.qoi", ch::texture_format(2), Options));
+        assert(!File.Header && !File.Allocation && !File.Mapping.Data);
+    }
+    
+    for (int I = 0; I < KeyCount; ++I)
+    {
+        char Path[600];
+        ch::GetTextureCachePath(Path, sizeof(Path), &Cache, Keys[I]);
+        remove(Path);
+    }
+    remove(TEST_DIR "_source.qoi");
+#ifdef _WIN32
+    _rmdir(TEST_DIR);
+#else
+    rmdir(TEST_DIR);
+#endif
+    assert(!FileExists(EntryPath));
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
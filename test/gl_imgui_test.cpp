@@ -0,0 +1,84 @@
+#include "../kernel.h"
+#include "ch_gl_mock.h"
+#include "imgui_mock.h"
+#include "../gl_imgui.cpp"
+
+static int
+CountStateQueries()
+{
+    return MockGLCalls("glGetIntegerv") + MockGLCalls("glIsEnabled") + MockGLCalls("glGetBooleanv");
+}
+
+// what the app had bound is what it has after the pass
+static void
+CheckAppState()
+{
+    mock_gl &GL = GetMockGL();
+    assert(GL.CurrentProgram == 5 && GL.CurrentVAO == 6);
+    assert(GL.Enabled[GL_DEPTH_TEST] && GL.Enabled[GL_CULL_FACE] && !GL.Enabled[GL_BLEND] && !GL.Enabled[GL_SCISSOR_TEST]);
+    assert(GL.Viewport[2] == 640 && GL.Viewport[3] == 360);
+}
+
+// binds around the cache, like a callback drawing with its own GL code
+static void
+RawGLCallback(const ImDrawList *, const ImDrawCmd *)
+{
+    glUseProgram(99);
+    glDisable(GL_BLEND);
+}
+
+int main()
+{
+    MockGLReset();
+    LoadGLFunctions(MockGLLoad);
+    GetMockGL().Viewport[2] = 1280;
+    GetMockGL().Viewport[3] = 720;
+    
+    InitImgui();
+    ImGuiIO &IO = ImGui::GetIO();
+    assert(IO.DisplaySize.x == 1280 && IO.DisplaySize.y == 720 && IO.RenderDrawListsFn == RenderImgui);
+    assert(MockGLCalls("glTexImage2D") == 1 && IO.Fonts->TexID);
+    assert(g_AttribLocationPosition == 0 && g_AttribLocationUV == 1 && g_AttribLocationColor == 2);
+    
+    // the app's state, through the cache
+    ch::SetGLProgram(5);
+    ch::SetGLVertexArray(6);
+    ch::SetGLEnabled(GL_DEPTH_TEST, true);
+    ch::SetGLEnabled(GL_CULL_FACE, true);
+    ch::SetGLViewport(0, 0, 640, 360);
+    
+    MockImguiFrame Frame(2, 3);
+    
+    // the first frame asks the driver for what the cache never saw
+    {
+        RenderImgui(&Frame.DrawData);
+        assert(GetMockGL().Draws.size() == 2 * 3);
+        CheckAppState();
+    }
+    
+    // after that it's known, a frame saves and restores without a single query
+    for (int FrameI = 0; FrameI < 3; ++FrameI)
+    {
+        int Queries = CountStateQueries();
+        u64 DriverQueries = ch::GetGLStateCache()->DriverQueryCount;
+        RenderImgui(&Frame.DrawData);
+        assert(CountStateQueries() == Queries && ch::GetGLStateCache()->DriverQueryCount == DriverQueries);
+        CheckAppState();
+    }
+    
+    // a callback that calls GL itself: the state is put back all the same, and known after
+    {
+        MockImguiFrame CallbackFrame(1, 2);
+        CallbackFrame.Lists[0].CmdBuffer.Data[0].UserCallback = RawGLCallback;
+        RenderImgui(&CallbackFrame.DrawData);
+        CheckAppState();
+        
+        int Queries = CountStateQueries();
+        RenderImgui(&Frame.DrawData);
+        assert(CountStateQueries() == Queries);
+        CheckAppState();
+    }
+    
+    printf("OK\n");
+    return 0;
+}
\ No newline at end of file
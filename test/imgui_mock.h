@@ -0,0 +1,157 @@
+#pragma once
+
+/*
+NOTE: sample usage code:
+
+#include "../kernel.h"
+#include "imgui_mock.h"
+#include "../gl_imgui.cpp"
+
+MockImguiFrame Frame(2, 3); // lists, commands per list
+RenderImgui(&Frame.DrawData);
+
+The part of Dear ImGui's API that gl_imgui.cpp uses, with the same names and
+layout, so it compiles and runs against ch_gl_mock.h without the library. Only
+data, nothing is laid out or rasterized.
+*/
+
+#include <vector>
+
+struct ImVec2
+{
+    float x, y;
+};
+
+struct ImVec4
+{
+    float x, y, z, w;
+};
+
+// begin() is a pointer like ImGui's
+template <typename T>
+struct ImVector
+{
+    std::vector<T> Data;
+    
+    int size() const { return int(Data.size()); }
+    const T &front() const { return Data.front(); }
+    const T *begin() const { return Data.data(); }
+    const T *end() const { return Data.data() + Data.size(); }
+};
+
+typedef unsigned short ImDrawIdx;
+
+struct ImDrawVert
+{
+    ImVec2 pos;
+    ImVec2 uv;
+    unsigned int col;
+};
+
+struct ImDrawList;
+struct ImDrawCmd;
+typedef void (*ImDrawCallback)(const ImDrawList *parent_list, const ImDrawCmd *cmd);
+
+struct ImDrawCmd
+{
+    unsigned int ElemCount;
+    ImVec4 ClipRect;
+    void *TextureId;
+    ImDrawCallback UserCallback;
+};
+
+struct ImDrawList
+{
+    ImVector<ImDrawCmd> CmdBuffer;
+    ImVector<ImDrawIdx> IdxBuffer;
+    ImVector<ImDrawVert> VtxBuffer;
+};
+
+struct ImDrawData
+{
+    ImDrawList **CmdLists;
+    int CmdListsCount;
+    int TotalVtxCount;
+    int TotalIdxCount;
+    
+    void ScaleClipRects(const ImVec2 &Scale)
+    {
+        for (int ListI = 0; ListI < CmdListsCount; ++ListI)
+        {
+            for (ImDrawCmd &Command: CmdLists[ListI]->CmdBuffer.Data)
+            {
+                Command.ClipRect = {Command.ClipRect.x * Scale.x, Command.ClipRect.y * Scale.y,
+                    Command.ClipRect.z * Scale.x, Command.ClipRect.w * Scale.y};
+            }
+        }
+    }
+};
+
+// a 4x4 white font
+struct ImFontAtlas
+{
+    unsigned char Pixels[4 * 4 * 4];
+    void *TexID;
+    
+    void GetTexDataAsRGBA32(unsigned char **OutPixels, int *Width, int *Height)
+    {
+        for (unsigned char &Byte: Pixels) Byte = 0xFF;
+        *OutPixels = Pixels;
+        *Width = 4;
+        *Height = 4;
+    }
+};
+
+struct ImGuiIO
+{
+    ImVec2 DisplaySize;
+    ImVec2 DisplayFramebufferScale;
+    void (*RenderDrawListsFn)(ImDrawData *data);
+    const char *IniFilename;
+    ImFontAtlas *Fonts;
+};
+
+namespace ImGui
+{
+    inline ImGuiIO &
+        GetIO()
+    {
+        static ImFontAtlas Fonts;
+        static ImGuiIO IO = {{0, 0}, {1, 1}, 0, 0, &Fonts};
+        return IO;
+    }
+};
+
+// lists of quads, each command a quad with its own clip rect
+struct MockImguiFrame
+{
+    std::vector<ImDrawList> Lists;
+    std::vector<ImDrawList *> ListPointers;
+    ImDrawData DrawData;
+    
+    MockImguiFrame(int ListCount, int CommandCount)
+    {
+        Lists.resize(size_t(ListCount));
+        DrawData = {};
+        for (ImDrawList &List: Lists)
+        {
+            for (int CommandI = 0; CommandI < CommandCount; ++CommandI)
+            {
+                ImDrawIdx First = ImDrawIdx(List.VtxBuffer.size());
+                for (int CornerI = 0; CornerI < 4; ++CornerI)
+                {
+                    ImDrawVert Vertex = {{float(CornerI & 1) * 10, float(CornerI >> 1) * 10}, {0, 0}, 0xFFFFFFFF};
+                    List.VtxBuffer.Data.push_back(Vertex);
+                }
+                for (ImDrawIdx Index: {0, 1, 2, 2, 1, 3}) List.IdxBuffer.Data.push_back(ImDrawIdx(First + Index));
+                ImDrawCmd Command = {6, {0, 0, 100.0f + float(CommandI), 100}, ImGui::GetIO().Fonts->TexID, 0};
+                List.CmdBuffer.Data.push_back(Command);
+            }
+            DrawData.TotalVtxCount += List.VtxBuffer.size();
+            DrawData.TotalIdxCount += List.IdxBuffer.size();
+            ListPointers.push_back(&List);
+        }
+        DrawData.CmdLists = ListPointers.data();
+        DrawData.CmdListsCount = ListCount;
+    }
+};
\ No newline at end of file